@@ -121,6 +121,17 @@ struct decoder_t
      */
     int                 i_extra_picture_buffers;
 
+    /**
+     * Size the decoded pictures will be downscaled to, in display
+     * orientation, or 0 if unknown (e.g. when creating thumbnails).
+     *
+     * Video decoders may output pictures smaller than their coded size, but
+     * not smaller than this one, if it is cheaper to do it while decoding.
+     * \see decoder_GetDownscaleShift()
+     */
+    unsigned            i_target_width;
+    unsigned            i_target_height;
+
     union
     {
 #       define VLCDEC_SUCCESS   VLC_SUCCESS
@@ -569,6 +580,44 @@ static inline float decoder_GetDisplayRate( decoder_t *dec )
     return dec->cbs->video.get_display_rate( dec );
 }
 
+/**
+ * This function returns by how many powers of two a video decoder can
+ * downscale a picture of the given coded size, while decoding it, without
+ * going below the target size.
+ *
+ * \param width coded width of the picture
+ * \param height coded height of the picture
+ * \param orientation orientation of the picture
+ * \param max_shift highest downscaling supported by the decoder, as a power
+ *                  of two
+ * \return the downscaling as a power of two, 0 to decode at full size
+ */
+VLC_USED
+static inline unsigned decoder_GetDownscaleShift( const decoder_t *dec,
+                                                  unsigned width,
+                                                  unsigned height,
+                                                  video_orientation_t orientation,
+                                                  unsigned max_shift )
+{
+    unsigned target_width = dec->i_target_width;
+    unsigned target_height = dec->i_target_height;
+
+    if( target_width == 0 && target_height == 0 )
+        return 0;
+    if( ORIENT_IS_SWAP( orientation ) )
+    {
+        target_width = dec->i_target_height;
+        target_height = dec->i_target_width;
+    }
+
+    unsigned shift = 0;
+    while( shift < max_shift && shift < 16
+        && ((width + (2u << shift) - 1) >> (shift + 1)) >= target_width
+        && ((height + (2u << shift) - 1) >> (shift + 1)) >= target_height )
+        shift++;
+    return shift;
+}
+
 /** @} */
 
 /**
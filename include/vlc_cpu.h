@@ -47,6 +47,7 @@ unsigned vlc_CPU_raw(void);
 #  define VLC_CPU_SSE4_1 0x00000400
 #  define VLC_CPU_AVX    0x00002000
 #  define VLC_CPU_AVX2   0x00004000
+#  define VLC_CPU_PCLMULQDQ 0x00008000
 
 #  if defined (__SSE__)
 #   define VLC_SSE
@@ -92,6 +93,12 @@ unsigned vlc_CPU_raw(void);
 #   define vlc_CPU_AVX2() ((vlc_CPU() & VLC_CPU_AVX2) != 0)
 #  endif
 
+#  ifdef __PCLMUL__
+#   define vlc_CPU_PCLMULQDQ() (1)
+#  else
+#   define vlc_CPU_PCLMULQDQ() ((vlc_CPU() & VLC_CPU_PCLMULQDQ) != 0)
+#  endif
+
 # elif defined (__ppc__) || defined (__ppc64__) || defined (__powerpc__)
 #  define HAVE_FPU 1
 #  define VLC_CPU_ALTIVEC 2
@@ -0,0 +1,83 @@
+/*****************************************************************************
+ * vlc_crc.h: Cyclic redundancy checks
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef VLC_CRC_H
+# define VLC_CRC_H
+
+/**
+ * \defgroup vlc_crc  Cyclic redundancy checks
+ * \ingroup cext
+ *
+ * CRCs used by the MPEG and FLAC bitstreams.
+ *
+ * All of them are computed most significant bit first, without reflection
+ * nor final XOR. The current value is passed in and returned, so that a CRC
+ * can be computed incrementally over several buffers:
+ * \code
+ * crc = vlc_crc16(0, a, a_size);
+ * crc = vlc_crc16(crc, b, b_size);
+ * \endcode
+ * gives the same result as a single call over the concatenation of a and b.
+ *
+ * @{
+ */
+
+/**
+ * Computes a CRC-8 with the polynomial x^8 + x^2 + x + 1 (0x07)
+ *
+ * This is the FLAC frame header CRC, with an initial value of 0.
+ *
+ * \param crc  current CRC value
+ * \param buf  data to add
+ * \param size size of the data in bytes
+ * \return the updated CRC value
+ */
+VLC_API uint8_t vlc_crc8(uint8_t crc, const void *buf, size_t size);
+
+/**
+ * Computes a CRC-16 with the polynomial x^16 + x^15 + x^2 + 1 (0x8005)
+ *
+ * This is the FLAC frame CRC, with an initial value of 0, and the MPEG audio
+ * frame CRC, with an initial value of 0xffff.
+ *
+ * \param crc  current CRC value
+ * \param buf  data to add
+ * \param size size of the data in bytes
+ * \return the updated CRC value
+ */
+VLC_API uint16_t vlc_crc16(uint16_t crc, const void *buf, size_t size);
+
+/**
+ * Computes a CRC-32 with the polynomial 0x04C11DB7
+ *
+ * This is the MPEG-2 systems CRC (PSI sections, program stream map), with an
+ * initial value of 0xffffffff. Unlike the zlib/PNG CRC-32 with the same
+ * polynomial, it is not reflected.
+ *
+ * \param crc  current CRC value
+ * \param buf  data to add
+ * \param size size of the data in bytes
+ * \return the updated CRC value
+ */
+VLC_API uint32_t vlc_crc32(uint32_t crc, const void *buf, size_t size);
+
+/** @} */
+
+#endif
@@ -205,6 +205,10 @@ struct input_item_node_t
     input_item_t *         p_item;
     int                    i_children;
     input_item_node_t      **pp_children;
+    /* The children follow the ones of the previous node posted for the same
+     * item, instead of replacing them (set by demuxers posting the subitems
+     * of a large playlist in several batches) */
+    bool                   b_append;
 };
 
 VLC_API void input_item_CopyOptions( input_item_t *p_child, input_item_t *p_parent );
@@ -484,8 +488,18 @@ typedef enum input_item_meta_request_option_t
     META_REQUEST_OPTION_FETCH_ANY     = 0x0C,
     META_REQUEST_OPTION_DO_INTERACT   = 0x10,
     META_REQUEST_OPTION_NO_SKIP       = 0x20,
+    META_REQUEST_OPTION_PRIORITY_LOW  = 0x40,
+    META_REQUEST_OPTION_PRIORITY_HIGH = 0x80,
 } input_item_meta_request_option_t;
 
+/* priority of the preparsing requests, see libvlc_MetadataSetPriority() */
+enum input_item_preparse_priority
+{
+    ITEM_PREPARSE_PRIORITY_LOW,
+    ITEM_PREPARSE_PRIORITY_NORMAL,
+    ITEM_PREPARSE_PRIORITY_HIGH,
+};
+
 /* status of the on_preparse_ended() callback */
 enum input_item_preparse_status
 {
@@ -514,6 +528,8 @@ VLC_API int libvlc_ArtRequest(libvlc_int_t *, input_item_t *,
                               const input_fetcher_callbacks_t *cbs,
                               void *cbs_userdata );
 VLC_API void libvlc_MetadataCancel( libvlc_int_t *, void * );
+VLC_API void libvlc_MetadataSetPriority( libvlc_int_t *, void *,
+                                         enum input_item_preparse_priority );
 
 /******************
  * Input stats
@@ -559,10 +575,12 @@ struct vlc_readdir_helper
     size_t i_slaves;
     void **pp_dirs;
     size_t i_dirs;
-    int i_sub_autodetect_fuzzy;
+    int i_sub_autodetect_fuzzy; /* 0 if the slaves are not attached */
     bool b_show_hiddenfiles;
     bool b_flatten;
     char *psz_ignored_exts;
+    input_item_t **pp_posted; /* posted items that may receive slaves */
+    size_t i_posted;
 };
 
 /**
@@ -583,6 +601,23 @@ VLC_API void vlc_readdir_helper_init(struct vlc_readdir_helper *p_rdh,
  */
 VLC_API void vlc_readdir_helper_finish(struct vlc_readdir_helper *p_rdh, bool b_success);
 
+/**
+ * Post the items added so far, before the end of the listing
+ *
+ * Accesses listing large directories can call this function every few items,
+ * so that the first ones are shown without waiting for the whole listing. The
+ * items are sorted within each batch, and the next ones are appended after
+ * them (see input_item_node_t.b_append). The possible slaves are kept until
+ * vlc_readdir_helper_finish(), which attaches them to the posted items too.
+ *
+ * \param out the es_out of the access (stream_t.out), can be NULL
+ * \return VLC_SUCCESS if the items were posted (or if there were none), an
+ * error if they are kept in the node, to be posted with the next batch or by
+ * the caller of pf_readdir
+ */
+VLC_API int vlc_readdir_helper_post(struct vlc_readdir_helper *p_rdh,
+                                    es_out_t *out);
+
 /**
  * Add a new input_item_t entry to the node of the vlc_readdir_helper struct.
  *
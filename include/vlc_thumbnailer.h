@@ -67,6 +67,8 @@ enum vlc_thumbnailer_seek_speed
  * \param time The time at which the thumbnail should be taken
  * \param speed The seeking speed \sa{enum vlc_thumbnailer_seek_speed}
  * \param input_item The input item to generate the thumbnail for
+ * \param width The width the thumbnail will be downscaled to, or 0
+ * \param height The height the thumbnail will be downscaled to, or 0
  * \param timeout A timeout value, or VLC_TICK_INVALID to disable timeout
  * \param cb A user callback to be called on completion (success & error)
  * \param user_data An opaque value, provided as pf_cb's first parameter
@@ -79,12 +81,18 @@ enum vlc_thumbnailer_seek_speed
  * vlc_thumbnailer_DestroyRequest().
  * The provided input_item will be held by the thumbnailer and can safely be
  * released safely after calling this function.
+ *
+ * The thumbnail is not downscaled by the thumbnailer, but the width and
+ * height are passed to the decoders, which may then output a picture at
+ * least that large instead of the full size one, which is faster.
  */
 VLC_API vlc_thumbnailer_request_t*
 vlc_thumbnailer_RequestByTime( vlc_thumbnailer_t *thumbnailer,
                                vlc_tick_t time,
                                enum vlc_thumbnailer_seek_speed speed,
-                               input_item_t *input_item, vlc_tick_t timeout,
+                               input_item_t *input_item,
+                               unsigned width, unsigned height,
+                               vlc_tick_t timeout,
                                vlc_thumbnailer_cb cb, void* user_data );
 /**
  * \brief vlc_thumbnailer_RequestByTime Requests a thumbnailer at a given time
@@ -92,6 +100,8 @@ vlc_thumbnailer_RequestByTime( vlc_thumbnailer_t *thumbnailer,
  * \param pos The position at which the thumbnail should be taken
  * \param speed The seeking speed \sa{enum vlc_thumbnailer_seek_speed}
  * \param input_item The input item to generate the thumbnail for
+ * \param width The width the thumbnail will be downscaled to, or 0
+ * \param height The height the thumbnail will be downscaled to, or 0
  * \param timeout A timeout value, or VLC_TICK_INVALID to disable timeout
  * \param cb A user callback to be called on completion (success & error)
  * \param user_data An opaque value, provided as pf_cb's first parameter
@@ -104,14 +114,102 @@ vlc_thumbnailer_RequestByTime( vlc_thumbnailer_t *thumbnailer,
  * vlc_thumbnailer_DestroyRequest().
  * The provided input_item will be held by the thumbnailer and can safely be
  * released after calling this function.
+ *
+ * \see vlc_thumbnailer_RequestByTime() for the width and height parameters
  */
 VLC_API vlc_thumbnailer_request_t*
 vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
                               double pos,
                               enum vlc_thumbnailer_seek_speed speed,
-                              input_item_t *input_item, vlc_tick_t timeout,
+                              input_item_t *input_item,
+                              unsigned width, unsigned height,
+                              vlc_tick_t timeout,
                               vlc_thumbnailer_cb cb, void* user_data );
 
+/**
+ * \brief Thumbnails of a batch request, all from the same media
+ *
+ * The thumbnails are taken either at the given times, or every interval from
+ * the start of the media.
+ */
+struct vlc_thumbnailer_batch
+{
+    /** Times of the thumbnails, in increasing order, or NULL to take one
+     * thumbnail every interval */
+    const vlc_tick_t *times;
+    /** Number of times, or maximum number of thumbnails taken every
+     * interval (0 for up to the end of the media) */
+    size_t count;
+    /** Interval between the thumbnails, if times is NULL */
+    vlc_tick_t interval;
+    /** Size the thumbnails will be downscaled to, or 0
+     * \see vlc_thumbnailer_RequestByTime() */
+    unsigned width;
+    unsigned height;
+    /** Number of columns of the sprite sheet, or 0 for no sprite sheet. The
+     * thumbnails are then cropped and scaled to width x height tiles. */
+    unsigned sprite_columns;
+    /** URL of the sprite sheet image in its WebVTT index, or NULL */
+    const char *sprite_url;
+};
+
+struct vlc_thumbnailer_batch_cbs
+{
+    /**
+     * Called for each thumbnail, in order
+     *
+     * \param data Is the opaque pointer passed to the request
+     * \param index Index of the thumbnail in the batch
+     * \param time Requested time of the thumbnail
+     * \param thumbnail The thumbnail, owned by the thumbnailer (see
+     * \ref vlc_thumbnailer_cb)
+     */
+    void (*on_thumbnail)(void *data, size_t index, vlc_tick_t time,
+                         picture_t *thumbnail);
+
+    /**
+     * Called once when the batch is over
+     *
+     * The batch stops early at the end of the media, on timeout or on error.
+     *
+     * \param data Is the opaque pointer passed to the request
+     * \param count Number of thumbnails generated
+     * \param sprite The RGBA sprite sheet, owned by the thumbnailer, or NULL
+     * if not requested or if it could not be created
+     * \param index The WebVTT index of the sprite sheet, with one cue per
+     * thumbnail pointing to its tile (sprite_url#xywh=x,y,w,h), or NULL
+     */
+    void (*on_ended)(void *data, size_t count, picture_t *sprite,
+                     const char *index);
+};
+
+/**
+ * \brief vlc_thumbnailer_RequestBatch Requests several thumbnails of a media
+ * \param thumbnailer A thumbnailer object
+ * \param input_item The input item to generate the thumbnails for
+ * \param batch The thumbnails to generate, copied by the thumbnailer
+ * \param timeout A timeout value for each thumbnail, or VLC_TICK_INVALID to
+ * disable timeout
+ * \param cbs User callbacks
+ * \param user_data An opaque value, provided as the callbacks' first parameter
+ * \return An opaque request object, or NULL in case of failure
+ *
+ * Unlike successive vlc_thumbnailer_RequestByTime() calls, the media is only
+ * opened once: the thumbnailer seeks to the keyframe nearest to each time,
+ * in order, and only decodes that frame.
+ *
+ * If this function returns a valid request object, on_ended is guaranteed to
+ * be called, unless the request is destroyed early. The returned request
+ * object must be freed with vlc_thumbnailer_DestroyRequest().
+ */
+VLC_API vlc_thumbnailer_request_t*
+vlc_thumbnailer_RequestBatch( vlc_thumbnailer_t *thumbnailer,
+                              input_item_t *input_item,
+                              const struct vlc_thumbnailer_batch *batch,
+                              vlc_tick_t timeout,
+                              const struct vlc_thumbnailer_batch_cbs *cbs,
+                              void *user_data );
+
 /**
  * \brief vlc_thumbnailer_DestroyRequest Destroy a thumbnail request
  * \param thumbnailer A thumbnailer object
@@ -1018,7 +1018,7 @@ libvlc_media_thumbnail_request_by_time( libvlc_instance_t *inst,
         vlc_tick_from_libvlc_time( time ),
         speed == libvlc_media_thumbnail_seek_fast ?
             VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
-        md->p_input_item,
+        md->p_input_item, width, height,
         timeout > 0 ? vlc_tick_from_libvlc_time( timeout ) : VLC_TICK_INVALID,
         media_on_thumbnail_ready, req );
     if ( req->req == NULL )
@@ -1060,7 +1060,7 @@ libvlc_media_thumbnail_request_by_pos( libvlc_instance_t *inst,
     req->req = vlc_thumbnailer_RequestByPos( priv->p_thumbnailer, pos,
         speed == libvlc_media_thumbnail_seek_fast ?
             VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
-        md->p_input_item,
+        md->p_input_item, width, height,
         timeout > 0 ? vlc_tick_from_libvlc_time( timeout ) : VLC_TICK_INVALID,
         media_on_thumbnail_ready, req );
     if ( req->req == NULL )
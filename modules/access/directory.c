@@ -36,10 +36,16 @@
 #include <vlc_common.h>
 #include "fs.h"
 #include <vlc_access.h>
+#include <vlc_executor.h>
 #include <vlc_input_item.h>
 
 #include <vlc_fs.h>
+#include <vlc_strings.h>
 #include <vlc_url.h>
+#include <vlc_vector.h>
+
+/* Number of entries listed before they are posted to the input */
+#define DIR_BATCH_SIZE 1000
 
 typedef struct
 {
@@ -131,95 +137,309 @@ void DirClose(vlc_object_t *obj)
     vlc_closedir(sys->dir);
 }
 
-static int DirRead (stream_t *access, input_item_node_t *node)
+struct dir_entry
+{
+    char *name;
+    int type; /**< ITEM_TYPE_*, or -1 until the entry is stat'ed */
+    bool has_stat;
+    bool stat_failed;
+    struct stat st;
+};
+
+typedef struct VLC_VECTOR(struct dir_entry) dir_entry_vector;
+
+static int DirStat(stream_t *access, const char *entry, struct stat *st)
 {
+#ifdef HAVE_FSTATAT
     access_sys_t *sys = access->p_sys;
-    const char *entry;
-    int ret = VLC_SUCCESS;
 
-    bool special_files = var_InheritBool(access, "list-special-files");
+    return fstatat(dirfd(sys->dir), entry, st, 0);
+#else
+    char *path;
 
-    struct vlc_readdir_helper rdh;
-    vlc_readdir_helper_init(&rdh, access, node);
+    if (asprintf(&path, "%s"DIR_SEP"%s", access->psz_filepath, entry) == -1)
+        return -1;
 
-    while (ret == VLC_SUCCESS && (entry = vlc_readdir(sys->dir)) != NULL)
+    int ret = vlc_stat(path, st);
+    free(path);
+    return ret;
+#endif
+}
+
+/* Returns the item type of a file mode, or -1 if it is not listed */
+static int DirTypeFromMode(mode_t mode, bool special_files)
+{
+    switch (mode & S_IFMT)
     {
-        struct stat st;
-        int type;
+#ifdef S_IFBLK
+        case S_IFBLK:
+            return special_files ? ITEM_TYPE_DISC : -1;
+#endif
+        case S_IFCHR:
+            return special_files ? ITEM_TYPE_CARD : -1;
+        case S_IFIFO:
+            return special_files ? ITEM_TYPE_STREAM : -1;
+        case S_IFREG:
+            return ITEM_TYPE_FILE;
+        case S_IFDIR:
+            return ITEM_TYPE_DIRECTORY;
+        /* S_IFLNK cannot occur while following symbolic links */
+        /* S_IFSOCK cannot be opened with open()/openat() */
+        default:
+            return -1; /* ignore */
+    }
+}
 
-#ifdef HAVE_FSTATAT
-        if (fstatat(dirfd(sys->dir), entry, &st, 0))
-            continue;
-#else
-        char *path;
+struct dir_stat_task
+{
+    struct vlc_runnable runnable;
+    stream_t *access;
+    struct dir_entry *entries;
+    size_t count;
+};
+
+static void DirStatRun(void *data)
+{
+    struct dir_stat_task *task = data;
 
-        if (asprintf(&path, "%s"DIR_SEP"%s", access->psz_filepath, entry) == -1
-         || (type = vlc_stat(path, &st), free(path), type))
+    for (size_t i = 0; i < task->count; i++)
+    {
+        struct dir_entry *ent = &task->entries[i];
+        if (ent->has_stat)
             continue;
-#endif
-        switch (st.st_mode & S_IFMT)
+        ent->stat_failed = DirStat(task->access, ent->name, &ent->st) != 0;
+        ent->has_stat = true;
+    }
+}
+
+/* Stats the entries, in parallel if an executor is provided: on network file
+ * systems, each stat is a round-trip to the server */
+static void DirStatEntries(stream_t *access, vlc_executor_t *executor,
+                           unsigned threads, struct dir_entry *entries,
+                           size_t count)
+{
+    if (executor == NULL || count < 2 * threads)
+    {
+        struct dir_stat_task task = { .access = access, .entries = entries,
+                                      .count = count };
+        DirStatRun(&task);
+        return;
+    }
+
+    struct dir_stat_task tasks[threads];
+    size_t start = 0;
+    for (unsigned i = 0; i < threads; i++)
+    {
+        size_t end = count * (i + 1) / threads;
+        tasks[i].runnable.run = DirStatRun;
+        tasks[i].runnable.userdata = &tasks[i];
+        tasks[i].access = access;
+        tasks[i].entries = &entries[start];
+        tasks[i].count = end - start;
+        vlc_executor_Submit(executor, &tasks[i].runnable);
+        start = end;
+    }
+    vlc_executor_WaitIdle(executor);
+}
+
+/* Lists the names of the entries, with their type if the file system
+ * provides it without stat */
+static int DirList(stream_t *access, dir_entry_vector *entries,
+                   bool special_files)
+{
+    access_sys_t *sys = access->p_sys;
+
+    for (;;)
+    {
+        struct dir_entry ent = { .type = -1 };
+        const char *name;
+#if defined(HAVE_FSTATAT) && defined(DT_UNKNOWN)
+        struct dirent *dirent = readdir(sys->dir);
+        if (dirent == NULL)
+            break;
+        name = dirent->d_name;
+
+        switch (dirent->d_type)
         {
-#ifdef S_IFBLK
-            case S_IFBLK:
-                if (!special_files)
-                    continue;
-                type = ITEM_TYPE_DISC;
+            case DT_REG:
+                ent.type = ITEM_TYPE_FILE;
                 break;
-#endif
-            case S_IFCHR:
-                if (!special_files)
-                    continue;
-                type = ITEM_TYPE_CARD;
+            case DT_DIR:
+                ent.type = ITEM_TYPE_DIRECTORY;
                 break;
-            case S_IFIFO:
+            case DT_BLK:
+            case DT_CHR:
+            case DT_FIFO:
                 if (!special_files)
                     continue;
-                type = ITEM_TYPE_STREAM;
-                break;
-            case S_IFREG:
-                type = ITEM_TYPE_FILE;
                 break;
-            case S_IFDIR:
-                type = ITEM_TYPE_DIRECTORY;
-                break;
-            /* S_IFLNK cannot occur while following symbolic links */
-            /* S_IFSOCK cannot be opened with open()/openat() */
-            default:
-                continue; /* ignore */
+            case DT_SOCK:
+                continue;
+            /* DT_LNK and DT_UNKNOWN need a stat */
         }
-
-        /* Create an input item for the current entry */
-        char *encoded = vlc_uri_encode(entry);
-        if (unlikely(encoded == NULL))
-        {
-            ret = VLC_ENOMEM;
+#else
+        VLC_UNUSED(special_files);
+        name = vlc_readdir(sys->dir);
+        if (name == NULL)
             break;
-        }
-
-        char *uri;
-        if (unlikely(asprintf(&uri, "%s%s%s", sys->base_uri,
-                              sys->need_separator ? "/" : "",
-                              encoded) == -1))
-            uri = NULL;
-        free(encoded);
-        if (unlikely(uri == NULL))
+#endif
+        ent.name = strdup(name);
+        if (unlikely(ent.name == NULL || !vlc_vector_push(entries, ent)))
         {
-            ret = VLC_ENOMEM;
-            break;
+            free(ent.name);
+            return VLC_ENOMEM;
         }
-        input_item_t *p_item;
-        ret = vlc_readdir_helper_additem(&rdh, uri, NULL, entry, type,
+    }
+    return VLC_SUCCESS;
+}
+
+static int DirEntryCmp(const void *a, const void *b)
+{
+    const struct dir_entry *ea = a, *eb = b;
+
+    /* same order as vlc_readdir_helper_finish(): folders first */
+    if (ea->type != eb->type)
+    {
+        if (ea->type == ITEM_TYPE_DIRECTORY)
+            return -1;
+        if (eb->type == ITEM_TYPE_DIRECTORY)
+            return 1;
+    }
+    return vlc_filenamecmp(ea->name, eb->name);
+}
+
+static int DirMasterExtCmp(const void *key, const void *entry)
+{
+    return strcasecmp(key, *(const char *const *)entry);
+}
+
+/* Whether the entry may receive subtitles or audio tracks from the others,
+ * as in vlc_readdir_helper_additem() */
+static bool DirIsMaster(const char *name)
+{
+    static const char *const exts[] = { MASTER_EXTENSIONS };
+
+    const char *ext = strrchr(name, '.');
+    if (ext == NULL || *(++ext) == '\0')
+        return false;
+
+    return bsearch(ext, exts, ARRAY_SIZE(exts), sizeof(*exts),
+                   DirMasterExtCmp) != NULL;
+}
+
+static int DirAddEntry(stream_t *access, struct vlc_readdir_helper *rdh,
+                       struct dir_entry *ent, bool special_files)
+{
+    access_sys_t *sys = access->p_sys;
+
+    if (ent->stat_failed)
+        return VLC_SUCCESS;
+
+    int type = DirTypeFromMode(ent->st.st_mode, special_files);
+    if (type == -1)
+        return VLC_SUCCESS;
+
+    /* Create an input item for the current entry */
+    char *encoded = vlc_uri_encode(ent->name);
+    if (unlikely(encoded == NULL))
+        return VLC_ENOMEM;
+
+    char *uri;
+    if (unlikely(asprintf(&uri, "%s%s%s", sys->base_uri,
+                          sys->need_separator ? "/" : "",
+                          encoded) == -1))
+        uri = NULL;
+    free(encoded);
+    if (unlikely(uri == NULL))
+        return VLC_ENOMEM;
+
+    input_item_t *p_item;
+    int ret = vlc_readdir_helper_additem(rdh, uri, NULL, ent->name, type,
                                          ITEM_NET_UNKNOWN, &p_item);
 
-        if (ret == VLC_SUCCESS && p_item && st.st_mtime >= 0 && st.st_size >= 0)
-        {
-            input_item_AddStat( p_item, "mtime", st.st_mtime );
-            input_item_AddStat( p_item, "size", st.st_size );
-        }
-        free(uri);
+    if (ret == VLC_SUCCESS && p_item && ent->st.st_mtime >= 0
+     && ent->st.st_size >= 0)
+    {
+        input_item_AddStat( p_item, "mtime", ent->st.st_mtime );
+        input_item_AddStat( p_item, "size", ent->st.st_size );
+    }
+    free(uri);
+    return ret;
+}
+
+static int DirRead (stream_t *access, input_item_node_t *node)
+{
+    bool special_files = var_InheritBool(access, "list-special-files");
+    unsigned threads = var_InheritInteger(access, "directory-stat-threads");
+    dir_entry_vector entries = VLC_VECTOR_INITIALIZER;
+    vlc_executor_t *executor = NULL;
+
+    /*
+     * The names are listed first, then sorted (the file system usually
+     * provides the type of the entries, which is enough to sort them). The
+     * entries are then stat'ed and posted in batches, in order, so that the
+     * first items of a large directory are shown without waiting for all
+     * the entries to be stat'ed.
+     */
+    int ret = DirList(access, &entries, special_files);
+
+    if (ret == VLC_SUCCESS && threads > 1 && entries.size > DIR_BATCH_SIZE)
+        executor = vlc_executor_New(threads);
+
+    /* Stat the entries of unknown type first, to sort them */
+    size_t unknown = 0;
+    for (size_t i = 0; ret == VLC_SUCCESS && i < entries.size; i++)
+    {
+        if (entries.data[i].type != -1)
+            continue;
+        struct dir_entry tmp = entries.data[unknown];
+        entries.data[unknown++] = entries.data[i];
+        entries.data[i] = tmp;
+    }
+    DirStatEntries(access, executor, threads, entries.data, unknown);
+    for (size_t i = 0; i < unknown; i++)
+    {
+        struct dir_entry *ent = &entries.data[i];
+        if (!ent->stat_failed)
+            ent->type = DirTypeFromMode(ent->st.st_mode, special_files);
+    }
+
+    qsort(entries.data, entries.size, sizeof(*entries.data), DirEntryCmp);
+
+    struct vlc_readdir_helper rdh;
+    vlc_readdir_helper_init(&rdh, access, node);
+
+    /* The possible subtitles and audio tracks are kept until the end of the
+     * listing, in case they match a video. Don't hold back a folder of audio
+     * files when there is no video they could be attached to. */
+    bool has_master = false;
+    for (size_t i = 0; !has_master && i < entries.size; i++)
+        has_master = DirIsMaster(entries.data[i].name);
+    if (!has_master)
+        rdh.i_sub_autodetect_fuzzy = 0;
+
+    for (size_t start = 0; ret == VLC_SUCCESS && start < entries.size;
+         start += DIR_BATCH_SIZE)
+    {
+        size_t count = __MIN(entries.size - start, DIR_BATCH_SIZE);
+        struct dir_entry *batch = &entries.data[start];
+
+        DirStatEntries(access, executor, threads, batch, count);
+        for (size_t i = 0; ret == VLC_SUCCESS && i < count; i++)
+            ret = DirAddEntry(access, &rdh, &batch[i], special_files);
+
+        /* the last batch is posted by the caller */
+        if (ret == VLC_SUCCESS && start + count < entries.size)
+            vlc_readdir_helper_post(&rdh, access->out);
     }
 
     vlc_readdir_helper_finish(&rdh, ret == VLC_SUCCESS);
 
+    if (executor != NULL)
+        vlc_executor_Delete(executor);
+    for (size_t i = 0; i < entries.size; i++)
+        free(entries.data[i].name);
+    vlc_vector_destroy(&entries);
+
     return ret;
 }
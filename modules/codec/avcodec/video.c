@@ -159,6 +159,10 @@ static int lavc_GetVideoFormat(decoder_t *dec, video_format_t *restrict fmt,
     {   /* software decoding */
         int aligns[AV_NUM_DATA_POINTERS];
 
+        /* the coded size is not reduced by lowres decoding */
+        width = (width + (1 << ctx->lowres) - 1) >> ctx->lowres;
+        height = (height + (1 << ctx->lowres) - 1) >> ctx->lowres;
+
         if (GetVlcChroma(fmt, pix_fmt))
             return -1;
 
@@ -182,16 +186,18 @@ static int lavc_GetVideoFormat(decoder_t *dec, video_format_t *restrict fmt,
 
     fmt->i_width = width;
     fmt->i_height = height;
-    if ( dec->fmt_in->video.i_visible_width != 0 &&
-         dec->fmt_in->video.i_visible_width <= (unsigned)ctx->width &&
-         dec->fmt_in->video.i_visible_height != 0 &&
-         dec->fmt_in->video.i_visible_height <= (unsigned)ctx->height )
+
+    /* the crop of the demuxer is in full resolution pixels */
+    unsigned visible_width = dec->fmt_in->video.i_visible_width >> ctx->lowres;
+    unsigned visible_height = dec->fmt_in->video.i_visible_height >> ctx->lowres;
+    if ( visible_width != 0 && visible_width <= (unsigned)ctx->width &&
+         visible_height != 0 && visible_height <= (unsigned)ctx->height )
     {
         /* the demuxer/packetizer provided crop info that are lost in lavc */
-        fmt->i_visible_width  = dec->fmt_in->video.i_visible_width;
-        fmt->i_visible_height = dec->fmt_in->video.i_visible_height;
-        fmt->i_x_offset       = dec->fmt_in->video.i_x_offset;
-        fmt->i_y_offset       = dec->fmt_in->video.i_y_offset;
+        fmt->i_visible_width  = visible_width;
+        fmt->i_visible_height = visible_height;
+        fmt->i_x_offset       = dec->fmt_in->video.i_x_offset >> ctx->lowres;
+        fmt->i_y_offset       = dec->fmt_in->video.i_y_offset >> ctx->lowres;
     }
     else
     {
@@ -468,7 +474,23 @@ int InitVideoDec( vlc_object_t *obj )
     /* ***** Output always the frames ***** */
     p_context->flags |= AV_CODEC_FLAG_OUTPUT_CORRUPT;
 
+    /* ***** Downscaled output (thumbnails) ***** */
+    const video_format_t *p_fmt_in = &p_dec->fmt_in->video;
+    p_context->lowres = decoder_GetDownscaleShift( p_dec,
+                                                   p_fmt_in->i_visible_width,
+                                                   p_fmt_in->i_visible_height,
+                                                   p_fmt_in->orientation,
+                                                   p_codec->max_lowres );
+    if( p_context->lowres > 0 )
+        msg_Dbg( p_dec, "decoding at 1/%d of the size", 1 << p_context->lowres );
+
     i_val = var_CreateGetInteger( p_dec, "avcodec-skiploopfilter" );
+    /* Deblocking artifacts vanish once the picture is downscaled by 2 */
+    if( i_val == 0 && decoder_GetDownscaleShift( p_dec,
+                                                 p_fmt_in->i_visible_width,
+                                                 p_fmt_in->i_visible_height,
+                                                 p_fmt_in->orientation, 1 ) )
+        i_val = 4;
     if( i_val >= 4 ) p_context->skip_loop_filter = AVDISCARD_ALL;
     else if( i_val == 3 ) p_context->skip_loop_filter = AVDISCARD_NONKEY;
     else if( i_val == 2 ) p_context->skip_loop_filter = AVDISCARD_BIDIR;
@@ -1718,7 +1740,8 @@ no_reuse:
     p_sys->profile = p_context->profile;
     p_sys->level = p_context->level;
 
-    if (!can_hwaccel)
+    /* Hardware decoders can't do lowres decoding */
+    if (!can_hwaccel || p_context->lowres > 0)
         return swfmt;
 
 #if !LIBAVCODEC_VERSION_CHECK(57, 83, 101)
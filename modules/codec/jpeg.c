@@ -498,6 +498,27 @@ static int DecodeBlock(decoder_t *p_dec, block_t *p_block)
 
     p_sys->p_jpeg.out_color_space = JCS_RGB;
 
+    int i_otag; /* Orientation tag has valid range of 1-8. 1 is normal orientation, 0 = unspecified = normal */
+    i_otag = jpeg_GetOrientation( &p_sys->p_jpeg );
+    if ( i_otag > 1 )
+    {
+        msg_Dbg( p_dec, "Jpeg orientation is %d", i_otag );
+        p_dec->fmt_out.video.orientation = ORIENT_FROM_EXIF( i_otag );
+    }
+
+    /* Let the IDCT downscale by up to 8 if the picture will be downscaled
+     * anyway (thumbnails): it skips most of the IDCT and upsampling work */
+    unsigned i_shift = decoder_GetDownscaleShift( p_dec,
+                                        p_sys->p_jpeg.image_width,
+                                        p_sys->p_jpeg.image_height,
+                                        p_dec->fmt_out.video.orientation, 3 );
+    if (i_shift > 0)
+    {
+        p_sys->p_jpeg.scale_num = 1;
+        p_sys->p_jpeg.scale_denom = 1 << i_shift;
+        p_sys->p_jpeg.do_fancy_upsampling = FALSE;
+    }
+
     jpeg_start_decompress(&p_sys->p_jpeg);
 
     /* Set output properties */
@@ -506,13 +527,6 @@ static int DecodeBlock(decoder_t *p_dec, block_t *p_block)
     p_dec->fmt_out.video.i_sar_num = 1;
     p_dec->fmt_out.video.i_sar_den = 1;
 
-    int i_otag; /* Orientation tag has valid range of 1-8. 1 is normal orientation, 0 = unspecified = normal */
-    i_otag = jpeg_GetOrientation( &p_sys->p_jpeg );
-    if ( i_otag > 1 )
-    {
-        msg_Dbg( p_dec, "Jpeg orientation is %d", i_otag );
-        p_dec->fmt_out.video.orientation = ORIENT_FROM_EXIF( i_otag );
-    }
     jpeg_FillProjection(&p_sys->p_jpeg, &p_dec->fmt_out.video);
 
     /* Get a new picture */
@@ -229,6 +229,52 @@ static int make_xmp_packet( const video_format_t *fmt, png_textp chunk )
 
 #endif
 
+/****************************************************************************
+ * ReadDownscaled: read the image, averaging blocks of 2^shift pixels
+ ****************************************************************************
+ * libpng can't skip pixels, but this avoids decoding the whole image into a
+ * picture only to downscale it right away (thumbnails).
+ ****************************************************************************/
+static void ReadDownscaled( png_structp p_png, picture_t *p_pic,
+                            png_uint_32 i_width, png_uint_32 i_height,
+                            unsigned i_channels, unsigned i_shift,
+                            uint8_t *p_row, uint32_t *p_sum )
+{
+    const unsigned i_block = 1 << i_shift;
+    const unsigned i_out_width = p_pic->format.i_width;
+    unsigned i_rows = 0;
+    uint8_t *p_out = p_pic->p->p_pixels;
+
+    memset( p_sum, 0, i_out_width * i_channels * sizeof(*p_sum) );
+
+    for( png_uint_32 y = 0; y < i_height; y++ )
+    {
+        png_read_row( p_png, p_row, NULL );
+
+        for( png_uint_32 x = 0; x < i_width; x++ )
+            for( unsigned k = 0; k < i_channels; k++ )
+                p_sum[(x >> i_shift) * i_channels + k] +=
+                    p_row[x * i_channels + k];
+
+        if( ++i_rows < i_block && y + 1 < i_height )
+            continue;
+
+        for( unsigned x = 0; x < i_out_width; x++ )
+        {
+            unsigned i_cols = __MIN( i_block, i_width - (x << i_shift) );
+            uint32_t i_count = i_cols * i_rows;
+            for( unsigned k = 0; k < i_channels; k++ )
+            {
+                uint32_t *p = &p_sum[x * i_channels + k];
+                p_out[x * i_channels + k] = (*p + i_count / 2) / i_count;
+                *p = 0;
+            }
+        }
+        p_out += p_pic->p->i_pitch;
+        i_rows = 0;
+    }
+}
+
 /****************************************************************************
  * DecodeBlock: the whole thing
  ****************************************************************************
@@ -246,6 +292,8 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
     png_structp p_png;
     png_infop p_info, p_end_info;
     png_bytep *volatile p_row_pointers = NULL;
+    void *volatile p_scale_buffer = NULL;
+    unsigned i_shift = 0;
 
     if( !p_block ) /* No Drain */
         return VLCDEC_SUCCESS;
@@ -296,10 +344,17 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
                   &i_compression_type, &i_filter_type);
     if( p_sys->b_error ) goto error;
 
+    /* Adam7 interlaced images are not worth downscaling while decoding */
+    if( i_interlace_type == PNG_INTERLACE_NONE )
+        i_shift = decoder_GetDownscaleShift( p_dec, i_width, i_height,
+                                             ORIENT_NORMAL, 5 );
+
     /* Set output properties */
     p_dec->fmt_out.i_codec = VLC_CODEC_RGBA;
-    p_dec->fmt_out.video.i_visible_width = p_dec->fmt_out.video.i_width = i_width;
-    p_dec->fmt_out.video.i_visible_height = p_dec->fmt_out.video.i_height = i_height;
+    p_dec->fmt_out.video.i_visible_width = p_dec->fmt_out.video.i_width =
+        (i_width + (1 << i_shift) - 1) >> i_shift;
+    p_dec->fmt_out.video.i_visible_height = p_dec->fmt_out.video.i_height =
+        (i_height + (1 << i_shift) - 1) >> i_shift;
     p_dec->fmt_out.video.i_sar_num = 1;
     p_dec->fmt_out.video.i_sar_den = 1;
 
@@ -371,19 +426,38 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
 
 
     /* Decode picture */
-    p_row_pointers = vlc_alloc( i_height, sizeof(png_bytep) );
-    if( !p_row_pointers )
-        goto error;
-    for( i = 0; i < (int)i_height; i++ )
-        p_row_pointers[i] = p_pic->p->p_pixels + p_pic->p->i_pitch * i;
+    if( i_shift > 0 )
+    {
+        unsigned i_channels =
+            p_dec->fmt_out.i_codec == VLC_CODEC_RGBA ? 4 : 3;
+        size_t i_row = (size_t)i_width * i_channels;
+        size_t i_sum = p_dec->fmt_out.video.i_width * i_channels;
 
-    png_read_image( p_png, p_row_pointers );
-    if( p_sys->b_error ) goto error;
+        p_scale_buffer = vlc_alloc( i_row + i_sum * sizeof(uint32_t), 1 );
+        if( !p_scale_buffer )
+            goto error;
+        ReadDownscaled( p_png, p_pic, i_width, i_height, i_channels, i_shift,
+                        (uint8_t *)p_scale_buffer + i_sum * sizeof(uint32_t),
+                        p_scale_buffer );
+        if( p_sys->b_error ) goto error;
+    }
+    else
+    {
+        p_row_pointers = vlc_alloc( i_height, sizeof(png_bytep) );
+        if( !p_row_pointers )
+            goto error;
+        for( i = 0; i < (int)i_height; i++ )
+            p_row_pointers[i] = p_pic->p->p_pixels + p_pic->p->i_pitch * i;
+
+        png_read_image( p_png, p_row_pointers );
+        if( p_sys->b_error ) goto error;
+    }
     png_read_end( p_png, p_end_info );
     if( p_sys->b_error ) goto error;
 
     png_destroy_read_struct( &p_png, &p_info, &p_end_info );
     free( p_row_pointers );
+    free( p_scale_buffer );
 
     p_pic->date = p_block->i_pts != VLC_TICK_INVALID ? p_block->i_pts : p_block->i_dts;
 
@@ -396,6 +470,7 @@ static int DecodeBlock( decoder_t *p_dec, block_t *p_block )
     if( p_pic )
         picture_Release( p_pic );
     free( p_row_pointers );
+    free( p_scale_buffer );
     png_destroy_read_struct( &p_png, &p_info, &p_end_info );
     block_Release( p_block );
     return VLCDEC_SUCCESS;
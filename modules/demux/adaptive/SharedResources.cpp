@@ -25,21 +25,28 @@
 #include "http/AuthStorage.hpp"
 #include "http/HTTPConnectionManager.h"
 #include "http/HTTPConnection.hpp"
+#include "http/SegmentCache.hpp"
 #include "encryption/Keyring.hpp"
 
 using namespace adaptive;
 
 SharedResources::SharedResources(AuthStorage *auth, Keyring *ring,
-                                 AbstractConnectionManager *conn)
+                                 AbstractConnectionManager *conn,
+                                 SegmentCache *cache)
 {
     authStorage = auth;
     encryptionKeyring = ring;
     connManager = conn;
+    segmentCache = cache;
 }
 
 SharedResources::~SharedResources()
 {
+    /* cached sources need their connection manager */
+    if(segmentCache)
+        segmentCache->clear();
     delete connManager;
+    delete segmentCache;
     delete encryptionKeyring;
     delete authStorage;
 }
@@ -59,6 +66,11 @@ AbstractConnectionManager * SharedResources::getConnManager()
     return connManager;
 }
 
+SegmentCache * SharedResources::getSegmentCache()
+{
+    return segmentCache;
+}
+
 SharedResources * SharedResources::createDefault(vlc_object_t *obj,
                                                  const std::string & playlisturl)
 {
@@ -71,5 +83,8 @@ SharedResources * SharedResources::createDefault(vlc_object_t *obj,
     ConnectionParams params(playlisturl);
     if(params.isLocal())
         m->setLocalConnectionsAllowed();
-    return new SharedResources(auth, keyring, m);
+    SegmentCache *cache = new SegmentCache(obj, 1024 *
+                                var_InheritInteger(obj, "adaptive-cachesize"));
+    m->setSegmentCache(cache);
+    return new SharedResources(auth, keyring, m, cache);
 }
@@ -29,6 +29,7 @@
 #include "HTTPConnection.hpp"
 #include "HTTPConnectionManager.h"
 #include "Downloader.hpp"
+#include "../tools/SharedBlock.hpp"
 
 #include <vlc_common.h>
 #include <vlc_block.h>
@@ -124,7 +125,8 @@ block_t * AbstractChunk::doRead(size_t size, bool b_block)
             block->i_flags |= BLOCK_FLAG_HEADER;
         bytesRead += block->i_buffer;
         onDownload(&block);
-        block->i_flags &= ~BLOCK_FLAG_HEADER;
+        if(block)
+            block->i_flags &= ~BLOCK_FLAG_HEADER;
     }
 
     return block;
@@ -155,6 +157,8 @@ HTTPChunkSource::HTTPChunkSource(const std::string& url, AbstractConnectionManag
 {
     prepared = false;
     eof = false;
+    cacheable = true;
+    cacheExpiry = VLC_TICK_INVALID;
     sourceid = id;
     setUseAccess(access);
     setIdentifier(url, range);
@@ -318,6 +322,9 @@ bool HTTPChunkSource::prepare()
         contentLength = connection->getContentLength();
         prepared = true;
         responseTime = vlc_tick_now();
+        cacheable = connection->isCacheable();
+        if(connection->getCacheMaxAge() != VLC_TICK_INVALID)
+            cacheExpiry = responseTime + connection->getCacheMaxAge();
         return true;
     }
 
@@ -371,6 +378,13 @@ bool HTTPChunkBufferedSource::isDone() const
     return done;
 }
 
+bool HTTPChunkBufferedSource::isComplete() const
+{
+    mutex_locker locker {lock};
+    return done && requeststatus == RequestStatus::Success &&
+           contentLength && buffered == contentLength;
+}
+
 void HTTPChunkBufferedSource::hold()
 {
     mutex_locker locker {lock};
@@ -432,6 +446,13 @@ void HTTPChunkBufferedSource::bufferize(size_t readsize)
     else
     {
         p_block->i_buffer = (size_t) ret;
+        /* readers will get references to the cached data */
+        p_block = SharedBlock::wrap(p_block);
+        if(!p_block)
+        {
+            eof = true;
+            return;
+        }
         mutex_locker locker {lock};
         buffered += p_block->i_buffer;
         block_ChainLastAppend(&pp_tail, p_block);
@@ -490,8 +511,10 @@ block_t * HTTPChunkBufferedSource::readBlock()
         return p_block;
     }
 
-    /* dequeue */
-    p_block = block_Duplicate(p_read);
+    /* dequeue, no copy */
+    p_block = SharedBlock::share(p_read);
+    if(!p_block)
+        return nullptr;
     consumed += p_block->i_buffer;
     p_read = p_read->p_next;
     inblockreadoffset = 0;
@@ -70,6 +70,7 @@ namespace adaptive
         class AbstractChunkSource : public ChunkInterface
         {
             friend class AbstractConnectionManager;
+            friend class SegmentCache;
 
             public:
                 const BytesRange &  getBytesRange   () const;
@@ -148,6 +149,8 @@ namespace adaptive
                 vlc_tick_t          requestStartTime;
                 vlc_tick_t          responseTime;
                 vlc_tick_t          downloadEndTime;
+                bool                cacheable;
+                vlc_tick_t          cacheExpiry;
 
             private:
                 bool init(const std::string &);
@@ -172,6 +175,7 @@ namespace adaptive
                                         bool = false);
                 void               bufferize(size_t);
                 bool               isDone() const;
+                bool               isComplete() const;
                 void               hold();
                 void               release();
 
@@ -46,6 +46,8 @@ AbstractConnection::AbstractConnection(vlc_object_t *p_object_)
     available = true;
     bytesRead = 0;
     contentLength = 0;
+    cacheable = true;
+    cacheMaxAge = VLC_TICK_INVALID;
 }
 
 AbstractConnection::~AbstractConnection()
@@ -83,6 +85,16 @@ const ConnectionParams & AbstractConnection::getRedirection() const
     return locationparams;
 }
 
+bool AbstractConnection::isCacheable() const
+{
+    return cacheable;
+}
+
+vlc_tick_t AbstractConnection::getCacheMaxAge() const
+{
+    return cacheMaxAge;
+}
+
 class adaptive::http::LibVLCHTTPSource : public adaptive::AbstractSource
 {
      friend class LibVLCHTTPConnection;
@@ -275,6 +287,8 @@ void LibVLCHTTPConnection::reset()
     contentType = std::string();
     bytesRead = 0;
     contentLength = 0;
+    cacheable = true;
+    cacheMaxAge = VLC_TICK_INVALID;
 }
 
 bool LibVLCHTTPConnection::canReuse(const ConnectionParams &params_) const
@@ -399,6 +413,35 @@ RequestStatus LibVLCHTTPConnection::request(const std::string &path,
     if(s)
         contentType = std::string(s);
 
+    /* Freshness only, as we can't revalidate */
+    const struct vlc_http_msg *resp = source->http_res->response;
+    if(vlc_http_msg_get_token(resp, "Cache-Control", "no-store") ||
+       vlc_http_msg_get_token(resp, "Cache-Control", "no-cache"))
+    {
+        cacheable = false;
+    }
+    else if((s = vlc_http_msg_get_token(resp, "Cache-Control", "max-age")))
+    {
+        s = strchr(s, '=');
+        if(s)
+        {
+            cacheMaxAge = vlc_tick_from_sec(strtoul(s + 1, nullptr, 10));
+            cacheable = (cacheMaxAge > 0);
+        }
+    }
+    else if(vlc_http_msg_get_header(resp, "Expires"))
+    {
+        /* invalid dates mean already expired */
+        time_t expires = vlc_http_msg_get_time(resp, "Expires");
+        time_t date = vlc_http_msg_get_atime(resp);
+        if(date == -1)
+            date = time(nullptr);
+        if(expires != -1 && expires > date)
+            cacheMaxAge = vlc_tick_from_sec(expires - date);
+        else
+            cacheable = false;
+    }
+
     s = vlc_http_msg_get_header(source->http_res->response, "Content-Encoding");
     if(s && stream && (strstr(s, "deflate") || strstr(s, "gzip")))
     {
@@ -449,6 +492,8 @@ void StreamUrlConnection::reset()
     contentLength = 0;
     contentType = std::string();
     bytesRange = BytesRange();
+    cacheable = true;
+    cacheMaxAge = VLC_TICK_INVALID;
 }
 
 bool StreamUrlConnection::canReuse(const ConnectionParams &params_) const
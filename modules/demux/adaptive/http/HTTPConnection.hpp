@@ -57,6 +57,8 @@ namespace adaptive
                 virtual size_t  getBytesRead() const;
                 virtual const std::string & getContentType() const;
                 virtual const ConnectionParams &getRedirection() const;
+                virtual bool    isCacheable() const;
+                virtual vlc_tick_t getCacheMaxAge() const;
                 virtual void    setUsed( bool ) = 0;
 
             protected:
@@ -68,6 +70,8 @@ namespace adaptive
                 std::string        contentType;
                 BytesRange         bytesRange;
                 size_t             bytesRead;
+                bool               cacheable;
+                vlc_tick_t         cacheMaxAge;
         };
 
        class LibVLCHTTPSource;
@@ -29,11 +29,11 @@
 #include "HTTPConnection.hpp"
 #include "ConnectionParams.hpp"
 #include "Downloader.hpp"
+#include "SegmentCache.hpp"
 #include "../tools/Debug.hpp"
 #include <vlc_url.h>
 #include <vlc_http.h>
 
-#include <cassert>
 
 using namespace adaptive::http;
 
@@ -81,22 +81,14 @@ HTTPConnectionManager::HTTPConnectionManager    (vlc_object_t *p_object_)
     downloaderhp = new Downloader();
     downloader->start();
     downloaderhp->start();
-    cache_total = 0;
-    cache_max = 1 << 19;
+    cache = nullptr;
 }
 
 HTTPConnectionManager::~HTTPConnectionManager   ()
 {
-    while(!cache.empty())
-    {
-        HTTPChunkBufferedSource *purged = cache.back();
-        cache.pop_back();
-        assert(cache_total >= purged->contentLength);
-        cache_total -= purged->contentLength;
-        CacheDebug(msg_Dbg(p_object, "Cache DEL '%s' usage %u bytes",
-                            purged->getStorageID().c_str(), cache_total));
-        deleteSource(purged);
-    }
+    /* cached sources must be released before us */
+    if(cache)
+        cache->clear();
     delete downloader;
     delete downloaderhp;
     this->closeAllConnections();
@@ -177,20 +169,14 @@ AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
     {
         case ChunkType::Init:
         case ChunkType::Index:
-            for(HTTPChunkBufferedSource *s : cache)
+        case ChunkType::Segment:
+            if(cache)
             {
-                if(s->getStorageID() == storageid)
-                {
-                    cache.remove(s);
-                    assert(cache_total >= s->contentLength);
-                    cache_total -= s->contentLength;
-                    CacheDebug(msg_Dbg(p_object, "Cache GET '%s' usage %u bytes",
-                                       storageid.c_str(), cache_total));
+                AbstractChunkSource *s = cache->get(storageid);
+                if(s)
                     return s;
-                }
             }
             // fallthrough
-        case ChunkType::Segment:
         case ChunkType::Key:
         case ChunkType::Playlist:
         default:
@@ -198,44 +184,34 @@ AbstractChunkSource *HTTPConnectionManager::makeSource(const std::string &url,
     }
 }
 
-void HTTPConnectionManager::recycleSource(AbstractChunkSource *source)
+bool HTTPConnectionManager::isCacheable(const HTTPChunkBufferedSource *source) const
 {
-    bool b_cacheable;
+    if(!source->cacheable)
+        return false;
+
     switch(source->getChunkType())
     {
         case ChunkType::Index:
         case ChunkType::Init:
-            b_cacheable = true;
-            break;
+            /* small and reused on each switch, can still be downloading */
+            return source->getRequestStatus() == RequestStatus::Success;
+        case ChunkType::Segment:
+            /* only for replay, don't keep partial or aborted downloads */
+            return source->isComplete();
         case ChunkType::Key:
         case ChunkType::Playlist:
-        case ChunkType::Segment:
         default:
-            b_cacheable = false;
-            break;
+            return false;
     }
+}
 
+void HTTPConnectionManager::recycleSource(AbstractChunkSource *source)
+{
     HTTPChunkBufferedSource *buf = dynamic_cast<HTTPChunkBufferedSource *>(source);
-    if(buf && b_cacheable && !buf->getStorageID().empty() &&
-       buf->contentLength < cache_max)
-    {
-        while(cache_max < cache_total + buf->contentLength)
-        {
-            HTTPChunkBufferedSource *purged = cache.back();
-            cache.pop_back();
-            assert(cache_total >= purged->contentLength);
-            cache_total -= purged->contentLength;
-            CacheDebug(msg_Dbg(p_object, "Cache DEL '%s' usage %u bytes",
-                               purged->getStorageID().c_str(), cache_total));
-            deleteSource(purged);
-        }
-        cache.push_front(buf);
-        cache_total += buf->contentLength;
-        CacheDebug(msg_Dbg(p_object, "Cache PUT '%s' usage %u bytes",
-                           buf->getStorageID().c_str(), cache_total));
-    }
-    else
-        deleteSource(source);
+    if(buf && cache && isCacheable(buf) &&
+       cache->put(buf, buf->contentLength, buf->cacheExpiry))
+        return;
+    deleteSource(source);
 }
 
 Downloader * HTTPConnectionManager::getDownloadQueue(const AbstractChunkSource *source) const
@@ -267,6 +243,11 @@ void HTTPConnectionManager::cancel(AbstractChunkSource *source)
         getDownloadQueue(src)->cancel(src);
 }
 
+void HTTPConnectionManager::setSegmentCache(SegmentCache *c)
+{
+    cache = c;
+}
+
 void HTTPConnectionManager::setLocalConnectionsAllowed()
 {
     localAllowed = true;
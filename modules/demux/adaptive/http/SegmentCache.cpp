@@ -0,0 +1,153 @@
+/*
+ * SegmentCache.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SegmentCache.hpp"
+#include "Chunk.h"
+#include "../tools/Debug.hpp"
+
+#include <cassert>
+
+using namespace adaptive::http;
+
+SegmentCache::Stats::Stats()
+{
+    hits = misses = expired = evictions = 0;
+    hitbytes = 0;
+}
+
+double SegmentCache::Stats::hitRate() const
+{
+    const unsigned lookups = hits + misses;
+    return lookups ? (double) hits / lookups : 0.0;
+}
+
+SegmentCache::SegmentCache(vlc_object_t *obj, size_t max)
+{
+    p_obj = obj;
+    total = 0;
+    maxsize = max;
+    vlc_mutex_init(&lock);
+}
+
+SegmentCache::~SegmentCache()
+{
+    clear();
+    if(p_obj && (stats.hits || stats.misses))
+        msg_Dbg(p_obj, "segment cache hit rate %.1f%% (%u hits, %u misses, "
+                       "%u expired, %u evicted, %" PRIu64 " KiB reused)",
+                100.0 * stats.hitRate(), stats.hits, stats.misses,
+                stats.expired, stats.evictions, stats.hitbytes / 1024);
+}
+
+AbstractChunkSource * SegmentCache::get(const StorageID &id)
+{
+    AbstractChunkSource *source = nullptr;
+    vlc_mutex_locker locker(&lock);
+    for(auto it = entries.begin(); it != entries.end(); ++it)
+    {
+        if((*it).source->getStorageID() != id)
+            continue;
+        Entry entry = *it;
+        entries.erase(it);
+        assert(total >= entry.size);
+        total -= entry.size;
+        if(entry.expiry != VLC_TICK_INVALID && entry.expiry <= vlc_tick_now())
+        {
+            CacheDebug(msg_Dbg(p_obj, "Cache EXPIRED '%s' usage %zu bytes",
+                               id.c_str(), total));
+            stats.expired++;
+            delete entry.source;
+            break;
+        }
+        CacheDebug(msg_Dbg(p_obj, "Cache GET '%s' usage %zu bytes",
+                           id.c_str(), total));
+        stats.hits++;
+        stats.hitbytes += entry.size;
+        source = entry.source;
+        break;
+    }
+    if(!source)
+        stats.misses++;
+    return source;
+}
+
+bool SegmentCache::put(AbstractChunkSource *source, size_t size, vlc_tick_t expiry)
+{
+    if(source->getStorageID().empty() || size > maxsize)
+        return false;
+
+    vlc_mutex_locker locker(&lock);
+    evict(size);
+    Entry entry;
+    entry.source = source;
+    entry.size = size;
+    entry.expiry = expiry;
+    entries.push_front(entry);
+    total += size;
+    CacheDebug(msg_Dbg(p_obj, "Cache PUT '%s' usage %zu bytes",
+                       source->getStorageID().c_str(), total));
+    return true;
+}
+
+void SegmentCache::evict(size_t size)
+{
+    while(!entries.empty() && maxsize < total + size)
+    {
+        Entry entry = entries.back();
+        entries.pop_back();
+        assert(total >= entry.size);
+        total -= entry.size;
+        CacheDebug(msg_Dbg(p_obj, "Cache DEL '%s' usage %zu bytes",
+                           entry.source->getStorageID().c_str(), total));
+        stats.evictions++;
+        delete entry.source;
+    }
+}
+
+void SegmentCache::clear()
+{
+    vlc_mutex_locker locker(&lock);
+    while(!entries.empty())
+    {
+        delete entries.back().source;
+        entries.pop_back();
+    }
+    total = 0;
+}
+
+size_t SegmentCache::getMaxSize() const
+{
+    return maxsize;
+}
+
+size_t SegmentCache::getSize() const
+{
+    vlc_mutex_locker locker(&lock);
+    return total;
+}
+
+SegmentCache::Stats SegmentCache::getStats() const
+{
+    vlc_mutex_locker locker(&lock);
+    return stats;
+}
@@ -0,0 +1,83 @@
+/*
+ * SegmentCache.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef SEGMENTCACHE_HPP
+#define SEGMENTCACHE_HPP
+
+#include <vlc_common.h>
+
+#include <list>
+#include <string>
+
+namespace adaptive
+{
+    namespace http
+    {
+        class AbstractChunkSource;
+        using StorageID = std::string;
+
+        /* LRU cache of downloaded sources, keyed by storage ID (URL and
+         * byte range) and limited by memory size.
+         * Sources are exclusively owned: get() removes them from cache
+         * until they're put back after use. */
+        class SegmentCache
+        {
+            public:
+                SegmentCache(vlc_object_t *, size_t);
+                ~SegmentCache();
+
+                AbstractChunkSource * get(const StorageID &);
+                bool put(AbstractChunkSource *, size_t, vlc_tick_t = VLC_TICK_INVALID);
+                void clear();
+                size_t getMaxSize() const;
+                size_t getSize() const;
+
+                class Stats
+                {
+                    public:
+                        Stats();
+                        unsigned hits;
+                        unsigned misses;
+                        unsigned expired;
+                        unsigned evictions;
+                        uint64_t hitbytes;
+                        double hitRate() const;
+                };
+                Stats getStats() const;
+
+            private:
+                class Entry
+                {
+                    public:
+                        AbstractChunkSource *source;
+                        size_t size;
+                        vlc_tick_t expiry;
+                };
+                void evict(size_t);
+                vlc_object_t *p_obj;
+                mutable vlc_mutex_t lock;
+                std::list<Entry> entries; /* most recently used first */
+                size_t total;
+                size_t maxsize;
+                Stats stats;
+        };
+    }
+}
+
+#endif // SEGMENTCACHE_HPP
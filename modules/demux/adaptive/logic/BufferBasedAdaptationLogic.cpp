@@ -0,0 +1,229 @@
+/*
+ * BufferBasedAdaptationLogic.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "BufferBasedAdaptationLogic.hpp"
+#include "Representationselectors.hpp"
+
+#include "../playlist/BaseAdaptationSet.h"
+#include "../playlist/BaseRepresentation.h"
+#include "../tools/Debug.hpp"
+
+#include <cmath>
+
+using namespace adaptive::logic;
+using namespace adaptive;
+
+/*
+ * Buffer occupancy based selection (BOLA-BASIC) with throughput capping
+ * on up switches (BOLA-O), robust throughput estimation and hysteresis.
+ * http://arxiv.org/abs/1601.06748
+ */
+
+const unsigned BufferBasedAdaptationLogic::SAFETY_FACTOR_PERCENT = 90;
+const unsigned BufferBasedAdaptationLogic::UPSWITCH_SEGMENTS_HYSTERESIS = 2;
+
+BufferBasedContext::BufferBasedContext()
+    : buffering_min( VLC_TICK_FROM_SEC(6) )
+    , buffering_level( 0 )
+    , buffering_target( VLC_TICK_FROM_SEC(30) )
+    , segments_since_switch( 0 )
+{ }
+
+BufferBasedAdaptationLogic::BufferBasedAdaptationLogic(vlc_object_t *obj)
+    : AbstractAdaptationLogic(obj)
+{
+    vlc_mutex_init(&lock);
+}
+
+BufferBasedAdaptationLogic::~BufferBasedAdaptationLogic()
+{
+}
+
+BaseRepresentation *
+BufferBasedAdaptationLogic::getBufferBasedRepresentation(BaseAdaptationSet *adaptSet,
+                                                         RepresentationSelector &selector,
+                                                         const BufferBasedContext &ctx) const
+{
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+
+    /* utilities are normalized so that lowest has 1 */
+    const double lowestbw = lowest->getBandwidth() ? lowest->getBandwidth() : 1;
+    const double umax = std::log(highest->getBandwidth() / lowestbw) + 1.0;
+    const double qmin = secf_from_vlc_tick(ctx.buffering_min);
+    const double qtarget = secf_from_vlc_tick(ctx.buffering_target);
+    if(umax <= 1.0 || qtarget <= qmin)
+        return nullptr;
+
+    /* lowest selected at minimum level, highest reached at target level */
+    const double gp = (umax - 1.0) / (qtarget / qmin - 1.0);
+    const double V = qmin / gp;
+    const double Q = secf_from_vlc_tick(ctx.buffering_level);
+
+    BaseRepresentation *ret = nullptr;
+    BaseRepresentation *prev = nullptr;
+    double argmax = 0;
+    for(BaseRepresentation *rep = lowest; rep && rep != prev;
+                            rep = selector.higher(adaptSet, rep))
+    {
+        const double bw = rep->getBandwidth() ? rep->getBandwidth() : 1;
+        const double utility = std::log(bw / lowestbw) + 1.0;
+        const double arg = (V * (utility + gp) - Q) / bw;
+        if(ret == nullptr || argmax <= arg)
+        {
+            ret = rep;
+            argmax = arg;
+        }
+        prev = rep;
+    }
+    return ret;
+}
+
+BaseRepresentation *BufferBasedAdaptationLogic::getNextRepresentation(BaseAdaptationSet *adaptSet,
+                                                                      BaseRepresentation *prevRep)
+{
+    RepresentationSelector selector(maxwidth, maxheight);
+
+    BaseRepresentation *lowest = selector.lowest(adaptSet);
+    BaseRepresentation *highest = selector.highest(adaptSet);
+    if(lowest == nullptr || highest == nullptr)
+        return nullptr;
+
+    if(lowest == highest)
+        return lowest;
+
+    vlc_mutex_locker locker(&lock);
+
+    std::map<ID, BufferBasedContext>::iterator it = streams.find(adaptSet->getID());
+    if(it == streams.end())
+        return lowest;
+
+    BufferBasedContext &ctx = (*it).second;
+    /* per stream estimation, no need to account for others usage */
+    const uint64_t bps = ctx.estimator.get() * SAFETY_FACTOR_PERCENT / 100;
+
+    BaseRepresentation *m;
+    if(prevRep == nullptr || ctx.estimator.getSamplesCount() < 2)
+    {
+        /* Starting, no reliable buffer or throughput history */
+        m = ctx.estimator.getSamplesCount() ? selector.select(adaptSet, bps) : lowest;
+    }
+    else if(ctx.buffering_level < ctx.buffering_min)
+    {
+        /* Low buffer, throughput based, never going up */
+        m = selector.select(adaptSet, bps);
+        if(m->getBandwidth() > prevRep->getBandwidth())
+            m = prevRep;
+    }
+    else
+    {
+        m = getBufferBasedRepresentation(adaptSet, selector, ctx);
+        if(m == nullptr)
+            m = selector.select(adaptSet, bps);
+
+        if(m->getBandwidth() > prevRep->getBandwidth())
+        {
+            /* cap up switches with sustainable throughput */
+            BaseRepresentation *mp = selector.select(adaptSet, bps);
+            if(mp->getBandwidth() < m->getBandwidth())
+                m = (mp->getBandwidth() > prevRep->getBandwidth()) ? mp : prevRep;
+            /* and don't switch up again too soon */
+            if(ctx.segments_since_switch < UPSWITCH_SEGMENTS_HYSTERESIS)
+                m = prevRep;
+        }
+        else if(m->getBandwidth() < prevRep->getBandwidth())
+        {
+            /* only drop if throughput can't sustain the current one,
+             * low buffer is already handled above */
+            if(prevRep->getBandwidth() <= bps)
+                m = prevRep;
+        }
+    }
+
+    if(m != prevRep)
+        ctx.segments_since_switch = 0;
+    else
+        ctx.segments_since_switch++;
+
+    BwDebug( msg_Info(p_obj, "buffering level %.2f%% rep %" PRIu64 " kBps estimated %" PRIu64 " kBps",
+             (float) 100 * ctx.buffering_level / ctx.buffering_target,
+             m->getBandwidth() / 8000, bps / 8000); );
+
+    return m;
+}
+
+void BufferBasedAdaptationLogic::updateDownloadRate(const ID &id, size_t dlsize,
+                                                    vlc_tick_t time, vlc_tick_t)
+{
+    vlc_mutex_locker locker(&lock);
+    std::map<ID, BufferBasedContext>::iterator it = streams.find(id);
+    if(it != streams.end())
+        (*it).second.estimator.push(dlsize, time);
+}
+
+void BufferBasedAdaptationLogic::trackerEvent(const TrackerEvent &ev)
+{
+    switch(ev.getType())
+    {
+    case TrackerEvent::Type::BufferingStateUpdate:
+        {
+            const BufferingStateUpdatedEvent &event =
+                    static_cast<const BufferingStateUpdatedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_locker locker(&lock);
+            if(event.enabled)
+            {
+                if(streams.find(id) == streams.end())
+                {
+                    BufferBasedContext ctx;
+                    streams.insert(std::pair<ID, BufferBasedContext>(id, ctx));
+                }
+            }
+            else
+            {
+                std::map<ID, BufferBasedContext>::iterator it = streams.find(id);
+                if(it != streams.end())
+                    streams.erase(it);
+            }
+            BwDebug(msg_Info(p_obj, "Stream %s is now known %sactive", id.str().c_str(),
+                             (event.enabled) ? "" : "in"));
+        }
+        break;
+
+    case TrackerEvent::Type::BufferingLevelChange:
+        {
+            const BufferingLevelChangedEvent &event =
+                    static_cast<const BufferingLevelChangedEvent &>(ev);
+            const ID &id = *event.id;
+            vlc_mutex_locker locker(&lock);
+            BufferBasedContext &ctx = streams[id];
+            ctx.buffering_level = event.current;
+            ctx.buffering_target = event.target;
+            ctx.buffering_min = event.minimum;
+        }
+        break;
+
+    default:
+        break;
+    }
+}
@@ -25,6 +25,7 @@
 #include "Segment.h"
 #include "BaseRepresentation.h"
 #include "../encryption/CommonEncryption.hpp"
+#include "../tools/SharedBlock.hpp"
 
 #include <vlc_block.h>
 
@@ -54,6 +55,10 @@ bool SegmentChunk::decrypt(block_t **pp_block)
 
     if(encryptionSession)
     {
+        /* decryption is in place, data must not be shared */
+        p_block = *pp_block = SharedBlock::makeWritable(p_block);
+        if(!p_block)
+            return false;
         bool b_last = !hasMoreData();
         p_block->i_buffer = encryptionSession->decrypt(p_block->p_buffer,
                                                        p_block->i_buffer, b_last);
@@ -40,6 +40,7 @@ SegmentList::SegmentList( SegmentInformation *parent_, bool b_relative ):
     AbstractMultipleSegmentBaseType( parent_, AttrsNode::Type::SegmentList )
 {
     totalLength = 0;
+    windowStart = std::numeric_limits<uint64_t>::max();
     b_relative_mediatimes = b_relative;
 }
 SegmentList::~SegmentList()
@@ -96,11 +97,19 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
     AbstractMultipleSegmentBaseType::updateWith(updated_);
 
     SegmentList *updated = dynamic_cast<SegmentList *>(updated_);
-    if(!updated || updated->segments.empty())
+    if(!updated)
         return;
 
     b_restamp = b_relative_mediatimes;
 
+    if(updated->segments.empty())
+    {
+        /* partial update with no new segment */
+        if(b_restamp && updated->windowStart != std::numeric_limits<uint64_t>::max())
+            pruneBySegmentNumber(updated->windowStart);
+        return;
+    }
+
     if(!b_restamp || segments.empty())
     {
         if(!segments.empty())
@@ -113,13 +122,18 @@ void SegmentList::updateWith(AbstractMultipleSegmentBaseType *updated_,
     else
     {
         const Segment * prevSegment = segments.back();
-        const uint64_t oldest = updated->segments.front()->getSequenceNumber();
+        const uint64_t oldest = (updated->windowStart != std::numeric_limits<uint64_t>::max())
+                              ? updated->windowStart
+                              : updated->segments.front()->getSequenceNumber();
 
         /* filter out known segments from the update */
         updated->pruneBySegmentNumber(prevSegment->getSequenceNumber() + 1);
 
         if(updated->segments.empty())
+        {
+            pruneBySegmentNumber(oldest);
             return;
+        }
 
         /* merge update with current list */
         for(auto it = updated->segments.begin(); it != updated->segments.end(); ++it)
@@ -168,6 +182,14 @@ void SegmentList::pruneBySegmentNumber(uint64_t tobelownum)
     }
 }
 
+void SegmentList::setWindowStartSegmentNumber(uint64_t number)
+{
+    /* Partial updates from live playlists only contain
+     * the new segments, so we need the real window start
+     * for expiring the old ones */
+    windowStart = number;
+}
+
 bool SegmentList::getPlaybackTimeDurationBySegmentNumber(uint64_t number,
                                                          vlc_tick_t *time, vlc_tick_t *dur) const
 {
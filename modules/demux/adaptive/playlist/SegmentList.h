@@ -47,6 +47,7 @@ namespace adaptive
                                                    bool = false) override;
                 void                    pruneBySegmentNumber(uint64_t);
                 void                    pruneByPlaybackTime(vlc_tick_t);
+                void                    setWindowStartSegmentNumber(uint64_t);
                 stime_t                 getTotalLength() const;
                 bool                    hasRelativeMediaTimes() const;
 
@@ -63,6 +64,7 @@ namespace adaptive
             private:
                 std::vector<Segment *>  segments;
                 stime_t totalLength;
+                uint64_t windowStart;
                 bool b_relative_mediatimes;
         };
     }
@@ -38,6 +38,7 @@ SegmentTimeline::SegmentTimeline(AbstractMultipleSegmentBaseType *parent_)
     : AttrsNode(Type::Timeline, parent_)
 {
     totalLength = 0;
+    windowStart = -1;
     parent = parent_;
 }
 
@@ -150,6 +151,15 @@ stime_t SegmentTimeline::getTotalLength() const
     return totalLength;
 }
 
+stime_t SegmentTimeline::getEndScaledTime() const
+{
+    if(elements.empty())
+        return 0;
+
+    const Element *e = elements.back();
+    return e->t + e->d * (e->r + 1);
+}
+
 uint64_t SegmentTimeline::maxElementNumber() const
 {
     if(elements.empty())
@@ -220,15 +230,31 @@ size_t SegmentTimeline::pruneBySequenceNumber(uint64_t number)
     return prunednow;
 }
 
+void SegmentTimeline::setWindowStartScaledTime(stime_t t)
+{
+    /* Set by partial updates, where the already known
+     * elements were not stored, to keep track of the
+     * availability window start */
+    windowStart = t;
+}
+
 void SegmentTimeline::updateWith(SegmentTimeline &other)
 {
+    /* expire elements no longer in the updated window */
+    if(other.windowStart >= 0 && !elements.empty() &&
+       elements.front()->t < other.windowStart)
+        pruneBySequenceNumber(getElementNumberByScaledPlaybackTime(other.windowStart));
+
     if(elements.empty())
     {
         while(other.elements.size())
         {
+            const Element *el = other.elements.front();
+            totalLength += (el->d * (el->r + 1));
             elements.push_back(other.elements.front());
             other.elements.pop_front();
         }
+        other.totalLength = 0;
         return;
     }
 
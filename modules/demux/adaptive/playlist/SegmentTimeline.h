@@ -47,17 +47,20 @@ namespace adaptive
                 stime_t getScaledPlaybackTimeByElementNumber(uint64_t) const;
                 stime_t getMinAheadScaledTime(uint64_t) const;
                 stime_t getTotalLength() const;
+                stime_t getEndScaledTime() const;
                 uint64_t maxElementNumber() const;
                 uint64_t minElementNumber() const;
                 uint64_t getElementIndexBySequence(uint64_t) const;
                 void pruneByPlaybackTime(vlc_tick_t);
                 size_t pruneBySequenceNumber(uint64_t);
+                void setWindowStartScaledTime(stime_t);
                 void updateWith(SegmentTimeline &);
                 void debug(vlc_object_t *, int = 0) const;
 
             private:
                 std::list<Element *> elements;
                 stime_t totalLength;
+                stime_t windowStart;
                 AbstractMultipleSegmentBaseType *parent;
 
                 class Element
@@ -269,6 +269,23 @@ size_t BufferedChunksSourceStream::Peek(const uint8_t **pp, size_t sz)
 {
     sz = std::min(sz, (size_t)MAX_BACKEND);
     invalidatePeek();
+
+    /* No copy if data is contiguous in a single block */
+    fillByteStream(i_bytestream_offset + sz);
+    size_t i_offset = bs.i_block_offset + i_bytestream_offset;
+    for(const block_t *p_block = bs.p_block; p_block; p_block = p_block->p_next)
+    {
+        if(i_offset < p_block->i_buffer)
+        {
+            const size_t i_avail = p_block->i_buffer - i_offset;
+            if(i_avail < sz && p_block->p_next)
+                break;
+            *pp = &p_block->p_buffer[i_offset];
+            return std::min(i_avail, sz);
+        }
+        i_offset -= p_block->i_buffer;
+    }
+
     p_peekdata = block_Alloc(sz);
     if(!p_peekdata)
         return 0;
@@ -0,0 +1,182 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../http/HTTPConnectionManager.h"
+#include "../../http/HTTPConnection.hpp"
+#include "../../http/SegmentCache.hpp"
+#include "../../http/Chunk.h"
+#include "../../ID.hpp"
+
+#include "../test.hpp"
+
+#include <vlc_block.h>
+
+#include <cstring>
+#include <map>
+
+using namespace adaptive;
+using namespace adaptive::http;
+
+/* Serves a fixed size body for any path, counting requests.
+ * Paths starting with /nostore/ are served as not cacheable. */
+class TestConnection : public AbstractConnection
+{
+    public:
+        TestConnection(std::map<std::string, unsigned> *r)
+            : AbstractConnection(nullptr), requests(r) {}
+        virtual ~TestConnection() {}
+
+        virtual bool canReuse(const ConnectionParams &) const override
+        {
+            return available;
+        }
+
+        virtual RequestStatus request(const std::string &path,
+                                      const BytesRange & = BytesRange()) override
+        {
+            (*requests)[path]++;
+            contentLength = BODY_SIZE;
+            bytesRead = 0;
+            cacheable = (path.find("/nostore/") != 0);
+            cacheMaxAge = VLC_TICK_INVALID;
+            return RequestStatus::Success;
+        }
+
+        virtual ssize_t read(void *p_buffer, size_t len) override
+        {
+            if(len > contentLength - bytesRead)
+                len = contentLength - bytesRead;
+            memset(p_buffer, 0x47, len);
+            bytesRead += len;
+            return len;
+        }
+
+        virtual void setUsed(bool b) override
+        {
+            available = !b;
+        }
+
+        static const size_t BODY_SIZE = 100000;
+
+    private:
+        std::map<std::string, unsigned> *requests;
+};
+
+class TestConnectionFactory : public AbstractConnectionFactory
+{
+    public:
+        TestConnectionFactory(std::map<std::string, unsigned> *r)
+            : requests(r) {}
+        virtual ~TestConnectionFactory() {}
+        virtual AbstractConnection * createConnection(vlc_object_t *,
+                                                      const ConnectionParams &) override
+        {
+            return new TestConnection(requests);
+        }
+
+    private:
+        std::map<std::string, unsigned> *requests;
+};
+
+static size_t Fetch(HTTPConnectionManager *manager, const std::string &path,
+                    ChunkType type = ChunkType::Segment)
+{
+    HTTPChunk chunk("http://example.com" + path, manager, ID("set"), type, BytesRange());
+    size_t total = 0;
+    block_t *p_block;
+    while((p_block = chunk.readBlock()))
+    {
+        total += p_block->i_buffer;
+        block_Release(p_block);
+    }
+    return total;
+}
+
+static unsigned Total(const std::map<std::string, unsigned> &requests)
+{
+    unsigned total = 0;
+    for(const auto &r : requests)
+        total += r.second;
+    return total;
+}
+
+int SegmentCache_test()
+{
+    std::map<std::string, unsigned> requests;
+    HTTPConnectionManager *manager = nullptr;
+    SegmentCache *cache = nullptr;
+    try
+    {
+        manager = new HTTPConnectionManager(nullptr);
+        manager->addFactory(new TestConnectionFactory(&requests));
+        /* room for 8 segments */
+        cache = new SegmentCache(nullptr, 8 * TestConnection::BODY_SIZE);
+        manager->setSegmentCache(cache);
+
+        /* Init segments are reused on each switch */
+        Expect(Fetch(manager, "/init", ChunkType::Init) == TestConnection::BODY_SIZE);
+        Expect(Fetch(manager, "/init", ChunkType::Init) == TestConnection::BODY_SIZE);
+        Expect(requests["/init"] == 1);
+
+        /* Linear playback */
+        for(int i=0; i<10; i++)
+            Expect(Fetch(manager, "/seg" + std::to_string(i)) == TestConnection::BODY_SIZE);
+        Expect(Total(requests) == 11);
+
+        /* Seek back within the cache budget */
+        for(int i=4; i<10; i++)
+            Expect(Fetch(manager, "/seg" + std::to_string(i)) == TestConnection::BODY_SIZE);
+        Expect(Total(requests) == 11);
+
+        /* Seek back further than the budget, LRU were evicted */
+        for(int i=0; i<2; i++)
+            Expect(Fetch(manager, "/seg" + std::to_string(i)) == TestConnection::BODY_SIZE);
+        Expect(Total(requests) == 13);
+        Expect(cache->getSize() <= cache->getMaxSize());
+
+        /* Cache-Control: no-store */
+        Expect(Fetch(manager, "/nostore/seg") == TestConnection::BODY_SIZE);
+        Expect(Fetch(manager, "/nostore/seg") == TestConnection::BODY_SIZE);
+        Expect(requests["/nostore/seg"] == 2);
+
+        SegmentCache::Stats stats = cache->getStats();
+        std::cerr << "  segment cache hit rate " << (unsigned)(100 * stats.hitRate())
+                  << "% (" << stats.hits << " hits, " << stats.misses << " misses, "
+                  << stats.evictions << " evicted), "
+                  << Total(requests) << " requests for 21 fetches" << std::endl;
+        Expect(stats.hits == 7);
+        Expect(stats.evictions > 0);
+
+        cache->clear();
+        delete manager;
+        delete cache;
+    } catch(...) {
+        if(cache)
+            cache->clear();
+        delete manager;
+        delete cache;
+        return 1;
+    }
+
+    return 0;
+}
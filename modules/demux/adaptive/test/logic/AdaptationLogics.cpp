@@ -0,0 +1,270 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../playlist/BasePlaylist.hpp"
+#include "../../playlist/BasePeriod.h"
+#include "../../playlist/BaseAdaptationSet.h"
+#include "../../playlist/BaseRepresentation.h"
+#include "../../logic/BufferingLogic.hpp"
+#include "../../logic/BufferBasedAdaptationLogic.hpp"
+#include "../../logic/NearOptimalAdaptationLogic.hpp"
+#include "../../logic/PredictiveAdaptationLogic.hpp"
+#include "../../logic/RateBasedAdaptationLogic.h"
+#include "../../SegmentTracker.hpp"
+#include "../../tools/ThroughputEstimator.hpp"
+
+#include "../test.hpp"
+
+#include <memory>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::playlist;
+using namespace logic;
+
+/*
+ * Trace driven playback simulation: segments are downloaded sequentially
+ * with the bandwidth from a repeating trace, while the buffer is drained
+ * in real time once playback has started.
+ */
+
+namespace
+{
+    class SimulatedPlaylist : public BasePlaylist
+    {
+        public:
+            SimulatedPlaylist() : BasePlaylist(nullptr) {}
+            virtual ~SimulatedPlaylist() {}
+            virtual bool isLive() const override { return false; }
+            virtual bool isLowLatency() const override { return false; }
+    };
+
+    struct TracePoint
+    {
+        vlc_tick_t duration;
+        uint64_t bps;
+    };
+
+    class Trace
+    {
+        public:
+            Trace(const std::vector<TracePoint> &p) : points(p)
+            {
+                period = 0;
+                for(const TracePoint &pt : points)
+                    period += pt.duration;
+            }
+
+            /* returns the time needed to download size bytes from time */
+            vlc_tick_t downloadTime(vlc_tick_t time, uint64_t size) const
+            {
+                vlc_tick_t elapsed = 0;
+                double bits = size * 8.0;
+                vlc_tick_t offset = time % period;
+                size_t i = 0;
+                while(offset >= points[i].duration)
+                    offset -= points[i++].duration;
+                for(;;)
+                {
+                    const TracePoint &pt = points[i];
+                    const vlc_tick_t remain = pt.duration - offset;
+                    const double avail = (double) pt.bps * remain / CLOCK_FREQ;
+                    if(avail >= bits)
+                        return elapsed + bits * CLOCK_FREQ / pt.bps;
+                    bits -= avail;
+                    elapsed += remain;
+                    offset = 0;
+                    i = (i + 1) % points.size();
+                }
+            }
+
+        private:
+            std::vector<TracePoint> points;
+            vlc_tick_t period;
+    };
+
+    struct SimulationResult
+    {
+        vlc_tick_t rebuffering;
+        uint64_t averagebps;
+        unsigned switches;
+    };
+}
+
+static SimulationResult Simulate(AbstractAdaptationLogic *logic, BaseAdaptationSet *set,
+                                 const Trace &trace, unsigned segmentscount)
+{
+    const vlc_tick_t segmentduration = VLC_TICK_FROM_SEC(2);
+    const vlc_tick_t minbuffering = AbstractBufferingLogic::DEFAULT_MIN_BUFFERING;
+    const vlc_tick_t maxbuffering = AbstractBufferingLogic::DEFAULT_MAX_BUFFERING;
+
+    SimulationResult result = { 0, 0, 0 };
+    const ID &id = set->getID();
+    BaseRepresentation *prev = nullptr;
+    vlc_tick_t now = 0;
+    vlc_tick_t buffer = 0;
+    bool playing = false;
+    uint64_t totalbits = 0;
+
+    logic->trackerEvent(BufferingStateUpdatedEvent(id, true));
+    logic->trackerEvent(BufferingLevelChangedEvent(id, minbuffering, maxbuffering,
+                                                   buffer, maxbuffering));
+
+    for(unsigned i=0; i<segmentscount; i++)
+    {
+        BaseRepresentation *rep = logic->getNextRepresentation(set, prev);
+        if(rep != prev)
+        {
+            logic->trackerEvent(RepresentationSwitchEvent(prev, rep));
+            if(prev)
+                result.switches++;
+            prev = rep;
+        }
+
+        const uint64_t size = rep->getBandwidth() * SEC_FROM_VLC_TICK(segmentduration) / 8;
+        const vlc_tick_t dltime = trace.downloadTime(now, size);
+        now += dltime;
+        if(playing)
+        {
+            if(buffer >= dltime)
+            {
+                buffer -= dltime;
+            }
+            else
+            {
+                result.rebuffering += dltime - buffer;
+                buffer = 0;
+            }
+        }
+        buffer += segmentduration;
+        totalbits += rep->getBandwidth() * SEC_FROM_VLC_TICK(segmentduration);
+        if(!playing && buffer >= minbuffering)
+            playing = true;
+
+        /* no download while buffer is full */
+        if(buffer > maxbuffering)
+        {
+            now += buffer - maxbuffering;
+            buffer = maxbuffering;
+        }
+
+        logic->updateDownloadRate(id, size, dltime, 0);
+        logic->trackerEvent(SegmentChangedEvent(id, i, VLC_TICK_INVALID,
+                                                segmentduration * i, segmentduration));
+        logic->trackerEvent(BufferingLevelChangedEvent(id, minbuffering, maxbuffering,
+                                                       buffer, maxbuffering));
+    }
+
+    result.averagebps = totalbits / (segmentscount * SEC_FROM_VLC_TICK(segmentduration));
+    return result;
+}
+
+static SimulationResult SimulateLogic(const char *name, AbstractAdaptationLogic *logic,
+                                      BaseAdaptationSet *set, const char *tracename,
+                                      const Trace &trace)
+{
+    SimulationResult result = Simulate(logic, set, trace, 150);
+    std::cerr << "  " << tracename << " trace, " << name
+              << ": rebuffering " << MS_FROM_VLC_TICK(result.rebuffering) << "ms"
+              << ", average bitrate " << result.averagebps / 1000 << "kbps"
+              << ", switches " << result.switches << std::endl;
+    return result;
+}
+
+int AdaptationLogics_test()
+{
+    SimulatedPlaylist *playlist = nullptr;
+    try
+    {
+        /* Estimator */
+        ThroughputEstimator estimator;
+        Expect(estimator.get() == 0);
+        for(int i=0; i<10; i++)
+            estimator.push(500000, VLC_TICK_FROM_SEC(1));
+        Expect(estimator.get() > 3900000 && estimator.get() <= 4000000);
+        estimator.push(5000000, VLC_TICK_FROM_SEC(1)); /* burst is filtered out */
+        Expect(estimator.get() <= 4000000);
+        for(int i=0; i<3; i++) /* sudden drop is followed */
+            estimator.push(50000, VLC_TICK_FROM_SEC(2));
+        Expect(estimator.get() < 2000000);
+
+        playlist = new SimulatedPlaylist();
+        BasePeriod *period = new BasePeriod(playlist);
+        playlist->addPeriod(period);
+        BaseAdaptationSet *set = new BaseAdaptationSet(period);
+        period->addAdaptationSet(set);
+        set->setID(ID("video"));
+        const uint64_t bandwidths[] = { 300000, 750000, 1500000, 3000000, 6000000 };
+        for(size_t i=0; i<ARRAY_SIZE(bandwidths); i++)
+        {
+            BaseRepresentation *rep = new BaseRepresentation(set);
+            rep->setBandwidth(bandwidths[i]);
+            set->addRepresentation(rep);
+        }
+
+        const Trace stable({ { VLC_TICK_FROM_SEC(1), 4000000 } });
+        const Trace bursty({ { VLC_TICK_FROM_MS(500), 12000000 },
+                             { VLC_TICK_FROM_MS(1500), 1600000 },
+                             { VLC_TICK_FROM_MS(300), 9000000 },
+                             { VLC_TICK_FROM_MS(2700), 1800000 } });
+        const Trace drop({ { VLC_TICK_FROM_SEC(90), 8000000 },
+                           { VLC_TICK_FROM_SEC(90), 1000000 } });
+
+        const struct
+        {
+            const char *name;
+            const Trace *trace;
+        } traces[] = { { "stable", &stable }, { "bursty", &bursty }, { "drop", &drop } };
+
+        for(size_t i=0; i<ARRAY_SIZE(traces); i++)
+        {
+            std::unique_ptr<AbstractAdaptationLogic> logic;
+            logic = std::make_unique<RateBasedAdaptationLogic>(nullptr);
+            SimulateLogic("rate", logic.get(), set, traces[i].name, *traces[i].trace);
+            logic = std::make_unique<PredictiveAdaptationLogic>(nullptr);
+            SimulateLogic("predictive", logic.get(), set, traces[i].name, *traces[i].trace);
+            logic = std::make_unique<NearOptimalAdaptationLogic>(nullptr);
+            SimulateLogic("nearoptimal", logic.get(), set, traces[i].name, *traces[i].trace);
+            logic = std::make_unique<BufferBasedAdaptationLogic>(nullptr);
+            const SimulationResult buffer =
+                SimulateLogic("buffer", logic.get(), set, traces[i].name, *traces[i].trace);
+
+            Expect(buffer.rebuffering == 0);
+            Expect(buffer.switches <= 10);
+            Expect(buffer.averagebps >= bandwidths[1]);
+        }
+
+        /* must settle below the link capacity */
+        BufferBasedAdaptationLogic logic(nullptr);
+        const SimulationResult result = Simulate(&logic, set, stable, 150);
+        Expect(result.averagebps < 4000000);
+        Expect(result.switches <= 4);
+
+        delete playlist;
+    } catch(...) {
+        delete playlist;
+        return 1;
+    }
+
+    return 0;
+}
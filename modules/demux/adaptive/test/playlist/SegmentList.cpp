@@ -200,6 +200,39 @@ int SegmentList_test() try
     segmentList.reset();
     segmentList2.reset();
 
+    /* partial updates, relative timings */
+    segmentList = std::make_unique<SegmentList>(nullptr, true);
+    segmentList->addAttribute(new TimescaleAttr(timescale));
+    for(int i=0; i<4; i++)
+    {
+        seg = std::make_unique<Segment>(nullptr);
+        seg->setSequenceNumber(123 + i);
+        seg->startTime.Set(START + 100 * i);
+        seg->duration.Set(100);
+        segmentList->addSegment(seg.release());
+    }
+    segmentList2 = std::make_unique<SegmentList>(nullptr, true);
+    segmentList2->setWindowStartSegmentNumber(125);
+    seg = std::make_unique<Segment>(nullptr);
+    seg->setSequenceNumber(127);
+    seg->duration.Set(100);
+    segmentList2->addSegment(seg.release());
+    segmentList->updateWith(segmentList2.get());
+    Expect(segmentList->getSegments().size() == 3);
+    Expect(segmentList->getStartSegmentNumber() == 125);
+    Expect(segmentList->getSegments().back()->getSequenceNumber() == 127);
+    Expect(segmentList->getSegments().back()->startTime.Get() == START + 100 * 4);
+    Expect(segmentList->getTotalLength() == 100 * 3);
+
+    segmentList2 = std::make_unique<SegmentList>(nullptr, true);
+    segmentList2->setWindowStartSegmentNumber(127);
+    segmentList->updateWith(segmentList2.get());
+    Expect(segmentList->getSegments().size() == 1);
+    Expect(segmentList->getStartSegmentNumber() == 127);
+
+    segmentList.reset();
+    segmentList2.reset();
+
     /* gap updates, absolute media timings */
     segmentList = std::make_unique<SegmentList>(nullptr, false);
     segmentList->addAttribute(new TimescaleAttr(timescale));
@@ -170,6 +170,25 @@ int Timeline_test()
         timeline->updateWith(*timeline2);
         Expect(timeline->maxElementNumber() == 4+99+10);
 
+        /* Partial update, only new elements and window start */
+        delete timeline2;
+        timeline2 = new SegmentTimeline(nullptr);
+        Expect(timeline->getEndScaledTime() == START+1000 + 2000 * 2 + 2 * 110);
+        timeline2->setWindowStartScaledTime(START+1000 + 2000 * 2 + 2 * 50);
+        timeline2->addElement(0, 2, 4, START+1000 + 2000 * 2 + 2 * 110);
+        timeline->updateWith(*timeline2);
+        Expect(timeline->minElementNumber() == 4+50);
+        Expect(timeline->maxElementNumber() == 4+109+5);
+        Expect(timeline->getTotalLength() == 2 * (110 - 50 + 5));
+
+        /* Partial update, no new elements */
+        delete timeline2;
+        timeline2 = new SegmentTimeline(nullptr);
+        timeline2->setWindowStartScaledTime(START+1000 + 2000 * 2 + 2 * 100);
+        timeline->updateWith(*timeline2);
+        Expect(timeline->minElementNumber() == 4+100);
+        Expect(timeline->maxElementNumber() == 4+109+5);
+
         delete timeline;
         delete timeline2;
 
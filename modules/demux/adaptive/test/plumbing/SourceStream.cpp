@@ -0,0 +1,391 @@
+/*****************************************************************************
+ *
+ *****************************************************************************
+ * Copyright (C) 2026 VideoLabs, VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../plumbing/SourceStream.hpp"
+#include "../../tools/SharedBlock.hpp"
+#include "../../AbstractSource.hpp"
+#include "../../http/HTTPConnectionManager.h"
+#include "../../http/HTTPConnection.hpp"
+#include "../../http/Chunk.h"
+#include "../../ID.hpp"
+
+#include "../test.hpp"
+
+#include <vlc_block.h>
+
+#include <cstring>
+#include <list>
+#include <vector>
+
+using namespace adaptive;
+using namespace adaptive::http;
+
+/* Downloaded data cache, handing out
+ * shared references to its blocks */
+class TestSource : public AbstractSource
+{
+    public:
+        TestSource(size_t blocksize, unsigned count)
+        {
+            for(unsigned i=0; i<count; i++)
+            {
+                block_t *p_block = block_Alloc(blocksize);
+                if(!p_block)
+                    throw 1;
+                for(size_t j=0; j<blocksize; j++)
+                    p_block->p_buffer[j] = (i * blocksize + j) % 251;
+                p_block = SharedBlock::wrap(p_block);
+                if(!p_block)
+                    throw 1;
+                cache.push_back(p_block);
+            }
+            it = cache.begin();
+        }
+
+        virtual ~TestSource()
+        {
+            for(block_t *p_block : cache)
+                block_Release(p_block);
+        }
+
+        virtual block_t *readNextBlock() override
+        {
+            if(it == cache.end())
+                return nullptr;
+            return SharedBlock::share(*it++);
+        }
+
+        bool contains(const uint8_t *p) const
+        {
+            for(const block_t *p_block : cache)
+                if(p >= p_block->p_buffer && p < p_block->p_buffer + p_block->i_buffer)
+                    return true;
+            return false;
+        }
+
+    private:
+        std::list<block_t *> cache;
+        std::list<block_t *>::const_iterator it;
+};
+
+class TestSourceStream : public BufferedChunksSourceStream
+{
+    public:
+        TestSourceStream(AbstractSource *source)
+            : BufferedChunksSourceStream(nullptr, source) {}
+        using BufferedChunksSourceStream::Read;
+        using BufferedChunksSourceStream::Seek;
+        using BufferedChunksSourceStream::Peek;
+};
+
+static bool CheckPattern(const uint8_t *p, size_t size, uint64_t offset)
+{
+    for(size_t i=0; i<size; i++)
+        if(p[i] != (offset + i) % 251)
+            return false;
+    return true;
+}
+
+static int SharedBlock_test()
+{
+    block_t *p_block = nullptr;
+    block_t *p_ref = nullptr;
+    try
+    {
+        p_block = SharedBlock::wrap(block_Alloc(100));
+        Expect(p_block);
+        memset(p_block->p_buffer, 0x42, p_block->i_buffer);
+        p_block->i_pts = VLC_TICK_0 + 1;
+        Expect(!SharedBlock::isShared(p_block));
+
+        p_ref = SharedBlock::share(p_block);
+        Expect(p_ref);
+        Expect(p_ref->p_buffer == p_block->p_buffer);
+        Expect(p_ref->i_buffer == 100);
+        Expect(p_ref->i_pts == VLC_TICK_0 + 1);
+        Expect(SharedBlock::isShared(p_block));
+        Expect(SharedBlock::isShared(p_ref));
+
+        /* consuming a reference does not affect others */
+        p_ref->p_buffer += 10;
+        p_ref->i_buffer -= 10;
+        Expect(p_block->i_buffer == 100);
+
+        /* sharing references only the remaining payload */
+        block_t *p_ref2 = SharedBlock::share(p_ref);
+        Expect(p_ref2);
+        Expect(p_ref2->p_buffer == p_block->p_buffer + 10);
+        Expect(p_ref2->i_buffer == 90);
+        /* no room to grow in place */
+        p_ref2 = block_Realloc(p_ref2, 0, 95);
+        Expect(p_ref2);
+        Expect(p_ref2->p_buffer != p_block->p_buffer + 10);
+        block_Release(p_ref2);
+
+        /* copy on write */
+        const uint8_t *p_shared = p_ref->p_buffer;
+        p_ref = SharedBlock::makeWritable(p_ref);
+        Expect(p_ref);
+        Expect(p_ref->p_buffer != p_shared);
+        Expect(p_ref->i_buffer == 90);
+        Expect(p_ref->p_buffer[0] == 0x42);
+        Expect(!SharedBlock::isShared(p_block));
+        block_Release(p_ref);
+
+        p_ref = SharedBlock::share(p_block);
+        Expect(p_ref);
+        block_Release(p_block);
+        p_block = nullptr;
+        /* last reference keeps data alive */
+        Expect(!SharedBlock::isShared(p_ref));
+        Expect(p_ref->p_buffer[99] == 0x42);
+        Expect(SharedBlock::makeWritable(p_ref) == p_ref);
+        block_Release(p_ref);
+        p_ref = nullptr;
+    } catch(...) {
+        if(p_block)
+            block_Release(p_block);
+        if(p_ref)
+            block_Release(p_ref);
+        return 1;
+    }
+    return 0;
+}
+
+static int SourceStreamData_test()
+{
+    try
+    {
+        TestSource source(1000, 10);
+        TestSourceStream stream(&source);
+
+        const uint8_t *p_peek;
+        /* contiguous peek is from source data */
+        Expect(stream.Peek(&p_peek, 500) == 500);
+        Expect(source.contains(p_peek));
+        Expect(CheckPattern(p_peek, 500, 0));
+
+        uint8_t buf[1500];
+        Expect(stream.Read(buf, 800) == 800);
+        Expect(CheckPattern(buf, 800, 0));
+
+        /* peek spanning blocks */
+        Expect(stream.Peek(&p_peek, 1500) == 1500);
+        Expect(!source.contains(p_peek));
+        Expect(CheckPattern(p_peek, 1500, 800));
+
+        Expect(stream.Read(buf, 1500) == 1500);
+        Expect(CheckPattern(buf, 1500, 800));
+
+        Expect(stream.Seek(100) == VLC_SUCCESS);
+        Expect(stream.Read(buf, 1000) == 1000);
+        Expect(CheckPattern(buf, 1000, 100));
+
+        Expect(stream.Seek(9900) == VLC_SUCCESS);
+        Expect(stream.Peek(&p_peek, 500) == 100);
+        Expect(source.contains(p_peek));
+        Expect(CheckPattern(p_peek, 100, 9900));
+        Expect(stream.Read(buf, 500) == 100);
+        Expect(stream.Read(buf, 500) == 0);
+    } catch(...) {
+        return 1;
+    }
+    return 0;
+}
+
+/* Where each downloaded part was written to,
+ * filled from the downloader thread */
+class DownloadLog
+{
+    public:
+        void add(const uint8_t *p)
+        {
+            vlc::threads::mutex_locker locker {lock};
+            buffers.push_back(p);
+        }
+
+        const uint8_t *get(size_t i) const
+        {
+            vlc::threads::mutex_locker locker {lock};
+            return i < buffers.size() ? buffers[i] : nullptr;
+        }
+
+        size_t count() const
+        {
+            vlc::threads::mutex_locker locker {lock};
+            return buffers.size();
+        }
+
+        void clear()
+        {
+            vlc::threads::mutex_locker locker {lock};
+            buffers.clear();
+        }
+
+    private:
+        mutable vlc::threads::mutex lock;
+        std::vector<const uint8_t *> buffers;
+};
+
+/* Serves the test pattern, logging the downloads */
+class PatternConnection : public AbstractConnection
+{
+    public:
+        PatternConnection(size_t size, DownloadLog *w)
+            : AbstractConnection(nullptr), size(size), writes(w) {}
+        virtual ~PatternConnection() {}
+
+        virtual bool canReuse(const ConnectionParams &) const override
+        {
+            return available;
+        }
+
+        virtual RequestStatus request(const std::string &,
+                                      const BytesRange & = BytesRange()) override
+        {
+            contentLength = size;
+            bytesRead = 0;
+            return RequestStatus::Success;
+        }
+
+        virtual ssize_t read(void *p_buffer, size_t len) override
+        {
+            if(len > contentLength - bytesRead)
+                len = contentLength - bytesRead;
+            uint8_t *p = static_cast<uint8_t *>(p_buffer);
+            for(size_t i=0; i<len; i++)
+                p[i] = (bytesRead + i) % 251;
+            if(len)
+                writes->add(p);
+            bytesRead += len;
+            return len;
+        }
+
+        virtual void setUsed(bool b) override
+        {
+            available = !b;
+        }
+
+    private:
+        size_t size;
+        DownloadLog *writes;
+};
+
+class PatternConnectionFactory : public AbstractConnectionFactory
+{
+    public:
+        PatternConnectionFactory(size_t size, DownloadLog *w)
+            : size(size), writes(w) {}
+        virtual ~PatternConnectionFactory() {}
+        virtual AbstractConnection * createConnection(vlc_object_t *,
+                                                      const ConnectionParams &) override
+        {
+            return new PatternConnection(size, writes);
+        }
+
+    private:
+        size_t size;
+        DownloadLog *writes;
+};
+
+class ChunkSource : public AbstractSource
+{
+    public:
+        ChunkSource(AbstractChunk *chunk) : chunk(chunk) {}
+        virtual ~ChunkSource() {}
+        virtual block_t *readNextBlock() override
+        {
+            return chunk->readBlock();
+        }
+
+    private:
+        AbstractChunk *chunk;
+};
+
+static int SourceStreamHandOff_test()
+{
+    const size_t size = 4 * HTTPChunkSource::CHUNK_SIZE + 1000;
+    DownloadLog writes;
+    HTTPConnectionManager *manager = nullptr;
+    block_t *p_block = nullptr;
+    try
+    {
+        manager = new HTTPConnectionManager(nullptr);
+        manager->addFactory(new PatternConnectionFactory(size, &writes));
+
+        {
+            /* downloaded blocks reach the reader as is */
+            HTTPChunk chunk("http://example.com/seg", manager, ID("set"),
+                            ChunkType::Segment, BytesRange());
+            size_t total = 0;
+            unsigned count = 0;
+            while((p_block = chunk.readBlock()))
+            {
+                if(p_block->i_buffer)
+                {
+                    Expect(p_block->p_buffer == writes.get(count));
+                    /* the chunk cache still references the data */
+                    Expect(SharedBlock::isShared(p_block));
+                    Expect(CheckPattern(p_block->p_buffer, p_block->i_buffer, total));
+                    total += p_block->i_buffer;
+                    count++;
+                }
+                block_Release(p_block);
+            }
+            Expect(total == size);
+            Expect(count == writes.count());
+
+            /* and through the source stream, peeks point to the downloaded data */
+            writes.clear();
+            HTTPChunk chunk2("http://example.com/seg", manager, ID("set"),
+                             ChunkType::Segment, BytesRange());
+            ChunkSource source(&chunk2);
+            TestSourceStream stream(&source);
+            const uint8_t *p_peek;
+            Expect(stream.Peek(&p_peek, 1000) == 1000);
+            Expect(p_peek == writes.get(0));
+
+            uint8_t buf[1000];
+            Expect(stream.Read(buf, 1000) == 1000);
+            Expect(CheckPattern(buf, 1000, 0));
+            Expect(stream.Seek(HTTPChunkSource::CHUNK_SIZE) == VLC_SUCCESS);
+            Expect(stream.Peek(&p_peek, 1000) == 1000);
+            Expect(p_peek == writes.get(1));
+        }
+
+        delete manager;
+    } catch(...) {
+        if(p_block)
+            block_Release(p_block);
+        delete manager;
+        return 1;
+    }
+    return 0;
+}
+
+int SourceStream_test()
+{
+    return SharedBlock_test() ||
+           SourceStreamData_test() ||
+           SourceStreamHandOff_test();
+}
@@ -46,7 +46,10 @@ int main()
     TEST(Conversions) ||
     TEST(TemplatedUri) ||
     TEST(BufferingLogic) ||
+    TEST(AdaptationLogics) ||
     TEST(CommandsQueue) ||
+    TEST(SourceStream) ||
+    TEST(SegmentCache) ||
     TEST(M3U8MasterPlaylist) ||
     TEST(M3U8Playlist) ||
     TEST(SegmentTracker)
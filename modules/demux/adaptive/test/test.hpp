@@ -46,7 +46,10 @@ int Conversions_test();
 int M3U8MasterPlaylist_test();
 int M3U8Playlist_test();
 int CommandsQueue_test();
+int SourceStream_test();
+int SegmentCache_test();
 int BufferingLogic_test();
+int AdaptationLogics_test();
 int FakeEsOut_test();
 int SegmentTracker_test();
 
@@ -0,0 +1,132 @@
+/*
+ * SharedBlock.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "SharedBlock.hpp"
+
+#include <vlc_block.h>
+#include <vlc_atomic.h>
+
+#include <new>
+
+using namespace adaptive;
+
+namespace
+{
+    struct shared_data_t
+    {
+        vlc_atomic_rc_t rc;
+        block_t *p_data;
+    };
+
+    struct shared_block_t
+    {
+        block_t self;
+        shared_data_t *p_shared;
+    };
+
+    void shared_block_Release(block_t *p_block)
+    {
+        shared_block_t *p_sb = container_of(p_block, shared_block_t, self);
+        if(vlc_atomic_rc_dec(&p_sb->p_shared->rc))
+        {
+            block_Release(p_sb->p_shared->p_data);
+            delete p_sb->p_shared;
+        }
+        delete p_sb;
+    }
+
+    const struct vlc_block_callbacks shared_block_cbs =
+    {
+        shared_block_Release,
+    };
+
+    block_t * shared_block_New(shared_data_t *p_shared, const block_t *p_from)
+    {
+        shared_block_t *p_sb = new (std::nothrow) shared_block_t;
+        if(!p_sb)
+            return nullptr;
+        p_sb->p_shared = p_shared;
+        /* Only the current payload is referenced. Without
+         * head or tail room, any realloc will reallocate */
+        block_Init(&p_sb->self, &shared_block_cbs,
+                   p_from->p_buffer, p_from->i_buffer);
+        block_CopyProperties(&p_sb->self, p_from);
+        return &p_sb->self;
+    }
+}
+
+block_t * SharedBlock::wrap(block_t *p_block)
+{
+    if(p_block == nullptr || p_block->cbs == &shared_block_cbs)
+        return p_block;
+
+    shared_data_t *p_shared = new (std::nothrow) shared_data_t;
+    if(!p_shared)
+    {
+        block_Release(p_block);
+        return nullptr;
+    }
+    vlc_atomic_rc_init(&p_shared->rc);
+    p_shared->p_data = p_block;
+
+    block_t *p_sb = shared_block_New(p_shared, p_block);
+    if(!p_sb)
+    {
+        delete p_shared;
+        block_Release(p_block);
+    }
+    return p_sb;
+}
+
+block_t * SharedBlock::share(const block_t *p_block)
+{
+    if(p_block->cbs != &shared_block_cbs)
+        return block_Duplicate(p_block);
+
+    const shared_block_t *p_sb = container_of(p_block, shared_block_t, self);
+    vlc_atomic_rc_inc(&p_sb->p_shared->rc);
+    block_t *p_ref = shared_block_New(p_sb->p_shared, p_block);
+    if(!p_ref && vlc_atomic_rc_dec(&p_sb->p_shared->rc))
+    {
+        block_Release(p_sb->p_shared->p_data);
+        delete p_sb->p_shared;
+    }
+    return p_ref;
+}
+
+bool SharedBlock::isShared(const block_t *p_block)
+{
+    if(p_block->cbs != &shared_block_cbs)
+        return false;
+    const shared_block_t *p_sb = container_of(p_block, shared_block_t, self);
+    return vlc_atomic_rc_get(&p_sb->p_shared->rc) > 1;
+}
+
+block_t * SharedBlock::makeWritable(block_t *p_block)
+{
+    if(!isShared(p_block))
+        return p_block;
+    block_t *p_copy = block_Duplicate(p_block);
+    block_Release(p_block);
+    return p_copy;
+}
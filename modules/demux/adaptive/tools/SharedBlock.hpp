@@ -0,0 +1,41 @@
+/*
+ * SharedBlock.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN and VLC Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef SHAREDBLOCK_HPP
+#define SHAREDBLOCK_HPP
+
+#include <vlc_common.h>
+
+namespace adaptive
+{
+    /* Blocks referencing a single refcounted data block.
+     * Payload of shared blocks is read only, use makeWritable()
+     * before any in place modification. Shared blocks can't grow
+     * in place, so realloc will always copy. */
+    class SharedBlock
+    {
+        public:
+            static block_t * wrap(block_t *);
+            static block_t * share(const block_t *);
+            static bool      isShared(const block_t *);
+            static block_t * makeWritable(block_t *);
+    };
+}
+
+#endif // SHAREDBLOCK_HPP
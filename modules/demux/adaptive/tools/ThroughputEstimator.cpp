@@ -0,0 +1,90 @@
+/*
+ * ThroughputEstimator.cpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "ThroughputEstimator.hpp"
+
+#include <algorithm>
+#include <vector>
+
+using namespace adaptive;
+
+ThroughputEstimator::ThroughputEstimator(unsigned maxsamples_, unsigned percentile_,
+                                         unsigned recentsamples_)
+{
+    maxsamples = std::max(maxsamples_, 1U);
+    percentile = std::min(percentile_, 100U);
+    recentsamples = std::max(std::min(recentsamples_, maxsamples), 1U);
+    reset();
+}
+
+void ThroughputEstimator::reset()
+{
+    samples.clear();
+    estimate = 0;
+}
+
+uint64_t ThroughputEstimator::push(size_t size, vlc_tick_t time)
+{
+    if(unlikely(time <= 0))
+        return estimate;
+
+    Sample sample;
+    sample.size = size;
+    sample.time = time;
+    sample.bps = CLOCK_FREQ * size * 8 / time;
+
+    samples.push_back(sample);
+    if(samples.size() > maxsamples)
+        samples.pop_front();
+
+    std::vector<uint64_t> sorted;
+    sorted.reserve(samples.size());
+    for(const Sample &s : samples)
+        sorted.push_back(s.bps);
+    const size_t index = (sorted.size() - 1) * percentile / 100;
+    std::nth_element(sorted.begin(), sorted.begin() + index, sorted.end());
+
+    /* size weighted harmonic mean is total size over total time */
+    uint64_t recentsize = 0;
+    vlc_tick_t recenttime = 0;
+    const size_t count = std::min(samples.size(), (size_t) recentsamples);
+    for(auto it = samples.rbegin(); it != samples.rbegin() + count; ++it)
+    {
+        recentsize += (*it).size;
+        recenttime += (*it).time;
+    }
+    const uint64_t recent = CLOCK_FREQ * recentsize * 8 / recenttime;
+
+    estimate = std::min(sorted[index], recent);
+    return estimate;
+}
+
+uint64_t ThroughputEstimator::get() const
+{
+    return estimate;
+}
+
+size_t ThroughputEstimator::getSamplesCount() const
+{
+    return samples.size();
+}
@@ -0,0 +1,56 @@
+/*
+ * ThroughputEstimator.hpp
+ *****************************************************************************
+ * Copyright (C) 2026 - VideoLAN Authors
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef THROUGHPUTESTIMATOR_HPP
+#define THROUGHPUTESTIMATOR_HPP
+
+#include <vlc_common.h>
+#include <deque>
+
+namespace adaptive
+{
+    /* Conservative throughput estimation:
+     * lowest of a sliding window percentile, which filters out
+     * bursts, and of the harmonic mean of the last samples,
+     * which follows sudden drops */
+    class ThroughputEstimator
+    {
+        public:
+            ThroughputEstimator(unsigned = 20, unsigned = 30, unsigned = 3);
+            uint64_t push(size_t, vlc_tick_t);
+            uint64_t get() const;
+            size_t   getSamplesCount() const;
+            void     reset();
+
+        private:
+            struct Sample
+            {
+                size_t size;
+                vlc_tick_t time;
+                uint64_t bps;
+            };
+            std::deque<Sample> samples;
+            unsigned maxsamples;
+            unsigned percentile;
+            unsigned recentsamples;
+            uint64_t estimate;
+    };
+}
+
+#endif // THROUGHPUTESTIMATOR_HPP
@@ -121,24 +121,58 @@ typedef struct
 
 typedef struct
 {
-    vlc_fourcc_t i_id;
     uint32_t     i_flags;
     uint64_t     i_pos;
     uint32_t     i_length;
-    uint64_t     i_lengthtotal;
 
 } avi_entry_t;
 
+/* The index is stored by blocks of 64 entries: positions are kept as 32 bits
+ * offsets from the first entry of the block and the keyframe flag is packed
+ * with the length. Cumulated lengths are only stored per block. */
+#define AVI_INDEX_BLOCK 64
+#define AVI_INDEX_KEY   0x80000000
+
+typedef struct
+{
+    uint64_t     i_pos;          /* position of the first entry set */
+    uint64_t     i_lengthtotal;  /* sum of the lengths before this block */
+    uint64_t     *p_pos;         /* absolute positions if an offset overflows */
+    uint64_t     i_set;          /* bitmask of the entries set */
+    uint32_t     i_offset[AVI_INDEX_BLOCK];
+    uint32_t     i_length[AVI_INDEX_BLOCK];
+
+} avi_index_block_t;
+
+/* OpenDML standard sub-index only read when one of its entries is needed */
+typedef struct
+{
+    uint64_t     i_pos;          /* position of the ix## chunk */
+    uint32_t     i_first;        /* first index entry */
+    uint32_t     i_count;
+    bool         b_loaded;
+
+} avi_subindex_t;
+
 typedef struct
 {
     uint32_t        i_size;
-    uint32_t        i_max;
-    avi_entry_t     *p_entry;
+    uint32_t        i_blocks;       /* allocated block pointers */
+    avi_index_block_t **pp_block;
+    uint32_t        i_lengthtotal;  /* blocks with a valid i_lengthtotal */
+
+    stream_t        *s;
+    uint32_t        i_subindex;
+    avi_subindex_t  *p_subindex;
 
 } avi_index_t;
 static void avi_index_Init( avi_index_t * );
 static void avi_index_Clean( avi_index_t * );
 static int64_t avi_index_Append( avi_index_t *, uint64_t *, avi_entry_t * );
+static uint64_t avi_index_Pos( avi_index_t *, uint32_t );
+static uint32_t avi_index_Length( avi_index_t *, uint32_t );
+static bool avi_index_IsKey( avi_index_t *, uint32_t );
+static uint64_t avi_index_LengthTotal( avi_index_t *, uint32_t );
 
 typedef struct
 {
@@ -221,6 +255,7 @@ static int AVI_PacketNext     ( demux_t * );
 static int AVI_PacketSearch   ( demux_t * );
 
 static void AVI_IndexLoad    ( demux_t * );
+static void AVI_IndexFree_idx1( demux_t * );
 static void AVI_IndexCreate  ( demux_t * );
 
 static void AVI_ExtractSubtitle( demux_t *, unsigned int i_stream, avi_chunk_list_t *, avi_chunk_STRING_t * );
@@ -736,7 +771,7 @@ aviindex:
     for( unsigned int i = 0; i < p_sys->i_track; i++ )
     {
         const avi_track_t *tk = p_sys->track[i];
-        if( tk->fmt.i_cat == VIDEO_ES && tk->idx.p_entry )
+        if( tk->fmt.i_cat == VIDEO_ES )
             i_idx_totalframes = __MAX(i_idx_totalframes, tk->idx.i_size);
     }
     if( i_idx_totalframes != p_avih->i_totalframes &&
@@ -786,6 +821,8 @@ aviindex:
         }
     }
 
+    AVI_IndexFree_idx1( p_demux );
+
     /* fix some BeOS MediaKit generated file */
     for( unsigned i = 0 ; i < p_sys->i_track; i++ )
     {
@@ -811,8 +848,8 @@ aviindex:
             tk->i_rate == p_auds->p_wf->nSamplesPerSec )
         {
             int64_t i_track_length =
-                tk->idx.p_entry[tk->idx.i_size-1].i_length +
-                tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal;
+                avi_index_Length( &tk->idx, tk->idx.i_size-1 ) +
+                avi_index_LengthTotal( &tk->idx, tk->idx.i_size-1 );
             vlc_tick_t i_length = VLC_TICK_FROM_US( p_avih->i_totalframes *
                                                     p_avih->i_microsecperframe );
 
@@ -1076,7 +1113,7 @@ static int Demux_Seekable( demux_t *p_demux )
         toread[i_track].b_ok = tk->b_activated && !tk->b_eof;
         if( tk->i_idxposc < tk->idx.i_size )
         {
-            toread[i_track].i_posf = tk->idx.p_entry[tk->i_idxposc].i_pos;
+            toread[i_track].i_posf = avi_index_Pos( &tk->idx, tk->i_idxposc );
            if( tk->i_idxposb > 0 )
            {
                 toread[i_track].i_posf += 8 + tk->i_idxposb;
@@ -1205,11 +1242,9 @@ static int Demux_Seekable( demux_t *p_demux )
 
                     /* add this chunk to the index */
                     avi_entry_t index;
-                    index.i_id     = avi_pk.i_fourcc;
                     index.i_flags  = AVI_GetKeyFlag(tk, avi_pk.i_peek);
                     index.i_pos    = avi_pk.i_pos;
                     index.i_length = avi_pk.i_size;
-                    index.i_lengthtotal = index.i_length;
                     int64_t i_indexid = avi_index_Append( &tk->idx, &p_sys->i_movi_lastchunk_pos, &index );
 
                     /* do we will read this data ? */
@@ -1243,7 +1278,7 @@ static int Demux_Seekable( demux_t *p_demux )
         tk = p_sys->track[i_track];
 
         size_t i_size;
-        unsigned i_ck_remaining_bytes = tk->idx.p_entry[tk->i_idxposc].i_length -
+        unsigned i_ck_remaining_bytes = avi_index_Length( &tk->idx, tk->i_idxposc ) -
                                         tk->i_idxposb;
 
         /* read those data */
@@ -1285,7 +1320,7 @@ static int Demux_Seekable( demux_t *p_demux )
         }
 
         p_frame->i_pts = VLC_TICK_0 + AVI_GetPTS( tk );
-        if( tk->idx.p_entry[tk->i_idxposc].i_flags&AVIIF_KEYFRAME )
+        if( avi_index_IsKey( &tk->idx, tk->i_idxposc ) )
         {
             p_frame->i_flags = BLOCK_FLAG_TYPE_I;
         }
@@ -1300,7 +1335,7 @@ static int Demux_Seekable( demux_t *p_demux )
             toread[i_track].i_toread -= i_size;
             tk->i_idxposb += i_size;
             if( tk->i_idxposb >=
-                    tk->idx.p_entry[tk->i_idxposc].i_length )
+                    avi_index_Length( &tk->idx, tk->i_idxposc ) )
             {
                 tk->i_idxposb = 0;
                 tk->i_idxposc++;
@@ -1321,7 +1356,7 @@ static int Demux_Seekable( demux_t *p_demux )
         if( tk->i_idxposc < tk->idx.i_size)
         {
             toread[i_track].i_posf =
-                tk->idx.p_entry[tk->i_idxposc].i_pos;
+                avi_index_Pos( &tk->idx, tk->i_idxposc );
             if( tk->i_idxposb > 0 )
             {
                 toread[i_track].i_posf += 8 + tk->i_idxposb;
@@ -1512,7 +1547,11 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_date, double f_ratio, bool b_acc
                 if ( p_sys->i_avih_flags & AVIF_MUSTUSEINDEX )
                     return VLC_EGENERIC;
             }
-            else AVI_IndexLoad( p_demux );
+            else
+            {
+                AVI_IndexLoad( p_demux );
+                AVI_IndexFree_idx1( p_demux );
+            }
 
             p_sys->b_indexloaded = true; /* we don't want to try each time */
         }
@@ -1564,8 +1603,8 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_date, double f_ratio, bool b_acc
                 goto failandresetpos;
             }
 
-            while( i_pos >= p_stream->idx.p_entry[p_stream->i_idxposc].i_pos +
-               p_stream->idx.p_entry[p_stream->i_idxposc].i_length + 8 )
+            while( i_pos >= avi_index_Pos( &p_stream->idx, p_stream->i_idxposc ) +
+               avi_index_Length( &p_stream->idx, p_stream->i_idxposc ) + 8 )
             {
                 /* search after i_idxposc */
                 if( AVI_StreamChunkSet( p_demux,
@@ -1839,12 +1878,12 @@ static vlc_tick_t AVI_GetPTS( avi_track_t *tk )
         {
             /* use the last entry */
             idx = tk->idx.i_size - 1;
-            i_count = tk->idx.p_entry[idx].i_lengthtotal
-                    + tk->idx.p_entry[idx].i_length;
+            i_count = avi_index_LengthTotal( &tk->idx, idx )
+                    + avi_index_Length( &tk->idx, idx );
         }
         else
         {
-            i_count = tk->idx.p_entry[idx].i_lengthtotal;
+            i_count = avi_index_LengthTotal( &tk->idx, idx );
         }
         return AVI_GetDPTS( tk, i_count + tk->i_idxposb );
     }
@@ -1902,11 +1941,9 @@ static int AVI_StreamChunkFind( demux_t *p_demux, avi_track_t *tk )
 
             /* add this chunk to the index */
             avi_entry_t index;
-            index.i_id     = avi_pk.i_fourcc;
             index.i_flags  = AVI_GetKeyFlag(tk_pk, avi_pk.i_peek);
             index.i_pos    = avi_pk.i_pos;
             index.i_length = avi_pk.i_size;
-            index.i_lengthtotal = index.i_length;
             avi_index_Append( &tk_pk->idx, &p_sys->i_movi_lastchunk_pos, &index );
 
             if( tk_pk == tk )
@@ -1952,8 +1989,8 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
                                uint64_t  i_byte )
 {
     if( ( p_stream->idx.i_size > 0 )
-        &&( i_byte < p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_lengthtotal +
-                p_stream->idx.p_entry[p_stream->idx.i_size - 1].i_length ) )
+        &&( i_byte < avi_index_LengthTotal( &p_stream->idx, p_stream->idx.i_size - 1 ) +
+                avi_index_Length( &p_stream->idx, p_stream->idx.i_size - 1 ) ) )
     {
         /* index is valid to find the ck */
         /* uses dichototmie to be fast enough */
@@ -1962,15 +1999,15 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
         int i_idxmin  = 0;
         for( ;; )
         {
-            if( p_stream->idx.p_entry[i_idxposc].i_lengthtotal > i_byte )
+            if( avi_index_LengthTotal( &p_stream->idx, i_idxposc ) > i_byte )
             {
                 i_idxmax  = i_idxposc ;
                 i_idxposc = ( i_idxmin + i_idxposc ) / 2 ;
             }
             else
             {
-                if( p_stream->idx.p_entry[i_idxposc].i_lengthtotal +
-                        p_stream->idx.p_entry[i_idxposc].i_length <= i_byte)
+                if( avi_index_LengthTotal( &p_stream->idx, i_idxposc ) +
+                        avi_index_Length( &p_stream->idx, i_idxposc ) <= i_byte)
                 {
                     i_idxmin  = i_idxposc ;
                     i_idxposc = (i_idxmax + i_idxposc ) / 2 ;
@@ -1979,7 +2016,7 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
                 {
                     p_stream->i_idxposc = i_idxposc;
                     p_stream->i_idxposb = i_byte -
-                            p_stream->idx.p_entry[i_idxposc].i_lengthtotal;
+                            avi_index_LengthTotal( &p_stream->idx, i_idxposc );
                     return VLC_SUCCESS;
                 }
             }
@@ -1998,11 +2035,11 @@ static int AVI_StreamBytesSet( demux_t    *p_demux,
                 return VLC_EGENERIC;
             }
 
-        } while( p_stream->idx.p_entry[p_stream->i_idxposc].i_lengthtotal +
-                    p_stream->idx.p_entry[p_stream->i_idxposc].i_length <= i_byte );
+        } while( avi_index_LengthTotal( &p_stream->idx, p_stream->i_idxposc ) +
+                    avi_index_Length( &p_stream->idx, p_stream->i_idxposc ) <= i_byte );
 
         p_stream->i_idxposb = i_byte -
-                       p_stream->idx.p_entry[p_stream->i_idxposc].i_lengthtotal;
+                       avi_index_LengthTotal( &p_stream->idx, p_stream->i_idxposc );
         return VLC_SUCCESS;
     }
 }
@@ -2034,7 +2071,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             {
                 tk->i_blockno = 0;
                 for( unsigned int i = 0; i < tk->i_idxposc; i++ )
-                    tk->i_blockno += ( tk->idx.p_entry[i].i_length + tk->i_blocksize - 1 ) / tk->i_blocksize;
+                    tk->i_blockno += ( avi_index_Length( &tk->idx, i ) + tk->i_blocksize - 1 ) / tk->i_blocksize;
             }
         }
 
@@ -2050,7 +2087,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             //if( i_date < i_oldpts || 1 )
             {
                 while( tk->i_idxposc > 0 &&
-                   !( tk->idx.p_entry[tk->i_idxposc].i_flags & AVIIF_KEYFRAME ) )
+                   !avi_index_IsKey( &tk->idx, tk->i_idxposc ) )
                 {
                     if( AVI_StreamChunkSet( p_demux, tk, tk->i_idxposc - 1 ) )
                     {
@@ -2062,7 +2099,7 @@ static int AVI_TrackSeek( demux_t *p_demux,
             else
             {
                 while( tk->i_idxposc < tk->idx.i_size &&
-                        !( tk->idx.p_entry[tk->i_idxposc].i_flags & AVIIF_KEYFRAME ) )
+                        !avi_index_IsKey( &tk->idx, tk->i_idxposc ) )
                 {
                     if( AVI_StreamChunkSet( p_demux, tk, tk->i_idxposc + 1 ) )
                     {
@@ -2327,15 +2364,87 @@ static int AVI_PacketSearch( demux_t *p_demux )
 static void avi_index_Init( avi_index_t *p_index )
 {
     p_index->i_size  = 0;
-    p_index->i_max   = 0;
-    p_index->p_entry = NULL;
+    p_index->i_blocks = 0;
+    p_index->pp_block = NULL;
+    p_index->i_lengthtotal = 0;
+    p_index->s = NULL;
+    p_index->i_subindex = 0;
+    p_index->p_subindex = NULL;
 }
 static void avi_index_Clean( avi_index_t *p_index )
 {
-    free( p_index->p_entry );
+    for( uint32_t i = 0; i < p_index->i_blocks; i++ )
+    {
+        if( p_index->pp_block[i] )
+        {
+            free( p_index->pp_block[i]->p_pos );
+            free( p_index->pp_block[i] );
+        }
+    }
+    free( p_index->pp_block );
+    free( p_index->p_subindex );
+    avi_index_Init( p_index );
+}
+#define MAX_INDEX_ENTRIES (UINT32_MAX - AVI_INDEX_BLOCK)
+#define INDEX_EXTENT 256 /* blocks */
+static int avi_index_Reserve( avi_index_t *p_index, uint32_t i_count )
+{
+    const uint32_t i_blocks = ( (uint64_t)i_count + AVI_INDEX_BLOCK - 1 ) / AVI_INDEX_BLOCK;
+    if( i_blocks <= p_index->i_blocks )
+        return VLC_SUCCESS;
+
+    const uint32_t i_max = __MAX( i_blocks, p_index->i_blocks + INDEX_EXTENT );
+    avi_index_block_t **pp_block = realloc( p_index->pp_block,
+                                            i_max * sizeof(*pp_block) );
+    if( !pp_block )
+        return VLC_ENOMEM;
+    for( uint32_t i = p_index->i_blocks; i < i_max; i++ )
+        pp_block[i] = NULL;
+    p_index->pp_block = pp_block;
+    p_index->i_blocks = i_max;
+    return VLC_SUCCESS;
+}
+static int avi_index_Set( avi_index_t *p_index, uint32_t i,
+                          const avi_entry_t *p_entry )
+{
+    avi_index_block_t *p_block = p_index->pp_block[i / AVI_INDEX_BLOCK];
+    const unsigned j = i % AVI_INDEX_BLOCK;
+
+    if( !p_block )
+    {
+        p_block = malloc( sizeof(*p_block) );
+        if( !p_block )
+            return VLC_ENOMEM;
+        p_block->i_pos = p_entry->i_pos;
+        p_block->i_lengthtotal = 0;
+        p_block->p_pos = NULL;
+        p_block->i_set = 0;
+        p_index->pp_block[i / AVI_INDEX_BLOCK] = p_block;
+    }
+
+    if( !p_block->p_pos &&
+        ( p_entry->i_pos < p_block->i_pos ||
+          p_entry->i_pos - p_block->i_pos > UINT32_MAX ) )
+    {
+        /* sparse stream, fall back to absolute positions for this block */
+        uint64_t *p_pos = malloc( AVI_INDEX_BLOCK * sizeof(*p_pos) );
+        if( !p_pos )
+            return VLC_ENOMEM;
+        for( unsigned k = 0; k < AVI_INDEX_BLOCK; k++ )
+            p_pos[k] = ( p_block->i_set >> k ) & 1 ?
+                       p_block->i_pos + p_block->i_offset[k] : 0;
+        p_block->p_pos = p_pos;
+    }
+
+    if( p_block->p_pos )
+        p_block->p_pos[j] = p_entry->i_pos;
+    else
+        p_block->i_offset[j] = p_entry->i_pos - p_block->i_pos;
+    p_block->i_length[j] = __MIN( p_entry->i_length, AVI_INDEX_KEY - 1 ) |
+                           ( p_entry->i_flags & AVIIF_KEYFRAME ? AVI_INDEX_KEY : 0 );
+    p_block->i_set |= UINT64_C(1) << j;
+    return VLC_SUCCESS;
 }
-#define MAX_INDEX_ENTRIES __MIN(SIZE_MAX/sizeof(avi_entry_t), UINT32_MAX)
-#define INDEX_EXTENT 16384
 static int64_t avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
                                  avi_entry_t *p_entry )
 {
@@ -2343,38 +2452,162 @@ static int64_t avi_index_Append( avi_index_t *p_index, uint64_t *pi_last_pos,
     if( *pi_last_pos < p_entry->i_pos )
          *pi_last_pos = p_entry->i_pos;
 
-    if( p_index->i_size == MAX_INDEX_ENTRIES )
+    if( p_index->i_size >= MAX_INDEX_ENTRIES )
         return -1;
 
     /* add the entry */
-    if( p_index->i_size >= p_index->i_max )
+    if( avi_index_Reserve( p_index, p_index->i_size + 1 ) ||
+        avi_index_Set( p_index, p_index->i_size, p_entry ) )
+        return -1;
+
+    return p_index->i_size++;
+}
+
+static void avi_index_EntryFromIndx( avi_entry_t *p_entry,
+                                     const avi_chunk_indx_t *p_indx, unsigned i )
+{
+    if( p_indx->i_indexsubtype == AVI_INDEX_2FIELD )
     {
-        if( MAX_INDEX_ENTRIES - INDEX_EXTENT > p_index->i_max )
-            p_index->i_max += INDEX_EXTENT;
-        else
-            p_index->i_max = MAX_INDEX_ENTRIES;
-        p_index->p_entry = realloc_or_free( p_index->p_entry,
-                                            p_index->i_max * sizeof(avi_entry_t) );
-        if( !p_index->p_entry )
-        {
-            avi_index_Init( p_index );
-            return -1;
+        p_entry->i_flags  = p_indx->idx.field[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
+        p_entry->i_pos    = p_indx->i_baseoffset + p_indx->idx.field[i].i_offset - 8;
+        p_entry->i_length = p_indx->idx.field[i].i_size;
+    }
+    else
+    {
+        p_entry->i_flags  = p_indx->idx.std[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
+        p_entry->i_pos    = p_indx->i_baseoffset + p_indx->idx.std[i].i_offset - 8;
+        p_entry->i_length = p_indx->idx.std[i].i_size&0x7fffffff;
+    }
+}
+
+static void avi_index_LoadSubindex( avi_index_t *p_index, uint32_t i_sub )
+{
+    stream_t *s = p_index->s;
+    avi_subindex_t *p_sub = &p_index->p_subindex[i_sub];
+    const uint64_t i_tell = vlc_stream_Tell( s );
+    avi_chunk_t ck_sub;
+    uint32_t i_loaded = 0;
+
+    p_sub->b_loaded = true;
+    if( !vlc_stream_Seek( s, p_sub->i_pos ) &&
+        !AVI_ChunkRead( s, &ck_sub, NULL ) )
+    {
+        if( ck_sub.common.i_chunk_fourcc == AVIFOURCC_indx &&
+            ck_sub.indx.i_indextype == AVI_INDEX_OF_CHUNKS &&
+            ck_sub.indx.i_indexsubtype == 0 )
+        {
+            const uint32_t i_count = __MIN( ck_sub.indx.i_entriesinuse, p_sub->i_count );
+            for( ; i_loaded < i_count; i_loaded++ )
+            {
+                avi_entry_t index;
+                avi_index_EntryFromIndx( &index, &ck_sub.indx, i_loaded );
+                if( avi_index_Set( p_index, p_sub->i_first + i_loaded, &index ) )
+                    break;
+            }
         }
+        AVI_ChunkClean( s, &ck_sub );
     }
-    /* calculate cumulate length */
-    if( p_index->i_size > 0 )
+    vlc_stream_Seek( s, i_tell );
+
+    if( i_loaded < p_sub->i_count )
     {
-        p_entry->i_lengthtotal =
-            p_index->p_entry[p_index->i_size - 1].i_length +
-                p_index->p_entry[p_index->i_size - 1].i_lengthtotal;
+        /* the index ends where the sub-index could not be read */
+        msg_Warn( s, "cannot load sub-index at %"PRIu64", index truncated",
+                  p_sub->i_pos );
+        p_index->i_size = p_sub->i_first + i_loaded;
+        p_index->i_lengthtotal = __MIN( p_index->i_lengthtotal,
+                                        p_index->i_size / AVI_INDEX_BLOCK + 1 );
+        for( uint32_t i = i_sub + 1; i < p_index->i_subindex; i++ )
+            p_index->p_subindex[i].b_loaded = true;
     }
-    else
+}
+
+/* load the sub-indexes covering entries i_first to i_last */
+static void avi_index_Load( avi_index_t *p_index, uint32_t i_first, uint32_t i_last )
+{
+    for( uint32_t i = 0; i < p_index->i_subindex; i++ )
+    {
+        const avi_subindex_t *p_sub = &p_index->p_subindex[i];
+        if( p_sub->i_first > i_last )
+            break;
+        if( !p_sub->b_loaded && p_sub->i_first + p_sub->i_count > i_first )
+            avi_index_LoadSubindex( p_index, i );
+    }
+}
+
+static avi_index_block_t *avi_index_Block( avi_index_t *p_index, uint32_t i )
+{
+    if( i >= p_index->i_size )
+        return NULL;
+
+    avi_index_block_t *p_block = p_index->pp_block[i / AVI_INDEX_BLOCK];
+    if( likely( p_block && ( p_block->i_set >> ( i % AVI_INDEX_BLOCK ) ) & 1 ) )
+        return p_block;
+
+    avi_index_Load( p_index, i, i );
+    if( i >= p_index->i_size )
+        return NULL;
+    p_block = p_index->pp_block[i / AVI_INDEX_BLOCK];
+    if( !p_block || !( ( p_block->i_set >> ( i % AVI_INDEX_BLOCK ) ) & 1 ) )
+        return NULL;
+    return p_block;
+}
+
+static uint64_t avi_index_Pos( avi_index_t *p_index, uint32_t i )
+{
+    const avi_index_block_t *p_block = avi_index_Block( p_index, i );
+    if( !p_block )
+        return 0;
+    const unsigned j = i % AVI_INDEX_BLOCK;
+    return p_block->p_pos ? p_block->p_pos[j] : p_block->i_pos + p_block->i_offset[j];
+}
+
+static uint32_t avi_index_Length( avi_index_t *p_index, uint32_t i )
+{
+    const avi_index_block_t *p_block = avi_index_Block( p_index, i );
+    return p_block ? p_block->i_length[i % AVI_INDEX_BLOCK] & ~AVI_INDEX_KEY : 0;
+}
+
+static bool avi_index_IsKey( avi_index_t *p_index, uint32_t i )
+{
+    const avi_index_block_t *p_block = avi_index_Block( p_index, i );
+    return p_block && ( p_block->i_length[i % AVI_INDEX_BLOCK] & AVI_INDEX_KEY );
+}
+
+static void avi_index_SetKey( avi_index_t *p_index, uint32_t i )
+{
+    avi_index_block_t *p_block = avi_index_Block( p_index, i );
+    if( p_block )
+        p_block->i_length[i % AVI_INDEX_BLOCK] |= AVI_INDEX_KEY;
+}
+
+/* sum of the lengths of the entries before i */
+static uint64_t avi_index_LengthTotal( avi_index_t *p_index, uint32_t i )
+{
+    avi_index_Load( p_index, 0, i );
+    if( i >= p_index->i_size )
+        return 0;
+
+    const uint32_t i_block = i / AVI_INDEX_BLOCK;
+    for( ; p_index->i_lengthtotal <= i_block; p_index->i_lengthtotal++ )
     {
-        p_entry->i_lengthtotal = 0;
+        const uint32_t b = p_index->i_lengthtotal;
+        uint64_t i_total = 0;
+        if( b > 0 )
+        {
+            const avi_index_block_t *p_prev = p_index->pp_block[b - 1];
+            i_total = p_prev->i_lengthtotal;
+            for( unsigned j = 0; j < AVI_INDEX_BLOCK; j++ )
+                i_total += p_prev->i_length[j] & ~AVI_INDEX_KEY;
+        }
+        p_index->pp_block[b]->i_lengthtotal = i_total;
     }
 
-    p_index->p_entry[p_index->i_size++] = *p_entry;
-    return p_index->i_size - 1;
+    const avi_index_block_t *p_block = p_index->pp_block[i_block];
+    uint64_t i_total = p_block->i_lengthtotal;
+    for( unsigned j = 0; j < i % AVI_INDEX_BLOCK; j++ )
+        i_total += p_block->i_length[j] & ~AVI_INDEX_KEY;
+    return i_total;
 }
 
 static int AVI_IndexFind_idx1( demux_t *p_demux,
@@ -2442,6 +2675,15 @@ static int AVI_IndexFind_idx1( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
+/* The idx1 entries are not needed anymore once converted to the index */
+static void AVI_IndexFree_idx1( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    avi_chunk_list_t *p_riff = AVI_ChunkFind( &p_sys->ck_root, AVIFOURCC_RIFF, 0, true);
+    AVI_ChunkClean( p_demux->s, AVI_ChunkFind( p_riff, AVIFOURCC_idx1, 0, false) );
+}
+
 static int AVI_IndexLoad_idx1( demux_t *p_demux,
                                avi_index_t p_index[], uint64_t *pi_last_offset )
 {
@@ -2466,11 +2708,9 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
             (i_cat == p_sys->track[i_stream]->fmt.i_cat || i_cat == UNKNOWN_ES ) )
         {
             avi_entry_t index;
-            index.i_id     = p_idx1->entry[i_index].i_fourcc;
             index.i_flags  = p_idx1->entry[i_index].i_flags&(~AVIIF_FIXKEYFRAME);
             index.i_pos    = p_idx1->entry[i_index].i_pos + i_offset;
             index.i_length = p_idx1->entry[i_index].i_length;
-            index.i_lengthtotal = index.i_length;
 
             avi_index_Append( &p_index[i_stream], pi_last_offset, &index );
         }
@@ -2485,14 +2725,14 @@ static int AVI_IndexLoad_idx1( demux_t *p_demux,
             if( p_sys->track[i_index]->i_samplesize )
             {
                 i_length = AVI_GetDPTS( p_sys->track[i_index],
-                                        p_index[i_index].p_entry[i].i_lengthtotal );
+                                        avi_index_LengthTotal( &p_index[i_index], i ) );
             }
             else
             {
                 i_length = AVI_GetDPTS( p_sys->track[i_index], i );
             }
             msg_Dbg( p_demux, "index stream %d @%ld time %ld", i_index,
-                     p_index[i_index].p_entry[i].i_pos, i_length );
+                     avi_index_Pos( &p_index[i_index], i ), i_length );
         }
     }
 #endif
@@ -2508,29 +2748,11 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     p_sys->b_indexloaded = true;
 
     msg_Dbg( p_demux, "loading subindex(0x%x) %d entries", p_indx->i_indextype, p_indx->i_entriesinuse );
-    if( p_indx->i_indexsubtype == 0 )
+    if( p_indx->i_indexsubtype == 0 || p_indx->i_indexsubtype == AVI_INDEX_2FIELD )
     {
         for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
         {
-            index.i_id     = p_indx->i_id;
-            index.i_flags  = p_indx->idx.std[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
-            index.i_pos    = p_indx->i_baseoffset + p_indx->idx.std[i].i_offset - 8;
-            index.i_length = p_indx->idx.std[i].i_size&0x7fffffff;
-            index.i_lengthtotal = index.i_length;
-
-            avi_index_Append( p_index, pi_max_offset, &index );
-        }
-    }
-    else if( p_indx->i_indexsubtype == AVI_INDEX_2FIELD )
-    {
-        for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
-        {
-            index.i_id     = p_indx->i_id;
-            index.i_flags  = p_indx->idx.field[i].i_size & 0x80000000 ? 0 : AVIIF_KEYFRAME;
-            index.i_pos    = p_indx->i_baseoffset + p_indx->idx.field[i].i_offset - 8;
-            index.i_length = p_indx->idx.field[i].i_size;
-            index.i_lengthtotal = index.i_length;
-
+            avi_index_EntryFromIndx( &index, p_indx, i );
             avi_index_Append( p_index, pi_max_offset, &index );
         }
     }
@@ -2540,6 +2762,51 @@ static void __Parse_indx( demux_t *p_demux, avi_index_t *p_index, uint64_t *pi_m
     }
 }
 
+/* Only reads the header of a standard sub-index, its entries will be loaded
+ * on first access */
+static int AVI_IndexAddSubindex( demux_t *p_demux, avi_index_t *p_index,
+                                 uint64_t i_pos )
+{
+    const uint8_t *p_peek;
+
+    if( vlc_stream_Seek( p_demux->s, i_pos ) ||
+        vlc_stream_Peek( p_demux->s, &p_peek, 32 ) < 32 )
+        return VLC_EGENERIC;
+
+    if( !( p_peek[0] == 'i' && p_peek[1] == 'x' ) &&
+        !( p_peek[2] == 'i' && p_peek[3] == 'x' ) )
+        return VLC_EGENERIC;
+
+    const uint32_t i_chunk_size = GetDWLE( &p_peek[4] );
+    if( GetWLE( &p_peek[8] ) != 2 || p_peek[10] != 0 ||
+        p_peek[11] != AVI_INDEX_OF_CHUNKS || i_chunk_size < 24 )
+        return VLC_EGENERIC;
+
+    const uint32_t i_count = __MIN( GetDWLE( &p_peek[12] ),
+                                    ( __EVEN( (uint64_t)i_chunk_size ) - 24 ) / 8 );
+    if( i_count == 0 || i_count > MAX_INDEX_ENTRIES - p_index->i_size )
+        return VLC_EGENERIC;
+
+    avi_subindex_t *p_sub = realloc( p_index->p_subindex,
+                                     ( p_index->i_subindex + 1 ) * sizeof(*p_sub) );
+    if( !p_sub )
+        return VLC_ENOMEM;
+    p_index->p_subindex = p_sub;
+
+    if( avi_index_Reserve( p_index, p_index->i_size + i_count ) )
+        return VLC_ENOMEM;
+
+    p_sub = &p_index->p_subindex[p_index->i_subindex++];
+    p_sub->i_pos    = i_pos;
+    p_sub->i_first  = p_index->i_size;
+    p_sub->i_count  = i_count;
+    p_sub->b_loaded = false;
+
+    p_index->s = p_demux->s;
+    p_index->i_size += i_count;
+    return VLC_SUCCESS;
+}
+
 static void AVI_IndexLoad_indx( demux_t *p_demux,
                                 avi_index_t p_index[], uint64_t *pi_last_offset )
 {
@@ -2578,6 +2845,16 @@ static void AVI_IndexLoad_indx( demux_t *p_demux,
             avi_chunk_t    ck_sub;
             for( unsigned i = 0; i < p_indx->i_entriesinuse; i++ )
             {
+                /* Entries are counted in chunks, sub-indexes can be read
+                 * when reached. The last one gives the last chunk position. */
+                if( p_sys->track[i_stream]->i_samplesize == 0 &&
+                    i > 0 && i + 1 < p_indx->i_entriesinuse &&
+                    !AVI_IndexAddSubindex( p_demux, &p_index[i_stream],
+                                           p_indx->idx.super[i].i_offset ) )
+                {
+                    p_sys->b_indexloaded = true;
+                    continue;
+                }
                 if( vlc_stream_Seek( p_demux->s,
                                      p_indx->idx.super[i].i_offset ) ||
                     AVI_ChunkRead( p_demux->s, &ck_sub, NULL  ) )
@@ -2623,14 +2900,14 @@ static void AVI_IndexLoad( demux_t *p_demux )
         if( p_idx_indx[i].i_size > p_idx_idx1[i].i_size )
         {
             msg_Dbg( p_demux, "selected ODML index for stream[%u]", i );
-            free(p_sys->track[i]->idx.p_entry);
+            avi_index_Clean( &p_sys->track[i]->idx );
             p_sys->track[i]->idx = p_idx_indx[i];
             avi_index_Clean( &p_idx_idx1[i] );
         }
         else
         {
             msg_Dbg( p_demux, "selected standard index for stream[%u]", i );
-            free(p_sys->track[i]->idx.p_entry);
+            avi_index_Clean( &p_sys->track[i]->idx );
             p_sys->track[i]->idx = p_idx_idx1[i];
             avi_index_Clean( &p_idx_indx[i] );
         }
@@ -2644,12 +2921,12 @@ static void AVI_IndexLoad( demux_t *p_demux )
         /* Fix key flag */
         bool b_key = false;
         for( unsigned j = 0; !b_key && j < p_index->i_size; j++ )
-            b_key = p_index->p_entry[j].i_flags & AVIIF_KEYFRAME;
+            b_key = avi_index_IsKey( p_index, j );
         if( !b_key )
         {
             msg_Warn( p_demux, "no key frame set for track %u", i );
             for( unsigned j = 0; j < p_index->i_size; j++ )
-                p_index->p_entry[j].i_flags |= AVIIF_KEYFRAME;
+                avi_index_SetKey( p_index, j );
         }
 
         /* */
@@ -2681,7 +2958,7 @@ static void AVI_IndexCreate( demux_t *p_demux )
     }
 
     for( i_stream = 0; i_stream < p_sys->i_track; i_stream++ )
-        avi_index_Init( &p_sys->track[i_stream]->idx );
+        avi_index_Clean( &p_sys->track[i_stream]->idx );
 
     i_movi_end = __MIN( (uint32_t)(p_movi->i_chunk_pos + p_movi->i_chunk_size),
                         stream_Size( p_demux->s ) );
@@ -2727,11 +3004,9 @@ static void AVI_IndexCreate( demux_t *p_demux )
             avi_track_t *tk = p_sys->track[pk.i_stream];
 
             avi_entry_t index;
-            index.i_id      = pk.i_fourcc;
             index.i_flags   = AVI_GetKeyFlag(tk, pk.i_peek);
             index.i_pos     = pk.i_pos;
             index.i_length  = pk.i_size;
-            index.i_lengthtotal = pk.i_size;
             avi_index_Append( &tk->idx, &p_sys->i_movi_lastchunk_pos, &index );
         }
         else
@@ -3077,7 +3352,7 @@ static vlc_tick_t  AVI_MovieGetLength( demux_t *p_demux )
         vlc_tick_t i_length;
 
         /* fix length for each stream */
-        if( tk->idx.i_size < 1 || !tk->idx.p_entry )
+        if( tk->idx.i_size < 1 )
         {
             continue;
         }
@@ -3085,8 +3360,8 @@ static vlc_tick_t  AVI_MovieGetLength( demux_t *p_demux )
         if( tk->i_samplesize )
         {
             i_length = AVI_GetDPTS( tk,
-                                    tk->idx.p_entry[tk->idx.i_size-1].i_lengthtotal +
-                                        tk->idx.p_entry[tk->idx.i_size-1].i_length );
+                                    avi_index_LengthTotal( &tk->idx, tk->idx.i_size-1 ) +
+                                        avi_index_Length( &tk->idx, tk->idx.i_size-1 ) );
         }
         else
         {
@@ -114,6 +114,7 @@ bool DASHManager::updatePlaylist()
 
         IsoffMainParser mpdparser(parser.getRootNode(), VLC_OBJECT(p_demux),
                                   mpdstream, Helper::getDirectoryPath(url).append("/"));
+        mpdparser.setKnownPlaylist(dynamic_cast<MPD *>(playlist));
         MPD *newmpd = mpdparser.parse();
         if(newmpd)
         {
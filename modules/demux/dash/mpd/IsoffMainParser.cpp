@@ -58,6 +58,8 @@ IsoffMainParser::IsoffMainParser    (Node *root_, vlc_object_t *p_object_,
     p_stream = stream;
     p_object = p_object_;
     playlisturl = streambaseurl_;
+    knownmpd = nullptr;
+    knownperiod = nullptr;
 }
 
 IsoffMainParser::~IsoffMainParser   ()
@@ -106,6 +108,13 @@ MPD * IsoffMainParser::parse()
     return mpd;
 }
 
+void IsoffMainParser::setKnownPlaylist(MPD *mpd)
+{
+    /* live refresh: timelines entries already present in
+     * the current playlist won't be materialized again */
+    knownmpd = mpd;
+}
+
 void    IsoffMainParser::parseMPDAttributes   (MPD *mpd, xml::Node *node)
 {
     const std::map<std::string, std::string> & attr = node->getAttributes();
@@ -166,6 +175,10 @@ void IsoffMainParser::parsePeriods(MPD *mpd, Node *root)
         BasePeriod *period = new (std::nothrow) BasePeriod(mpd);
         if (!period)
             continue;
+        /* periods are matched by index on update */
+        const size_t index = mpd->getPeriods().size();
+        knownperiod = (knownmpd && index < knownmpd->getPeriods().size())
+                    ? knownmpd->getPeriods().at(index) : nullptr;
         parseSegmentInformation(mpd, *it, period, &nextid);
         if((*it)->hasAttribute("start"))
             period->startTime.Set(IsoTime((*it)->getAttributeValue("start")));
@@ -225,7 +238,7 @@ void IsoffMainParser::parseMultipleSegmentBaseType(MPD *mpd, Node *node,
     if(node->hasAttribute("startNumber"))
         base->addAttribute(new StartnumberAttr(Integer<uint64_t>(node->getAttributeValue("startNumber"))));
 
-    parseTimeline(DOMHelper::getFirstChildElementByName(node, "SegmentTimeline"), base);
+    parseTimeline(DOMHelper::getFirstChildElementByName(node, "SegmentTimeline"), base, parent);
 }
 
 size_t IsoffMainParser::parseSegmentTemplate(MPD *mpd, Node *templateNode, SegmentInformation *info)
@@ -268,19 +281,21 @@ size_t IsoffMainParser::parseSegmentInformation(MPD *mpd, Node *node,
                                                 SegmentInformation *info, uint64_t *nextid)
 {
     size_t total = 0;
+    /* id and timescale are required for matching known timelines */
+    if(node->hasAttribute("id"))
+        info->setID(ID(node->getAttributeValue("id")));
+    else
+        info->setID(ID((*nextid)++));
+
+    if(node->hasAttribute("timescale"))
+        info->addAttribute(new TimescaleAttr(Timescale(Integer<uint64_t>(node->getAttributeValue("timescale")))));
+
     total += parseSegmentBase(mpd, DOMHelper::getFirstChildElementByName(node, "SegmentBase"), info);
     total += parseSegmentList(mpd, DOMHelper::getFirstChildElementByName(node, "SegmentList"), info);
     total += parseSegmentTemplate(mpd, DOMHelper::getFirstChildElementByName(node, "SegmentTemplate" ), info);
-    if(node->hasAttribute("timescale"))
-        info->addAttribute(new TimescaleAttr(Timescale(Integer<uint64_t>(node->getAttributeValue("timescale")))));
 
     parseAvailability<SegmentInformation>(mpd, node, info);
 
-    if(node->hasAttribute("id"))
-        info->setID(ID(node->getAttributeValue("id")));
-    else
-        info->setID(ID((*nextid)++));
-
     return total;
 }
 
@@ -507,7 +522,43 @@ void IsoffMainParser::parseInitSegment(Node *initNode, Initializable<InitSegment
     init->initialisationSegment.Set(seg);
 }
 
-void IsoffMainParser::parseTimeline(Node *node, AbstractMultipleSegmentBaseType *base)
+const SegmentTimeline * IsoffMainParser::getKnownTimeline(SegmentInformation *info,
+                                                          const AbstractMultipleSegmentBaseType *base) const
+{
+    if(!knownperiod)
+        return nullptr;
+
+    const SegmentInformation *known = nullptr;
+    if(dynamic_cast<BasePeriod *>(info))
+    {
+        known = knownperiod;
+    }
+    else if(dynamic_cast<AdaptationSet *>(info))
+    {
+        known = knownperiod->getAdaptationSetByID(info->getID());
+    }
+    else if(Representation *rep = dynamic_cast<Representation *>(info))
+    {
+        const BaseAdaptationSet *adaptSet =
+                knownperiod->getAdaptationSetByID(rep->getAdaptationSet()->getID());
+        if(adaptSet)
+            known = adaptSet->getRepresentationByID(rep->getID());
+    }
+
+    if(!known)
+        return nullptr;
+
+    /* the new template is not attached to info yet,
+     * and its timescale is usually its own attribute */
+    const SegmentTemplate *templ = known->inheritSegmentTemplate();
+    if(!templ || templ->inheritTimescale() != base->inheritTimescale())
+        return nullptr;
+
+    return templ->inheritSegmentTimeline();
+}
+
+void IsoffMainParser::parseTimeline(Node *node, AbstractMultipleSegmentBaseType *base,
+                                    SegmentInformation *parent)
 {
     if(!node)
         return;
@@ -520,11 +571,20 @@ void IsoffMainParser::parseTimeline(Node *node, AbstractMultipleSegmentBaseType
     if(number == std::numeric_limits<uint64_t>::max())
         number = 1;
 
+    /* Only templates can skip entries, as lists segments are
+     * mapped by timeline index */
+    const SegmentTimeline *known = nullptr;
+    if(knownmpd && base->getType() == AbstractAttr::Type::SegmentTemplate)
+        known = getKnownTimeline(parent, base);
+    const stime_t knownend = known ? known->getEndScaledTime() : 0;
+
     SegmentTimeline *timeline = new (std::nothrow) SegmentTimeline(base);
     if(timeline)
     {
         std::vector<Node *> elements = DOMHelper::getElementByTagName(node, "S", false);
         std::vector<Node *>::const_iterator it;
+        stime_t t = 0;
+        bool b_first = true;
         for(it = elements.begin(); it != elements.end(); ++it)
         {
             const Node *s = *it;
@@ -540,12 +600,23 @@ void IsoffMainParser::parseTimeline(Node *node, AbstractMultipleSegmentBaseType
             }
 
             if(s->hasAttribute("t"))
+                t = Integer<stime_t>(s->getAttributeValue("t"));
+
+            if(known && b_first)
+                timeline->setWindowStartScaledTime(t);
+            b_first = false;
+
+            /* Already fully known element, do not store */
+            if(known && t + d * (r + 1) <= knownend)
             {
-                stime_t t = Integer<stime_t>(s->getAttributeValue("t"));
-                timeline->addElement(number, d, r, t);
+                t += d * (r + 1);
+                number += (1 + r);
+                continue;
             }
-            else timeline->addElement(number, d, r);
 
+            timeline->addElement(number, d, r, t);
+
+            t += d * (r + 1);
             number += (1 + r);
         }
         //base->setSegmentTimeline(timeline);
@@ -42,6 +42,7 @@ namespace adaptive
     {
         class SegmentInformation;
         class SegmentTemplate;
+        class SegmentTimeline;
         class BasePeriod;
         class CommonAttributesElements;
     }
@@ -68,6 +69,7 @@ namespace dash
                                              stream_t *p_stream, const std::string &);
                 virtual ~IsoffMainParser    ();
                 MPD *   parse();
+                void    setKnownPlaylist    (MPD *);
 
             private:
                 mpd::Profile getProfile     () const;
@@ -76,7 +78,10 @@ namespace dash
                 void    parseAdaptationSets (MPD *, xml::Node *periodNode, BasePeriod *period);
                 void    parseRepresentations(MPD *, xml::Node *adaptationSetNode, AdaptationSet *adaptationSet);
                 void    parseInitSegment    (xml::Node *, Initializable<InitSegment> *, SegmentInformation *);
-                void    parseTimeline       (xml::Node *, AbstractMultipleSegmentBaseType *);
+                void    parseTimeline       (xml::Node *, AbstractMultipleSegmentBaseType *,
+                                             SegmentInformation *);
+                const SegmentTimeline * getKnownTimeline(SegmentInformation *,
+                                                         const AbstractMultipleSegmentBaseType *) const;
                 void    parsePeriods        (MPD *, xml::Node *);
                 size_t  parseSegmentInformation(MPD *, xml::Node *, SegmentInformation *, uint64_t *);
                 size_t  parseSegmentBase    (MPD *, xml::Node *, SegmentInformation *);
@@ -95,6 +100,8 @@ namespace dash
                 vlc_object_t    *p_object;
                 stream_t        *p_stream;
                 std::string      playlisturl;
+                MPD             *knownmpd;
+                BasePeriod      *knownperiod;
         };
     }
 }
@@ -230,12 +230,8 @@ bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresent
         stream_t *substream = vlc_stream_MemoryNew(p_obj, p_block->p_buffer, p_block->i_buffer, true);
         if(substream)
         {
-            std::list<Tag *> tagslist = parseEntries(substream);
+            appendSegmentsFromStream(p_obj, substream, rep);
             vlc_stream_Delete(substream);
-
-            parseSegments(p_obj, rep, tagslist);
-
-            releaseTagsList(tagslist);
         }
         block_Release(p_block);
         return true;
@@ -243,6 +239,14 @@ bool M3U8Parser::appendSegmentsFromPlaylistURI(vlc_object_t *p_obj, HLSRepresent
     return false;
 }
 
+void M3U8Parser::appendSegmentsFromStream(vlc_object_t *p_obj, stream_t *p_stream,
+                                          HLSRepresentation *rep)
+{
+    std::list<Tag *> tagslist = parseEntries(p_stream);
+    parseSegments(p_obj, rep, tagslist);
+    releaseTagsList(tagslist);
+}
+
 static bool parseEncryption(const AttributesTag *keytag, const Url &playlistUrl,
                             CommonEncryption &encryption)
 {
@@ -287,6 +291,16 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
     SegmentList *segmentList = new SegmentList(rep, !b_vod && !b_pdt);
     const Timescale timescale = rep->inheritTimescale();
 
+    /* Live refresh with relative timings: only new segments will be
+     * merged, so don't create the already known ones */
+    uint64_t lastKnownSequence = std::numeric_limits<uint64_t>::max();
+    const SegmentList *currentList = rep->inheritSegmentList();
+    if(rep->b_loaded && segmentList->hasRelativeMediaTimes() &&
+       currentList && currentList->hasRelativeMediaTimes() &&
+       !currentList->getSegments().empty())
+        lastKnownSequence = currentList->getSegments().back()->getSequenceNumber();
+    uint64_t windowStart = std::numeric_limits<uint64_t>::max();
+
     rep->b_loaded = true;
     rep->b_live = !b_vod;
 
@@ -332,11 +346,8 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                     break;
                 }
 
-                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
-                if(!segment)
-                    break;
-
-                segment->setSourceUrl(uritag->getValue().value);
+                if(windowStart == std::numeric_limits<uint64_t>::max())
+                    windowStart = sequenceNumber;
 
                 /* Need to use EXTXTARGETDURATION as default as some can't properly set segment one */
                 vlc_tick_t nzDuration = vlc_tick_from_sec(rep->targetDuration);
@@ -347,6 +358,34 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
                         nzDuration = vlc_tick_from_sec(durAttribute->floatingPoint());
                     ctx_extinf = nullptr;
                 }
+
+                std::pair<std::size_t,std::size_t> range(0, 0);
+                if(ctx_byterange)
+                {
+                    range = ctx_byterange->getValue().getByteRange();
+                    if(range.first == 0) /* first == size, second = offset */
+                        range.first = prevbyterangeoffset;
+                    prevbyterangeoffset = range.first + range.second;
+                }
+
+                if(lastKnownSequence != std::numeric_limits<uint64_t>::max() &&
+                   sequenceNumber <= lastKnownSequence)
+                {
+                    /* already in current list, only keep context */
+                    sequenceNumber++;
+                    nzStartTime += nzDuration;
+                    totalduration += nzDuration;
+                    ctx_byterange = nullptr;
+                    discontinuity = false;
+                    break;
+                }
+
+                HLSSegment *segment = new (std::nothrow) HLSSegment(rep, sequenceNumber++);
+                if(!segment)
+                    break;
+
+                segment->setSourceUrl(uritag->getValue().value);
+
                 segment->duration.Set(timescale.ToScaled(nzDuration));
                 segment->startTime.Set(timescale.ToScaled(nzStartTime));
                 nzStartTime += nzDuration;
@@ -361,10 +400,6 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
 
                 if(ctx_byterange)
                 {
-                    std::pair<std::size_t,std::size_t> range = ctx_byterange->getValue().getByteRange();
-                    if(range.first == 0) /* first == size, second = offset */
-                        range.first = prevbyterangeoffset;
-                    prevbyterangeoffset = range.first + range.second;
                     segment->setByteRange(range.first, prevbyterangeoffset - 1);
                     ctx_byterange = nullptr;
                 }
@@ -454,6 +489,9 @@ void M3U8Parser::parseSegments(vlc_object_t *, HLSRepresentation *rep, const std
         segmentList->addSegment(seg);
     segmentstoappend.clear();
 
+    if(lastKnownSequence != std::numeric_limits<uint64_t>::max())
+        segmentList->setWindowStartSegmentNumber(windowStart);
+
     if(rep->isLive())
     {
         rep->getPlaylist()->duration.Set(0);
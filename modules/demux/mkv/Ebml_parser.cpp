@@ -35,6 +35,7 @@ EbmlParser::EbmlParser( EbmlStream *es, EbmlElement *el_start, demux_t *p_demux
     m_es( es ),
     mi_level( 1 ),
     m_got( NULL ),
+    mi_raw_end( 0 ),
     mi_user_level( 1 ),
     mb_keep( false ),
     mb_dummy( var_InheritBool( p_demux, "mkv-use-dummy" ) )
@@ -83,6 +84,7 @@ void EbmlParser::Down( void )
 {
     mi_user_level++;
     mi_level++;
+    mi_raw_end = 0;
 }
 
 void EbmlParser::Keep( void )
@@ -110,6 +112,7 @@ void EbmlParser::Reset( demux_t *p_demux )
     }
     this->p_demux = p_demux;
     mi_user_level = mi_level = 1;
+    mi_raw_end = 0;
     // a little faster and cleaner
     m_es->I_O().setFilePointer( static_cast<EbmlMaster*>(m_el[0])->GetDataStart() );
 }
@@ -160,7 +163,11 @@ next:
         i_max_read = UINT64_MAX;
     else if (!p_prev)
     {
-        i_max_read = m_el[mi_level-1]->GetSize();
+        if ( mi_raw_end )
+            /* only the end of the parent is left after raw blocks */
+            i_max_read = m_el[mi_level-1]->GetEndPosition() - mi_raw_end;
+        else
+            i_max_read = m_el[mi_level-1]->GetSize();
         if (i_max_read == 0)
         {
             /* check if the parent still has data to read */
@@ -193,6 +200,8 @@ next:
         }
     }
 
+    mi_raw_end = 0;
+
     if (do_read)
     {
         // If the parent is a segment, use the segment context when creating children
@@ -336,6 +345,80 @@ next:
     return m_el[mi_level];
 }
 
+block_t *EbmlParser::GetRawSimpleBlock( uint64_t *pi_pos )
+{
+    if( mi_user_level != mi_level || mi_level < 2 || m_got || mb_keep )
+        return NULL;
+
+    EbmlElement *p_prev = m_el[mi_level];
+    EbmlElement *p_parent = m_el[mi_level - 1];
+    uint64_t i_pos;
+
+    if( p_prev != NULL )
+    {
+        if( !MKV_IS_ID( p_prev, KaxSimpleBlock ) || !p_prev->IsFiniteSize() )
+            return NULL;
+        i_pos = p_prev->GetEndPosition();
+    }
+    else if( mi_raw_end )
+        i_pos = mi_raw_end;
+    else
+        return NULL;
+
+    vlc_stream_io_callback *io_callback = dynamic_cast<vlc_stream_io_callback *>(&m_es->I_O());
+    if( io_callback == NULL || io_callback->IsEOF() ||
+        io_callback->getFilePointer() != i_pos )
+        return NULL;
+
+    stream_t *s = io_callback->GetStream();
+    const uint8_t *p_peek;
+    ssize_t i_peek = vlc_stream_Peek( s, &p_peek, 9 );
+    if( i_peek < 2 || p_peek[0] != 0xA3 ) /* SimpleBlock */
+        return NULL;
+
+    unsigned i_len = 1;
+    for( uint8_t mask = 0x80; mask && !( p_peek[1] & mask ); mask >>= 1 )
+        i_len++;
+    if( i_len > 8 || i_peek < 1 + (ssize_t) i_len )
+        return NULL;
+
+    uint64_t i_size = p_peek[1] & ( 0xFF >> i_len );
+    bool b_unknown = i_size == ( 0xFFU >> i_len );
+    for( unsigned i = 1; i < i_len; i++ )
+    {
+        i_size = ( i_size << 8 ) | p_peek[1 + i];
+        b_unknown = b_unknown && p_peek[1 + i] == 0xFF;
+    }
+
+    const size_t i_header = 1 + i_len;
+    if( b_unknown || i_size > UINT32_MAX )
+        return NULL;
+    if( p_parent->IsFiniteSize() &&
+        i_pos + i_header + i_size > p_parent->GetEndPosition() )
+        return NULL;
+
+    block_t *p_block = vlc_stream_Block( s, i_header + i_size );
+    if( p_block == NULL || p_block->i_buffer != i_header + i_size )
+    {
+        if( p_block )
+            block_Release( p_block );
+        io_callback->setFilePointer( i_pos );
+        return NULL;
+    }
+
+    if( p_prev != NULL )
+    {
+        delete p_prev;
+        m_el[mi_level] = NULL;
+    }
+    mi_raw_end = i_pos + i_header + i_size;
+
+    p_block->p_buffer += i_header;
+    p_block->i_buffer -= i_header;
+    *pi_pos = i_pos;
+    return p_block;
+}
+
 bool EbmlParser::IsTopPresent( EbmlElement *el ) const
 {
     for( int i = 0; i < mi_level; i++ )
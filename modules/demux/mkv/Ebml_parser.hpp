@@ -43,6 +43,9 @@ class EbmlParser
     void Down( void );
     void Reset( demux_t *p_demux );
     EbmlElement *Get( bool allow_overshoot = true );
+    /* Read the next SimpleBlock of the current Cluster directly from the
+     * stream, following a SimpleBlock, returns NULL for any other element */
+    block_t     *GetRawSimpleBlock( uint64_t *pi_pos );
     void        Keep( void );
     void        Unkeep( void );
 
@@ -60,6 +63,8 @@ class EbmlParser
     EbmlElement *m_el[M_EL_MAXSIZE];
 
     EbmlElement *m_got;
+    /* end of the last element read by GetRawSimpleBlock() */
+    uint64_t     mi_raw_end;
 
     int          mi_user_level;
     bool         mb_keep;
@@ -693,6 +693,23 @@ bool matroska_segment_c::Preload( )
     return true;
 }
 
+void matroska_segment_c::StartIndexing()
+{
+    if( _indexer || b_cues || !sys.b_fastseekable || tracks.empty() )
+        return;
+
+    /* the indexer reopens the URL, only the demuxed stream can be used */
+    if( sys.streams.empty() || &es != &sys.streams[0]->estream )
+        return;
+
+    if( !var_InheritBool( &sys.demuxer, "mkv-index-clusters" ) )
+        return;
+
+    _indexer.reset( new (std::nothrow) SegmentIndexer( sys.demuxer, *this ) );
+    if( _indexer && !_indexer->Start() )
+        _indexer.reset();
+}
+
 /* Here we try to load elements that were found in Seek Heads, but not yet parsed */
 bool matroska_segment_c::LoadSeekHeadItem( const EbmlCallbacks & ClassInfos, int64_t i_element_position )
 {
@@ -838,6 +855,9 @@ bool matroska_segment_c::Seek( demux_t &demuxer, vlc_tick_t i_absolute_mk_date,
 
     // find appropriate seekpoints //
 
+    if( _indexer )
+        _indexer->Merge( _seeker );
+
     try {
         seekpoints = _seeker.get_seekpoints( *this, i_mk_date, priority, selected_tracks );
     }
@@ -900,6 +920,40 @@ bool matroska_segment_c::Seek( demux_t &demuxer, vlc_tick_t i_absolute_mk_date,
 }
 
 
+/* Reads the next SimpleBlock without libebml, only possible when the
+ * previous element was a SimpleBlock of the same Cluster */
+int matroska_segment_c::RawBlockGet( raw_simpleblock_t & raw, mkv_track_t * & p_track )
+{
+    raw.p_data = NULL;
+
+    if( cluster == NULL )
+        return VLC_EGENERIC;
+
+    raw.p_data = ep.GetRawSimpleBlock( &raw.i_pos );
+    if( raw.p_data == NULL )
+        return VLC_EGENERIC;
+
+    tracks_map_t::iterator track_it;
+    if( !RawSimpleBlockParse( raw ) ||
+        ( track_it = tracks.find( raw.i_track ) ) == tracks.end() )
+    {
+        /* skipped, like the invalid blocks in BlockGet() */
+        block_Release( raw.p_data );
+        raw.p_data = NULL;
+        return VLC_EGENERIC;
+    }
+
+    raw.i_global_timecode = static_cast<int64_t>( cluster->GlobalTimecode() ) +
+                            raw.i_timecode * static_cast<int64_t>( i_timescale );
+
+    if( raw.b_key_picture )
+        _seeker.add_seekpoint( raw.i_track,
+            SegmentSeeker::Seekpoint( raw.i_pos, VLC_TICK_FROM_NS( raw.i_global_timecode ) ) );
+
+    p_track = track_it->second.get();
+    return VLC_SUCCESS;
+}
+
 mkv_track_t * matroska_segment_c::FindTrackByBlock(
                                              const KaxBlock *p_block, const KaxSimpleBlock *p_simpleblock )
 {
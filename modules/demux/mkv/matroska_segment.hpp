@@ -27,6 +27,7 @@
 #include "demux.hpp"
 #include "mkv.hpp"
 #include "matroska_segment_seeker.hpp"
+#include "matroska_segment_indexer.hpp"
 #include <vector>
 #include <string>
 
@@ -76,6 +77,8 @@ public:
     simple_tags_t   simple_tags;
 };
 
+struct raw_simpleblock_t;
+
 class matroska_segment_c
 {
 public:
@@ -145,9 +148,11 @@ public:
     void InformationCreate();
 
     bool Seek( demux_t &, vlc_tick_t i_mk_date, vlc_tick_t i_mk_time_offset, bool b_accurate );
+    void StartIndexing();
 
     int BlockGet( KaxBlock * &, KaxSimpleBlock * &, KaxBlockAdditions * &,
                   bool *, bool *, int64_t *);
+    int RawBlockGet( raw_simpleblock_t &, mkv_track_t * & );
 
     mkv_track_t * FindTrackByBlock(const KaxBlock *, const KaxSimpleBlock * );
 
@@ -176,6 +181,7 @@ private:
     void EnsureDuration();
 
     SegmentSeeker _seeker;
+    std::unique_ptr<SegmentIndexer> _indexer;
 
     friend SegmentSeeker;
 };
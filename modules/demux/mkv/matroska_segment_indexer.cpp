@@ -0,0 +1,448 @@
+/*****************************************************************************
+ * matroska_segment_indexer.cpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "matroska_segment_indexer.hpp"
+#include "matroska_segment.hpp"
+
+#include <vlc_tick.h>
+
+#include <algorithm>
+
+/* below this distance, reading is cheaper than seeking */
+#define INDEXER_READTHROUGH (64 * 1024)
+
+namespace {
+    /* EBML IDs, including their length marker */
+    enum : uint32_t {
+        ID_EBML                = 0x1A45DFA3,
+        ID_SEGMENT             = 0x18538067,
+        ID_SEEKHEAD            = 0x114D9B74,
+        ID_INFO                = 0x1549A966,
+        ID_TRACKS              = 0x1654AE6B,
+        ID_CUES                = 0x1C53BB6B,
+        ID_CHAPTERS            = 0x1043A770,
+        ID_ATTACHMENTS         = 0x1941A469,
+        ID_TAGS                = 0x1254C367,
+        ID_CLUSTER             = 0x1F43B675,
+        ID_CLUSTER_TIMECODE    = 0xE7,
+        ID_SIMPLEBLOCK         = 0xA3,
+        ID_BLOCKGROUP          = 0xA0,
+        ID_BLOCK               = 0xA1,
+        ID_REFERENCEBLOCK      = 0xFB,
+    };
+
+    /* an element of this kind ends a Cluster of unknown size */
+    bool IsTopLevel( uint32_t id )
+    {
+        switch( id )
+        {
+            case ID_EBML: case ID_SEGMENT: case ID_SEEKHEAD: case ID_INFO:
+            case ID_TRACKS: case ID_CUES: case ID_CHAPTERS: case ID_ATTACHMENTS:
+            case ID_TAGS: case ID_CLUSTER:
+                return true;
+            default:
+                return false;
+        }
+    }
+
+    /* returns the length of the variable size integer starting with b, or 0 */
+    unsigned VintLength( uint8_t b )
+    {
+        unsigned i_len = 1;
+        for( uint8_t mask = 0x80; mask && !( b & mask ); mask >>= 1 )
+            i_len++;
+        return i_len > 8 ? 0 : i_len;
+    }
+}
+
+namespace mkv {
+
+SegmentIndexer::SegmentIndexer( demux_t & demuxer, matroska_segment_c const& ms )
+    : demuxer( demuxer )
+    , url( demuxer.psz_url )
+    , i_segment_pos( ms.segment->GetElementPosition() )
+    , i_segment_data( ms.segment->GetDataStart() )
+    , i_segment_end( ms.segment->IsFiniteSize() ? ms.segment->GetEndPosition() : UINT64_MAX )
+    , i_timescale( ms.i_timescale )
+    , s( NULL )
+    , i_cluster_timecode( 0 )
+    , i_indexed_start( UINT64_MAX )
+    , i_indexed_end( 0 )
+    , i_merged_end( 0 )
+    , b_abort( false )
+    , b_running( false )
+{
+    vlc_mutex_init( &lock );
+
+    for( matroska_segment_c::tracks_map_t::const_iterator it = ms.tracks.begin();
+         it != ms.tracks.end(); ++it )
+    {
+        TrackInfo info = { it->second->fmt.i_cat, it->second->fmt.i_codec };
+        tracks.insert( tracks_t::value_type( it->first, info ) );
+    }
+}
+
+SegmentIndexer::~SegmentIndexer()
+{
+    Stop();
+}
+
+bool SegmentIndexer::Start()
+{
+    if( !b_running )
+    {
+        b_abort = false;
+        b_running = !vlc_clone( &thread, Thread, this );
+    }
+    return b_running;
+}
+
+void SegmentIndexer::Stop()
+{
+    if( !b_running )
+        return;
+
+    b_abort = true;
+    vlc_join( thread, NULL );
+    b_running = false;
+}
+
+void SegmentIndexer::Merge( SegmentSeeker & seeker )
+{
+    std::vector<SegmentSeeker::Cluster> clusters;
+    std::vector<track_seekpoint_t> seekpoints;
+    fptr_t i_start, i_end;
+
+    {
+        vlc_mutex_locker l( &lock );
+        clusters.swap( pending_clusters );
+        seekpoints.swap( pending_seekpoints );
+        i_start = i_indexed_start;
+        i_end   = i_indexed_end;
+    }
+
+    for( std::vector<SegmentSeeker::Cluster>::const_iterator it = clusters.begin();
+         it != clusters.end(); ++it )
+        seeker.add_cluster( *it );
+
+    for( std::vector<track_seekpoint_t>::const_iterator it = seekpoints.begin();
+         it != seekpoints.end(); ++it )
+        seeker.add_seekpoint( it->first, it->second );
+
+    if( i_start < i_end && i_merged_end < i_end )
+    {
+        /* every keyframe up to i_end is known now, the seeker doesn't
+         * need to parse this area anymore */
+        seeker.mark_range_as_searched( SegmentSeeker::Range( i_start, i_end ) );
+        i_merged_end = i_end;
+    }
+}
+
+void *SegmentIndexer::Thread( void *data )
+{
+    static_cast<SegmentIndexer*>( data )->Run();
+    return NULL;
+}
+
+void SegmentIndexer::Run()
+{
+    vlc_thread_set_name( "vlc-mkv-index" );
+
+    s = vlc_stream_NewURL( &demuxer, url.c_str() );
+    if( s == NULL )
+        return;
+
+    /* make sure the new stream shows the same data as the demuxed one */
+    Element segment;
+    if( vlc_stream_Seek( s, i_segment_pos ) != VLC_SUCCESS ||
+        !ReadElement( segment ) || segment.id != ID_SEGMENT ||
+        segment.data != i_segment_data )
+    {
+        msg_Dbg( &demuxer, "cannot index the segment, the stream differs" );
+        vlc_stream_Delete( s );
+        s = NULL;
+        return;
+    }
+
+    fptr_t i_end = i_segment_end;
+    uint64_t i_size;
+    if( i_end == UINT64_MAX && vlc_stream_GetSize( s, &i_size ) == VLC_SUCCESS )
+        i_end = i_size;
+
+    vlc_tick_t i_start_time = vlc_tick_now();
+    size_t i_clusters = 0;
+
+    for( fptr_t i_pos = i_segment_data; i_pos < i_end && !b_abort; )
+    {
+        Element el;
+        if( !SkipTo( i_pos ) || !ReadElement( el ) )
+            break;
+
+        if( el.id == ID_CLUSTER )
+        {
+            if( !IndexCluster( el ) )
+                break;
+            i_clusters++;
+        }
+        else if( el.end == UINT64_MAX )
+            break;
+
+        i_pos = el.end;
+    }
+
+    msg_Dbg( &demuxer, "indexed %zu clusters in %" PRId64 " ms%s", i_clusters,
+             MS_FROM_VLC_TICK( vlc_tick_now() - i_start_time ),
+             b_abort ? " (aborted)" : "" );
+
+    vlc_stream_Delete( s );
+    s = NULL;
+}
+
+bool SegmentIndexer::SkipTo( fptr_t i_pos )
+{
+    uint64_t i_tell = vlc_stream_Tell( s );
+    if( i_pos == i_tell )
+        return true;
+
+    if( i_pos > i_tell && i_pos - i_tell <= INDEXER_READTHROUGH )
+    {
+        size_t i_toread = i_pos - i_tell;
+        return vlc_stream_Read( s, NULL, i_toread ) == (ssize_t) i_toread;
+    }
+
+    return vlc_stream_Seek( s, i_pos ) == VLC_SUCCESS;
+}
+
+bool SegmentIndexer::ReadElement( Element & el )
+{
+    const uint8_t *p_peek;
+    ssize_t i_peek = vlc_stream_Peek( s, &p_peek, 12 );
+    if( i_peek < 2 )
+        return false;
+
+    unsigned i_id_len = VintLength( p_peek[0] );
+    if( i_id_len == 0 || i_id_len > 4 || (size_t) i_peek <= i_id_len )
+        return false;
+
+    unsigned i_size_len = VintLength( p_peek[i_id_len] );
+    if( i_size_len == 0 || (size_t) i_peek < i_id_len + i_size_len )
+        return false;
+
+    el.id = 0;
+    for( unsigned i = 0; i < i_id_len; i++ )
+        el.id = ( el.id << 8 ) | p_peek[i];
+
+    const uint8_t *p_size = &p_peek[i_id_len];
+    uint64_t i_size = p_size[0] & ( 0xFF >> i_size_len );
+    bool b_unknown = i_size == ( 0xFFU >> i_size_len );
+    for( unsigned i = 1; i < i_size_len; i++ )
+    {
+        i_size = ( i_size << 8 ) | p_size[i];
+        b_unknown = b_unknown && p_size[i] == 0xFF;
+    }
+
+    el.pos  = vlc_stream_Tell( s );
+    el.data = el.pos + i_id_len + i_size_len;
+    el.end  = b_unknown ? UINT64_MAX : el.data + i_size;
+    if( el.end < el.data )
+        return false;
+
+    return vlc_stream_Read( s, NULL, i_id_len + i_size_len ) == (ssize_t)( i_id_len + i_size_len );
+}
+
+bool SegmentIndexer::ReadBlockHeader( Element const& el, BlockHeader & hdr )
+{
+    const uint8_t *p_peek;
+    size_t i_toread = std::min<fptr_t>( el.end - el.data, 12 );
+    ssize_t i_peek = vlc_stream_Peek( s, &p_peek, i_toread );
+    if( i_peek < 4 )
+        return false;
+
+    unsigned i_len = VintLength( p_peek[0] );
+    if( i_len == 0 || (size_t) i_peek < i_len + 3 )
+        return false;
+
+    uint64_t i_track = p_peek[0] & ( 0xFF >> i_len );
+    for( unsigned i = 1; i < i_len; i++ )
+        i_track = ( i_track << 8 ) | p_peek[i];
+
+    hdr.i_track      = i_track;
+    hdr.i_timecode   = (int16_t) GetWBE( &p_peek[i_len] );
+    hdr.i_flags      = p_peek[i_len + 2];
+    hdr.i_first_byte = ( hdr.i_flags & 0x06 ) == 0 && (size_t) i_peek > i_len + 3
+                     ? p_peek[i_len + 3] : -1;
+    return true;
+}
+
+void SegmentIndexer::AddBlock( Element const& el, BlockHeader const& hdr,
+                               bool b_simpleblock, bool b_reference )
+{
+    tracks_t::const_iterator track = tracks.find( hdr.i_track );
+    if( track == tracks.end() )
+        return;
+
+    bool b_key;
+    if( b_simpleblock )
+        b_key = hdr.i_flags & 0x80;
+    else if( track->second.i_cat == SPU_ES )
+        b_key = true;
+    else if( track->second.i_codec == VLC_CODEC_THEORA )
+        /* if the second bit of a Theora frame is 1 it's not a keyframe */
+        b_key = !b_reference && hdr.i_first_byte >= 0 && !( hdr.i_first_byte & 0x40 );
+    else
+        b_key = !b_reference;
+
+    if( !b_key )
+        return;
+
+    if( track->second.i_cat == AUDIO_ES )
+    {
+        /* every audio frame is a keyframe, one seekpoint per cluster is
+         * enough and keeps the index small on long files */
+        if( std::find( cluster_audio_tracks.begin(), cluster_audio_tracks.end(),
+                       hdr.i_track ) != cluster_audio_tracks.end() )
+            return;
+        cluster_audio_tracks.push_back( hdr.i_track );
+    }
+
+    int64_t i_ns = ( (int64_t) i_cluster_timecode + hdr.i_timecode ) * (int64_t) i_timescale;
+    cluster_seekpoints.push_back( track_seekpoint_t( hdr.i_track,
+        SegmentSeeker::Seekpoint( el.pos, VLC_TICK_FROM_NS( i_ns ) ) ) );
+}
+
+bool SegmentIndexer::IndexCluster( Element & cluster )
+{
+    bool b_timecode = false;
+    fptr_t i_end = cluster.end;
+
+    i_cluster_timecode = 0;
+    cluster_audio_tracks.clear();
+    cluster_seekpoints.clear();
+
+    for( fptr_t i_pos = cluster.data; i_pos < i_end; )
+    {
+        if( b_abort )
+            return false;
+
+        Element el;
+        if( !SkipTo( i_pos ) || !ReadElement( el ) )
+        {
+            if( cluster.end != UINT64_MAX )
+                return false;
+            i_end = i_pos; /* last Cluster of unknown size */
+            break;
+        }
+
+        if( cluster.end == UINT64_MAX && IsTopLevel( el.id ) )
+        {
+            i_end = el.pos;
+            break;
+        }
+
+        if( el.end == UINT64_MAX || el.end > i_end )
+            return false;
+
+        switch( el.id )
+        {
+            case ID_CLUSTER_TIMECODE:
+            {
+                uint8_t buf[8];
+                size_t i_size = el.end - el.data;
+                if( i_size > sizeof(buf) || vlc_stream_Read( s, buf, i_size ) != (ssize_t) i_size )
+                    return false;
+                i_cluster_timecode = 0;
+                for( size_t i = 0; i < i_size; i++ )
+                    i_cluster_timecode = ( i_cluster_timecode << 8 ) | buf[i];
+                b_timecode = true;
+                break;
+            }
+            case ID_SIMPLEBLOCK:
+            {
+                BlockHeader hdr;
+                if( b_timecode && ReadBlockHeader( el, hdr ) )
+                    AddBlock( el, hdr, true, false );
+                break;
+            }
+            case ID_BLOCKGROUP:
+            {
+                Element block;
+                BlockHeader hdr;
+                bool b_block = false;
+                bool b_reference = false;
+
+                for( fptr_t i_child = el.data; i_child < el.end; )
+                {
+                    Element child;
+                    if( !SkipTo( i_child ) || !ReadElement( child ) ||
+                        child.end == UINT64_MAX || child.end > el.end )
+                        break;
+
+                    if( child.id == ID_BLOCK )
+                    {
+                        block = child;
+                        b_block = ReadBlockHeader( child, hdr );
+                    }
+                    else if( child.id == ID_REFERENCEBLOCK )
+                        b_reference = true;
+
+                    i_child = child.end;
+                }
+
+                if( b_timecode && b_block )
+                    AddBlock( block, hdr, false, b_reference );
+                break;
+            }
+            default:
+                break;
+        }
+
+        i_pos = el.end;
+    }
+
+    cluster.end = i_end;
+
+    vlc_mutex_locker l( &lock );
+
+    if( b_timecode )
+    {
+        SegmentSeeker::Cluster cinfo = {
+            /* fpos     */ cluster.pos,
+            /* pts      */ vlc_tick_t( VLC_TICK_FROM_NS( i_cluster_timecode * i_timescale ) ),
+            /* duration */ vlc_tick_t( -1 ),
+            /* size     */ i_end - cluster.pos
+        };
+        pending_clusters.push_back( cinfo );
+    }
+
+    pending_seekpoints.insert( pending_seekpoints.end(),
+                               cluster_seekpoints.begin(), cluster_seekpoints.end() );
+
+    if( i_indexed_start == UINT64_MAX )
+        i_indexed_start = cluster.pos;
+    i_indexed_end = i_end;
+
+    return true;
+}
+
+} // namespace
@@ -0,0 +1,121 @@
+/*****************************************************************************
+ * matroska_segment_indexer.hpp : matroska demuxer
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef MKV_MATROSKA_SEGMENT_INDEXER_HPP_
+#define MKV_MATROSKA_SEGMENT_INDEXER_HPP_
+
+#include "matroska_segment_seeker.hpp"
+
+#include <vlc_threads.h>
+
+#include <atomic>
+#include <map>
+#include <string>
+#include <utility>
+#include <vector>
+
+namespace mkv {
+
+class matroska_segment_c;
+
+/* Scans the Cluster and Block headers of a segment without Cues on a
+ * separate stream and thread, so that seeking does not have to discover
+ * the seekpoints cluster by cluster. Block payloads are never read. */
+class SegmentIndexer
+{
+    public:
+        typedef SegmentSeeker::fptr_t     fptr_t;
+        typedef SegmentSeeker::track_id_t track_id_t;
+
+        SegmentIndexer( demux_t &, matroska_segment_c const& );
+        ~SegmentIndexer();
+
+        bool Start();
+        void Stop();
+
+        /* move what has been indexed so far to the seeker, must be
+         * called from the demuxer thread */
+        void Merge( SegmentSeeker & );
+
+    private:
+        struct TrackInfo
+        {
+            int          i_cat;
+            vlc_fourcc_t i_codec;
+        };
+
+        typedef std::map<track_id_t, TrackInfo> tracks_t;
+        typedef std::pair<track_id_t, SegmentSeeker::Seekpoint> track_seekpoint_t;
+
+        struct Element
+        {
+            uint32_t id;
+            fptr_t   pos;
+            fptr_t   data;
+            fptr_t   end; /* UINT64_MAX if the size is unknown */
+        };
+
+        struct BlockHeader
+        {
+            track_id_t i_track;
+            int16_t    i_timecode;
+            uint8_t    i_flags;
+            int        i_first_byte; /* first payload byte, -1 if laced */
+        };
+
+        static void *Thread( void * );
+        void Run();
+
+        bool ReadElement( Element & );
+        bool ReadBlockHeader( Element const&, BlockHeader & );
+        bool SkipTo( fptr_t );
+        bool IndexCluster( Element & );
+        void AddBlock( Element const&, BlockHeader const&, bool b_simpleblock, bool b_reference );
+
+        demux_t     & demuxer;
+        std::string   url;
+        fptr_t        i_segment_pos;
+        fptr_t        i_segment_data;
+        fptr_t        i_segment_end;
+        uint64_t      i_timescale;
+        tracks_t      tracks;
+
+        /* indexer thread only */
+        stream_t                       *s;
+        uint64_t                        i_cluster_timecode;
+        std::vector<track_id_t>         cluster_audio_tracks;
+        std::vector<track_seekpoint_t>  cluster_seekpoints;
+
+        /* shared with the demuxer thread */
+        vlc_mutex_t                         lock;
+        std::vector<SegmentSeeker::Cluster> pending_clusters;
+        std::vector<track_seekpoint_t>      pending_seekpoints;
+        fptr_t                              i_indexed_start;
+        fptr_t                              i_indexed_end;
+        fptr_t                              i_merged_end;
+
+        std::atomic<bool> b_abort;
+        bool              b_running;
+        vlc_thread_t      thread;
+};
+
+} // namespace
+
+#endif /* include-guard */
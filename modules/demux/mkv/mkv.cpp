@@ -81,6 +81,10 @@ vlc_module_begin ()
             N_("Preload clusters"),
             N_("Find all cluster positions by jumping cluster-to-cluster before playback") );
 
+    add_bool( "mkv-index-clusters", true,
+            N_("Index clusters in the background"),
+            N_("Build a seek index of files without cues by reading the cluster and block headers in the background.") );
+
     add_shortcut( "mka", "mkv" )
     add_file_extension("mka")
     add_file_extension("mks")
@@ -525,6 +529,176 @@ static int Seek( demux_t *p_demux, vlc_tick_t i_mk_date, double f_percent, virtu
     return p_vsegment->Seek( *p_demux, i_mk_date, p_vchapter, b_precise ) ? VLC_SUCCESS : VLC_EGENERIC;
 }
 
+/* Returns whether the blocks of the track should be sent */
+static bool BlockTrackSelected( demux_t *p_demux, mkv_track_t & track )
+{
+    if( track.fmt.i_cat != DATA_ES && track.p_es == NULL )
+    {
+        msg_Err( p_demux, "unknown track number %u (%4.4s)",
+                 track.i_number, (const char *) &track.fmt.i_codec );
+        return false;
+    }
+
+    if ( track.fmt.i_cat != DATA_ES )
+    {
+        bool b;
+        es_out_Control( p_demux->out, ES_OUT_GET_ES_STATE, track.p_es, &b );
+
+        if( !b )
+        {
+            if( track.fmt.i_cat == VIDEO_ES || track.fmt.i_cat == AUDIO_ES )
+                track.i_last_dts = VLC_TICK_INVALID;
+            return false;
+        }
+    }
+    return true;
+}
+
+/* Sends one frame of a block, returns false if the remaining frames
+ * of the block must be dropped */
+static bool BlockSendFrame( demux_t *p_demux, mkv_track_t & track, block_t *p_block,
+                            KaxBlockAdditions *additions, vlc_tick_t & i_pts,
+                            int64_t i_duration, unsigned i_number_frames,
+                            bool b_key_picture, bool b_discardable_picture )
+{
+    demux_sys_t *p_sys = (demux_sys_t *)p_demux->p_sys;
+    matroska_segment_c *p_segment = p_sys->p_current_vsegment->CurrentSegment();
+
+#ifdef HAVE_ZLIB
+    if( track.i_compression_type == MATROSKA_COMPRESSION_ZLIB &&
+        track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+    {
+        p_block = block_zlib_decompress( VLC_OBJECT(p_demux), p_block );
+        if( p_block == NULL )
+            return false;
+    }
+    else
+#endif
+    if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
+        track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+    {
+        memcpy( p_block->p_buffer, track.p_compression_data->GetBuffer(), track.p_compression_data->GetSize() );
+    }
+    if ( track.fmt.i_codec == VLC_CODEC_PRORES )
+        memcpy( p_block->p_buffer + 4, "icpf", 4 );
+
+    if ( b_key_picture )
+        p_block->i_flags |= BLOCK_FLAG_TYPE_I;
+
+    switch( track.fmt.i_codec )
+    {
+    case VLC_CODEC_COOK:
+    case VLC_CODEC_ATRAC3:
+    {
+        handle_real_audio(p_demux, &track, p_block, i_pts);
+        block_Release(p_block);
+        i_pts = ( track.i_default_duration )?
+            i_pts + track.i_default_duration:
+            VLC_TICK_INVALID;
+        return true;
+     }
+
+     case VLC_CODEC_WEBVTT:
+        {
+            const uint8_t *p_addition = NULL;
+            size_t i_addition = 0;
+            if(additions)
+            {
+                KaxBlockMore *blockmore = FindChild<KaxBlockMore>(*additions);
+                if(blockmore)
+                {
+                    KaxBlockAdditional *addition = FindChild<KaxBlockAdditional>(*blockmore);
+                    if(addition)
+                    {
+                        i_addition = static_cast<std::string::size_type>(addition->GetSize());
+                        p_addition = reinterpret_cast<const uint8_t *>(addition->GetBuffer());
+                    }
+                }
+            }
+            p_block = WEBVTT_Repack_Sample( p_block, /* D_WEBVTT -> webm */
+                                            !track.codec.compare( 0, 1, "D" ),
+                                            p_addition, i_addition );
+            if( !p_block )
+                return true;
+        }
+        break;
+
+     case VLC_CODEC_OPUS:
+        {
+            vlc_tick_t i_length = VLC_TICK_FROM_NS(i_duration * track.f_timecodescale *
+                                                   p_segment->i_timescale);
+            if ( i_length < 0 ) i_length = 0;
+            p_block->i_nb_samples = samples_from_vlc_tick(i_length, track.fmt.audio.i_rate);
+        }
+        break;
+
+     case VLC_CODEC_DVBS:
+        {
+            p_block = block_Realloc( p_block, 2, p_block->i_buffer + 1);
+
+            if( unlikely( !p_block ) )
+                return true;
+
+            p_block->p_buffer[0] = 0x20; // data identifier
+            p_block->p_buffer[1] = 0x00; // subtitle stream id
+            p_block->p_buffer[ p_block->i_buffer - 1 ] = 0x3f; // end marker
+        }
+        break;
+
+      case VLC_CODEC_AV1:
+        p_block = AV1_Unpack_Sample( p_block );
+        if( unlikely( !p_block ) )
+            return true;
+        break;
+    }
+
+    if( track.fmt.i_cat != VIDEO_ES )
+    {
+        if ( track.fmt.i_cat == DATA_ES )
+        {
+            // TODO handle the start/stop times of this packet
+            if( p_block->i_size >= sizeof(pci_t))
+                p_sys->ev.SetPci( (const pci_t *)&p_block->p_buffer[1]);
+            block_Release( p_block );
+            return false;
+        }
+        p_block->i_dts = p_block->i_pts = i_pts;
+    }
+    else
+    {
+        // correct timestamping when B frames are used
+        if( track.b_dts_only )
+        {
+            p_block->i_pts = VLC_TICK_INVALID;
+            p_block->i_dts = i_pts;
+        }
+        else if( track.b_pts_only )
+        {
+            p_block->i_pts = i_pts;
+            p_block->i_dts = i_pts;
+        }
+        else
+        {
+            p_block->i_pts = i_pts;
+            // condition when the DTS is correct (keyframe or B frame == NOT P frame)
+            if ( b_key_picture || b_discardable_picture )
+                    p_block->i_dts = p_block->i_pts;
+            else if ( track.i_last_dts == VLC_TICK_INVALID )
+                p_block->i_dts = i_pts;
+            else
+                p_block->i_dts = std::min( i_pts, track.i_last_dts + track.i_default_duration );
+        }
+    }
+
+    send_Block( p_demux, &track, p_block, i_number_frames, i_duration );
+
+    /* use time stamp only for first block */
+    i_pts = ( track.i_default_duration )?
+             i_pts + track.i_default_duration:
+             ( track.fmt.b_packetized ) ? VLC_TICK_INVALID : i_pts + 1;
+    return true;
+}
+
 /* Needed by matroska_segment::Seek() and Seek */
 void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock,
                   KaxBlockAdditions *additions,
@@ -549,29 +723,12 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
 
     mkv_track_t &track = *p_track;
 
-    if( track.fmt.i_cat != DATA_ES && track.p_es == NULL )
-    {
-        msg_Err( p_demux, "unknown track number %u (%4.4s)",
-                 track.i_number, (const char *) &track.fmt.i_codec );
+    if( !BlockTrackSelected( p_demux, track ) )
         return;
-    }
 
     if (i_pts != VLC_TICK_INVALID)
         i_pts += p_segment->pcr_shift - track.i_codec_delay;
 
-    if ( track.fmt.i_cat != DATA_ES )
-    {
-        bool b;
-        es_out_Control( p_demux->out, ES_OUT_GET_ES_STATE, track.p_es, &b );
-
-        if( !b )
-        {
-            if( track.fmt.i_cat == VIDEO_ES || track.fmt.i_cat == AUDIO_ES )
-                track.i_last_dts = VLC_TICK_INVALID;
-            return;
-        }
-    }
-
     size_t frame_size = 0;
     size_t block_size = internal_block.GetSize();
     const unsigned i_number_frames = internal_block.NumberFrames();
@@ -603,138 +760,59 @@ void BlockDecode( demux_t *p_demux, KaxBlock *block, KaxSimpleBlock *simpleblock
             break;
         }
 
-#ifdef HAVE_ZLIB
-        if( track.i_compression_type == MATROSKA_COMPRESSION_ZLIB &&
-            track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
-        {
-            p_block = block_zlib_decompress( VLC_OBJECT(p_demux), p_block );
-            if( p_block == NULL )
-                break;
-        }
-        else
-#endif
-        if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
-            track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
-        {
-            memcpy( p_block->p_buffer, track.p_compression_data->GetBuffer(), track.p_compression_data->GetSize() );
-        }
-        if ( track.fmt.i_codec == VLC_CODEC_PRORES )
-            memcpy( p_block->p_buffer + 4, "icpf", 4 );
-
-        if ( b_key_picture )
-            p_block->i_flags |= BLOCK_FLAG_TYPE_I;
-
-        switch( track.fmt.i_codec )
-        {
-        case VLC_CODEC_COOK:
-        case VLC_CODEC_ATRAC3:
-        {
-            handle_real_audio(p_demux, &track, p_block, i_pts);
-            block_Release(p_block);
-            i_pts = ( track.i_default_duration )?
-                i_pts + track.i_default_duration:
-                VLC_TICK_INVALID;
-            continue;
-         }
-
-         case VLC_CODEC_WEBVTT:
-            {
-                const uint8_t *p_addition = NULL;
-                size_t i_addition = 0;
-                if(additions)
-                {
-                    KaxBlockMore *blockmore = FindChild<KaxBlockMore>(*additions);
-                    if(blockmore)
-                    {
-                        KaxBlockAdditional *addition = FindChild<KaxBlockAdditional>(*blockmore);
-                        if(addition)
-                        {
-                            i_addition = static_cast<std::string::size_type>(addition->GetSize());
-                            p_addition = reinterpret_cast<const uint8_t *>(addition->GetBuffer());
-                        }
-                    }
-                }
-                p_block = WEBVTT_Repack_Sample( p_block, /* D_WEBVTT -> webm */
-                                                !p_track->codec.compare( 0, 1, "D" ),
-                                                p_addition, i_addition );
-                if( !p_block )
-                    continue;
-            }
+        if( !BlockSendFrame( p_demux, track, p_block, additions, i_pts, i_duration,
+                             i_number_frames, b_key_picture, b_discardable_picture ) )
             break;
+    }
+}
 
-         case VLC_CODEC_OPUS:
-            {
-                vlc_tick_t i_length = VLC_TICK_FROM_NS(i_duration * track.f_timecodescale *
-                                                       p_segment->i_timescale);
-                if ( i_length < 0 ) i_length = 0;
-                p_block->i_nb_samples = samples_from_vlc_tick(i_length, track.fmt.audio.i_rate);
-            }
-            break;
+/* Same as BlockDecode() for a SimpleBlock read without libebml, the
+ * frames are sent without copying their data */
+static void RawBlockDecode( demux_t *p_demux, mkv_track_t & track, raw_simpleblock_t & raw,
+                            vlc_tick_t i_pts )
+{
+    demux_sys_t *p_sys = (demux_sys_t *)p_demux->p_sys;
+    matroska_segment_c *p_segment = p_sys->p_current_vsegment->CurrentSegment();
 
-         case VLC_CODEC_DVBS:
-            {
-                p_block = block_Realloc( p_block, 2, p_block->i_buffer + 1);
+    if( !BlockTrackSelected( p_demux, track ) )
+        return;
 
-                if( unlikely( !p_block ) )
-                    continue;
+    if (i_pts != VLC_TICK_INVALID)
+        i_pts += p_segment->pcr_shift - track.i_codec_delay;
 
-                p_block->p_buffer[0] = 0x20; // data identifier
-                p_block->p_buffer[1] = 0x00; // subtitle stream id
-                p_block->p_buffer[ p_block->i_buffer - 1 ] = 0x3f; // end marker
-            }
-            break;
+    block_t *frames[ARRAY_SIZE(raw.pi_frame_size)];
+    const unsigned i_number_frames = RawSimpleBlockFrames( raw, frames );
 
-          case VLC_CODEC_AV1:
-            p_block = AV1_Unpack_Sample( p_block );
-            if( unlikely( !p_block ) )
-                continue;
-            break;
-        }
+    for( unsigned int i_frame = 0; i_frame < i_number_frames; i_frame++ )
+    {
+        block_t *p_block = frames[i_frame];
+        size_t extra_data = track.fmt.i_codec == VLC_CODEC_PRORES ? 8 : 0;
 
-        if( track.fmt.i_cat != VIDEO_ES )
+        /* same order as BlockDecode(): reserve the room where
+         * BlockSendFrame() restores the stripped header */
+        if( track.i_compression_type == MATROSKA_COMPRESSION_HEADER &&
+            track.p_compression_data != NULL &&
+            track.i_encoding_scope & MATROSKA_ENCODING_SCOPE_ALL_FRAMES )
+            p_block = block_Realloc( p_block,
+                                     track.p_compression_data->GetSize() + extra_data,
+                                     p_block->i_buffer );
+        else if( unlikely( track.fmt.i_codec == VLC_CODEC_WAVPACK ) )
         {
-            if ( track.fmt.i_cat == DATA_ES )
-            {
-                // TODO handle the start/stop times of this packet
-                if( p_block->i_size >= sizeof(pci_t))
-                    p_sys->ev.SetPci( (const pci_t *)&p_block->p_buffer[1]);
-                block_Release( p_block );
-                return;
-            }
-            p_block->i_dts = p_block->i_pts = i_pts;
+            block_t *p_packet = packetize_wavpack( track, p_block->p_buffer, p_block->i_buffer );
+            block_Release( p_block );
+            p_block = p_packet;
         }
-        else
+        else if( extra_data )
+            p_block = block_Realloc( p_block, extra_data, p_block->i_buffer );
+
+        if( p_block == NULL ||
+            !BlockSendFrame( p_demux, track, p_block, NULL, i_pts, 0,
+                             i_number_frames, raw.b_key_picture, raw.b_discardable_picture ) )
         {
-            // correct timestamping when B frames are used
-            if( track.b_dts_only )
-            {
-                p_block->i_pts = VLC_TICK_INVALID;
-                p_block->i_dts = i_pts;
-            }
-            else if( track.b_pts_only )
-            {
-                p_block->i_pts = i_pts;
-                p_block->i_dts = i_pts;
-            }
-            else
-            {
-                p_block->i_pts = i_pts;
-                // condition when the DTS is correct (keyframe or B frame == NOT P frame)
-                if ( b_key_picture || b_discardable_picture )
-                        p_block->i_dts = p_block->i_pts;
-                else if ( track.i_last_dts == VLC_TICK_INVALID )
-                    p_block->i_dts = i_pts;
-                else
-                    p_block->i_dts = std::min( i_pts, track.i_last_dts + track.i_default_duration );
-            }
+            while( ++i_frame < i_number_frames )
+                block_Release( frames[i_frame] );
+            break;
         }
-
-        send_Block( p_demux, &track, p_block, i_number_frames, i_duration );
-
-        /* use time stamp only for first block */
-        i_pts = ( track.i_default_duration )?
-                 i_pts + track.i_default_duration:
-                 ( track.fmt.b_packetized ) ? VLC_TICK_INVALID : i_pts + 1;
     }
 }
 
@@ -762,15 +840,26 @@ static int Demux( demux_t *p_demux)
     if ( p_segment == NULL )
         return VLC_DEMUXER_EOF;
 
-    KaxBlock *block;
-    KaxSimpleBlock *simpleblock;
-    KaxBlockAdditions *additions;
+    KaxBlock *block = NULL;
+    KaxSimpleBlock *simpleblock = NULL;
+    KaxBlockAdditions *additions = NULL;
+    raw_simpleblock_t raw;
+    mkv_track_t *p_track;
+    uint64_t i_block_pos;
+    int64_t i_block_timecode;
     int64_t i_block_duration = 0;
     bool b_key_picture;
     bool b_discardable_picture;
 
-    if( p_segment->BlockGet( block, simpleblock, additions,
-                             &b_key_picture, &b_discardable_picture, &i_block_duration ) )
+    if( p_segment->RawBlockGet( raw, p_track ) == VLC_SUCCESS )
+    {
+        i_block_pos           = raw.i_pos;
+        i_block_timecode      = raw.i_global_timecode;
+        b_key_picture         = raw.b_key_picture;
+        b_discardable_picture = raw.b_discardable_picture;
+    }
+    else if( p_segment->BlockGet( block, simpleblock, additions,
+                                  &b_key_picture, &b_discardable_picture, &i_block_duration ) )
     {
         if ( p_vsegment->CurrentEdition() && p_vsegment->CurrentEdition()->b_ordered )
         {
@@ -790,13 +879,13 @@ static int Demux( demux_t *p_demux)
         msg_Warn( p_demux, "cannot get block EOF?" );
         return VLC_DEMUXER_EOF;
     }
-
-    KaxInternalBlock& internal_block = block
-        ? static_cast<KaxInternalBlock&>( *block )
-        : static_cast<KaxInternalBlock&>( *simpleblock );
-
+    else
     {
-        mkv_track_t *p_track = p_segment->FindTrackByBlock( block, simpleblock );
+        KaxInternalBlock& internal_block = block
+            ? static_cast<KaxInternalBlock&>( *block )
+            : static_cast<KaxInternalBlock&>( *simpleblock );
+
+        p_track = p_segment->FindTrackByBlock( block, simpleblock );
 
         if( p_track == NULL )
         {
@@ -806,17 +895,26 @@ static int Demux( demux_t *p_demux)
             return VLC_DEMUXER_EGENERIC;
         }
 
+        i_block_pos      = internal_block.GetElementPosition();
+        i_block_timecode = internal_block.GlobalTimecode();
+    }
+
+    auto release_block = [&]() {
+        delete block;
+        delete additions;
+        if( raw.p_data )
+            block_Release( raw.p_data );
+    };
+
+    {
         mkv_track_t &track = *p_track;
 
 
         if( track.i_skip_until_fpos != std::numeric_limits<uint64_t>::max() ) {
 
-            uint64_t block_fpos = internal_block.GetElementPosition();
-
-            if ( track.i_skip_until_fpos > block_fpos )
+            if ( track.i_skip_until_fpos > i_block_pos )
             {
-                delete block;
-                delete additions;
+                release_block();
                 return VLC_DEMUXER_SUCCESS; // this block shall be ignored
             }
         }
@@ -825,15 +923,14 @@ static int Demux( demux_t *p_demux)
     if (UpdatePCR( p_demux ) != VLC_SUCCESS)
     {
         msg_Err( p_demux, "ES_OUT_SET_PCR failed, aborting." );
-        delete block;
-        delete additions;
+        release_block();
         return VLC_DEMUXER_EGENERIC;
     }
 
     /* set pts */
     {
         p_sys->i_pts = p_sys->i_mk_chapter_time + VLC_TICK_0;
-        p_sys->i_pts += VLC_TICK_FROM_NS(internal_block.GlobalTimecode());
+        p_sys->i_pts += VLC_TICK_FROM_NS(i_block_timecode);
     }
 
     if ( p_vsegment->CurrentEdition() &&
@@ -841,16 +938,17 @@ static int Demux( demux_t *p_demux)
          p_vsegment->CurrentChapter() == NULL )
     {
         /* nothing left to read in this ordered edition */
-        delete block;
-        delete additions;
+        release_block();
         return VLC_DEMUXER_EOF;
     }
 
-    BlockDecode( p_demux, block, simpleblock, additions,
-                 p_sys->i_pts, i_block_duration, b_key_picture, b_discardable_picture );
+    if( raw.p_data )
+        RawBlockDecode( p_demux, *p_track, raw, p_sys->i_pts );
+    else
+        BlockDecode( p_demux, block, simpleblock, additions,
+                     p_sys->i_pts, i_block_duration, b_key_picture, b_discardable_picture );
 
-    delete block;
-    delete additions;
+    release_block();
 
     return VLC_DEMUXER_SUCCESS;
 }
@@ -25,6 +25,8 @@
 #include "demux.hpp"
 #include "../../codec/webvtt/helpers.h"
 
+#include <vlc_atomic.h>
+
 namespace mkv {
 
 /*****************************************************************************
@@ -500,6 +502,206 @@ block_t * packetize_wavpack( const mkv_track_t & tk, uint8_t * buffer, size_t  s
     return p_block;
 }
 
+/* Reads an EBML variable size integer, returns its length or 0 */
+static unsigned ReadVint( const uint8_t *p, size_t i_size, uint64_t *pi_value )
+{
+    if( i_size == 0 )
+        return 0;
+
+    unsigned i_len = 1;
+    for( uint8_t mask = 0x80; mask && !( p[0] & mask ); mask >>= 1 )
+        i_len++;
+    if( i_len > 8 || i_len > i_size )
+        return 0;
+
+    uint64_t i_value = p[0] & ( 0xFF >> i_len );
+    for( unsigned i = 1; i < i_len; i++ )
+        i_value = ( i_value << 8 ) | p[i];
+    *pi_value = i_value;
+    return i_len;
+}
+
+/* Parses the block header and the lacing, on success the payload of
+ * p_data only contains the frames */
+bool RawSimpleBlockParse( raw_simpleblock_t & raw )
+{
+    uint8_t *p = raw.p_data->p_buffer;
+    size_t i_size = raw.p_data->i_buffer;
+    uint64_t i_track;
+
+    if( i_size > UINT32_MAX )
+        return false;
+
+    unsigned i_len = ReadVint( p, i_size, &i_track );
+    if( i_len == 0 || i_size < i_len + 3 )
+        return false;
+
+    const uint8_t i_flags = p[i_len + 2];
+    raw.i_track               = i_track;
+    raw.i_timecode            = (int16_t) GetWBE( &p[i_len] );
+    raw.b_key_picture         = i_flags & 0x80;
+    raw.b_discardable_picture = i_flags & 0x01;
+    raw.i_frames              = 1;
+    p      += i_len + 3;
+    i_size -= i_len + 3;
+
+    uint64_t i_total = 0;
+    if( i_flags & 0x06 )
+    {
+        if( i_size == 0 )
+            return false;
+        raw.i_frames = p[0] + 1;
+        p++;
+        i_size--;
+    }
+
+    if( raw.i_frames > 1 )
+    {
+        switch( i_flags & 0x06 )
+        {
+            case 0x02: /* Xiph lacing */
+                for( unsigned i = 0; i < raw.i_frames - 1; i++ )
+                {
+                    uint64_t i_frame = 0;
+                    uint8_t i_byte;
+                    do
+                    {
+                        if( i_size == 0 )
+                            return false;
+                        i_byte = *p++;
+                        i_size--;
+                        i_frame += i_byte;
+                    } while( i_byte == 0xFF );
+
+                    i_total += i_frame;
+                    if( i_total > i_size )
+                        return false;
+                    raw.pi_frame_size[i] = i_frame;
+                }
+                break;
+
+            case 0x06: /* EBML lacing */
+            {
+                uint64_t i_frame;
+                unsigned i_vint = ReadVint( p, i_size, &i_frame );
+                if( i_vint == 0 )
+                    return false;
+                p      += i_vint;
+                i_size -= i_vint;
+
+                for( unsigned i = 0; i < raw.i_frames - 1; i++ )
+                {
+                    if( i > 0 )
+                    {
+                        /* sizes are stored as signed differences */
+                        uint64_t i_delta;
+                        i_vint = ReadVint( p, i_size, &i_delta );
+                        if( i_vint == 0 )
+                            return false;
+                        p      += i_vint;
+                        i_size -= i_vint;
+
+                        int64_t i_bias = ( INT64_C(1) << ( 7 * i_vint - 1 ) ) - 1;
+                        int64_t i_next = (int64_t) i_frame + (int64_t) i_delta - i_bias;
+                        if( i_next < 0 )
+                            return false;
+                        i_frame = i_next;
+                    }
+
+                    i_total += i_frame;
+                    if( i_frame > i_size || i_total > i_size )
+                        return false;
+                    raw.pi_frame_size[i] = i_frame;
+                }
+                break;
+            }
+
+            default: /* fixed-size lacing */
+                if( i_size % raw.i_frames )
+                    return false;
+                for( unsigned i = 0; i < raw.i_frames - 1; i++ )
+                    raw.pi_frame_size[i] = i_size / raw.i_frames;
+                i_total = i_size - i_size / raw.i_frames;
+                break;
+        }
+    }
+
+    if( i_total > i_size )
+        return false;
+    raw.pi_frame_size[raw.i_frames - 1] = i_size - i_total;
+
+    raw.p_data->p_buffer = p;
+    raw.p_data->i_buffer = i_size;
+    return true;
+}
+
+namespace {
+    struct raw_frames_t
+    {
+        vlc_atomic_rc_t rc;
+        block_t         *p_data;
+    };
+
+    struct raw_frame_t
+    {
+        block_t      self;
+        raw_frames_t *p_frames;
+    };
+
+    void RawFrameRelease( block_t *p_block )
+    {
+        raw_frames_t *p_frames = container_of( p_block, raw_frame_t, self )->p_frames;
+        if( vlc_atomic_rc_dec( &p_frames->rc ) )
+        {
+            block_Release( p_frames->p_data );
+            free( p_frames );
+        }
+    }
+
+    const struct vlc_block_callbacks raw_frame_cbs =
+    {
+        RawFrameRelease,
+    };
+}
+
+/* Hands out the frames of a parsed block without copying them. Laced
+ * frames reference the block data, which is released with the last
+ * of them. Returns the number of frames, 0 on error */
+unsigned RawSimpleBlockFrames( raw_simpleblock_t & raw, block_t **pp_frames )
+{
+    if( raw.i_frames == 1 )
+    {
+        pp_frames[0] = raw.p_data;
+        raw.p_data = NULL;
+        return 1;
+    }
+
+    /* a single allocation for all the frames */
+    raw_frames_t *p_frames = static_cast<raw_frames_t *>(
+        malloc( sizeof(*p_frames) + raw.i_frames * sizeof(raw_frame_t) ) );
+    if( unlikely( p_frames == NULL ) )
+        return 0;
+
+    raw_frame_t *p_views = reinterpret_cast<raw_frame_t *>( p_frames + 1 );
+    uint8_t *p = raw.p_data->p_buffer;
+
+    vlc_atomic_rc_init( &p_frames->rc );
+    p_frames->p_data = raw.p_data;
+    raw.p_data = NULL;
+
+    for( unsigned i = 0; i < raw.i_frames; i++ )
+    {
+        if( i > 0 )
+            vlc_atomic_rc_inc( &p_frames->rc );
+        p_views[i].p_frames = p_frames;
+        block_Init( &p_views[i].self, &raw_frame_cbs, p, raw.pi_frame_size[i] );
+        pp_frames[i] = &p_views[i].self;
+        p += raw.pi_frame_size[i];
+    }
+
+    return raw.i_frames;
+}
+
 void MkvTree_va( demux_t& demuxer, int i_level, const char* fmt, va_list args)
 {
     static const char indent[] = "|   ";
@@ -95,6 +95,23 @@ public:
 
 block_t * packetize_wavpack( const mkv_track_t &, uint8_t *, size_t);
 
+/* SimpleBlock read from the stream without libebml */
+struct raw_simpleblock_t
+{
+    block_t  *p_data;       /* element payload */
+    uint64_t i_pos;         /* element position */
+    uint64_t i_track;
+    int16_t  i_timecode;
+    int64_t  i_global_timecode; /* set by the segment */
+    bool     b_key_picture;
+    bool     b_discardable_picture;
+    unsigned i_frames;
+    uint32_t pi_frame_size[256];
+};
+
+bool RawSimpleBlockParse( raw_simpleblock_t & );
+unsigned RawSimpleBlockFrames( raw_simpleblock_t &, block_t ** );
+
 /* helper functions to print the mkv parse tree */
 void MkvTree_va( demux_t& demuxer, int i_level, const char* fmt, va_list args);
 void MkvTree( demux_t & demuxer, int i_level, const char *psz_format, ... );
@@ -48,21 +48,59 @@ mp4_fragments_index_t * MP4_Fragments_Index_New( unsigned i_tracks, unsigned i_n
             MP4_Fragments_Index_Delete( p_index );
             return NULL;
         }
-        p_index->i_entries = i_num;
+        p_index->i_entries = 0;
+        p_index->i_allocated = i_num;
         p_index->i_last_time = 0;
         p_index->i_tracks = i_tracks;
     }
     return p_index;
 }
 
+int MP4_Fragments_Index_Append( mp4_fragments_index_t *p_index,
+                                uint64_t i_pos, const stime_t *p_times )
+{
+    if( p_index->i_entries == p_index->i_allocated )
+    {
+        if( p_index->i_allocated > UINT_MAX / 2 ||
+            SIZE_MAX / (2 * p_index->i_allocated) < p_index->i_tracks )
+            return VLC_ENOMEM;
+        const unsigned i_num = p_index->i_allocated * 2;
+
+        uint64_t *pi_pos = realloc( p_index->pi_pos, sizeof(*pi_pos) * i_num );
+        if( !pi_pos )
+            return VLC_ENOMEM;
+        p_index->pi_pos = pi_pos;
+
+        stime_t *p_times = realloc( p_index->p_times,
+                                    sizeof(*p_times) * i_num * p_index->i_tracks );
+        if( !p_times )
+            return VLC_ENOMEM;
+        p_index->p_times = p_times;
+        p_index->i_allocated = i_num;
+    }
+
+    const size_t i_entry = p_index->i_entries++;
+    p_index->pi_pos[i_entry] = i_pos;
+    memcpy( &p_index->p_times[i_entry * p_index->i_tracks], p_times,
+            sizeof(*p_times) * p_index->i_tracks );
+    return VLC_SUCCESS;
+}
+
 stime_t MP4_Fragment_Index_GetTrackStartTime( mp4_fragments_index_t *p_index,
                                               unsigned i_track_index, uint64_t i_moof_pos )
 {
-    for( size_t i=0; i<p_index->i_entries; i++ )
+    /* first fragment at or after i_moof_pos */
+    size_t i_low = 0, i_high = p_index->i_entries;
+    while( i_low < i_high )
     {
-        if( p_index->pi_pos[i] >= i_moof_pos )
-            return p_index->p_times[i * p_index->i_tracks + i_track_index];
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->pi_pos[i_mid] < i_moof_pos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
     }
+    if( i_low < p_index->i_entries )
+        return p_index->p_times[i_low * p_index->i_tracks + i_track_index];
     return 0;
 }
 
@@ -78,18 +116,19 @@ bool MP4_Fragments_Index_Lookup( mp4_fragments_index_t *p_index, stime_t *pi_tim
         i_track_index >= p_index->i_tracks )
         return false;
 
-    for( size_t i=1; i<p_index->i_entries; i++ )
+    /* first fragment starting after the requested time */
+    size_t i_low = 1, i_high = p_index->i_entries;
+    while( i_low < i_high )
     {
-        if( p_index->p_times[i * p_index->i_tracks + i_track_index] > *pi_time )
-        {
-            *pi_time = p_index->p_times[(i - 1) * p_index->i_tracks + i_track_index];
-            *pi_pos = p_index->pi_pos[i - 1];
-            return true;
-        }
+        size_t i_mid = i_low + (i_high - i_low) / 2;
+        if( p_index->p_times[i_mid * p_index->i_tracks + i_track_index] > *pi_time )
+            i_high = i_mid;
+        else
+            i_low = i_mid + 1;
     }
 
-    *pi_time = p_index->p_times[(size_t)(p_index->i_entries - 1) * p_index->i_tracks];
-    *pi_pos = p_index->pi_pos[p_index->i_entries - 1];
+    *pi_time = p_index->p_times[(i_low - 1) * p_index->i_tracks + i_track_index];
+    *pi_pos = p_index->pi_pos[i_low - 1];
     return true;
 }
 
@@ -458,43 +458,23 @@ static es_out_id_t * MP4_CreateES( es_out_t *out, const es_format_t *p_fmt,
     return p_es;
 }
 
-static int MP4_ChunkAllocEntries( size_t entries, uint32_t *smallbuf,
-                                  uint32_t **dst0, uint32_t **dst1 )
-{
-    uint32_t *buf;
-
-    if( entries > MP4_CHUNK_SMALLBUF_ENTRIES )
-    {
-        buf = calloc( entries, sizeof( buf[0] ) * 2 );
-        if( unlikely(buf == NULL) )
-            return VLC_ENOMEM;
-    }
-    else buf = smallbuf;
-
-    *dst0 = buf;
-    *dst1 = &buf[entries];
-
-    return VLC_SUCCESS;
-}
-
-static void MP4_ChunkDestroy( mp4_chunk_t *ck )
-{
-    if( ck->p_sample_count_dts != ck->small_dts_buf )
-        free( ck->p_sample_count_dts );
-    if( ck->p_sample_count_pts != ck->small_pts_buf )
-        free( ck->p_sample_count_pts );
-}
-
 static const mp4_chunk_t * MP4_TrackChunkForSample( const mp4_track_t *p_track,
                                                     uint32_t i_sample )
 {
     if( i_sample >= p_track->i_sample_count )
         return NULL;
-    for( uint32_t i=0; i<p_track->i_chunk_count; i++ )
-    {
-        if( i_sample >= p_track->chunk[i].i_sample_first &&
-            i_sample - p_track->chunk[i].i_sample_first < p_track->chunk[i].i_sample_count )
-            return &p_track->chunk[i];
+    /* chunks are sorted by first sample */
+    uint32_t i_low = 0, i_high = p_track->i_chunk_count;
+    while( i_low < i_high )
+    {
+        uint32_t i_mid = i_low + (i_high - i_low) / 2;
+        const mp4_chunk_t *ck = &p_track->chunk[i_mid];
+        if( i_sample < ck->i_sample_first )
+            i_high = i_mid;
+        else if( i_sample - ck->i_sample_first >= ck->i_sample_count )
+            i_low = i_mid + 1;
+        else
+            return ck;
     }
     return NULL;
 }
@@ -545,42 +525,54 @@ static stime_t MP4_MapMediaTimelineToTrackTime( const mp4_track_t *p_track,
     return i_time;
 }
 
-static stime_t MP4_ChunkGetSampleDTS( const mp4_chunk_t *p_chunk,
+static stime_t MP4_ChunkGetSampleDTS( const mp4_track_t *p_track,
+                                      const mp4_chunk_t *p_chunk,
                                       uint32_t i_sample )
 {
-    uint32_t i_index = 0;
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
     stime_t sdts = p_chunk->i_first_dts;
-    while( i_sample > 0 && i_index < p_chunk->i_entries_dts )
+    uint32_t i_skip = p_chunk->i_stts_skip;
+    for( uint32_t i_index = p_chunk->i_stts_entry;
+         i_sample > 0 && i_index < stts->i_entry_count; i_index++ )
     {
-        if( i_sample > p_chunk->p_sample_count_dts[i_index] )
+        uint32_t i_count = stts->pi_sample_count[i_index] - i_skip;
+        uint32_t i_delta = stts->pi_sample_delta[i_index];
+        i_skip = 0;
+        if( i_sample > i_count )
         {
-            sdts += (stime_t)p_chunk->p_sample_count_dts[i_index] *
-                p_chunk->p_sample_delta_dts[i_index];
-            i_sample -= p_chunk->p_sample_count_dts[i_index++];
+            sdts += (stime_t)i_count * i_delta;
+            i_sample -= i_count;
         }
         else
         {
-            sdts += (stime_t)i_sample * p_chunk->p_sample_delta_dts[i_index];
+            sdts += (stime_t)i_sample * i_delta;
             break;
         }
     }
     return sdts;
 }
 
-static bool MP4_ChunkGetSampleCTSDelta( const mp4_chunk_t *p_chunk,
+static bool MP4_ChunkGetSampleCTSDelta( const mp4_track_t *p_track,
+                                        const mp4_chunk_t *p_chunk,
                                         uint32_t i_sample, stime_t *pi_delta )
 {
-    if( p_chunk->p_sample_count_pts && p_chunk->p_sample_offset_pts )
+    const MP4_Box_data_ctts_t *ctts = p_track->p_ctts;
+    if( ctts == NULL || i_sample >= p_chunk->i_sample_count )
+        return false;
+
+    uint32_t i_skip = p_chunk->i_ctts_skip;
+    for( uint32_t i_index = p_chunk->i_ctts_entry;
+         i_index < ctts->i_entry_count; i_index++ )
     {
-        for( uint32_t i_index = 0; i_index < p_chunk->i_entries_pts ; i_index++ )
+        uint32_t i_count = ctts->pi_sample_count[i_index] - i_skip;
+        i_skip = 0;
+        if( i_sample < i_count )
         {
-            if( i_sample < p_chunk->p_sample_count_pts[i_index] )
-            {
-                *pi_delta = p_chunk->p_sample_offset_pts[i_index];
-                return true;
-            }
-            i_sample -= p_chunk->p_sample_count_pts[i_index];
+            int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + p_track->i_cts_shift;
+            *pi_delta = i_ctsdelta > 0 ? i_ctsdelta : 0; /* < 0 should not */
+            return true;
         }
+        i_sample -= i_count;
     }
     return false;
 }
@@ -614,55 +606,30 @@ static vlc_tick_t MP4_TrackGetDTSPTS( demux_t *p_demux, const mp4_track_t *p_tra
     return i_dts;
 }
 
-static stime_t MP4_GetChunkSamplesDuration( const mp4_chunk_t *p_chunk,
+static stime_t MP4_GetChunkSamplesDuration( const mp4_track_t *p_track,
+                                            const mp4_chunk_t *p_chunk,
                                             uint32_t i_start_sample,
                                             uint32_t i_nb_samples )
 {
-    stime_t i_duration = 0;
-
-    /* Forward to right index, and set remaining count in that index */
-    uint32_t i_index = 0;
-    uint32_t i_remain = 0;
-    for( uint32_t i = p_chunk->i_sample_first;
-         i<i_start_sample && i_index < p_chunk->i_entries_dts; )
-    {
-        if( i_start_sample - i >= p_chunk->p_sample_count_dts[i_index] )
-        {
-            i += p_chunk->p_sample_count_dts[i_index];
-            i_index++;
-        }
-        else
-        {
-            i_remain = i_start_sample - i;
-            break;
-        }
-    }
+    uint32_t i_first = 0;
+    if( i_start_sample > p_chunk->i_sample_first )
+        i_first = i_start_sample - p_chunk->i_sample_first;
+    if( i_first >= p_chunk->i_sample_count )
+        return 0;
 
-    /* Compute total duration from all samples from index */
-    while( i_nb_samples > 0 && i_index < p_chunk->i_entries_dts )
-    {
-        if( i_nb_samples >= p_chunk->p_sample_count_dts[i_index] - i_remain )
-        {
-            i_duration += (p_chunk->p_sample_count_dts[i_index] - i_remain) *
-                          (int64_t) p_chunk->p_sample_delta_dts[i_index];
-            i_nb_samples -= (p_chunk->p_sample_count_dts[i_index] - i_remain);
-            i_index++;
-            i_remain = 0;
-        }
-        else
-        {
-            i_duration += (stime_t)i_nb_samples * p_chunk->p_sample_delta_dts[i_index];
-            break;
-        }
-    }
+    /* only account for the samples of this chunk */
+    uint32_t i_last = i_first + __MIN( i_nb_samples,
+                                       p_chunk->i_sample_count - i_first );
 
-    return i_duration;
+    return MP4_ChunkGetSampleDTS( p_track, p_chunk, i_last ) -
+           MP4_ChunkGetSampleDTS( p_track, p_chunk, i_first );
 }
 
 static inline vlc_tick_t MP4_GetSamplesDuration( const mp4_track_t *p_track,
                                                  uint32_t i_nb_samples )
 {
-    stime_t i_duration = MP4_GetChunkSamplesDuration( &p_track->chunk[p_track->i_chunk],
+    stime_t i_duration = MP4_GetChunkSamplesDuration( p_track,
+                                                      &p_track->chunk[p_track->i_chunk],
                                                       p_track->i_sample,
                                                       i_nb_samples );
     return MP4_rescale_mtime( i_duration, p_track->i_timescale );
@@ -2581,14 +2548,7 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
         mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
 
         ck->i_offset = BOXDATA(p_co64)->i_chunk_offset[i_chunk];
-
         ck->i_first_dts = 0;
-        ck->i_entries_dts = 0;
-        ck->p_sample_count_dts = NULL;
-        ck->p_sample_delta_dts = NULL;
-        ck->i_entries_pts = 0;
-        ck->p_sample_count_pts = NULL;
-        ck->p_sample_offset_pts = NULL;
     }
 
     /* now we read index for SampleEntry( soun vide mp4a mp4v ...)
@@ -2650,52 +2610,32 @@ static int TrackCreateChunksIndex( demux_t *p_demux,
     return VLC_SUCCESS;
 }
 
-static int xTTS_CountEntries( demux_t *p_demux, uint32_t *pi_entry /* out */,
-                              const uint32_t i_index,
-                              uint32_t i_index_samples_left,
-                              uint32_t i_sample_count,
-                              const uint32_t *pi_index_sample_count,
-                              const uint32_t i_table_count )
+/* Moves a stts/ctts run-length cursor forward by i_sample_count samples.
+ * Returns the sum of the values of the samples skipped (when pi_value is
+ * set) and false if the table was exhausted before. */
+static bool xTTS_Advance( const uint32_t *pi_count, const int32_t *pi_value,
+                          uint32_t i_table_count,
+                          uint32_t *pi_index, uint32_t *pi_skip,
+                          uint32_t i_sample_count, int64_t *pi_sum )
 {
-    uint32_t i_array_offset;
     while( i_sample_count > 0 )
     {
-        if ( likely((UINT32_MAX - i_index) >= *pi_entry) )
-            i_array_offset = i_index + *pi_entry;
-        else
-            return VLC_EGENERIC;
-
-        if ( i_array_offset >= i_table_count )
-        {
-            msg_Err( p_demux, "invalid index counting total samples %u %u", i_array_offset,  i_table_count );
-            return VLC_EINVAL;
-        }
+        if( *pi_index >= i_table_count )
+            return false;
 
-        if ( i_index_samples_left )
-        {
-            if ( i_index_samples_left > i_sample_count )
-            {
-                i_index_samples_left -= i_sample_count;
-                i_sample_count = 0;
-                *pi_entry +=1; /* No samples left, go copy */
-                break;
-            }
-            else
-            {
-                i_sample_count -= i_index_samples_left;
-                i_index_samples_left = 0;
-                *pi_entry += 1;
-                continue;
-            }
-        }
-        else
+        uint32_t i_left = pi_count[*pi_index] - *pi_skip;
+        uint32_t i_used = __MIN( i_left, i_sample_count );
+        if( pi_value )
+            *pi_sum += (int64_t)i_used * pi_value[*pi_index];
+        i_sample_count -= i_used;
+        if( i_used == i_left )
         {
-            i_sample_count -= __MIN( i_sample_count, pi_index_sample_count[i_array_offset] );
-            *pi_entry += 1;
+            *pi_index += 1;
+            *pi_skip = 0;
         }
+        else *pi_skip += i_used;
     }
-
-    return VLC_SUCCESS;
+    return true;
 }
 
 static int TrackCreateSamplesIndex( demux_t *p_demux,
@@ -2735,18 +2675,12 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
     }
     else
     {
-        /* 2: each sample can have a different size */
+        /* 2: each sample can have a different size, the box table
+         *    outlives the track so there's no need to copy it */
         p_demux_track->i_sample_size = 0;
-        p_demux_track->p_sample_size =
-            calloc( p_demux_track->i_sample_count, sizeof( uint32_t ) );
+        p_demux_track->p_sample_size = stsz->i_entry_size;
         if( p_demux_track->p_sample_size == NULL )
-            return VLC_ENOMEM;
-
-        for( uint32_t i_sample = 0; i_sample < p_demux_track->i_sample_count; i_sample++ )
-        {
-            p_demux_track->p_sample_size[i_sample] =
-                    stsz->i_entry_size[i_sample];
-        }
+            return VLC_EGENERIC;
     }
 
     if ( p_demux_track->i_chunk_count && p_demux_track->i_sample_size == 0 )
@@ -2759,132 +2693,64 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
         }
     }
 
-    /* Use stts table to create a sample number -> dts table.
-     * XXX: if we don't want to waste too much memory, we can't expand
-     *  the box! so each chunk will contain an "extract" of this table
-     *  for fast research (problem with raw stream where a sample is sometime
-     *  just channels*bits_per_sample/8 */
-
-     /* FIXME: refactor STTS & CTTS, STTS having now only few extra lines and
-      *        differing in 2/2 fields and 1 signedness */
+    /* The stts and ctts tables are kept in their run-length form.
+     * Each chunk only stores a cursor to its first sample entry, and
+     * samples timings are decoded on demand from there. */
 
     int64_t i_next_dts = 0;
     /* Find stts
      *  Gives mapping between sample and decoding time
      */
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "stts" );
-    if( !p_box )
+    if( !p_box || !p_box->data.p_stts )
     {
         msg_Warn( p_demux, "cannot find STTS box" );
         return VLC_EGENERIC;
     }
     else
     {
-        MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        const MP4_Box_data_stts_t *stts = p_box->data.p_stts;
+        p_demux_track->p_stts = stts;
 
         msg_Warn( p_demux, "STTS table of %"PRIu32" entries", stts->i_entry_count );
 
-        /* Create sample -> dts table per chunk */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
+        bool b_complete = true;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
 
             /* save first dts */
             ck->i_first_dts = i_next_dts;
+            ck->i_stts_entry = i_index;
+            ck->i_stts_skip = i_skip;
 
-            /* count how many entries are needed for this chunk
-             * for p_sample_delta_dts and p_sample_count_dts */
-            ck->i_entries_dts = 0;
-
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_dts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           stts->pi_sample_count,
-                                           stts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
+            if( !xTTS_Advance( stts->pi_sample_count, stts->pi_sample_delta,
+                               stts->i_entry_count, &i_index, &i_skip,
+                               ck->i_sample_count, &i_next_dts ) )
+                b_complete = false;
 
-            /* allocate them */
-            i_ret = MP4_ChunkAllocEntries( ck->i_entries_dts,
-                                           ck->small_dts_buf,
-                                           &ck->p_sample_count_dts,
-                                           &ck->p_sample_delta_dts );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_dts );
-                ck->i_entries_dts = 0;
-                return i_ret;
-            }
-
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
-
-            for( uint32_t i = 0; i < ck->i_entries_dts; i++ )
-            {
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = i_current_index_samples_left;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_current_index_samples_left ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( stts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_dts[i] = i_sample_count;
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( i_sample_count ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_current_index_samples_left = stts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_dts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_dts[i] = stts->pi_sample_count[i_index];
-                        ck->p_sample_delta_dts[i] = stts->pi_sample_delta[i_index];
-                        i_next_dts += (int64_t)ck->p_sample_count_dts[i] * stts->pi_sample_delta[i_index];
-                        if ( stts->pi_sample_count[i_index] ) ck->i_duration = i_next_dts - ck->i_first_dts;
-                        i_sample_count -= stts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-            }
+            ck->i_duration = i_next_dts - ck->i_first_dts;
         }
+
+        if( !b_complete )
+            msg_Err( p_demux, "invalid index counting total samples, stts "
+                              "table is too small (%"PRIu32")", stts->i_entry_count );
     }
 
 
     /* Find ctts
      *  Gives the delta between decoding time (dts) and composition table (pts)
      */
+    p_demux_track->p_ctts = NULL;
+    p_demux_track->i_cts_shift = 0;
     p_box = MP4_BoxGet( p_demux_track->p_stbl, "ctts" );
     if( p_box && p_box->data.p_ctts )
     {
-        MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        const MP4_Box_data_ctts_t *ctts = p_box->data.p_ctts;
+        p_demux_track->p_ctts = ctts;
 
         msg_Warn( p_demux, "CTTS table of %"PRIu32" entries", ctts->i_entry_count );
 
@@ -2902,89 +2768,20 @@ static int TrackCreateSamplesIndex( demux_t *p_demux,
                     i_cts_shift = -ctts->pi_sample_offset[i];
             }
         }
+        p_demux_track->i_cts_shift = i_cts_shift;
 
-        /* Create pts-dts table per chunk */
         uint32_t i_index = 0;
-        uint32_t i_current_index_samples_left = 0;
+        uint32_t i_skip = 0;
 
         for( uint32_t i_chunk = 0; i_chunk < p_demux_track->i_chunk_count; i_chunk++ )
         {
             mp4_chunk_t *ck = &p_demux_track->chunk[i_chunk];
-            uint32_t i_sample_count;
-
-            /* count how many entries are needed for this chunk
-             * for p_sample_offset_pts and p_sample_count_pts */
-            ck->i_entries_pts = 0;
-            int i_ret = xTTS_CountEntries( p_demux, &ck->i_entries_pts, i_index,
-                                           i_current_index_samples_left,
-                                           ck->i_sample_count,
-                                           ctts->pi_sample_count,
-                                           ctts->i_entry_count );
-            if ( i_ret == VLC_EGENERIC )
-                return i_ret;
-
-            /* allocate them */
-            i_ret = MP4_ChunkAllocEntries( ck->i_entries_pts,
-                                           ck->small_pts_buf,
-                                           &ck->p_sample_count_pts,
-                                           &ck->p_sample_offset_pts );
-            if( i_ret )
-            {
-                msg_Err( p_demux, "can't allocate memory for i_entry=%"PRIu32, ck->i_entries_pts );
-                ck->i_entries_pts = 0;
-                return i_ret;
-            }
 
-            /* now copy */
-            i_sample_count = ck->i_sample_count;
+            ck->i_ctts_entry = i_index;
+            ck->i_ctts_skip = i_skip;
 
-            for( uint32_t i = 0; i < ck->i_entries_pts; i++ )
-            {
-                int64_t i_ctsdelta = ctts->pi_sample_offset[i_index] + i_cts_shift;
-                if( i_ctsdelta < 0 ) /* should not */
-                    i_ctsdelta = 0;
-                if ( i_current_index_samples_left )
-                {
-                    if ( i_current_index_samples_left > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left -= i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        break;
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = i_current_index_samples_left;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= i_current_index_samples_left;
-                        i_current_index_samples_left = 0;
-                        i_index++;
-                    }
-                }
-                else
-                {
-                    if ( ctts->pi_sample_count[i_index] > i_sample_count )
-                    {
-                        ck->p_sample_count_pts[i] = i_sample_count;
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_current_index_samples_left = ctts->pi_sample_count[i_index] - i_sample_count;
-                        i_sample_count = 0;
-                        assert( i == ck->i_entries_pts - 1 );
-                        // keep building from same index
-                    }
-                    else
-                    {
-                        ck->p_sample_count_pts[i] = ctts->pi_sample_count[i_index];
-                        ck->p_sample_offset_pts[i] = i_ctsdelta;
-                        i_sample_count -= ctts->pi_sample_count[i_index];
-                        i_index++;
-                    }
-                }
-
-
-            }
+            xTTS_Advance( ctts->pi_sample_count, NULL, ctts->i_entry_count,
+                          &i_index, &i_skip, ck->i_sample_count, NULL );
         }
     }
 
@@ -3296,24 +3093,30 @@ static int STTSToSampleChunk(const mp4_track_t *p_track, uint64_t i_dts,
     }
 
     /* *** find sample in the chunk *** */
+    const MP4_Box_data_stts_t *stts = p_track->p_stts;
     uint32_t i_sample = ck->i_sample_first;
+    uint32_t i_left = ck->i_sample_count;
+    uint32_t i_skip = ck->i_stts_skip;
     uint64_t i_entrydts = ck->i_first_dts;
 
-    for( uint_fast32_t i = 0;
-         i < ck->i_entries_dts && i_sample < ck->i_sample_count;
+    for( uint32_t i = ck->i_stts_entry;
+         i < stts->i_entry_count && i_left > 0;
          i++ )
     {
-        uint64_t i_entry_duration = ck->p_sample_count_dts[i] * (uint64_t)
-                                    ck->p_sample_delta_dts[i];
+        uint32_t i_count = __MIN( stts->pi_sample_count[i] - i_skip, i_left );
+        uint32_t i_delta = stts->pi_sample_delta[i];
+        i_skip = 0;
+        uint64_t i_entry_duration = i_count * (uint64_t) i_delta;
         if( i_entrydts + i_entry_duration < i_dts )
         {
             i_entrydts += i_entry_duration;
-            i_sample += ck->p_sample_count_dts[i];
+            i_sample += i_count;
+            i_left -= i_count;
         }
         else
         {
-            if( ck->p_sample_delta_dts[i] > 0 )
-                i_sample += ( i_dts - i_entrydts ) / ck->p_sample_delta_dts[i];
+            if( i_delta > 0 )
+                i_sample += ( i_dts - i_entrydts ) / i_delta;
             break;
         }
     }
@@ -3519,8 +3322,7 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
     p_track->i_start_delta = p_track->i_next_delta;
 
     /* Probe the 16 first B frames */
-    const mp4_chunk_t *p_chunk = &p_track->chunk[p_track->i_chunk];
-    if( p_chunk->i_entries_pts )
+    if( p_track->p_ctts )
     {
         for( uint32_t i=1; i<16; i++ )
         {
@@ -3529,9 +3331,9 @@ static void TrackUpdateStarttimes( mp4_track_t *p_track )
             if(!ck)
                 break;
             stime_t pts;
-            stime_t dts = pts = MP4_ChunkGetSampleDTS( ck, i_nextsample - ck->i_sample_first );
+            stime_t dts = pts = MP4_ChunkGetSampleDTS( p_track, ck, i_nextsample - ck->i_sample_first );
             stime_t delta = UNKNOWN_DELTA;
-            if( MP4_ChunkGetSampleCTSDelta( ck, i_nextsample - ck->i_sample_first, &delta ) )
+            if( MP4_ChunkGetSampleCTSDelta( p_track, ck, i_nextsample - ck->i_sample_first, &delta ) )
                 pts += delta;
             stime_t lowest = p_track->i_start_dts;
             if( p_track->i_start_delta != UNKNOWN_DELTA )
@@ -3551,9 +3353,9 @@ static void TrackUpdateSampleAndTimes( mp4_track_t *p_track )
     uint32_t i_chunk_sample = p_track->i_sample - p_chunk->i_sample_first;
     if( i_chunk_sample > p_chunk->i_sample_count && p_chunk->i_sample_count )
         i_chunk_sample = p_chunk->i_sample_count - 1;
-    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_chunk, i_chunk_sample );
+    p_track->i_next_dts = MP4_ChunkGetSampleDTS( p_track, p_chunk, i_chunk_sample );
     stime_t i_next_delta;
-    if( !MP4_ChunkGetSampleCTSDelta( p_chunk, i_chunk_sample, &i_next_delta ) )
+    if( !MP4_ChunkGetSampleCTSDelta( p_track, p_chunk, i_chunk_sample, &i_next_delta ) )
         p_track->i_next_delta = UNKNOWN_DELTA;
     else
         p_track->i_next_delta = i_next_delta;
@@ -3848,16 +3650,8 @@ static void MP4_TrackClean( es_out_t *out, mp4_track_t *p_track )
     if( p_track->p_es )
         es_out_Del( out, p_track->p_es );
 
-    if( p_track->chunk )
-    {
-        for( unsigned int i_chunk = 0; i_chunk < p_track->i_chunk_count; i_chunk++ )
-            MP4_ChunkDestroy( &p_track->chunk[i_chunk] );
-    }
     free( p_track->chunk );
 
-    if( !p_track->i_sample_size )
-        free( p_track->p_sample_size );
-
     ASFPacketTrackReset( &p_track->asfinfo );
 
     free( p_track->context.runs.p_array );
@@ -4556,93 +4350,212 @@ static bool GetMoofTrackDuration( MP4_Box_t *p_moov, MP4_Box_t *p_moof,
     return true;
 }
 
-static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
+/* Below that size, boxes are read through instead of seeking over, as a
+ * new request costs more than the data on slow seeking streams */
+#define FRAGS_SCAN_READTHROUGH (256 * 1024)
+
+static int FragScanSkipTo( demux_t *p_demux, uint64_t i_pos )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
+    const uint64_t i_tell = vlc_stream_Tell( p_demux->s );
+    if( i_pos == i_tell )
+        return VLC_SUCCESS;
+    if( !p_sys->b_fastseekable && i_pos > i_tell &&
+        i_pos - i_tell <= FRAGS_SCAN_READTHROUGH )
+    {
+        const size_t i_toread = i_pos - i_tell;
+        return vlc_stream_Read( p_demux->s, NULL, i_toread ) == (ssize_t) i_toread
+               ? VLC_SUCCESS : VLC_EGENERIC;
+    }
+    return vlc_stream_Seek( p_demux->s, i_pos );
+}
 
-    msg_Dbg( p_demux, "probing fragments from %"PRId64, vlc_stream_Tell( p_demux->s ) );
-
-    assert( p_sys->p_root );
+/* Adds the media subsegments references of a sidx to the index,
+ * and returns the end position of the indexed range, or 0 */
+static uint64_t FragScanIndexSidx( demux_t *p_demux, const MP4_Box_t *p_sidx,
+                                   stime_t *pi_track_times, stime_t *pi_movie_times )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    const MP4_Box_data_sidx_t *p_data = BOXDATA(p_sidx);
+    if( !p_data || !p_data->i_timescale || !p_data->i_reference_count )
+        return 0;
 
-    MP4_Box_t *p_vroot = MP4_BoxNew(ATOM_root);
-    if( !p_vroot )
-        return VLC_EGENERIC;
+    /* only handle flat indexes of fragments */
+    for( uint16_t i=0; i<p_data->i_reference_count; i++ )
+        if( p_data->p_items[i].b_reference_type != 0 )
+            return 0;
+
+    uint64_t i_pos = p_data->i_first_offset + p_sidx->i_pos + p_sidx->i_size;
+    stime_t i_time = p_data->i_earliest_presentation_time;
+    for( uint16_t i=0; i<p_data->i_reference_count; i++ )
+    {
+        const stime_t i_movietime = MP4_rescale( i_time, p_data->i_timescale,
+                                                 p_sys->i_timescale );
+        for( unsigned j=0; j<p_sys->i_tracks; j++ )
+            pi_movie_times[j] = i_movietime;
+        if( MP4_Fragments_Index_Append( p_sys->p_fragsindex, i_pos,
+                                        pi_movie_times ) != VLC_SUCCESS )
+            return 0;
+        i_pos += p_data->p_items[i].i_referenced_size;
+        i_time += p_data->p_items[i].i_subsegment_duration;
+    }
+
+    for( unsigned j=0; j<p_sys->i_tracks; j++ )
+        pi_track_times[j] = MP4_rescale( i_time, p_data->i_timescale,
+                                         p_sys->track[j].i_timescale );
+    return i_pos;
+}
 
-    if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
+static void FragScanIndexMoof( demux_sys_t *p_sys, MP4_Box_t *p_moof,
+                               stime_t *pi_track_times, stime_t *pi_movie_times )
+{
+    for( unsigned i=0; i<p_sys->i_tracks; i++ )
     {
-        MP4_ReadBoxContainerChildren( p_demux->s, p_vroot, NULL ); /* Get the rest of the file */
-        p_sys->b_fragments_probed = true;
+        MP4_Box_t *p_tfdt = NULL;
+        MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
+        if( p_traf )
+            p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
 
-        const unsigned i_moof = MP4_BoxCount( p_vroot, "/moof" );
-        if( i_moof )
+        if( p_tfdt && BOXDATA(p_tfdt) )
         {
-            *pb_fragmented = true;
-            p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, i_moof );
-            if( !p_sys->p_fragsindex )
-            {
-                MP4_BoxFree( p_vroot );
-                return VLC_EGENERIC;
-            }
-
-            stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
-            if( !pi_track_times )
-            {
-                MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
-                p_sys->p_fragsindex = NULL;
-                MP4_BoxFree( p_vroot );
-                return VLC_EGENERIC;
-            }
+            pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
+        }
+        else if( p_sys->p_fragsindex->i_entries == 0 ) /* Set first fragment time offset from moov */
+        {
+            stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
+            pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
+        }
 
-            unsigned index = 0;
+        pi_movie_times[i] = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
 
-            for( MP4_Box_t *p_moof = p_vroot->p_first; p_moof; p_moof = p_moof->p_next )
-            {
-                if( p_moof->i_type != ATOM_moof )
-                    continue;
+        stime_t i_duration = 0;
+        if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
+            pi_track_times[i] += i_duration;
+    }
+}
 
-                for( unsigned i=0; i<p_sys->i_tracks; i++ )
-                {
-                    MP4_Box_t *p_tfdt = NULL;
-                    MP4_Box_t *p_traf = MP4_GetTrafByTrackID( p_moof, p_sys->track[i].i_track_ID );
-                    if( p_traf )
-                        p_tfdt = MP4_BoxGet( p_traf, "tfdt" );
+/* Builds the fragments index in a single pass over the remaining top level
+ * boxes. Only the moof headers are parsed, one at a time, and the
+ * subsegments covered by a sidx are indexed without being visited. */
+static int FragScanIndex( demux_t *p_demux, bool *pb_fragmented )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
 
-                    if( p_tfdt && BOXDATA(p_tfdt) )
-                    {
-                        pi_track_times[i] = p_tfdt->data.p_tfdt->i_base_media_decode_time;
-                    }
-                    else if( index == 0 ) /* Set first fragment time offset from moov */
-                    {
-                        stime_t i_duration = GetMoovTrackDuration( p_sys, p_sys->track[i].i_track_ID );
-                        pi_track_times[i] = MP4_rescale( i_duration, p_sys->i_timescale, p_sys->track[i].i_timescale );
-                    }
+    p_sys->p_fragsindex = MP4_Fragments_Index_New( p_sys->i_tracks, 64 );
+    stime_t *pi_track_times = calloc( p_sys->i_tracks, sizeof(*pi_track_times) );
+    stime_t *pi_movie_times = calloc( p_sys->i_tracks, sizeof(*pi_movie_times) );
+    if( !p_sys->p_fragsindex || !pi_track_times || !pi_movie_times )
+    {
+        free( pi_track_times );
+        free( pi_movie_times );
+        MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
+        p_sys->p_fragsindex = NULL;
+        return VLC_ENOMEM;
+    }
 
-                    stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                    p_sys->p_fragsindex->p_times[index * p_sys->i_tracks + i] = i_movietime;
+    int i_ret = VLC_SUCCESS;
+    for( ;; )
+    {
+        const uint8_t *p_peek;
+        if( vlc_stream_Peek( p_demux->s, &p_peek, 16 ) < 16 )
+            break;
 
-                    stime_t i_duration = 0;
-                    if( GetMoofTrackDuration( p_sys->p_moov, p_moof, p_sys->track[i].i_track_ID, &i_duration ) )
-                        pi_track_times[i] += i_duration;
-                }
+        const uint64_t i_pos = vlc_stream_Tell( p_demux->s );
+        const uint32_t i_type = VLC_FOURCC( p_peek[4], p_peek[5], p_peek[6], p_peek[7] );
+        uint64_t i_size = GetDWBE( p_peek );
+        if( i_size == 1 )
+            i_size = GetQWBE( &p_peek[8] );
+        if( i_size < 8 || UINT64_MAX - i_size < i_pos )
+            break; /* invalid, or extends up to the end of file */
 
-                p_sys->p_fragsindex->pi_pos[index++] = p_moof->i_pos;
+        uint64_t i_next = i_pos + i_size;
+        if( i_type == ATOM_moof || i_type == ATOM_sidx )
+        {
+            MP4_Box_t *p_vroot = MP4_BoxNew( ATOM_root );
+            if( !p_vroot )
+            {
+                i_ret = VLC_ENOMEM;
+                break;
             }
+            const uint32_t stoplist[] = { i_type, 0 };
+            MP4_ReadBoxContainerChildren( p_demux->s, p_vroot, stoplist );
 
-            for( unsigned i=0; i<p_sys->i_tracks; i++ )
+            /* ignore anything else read past a failed box */
+            MP4_Box_t *p_box = p_vroot->p_first;
+            if( p_box && p_box->i_pos != i_pos )
+                p_box = NULL;
+
+            if( p_box && p_box->i_type == ATOM_moof )
+            {
+                *pb_fragmented = true;
+                FragScanIndexMoof( p_sys, p_box, pi_track_times, pi_movie_times );
+                i_ret = MP4_Fragments_Index_Append( p_sys->p_fragsindex, p_box->i_pos,
+                                                    pi_movie_times );
+            }
+            else if( p_box && p_box->i_type == ATOM_sidx )
             {
-                stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
-                if( p_sys->p_fragsindex->i_last_time < i_movietime )
-                    p_sys->p_fragsindex->i_last_time = i_movietime;
+                uint64_t i_end = FragScanIndexSidx( p_demux, p_box,
+                                                    pi_track_times, pi_movie_times );
+                if( i_end > i_next )
+                {
+                    *pb_fragmented = true;
+                    i_next = i_end;
+                }
             }
+            MP4_BoxFree( p_vroot );
+            if( i_ret != VLC_SUCCESS )
+                break;
+        }
 
-            free( pi_track_times );
+        if( FragScanSkipTo( p_demux, i_next ) != VLC_SUCCESS ||
+            vlc_stream_Tell( p_demux->s ) != i_next )
+            break;
+    }
+
+    if( p_sys->p_fragsindex->i_entries )
+    {
+        for( unsigned i=0; i<p_sys->i_tracks; i++ )
+        {
+            stime_t i_movietime = MP4_rescale( pi_track_times[i], p_sys->track[i].i_timescale, p_sys->i_timescale );
+            if( p_sys->p_fragsindex->i_last_time < i_movietime )
+                p_sys->p_fragsindex->i_last_time = i_movietime;
+        }
+        msg_Dbg( p_demux, "indexed %u fragments", p_sys->p_fragsindex->i_entries );
 #ifdef MP4_VERBOSE
-            MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
+        MP4_Fragments_Index_Dump( VLC_OBJECT(p_demux), p_sys->p_fragsindex, p_sys->i_timescale );
 #endif
-        }
     }
     else
     {
+        MP4_Fragments_Index_Delete( p_sys->p_fragsindex );
+        p_sys->p_fragsindex = NULL;
+    }
+
+    free( pi_track_times );
+    free( pi_movie_times );
+    return i_ret;
+}
+
+static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    msg_Dbg( p_demux, "probing fragments from %"PRId64, vlc_stream_Tell( p_demux->s ) );
+
+    assert( p_sys->p_root );
+
+    if( p_sys->b_seekable && (p_sys->b_fastseekable || b_force) )
+    {
+        p_sys->b_fragments_probed = true;
+        if( FragScanIndex( p_demux, pb_fragmented ) != VLC_SUCCESS )
+            return VLC_EGENERIC;
+    }
+    else
+    {
+        MP4_Box_t *p_vroot = MP4_BoxNew(ATOM_root);
+        if( !p_vroot )
+            return VLC_EGENERIC;
+
         /* We stop at first moof, which validates our fragmentation condition
          * and we'll find others while reading. */
         const uint32_t excllist[] = { ATOM_moof, 0 };
@@ -4653,9 +4566,9 @@ static int ProbeFragments( demux_t *p_demux, bool b_force, bool *pb_fragmented )
             *pb_fragmented = (VLC_FOURCC( p_peek[4], p_peek[5], p_peek[6], p_peek[7] ) == ATOM_moof);
         else
             *pb_fragmented = false;
-    }
 
-    MP4_BoxFree( p_vroot );
+        MP4_BoxFree( p_vroot );
+    }
 
     MP4_Box_t *p_mehd = MP4_BoxGet( p_sys->p_moov, "mvex/mehd");
     if ( !p_mehd )
@@ -44,6 +44,8 @@
 #include "../../meta_engine/ID3Text.h"
 #include "../../meta_engine/ID3Meta.h"
 
+#include "es_seektable.h"
+
 /*****************************************************************************
  * Module descriptor
  *****************************************************************************/
@@ -55,6 +57,11 @@ static void Close    ( vlc_object_t * );
 #define FPS_LONGTEXT N_("This is the frame rate used as a fallback when " \
     "playing MPEG video elementary streams.")
 
+#define SEEK_INDEX_TEXT N_("Build a seek index")
+#define SEEK_INDEX_LONGTEXT N_("Read the audio frame headers in the " \
+    "background to get exact seek positions and duration of variable " \
+    "bitrate files.")
+
 vlc_module_begin ()
     set_subcategory( SUBCAT_INPUT_DEMUX )
     set_description( N_("MPEG-I/II/4 / A52 / DTS / MLP audio" ) )
@@ -69,6 +76,8 @@ vlc_module_begin ()
                   "dts",
                   "mlp", "thd" )
 
+    add_bool( "es-seek-index", true, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT )
+
     add_submodule()
     set_description( N_("MPEG-4 video" ) )
     set_capability( "demux", 5 )
@@ -365,6 +374,11 @@ typedef struct
     float rgf_replay_peak[AUDIO_REPLAY_GAIN_MAX];
 
     sync_table_t mllt;
+
+    /* built from the frame headers, when no exact table is available */
+    seektable_t    seektable;
+    bool           b_seektable;
+
     struct
     {
         size_t i_count;
@@ -392,6 +406,7 @@ static int MlpInit( demux_t *p_demux );
 
 static bool Parse( demux_t *p_demux, block_t **pp_output );
 static int SeekByMlltTable( sync_table_t *, vlc_tick_t *, uint64_t * );
+static void SeekTableStart( demux_t *p_demux );
 
 static const codec_t p_codecs[] = {
     { VLC_CODEC_MP4A, false, "mp4 audio",  AacProbe,  AacInit },
@@ -489,6 +504,8 @@ static int OpenCommon( demux_t *p_demux,
             break;
     }
 
+    SeekTableStart( p_demux );
+
     return VLC_SUCCESS;
 }
 static int OpenAudio( vlc_object_t *p_this )
@@ -606,6 +623,47 @@ static int Demux( demux_t *p_demux )
     return ret;
 }
 
+/*****************************************************************************
+ * Seek table: scans the frame headers on a separate stream
+ *****************************************************************************/
+static int SeekTableScan( seektable_t *p_table, stream_t *s, void *opaque )
+{
+    demux_sys_t *p_sys = opaque;
+
+    return es_seektable_Scan( p_table, s, p_sys->codec.i_codec,
+                              p_sys->b_big_endian );
+}
+
+static void SeekTableStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !es_seektable_IsSupported( p_sys->codec.i_codec ) ||
+        p_sys->mllt.p_bits || p_demux->b_preparsing ||
+        !var_InheritBool( p_demux, "es-seek-index" ) )
+        return;
+
+    seektable_Init( &p_sys->seektable );
+    if( seektable_Start( &p_sys->seektable, p_demux, "vlc-es-index",
+                         p_sys->i_stream_offset, SeekTableScan, p_sys ) )
+    {
+        seektable_Clean( &p_sys->seektable );
+        return;
+    }
+    p_sys->b_seektable = true;
+}
+
+static void SeekTableStop( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->b_seektable )
+        return;
+
+    seektable_Clean( &p_sys->seektable );
+    p_sys->b_seektable = false;
+}
+
 /*****************************************************************************
  * Close: frees unused data
  *****************************************************************************/
@@ -614,6 +672,7 @@ static void Close( vlc_object_t * p_this )
     demux_t     *p_demux = (demux_t*)p_this;
     demux_sys_t *p_sys = p_demux->p_sys;
 
+    SeekTableStop( p_demux );
     if( p_sys->p_packetized_data )
         block_ChainRelease( p_sys->p_packetized_data );
     for( size_t i=0; i< p_sys->chapters.i_count; i++ )
@@ -673,6 +732,8 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         case DEMUX_GET_LENGTH:
         {
+            if( p_sys->i_duration == 0 && p_sys->b_seektable )
+                seektable_GetEndTime( &p_sys->seektable, &p_sys->i_duration );
             if( p_sys->i_duration > 0 )
             {
                 *va_arg( args, vlc_tick_t * ) = p_sys->i_duration;
@@ -715,6 +776,9 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             double f_pos;
             uint64_t i_offset;
 
+            if( p_sys->i_duration == 0 && p_sys->b_seektable )
+                seektable_GetEndTime( &p_sys->seektable, &p_sys->i_duration );
+
             va_list ap;
             va_copy ( ap, args ); /* don't break args for helper fallback */
             if( i_query == DEMUX_SET_TIME )
@@ -735,6 +799,38 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             if( !SeekByMlltTable( &p_sys->mllt, &i_time, &i_offset ) )
                 return MovetoTimePos( p_demux, i_time, i_offset );
 
+            /* Try the table built from the frame headers */
+            if( p_sys->b_seektable )
+            {
+                seektable_point_t point;
+                int i_ret = VLC_EGENERIC;
+
+                if( i_query == DEMUX_SET_TIME )
+                {
+                    i_ret = seektable_SeekByTime( &p_sys->seektable, i_time,
+                                                  &point );
+                }
+                else
+                {
+                    uint64_t streamsize;
+                    if( !vlc_stream_GetSize( p_demux->s, &streamsize ) &&
+                        streamsize > p_sys->i_stream_offset )
+                        i_ret = seektable_SeekByPos( &p_sys->seektable,
+                                    f_pos * (streamsize - p_sys->i_stream_offset),
+                                    &point );
+                }
+
+                if( i_ret == VLC_SUCCESS &&
+                    MovetoTimePos( p_demux, point.i_time, point.i_pos ) == VLC_SUCCESS )
+                {
+                    /* the table points to the frame at or before the target */
+                    if( i_query == DEMUX_SET_TIME )
+                        es_out_Control( p_demux->out, ES_OUT_SET_NEXT_DISPLAY_TIME,
+                                        VLC_TICK_0 + i_time );
+                    return VLC_SUCCESS;
+                }
+            }
+
             if( p_sys->codec.i_codec == VLC_CODEC_MPGA )
             {
                 uint64_t streamsize;
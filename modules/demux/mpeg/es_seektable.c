@@ -0,0 +1,252 @@
+/*****************************************************************************
+ * es_seektable.c: audio elementary stream seek table
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+#include <vlc_codec.h>
+
+#include "../../packetizer/a52.h"
+#include "../../packetizer/mpegaudio.h"
+
+#include "es_seektable.h"
+
+#define ES_SEEKTABLE_BUFFER     (64 * 1024)
+/* larger than any frame (ADTS is 13 bits) plus the next header */
+#define ES_SEEKTABLE_LOOKAHEAD  (8192 + ES_SEEKTABLE_HEADER)
+#define ES_SEEKTABLE_HEADER     VLC_A52_MIN_HEADER_SIZE
+/* bytes without sync before giving up */
+#define ES_SEEKTABLE_MAX_LOST   (64 * 1024)
+/* seekpoints gathered before publishing them */
+#define ES_SEEKTABLE_BATCH      256
+
+/*****************************************************************************
+ * Frame headers
+ *****************************************************************************
+ * Return the frame size, or -1 if p_peek does not start a frame.
+ *****************************************************************************/
+static int MpgaParseFrame( const uint8_t *p_peek,
+                           unsigned *pi_samples, unsigned *pi_rate )
+{
+    struct mpga_frameheader_s mpgah;
+    uint32_t h = GetDWBE( p_peek );
+
+    if( ((h >> 21) & 0x07FF) != 0x07FF || ((h >> 19) & 0x03) == 1 ||
+        mpga_decode_frameheader( h, &mpgah ) )
+        return -1;
+    /* free format frames have no size */
+    if( mpgah.i_bit_rate == 0 || mpgah.i_frame_size == 0 )
+        return -1;
+
+    *pi_samples = mpgah.i_samples_per_frame;
+    *pi_rate = mpgah.i_sample_rate;
+    return mpgah.i_frame_size;
+}
+
+static int AdtsParseFrame( const uint8_t *p_peek,
+                           unsigned *pi_samples, unsigned *pi_rate )
+{
+    static const unsigned pi_sample_rates[16] =
+    {
+        96000, 88200, 64000, 48000, 44100, 32000,
+        24000, 22050, 16000, 12000, 11025, 8000,
+    };
+
+    /* syncword and layer */
+    if( p_peek[0] != 0xFF || (p_peek[1] & 0xF6) != 0xF0 )
+        return -1;
+
+    unsigned i_rate = pi_sample_rates[(p_peek[2] >> 2) & 0x0F];
+    int i_size = ((p_peek[3] & 0x03) << 11) | (p_peek[4] << 3) | (p_peek[5] >> 5);
+    unsigned i_header = (p_peek[1] & 0x01) ? 7 : 9;
+    if( i_rate == 0 || i_size < (int)i_header )
+        return -1;
+
+    *pi_samples = 1024 * ((p_peek[6] & 0x03) + 1);
+    *pi_rate = i_rate;
+    return i_size;
+}
+
+static int A52ParseFrame( const uint8_t *p_peek, bool b_big_endian,
+                          unsigned *pi_samples, unsigned *pi_rate )
+{
+    vlc_a52_header_t header;
+    uint8_t p_tmp[VLC_A52_MIN_HEADER_SIZE];
+
+    if( !b_big_endian )
+    {
+        swab( p_peek, p_tmp, VLC_A52_MIN_HEADER_SIZE );
+        p_peek = p_tmp;
+    }
+
+    if( vlc_a52_header_Parse( &header, p_peek, VLC_A52_MIN_HEADER_SIZE ) )
+        return -1;
+
+    /* only the first independent substream advances the time */
+    if( header.b_eac3 && (header.bs.eac3.strmtyp == EAC3_STRMTYP_DEPENDENT ||
+                          header.bs.eac3.i_substreamid != 0) )
+        *pi_samples = 0;
+    else
+        *pi_samples = header.i_samples;
+    *pi_rate = header.i_rate;
+    return header.i_size;
+}
+
+static int ParseFrame( vlc_fourcc_t i_codec, bool b_big_endian,
+                       const uint8_t *p_peek,
+                       unsigned *pi_samples, unsigned *pi_rate )
+{
+    switch( i_codec )
+    {
+        case VLC_CODEC_MPGA:
+            return MpgaParseFrame( p_peek, pi_samples, pi_rate );
+        case VLC_CODEC_MP4A:
+            return AdtsParseFrame( p_peek, pi_samples, pi_rate );
+        case VLC_CODEC_A52:
+        case VLC_CODEC_EAC3:
+            return A52ParseFrame( p_peek, b_big_endian, pi_samples, pi_rate );
+        default:
+            return -1;
+    }
+}
+
+bool es_seektable_IsSupported( vlc_fourcc_t i_codec )
+{
+    return i_codec == VLC_CODEC_MPGA || i_codec == VLC_CODEC_MP4A ||
+           i_codec == VLC_CODEC_A52 || i_codec == VLC_CODEC_EAC3;
+}
+
+/*****************************************************************************
+ * Scan
+ *****************************************************************************/
+int es_seektable_Scan( seektable_t *p_table, stream_t *s,
+                       vlc_fourcc_t i_codec, bool b_big_endian )
+{
+    seektable_point_t pending[ES_SEEKTABLE_BATCH];
+    size_t i_pending = 0;
+
+    uint8_t *p_buf = malloc( ES_SEEKTABLE_BUFFER );
+    if( !p_buf )
+        return VLC_ENOMEM;
+
+    size_t   i_buf = 0;     /* bytes in p_buf */
+    size_t   i_off = 0;     /* current offset in p_buf */
+    uint64_t i_buf_pos = 0; /* stream position of p_buf[0] */
+    bool     b_eof = false;
+
+    uint64_t i_samples = 0;
+    uint64_t i_frames = 0;
+    unsigned i_rate = 0;
+    bool     b_synced = false;
+    size_t   i_lost = 0;
+    int      i_ret = VLC_SUCCESS;
+
+    while( !seektable_IsAborted( p_table ) )
+    {
+        if( !b_eof && i_buf - i_off < ES_SEEKTABLE_LOOKAHEAD )
+        {
+            memmove( p_buf, &p_buf[i_off], i_buf - i_off );
+            i_buf -= i_off;
+            i_buf_pos += i_off;
+            i_off = 0;
+
+            ssize_t i_read = vlc_stream_Read( s, &p_buf[i_buf],
+                                              ES_SEEKTABLE_BUFFER - i_buf );
+            if( i_read <= 0 )
+                b_eof = true;
+            else
+                i_buf += i_read;
+        }
+
+        const size_t i_avail = i_buf - i_off;
+        if( i_avail < ES_SEEKTABLE_HEADER )
+            break;
+
+        unsigned i_frame_samples, i_frame_rate;
+        int i_size = ParseFrame( i_codec, b_big_endian, &p_buf[i_off],
+                                 &i_frame_samples, &i_frame_rate );
+        bool b_frame = i_size > 0 && (i_rate == 0 || i_frame_rate == i_rate);
+
+        /* after a loss of sync, the next header must be valid too */
+        if( b_frame && !b_synced && i_avail >= (size_t)i_size + ES_SEEKTABLE_HEADER )
+        {
+            unsigned i_next_samples, i_next_rate;
+            b_frame = ParseFrame( i_codec, b_big_endian, &p_buf[i_off + i_size],
+                                  &i_next_samples, &i_next_rate ) > 0 &&
+                      i_next_rate == i_frame_rate;
+        }
+
+        if( !b_frame )
+        {
+            b_synced = false;
+            i_off++;
+            if( ++i_lost > ES_SEEKTABLE_MAX_LOST )
+                break;
+            continue;
+        }
+
+        /* truncated last frame */
+        if( (size_t)i_size > i_avail )
+            break;
+
+        b_synced = true;
+        i_lost = 0;
+        if( i_rate == 0 )
+            i_rate = i_frame_rate;
+
+        if( i_frame_samples )
+        {
+            if( i_frames++ % ES_SEEKTABLE_INTERVAL == 0 )
+            {
+                pending[i_pending].i_time = vlc_tick_from_samples( i_samples, i_rate );
+                pending[i_pending].i_offset = 0;
+                pending[i_pending].i_pos = i_buf_pos + i_off;
+                i_pending++;
+            }
+            i_samples += i_frame_samples;
+        }
+        i_off += i_size;
+
+        if( i_pending == ES_SEEKTABLE_BATCH )
+        {
+            i_ret = seektable_Publish( p_table, pending, i_pending,
+                                       i_buf_pos + i_off,
+                                       vlc_tick_from_samples( i_samples, i_rate ),
+                                       false );
+            if( i_ret != VLC_SUCCESS )
+                break;
+            i_pending = 0;
+        }
+    }
+
+    if( i_ret == VLC_SUCCESS && i_rate )
+    {
+        /* trailing tags or garbage are fine once the end is reached */
+        bool b_done = b_eof && !seektable_IsAborted( p_table );
+        i_ret = seektable_Publish( p_table, pending, i_pending, i_buf_pos + i_off,
+                                   vlc_tick_from_samples( i_samples, i_rate ),
+                                   b_done );
+    }
+
+    free( p_buf );
+    return i_ret;
+}
@@ -0,0 +1,36 @@
+/*****************************************************************************
+ * es_seektable.h: audio elementary stream seek table
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_ES_SEEKTABLE_H
+#define VLC_ES_SEEKTABLE_H
+
+#include "seektable.h"
+
+/* one seekpoint every n frames */
+#define ES_SEEKTABLE_INTERVAL 8
+
+bool es_seektable_IsSupported( vlc_fourcc_t i_codec );
+
+/* Fills the table with the exact time of the frames of a MPEG audio, ADTS
+ * AAC, A52 or E-AC3 elementary stream, relative to the first scanned frame,
+ * from their headers. Stops at EOF, loss of sync or seektable_Abort(). */
+int es_seektable_Scan( seektable_t *, stream_t *s,
+                       vlc_fourcc_t i_codec, bool b_big_endian );
+
+#endif
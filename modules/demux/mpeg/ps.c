@@ -34,6 +34,7 @@
 
 #include "pes.h"
 #include "ps.h"
+#include "ps_seektable.h"
 
 /* TODO:
  *  - re-add pre-scanning.
@@ -45,6 +46,10 @@
     "to calculate position and duration. However sometimes this might not " \
     "be usable. Disable this option to calculate from the bitrate instead." )
 
+#define SEEK_INDEX_TEXT N_("Build a seek index")
+#define SEEK_INDEX_LONGTEXT N_("Read the packets in the background to " \
+    "seek to the keyframe nearest to the requested time.")
+
 #define PS_PACKET_PROBE 3
 #define CDXA_HEADER_SIZE 44
 #define CDXA_SECTOR_SIZE 2352
@@ -68,6 +73,7 @@ vlc_module_begin ()
     add_bool( "ps-trust-timestamps", true, TIME_TEXT,
                  TIME_LONGTEXT )
         change_safe ()
+    add_bool( "ps-seek-index", true, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT )
 
     add_submodule ()
     set_description( N_("MPEG-PS demuxer") )
@@ -113,6 +119,9 @@ typedef struct
     int         current_title;
     int         current_seekpoint;
     unsigned    updates;
+
+    seektable_t    seektable;
+    bool           b_seektable;
 } demux_sys_t;
 
 static int Demux  ( demux_t *p_demux );
@@ -121,6 +130,9 @@ static int Control( demux_t *p_demux, int i_query, va_list args );
 static int      ps_pkt_resynch( stream_t *, int, bool );
 static block_t *ps_pkt_read   ( stream_t * );
 
+static void SeekTableStart( demux_t * );
+static void SeekTableStop( demux_t * );
+
 static void CreateOrUpdateES( demux_t*p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -252,6 +264,7 @@ static int OpenCommon( vlc_object_t *p_this, bool b_force )
     p_sys->current_title = 0;
     p_sys->current_seekpoint = 0;
     p_sys->updates = 0;
+    p_sys->b_seektable = false;
 
     vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &p_sys->b_seekable );
 
@@ -260,6 +273,8 @@ static int OpenCommon( vlc_object_t *p_this, bool b_force )
 
     /* TODO prescanning of ES */
 
+    SeekTableStart( p_demux );
+
     return VLC_SUCCESS;
 }
 
@@ -282,6 +297,8 @@ static void Close( vlc_object_t *p_this )
     demux_sys_t *p_sys = p_demux->p_sys;
     int i;
 
+    SeekTableStop( p_demux );
+
     for( i = 0; i < PS_TK_COUNT; i++ )
     {
         ps_track_t *tk = &p_sys->tk[i];
@@ -297,6 +314,47 @@ static void Close( vlc_object_t *p_this )
     free( p_sys );
 }
 
+/*****************************************************************************
+ * Seek table
+ *****************************************************************************/
+static int SeekTableScan( seektable_t *p_table, stream_t *s, void *opaque )
+{
+    demux_sys_t *p_sys = opaque;
+
+    return ps_seektable_Scan( p_table, s, p_sys->format == PSMF_PS );
+}
+
+static void SeekTableStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    /* CDXA sectors and NVR timestamps can't be walked packet by packet */
+    if( ( p_sys->format != MPEG_PS && p_sys->format != PSMF_PS ) ||
+        !p_sys->b_seekable || p_demux->b_preparsing ||
+        !var_InheritBool( p_demux, "ps-seek-index" ) )
+        return;
+
+    seektable_Init( &p_sys->seektable );
+    if( seektable_Start( &p_sys->seektable, p_demux, "vlc-ps-index",
+                         p_sys->i_start_byte, SeekTableScan, p_sys ) )
+    {
+        seektable_Clean( &p_sys->seektable );
+        return;
+    }
+    p_sys->b_seektable = true;
+}
+
+static void SeekTableStop( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->b_seektable )
+        return;
+
+    seektable_Clean( &p_sys->seektable );
+    p_sys->b_seektable = false;
+}
+
 static int Probe( demux_t *p_demux, bool b_end )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -702,6 +760,54 @@ static int Demux( demux_t *p_demux )
 /*****************************************************************************
  * Control:
  *****************************************************************************/
+/* Seek to the keyframe at or before a time or offset, from the seek table */
+static int SeekTableMove( demux_t *p_demux, const seektable_point_t *p_point )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( vlc_stream_Seek( p_demux->s, p_point->i_pos ) != VLC_SUCCESS )
+        return VLC_EGENERIC;
+
+    p_sys->i_current_pts = VLC_TICK_INVALID;
+    p_sys->i_scr = VLC_TICK_INVALID;
+    NotifyDiscontinuity( p_sys->tk, p_demux->out );
+    return VLC_SUCCESS;
+}
+
+static int SeekTableSetTime( demux_t *p_demux, vlc_tick_t i_time, bool b_precise )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    vlc_tick_t i_origin;
+    seektable_point_t point;
+
+    /* same origin as DEMUX_GET_TIME */
+    if( p_sys->i_time_track_index >= 0 )
+        i_origin = p_sys->tk[p_sys->i_time_track_index].i_first_pts;
+    else if( p_sys->i_first_scr != VLC_TICK_INVALID )
+        i_origin = p_sys->i_first_scr;
+    else
+        return VLC_EGENERIC;
+
+    if( seektable_SeekByTime( &p_sys->seektable, i_origin + i_time, &point ) ||
+        SeekTableMove( p_demux, &point ) )
+        return VLC_EGENERIC;
+
+    if( b_precise )
+        es_out_Control( p_demux->out, ES_OUT_SET_NEXT_DISPLAY_TIME,
+                        i_origin + i_time - point.i_offset );
+    return VLC_SUCCESS;
+}
+
+static int SeekTableSetPosition( demux_t *p_demux, uint64_t i_pos )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    seektable_point_t point;
+
+    if( seektable_SeekByPos( &p_sys->seektable, i_pos, &point ) )
+        return VLC_EGENERIC;
+    return SeekTableMove( p_demux, &point );
+}
+
 static int Control( demux_t *p_demux, int i_query, va_list args )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -751,6 +857,10 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
             else
             {
                 i64 = p_sys->i_start_byte + (int64_t)(i64 * f);
+                /* start from the previous keyframe */
+                if( p_sys->b_seektable &&
+                    SeekTableSetPosition( p_demux, i64 ) == VLC_SUCCESS )
+                    return VLC_SUCCESS;
             }
 
             i_ret = vlc_stream_Seek( p_demux->s, i64 );
@@ -799,10 +909,16 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 
         case DEMUX_SET_TIME:
         {
+            vlc_tick_t i_time = va_arg( args, vlc_tick_t );
+            bool b_precise = va_arg( args, int );
+
+            if( p_sys->b_seektable &&
+                SeekTableSetTime( p_demux, i_time, b_precise ) == VLC_SUCCESS )
+                return VLC_SUCCESS;
+
             if( p_sys->i_time_track_index >= 0 && p_sys->i_current_pts != VLC_TICK_INVALID &&
                 p_sys->i_length > VLC_TICK_0)
             {
-                vlc_tick_t i_time = va_arg( args, vlc_tick_t );
                 i_time -= p_sys->tk[p_sys->i_time_track_index].i_first_pts;
                 return demux_SetPosition( p_demux, (double) i_time / p_sys->i_length, false, true );
             }
@@ -0,0 +1,240 @@
+/*****************************************************************************
+ * ps_seektable.c: MPEG program stream seek table
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+
+#include "pes.h"
+#include "ps.h"
+#include "ps_seektable.h"
+
+#define PS_SEEKTABLE_BUFFER     (256 * 1024)
+/* largest packet */
+#define PS_SEEKTABLE_LOOKAHEAD  (6 + 0xFFFF)
+/* bytes without sync before giving up */
+#define PS_SEEKTABLE_MAX_LOST   (1024 * 1024)
+/* seekpoints gathered before publishing them */
+#define PS_SEEKTABLE_BATCH      256
+/* spacing of the seekpoints of audio only streams */
+#define PS_SEEKTABLE_AUDIO_INTERVAL VLC_TICK_FROM_MS(500)
+/* SCR jumps larger than this are discontinuities (H.222 allows 0.7s) */
+#define PS_SEEKTABLE_MAX_GAP    VLC_TICK_FROM_SEC(1)
+
+/*****************************************************************************
+ * Scan
+ *****************************************************************************/
+
+/* Whether a video payload starts a sequence the decoder can start with:
+ * sequence or GOP header, or I picture for MPEG video, IDR or SPS for H264 */
+static bool IsRandomAccess( const uint8_t *p, size_t i_size, bool b_h264 )
+{
+    for( size_t i = 0; i + 6 <= i_size; i++ )
+    {
+        if( p[i] != 0 || p[i+1] != 0 || p[i+2] != 1 )
+            continue;
+
+        if( b_h264 )
+        {
+            const uint8_t i_nal = p[i+3] & 0x1f;
+            if( i_nal == 5 || i_nal == 7 )
+                return true;
+            if( i_nal == 1 )
+                return false;
+        }
+        else
+        {
+            if( p[i+3] == 0xB3 || p[i+3] == 0xB8 )
+                return true;
+            if( p[i+3] == 0x00 ) /* picture_coding_type */
+                return ((p[i+5] >> 3) & 0x07) == 1;
+        }
+    }
+    return false;
+}
+
+int ps_seektable_Scan( seektable_t *p_table, stream_t *s, bool b_h264 )
+{
+    seektable_point_t pending[PS_SEEKTABLE_BATCH];
+    size_t i_pending = 0;
+
+    uint8_t *p_buf = malloc( PS_SEEKTABLE_BUFFER );
+    if( !p_buf )
+        return VLC_ENOMEM;
+
+    size_t   i_buf = 0;     /* bytes in p_buf */
+    size_t   i_off = 0;     /* current offset in p_buf */
+    uint64_t i_buf_pos = vlc_stream_Tell( s ); /* stream position of p_buf[0] */
+    bool     b_eof = false;
+
+    uint64_t   i_pack_pos = 0;
+    bool       b_pack = false;
+    vlc_tick_t i_scr = VLC_TICK_INVALID;
+    vlc_tick_t i_offset = 0;
+    vlc_tick_t i_last_time = VLC_TICK_INVALID;
+    vlc_tick_t i_end_time = VLC_TICK_INVALID; /* time reached by the scan */
+    uint64_t   i_last_pos = 0;
+    bool       b_video = false;
+    size_t     i_lost = 0;
+    int        i_ret = VLC_SUCCESS;
+
+    while( !seektable_IsAborted( p_table ) )
+    {
+        if( !b_eof && i_buf - i_off < PS_SEEKTABLE_LOOKAHEAD )
+        {
+            memmove( p_buf, &p_buf[i_off], i_buf - i_off );
+            i_buf -= i_off;
+            i_buf_pos += i_off;
+            i_off = 0;
+
+            ssize_t i_read = vlc_stream_Read( s, &p_buf[i_buf],
+                                              PS_SEEKTABLE_BUFFER - i_buf );
+            if( i_read <= 0 )
+                b_eof = true;
+            else
+                i_buf += i_read;
+        }
+
+        const size_t i_avail = i_buf - i_off;
+        if( i_avail < 4 )
+            break;
+
+        const uint8_t *p = &p_buf[i_off];
+        int i_size = -1;
+        if( p[0] == 0 && p[1] == 0 && p[2] == 1 && p[3] >= PS_STREAM_ID_END_STREAM )
+            i_size = ps_pkt_size( p, __MIN(i_avail, 14) );
+
+        /* empty packets are only found in broken streams, resync too */
+        if( i_size < 0 || ( i_size <= 6 && p[3] > PS_STREAM_ID_PACK_HEADER ) )
+        {
+            if( i_avail < 14 && b_eof )
+                break;
+            i_off++;
+            if( ++i_lost > PS_SEEKTABLE_MAX_LOST )
+                break;
+            continue;
+        }
+
+        /* truncated last packet */
+        if( (size_t)i_size > i_avail )
+            break;
+        i_lost = 0;
+
+        const uint64_t i_pos = i_buf_pos + i_off;
+        const uint8_t i_id = p[3];
+        vlc_tick_t i_time = VLC_TICK_INVALID;
+        bool b_point = false;
+
+        if( i_id == PS_STREAM_ID_PACK_HEADER )
+        {
+            vlc_tick_t i_pack_scr;
+            int i_mux_rate;
+            if( !ps_pkt_parse_pack( p, i_size, &i_pack_scr, &i_mux_rate ) )
+            {
+                if( i_scr != VLC_TICK_INVALID &&
+                    ( i_pack_scr < i_scr || i_pack_scr - i_scr > PS_SEEKTABLE_MAX_GAP ) )
+                {
+                    /* continue the timeline where it was */
+                    i_offset += i_scr - i_pack_scr;
+                }
+                i_scr = i_pack_scr;
+                i_end_time = i_scr + i_offset;
+                i_pack_pos = i_pos;
+                b_pack = true;
+            }
+        }
+        else if( ( i_id >= 0xC0 && i_id <= 0xEF ) ||
+                 i_id == PS_STREAM_ID_PRIVATE_STREAM1 )
+        {
+            const bool b_video_pes = i_id >= 0xE0;
+            unsigned i_skip;
+            stime_t i_pts = -1, i_dts = -1;
+            uint8_t i_stream_id;
+
+            if( ( b_video_pes || !b_video ) &&
+                ParsePESHeader( VLC_OBJECT(s), p, i_size, &i_skip,
+                                &i_dts, &i_pts, &i_stream_id, NULL ) == VLC_SUCCESS &&
+                i_skip < (unsigned)i_size )
+            {
+                if( i_pts >= 0 )
+                    i_time = FROM_SCALE( i_pts );
+                else if( i_scr != VLC_TICK_INVALID )
+                    i_time = i_scr;
+                if( i_time != VLC_TICK_INVALID )
+                {
+                    i_time += i_offset;
+                    /* without packs, the timestamps are the only clock */
+                    if( !b_pack && i_time > i_end_time )
+                        i_end_time = i_time;
+                }
+
+                if( b_video_pes )
+                {
+                    b_video = true;
+                    b_point = IsRandomAccess( &p[i_skip], i_size - i_skip,
+                                              b_h264 );
+                }
+                else
+                {
+                    b_point = i_last_time == VLC_TICK_INVALID ||
+                              i_time - i_last_time >= PS_SEEKTABLE_AUDIO_INTERVAL;
+                }
+            }
+        }
+
+        /* start decoding from the pack carrying the access unit */
+        const uint64_t i_point_pos = b_pack ? i_pack_pos : i_pos;
+        if( b_point && i_time != VLC_TICK_INVALID &&
+            ( i_last_time == VLC_TICK_INVALID ||
+              ( i_time > i_last_time && i_point_pos > i_last_pos ) ) )
+        {
+            pending[i_pending].i_time = i_time;
+            pending[i_pending].i_offset = i_offset;
+            pending[i_pending].i_pos = i_point_pos;
+            i_pending++;
+            i_last_time = i_time;
+            i_last_pos = i_point_pos;
+        }
+
+        i_off += i_size;
+
+        if( i_pending == PS_SEEKTABLE_BATCH )
+        {
+            i_ret = seektable_Publish( p_table, pending, i_pending,
+                                       i_buf_pos + i_off, i_end_time, false );
+            if( i_ret != VLC_SUCCESS )
+                break;
+            i_pending = 0;
+        }
+    }
+
+    if( i_ret == VLC_SUCCESS && i_end_time != VLC_TICK_INVALID )
+    {
+        bool b_done = b_eof && !seektable_IsAborted( p_table );
+        i_ret = seektable_Publish( p_table, pending, i_pending,
+                                   i_buf_pos + i_off, i_end_time, b_done );
+    }
+
+    free( p_buf );
+    return i_ret;
+}
@@ -0,0 +1,31 @@
+/*****************************************************************************
+ * ps_seektable.h: MPEG program stream seek table
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_PS_SEEKTABLE_H
+#define VLC_PS_SEEKTABLE_H
+
+#include "seektable.h"
+
+/* Fills the table with the packs starting a video keyframe of a program
+ * stream, or its audio packets when it has no video. The time of a seekpoint
+ * is the PTS of its access unit, or the SCR of its pack, made continuous over
+ * discontinuities. Stops at EOF, loss of sync or seektable_Abort(). */
+int ps_seektable_Scan( seektable_t *, stream_t *s, bool b_h264 );
+
+#endif
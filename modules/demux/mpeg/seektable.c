@@ -0,0 +1,229 @@
+/*****************************************************************************
+ * seektable.c: seek table built in the background
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+
+#include "seektable.h"
+
+/*****************************************************************************
+ * Table
+ *****************************************************************************/
+void seektable_Init( seektable_t *p_table )
+{
+    vlc_mutex_init( &p_table->lock );
+    p_table->p_points = NULL;
+    p_table->i_points = 0;
+    p_table->i_max = 0;
+    p_table->i_indexed_end = 0;
+    p_table->i_indexed_time = VLC_TICK_INVALID;
+    p_table->b_done = false;
+    atomic_init( &p_table->b_abort, false );
+    p_table->b_running = false;
+}
+
+void seektable_Clean( seektable_t *p_table )
+{
+    seektable_Stop( p_table );
+    free( p_table->p_points );
+    p_table->p_points = NULL;
+    p_table->i_points = p_table->i_max = 0;
+}
+
+void seektable_Abort( seektable_t *p_table )
+{
+    atomic_store( &p_table->b_abort, true );
+}
+
+int seektable_Publish( seektable_t *p_table,
+                       const seektable_point_t *p_points, size_t i_points,
+                       uint64_t i_end, vlc_tick_t i_time, bool b_done )
+{
+    int i_ret = VLC_SUCCESS;
+
+    vlc_mutex_lock( &p_table->lock );
+    if( p_table->i_points + i_points > p_table->i_max )
+    {
+        size_t i_max = __MAX( p_table->i_max * 2, p_table->i_points + i_points );
+        seektable_point_t *p_realloc = realloc( p_table->p_points,
+                                                i_max * sizeof(*p_realloc) );
+        if( p_realloc )
+        {
+            p_table->p_points = p_realloc;
+            p_table->i_max = i_max;
+        }
+        else
+        {
+            /* keep what we have, and don't claim more */
+            i_ret = VLC_ENOMEM;
+        }
+    }
+    if( i_ret == VLC_SUCCESS )
+    {
+        memcpy( &p_table->p_points[p_table->i_points], p_points,
+                i_points * sizeof(*p_points) );
+        p_table->i_points += i_points;
+        p_table->i_indexed_end = i_end;
+        p_table->i_indexed_time = i_time;
+        p_table->b_done = b_done;
+    }
+    vlc_mutex_unlock( &p_table->lock );
+
+    return i_ret;
+}
+
+/*****************************************************************************
+ * Background scan
+ *****************************************************************************/
+static void *Thread( void *data )
+{
+    seektable_t *p_table = data;
+    demux_t     *p_demux = p_table->p_demux;
+
+    vlc_thread_set_name( p_table->psz_name );
+
+    stream_t *s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    if( !s )
+        return NULL;
+
+    vlc_tick_t i_start = vlc_tick_now();
+    if( vlc_stream_Seek( s, p_table->i_start ) == VLC_SUCCESS &&
+        p_table->pf_scan( p_table, s, p_table->opaque ) == VLC_SUCCESS )
+    {
+        vlc_mutex_lock( &p_table->lock );
+        msg_Dbg( p_demux, "seek index: %zu entries over %"PRIu64" bytes "
+                 "in %"PRId64" ms%s", p_table->i_points,
+                 p_table->i_indexed_end,
+                 MS_FROM_VLC_TICK( vlc_tick_now() - i_start ),
+                 p_table->b_done ? "" : " (incomplete)" );
+        vlc_mutex_unlock( &p_table->lock );
+    }
+    vlc_stream_Delete( s );
+
+    return NULL;
+}
+
+int seektable_Start( seektable_t *p_table, demux_t *p_demux,
+                     const char *psz_thread_name, uint64_t i_start,
+                     seektable_scan_cb pf_scan, void *opaque )
+{
+    bool b_fastseekable;
+
+    /* the scan reads the same URL on its own */
+    if( p_table->b_running || !p_demux->psz_url ||
+        vlc_stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseekable ) ||
+        !b_fastseekable )
+        return VLC_EGENERIC;
+
+    p_table->p_demux = p_demux;
+    p_table->psz_name = psz_thread_name;
+    p_table->i_start = i_start;
+    p_table->pf_scan = pf_scan;
+    p_table->opaque = opaque;
+    atomic_store( &p_table->b_abort, false );
+
+    if( vlc_clone( &p_table->thread, Thread, p_table ) )
+        return VLC_EGENERIC;
+    p_table->b_running = true;
+    return VLC_SUCCESS;
+}
+
+void seektable_Stop( seektable_t *p_table )
+{
+    if( !p_table->b_running )
+        return;
+
+    seektable_Abort( p_table );
+    vlc_join( p_table->thread, NULL );
+    p_table->b_running = false;
+}
+
+/*****************************************************************************
+ * Lookups
+ *****************************************************************************/
+int seektable_SeekByTime( seektable_t *p_table, vlc_tick_t i_time,
+                          seektable_point_t *p_point )
+{
+    int i_ret = VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_table->lock );
+    if( p_table->i_points > 0 &&
+        (p_table->b_done || i_time < p_table->i_indexed_time) )
+    {
+        size_t i_low = 0, i_high = p_table->i_points;
+        while( i_high - i_low > 1 )
+        {
+            size_t i_mid = i_low + (i_high - i_low) / 2;
+            if( p_table->p_points[i_mid].i_time <= i_time )
+                i_low = i_mid;
+            else
+                i_high = i_mid;
+        }
+        *p_point = p_table->p_points[i_low];
+        i_ret = VLC_SUCCESS;
+    }
+    vlc_mutex_unlock( &p_table->lock );
+
+    return i_ret;
+}
+
+int seektable_SeekByPos( seektable_t *p_table, uint64_t i_pos,
+                         seektable_point_t *p_point )
+{
+    int i_ret = VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_table->lock );
+    if( p_table->i_points > 0 &&
+        (p_table->b_done || i_pos < p_table->i_indexed_end) )
+    {
+        size_t i_low = 0, i_high = p_table->i_points;
+        while( i_high - i_low > 1 )
+        {
+            size_t i_mid = i_low + (i_high - i_low) / 2;
+            if( p_table->p_points[i_mid].i_pos <= i_pos )
+                i_low = i_mid;
+            else
+                i_high = i_mid;
+        }
+        *p_point = p_table->p_points[i_low];
+        i_ret = VLC_SUCCESS;
+    }
+    vlc_mutex_unlock( &p_table->lock );
+
+    return i_ret;
+}
+
+int seektable_GetEndTime( seektable_t *p_table, vlc_tick_t *pi_time )
+{
+    int i_ret = VLC_EGENERIC;
+
+    vlc_mutex_lock( &p_table->lock );
+    if( p_table->b_done && p_table->i_indexed_time != VLC_TICK_INVALID )
+    {
+        *pi_time = p_table->i_indexed_time;
+        i_ret = VLC_SUCCESS;
+    }
+    vlc_mutex_unlock( &p_table->lock );
+
+    return i_ret;
+}
@@ -0,0 +1,95 @@
+/*****************************************************************************
+ * seektable.h: seek table built in the background
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifndef VLC_MPEG_SEEKTABLE_H
+#define VLC_MPEG_SEEKTABLE_H
+
+#include <stdatomic.h>
+
+typedef struct
+{
+    vlc_tick_t i_time;
+    vlc_tick_t i_offset; /* added to the stream timestamps to keep i_time
+                            increasing over discontinuities */
+    uint64_t   i_pos;
+} seektable_point_t;
+
+typedef struct seektable_t seektable_t;
+
+/* Reads the stream from its current position, and publishes the seekpoints
+ * it finds until EOF or seektable_IsAborted() */
+typedef int (*seektable_scan_cb)( seektable_t *, stream_t *s, void *opaque );
+
+/* Time to offset table, in increasing time and offset order. The scan can run
+ * on its own thread and stream while the lookups are done from the demuxer. */
+struct seektable_t
+{
+    vlc_mutex_t        lock;
+    seektable_point_t *p_points;
+    size_t             i_points;
+    size_t             i_max;
+    uint64_t           i_indexed_end;  /* scanned bytes */
+    vlc_tick_t         i_indexed_time; /* time at i_indexed_end */
+    bool               b_done;         /* whole stream scanned */
+
+    atomic_bool        b_abort;
+
+    /* background scan */
+    demux_t           *p_demux;
+    const char        *psz_name;
+    uint64_t           i_start;
+    seektable_scan_cb  pf_scan;
+    void              *opaque;
+    vlc_thread_t       thread;
+    bool               b_running;
+};
+
+void seektable_Init( seektable_t * );
+void seektable_Clean( seektable_t * );
+
+/* Scans the demuxed URL from i_start on a new stream and thread, if the
+ * demuxer stream is fast seekable */
+int  seektable_Start( seektable_t *, demux_t *, const char *psz_thread_name,
+                      uint64_t i_start, seektable_scan_cb, void *opaque );
+/* Aborts and waits for the scan, the table stays usable */
+void seektable_Stop( seektable_t * );
+
+void seektable_Abort( seektable_t * );
+
+static inline bool seektable_IsAborted( seektable_t *p_table )
+{
+    return atomic_load( &p_table->b_abort );
+}
+
+/* Appends seekpoints found by the scan, which reached i_end and i_time */
+int seektable_Publish( seektable_t *, const seektable_point_t *p_points,
+                       size_t i_points, uint64_t i_end, vlc_tick_t i_time,
+                       bool b_done );
+
+/* Return the last seekpoint at or before the requested time or offset,
+ * or VLC_EGENERIC if that part of the stream has not been scanned yet */
+int seektable_SeekByTime( seektable_t *, vlc_tick_t i_time,
+                          seektable_point_t *p_point );
+int seektable_SeekByPos( seektable_t *, uint64_t i_pos,
+                         seektable_point_t *p_point );
+
+/* Time at the end of the stream, once fully scanned */
+int seektable_GetEndTime( seektable_t *, vlc_tick_t *pi_time );
+
+#endif
@@ -56,6 +56,10 @@
 static int  Open ( vlc_object_t * );
 static void Close( vlc_object_t * );
 
+#define SEEK_INDEX_TEXT N_("Build a seek index")
+#define SEEK_INDEX_LONGTEXT N_("Read the page headers in the background " \
+    "to seek audio streams without searching the file.")
+
 vlc_module_begin ()
     set_shortname ( "OGG" )
     set_description( N_("OGG demuxer" ) )
@@ -70,6 +74,8 @@ vlc_module_begin ()
     add_file_extension("ogx")
     add_file_extension("opus")
     add_file_extension("spx")
+
+    add_bool( "ogg-seek-index", true, SEEK_INDEX_TEXT, SEEK_INDEX_LONGTEXT )
 vlc_module_end ()
 
 
@@ -436,7 +442,10 @@ static int Demux( demux_t * p_demux )
             /* Find the real duration */
             vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &b_canseek );
             if ( b_canseek )
+            {
                 Oggseek_ProbeEnd( p_demux );
+                Oggseek_PrescanStart( p_demux );
+            }
         }
         else
         {
@@ -461,6 +470,7 @@ static int Demux( demux_t * p_demux )
      * And, as we all know, seeking without having backed up all headers is bad, since the
      * codec will fail to initialize if it's missing its headers.
      */
+    int64_t i_pagepos = -1;
     if( !p_sys->b_page_waiting)
     {
         /*
@@ -468,6 +478,9 @@ static int Demux( demux_t * p_demux )
          */
         if( Ogg_ReadPage( p_demux, &p_sys->current_page ) != VLC_SUCCESS )
             return VLC_DEMUXER_EOF; /* EOF */
+        i_pagepos = vlc_stream_Tell( p_demux->s )
+                  - ( p_sys->oy.fill - p_sys->oy.returned )
+                  - ( p_sys->current_page.header_len + p_sys->current_page.body_len );
         /* Test for End of Stream */
         if( ogg_page_eos( &p_sys->current_page ) )
         {
@@ -520,6 +533,8 @@ static int Demux( demux_t * p_demux )
             {
                 continue;
             }
+
+            OggSeek_IndexPage( p_stream, &p_sys->current_page, i_pagepos );
         }
 
         /* clear the finished flag if pages after eos (ex: after a seek) */
@@ -628,6 +643,7 @@ static void Ogg_ResetStream( logical_stream_t *p_stream )
     p_stream->b_interpolation_failed = false;
     date_Set( &p_stream->dts, VLC_TICK_INVALID );
     ogg_stream_reset( &p_stream->os );
+    p_stream->idx.i_playback_run = -1;
     block_ChainRelease( p_stream->queue.p_blocks );
     p_stream->queue.p_blocks = NULL;
     p_stream->queue.pp_append = &p_stream->queue.p_blocks;
@@ -2256,7 +2272,7 @@ static int Ogg_BeginningOfStream( demux_t *p_demux )
         p_stream->p_es = NULL;
 
         /* initialise kframe index */
-        p_stream->idx=NULL;
+        oggseek_index_init( &p_stream->idx );
 
         if ( p_stream->fmt.i_bitrate == 0  &&
              ( p_stream->fmt.i_cat == VIDEO_ES ||
@@ -2283,6 +2299,8 @@ static void Ogg_EndOfStream( demux_t *p_demux )
     demux_sys_t *p_ogg = p_demux->p_sys  ;
     int i_stream;
 
+    Oggseek_PrescanStop( p_demux );
+
     for( i_stream = 0 ; i_stream < p_ogg->i_streams; i_stream++ )
         Ogg_LogicalStreamDelete( p_demux, p_ogg->pp_stream[i_stream] );
     free( p_ogg->pp_stream );
@@ -2362,10 +2380,7 @@ static void Ogg_LogicalStreamDelete( demux_t *p_demux, logical_stream_t *p_strea
     es_format_Clean( &p_stream->fmt_old );
     es_format_Clean( &p_stream->fmt );
 
-    if ( p_stream->idx != NULL)
-    {
-        oggseek_index_entries_free( p_stream->idx );
-    }
+    oggseek_index_clean( &p_stream->idx );
 
     Ogg_FreeSkeleton( p_stream->p_skel );
     p_stream->p_skel = NULL;
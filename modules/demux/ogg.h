@@ -43,8 +43,21 @@
 #define OGGDS_RESOLUTION     10000000
 
 typedef struct oggseek_index_entry demux_index_entry_t;
+typedef struct oggseek_prescan oggseek_prescan_t;
 typedef struct ogg_skeleton_t ogg_skeleton_t;
 
+typedef struct
+{
+    demux_index_entry_t *p_entries; /* sorted by page position */
+    size_t i_count;
+    size_t i_max;
+    /* the entries reach the end of the logical stream */
+    bool b_complete;
+    /* last page indexed while reading sequentially, -1 if none */
+    int64_t i_playback_run;
+    int64_t i_prescan_run;
+} oggseek_index_t;
+
 typedef struct backup_queue
 {
     block_t *p_block;
@@ -93,7 +106,7 @@ typedef struct logical_stream_s
     int8_t i_first_frame_index;
 
     /* keyframe index for seeking, created as we discover keyframes */
-    demux_index_entry_t *idx;
+    oggseek_index_t idx;
 
     /* Skeleton data */
     ogg_skeleton_t *p_skel;
@@ -222,6 +235,9 @@ typedef struct
     /* Time length, if available. 0 otherwise. */
     vlc_tick_t i_length;
 
+    /* background page index */
+    oggseek_prescan_t *p_prescan;
+
     bool b_slave;
 
 } demux_sys_t;
@@ -41,6 +41,7 @@
 #include <limits.h>
 #include <math.h>
 #include <assert.h>
+#include <stdatomic.h>
 
 #include "ogg.h"
 #include "oggseek.h"
@@ -61,94 +62,518 @@ typedef struct packetStartCoordinates
 * index entries
 *************************************************************/
 
-/* free all entries in index list */
+void oggseek_index_init( oggseek_index_t *p_idx )
+{
+    p_idx->p_entries = NULL;
+    p_idx->i_count = 0;
+    p_idx->i_max = 0;
+    p_idx->b_complete = false;
+    p_idx->i_playback_run = -1;
+    p_idx->i_prescan_run = -1;
+}
 
-void oggseek_index_entries_free ( demux_index_entry_t *idx )
+void oggseek_index_clean( oggseek_index_t *p_idx )
 {
-    demux_index_entry_t *idx_next;
+    free( p_idx->p_entries );
+    oggseek_index_init( p_idx );
+}
 
-    while ( idx != NULL )
+/* first entry at or after i_pagepos */
+static size_t OggSeekIndexLowerBound( const oggseek_index_t *p_idx, int64_t i_pagepos )
+{
+    size_t i_low = 0, i_high = p_idx->i_count;
+    while( i_low < i_high )
     {
-        idx_next = idx->p_next;
-        free( idx );
-        idx = idx_next;
+        size_t i_mid = i_low + ( i_high - i_low ) / 2;
+        if( p_idx->p_entries[i_mid].i_pagepos < i_pagepos )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
     }
+    return i_low;
 }
 
-
-/* internal function to create a new list member */
-
-static demux_index_entry_t *index_entry_new( vlc_tick_t i_timestamp, int64_t i_pagepos )
+/* We insert into index, sorting by pagepos (as a page can match multiple
+   time stamps) */
+static demux_index_entry_t *OggSeekIndexInsert( oggseek_index_t *p_idx,
+                                                vlc_tick_t i_timestamp,
+                                                int64_t i_pagepos )
 {
     if ( i_timestamp == VLC_TICK_INVALID || i_pagepos < 1 )
         return NULL;
 
-    demux_index_entry_t *idx = malloc( sizeof(*idx) );
-    if ( idx )
+    size_t i = OggSeekIndexLowerBound( p_idx, i_pagepos );
+    if( i < p_idx->i_count && p_idx->p_entries[i].i_pagepos == i_pagepos )
+        return NULL;
+
+    if( p_idx->i_count == p_idx->i_max )
     {
-        idx->i_value = i_timestamp;
-        idx->i_pagepos = i_pagepos;
-        idx->p_next = NULL;
+        size_t i_max = p_idx->i_max ? p_idx->i_max * 2 : 64;
+        demux_index_entry_t *p_realloc =
+            realloc( p_idx->p_entries, i_max * sizeof(*p_realloc) );
+        if( !p_realloc )
+            return NULL;
+        p_idx->p_entries = p_realloc;
+        p_idx->i_max = i_max;
     }
-    return idx;
+
+    demux_index_entry_t *ie = &p_idx->p_entries[i];
+    memmove( ie + 1, ie, ( p_idx->i_count - i ) * sizeof(*ie) );
+    p_idx->i_count++;
+
+    ie->i_value = i_timestamp;
+    ie->i_pagepos = i_pagepos;
+    /* splitting a range that was read in sequence keeps it in sequence */
+    ie->b_contiguous = i > 0 && p_idx->p_entries[i - 1].b_contiguous;
+
+    return ie;
 }
 
-/* We insert into index, sorting by pagepos (as a page can match multiple
-   time stamps) */
 const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *p_stream,
                                              vlc_tick_t i_timestamp,
                                              int64_t i_pagepos )
 {
-    demux_index_entry_t **pp_next = &p_stream->idx;
-    for( ; *pp_next; )
+    return OggSeekIndexInsert( &p_stream->idx, i_timestamp, i_pagepos );
+}
+
+/* Adds a page met while reading the stream in sequence. *pi_run is the
+ * previous page indexed by the same reader: every page in between has been
+ * seen, so the entries there are contiguous with their successor. */
+static void OggSeekIndexAddRun( oggseek_index_t *p_idx, int64_t *pi_run,
+                                vlc_tick_t i_timestamp, int64_t i_pagepos,
+                                vlc_tick_t i_interval )
+{
+    size_t i_prev = p_idx->i_count;
+
+    if( *pi_run >= 0 && *pi_run < i_pagepos )
     {
-        if( (*pp_next)->i_pagepos >= i_pagepos )
+        i_prev = OggSeekIndexLowerBound( p_idx, *pi_run );
+        if( i_prev < p_idx->i_count &&
+            p_idx->p_entries[i_prev].i_pagepos == *pi_run )
         {
-            if( (*pp_next)->i_pagepos == i_pagepos )
-                return NULL;
-            break;
+            if( i_timestamp - p_idx->p_entries[i_prev].i_value < i_interval )
+                return;
         }
-        pp_next = &((*pp_next)->p_next);
+        else i_prev = p_idx->i_count;
     }
 
-    demux_index_entry_t *ie = index_entry_new( i_timestamp, i_pagepos );
-    if ( ie )
+    /* the page might already be indexed by another reader */
+    OggSeekIndexInsert( p_idx, i_timestamp, i_pagepos );
+    size_t i_new = OggSeekIndexLowerBound( p_idx, i_pagepos );
+    if( i_new == p_idx->i_count || p_idx->p_entries[i_new].i_pagepos != i_pagepos )
     {
-        ie->p_next = *pp_next;
-        *pp_next = ie;
+        *pi_run = -1;
+        return;
     }
 
-    return ie;
+    for( size_t i = i_prev; i < i_new; i++ )
+        p_idx->p_entries[i].b_contiguous = true;
+
+    *pi_run = i_pagepos;
+}
+
+void OggSeek_IndexPage( logical_stream_t *p_stream, const ogg_page *p_page,
+                        int64_t i_pagepos )
+{
+    /* Every audio packet starts a decodable sequence. Video pages need
+     * their keyframe, which the bisection looks up. */
+    if( p_stream->fmt.i_cat != AUDIO_ES || p_stream->b_oggds ||
+        p_stream->b_initializing || i_pagepos < p_stream->i_data_start )
+        return;
+
+    int64_t i_granule = ogg_page_granulepos( p_page );
+    if( i_granule <= 0 )
+        return;
+
+    vlc_tick_t i_time = Ogg_GranuleToTime( p_stream, i_granule,
+                                           !p_stream->b_contiguous, false );
+    if( i_time == VLC_TICK_INVALID )
+        return;
+
+    OggSeekIndexAddRun( &p_stream->idx, &p_stream->idx.i_playback_run,
+                        i_time, i_pagepos, OGGSEEK_INDEX_INTERVAL );
+}
+
+/* last entry at or before i_timestamp */
+static const demux_index_entry_t *OggSeekIndexLookup( const oggseek_index_t *p_idx,
+                                                      vlc_tick_t i_timestamp )
+{
+    size_t i_low = 0, i_high = p_idx->i_count;
+    while( i_low < i_high )
+    {
+        size_t i_mid = i_low + ( i_high - i_low ) / 2;
+        if( p_idx->p_entries[i_mid].i_value <= i_timestamp )
+            i_low = i_mid + 1;
+        else
+            i_high = i_mid;
+    }
+    return i_low ? &p_idx->p_entries[i_low - 1] : NULL;
 }
 
 static bool OggSeekIndexFind ( logical_stream_t *p_stream, vlc_tick_t i_timestamp,
                                int64_t *pi_pos_lower, int64_t *pi_pos_upper,
-                               vlc_tick_t *pi_lower_timestamp )
+                               vlc_tick_t *pi_lower_timestamp, bool *pb_exact )
 {
-    demux_index_entry_t *idx = p_stream->idx;
+    const oggseek_index_t *p_idx = &p_stream->idx;
+    const demux_index_entry_t *idx = OggSeekIndexLookup( p_idx, i_timestamp );
+
+    if ( idx == NULL )
+        return false;
+
+    *pi_pos_lower = idx->i_pagepos;
+    *pi_lower_timestamp = idx->i_value;
+    if ( idx + 1 < p_idx->p_entries + p_idx->i_count )
+    {
+        *pi_pos_upper = idx[1].i_pagepos;
+        *pb_exact = idx->b_contiguous;
+    }
+    else /* found on last index */
+    {
+        *pb_exact = p_idx->b_complete;
+    }
+    return true;
+}
+
+/************************************************************
+* background page index
+*************************************************************/
+
+/* pages handed over to the demuxer at once */
+#define OGGSEEK_PRESCAN_BATCH 64
+
+typedef struct
+{
+    uint32_t i_serial;
+    int64_t i_granule;
+    int64_t i_pagepos;
+} oggseek_prescan_page_t;
+
+typedef struct
+{
+    uint32_t i_serial;
+    int64_t i_granule_interval;
+    /* scanner state */
+    int64_t i_last_granule;
+    oggseek_prescan_page_t pending; /* last page not indexed yet */
+    /* protected by the lock */
+    bool b_complete;
+} oggseek_prescan_stream_t;
+
+struct oggseek_prescan
+{
+    demux_t *p_demux;
+    vlc_thread_t thread;
+    atomic_bool b_abort;
+
+    oggseek_prescan_stream_t *p_streams;
+    size_t i_streams;
+
+    vlc_mutex_t lock;
+    oggseek_prescan_page_t *p_pages; /* not merged yet */
+    size_t i_pages;
+    size_t i_max;
+};
+
+static void OggSeekPrescanPublish( oggseek_prescan_t *p_prescan,
+                                   const oggseek_prescan_page_t *p_pages,
+                                   size_t i_pages )
+{
+    vlc_mutex_lock( &p_prescan->lock );
+    if( p_prescan->i_pages + i_pages > p_prescan->i_max )
+    {
+        size_t i_max = __MAX( p_prescan->i_max * 2, p_prescan->i_pages + i_pages );
+        oggseek_prescan_page_t *p_realloc =
+            realloc( p_prescan->p_pages, i_max * sizeof(*p_realloc) );
+        if( !p_realloc )
+        {
+            vlc_mutex_unlock( &p_prescan->lock );
+            return;
+        }
+        p_prescan->p_pages = p_realloc;
+        p_prescan->i_max = i_max;
+    }
+    memcpy( &p_prescan->p_pages[p_prescan->i_pages], p_pages,
+            i_pages * sizeof(*p_pages) );
+    p_prescan->i_pages += i_pages;
+    vlc_mutex_unlock( &p_prescan->lock );
+}
+
+static void *OggSeekPrescanThread( void *data )
+{
+    oggseek_prescan_t *p_prescan = data;
+    demux_t *p_demux = p_prescan->p_demux;
+    oggseek_prescan_page_t batch[OGGSEEK_PRESCAN_BATCH];
+    size_t i_batch = 0;
+    uint8_t header[PAGE_HEADER_BYTES + 255];
+    int64_t i_pos = 0;
+    size_t i_indexed = 0;
+    bool b_data = false;
+    bool b_eof = false;
+
+    vlc_thread_set_name( "vlc-ogg-index" );
+
+    stream_t *s = vlc_stream_NewURL( p_demux, p_demux->psz_url );
+    if( !s )
+        return NULL;
+
+    vlc_tick_t i_start = vlc_tick_now();
+
+    while( !atomic_load_explicit( &p_prescan->b_abort, memory_order_relaxed ) )
+    {
+        if( vlc_stream_Read( s, header, PAGE_HEADER_BYTES ) < PAGE_HEADER_BYTES )
+        {
+            b_eof = true;
+            break;
+        }
+        /* we only walk from page to page: stop on any damage */
+        if( memcmp( header, "OggS", 4 ) || header[4] != 0 )
+            break;
+
+        const unsigned i_nsegs = header[PAGE_HEADER_BYTES - 1];
+        if( vlc_stream_Read( s, &header[PAGE_HEADER_BYTES], i_nsegs ) < i_nsegs )
+        {
+            b_eof = true;
+            break;
+        }
+
+        int64_t i_body = 0;
+        for( unsigned i = 0; i < i_nsegs; i++ )
+            i_body += header[PAGE_HEADER_BYTES + i];
+
+        const uint8_t i_flags = header[5];
+        const int64_t i_granule = GetQWLE( &header[6] );
+        const uint32_t i_serial = GetDWLE( &header[14] );
+
+        oggseek_prescan_stream_t *p_stream = NULL;
+        for( size_t i = 0; i < p_prescan->i_streams; i++ )
+        {
+            if( p_prescan->p_streams[i].i_serial == i_serial )
+            {
+                p_stream = &p_prescan->p_streams[i];
+                break;
+            }
+        }
+
+        /* a new group of logical streams is chained after this one */
+        if( !p_stream && ( i_flags & 0x02 ) && b_data )
+        {
+            b_eof = true;
+            break;
+        }
+
+        if( p_stream && i_granule > 0 )
+        {
+            const oggseek_prescan_page_t page = { i_serial, i_granule, i_pos };
+            bool b_eos = i_flags & 0x04;
+
+            b_data = true;
+            p_stream->pending = page;
+            if( p_stream->i_last_granule < 0 || b_eos ||
+                i_granule - p_stream->i_last_granule >= p_stream->i_granule_interval )
+            {
+                batch[i_batch++] = page;
+                p_stream->i_last_granule = i_granule;
+                p_stream->pending.i_pagepos = -1;
+            }
+            if( i_batch == OGGSEEK_PRESCAN_BATCH || b_eos )
+            {
+                OggSeekPrescanPublish( p_prescan, batch, i_batch );
+                i_indexed += i_batch;
+                i_batch = 0;
+            }
+            if( b_eos )
+            {
+                vlc_mutex_lock( &p_prescan->lock );
+                p_stream->b_complete = true;
+                vlc_mutex_unlock( &p_prescan->lock );
+            }
+        }
 
-    while ( idx != NULL )
+        i_pos += PAGE_HEADER_BYTES + i_nsegs + i_body;
+        if( vlc_stream_Seek( s, i_pos ) != VLC_SUCCESS )
+        {
+            b_eof = true;
+            break;
+        }
+    }
+
+    if( b_eof )
     {
-        if ( idx->i_value <= i_timestamp )
+        /* streams without EOS page end with the file */
+        for( size_t i = 0; i < p_prescan->i_streams; i++ )
         {
-            if ( !idx->p_next ) /* found on last index */
+            oggseek_prescan_stream_t *p_stream = &p_prescan->p_streams[i];
+            if( p_stream->pending.i_pagepos >= 0 )
             {
-                *pi_pos_lower = idx->i_pagepos;
-                *pi_lower_timestamp = idx->i_value;
-                return true;
+                if( i_batch == OGGSEEK_PRESCAN_BATCH )
+                {
+                    OggSeekPrescanPublish( p_prescan, batch, i_batch );
+                    i_indexed += i_batch;
+                    i_batch = 0;
+                }
+                batch[i_batch++] = p_stream->pending;
             }
-            if ( idx->p_next->i_value > i_timestamp )
+        }
+    }
+    if( i_batch )
+    {
+        OggSeekPrescanPublish( p_prescan, batch, i_batch );
+        i_indexed += i_batch;
+    }
+    if( b_eof )
+    {
+        vlc_mutex_lock( &p_prescan->lock );
+        for( size_t i = 0; i < p_prescan->i_streams; i++ )
+            p_prescan->p_streams[i].b_complete = true;
+        vlc_mutex_unlock( &p_prescan->lock );
+    }
+
+    msg_Dbg( p_demux, "seek index: %zu pages over %"PRId64" bytes in %"PRId64
+             " ms%s", i_indexed, i_pos, MS_FROM_VLC_TICK( vlc_tick_now() - i_start ),
+             b_eof ? "" : " (incomplete)" );
+
+    vlc_stream_Delete( s );
+
+    return NULL;
+}
+
+void Oggseek_PrescanStart( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    bool b_fastseekable;
+
+    if( p_sys->p_prescan || p_demux->b_preparsing || !p_demux->psz_url ||
+        !var_InheritBool( p_demux, "ogg-seek-index" ) )
+        return;
+
+    if( vlc_stream_Control( p_demux->s, STREAM_CAN_FASTSEEK, &b_fastseekable ) ||
+        !b_fastseekable )
+        return;
+
+    oggseek_prescan_t *p_prescan = malloc( sizeof(*p_prescan) );
+    if( !p_prescan )
+        return;
+    p_prescan->p_streams = vlc_alloc( p_sys->i_streams, sizeof(*p_prescan->p_streams) );
+    if( !p_prescan->p_streams )
+    {
+        free( p_prescan );
+        return;
+    }
+
+    p_prescan->i_streams = 0;
+    for( int i = 0; i < p_sys->i_streams; i++ )
+    {
+        const logical_stream_t *p_stream = p_sys->pp_stream[i];
+        /* same restriction as when indexing during playback */
+        if( p_stream->fmt.i_cat != AUDIO_ES || p_stream->b_oggds )
+            continue;
+
+        oggseek_prescan_stream_t *p_entry = &p_prescan->p_streams[p_prescan->i_streams++];
+        p_entry->i_serial = p_stream->i_serial_no;
+        /* audio granules count samples */
+        p_entry->i_granule_interval = 0;
+        if( p_stream->dts.i_divider_den )
+            p_entry->i_granule_interval = SEC_FROM_VLC_TICK( OGGSEEK_INDEX_INTERVAL ) *
+                p_stream->dts.i_divider_num / p_stream->dts.i_divider_den;
+        p_entry->i_last_granule = -1;
+        p_entry->pending.i_pagepos = -1;
+        p_entry->b_complete = false;
+    }
+
+    if( p_prescan->i_streams == 0 )
+    {
+        free( p_prescan->p_streams );
+        free( p_prescan );
+        return;
+    }
+
+    p_prescan->p_demux = p_demux;
+    atomic_init( &p_prescan->b_abort, false );
+    vlc_mutex_init( &p_prescan->lock );
+    p_prescan->p_pages = NULL;
+    p_prescan->i_pages = 0;
+    p_prescan->i_max = 0;
+
+    if( vlc_clone( &p_prescan->thread, OggSeekPrescanThread, p_prescan ) )
+    {
+        free( p_prescan->p_streams );
+        free( p_prescan );
+        return;
+    }
+    p_sys->p_prescan = p_prescan;
+}
+
+void Oggseek_PrescanStop( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    oggseek_prescan_t *p_prescan = p_sys->p_prescan;
+
+    if( !p_prescan )
+        return;
+
+    atomic_store( &p_prescan->b_abort, true );
+    vlc_join( p_prescan->thread, NULL );
+
+    free( p_prescan->p_pages );
+    free( p_prescan->p_streams );
+    free( p_prescan );
+    p_sys->p_prescan = NULL;
+}
+
+/* Moves the pages found by the scanner to the streams indexes */
+static void OggSeekPrescanMerge( demux_t *p_demux )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+    oggseek_prescan_t *p_prescan = p_sys->p_prescan;
+
+    if( !p_prescan )
+        return;
+
+    /* granules can't be converted before the headers are parsed */
+    for( int i = 0; i < p_sys->i_streams; i++ )
+    {
+        if( p_sys->pp_stream[i]->b_initializing )
+            return;
+    }
+
+    vlc_mutex_lock( &p_prescan->lock );
+    oggseek_prescan_page_t *p_pages = p_prescan->p_pages;
+    size_t i_pages = p_prescan->i_pages;
+    p_prescan->p_pages = NULL;
+    p_prescan->i_pages = p_prescan->i_max = 0;
+    bool b_complete[p_prescan->i_streams];
+    for( size_t i = 0; i < p_prescan->i_streams; i++ )
+        b_complete[i] = p_prescan->p_streams[i].b_complete;
+    vlc_mutex_unlock( &p_prescan->lock );
+
+    for( int i_stream = 0; i_stream < p_sys->i_streams; i_stream++ )
+    {
+        logical_stream_t *p_stream = p_sys->pp_stream[i_stream];
+
+        for( size_t i = 0; i < i_pages; i++ )
+        {
+            if( p_pages[i].i_serial != (uint32_t) p_stream->i_serial_no )
+                continue;
+            vlc_tick_t i_time = Ogg_GranuleToTime( p_stream, p_pages[i].i_granule,
+                                                   !p_stream->b_contiguous, false );
+            if( i_time != VLC_TICK_INVALID )
+                OggSeekIndexAddRun( &p_stream->idx, &p_stream->idx.i_prescan_run,
+                                    i_time, p_pages[i].i_pagepos, 0 );
+        }
+
+        for( size_t i = 0; i < p_prescan->i_streams; i++ )
+        {
+            if( p_prescan->p_streams[i].i_serial == (uint32_t) p_stream->i_serial_no &&
+                b_complete[i] && !p_stream->idx.b_complete )
             {
-                *pi_pos_lower = idx->i_pagepos;
-                *pi_lower_timestamp = idx->i_value;
-                *pi_pos_upper = idx->p_next->i_pagepos;
-                return true;
+                p_stream->idx.b_complete = true;
+                msg_Dbg( p_demux, "seek index complete for stream %d: %zu entries",
+                         p_stream->i_serial_no, p_stream->idx.i_count );
             }
         }
-        idx = idx->p_next;
     }
 
-    return false;
+    free( p_pages );
 }
 
 /*********************************************************************
@@ -795,9 +1220,14 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
 
     /* And also search in our own index */
     vlc_tick_t foo;
-    if ( !b_found && OggSeekIndexFind( p_stream, i_time, &i_lowerpos, &i_upperpos, &foo ) )
+    bool b_exact;
+    OggSeekPrescanMerge( p_demux );
+    if ( !b_found && OggSeekIndexFind( p_stream, i_time, &i_lowerpos, &i_upperpos, &foo, &b_exact ) )
     {
-        b_found = true;
+        OggDebug( msg_Dbg( p_demux, "Found %s page at %"PRId64" using our index",
+                           b_exact ? "exact" : "lower", i_lowerpos ) );
+        /* otherwise only use it as bisection bounds */
+        b_found = b_exact || !b_fastseek;
     }
 
     /* FIXME: add function to get preload time by codec, ex: opus */
@@ -807,7 +1237,7 @@ int Oggseek_BlindSeektoAbsoluteTime( demux_t *p_demux, logical_stream_t *p_strea
     {
         int64_t i_sync_time;
         i_lowerpos = OggBisectSearchByTime( p_demux, p_stream, i_time,
-                                            p_stream->i_data_start, p_sys->i_total_bytes,
+                                            i_lowerpos, i_upperpos,
                                             &i_sync_time );
         b_found = ( i_lowerpos != -1 );
     }
@@ -894,10 +1324,21 @@ int Oggseek_SeektoAbsolutetime( demux_t *p_demux, logical_stream_t *p_stream,
     }
     OggDebug( msg_Dbg( p_demux, "Search bounds set to %"PRId64" %"PRId64" using skeleton index", i_offset_lower, i_offset_upper ) );
 
+    OggSeekPrescanMerge( p_demux );
 
     vlc_tick_t i_lower_index;
-    if(!OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper, &i_lower_index ))
+    bool b_exact;
+    if(!OggSeekIndexFind( p_stream, i_time, &i_offset_lower, &i_offset_upper, &i_lower_index, &b_exact ))
         i_lower_index = 0;
+    else if ( b_exact && i_offset_lower >= p_stream->i_data_start )
+    {
+        /* Pages were read in sequence around that time */
+        OggDebug( msg_Dbg( p_demux, "Found page at %"PRId64" using our index", i_offset_lower ) );
+        ogg_stream_reset( &p_stream->os );
+        p_sys->i_input_position = i_offset_lower;
+        seek_byte( p_demux, p_sys->i_input_position );
+        return i_offset_lower;
+    }
 
     i_offset_lower = __MAX( i_offset_lower, p_stream->i_data_start );
     i_offset_upper = __MIN( i_offset_upper, p_sys->i_total_bytes );
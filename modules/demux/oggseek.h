@@ -40,21 +40,30 @@
 #define OGGSEEK_BYTES_TO_READ 8500
 #define OGGSEEK_SERIALNO_MAX_LOOKUP_BYTES (OGGSEEK_BYTES_TO_READ * 25)
 
+/* minimum time between two pages indexed while reading */
+#define OGGSEEK_INDEX_INTERVAL VLC_TICK_FROM_SEC(1)
+
 /* this is typedefed to demux_index_entry_t in ogg.h */
 struct oggseek_index_entry
 {
-    demux_index_entry_t *p_next;
     /* value is highest granulepos for theora, sync frame for dirac */
     vlc_tick_t i_value;
     int64_t i_pagepos;
+    /* pages up to the next entry were all read in sequence */
+    bool b_contiguous;
 };
 
 int     Oggseek_BlindSeektoAbsoluteTime ( demux_t *, logical_stream_t *, vlc_tick_t, bool );
 int     Oggseek_BlindSeektoPosition ( demux_t *, logical_stream_t *, double f, bool );
 int     Oggseek_SeektoAbsolutetime ( demux_t *, logical_stream_t *, vlc_tick_t );
 const demux_index_entry_t *OggSeek_IndexAdd ( logical_stream_t *, vlc_tick_t, int64_t );
+void    OggSeek_IndexPage ( logical_stream_t *, const ogg_page *, int64_t );
 void    Oggseek_ProbeEnd( demux_t * );
 
-void oggseek_index_entries_free ( demux_index_entry_t * );
+void    Oggseek_PrescanStart( demux_t * );
+void    Oggseek_PrescanStop( demux_t * );
+
+void oggseek_index_init ( oggseek_index_t * );
+void oggseek_index_clean ( oggseek_index_t * );
 
 int64_t oggseek_read_page ( demux_t * );
@@ -340,6 +340,7 @@ static int ReadDir( stream_t *p_demux, input_item_node_t *p_subitems )
             free( psz_parse );
 
             CreateEntry( p_subitems, &meta );
+            PlaylistPostBatch( p_demux, p_subitems );
 
             /* Cleanup state after entry */
             entry_meta_Clean( &meta );
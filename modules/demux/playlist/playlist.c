@@ -200,6 +200,36 @@ char *ProcessMRL(const char *str, const char *base)
     return abs;
 }
 
+void PlaylistPostBatch( stream_t *p_demux, input_item_node_t *p_node )
+{
+    if( p_node->i_children < PLAYLIST_BATCH_SIZE || p_demux->out == NULL )
+        return;
+
+    input_item_node_t *p_batch = input_item_node_Create( p_node->p_item );
+    if( unlikely(p_batch == NULL) )
+        return; /* keep them for the next batch */
+
+    p_batch->i_children = p_node->i_children;
+    p_batch->pp_children = p_node->pp_children;
+    p_batch->b_append = p_node->b_append;
+    p_node->i_children = 0;
+    p_node->pp_children = NULL;
+
+    /* the node is released by the es_out on success */
+    if( es_out_Control( p_demux->out, ES_OUT_POST_SUBNODE, p_batch ) )
+    {
+        p_node->i_children = p_batch->i_children;
+        p_node->pp_children = p_batch->pp_children;
+        p_batch->i_children = 0;
+        p_batch->pp_children = NULL;
+        input_item_node_Delete( p_batch );
+        return;
+    }
+
+    /* the remaining subitems follow the ones already posted */
+    p_node->b_append = true;
+}
+
 int PlaylistControl( stream_t *p_access, int i_query, va_list args )
 {
     switch ( i_query )
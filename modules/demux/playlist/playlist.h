@@ -26,6 +26,14 @@ char *ProcessMRL( const char *, const char * );
 
 int PlaylistControl( stream_t *p_access, int i_query, va_list args );
 
+/* Number of entries read before they are posted to the input */
+#define PLAYLIST_BATCH_SIZE 1000
+
+/* Post the subitems of the node read so far once there are
+ * PLAYLIST_BATCH_SIZE of them, so that large playlists are not expanded all
+ * at once when the whole file has been parsed */
+void PlaylistPostBatch( stream_t *p_demux, input_item_node_t *p_node );
+
 int Import_M3U ( vlc_object_t * );
 
 int Import_RAM ( vlc_object_t * );
@@ -78,6 +78,7 @@ typedef struct
     int i_tracklist_entries;
     int i_track_id;
     char * psz_base;
+    input_item_node_t *p_root; /* node of the playlist item */
 } xspf_sys_t;
 
 static int ReadDir(stream_t *, input_item_node_t *);
@@ -131,6 +132,7 @@ static int ReadDir(stream_t *p_stream, input_item_node_t *p_subitems)
     sys->i_tracklist_entries = 0;
     sys->i_track_id = -1;
     sys->psz_base = strdup(p_stream->psz_url);
+    sys->p_root = p_subitems;
 
     /* create new xml parser from stream */
     p_xml_reader = xml_ReaderCreate(p_stream, p_stream->s);
@@ -489,6 +491,9 @@ static bool parse_track_node COMPLEX_INTERFACE
             }
             else b_ret = false;
         }
+
+        if (p_input_node == p_sys->p_root)
+            PlaylistPostBatch(p_stream, p_input_node);
     }
 
     if(p_new_node)
@@ -103,22 +103,40 @@ enum subtitle_type_e
     SUB_TYPE_SCC,      /* Scenarist Closed Caption */
 };
 
+/* lines kept behind the current one when reading from the stream */
+#define TEXT_STREAM_LINES 4
+
+/* Files larger than this are indexed at open and their entries parsed
+ * again from the stream when they are due */
+#define SUB_LAZY_MIN_SIZE (1024 * 1024)
+
 typedef struct
 {
     size_t  i_line_count;
     size_t  i_line;
     char    **line;
+
+    /* streamed mode: lines are read on demand and only the last
+     * TEXT_STREAM_LINES of them are kept */
+    stream_t *s;
+    uint64_t  pi_pos[TEXT_STREAM_LINES];
 } text_t;
 
 static int  TextLoad( text_t *, stream_t *s );
+static int  TextStreamInit( text_t *, stream_t *s );
 static void TextUnload( text_t * );
+static uint64_t TextTell( const text_t * );
+static int  TextSeek( text_t *, uint64_t );
 
 typedef struct
 {
     vlc_tick_t i_start;
     vlc_tick_t i_stop;
 
-    char    *psz_text;
+    char    *psz_text; /* NULL until needed when loading lazily */
+
+    uint64_t i_offset; /* first line read by the parser for this entry */
+    size_t   i_idx;
 } subtitle_t;
 
 typedef struct
@@ -174,6 +192,14 @@ typedef struct
     /* */
     subs_properties_t props;
 
+    /* entries text read from the stream when sent */
+    struct
+    {
+        bool    b_enabled;
+        text_t  txt;
+        int  (*pf_read)( vlc_object_t *, subs_properties_t *, text_t *, subtitle_t*, size_t );
+    } lazy;
+
     block_t * (*pf_convert)( const subtitle_t * );
 } demux_sys_t;
 
@@ -202,29 +228,32 @@ static const struct
     int  i_type;
     const char *psz_name;
     int  (*pf_read)( vlc_object_t *, subs_properties_t *, text_t *, subtitle_t*, size_t );
+    /* an entry can be parsed again starting from its first line, with
+     * the properties as they were after the whole file was read */
+    bool b_lazy;
 } sub_read_subtitle_function [] =
 {
-    { "microdvd",   SUB_TYPE_MICRODVD,    "MicroDVD",    ParseMicroDvd },
-    { "subrip",     SUB_TYPE_SUBRIP,      "SubRIP",      ParseSubRip },
-    { "subviewer",  SUB_TYPE_SUBVIEWER,   "SubViewer",   ParseSubViewer },
-    { "ssa1",       SUB_TYPE_SSA1,        "SSA-1",       ParseSSA },
-    { "ssa2-4",     SUB_TYPE_SSA2_4,      "SSA-2/3/4",   ParseSSA },
-    { "ass",        SUB_TYPE_ASS,         "SSA/ASS",     ParseSSA },
-    { "vplayer",    SUB_TYPE_VPLAYER,     "VPlayer",     ParseVplayer },
-    { "sami",       SUB_TYPE_SAMI,        "SAMI",        ParseSami },
-    { "dvdsubtitle",SUB_TYPE_DVDSUBTITLE, "DVDSubtitle", ParseDVDSubtitle },
-    { "mpl2",       SUB_TYPE_MPL2,        "MPL2",        ParseMPL2 },
-    { "aqt",        SUB_TYPE_AQT,         "AQTitle",     ParseAQT },
-    { "pjs",        SUB_TYPE_PJS,         "PhoenixSub",  ParsePJS },
-    { "mpsub",      SUB_TYPE_MPSUB,       "MPSub",       ParseMPSub },
-    { "jacosub",    SUB_TYPE_JACOSUB,     "JacoSub",     ParseJSS },
-    { "psb",        SUB_TYPE_PSB,         "PowerDivx",   ParsePSB },
-    { "realtext",   SUB_TYPE_RT,          "RealText",    ParseRealText },
-    { "dks",        SUB_TYPE_DKS,         "DKS",         ParseDKS },
-    { "subviewer1", SUB_TYPE_SUBVIEW1,    "Subviewer 1", ParseSubViewer1 },
-    { "sbv",        SUB_TYPE_SBV,         "SBV",         ParseCommonSBV },
-    { "scc",        SUB_TYPE_SCC,         "SCC",         ParseSCC },
-    { NULL,         SUB_TYPE_UNKNOWN,     "Unknown",     NULL }
+    { "microdvd",   SUB_TYPE_MICRODVD,    "MicroDVD",    ParseMicroDvd,    true },
+    { "subrip",     SUB_TYPE_SUBRIP,      "SubRIP",      ParseSubRip,      true },
+    { "subviewer",  SUB_TYPE_SUBVIEWER,   "SubViewer",   ParseSubViewer,   true },
+    { "ssa1",       SUB_TYPE_SSA1,        "SSA-1",       ParseSSA,         true },
+    { "ssa2-4",     SUB_TYPE_SSA2_4,      "SSA-2/3/4",   ParseSSA,         true },
+    { "ass",        SUB_TYPE_ASS,         "SSA/ASS",     ParseSSA,         true },
+    { "vplayer",    SUB_TYPE_VPLAYER,     "VPlayer",     ParseVplayer,     true },
+    { "sami",       SUB_TYPE_SAMI,        "SAMI",        ParseSami,        false },
+    { "dvdsubtitle",SUB_TYPE_DVDSUBTITLE, "DVDSubtitle", ParseDVDSubtitle, false },
+    { "mpl2",       SUB_TYPE_MPL2,        "MPL2",        ParseMPL2,        true },
+    { "aqt",        SUB_TYPE_AQT,         "AQTitle",     ParseAQT,         false },
+    { "pjs",        SUB_TYPE_PJS,         "PhoenixSub",  ParsePJS,         false },
+    { "mpsub",      SUB_TYPE_MPSUB,       "MPSub",       ParseMPSub,       false },
+    { "jacosub",    SUB_TYPE_JACOSUB,     "JacoSub",     ParseJSS,         false },
+    { "psb",        SUB_TYPE_PSB,         "PowerDivx",   ParsePSB,         false },
+    { "realtext",   SUB_TYPE_RT,          "RealText",    ParseRealText,    false },
+    { "dks",        SUB_TYPE_DKS,         "DKS",         ParseDKS,         false },
+    { "subviewer1", SUB_TYPE_SUBVIEW1,    "Subviewer 1", ParseSubViewer1,  false },
+    { "sbv",        SUB_TYPE_SBV,         "SBV",         ParseCommonSBV,   true },
+    { "scc",        SUB_TYPE_SCC,         "SCC",         ParseSCC,         false },
+    { NULL,         SUB_TYPE_UNKNOWN,     "Unknown",     NULL,             false }
 };
 /* When adding support for more formats, be sure to add their file extension
  * to src/input/subtitles.c to enable auto-detection.
@@ -293,6 +322,7 @@ static int Open ( vlc_object_t *p_this )
     float          f_fps;
     char           *psz_type;
     int  (*pf_read)( vlc_object_t *, subs_properties_t *, text_t *, subtitle_t*, size_t );
+    bool           b_lazy = false;
 
     if( !p_demux->obj.force )
     {
@@ -317,6 +347,8 @@ static int Open ( vlc_object_t *p_this )
     p_sys->subtitles.i_count  = 0;
     p_sys->subtitles.p_array  = NULL;
 
+    p_sys->lazy.b_enabled = false;
+
     p_sys->props.psz_header         = NULL;
     p_sys->props.psz_lang           = NULL;
     p_sys->props.i_microsecperframe = VLC_TICK_FROM_MS(40);
@@ -621,11 +653,23 @@ static int Open ( vlc_object_t *p_this )
             msg_Dbg( p_demux, "detected %s format",
                      sub_read_subtitle_function[i].psz_name );
             pf_read = sub_read_subtitle_function[i].pf_read;
+            b_lazy = sub_read_subtitle_function[i].b_lazy;
             break;
         }
     }
 
-    msg_Dbg( p_demux, "loading all subtitles..." );
+    /* Only keep the timings of large files, the text will be read again */
+    uint64_t i_size;
+    bool b_can_seek;
+    if( b_lazy &&
+        ( vlc_stream_GetSize( p_demux->s, &i_size ) ||
+          i_size < SUB_LAZY_MIN_SIZE ||
+          vlc_stream_Control( p_demux->s, STREAM_CAN_SEEK, &b_can_seek ) ||
+          !b_can_seek ) )
+        b_lazy = false;
+
+    msg_Dbg( p_demux, b_lazy ? "indexing all subtitles..."
+                             : "loading all subtitles..." );
 
     if( e_bom == UTF8BOM && /* skip BOM */
         vlc_stream_Read( p_demux->s, NULL, 3 ) != 3 )
@@ -634,9 +678,18 @@ static int Open ( vlc_object_t *p_this )
         return VLC_EGENERIC;
     }
 
-    /* Load the whole file */
+    /* Load the whole file, or read it line by line */
     text_t txtlines;
-    TextLoad( &txtlines, p_demux->s );
+    if( b_lazy )
+    {
+        if( TextStreamInit( &txtlines, p_demux->s ) )
+        {
+            Close( p_this );
+            return VLC_ENOMEM;
+        }
+    }
+    else
+        TextLoad( &txtlines, p_demux->s );
 
     /* Parse it */
     for( size_t i_max = 0; i_max < SIZE_MAX - 500 * sizeof(subtitle_t); )
@@ -654,17 +707,36 @@ static int Open ( vlc_object_t *p_this )
             p_sys->subtitles.p_array = p_realloc;
         }
 
+        subtitle_t *p_subtitle = &p_sys->subtitles.p_array[p_sys->subtitles.i_count];
+        p_subtitle->i_offset = b_lazy ? TextTell( &txtlines ) : 0;
+        p_subtitle->i_idx = p_sys->subtitles.i_count;
         if( pf_read( VLC_OBJECT(p_demux), &p_sys->props, &txtlines,
-                     &p_sys->subtitles.p_array[p_sys->subtitles.i_count],
-                     p_sys->subtitles.i_count ) )
+                     p_subtitle, p_sys->subtitles.i_count ) )
             break;
 
+        if( b_lazy )
+        {
+            free( p_subtitle->psz_text );
+            p_subtitle->psz_text = NULL;
+        }
         p_sys->subtitles.i_count++;
     }
-    /* Unload */
-    TextUnload( &txtlines );
 
-    msg_Dbg(p_demux, "loaded %zu subtitles", p_sys->subtitles.i_count );
+    if( b_lazy )
+    {
+        /* keep the reader, its lines are only the last few read */
+        p_sys->lazy.b_enabled = true;
+        p_sys->lazy.txt = txtlines;
+        p_sys->lazy.pf_read = pf_read;
+    }
+    else
+    {
+        /* Unload */
+        TextUnload( &txtlines );
+    }
+
+    msg_Dbg(p_demux, "%s %zu subtitles", b_lazy ? "indexed" : "loaded",
+            p_sys->subtitles.i_count );
 
     /* *** add subtitle ES *** */
     if( p_sys->props.i_type == SUB_TYPE_SSA1 ||
@@ -737,6 +809,8 @@ static void Close( vlc_object_t *p_this )
         free( p_sys->subtitles.p_array[i].psz_text );
     free( p_sys->subtitles.p_array );
     free( p_sys->props.psz_header );
+    if( p_sys->lazy.b_enabled )
+        TextUnload( &p_sys->lazy.txt );
 
     free( p_sys );
 }
@@ -844,6 +918,49 @@ static int Control( demux_t *p_demux, int i_query, va_list args )
 /*****************************************************************************
  * Demux: Send subtitle to decoder
  *****************************************************************************/
+/* Parse again the entry from its first line, only its text is used */
+static int LoadText( demux_t *p_demux, const subtitle_t *p_subtitle,
+                     subtitle_t *p_loaded )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( TextSeek( &p_sys->lazy.txt, p_subtitle->i_offset ) )
+        return VLC_EGENERIC;
+
+    /* anything collected again is dropped, the ES is already set up */
+    subs_properties_t props = p_sys->props;
+    props.psz_header = NULL;
+    props.psz_lang = NULL;
+
+    p_loaded->psz_text = NULL;
+    int i_ret = p_sys->lazy.pf_read( VLC_OBJECT(p_demux), &props,
+                                     &p_sys->lazy.txt, p_loaded,
+                                     p_subtitle->i_idx );
+    free( props.psz_header );
+    free( props.psz_lang );
+    if( i_ret == VLC_SUCCESS && p_loaded->psz_text == NULL )
+        i_ret = VLC_EGENERIC;
+    return i_ret;
+}
+
+static block_t *ToBlock( demux_t *p_demux, const subtitle_t *p_subtitle )
+{
+    demux_sys_t *p_sys = p_demux->p_sys;
+
+    if( !p_sys->lazy.b_enabled )
+        return p_sys->pf_convert( p_subtitle );
+
+    subtitle_t loaded;
+    if( LoadText( p_demux, p_subtitle, &loaded ) )
+    {
+        msg_Warn( p_demux, "cannot read subtitle %zu", p_subtitle->i_idx );
+        return NULL;
+    }
+    block_t *p_block = p_sys->pf_convert( &loaded );
+    free( loaded.psz_text );
+    return p_block;
+}
+
 static int Demux( demux_t *p_demux )
 {
     demux_sys_t *p_sys = p_demux->p_sys;
@@ -864,7 +981,7 @@ static int Demux( demux_t *p_demux )
 
         if( p_subtitle->i_start >= 0 )
         {
-            block_t *p_block = p_sys->pf_convert( p_subtitle );
+            block_t *p_block = ToBlock( p_demux, p_subtitle );
             if( p_block )
             {
                 p_block->i_dts =
@@ -918,6 +1035,7 @@ static int TextLoad( text_t *txt, stream_t *s )
     i_line_max          = 500;
     txt->i_line_count   = 0;
     txt->i_line         = 0;
+    txt->s              = NULL;
     txt->line           = calloc( i_line_max, sizeof( char * ) );
     if( !txt->line )
         return VLC_ENOMEM;
@@ -952,7 +1070,13 @@ static int TextLoad( text_t *txt, stream_t *s )
 }
 static void TextUnload( text_t *txt )
 {
-    if( txt->i_line_count )
+    if( txt->s )
+    {
+        for( size_t i = 0; i < TEXT_STREAM_LINES; i++ )
+            free( txt->line[i] );
+        free( txt->line );
+    }
+    else if( txt->i_line_count )
     {
         for( size_t i = 0; i < txt->i_line_count; i++ )
             free( txt->line[i] );
@@ -962,15 +1086,62 @@ static void TextUnload( text_t *txt )
     txt->i_line_count = 0;
 }
 
+static int TextStreamInit( text_t *txt, stream_t *s )
+{
+    txt->i_line_count   = 0;
+    txt->i_line         = 0;
+    txt->s              = s;
+    txt->line           = calloc( TEXT_STREAM_LINES, sizeof( char * ) );
+    if( !txt->line )
+        return VLC_ENOMEM;
+    return VLC_SUCCESS;
+}
+
+/* Offset of the line TextGetLine() will return next */
+static uint64_t TextTell( const text_t *txt )
+{
+    if( txt->i_line < txt->i_line_count )
+        return txt->pi_pos[txt->i_line % TEXT_STREAM_LINES];
+    return vlc_stream_Tell( txt->s );
+}
+
+static int TextSeek( text_t *txt, uint64_t i_pos )
+{
+    /* entries are mostly read in order, keep going if we are there */
+    if( TextTell( txt ) == i_pos )
+        return VLC_SUCCESS;
+
+    txt->i_line = txt->i_line_count = 0;
+    return vlc_stream_Seek( txt->s, i_pos );
+}
+
 static char *TextGetLine( text_t *txt )
 {
+    if( txt->s && txt->i_line == txt->i_line_count )
+    {
+        const uint64_t i_pos = vlc_stream_Tell( txt->s );
+        char *psz = vlc_stream_ReadLine( txt->s );
+        if( psz == NULL )
+            return NULL;
+
+        const size_t i_slot = txt->i_line_count++ % TEXT_STREAM_LINES;
+        free( txt->line[i_slot] );
+        txt->line[i_slot] = psz;
+        txt->pi_pos[i_slot] = i_pos;
+    }
+
     if( txt->i_line >= txt->i_line_count )
         return( NULL );
 
+    if( txt->s )
+        return txt->line[txt->i_line++ % TEXT_STREAM_LINES];
     return txt->line[txt->i_line++];
 }
 static void TextPreviousLine( text_t *txt )
 {
+    /* streamed lines are only kept for a while */
+    if( txt->s && txt->i_line + TEXT_STREAM_LINES <= txt->i_line_count )
+        return;
     if( txt->i_line > 0 )
         txt->i_line--;
 }
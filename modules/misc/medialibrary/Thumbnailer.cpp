@@ -74,6 +74,7 @@ bool Thumbnailer::generate( const medialibrary::IMedia&, const std::string& mrl,
         m_currentContext = &ctx;
         ctx.request = vlc_thumbnailer_RequestByPos( m_thumbnailer.get(), position,
                                       VLC_THUMBNAILER_SEEK_FAST, item.get(),
+                                      desiredWidth, desiredHeight,
                                       VLC_TICK_FROM_SEC( 3 ),
                                       &onThumbnailComplete, &ctx );
 
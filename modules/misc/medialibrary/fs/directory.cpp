@@ -36,6 +36,8 @@
 
 #include <algorithm>
 #include <assert.h>
+#include <cstring>
+#include <ctime>
 #include <medialibrary/filesystem/Errors.h>
 #include <sys/stat.h>
 #include <system_error>
@@ -191,6 +193,79 @@ static bool request_metadata_sync( libvlc_int_t *libvlc, input_item_t *media,
 void
 SDDirectory::read() const
 {
+    /* the listing of a watched directory is trusted until it changes, the
+     * other ones (from a previous run, or after lost events) are checked */
+    bool trusted;
+    uint64_t token;
+    auto listing = m_fs.listing( m_mrl, &trusted, &token );
+    if ( listing != nullptr && !trusted )
+        listing = check( *listing );
+
+    bool relative = true;
+    if ( listing == nullptr )
+        listing = browse( &relative );
+    if ( relative && !trusted )
+        m_fs.storeListing( m_mrl, listing, token );
+
+    const std::string base = relative ? m_mrl : std::string{};
+    for ( const auto& dir : listing->dirs )
+        m_dirs.push_back( std::make_shared<SDDirectory>( base + dir, m_fs ) );
+    for ( const auto& f : listing->files )
+    {
+        if ( f.linkedType == IFile::LinkedFileType::None )
+            m_files.push_back( std::make_shared<SDFile>(
+                base + f.name, f.size, f.lastModificationDate ) );
+        else
+            m_files.push_back( std::make_shared<SDFile>(
+                base + f.name, f.linkedType, base + f.linkedWith, f.size,
+                f.lastModificationDate ) );
+    }
+
+    m_read_done = true;
+}
+
+std::shared_ptr<const SDListing>
+SDDirectory::check( const SDListing& cached ) const
+{
+    auto listing = std::make_shared<SDListing>( cached );
+    listing->listingDate = time( nullptr );
+
+    /* same modification date: same entries, but the files may have been
+     * modified */
+    auto path = vlc::wrap_cptr( vlc_uri2path( m_mrl.c_str() ) );
+    struct stat stat;
+    if ( path == nullptr || vlc_stat( path.get(), &stat ) != 0
+      || stat.st_mtime != cached.lastModificationDate
+      || cached.lastModificationDate >= cached.listingDate )
+        return nullptr;
+
+    for ( auto& f : listing->files )
+    {
+        auto filePath = vlc::wrap_cptr( vlc_uri2path( ( m_mrl + f.name ).c_str() ) );
+        if ( filePath == nullptr || vlc_stat( filePath.get(), &stat ) != 0 )
+            return nullptr;
+        f.size = stat.st_size;
+        f.lastModificationDate = stat.st_mtime;
+    }
+    return listing;
+}
+
+std::shared_ptr<const SDListing>
+SDDirectory::browse( bool *relative ) const
+{
+    auto listing = std::make_shared<SDListing>();
+    listing->listingDate = time( nullptr );
+    /* never trusted, unless the modification date is known */
+    listing->lastModificationDate = listing->listingDate;
+
+    if ( m_fs.isNetworkFileSystem() == false )
+    {
+        auto path = vlc::wrap_cptr( vlc_uri2path( m_mrl.c_str() ) );
+        struct stat stat;
+        if ( path != nullptr && vlc_stat( path.get(), &stat ) == 0 )
+            listing->lastModificationDate = stat.st_mtime;
+    }
+
     auto media =
         vlc::wrap_cptr( input_item_New( m_mrl.c_str(), m_mrl.c_str() ), &input_item_Release );
     if ( !media )
@@ -207,17 +282,31 @@ SDDirectory::read() const
         throw medialibrary::fs::errors::System(
             EIO, "Failed to browse directory: Unknown error" );
 
+    /* the entries are kept relative to the directory when possible */
+    *relative = std::all_of( cbegin( children ), cend( children ),
+                             [this]( const InputItemPtr& m ) {
+        if ( strncmp( m->psz_uri, m_mrl.c_str(), m_mrl.length() ) != 0 )
+            return false;
+        for ( auto i = 0; i < m->i_slaves; ++i )
+            if ( strncmp( m->pp_slaves[i]->psz_uri, m_mrl.c_str(),
+                          m_mrl.length() ) != 0 )
+                return false;
+        return true;
+    });
+    const size_t prefix = *relative ? m_mrl.length() : 0;
+
     for ( const InputItemPtr& m : children )
     {
         const char* mrl = m.get()->psz_uri;
         enum input_item_type_e type = m->i_type;
         if ( type == ITEM_TYPE_DIRECTORY )
         {
-            m_dirs.push_back( std::make_shared<SDDirectory>( mrl, m_fs ) );
+            listing->dirs.push_back( mrl + prefix );
         }
         else if ( type == ITEM_TYPE_FILE )
         {
-            addFile( mrl, IFile::LinkedFileType::None, {} );
+            addFile( *listing, m.get(), mrl, IFile::LinkedFileType::None, {},
+                     prefix );
             for ( auto i = 0; i < m->i_slaves; ++i )
             {
                 const auto* slave = m->pp_slaves[i];
@@ -225,21 +314,36 @@ SDDirectory::read() const
                                              ? IFile::LinkedFileType::SoundTrack
                                              : IFile::LinkedFileType::Subtitles;
 
-                addFile( slave->psz_uri, linked_type, mrl );
+                addFile( *listing, nullptr, slave->psz_uri, linked_type, mrl,
+                         prefix );
             }
         }
     }
+    return listing;
+}
 
-    m_read_done = true;
+static bool getStat( input_item_t* item, const char* name, int64_t* value )
+{
+    auto info = vlc::wrap_cptr( input_item_GetInfo( item, ".stat", name ) );
+    if ( info == nullptr || info.get()[0] == '\0' )
+        return false;
+    *value = strtoll( info.get(), nullptr, 10 );
+    return true;
 }
 
 void
-SDDirectory::addFile(std::string mrl, IFile::LinkedFileType fType, std::string linkedFile) const
+SDDirectory::addFile( SDListing& listing, input_item_t* item, std::string mrl,
+                      IFile::LinkedFileType fType, std::string linkedFile,
+                      size_t prefix ) const
 {
-    time_t lastModificationDate = 0;
+    int64_t lastModificationDate = 0;
     int64_t fileSize = 0;
 
-    if ( m_fs.isNetworkFileSystem() == false )
+    /* the directory access provides the size and date of its items, but not
+     * of the linked files */
+    if ( m_fs.isNetworkFileSystem() == false
+      && ( item == nullptr || !getStat( item, "mtime", &lastModificationDate )
+                           || !getStat( item, "size", &fileSize ) ) )
     {
         const auto path = vlc::wrap_cptr( vlc_uri2path( mrl.c_str() ) );
         struct stat stat;
@@ -254,16 +358,14 @@ SDDirectory::addFile(std::string mrl, IFile::LinkedFileType fType, std::string l
         fileSize = stat.st_size;
     }
 
-    if ( fType == IFile::LinkedFileType::None )
-    {
-        m_files.push_back(
-            std::make_shared<SDFile>( std::move( mrl ), fileSize, lastModificationDate ) );
-    }
-    else
-    {
-        m_files.push_back( std::make_shared<SDFile>(
-            std::move( mrl ), fType, std::move( linkedFile ), fileSize, lastModificationDate ) );
-    }
+    SDListing::File f;
+    f.name = mrl.substr( prefix );
+    if ( fType != IFile::LinkedFileType::None )
+        f.linkedWith = linkedFile.substr( prefix );
+    f.linkedType = fType;
+    f.size = fileSize;
+    f.lastModificationDate = lastModificationDate;
+    listing.files.push_back( std::move( f ) );
 }
   } /* namespace medialibrary */
 } /* namespace vlc */
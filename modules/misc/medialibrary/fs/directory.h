@@ -44,7 +44,11 @@ public:
 
 private:
     void read() const;
-    void addFile( std::string mrl, fs::IFile::LinkedFileType, std::string linkedWith ) const;
+    std::shared_ptr<const SDListing> check( const SDListing& cached ) const;
+    std::shared_ptr<const SDListing> browse( bool *relative ) const;
+    void addFile( SDListing& listing, input_item_t* item, std::string mrl,
+                  fs::IFile::LinkedFileType, std::string linkedWith,
+                  size_t prefix ) const;
 
     std::string m_mrl;
     SDFileSystemFactory &m_fs;
@@ -23,6 +23,11 @@
 #endif
 
 #include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <sstream>
+#include <vlc_common.h>
+#include <vlc_fs.h>
 #include <vlc_services_discovery.h>
 #include <medialibrary/IDeviceLister.h>
 #include <medialibrary/filesystem/IDevice.h>
@@ -32,6 +37,9 @@
 #include "directory.h"
 #include "util.h"
 #include "fs.h"
+#include "watcher.h"
+
+#define LISTINGS_HEADER "VLC media library listings 1"
 
 namespace vlc {
   namespace medialibrary {
@@ -39,10 +47,12 @@ namespace vlc {
 using namespace ::medialibrary;
 
 SDFileSystemFactory::SDFileSystemFactory(vlc_object_t *parent,
-                                         const std::string &scheme)
+                                         const std::string &scheme,
+                                         std::string listingsPath)
     : m_parent(parent)
     , m_scheme(scheme)
     , m_callbacks( nullptr )
+    , m_listingsPath( std::move( listingsPath ) )
 {
     m_isNetwork = strncasecmp( m_scheme.c_str(), "file://",
                                m_scheme.length() ) != 0;
@@ -116,6 +126,7 @@ SDFileSystemFactory::start(IFileSystemFactoryCb *callbacks)
 {
     assert( isStarted() == false );
     m_callbacks = callbacks;
+    loadListings();
     return m_deviceLister->start( this );
 }
 
@@ -125,6 +136,7 @@ SDFileSystemFactory::stop()
     assert( isStarted() == true );
     m_deviceLister->stop();
     m_callbacks = nullptr;
+    saveListings();
 }
 
 libvlc_int_t *
@@ -223,5 +235,196 @@ std::shared_ptr<IDevice> SDFileSystemFactory::deviceByMrl(const std::string& mrl
     return res;
 }
 
+void SDFileSystemFactory::setWatcher(SDWatcher *watcher)
+{
+    vlc::threads::mutex_locker lock( m_listingsMutex );
+    m_watcher = watcher;
+    if ( watcher == nullptr )
+    {
+        m_listingsEpoch++;
+        for ( auto& l : m_listings )
+            l.second.trusted = false;
+    }
+}
+
+std::shared_ptr<const SDListing>
+SDFileSystemFactory::listing(const std::string &mrl, bool *trusted,
+                             uint64_t *token)
+{
+    *trusted = false;
+    *token = 0;
+    if ( m_isNetwork )
+        return nullptr;
+
+    vlc::threads::mutex_locker lock( m_listingsMutex );
+    /* the listing can only be trusted if the changes made while it is read
+     * are reported, and as long as they are */
+    bool watched = m_watcher != nullptr && m_watcher->isWatched( mrl );
+    if ( watched )
+        *token = m_listingsEpoch;
+
+    auto it = m_listings.find( mrl );
+    if ( it == m_listings.end() )
+        return nullptr;
+    *trusted = it->second.trusted && watched;
+    return it->second.listing;
+}
+
+void
+SDFileSystemFactory::storeListing(const std::string &mrl,
+                                  std::shared_ptr<const SDListing> listing,
+                                  uint64_t token)
+{
+    if ( m_isNetwork )
+        return;
+
+    vlc::threads::mutex_locker lock( m_listingsMutex );
+    bool trusted = token != 0 && token == m_listingsEpoch
+                && m_watcher != nullptr && m_watcher->isWatched( mrl );
+    m_listings[mrl] = CachedListing{ std::move( listing ), trusted };
+}
+
+void SDFileSystemFactory::invalidate(const std::string &mrl)
+{
+    vlc::threads::mutex_locker lock( m_listingsMutex );
+    m_listingsEpoch++;
+    /* it will be read again anyway (and it may not exist anymore) */
+    m_listings.erase( mrl );
+}
+
+void SDFileSystemFactory::invalidateAll()
+{
+    vlc::threads::mutex_locker lock( m_listingsMutex );
+    m_listingsEpoch++;
+    for ( auto& l : m_listings )
+        l.second.trusted = false;
+}
+
+void SDFileSystemFactory::loadListings()
+{
+    if ( m_isNetwork || m_listingsPath.empty() )
+        return;
+
+    FILE *file = vlc_fopen( m_listingsPath.c_str(), "rt" );
+    if ( file == nullptr )
+        return;
+
+    std::unordered_map<std::string, CachedListing> listings;
+    std::shared_ptr<SDListing> listing;
+    char *line = nullptr;
+    size_t size = 0;
+    bool valid = getline( &line, &size, file ) != -1
+              && !strcmp( line, LISTINGS_HEADER "\n" );
+
+    while ( valid && getline( &line, &size, file ) != -1 )
+    {
+        std::istringstream in( line );
+        char type = 0;
+        in >> type;
+        if ( type == 'D' )
+        {
+            long long mtime, date;
+            std::string mrl;
+            in >> mtime >> date >> mrl;
+            listing = std::make_shared<SDListing>();
+            listing->lastModificationDate = mtime;
+            listing->listingDate = date;
+            listings[mrl] = CachedListing{ listing, false };
+        }
+        else if ( type == 'S' && listing != nullptr )
+        {
+            std::string name;
+            in >> name;
+            listing->dirs.push_back( std::move( name ) );
+        }
+        else if ( type == 'F' && listing != nullptr )
+        {
+            SDListing::File f;
+            long long mtime;
+            int linkedType;
+            in >> f.size >> mtime >> linkedType >> f.name >> f.linkedWith;
+            f.lastModificationDate = mtime;
+            f.linkedType = static_cast<IFile::LinkedFileType>( linkedType );
+            if ( f.linkedWith == "-" )
+                f.linkedWith.clear();
+            listing->files.push_back( std::move( f ) );
+        }
+        else
+            valid = false;
+        if ( in.fail() )
+            valid = false;
+    }
+    free( line );
+    fclose( file );
+
+    if ( !valid )
+    {
+        msg_Warn( m_parent, "ignoring invalid listings %s",
+                  m_listingsPath.c_str() );
+        return;
+    }
+
+    vlc::threads::mutex_locker lock( m_listingsMutex );
+    m_listings = std::move( listings );
+}
+
+void SDFileSystemFactory::saveListings()
+{
+    if ( m_isNetwork || m_listingsPath.empty() )
+        return;
+
+    /* the mrls are encoded, but the entry points are given by the user */
+    auto savable = []( const std::string& mrl ) {
+        return !mrl.empty() && mrl.find_first_of( " \n" ) == std::string::npos;
+    };
+
+    std::string tmpPath = m_listingsPath + ".tmp";
+    FILE *file = vlc_fopen( tmpPath.c_str(), "wt" );
+    if ( file == nullptr )
+    {
+        msg_Warn( m_parent, "can't save the listings to %s: %s",
+                  tmpPath.c_str(), vlc_strerror_c( errno ) );
+        return;
+    }
+
+    fputs( LISTINGS_HEADER "\n", file );
+    {
+        vlc::threads::mutex_locker lock( m_listingsMutex );
+        for ( const auto& l : m_listings )
+        {
+            const SDListing& listing = *l.second.listing;
+            if ( !savable( l.first )
+              || std::any_of( cbegin( listing.files ), cend( listing.files ),
+                    [&savable]( const SDListing::File& f ) {
+                        return !savable( f.name ) || ( !f.linkedWith.empty()
+                            && !savable( f.linkedWith ) );
+                    } )
+              || !std::all_of( cbegin( listing.dirs ), cend( listing.dirs ),
+                               savable ) )
+                continue;
+
+            fprintf( file, "D %lld %lld %s\n",
+                     (long long) listing.lastModificationDate,
+                     (long long) listing.listingDate, l.first.c_str() );
+            for ( const auto& dir : listing.dirs )
+                fprintf( file, "S %s\n", dir.c_str() );
+            for ( const auto& f : listing.files )
+                fprintf( file, "F %" PRId64 " %lld %d %s %s\n", f.size,
+                         (long long) f.lastModificationDate,
+                         static_cast<int>( f.linkedType ), f.name.c_str(),
+                         f.linkedWith.empty() ? "-" : f.linkedWith.c_str() );
+        }
+    }
+
+    bool success = !ferror( file );
+    success = fclose( file ) == 0 && success;
+    if ( !success || vlc_rename( tmpPath.c_str(), m_listingsPath.c_str() ) )
+    {
+        msg_Warn( m_parent, "can't save the listings to %s",
+                  m_listingsPath.c_str() );
+        vlc_unlink( tmpPath.c_str() );
+    }
+}
+
   } /* namespace medialibrary */
 } /* namespace vlc */
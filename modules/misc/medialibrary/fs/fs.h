@@ -21,12 +21,16 @@
 #ifndef SD_FS_H
 #define SD_FS_H
 
+#include <ctime>
 #include <memory>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <vlc_common.h>
 #include <vlc_threads.h>
 #include <vlc_cxx_helpers.hpp>
 #include <medialibrary/filesystem/IFileSystemFactory.h>
+#include <medialibrary/filesystem/IFile.h>
 #include <medialibrary/IDeviceLister.h>
 
 struct libvlc_int_t;
@@ -42,10 +46,36 @@ namespace vlc {
 using namespace ::medialibrary;
 using namespace ::medialibrary::fs;
 
+class SDWatcher;
+
+/**
+ * Listing of a local directory, kept by the factory so that unchanged
+ * directories are not read again (see SDDirectory::read())
+ */
+struct SDListing
+{
+    struct File
+    {
+        std::string name; /* mrl, relative to the directory mrl */
+        std::string linkedWith; /* relative mrl of the main file */
+        IFile::LinkedFileType linkedType;
+        int64_t size;
+        time_t lastModificationDate;
+    };
+
+    std::vector<File> files;
+    std::vector<std::string> dirs; /* relative mrls */
+    /* modification date of the directory, and date of the listing: if the
+     * directory was modified during the same second, it must be read again */
+    time_t lastModificationDate;
+    time_t listingDate;
+};
+
 class SDFileSystemFactory : public IFileSystemFactory, private IDeviceListerCb {
 public:
     SDFileSystemFactory(vlc_object_t *m_parent,
-                        const std::string &scheme);
+                        const std::string &scheme,
+                        std::string listingsPath = {});
 
     bool
     initialize( const IMediaLibrary* ml ) override;
@@ -92,6 +122,40 @@ public:
     bool
     waitForDevice(const std::string& mrl, uint32_t timeout) const override;
 
+    /**
+     * Sets the watcher reporting the changes of the local directories, or
+     * nullptr. The listings of the watched directories are trusted until
+     * they are invalidated.
+     */
+    void
+    setWatcher(SDWatcher *watcher);
+
+    /**
+     * Returns the last listing of a directory, or nullptr.
+     *
+     * If the listing is not trusted, it must be checked against the file
+     * system. The token must be passed to storeListing().
+     */
+    std::shared_ptr<const SDListing>
+    listing(const std::string &mrl, bool *trusted, uint64_t *token);
+
+    void
+    storeListing(const std::string &mrl,
+                 std::shared_ptr<const SDListing> listing, uint64_t token);
+
+    /**
+     * Drops the listing of a changed directory.
+     */
+    void
+    invalidate(const std::string &mrl);
+
+    /**
+     * Stops trusting all the listings, which have to be checked against the
+     * file system when they are needed again.
+     */
+    void
+    invalidateAll();
+
 private:
     std::shared_ptr<fs::IDevice>
     deviceByUuid(const std::string& uuid);
@@ -100,6 +164,9 @@ private:
 
     std::shared_ptr<fs::IDevice> deviceByMrl(const std::string& mrl) const;
 
+    void loadListings();
+    void saveListings();
+
 private:
     vlc_object_t *const m_parent;
     const std::string m_scheme;
@@ -110,6 +177,20 @@ private:
     mutable vlc::threads::condition_variable m_cond;
     std::vector<std::shared_ptr<IDevice>> m_devices;
     std::shared_ptr<IDeviceLister> m_deviceLister;
+
+    struct CachedListing
+    {
+        std::shared_ptr<const SDListing> listing;
+        bool trusted;
+    };
+
+    /* saved across restarts, where they are checked against the file system */
+    const std::string m_listingsPath;
+    vlc::threads::mutex m_listingsMutex;
+    std::unordered_map<std::string, CachedListing> m_listings;
+    SDWatcher *m_watcher = nullptr;
+    /* incremented by each invalidation */
+    uint64_t m_listingsEpoch = 1;
 };
 
   } /* namespace medialibrary */
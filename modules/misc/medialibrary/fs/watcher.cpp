@@ -0,0 +1,441 @@
+/*****************************************************************************
+ * watcher.cpp: Media library file system watcher
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "watcher.h"
+
+#include <vlc_fs.h>
+#include <vlc_url.h>
+
+#include <algorithm>
+#include <cerrno>
+#include <cstring>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#ifdef HAVE_SYS_INOTIFY_H
+# include <dirent.h>
+# include <poll.h>
+# include <sys/inotify.h>
+#endif
+
+/* Changes are reported once no events happened for SETTLE_DELAY, or after
+ * SETTLE_MAX if the directories keep changing (large copies) */
+#define SETTLE_DELAY VLC_TICK_FROM_SEC(1)
+#define SETTLE_MAX   VLC_TICK_FROM_SEC(10)
+
+namespace vlc {
+  namespace medialibrary {
+
+static std::string dirMrl( const std::string& mrl )
+{
+    if ( !mrl.empty() && *mrl.crbegin() != '/' )
+        return mrl + '/';
+    return mrl;
+}
+
+SDWatcher::SDWatcher( vlc_object_t* parent, IWatcherCb& cb )
+    : m_parent( parent )
+    , m_cb( cb )
+{
+}
+
+SDWatcher::~SDWatcher()
+{
+    bool started;
+    {
+        vlc::threads::mutex_locker lock( m_mutex );
+        m_stop = true;
+        started = m_started;
+        wake();
+    }
+    if ( started )
+        vlc_join( m_thread, nullptr );
+    if ( m_wakeFds[0] != -1 )
+    {
+        vlc_close( m_wakeFds[0] );
+        vlc_close( m_wakeFds[1] );
+    }
+    if ( m_fd != -1 )
+        vlc_close( m_fd );
+}
+
+bool SDWatcher::start()
+{
+#ifdef HAVE_SYS_INOTIFY_H
+    m_fd = inotify_init1( IN_NONBLOCK | IN_CLOEXEC );
+    if ( m_fd == -1 )
+    {
+        msg_Warn( m_parent, "can't watch the file system: %s",
+                  vlc_strerror_c( errno ) );
+        return false;
+    }
+    if ( vlc_pipe( m_wakeFds ) )
+    {
+        m_wakeFds[0] = m_wakeFds[1] = -1;
+        return false;
+    }
+
+    vlc::threads::mutex_locker lock( m_mutex );
+    if ( vlc_clone( &m_thread, runThread, this ) )
+        return false;
+    m_started = true;
+    return true;
+#else
+    return false;
+#endif
+}
+
+void SDWatcher::watch( const std::string& mrl )
+{
+    if ( mrl.compare( 0, 7, "file://" ) != 0 )
+        return;
+
+    vlc::threads::mutex_locker lock( m_mutex );
+    m_toWatch.push_back( dirMrl( mrl ) );
+    wake();
+}
+
+void SDWatcher::unwatch( const std::string& mrl )
+{
+    if ( mrl.compare( 0, 7, "file://" ) != 0 )
+        return;
+
+    vlc::threads::mutex_locker lock( m_mutex );
+    m_toUnwatch.push_back( dirMrl( mrl ) );
+    wake();
+}
+
+void SDWatcher::wake()
+{
+    /* the requests are processed when the thread starts otherwise */
+    if ( !m_started )
+        return;
+
+    char c = 0;
+    if ( write( m_wakeFds[1], &c, 1 ) < 0 )
+        msg_Warn( m_parent, "can't wake the file system watcher" );
+}
+
+bool SDWatcher::isWatched( const std::string& mrl ) const
+{
+    vlc::threads::mutex_locker lock( m_mutex );
+    return m_wds.find( dirMrl( mrl ) ) != m_wds.end();
+}
+
+void* SDWatcher::runThread( void* data )
+{
+    vlc_thread_set_name( "vlc-ml-watcher" );
+
+    auto self = static_cast<SDWatcher*>( data );
+    self->run();
+    return nullptr;
+}
+
+#ifdef HAVE_SYS_INOTIFY_H
+
+#define WATCH_MASK (IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO \
+                    | IN_CLOSE_WRITE | IN_ATTRIB | IN_ONLYDIR)
+
+void SDWatcher::run()
+{
+    for ( ;; )
+    {
+        std::vector<std::string> toWatch, toUnwatch;
+        {
+            vlc::threads::mutex_locker lock( m_mutex );
+            if ( m_stop )
+                break;
+            toWatch.swap( m_toWatch );
+            toUnwatch.swap( m_toUnwatch );
+        }
+        /* the listings of the unwatched directories can't be trusted
+         * anymore, even if they are watched again later */
+        for ( const auto& mrl : toUnwatch )
+            for ( const auto& removed : removeTree( mrl ) )
+                m_cb.onDirectoryChanged( removed );
+        for ( const auto& mrl : toWatch )
+        {
+            auto path = vlc::wrap_cptr( vlc_uri2path( mrl.c_str() ) );
+            if ( path != nullptr )
+                addTree( mrl, path.get() );
+        }
+
+        int timeout = -1;
+        if ( !m_changed.empty() )
+        {
+            auto deadline = std::min( m_lastChange + SETTLE_DELAY,
+                                      m_firstChange + SETTLE_MAX );
+            auto now = vlc_tick_now();
+            timeout = deadline > now ? MS_FROM_VLC_TICK( deadline - now ) + 1
+                                     : 0;
+        }
+
+        struct pollfd fds[2] = {
+            { m_fd, POLLIN, 0 },
+            { m_wakeFds[0], POLLIN, 0 },
+        };
+        if ( poll( fds, 2, timeout ) < 0 && errno != EINTR )
+        {
+            msg_Err( m_parent, "can't poll the file system events: %s",
+                     vlc_strerror_c( errno ) );
+            break;
+        }
+
+        if ( fds[1].revents )
+        {
+            /* the requests are processed by the next iteration */
+            char buf[64];
+            if ( read( m_wakeFds[0], buf, sizeof( buf ) ) < 0 )
+                msg_Warn( m_parent, "can't read the wake up pipe" );
+        }
+
+        if ( fds[0].revents )
+            processEvents();
+
+        if ( !m_changed.empty() )
+        {
+            auto now = vlc_tick_now();
+            if ( now >= m_lastChange + SETTLE_DELAY
+              || now >= m_firstChange + SETTLE_MAX )
+                settle();
+        }
+    }
+}
+
+void SDWatcher::addTree( const std::string& rootMrl,
+                         const std::string& rootPath )
+{
+    /* the links to directories are watched last, so that a directory is
+     * watched through its real path if both are in the tree */
+    std::vector<Watch> stack{ Watch{ rootMrl, rootPath } };
+    std::vector<Watch> links;
+
+    while ( !stack.empty() || !links.empty() )
+    {
+        auto& from = stack.empty() ? links : stack;
+        Watch dir = std::move( from.back() );
+        from.pop_back();
+
+        int wd = inotify_add_watch( m_fd, dir.path.c_str(), WATCH_MASK );
+        if ( wd == -1 )
+        {
+            if ( errno == ENOSPC && !m_limitWarned )
+            {
+                msg_Warn( m_parent, "too many directories to watch, the "
+                          "changes will only be found by the next scan "
+                          "(increase fs.inotify.max_user_watches)" );
+                m_limitWarned = true;
+            }
+            continue;
+        }
+
+        {
+            vlc::threads::mutex_locker lock( m_mutex );
+            auto it = m_watches.find( wd );
+            if ( it != m_watches.end() )
+            {
+                /* the same directory is reachable through another path (or a
+                 * link to a parent): only the first one is watched */
+                if ( it->second.mrl != dir.mrl )
+                    continue;
+            }
+            else
+            {
+                m_wds.emplace( dir.mrl, wd );
+                m_watches.emplace( wd, dir );
+            }
+        }
+
+        DIR* handle = vlc_opendir( dir.path.c_str() );
+        if ( handle == nullptr )
+            continue;
+
+        /* only the subdirectories are needed: avoid a stat for each file */
+        struct dirent* ent;
+        while ( ( ent = readdir( handle ) ) != nullptr )
+        {
+            const char* name = ent->d_name;
+            if ( !strcmp( name, "." ) || !strcmp( name, ".." )
+              || ( ent->d_type != DT_DIR && ent->d_type != DT_LNK
+                && ent->d_type != DT_UNKNOWN ) )
+                continue;
+
+            std::string path = dir.path + '/' + name;
+            struct stat st;
+            if ( ent->d_type != DT_DIR
+              && ( vlc_stat( path.c_str(), &st ) || !S_ISDIR( st.st_mode ) ) )
+                continue;
+
+            auto encoded = vlc::wrap_cptr( vlc_uri_encode( name ) );
+            if ( encoded == nullptr )
+                continue;
+            ( ent->d_type == DT_DIR ? stack : links ).push_back(
+                Watch{ dir.mrl + encoded.get() + '/', std::move( path ) } );
+        }
+        vlc_closedir( handle );
+    }
+}
+
+std::vector<std::string> SDWatcher::removeTree( const std::string& mrl )
+{
+    std::vector<std::string> removed;
+    vlc::threads::mutex_locker lock( m_mutex );
+
+    auto it = m_wds.begin();
+    while ( it != m_wds.end() )
+    {
+        if ( it->first.compare( 0, mrl.length(), mrl ) != 0 )
+        {
+            ++it;
+            continue;
+        }
+        inotify_rm_watch( m_fd, it->second );
+        m_watches.erase( it->second );
+        removed.push_back( it->first );
+        it = m_wds.erase( it );
+    }
+    return removed;
+}
+
+void SDWatcher::processEvents()
+{
+    alignas( struct inotify_event ) char buf[4096];
+
+    for ( ;; )
+    {
+        ssize_t len = read( m_fd, buf, sizeof( buf ) );
+        if ( len <= 0 )
+            break;
+
+        for ( char* p = buf; p < buf + len; )
+        {
+            auto ev = reinterpret_cast<const struct inotify_event*>( p );
+            p += sizeof( *ev ) + ev->len;
+
+            if ( ev->mask & IN_Q_OVERFLOW )
+            {
+                msg_Warn( m_parent, "file system events were lost" );
+                m_changed.clear();
+                m_cb.onOverflow();
+                continue;
+            }
+
+            Watch dir;
+            bool ignored = ev->mask & IN_IGNORED;
+            {
+                vlc::threads::mutex_locker lock( m_mutex );
+                auto it = m_watches.find( ev->wd );
+                if ( it == m_watches.end() )
+                    continue;
+                dir = it->second;
+                if ( ignored )
+                {
+                    m_wds.erase( it->second.mrl );
+                    m_watches.erase( it );
+                }
+            }
+            if ( ignored )
+            {
+                /* deleted or unmounted, usually before the event of its
+                 * parent: its listing must not be trusted anymore */
+                m_cb.onDirectoryChanged( dir.mrl );
+                continue;
+            }
+
+            /* the attributes of a subdirectory are not listed */
+            if ( ev->len == 0 || ( ( ev->mask & IN_ISDIR )
+                && !( ev->mask & ( IN_CREATE | IN_DELETE
+                                 | IN_MOVED_FROM | IN_MOVED_TO ) ) ) )
+                continue;
+
+            if ( ev->mask & IN_ISDIR )
+            {
+                auto encoded = vlc::wrap_cptr( vlc_uri_encode( ev->name ) );
+                if ( encoded == nullptr )
+                    continue;
+                std::string mrl = dir.mrl + encoded.get() + '/';
+
+                if ( ev->mask & ( IN_DELETE | IN_MOVED_FROM ) )
+                {
+                    for ( const auto& removed : removeTree( mrl ) )
+                        m_cb.onDirectoryChanged( removed );
+                }
+                else
+                    addTree( mrl, dir.path + '/' + ev->name );
+            }
+            changed( dir.mrl );
+        }
+    }
+}
+
+#else
+
+void SDWatcher::run()
+{
+}
+
+void SDWatcher::addTree( const std::string&, const std::string& )
+{
+}
+
+std::vector<std::string> SDWatcher::removeTree( const std::string& )
+{
+    return {};
+}
+
+void SDWatcher::processEvents()
+{
+}
+
+#endif
+
+void SDWatcher::changed( const std::string& mrl )
+{
+    m_cb.onDirectoryChanged( mrl );
+
+    auto now = vlc_tick_now();
+    if ( m_changed.empty() )
+        m_firstChange = now;
+    m_lastChange = now;
+    m_changed.insert( mrl );
+}
+
+void SDWatcher::settle()
+{
+    /* the subdirectories are right after their parents: only report the
+     * topmost ones, which are scanned recursively */
+    std::vector<std::string> mrls;
+    for ( const auto& mrl : m_changed )
+    {
+        if ( !mrls.empty()
+          && mrl.compare( 0, mrls.back().length(), mrls.back() ) == 0 )
+            continue;
+        mrls.push_back( mrl );
+    }
+    m_changed.clear();
+    m_cb.onChangesSettled( mrls );
+}
+
+  } /* namespace medialibrary */
+} /* namespace vlc */
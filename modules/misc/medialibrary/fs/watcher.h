@@ -0,0 +1,135 @@
+/*****************************************************************************
+ * watcher.h: Media library file system watcher
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify
+ * it under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef SD_WATCHER_H
+#define SD_WATCHER_H
+
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_cxx_helpers.hpp>
+
+namespace vlc {
+  namespace medialibrary {
+
+class IWatcherCb
+{
+public:
+    virtual ~IWatcherCb() = default;
+
+    /**
+     * Called from the watcher thread as soon as an entry of a watched
+     * directory (identified by its mrl, with a trailing '/') is created,
+     * deleted, moved or modified.
+     */
+    virtual void onDirectoryChanged( const std::string& mrl ) = 0;
+
+    /**
+     * Called once no more changes happened for a while, with the topmost
+     * changed directories.
+     */
+    virtual void onChangesSettled( const std::vector<std::string>& mrls ) = 0;
+
+    /**
+     * Called when some events were lost: all the watched directories must be
+     * checked again.
+     */
+    virtual void onOverflow() = 0;
+};
+
+/**
+ * Watches the local directory trees of the entry points (with inotify on
+ * Linux), so that only the changed directories need to be read again.
+ */
+class SDWatcher
+{
+public:
+    SDWatcher( vlc_object_t* parent, IWatcherCb& cb );
+    ~SDWatcher();
+
+    SDWatcher( const SDWatcher& ) = delete;
+    SDWatcher& operator=( const SDWatcher& ) = delete;
+
+    /**
+     * Starts the watcher thread.
+     *
+     * \return false if file system events are not supported
+     */
+    bool start();
+
+    /**
+     * Watches a directory tree, asynchronously (once started).
+     */
+    void watch( const std::string& mrl );
+
+    void unwatch( const std::string& mrl );
+
+    /**
+     * Tells if a directory is watched: if it is, any change of its entries
+     * will be reported from now on.
+     */
+    bool isWatched( const std::string& mrl ) const;
+
+private:
+    struct Watch
+    {
+        std::string mrl;
+        std::string path;
+    };
+
+    static void* runThread( void* data );
+    void run();
+    void addTree( const std::string& mrl, const std::string& path );
+    std::vector<std::string> removeTree( const std::string& mrl );
+    void processEvents();
+    void changed( const std::string& mrl );
+    void settle();
+    void wake();
+
+    vlc_object_t* const m_parent;
+    IWatcherCb& m_cb;
+
+    int m_fd = -1;
+    int m_wakeFds[2] = { -1, -1 };
+    vlc_thread_t m_thread;
+
+    mutable vlc::threads::mutex m_mutex;
+    /* protected by m_mutex */
+    bool m_started = false;
+    std::unordered_map<int, Watch> m_watches;
+    std::unordered_map<std::string, int> m_wds;
+    std::vector<std::string> m_toWatch;
+    std::vector<std::string> m_toUnwatch;
+    bool m_stop = false;
+
+    /* only accessed by the watcher thread */
+    std::set<std::string> m_changed;
+    vlc_tick_t m_firstChange = VLC_TICK_INVALID;
+    vlc_tick_t m_lastChange = VLC_TICK_INVALID;
+    bool m_limitWarned = false;
+};
+
+  } /* namespace medialibrary */
+} /* namespace vlc */
+
+#endif
@@ -41,6 +41,7 @@
 #include <medialibrary/IPlaylist.h>
 #include <medialibrary/IBookmark.h>
 #include <medialibrary/IFolder.h>
+#include <medialibrary/filesystem/Errors.h>
 
 #include <sstream>
 #include <initializer_list>
@@ -304,6 +305,9 @@ void MediaLibrary::onEntryPointAdded( const std::string& entryPoint, bool succes
     ev.entry_point_added.psz_entry_point = entryPoint.c_str();
     ev.entry_point_added.b_success = success;
     m_vlc_ml->cbs->pf_send_event( m_vlc_ml, &ev );
+
+    if ( success && m_watching )
+        m_watcher->watch( entryPoint );
 }
 
 void MediaLibrary::onEntryPointRemoved( const std::string& entryPoint, bool success )
@@ -313,6 +317,9 @@ void MediaLibrary::onEntryPointRemoved( const std::string& entryPoint, bool succ
     ev.entry_point_removed.psz_entry_point = entryPoint.c_str();
     ev.entry_point_removed.b_success = success;
     m_vlc_ml->cbs->pf_send_event( m_vlc_ml, &ev );
+
+    if ( success && m_watching )
+        m_watcher->unwatch( entryPoint );
 }
 
 void MediaLibrary::onEntryPointBanned( const std::string& entryPoint, bool success )
@@ -393,6 +400,24 @@ void MediaLibrary::onRescanStarted()
     m_vlc_ml->cbs->pf_send_event( m_vlc_ml, &ev );
 }
 
+void MediaLibrary::onDirectoryChanged( const std::string& mrl )
+{
+    m_fileFs->invalidate( mrl );
+}
+
+void MediaLibrary::onChangesSettled( const std::vector<std::string>& mrls )
+{
+    for ( const auto& mrl : mrls )
+        m_ml->reload( mrl );
+}
+
+void MediaLibrary::onOverflow()
+{
+    /* some changes were missed: check all the folders again */
+    m_fileFs->invalidateAll();
+    m_ml->reload();
+}
+
 MediaLibrary* MediaLibrary::create( vlc_medialibrary_module_t* vlc_ml )
 {
     char *userdir = config_GetUserDir( VLC_USERDATA_DIR );
@@ -405,9 +430,13 @@ MediaLibrary* MediaLibrary::create( vlc_medialibrary_module_t* vlc_ml )
     medialibrary::SetupConfig cfg;
     cfg.deviceListers = { { "smb://", std::make_shared<vlc::medialibrary::DeviceLister>(
                                            VLC_OBJECT(vlc_ml) ) } };
+    /* the listings of the local folders are kept between runs, so that only
+     * the modified ones are read again at startup */
+    auto fileFs = std::make_shared<vlc::medialibrary::SDFileSystemFactory>(
+                                    VLC_OBJECT( vlc_ml ), "file://",
+                                    mlDir + "listings.dat" );
     cfg.fsFactories = {
-        std::make_shared<vlc::medialibrary::SDFileSystemFactory>(
-                                    VLC_OBJECT( vlc_ml ), "file://"),
+        fileFs,
         std::make_shared<vlc::medialibrary::SDFileSystemFactory>(
                                     VLC_OBJECT( vlc_ml ), "smb://")
     };
@@ -425,14 +454,25 @@ MediaLibrary* MediaLibrary::create( vlc_medialibrary_module_t* vlc_ml )
     if ( !ml )
         return nullptr;
 
-    return new MediaLibrary( vlc_ml, ml );
+    return new MediaLibrary( vlc_ml, ml, std::move( fileFs ) );
 }
 
 MediaLibrary::MediaLibrary( vlc_medialibrary_module_t* vlc_ml,
-                            medialibrary::IMediaLibrary* ml )
+                            medialibrary::IMediaLibrary* ml,
+                            std::shared_ptr<vlc::medialibrary::SDFileSystemFactory> fileFs )
     : m_vlc_ml( vlc_ml )
     , m_ml( ml )
+    , m_fileFs( std::move( fileFs ) )
+    , m_watcher( std::make_unique<vlc::medialibrary::SDWatcher>(
+                     VLC_OBJECT( vlc_ml ), *this ) )
+{
+}
+
+MediaLibrary::~MediaLibrary()
 {
+    /* the listings must not be trusted anymore once the watcher is gone */
+    m_fileFs->setWatcher( nullptr );
+    m_watcher.reset();
 }
 
 bool MediaLibrary::Init()
@@ -492,6 +532,29 @@ bool MediaLibrary::Init()
 
     m_ml->setDiscoverNetworkEnabled( true );
 
+    /* watch the local entry points, so that only the changed folders need to
+     * be reloaded, instead of rescanning them entirely */
+    if ( var_InheritBool( m_vlc_ml, "ml-watch" ) && m_watcher->start() )
+    {
+        m_fileFs->setWatcher( m_watcher.get() );
+        m_watching = true;
+        auto entryPoints = m_ml->entryPoints();
+        if ( entryPoints != nullptr )
+        {
+            for ( const auto& folder : entryPoints->all() )
+            {
+                try
+                {
+                    m_watcher->watch( folder->mrl() );
+                }
+                catch ( const medialibrary::fs::errors::DeviceRemoved& )
+                {
+                    /* not mounted: it will be browsed again once it is */
+                }
+            }
+        }
+    }
+
     m_initialized = true;
     return true;
 }
@@ -2141,6 +2204,10 @@ static void Close( vlc_object_t* obj )
                               "media from" )
 
 #define ML_VERBOSE _( "Extra verbose media library logs" )
+#define ML_WATCH_TEXT N_( "Watch the local folders" )
+#define ML_WATCH_LONGTEXT N_( "Update the media library as soon as the " \
+                             "local folders change, instead of rescanning " \
+                             "them entirely." )
 
 vlc_module_begin()
     set_shortname(N_("media library"))
@@ -2149,4 +2216,5 @@ vlc_module_begin()
     set_capability("medialibrary", 100)
     set_callbacks(Open, Close)
     add_bool( "ml-verbose", false, ML_VERBOSE, nullptr )
+    add_bool( "ml-watch", true, ML_WATCH_TEXT, ML_WATCH_LONGTEXT )
 vlc_module_end()
@@ -35,8 +35,12 @@
 #include <vlc_media_library.h>
 #include <vlc_cxx_helpers.hpp>
 
+#include <atomic>
 #include <cstdarg>
 
+#include "fs/fs.h"
+#include "fs/watcher.h"
+
 struct vlc_event_t;
 struct vlc_object_t;
 struct vlc_thumbnailer_t;
@@ -146,10 +150,12 @@ private:
     std::unique_ptr<vlc_thumbnailer_t, void(*)(vlc_thumbnailer_t*)> m_thumbnailer;
 };
 
-class MediaLibrary : public medialibrary::IMediaLibraryCb
+class MediaLibrary : public medialibrary::IMediaLibraryCb,
+                     private vlc::medialibrary::IWatcherCb
 {
 public:
     static MediaLibrary* create( vlc_medialibrary_module_t* ml );
+    ~MediaLibrary();
 
     bool Init();
     int Control( int query, va_list args );
@@ -186,10 +192,16 @@ private:
     static medialibrary::SortingCriteria sortingCriteria( int sort );
 
 private:
-    MediaLibrary( vlc_medialibrary_module_t* vlc_ml, medialibrary::IMediaLibrary* ml );
+    MediaLibrary( vlc_medialibrary_module_t* vlc_ml, medialibrary::IMediaLibrary* ml,
+                  std::shared_ptr<vlc::medialibrary::SDFileSystemFactory> fileFs );
 
     vlc_medialibrary_module_t* m_vlc_ml;
     std::unique_ptr<medialibrary::IMediaLibrary> m_ml;
+    std::shared_ptr<vlc::medialibrary::SDFileSystemFactory> m_fileFs;
+    /* stopped before the media library, which it reloads */
+    std::unique_ptr<vlc::medialibrary::SDWatcher> m_watcher;
+    /* the watch requests would never be processed if it is not started */
+    std::atomic<bool> m_watching{ false };
 
     vlc::threads::mutex m_mutex;
     bool m_initialized = false; /* protected by m_mutex */
@@ -237,6 +249,12 @@ public:
                                        bool success) override;
     virtual void onHistoryChanged( medialibrary::HistoryType historyType ) override;
     virtual void onRescanStarted() override;
+
+    // IWatcherCb interface
+private:
+    virtual void onDirectoryChanged( const std::string& mrl ) override;
+    virtual void onChangesSettled( const std::vector<std::string>& mrls ) override;
+    virtual void onOverflow() override;
 };
 
 bool Convert( const medialibrary::IMedia* input, vlc_ml_media_t& output );
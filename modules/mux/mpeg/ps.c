@@ -35,6 +35,7 @@
 #include <vlc_plugin.h>
 #include <vlc_sout.h>
 #include <vlc_block.h>
+#include <vlc_crc.h>
 
 #include "bits.h"
 #include "pes.h"
@@ -133,7 +134,6 @@ typedef struct
     int i_pes_max_size;
 
     int i_psm_version;
-    uint32_t crc32_table[256];
 } sout_mux_sys_t;
 
 static const char *const ppsz_sout_options[] = {
@@ -185,21 +185,6 @@ static int Open( vlc_object_t *p_this )
     var_Get( p_mux, SOUT_CFG_PREFIX "pes-max-size", &val );
     p_sys->i_pes_max_size = (int64_t)val.i_int;
 
-    /* Initialise CRC32 table */
-    if( p_sys->b_mpeg2 )
-    {
-        uint32_t i, j, k;
-
-        for( i = 0; i < 256; i++ )
-        {
-            k = 0;
-            for( j = (i << 24) | 0x800000; j != 0x80000000; j <<= 1 )
-                k = (k << 1) ^ (((k ^ j) & 0x80000000) ? 0x04c11db7 : 0);
-
-            p_sys->crc32_table[i] = k;
-        }
-    }
-
     return VLC_SUCCESS;
 }
 
@@ -814,11 +799,8 @@ static void MuxWritePSM( sout_mux_t *p_mux, block_t **p_buf, vlc_tick_t i_dts )
 
     /* CRC32 */
     {
-        uint32_t i_crc = 0xffffffff;
-        for( i = 0; (size_t)i < p_hdr->i_buffer; i++ )
-        i_crc = (i_crc << 8) ^
-            p_sys->crc32_table[((i_crc >> 24) ^ p_hdr->p_buffer[i]) & 0xff];
-
+        uint32_t i_crc = vlc_crc32( 0xffffffff, p_hdr->p_buffer,
+                                    p_hdr->i_buffer );
         bits_write( &bits, 32, i_crc );
     }
 
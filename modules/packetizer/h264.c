@@ -78,7 +78,8 @@ typedef struct
     {
         block_t *p_head;
         block_t **pp_append;
-    } frame, leading;
+    } leading;
+    hxxx_au_t frame;
 
     /* a new sps/pps can be transmitted outside of iframes */
     bool    b_new_sps;
@@ -308,14 +309,21 @@ static bool IsFirstVCLNALUnit( const h264_slice_t *p_prev, const h264_slice_t *p
 
 static void DropStoredNAL( decoder_sys_t *p_sys )
 {
-    block_ChainRelease( p_sys->frame.p_head );
+    hxxx_au_Clean( &p_sys->frame );
     block_ChainRelease( p_sys->leading.p_head );
-    p_sys->frame.p_head = NULL;
-    p_sys->frame.pp_append = &p_sys->frame.p_head;
     p_sys->leading.p_head = NULL;
     p_sys->leading.pp_append = &p_sys->leading.p_head;
 }
 
+/* Slices and suffix NALs are copied into the access unit, their fragment
+ * being reused for the next NALs. If one can't be copied, the whole access
+ * unit is dropped on output. */
+static void AppendToFrame( decoder_sys_t *p_sys, block_t *p_frag )
+{
+    hxxx_au_Append( &p_sys->frame, p_frag );
+    packetizer_RecycleFragment( &p_sys->packetizer, p_frag );
+}
+
 /*****************************************************************************
  * Open: probe the packetizer and return score
  * When opening after demux, the packetizer is only loaded AFTER the decoder
@@ -354,8 +362,7 @@ static int Open( vlc_object_t *p_this )
                      p_dec );
 
     p_sys->b_slice = false;
-    p_sys->frame.p_head = NULL;
-    p_sys->frame.pp_append = &p_sys->frame.p_head;
+    hxxx_au_Init( &p_sys->frame );
     p_sys->leading.p_head = NULL;
     p_sys->leading.pp_append = &p_sys->leading.p_head;
     p_sys->b_new_sps = false;
@@ -690,7 +697,7 @@ static block_t *ParseNALBlock( decoder_t *p_dec, bool *pb_ts_used, block_t *p_fr
             }
             p_sys->b_slice = true;
 
-            block_ChainLastAppend( &p_sys->frame.pp_append, p_frag );
+            AppendToFrame( p_sys, p_frag );
         } break;
 
         /*** Prefix NALs ***/
@@ -755,7 +762,7 @@ static block_t *ParseNALBlock( decoder_t *p_dec, bool *pb_ts_used, block_t *p_fr
         case H264_NAL_END_OF_SEQ:
         case H264_NAL_END_OF_STREAM:
             /* Early end of packetization */
-            block_ChainLastAppend( &p_sys->frame.pp_append, p_frag );
+            AppendToFrame( p_sys, p_frag );
 
             /* important for still pictures/menus */
             p_sys->i_next_block_flags |= BLOCK_FLAG_END_OF_SEQUENCE;
@@ -771,7 +778,7 @@ static block_t *ParseNALBlock( decoder_t *p_dec, bool *pb_ts_used, block_t *p_fr
         case H264_NAL_RESERVED_22:
         case H264_NAL_RESERVED_23:
         default: /* others 24..31, including unknown */
-            block_ChainLastAppend( &p_sys->frame.pp_append, p_frag );
+            AppendToFrame( p_sys, p_frag );
         break;
     }
 
@@ -817,9 +824,9 @@ static block_t *OutputPicture( decoder_t *p_dec )
     block_t *p_pic = NULL;
     block_t **pp_pic_last = &p_pic;
 
-    if( unlikely(!p_sys->frame.p_head) )
+    if( unlikely(hxxx_au_IsEmpty( &p_sys->frame )) )
     {
-        assert( p_sys->frame.p_head );
+        assert( !hxxx_au_IsEmpty( &p_sys->frame ) );
         DropStoredNAL( p_sys );
         ResetOutputVariables( p_sys );
         cc_storage_reset( p_sys->p_ccs );
@@ -911,17 +918,12 @@ static block_t *OutputPicture( decoder_t *p_dec )
     if( p_sys->leading.p_head )
         block_ChainLastAppend( &pp_pic_last, p_sys->leading.p_head );
 
-    assert( p_sys->frame.p_head );
-    if( p_sys->frame.p_head )
-        block_ChainLastAppend( &pp_pic_last, p_sys->frame.p_head );
-
-    /* Reset chains, now empty */
-    p_sys->frame.p_head = NULL;
-    p_sys->frame.pp_append = &p_sys->frame.p_head;
+    /* Reset chain, now empty */
     p_sys->leading.p_head = NULL;
     p_sys->leading.pp_append = &p_sys->leading.p_head;
 
-    p_pic = block_ChainGather( p_pic );
+    /* Prepend them to the slices */
+    p_pic = hxxx_au_Output( &p_sys->frame, p_pic, NULL );
 
     if( !p_pic )
     {
@@ -76,7 +76,8 @@ typedef struct
     {
         block_t *p_chain;
         block_t **pp_chain_last;
-    } frame, pre, post;
+    } pre, post;
+    hxxx_au_t frame;
 
     uint8_t  i_nal_length_size;
 
@@ -135,7 +136,7 @@ static block_t * OutputQueues(decoder_sys_t *p_sys, bool b_valid)
 {
     block_t *p_output = NULL;
     block_t **pp_output_last = &p_output;
-    uint32_t i_flags = 0; /* Because block_ChainGather does not merge flags or times */
+    uint32_t i_flags = 0; /* Because gathering does not merge flags or times */
 
     if(p_sys->pre.p_chain)
     {
@@ -159,22 +160,39 @@ static block_t * OutputQueues(decoder_sys_t *p_sys, bool b_valid)
         INITQ(pre);
     }
 
-    if(p_sys->frame.p_chain)
+    block_t *p_post = p_sys->post.p_chain;
+    if(p_post)
     {
-        i_flags |= p_sys->frame.p_chain->i_flags;
-        block_ChainLastAppend(&pp_output_last, p_sys->frame.p_chain);
-        p_output->i_dts = date_Get(&p_sys->dts);
-        p_output->i_pts = p_sys->pts;
-        INITQ(frame);
+        i_flags |= p_post->i_flags;
+        INITQ(post);
     }
 
-    if(p_sys->post.p_chain)
+    if(!hxxx_au_IsEmpty(&p_sys->frame))
     {
-        i_flags |= p_sys->post.p_chain->i_flags;
-        block_ChainLastAppend(&pp_output_last, p_sys->post.p_chain);
-        INITQ(post);
+        if(p_sys->frame.p_block)
+            i_flags |= p_sys->frame.p_block->i_flags;
+        if(b_valid)
+        {
+            /* Copy the other NALs around the slices */
+            p_output = hxxx_au_Output(&p_sys->frame, p_output, p_post);
+            p_post = NULL;
+        }
+        else /* will be dropped, don't gather */
+        {
+            block_t *p_frame = hxxx_au_Detach(&p_sys->frame);
+            if(p_frame)
+                block_ChainLastAppend(&pp_output_last, p_frame);
+        }
+        if(p_output)
+        {
+            p_output->i_dts = date_Get(&p_sys->dts);
+            p_output->i_pts = p_sys->pts;
+        }
     }
 
+    if(p_post)
+        block_ChainAppend(&p_output, p_post);
+
     if(p_output)
     {
         p_output->i_flags |= i_flags;
@@ -209,7 +227,7 @@ static int Open(vlc_object_t *p_this)
     }
 
     INITQ(pre);
-    INITQ(frame);
+    hxxx_au_Init(&p_sys->frame);
     INITQ(post);
 
     packetizer_Init(&p_sys->packetizer,
@@ -279,7 +297,7 @@ static void Close(vlc_object_t *p_this)
     decoder_sys_t *p_sys = p_dec->p_sys;
     packetizer_Clean(&p_sys->packetizer);
 
-    block_ChainRelease(p_sys->frame.p_chain);
+    hxxx_au_Clean(&p_sys->frame);
     block_ChainRelease(p_sys->pre.p_chain);
     block_ChainRelease(p_sys->post.p_chain);
 
@@ -686,6 +704,15 @@ static void ParseStoredSEI( decoder_t *p_dec )
     }
 }
 
+/* Slices are copied into the access unit, their fragment being reused for
+ * the next NALs. If one can't be copied, the whole access unit is dropped on
+ * output. */
+static void AppendToFrame(decoder_sys_t *p_sys, block_t *p_frag)
+{
+    hxxx_au_Append(&p_sys->frame, p_frag);
+    packetizer_RecycleFragment(&p_sys->packetizer, p_frag);
+}
+
 static block_t *ParseVCL(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_frag)
 {
     decoder_sys_t *p_sys = p_dec->p_sys;
@@ -696,7 +723,7 @@ static block_t *ParseVCL(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_frag)
 
     if(unlikely(!hxxx_strip_AnnexB_startcode(&p_buffer, &i_buffer) || i_buffer < 3))
     {
-        block_ChainLastAppend(&p_sys->frame.pp_chain_last, p_frag); /* might be corrupted */
+        AppendToFrame(p_sys, p_frag); /* might be corrupted */
         return NULL;
     }
 
@@ -704,7 +731,7 @@ static block_t *ParseVCL(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_frag)
     bool b_first_slice_in_pic = p_buffer[2] & 0x80;
     if (b_first_slice_in_pic)
     {
-        if(p_sys->frame.p_chain)
+        if(!hxxx_au_IsEmpty(&p_sys->frame))
         {
             /* Starting new frame: return previous frame data for output */
             p_outputchain = OutputQueues(p_sys, p_sys->sets != MISSING &&
@@ -776,7 +803,7 @@ static block_t *ParseVCL(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_frag)
     if(!p_sys->b_recovery_point) /* content will be dropped */
         cc_storage_reset(p_sys->p_ccs);
 
-    block_ChainLastAppend(&p_sys->frame.pp_chain_last, p_frag);
+    AppendToFrame(p_sys, p_frag);
 
     return p_outputchain;
 }
@@ -786,7 +813,7 @@ static block_t * ParseAUHead(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_na
     decoder_sys_t *p_sys = p_dec->p_sys;
     block_t *p_ret = NULL;
 
-    if(p_sys->post.p_chain || p_sys->frame.p_chain)
+    if(p_sys->post.p_chain || !hxxx_au_IsEmpty(&p_sys->frame))
         p_ret = OutputQueues(p_sys, p_sys->sets != MISSING &&
                                     p_sys->b_recovery_point);
 
@@ -850,7 +877,7 @@ static block_t * ParseAUTail(decoder_t *p_dec, uint8_t i_nal_type, block_t *p_na
             break;
     }
 
-    if(!p_ret && p_sys->frame.p_chain == NULL)
+    if(!p_ret && hxxx_au_IsEmpty(&p_sys->frame))
         p_ret = OutputQueues(p_sys, false);
 
     return p_ret;
@@ -1021,7 +1048,7 @@ static block_t * PacketizeDrain(void *p_private)
 
     block_t *p_out = NULL;
 
-    if( p_sys->frame.p_chain &&
+    if( !hxxx_au_IsEmpty(&p_sys->frame) &&
         p_sys->sets != MISSING &&
         p_sys->b_recovery_point )
     {
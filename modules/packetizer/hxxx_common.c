@@ -105,6 +105,155 @@ block_t * cc_storage_get_current( cc_storage_t *p_ccs, decoder_cc_desc_t *p_desc
     return p_block;
 }
 
+/****************************************************************************
+ * Access unit storage
+ ****************************************************************************/
+#define HXXX_AU_MIN_PREPEND 256
+
+void hxxx_au_Init( hxxx_au_t *p_au )
+{
+    p_au->p_block = NULL;
+    p_au->i_size_hint = 0;
+    p_au->i_prepend_hint = HXXX_AU_MIN_PREPEND;
+    p_au->b_error = false;
+}
+
+void hxxx_au_Clean( hxxx_au_t *p_au )
+{
+    if( p_au->p_block )
+        block_Release( p_au->p_block );
+    p_au->p_block = NULL;
+    p_au->b_error = false;
+}
+
+/* Drops the access unit, as it misses a NAL */
+static int hxxx_au_Error( hxxx_au_t *p_au )
+{
+    if( p_au->p_block )
+        block_Release( p_au->p_block );
+    p_au->p_block = NULL;
+    p_au->b_error = true;
+    return VLC_ENOMEM;
+}
+
+/* Allocates an empty block for i_size bytes of payload, preceded by
+ * i_prepend reserved bytes */
+static block_t * hxxx_au_Alloc( size_t i_prepend, size_t i_size )
+{
+    block_t *p_block = block_Alloc( i_prepend + i_size );
+    if( p_block )
+    {
+        p_block->p_buffer += i_prepend;
+        p_block->i_buffer = 0;
+    }
+    return p_block;
+}
+
+int hxxx_au_Append( hxxx_au_t *p_au, const block_t *p_nal )
+{
+    block_t *p_block = p_au->p_block;
+
+    if( p_au->b_error )
+        return VLC_ENOMEM;
+
+    if( p_block == NULL )
+    {
+        p_block = hxxx_au_Alloc( p_au->i_prepend_hint,
+                                 __MAX(p_au->i_size_hint, p_nal->i_buffer) );
+        if( !p_block )
+            return hxxx_au_Error( p_au );
+        block_CopyProperties( p_block, p_nal );
+        p_au->p_block = p_block;
+    }
+    else
+    {
+        size_t i_prepend = p_block->p_buffer - p_block->p_start;
+        size_t i_avail = p_block->i_size - i_prepend - p_block->i_buffer;
+        if( i_avail < p_nal->i_buffer )
+        {
+            /* grow geometrically, keeping the reserved room */
+            size_t i_size = __MAX(p_block->i_buffer * 2,
+                                  p_block->i_buffer + p_nal->i_buffer);
+            block_t *p_realloc = hxxx_au_Alloc( i_prepend, i_size );
+            if( !p_realloc )
+                return hxxx_au_Error( p_au );
+            memcpy( p_realloc->p_buffer, p_block->p_buffer, p_block->i_buffer );
+            p_realloc->i_buffer = p_block->i_buffer;
+            block_CopyProperties( p_realloc, p_block );
+            block_Release( p_block );
+            p_block = p_au->p_block = p_realloc;
+        }
+        /* as block_ChainGather() */
+        p_block->i_length += p_nal->i_length;
+    }
+
+    memcpy( &p_block->p_buffer[p_block->i_buffer], p_nal->p_buffer, p_nal->i_buffer );
+    p_block->i_buffer += p_nal->i_buffer;
+    return VLC_SUCCESS;
+}
+
+block_t * hxxx_au_Detach( hxxx_au_t *p_au )
+{
+    block_t *p_block = p_au->p_block;
+    if( p_block )
+        p_au->i_size_hint = p_block->i_buffer;
+    p_au->p_block = NULL;
+    p_au->b_error = false;
+    return p_block;
+}
+
+block_t * hxxx_au_Output( hxxx_au_t *p_au, block_t *p_head, block_t *p_tail )
+{
+    bool b_error = p_au->b_error;
+    block_t *p_block = hxxx_au_Detach( p_au );
+    if( b_error )
+    {
+        block_ChainRelease( p_head );
+        block_ChainRelease( p_tail );
+        return NULL;
+    }
+    if( p_block == NULL )
+    {
+        block_ChainAppend( &p_head, p_tail );
+        return p_head ? block_ChainGather( p_head ) : NULL;
+    }
+
+    size_t i_head, i_tail;
+    vlc_tick_t i_head_length, i_tail_length;
+    block_ChainProperties( p_head, NULL, &i_head, &i_head_length );
+    block_ChainProperties( p_tail, NULL, &i_tail, &i_tail_length );
+    p_au->i_prepend_hint = __MAX(i_head, HXXX_AU_MIN_PREPEND);
+
+    /* Uses the reserved room in front, or reallocates once */
+    size_t i_body = p_block->i_buffer;
+    block_t *p_realloc = block_TryRealloc( p_block, i_head, i_body + i_tail );
+    if( !p_realloc )
+    {
+        block_Release( p_block );
+        block_ChainRelease( p_head );
+        block_ChainRelease( p_tail );
+        return NULL;
+    }
+    p_block = p_realloc;
+
+    if( p_head )
+    {
+        block_ChainExtract( p_head, p_block->p_buffer, i_head );
+        p_block->i_flags = p_head->i_flags;
+        p_block->i_pts = p_head->i_pts;
+        p_block->i_dts = p_head->i_dts;
+        block_ChainRelease( p_head );
+    }
+    if( p_tail )
+    {
+        block_ChainExtract( p_tail, &p_block->p_buffer[i_head + i_body], i_tail );
+        block_ChainRelease( p_tail );
+    }
+    p_block->i_length += i_head_length + i_tail_length;
+
+    return p_block;
+}
+
 /****************************************************************************
  * PacketizeXXC1: Takes VCL blocks of data and creates annexe B type NAL stream
  * Will always use 4 byte 0 0 0 1 startcodes
@@ -35,6 +35,42 @@ void cc_storage_commit( cc_storage_t *p_ccs, block_t *p_pic );
 
 block_t * cc_storage_get_current( cc_storage_t *p_ccs, decoder_cc_desc_t * );
 
+/* Access unit storage: the NALs are copied one after the other into a single
+ * block, sized from the previous access unit and with room reserved in front
+ * for the NALs to be prepended on output, so that no gathering is needed. */
+typedef struct
+{
+    block_t *p_block;         /* NALs of the current access unit, or NULL */
+    size_t   i_size_hint;     /* payload size of the previous access unit */
+    size_t   i_prepend_hint;  /* size of the previous prepended NALs */
+    bool     b_error;         /* a NAL was lost, the access unit is dropped */
+} hxxx_au_t;
+
+void hxxx_au_Init( hxxx_au_t * );
+void hxxx_au_Clean( hxxx_au_t * );
+
+/* Whether no NAL was appended since the last output */
+static inline bool hxxx_au_IsEmpty( const hxxx_au_t *p_au )
+{
+    return p_au->p_block == NULL && !p_au->b_error;
+}
+
+/* Copies the NAL at the end of the access unit, the first one also giving
+ * its properties. The NAL block is left to the caller. On error, the whole
+ * access unit is dropped: the next NALs are ignored until it is output. */
+int hxxx_au_Append( hxxx_au_t *, const block_t *p_nal );
+
+/* Returns the current access unit block, without the other NALs, or NULL
+ * if it was dropped */
+block_t * hxxx_au_Detach( hxxx_au_t * );
+
+/* Returns the current access unit as a single block, with the p_head and
+ * p_tail chains copied respectively before and after its NALs and released.
+ * Properties are the ones of the first block and the length the sum of all
+ * of them, as with block_ChainGather(). Returns NULL, releasing the chains,
+ * if the access unit was dropped. */
+block_t * hxxx_au_Output( hxxx_au_t *, block_t *p_head, block_t *p_tail );
+
 /* */
 
 typedef block_t * (*pf_annexb_nal_packetizer)(decoder_t *, bool *, block_t *);
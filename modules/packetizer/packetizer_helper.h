@@ -56,6 +56,8 @@ typedef struct
 
     unsigned i_au_min_size;
 
+    block_t *p_spare; /* fragment given back by the parser, for reuse */
+
     void *p_private;
     packetizer_reset_t    pf_reset;
     packetizer_parse_t    pf_parse;
@@ -82,6 +84,7 @@ static inline void packetizer_Init( packetizer_t *p_pack,
     p_pack->i_au_prepend = i_au_prepend;
     p_pack->p_au_prepend = p_au_prepend;
     p_pack->i_au_min_size = i_au_min_size;
+    p_pack->p_spare = NULL;
 
     p_pack->i_startcode = i_startcode;
     p_pack->p_startcode = p_startcode;
@@ -96,6 +99,40 @@ static inline void packetizer_Init( packetizer_t *p_pack,
 static inline void packetizer_Clean( packetizer_t *p_pack )
 {
     block_BytestreamRelease( &p_pack->bytestream );
+    if( p_pack->p_spare )
+        block_Release( p_pack->p_spare );
+}
+
+/* Gives back a fragment the parser no longer needs, once its data has been
+ * copied, so that its buffer is reused for the next fragments instead of
+ * allocating one per NAL. Only the largest one is kept. */
+static inline void packetizer_RecycleFragment( packetizer_t *p_pack, block_t *p_frag )
+{
+    if( p_pack->p_spare && p_pack->p_spare->i_size >= p_frag->i_size )
+    {
+        block_Release( p_frag );
+        return;
+    }
+    if( p_pack->p_spare )
+        block_Release( p_pack->p_spare );
+    p_pack->p_spare = p_frag;
+}
+
+static inline block_t *packetizer_AllocFragment( packetizer_t *p_pack, size_t i_size )
+{
+    block_t *p_frag = p_pack->p_spare;
+    if( p_frag == NULL || p_frag->i_size < i_size )
+        return block_Alloc( i_size );
+
+    p_pack->p_spare = NULL;
+    p_frag->p_next = NULL;
+    p_frag->p_buffer = p_frag->p_start;
+    p_frag->i_buffer = i_size;
+    p_frag->i_flags = 0;
+    p_frag->i_nb_samples = 0;
+    p_frag->i_pts = p_frag->i_dts = VLC_TICK_INVALID;
+    p_frag->i_length = 0;
+    return p_frag;
 }
 
 static inline void packetizer_Flush( packetizer_t *p_pack )
@@ -180,7 +217,8 @@ static block_t *packetizer_PacketizeBlock( packetizer_t *p_pack, block_t **pp_bl
             /* Get the new fragment and set the pts/dts */
             block_t *p_block_bytestream = p_pack->bytestream.p_block;
 
-            p_pic = block_Alloc( p_pack->i_offset + p_pack->i_au_prepend );
+            p_pic = packetizer_AllocFragment( p_pack,
+                                              p_pack->i_offset + p_pack->i_au_prepend );
             p_pic->i_pts = p_block_bytestream->i_pts;
             p_pic->i_dts = p_block_bytestream->i_dts;
 
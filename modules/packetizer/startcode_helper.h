@@ -34,6 +34,15 @@
 #  endif
 #endif
 
+#ifdef HAVE_AVX2_INTRINSICS
+#  include <immintrin.h>
+#endif
+
+#if defined(__ARM_NEON) && (defined(__aarch64__) || defined(__arm__))
+#  include <arm_neon.h>
+#  define HAVE_STARTCODE_NEON
+#endif
+
 /* Looks up efficiently for an AnnexB startcode 0x00 0x00 0x01
  * by using a 4 times faster trick than single byte lookup. */
 
@@ -65,7 +74,7 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
             return p;
     }
 
-    if( p == end )
+    if( p > end )
         return NULL;
 
     alignedend = end - ((intptr_t) end & 15);
@@ -119,6 +128,97 @@ static inline const uint8_t * startcode_FindAnnexB_SSE2( const uint8_t *p, const
 
 #endif
 
+#ifdef HAVE_AVX2_INTRINSICS
+
+/* Compares 32 start positions at once: a startcode begins wherever the byte
+ * and the next one are 0 and the one after is 1. The loads of p + 1 and p + 2
+ * are unaligned but stay within the cache lines already being read. */
+__attribute__ ((__target__ ("avx2")))
+static inline const uint8_t * startcode_FindAnnexB_AVX2( const uint8_t *p, const uint8_t *end )
+{
+    const uint8_t *alignedend = p + 32 - ((intptr_t)p & 31);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    if( p > end )
+        return NULL;
+
+    alignedend = end - ((intptr_t) end & 31);
+    if( alignedend > p )
+    {
+        const __m256i zeros = _mm256_setzero_si256();
+        const __m256i ones = _mm256_set1_epi8(1);
+
+        for( ; p < alignedend; p += 32)
+        {
+            __m256i v0 = _mm256_load_si256((const __m256i *) p);
+            __m256i v1 = _mm256_loadu_si256((const __m256i *) (p + 1));
+            __m256i v2 = _mm256_loadu_si256((const __m256i *) (p + 2));
+            __m256i match = _mm256_and_si256(
+                                _mm256_and_si256(_mm256_cmpeq_epi8(v0, zeros),
+                                                 _mm256_cmpeq_epi8(v1, zeros)),
+                                _mm256_cmpeq_epi8(v2, ones));
+            uint32_t mask = _mm256_movemask_epi8(match);
+            if( mask )
+                return p + ctz(mask);
+        }
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
+#ifdef HAVE_STARTCODE_NEON
+
+/* Same lookup as the AVX2 one, 16 positions at a time */
+static inline const uint8_t * startcode_FindAnnexB_NEON( const uint8_t *p, const uint8_t *end )
+{
+    const uint8_t *alignedend = p + 16 - ((intptr_t)p & 15);
+    for (end -= 3; p < alignedend && p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    if( p > end )
+        return NULL;
+
+    alignedend = end - ((intptr_t) end & 15);
+    if( alignedend > p )
+    {
+        const uint8x16_t zeros = vdupq_n_u8(0);
+        const uint8x16_t ones = vdupq_n_u8(1);
+
+        for( ; p < alignedend; p += 16)
+        {
+            uint8x16_t match = vandq_u8(vandq_u8(vceqq_u8(vld1q_u8(p), zeros),
+                                                 vceqq_u8(vld1q_u8(p + 1), zeros)),
+                                        vceqq_u8(vld1q_u8(p + 2), ones));
+            /* narrow to 4 bits per position */
+            uint64_t mask = vget_lane_u64(vreinterpret_u64_u8(
+                                vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+            if( mask )
+                return p + ctz(mask) / 4;
+        }
+    }
+
+    for (; p <= end; p++) {
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1)
+            return p;
+    }
+
+    return NULL;
+}
+
+#endif
+
 /* That code is adapted from libav's ff_avc_find_startcode_internal
  * and i believe the trick originated from
  * https://graphics.stanford.edu/~seander/bithacks.html#ZeroInWord
@@ -150,16 +250,21 @@ static inline const uint8_t * startcode_FindAnnexB_Bits( const uint8_t *p, const
 }
 #undef TRY_MATCH
 
-#ifdef CAN_COMPILE_SSE2
 static inline const uint8_t * startcode_FindAnnexB( const uint8_t *p, const uint8_t *end )
 {
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        return startcode_FindAnnexB_AVX2(p, end);
+#endif
+#ifdef CAN_COMPILE_SSE2
     if (vlc_CPU_SSE2())
         return startcode_FindAnnexB_SSE2(p, end);
-    else
-        return startcode_FindAnnexB_Bits(p, end);
-}
+#endif
+#ifdef HAVE_STARTCODE_NEON
+    return startcode_FindAnnexB_NEON(p, end);
 #else
-    #define startcode_FindAnnexB startcode_FindAnnexB_Bits
+    return startcode_FindAnnexB_Bits(p, end);
 #endif
+}
 
 #endif
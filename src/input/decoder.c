@@ -123,6 +123,9 @@ struct vlc_input_decoder_t
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_userdata;
 
+    unsigned         target_width;
+    unsigned         target_height;
+
     ssize_t          i_spu_channel;
     int64_t          i_spu_order;
 
@@ -206,6 +209,9 @@ struct vlc_input_decoder_t
     bool b_first;
     bool b_has_data;
 
+    /* Thumbnailing: a thumbnail was sent since the last flush */
+    bool thumbnail_sent;
+
     /* Flushing */
     bool flushing;
     bool b_draining;
@@ -373,6 +379,10 @@ static int LoadDecoder( decoder_t *p_dec, bool b_packetizer, es_format_t *fmt_in
     /* Find a suitable decoder/packetizer module */
     if( !b_packetizer )
     {
+        vlc_input_decoder_t *p_owner = dec_get_owner( p_dec );
+        p_dec->i_target_width = p_owner->target_width;
+        p_dec->i_target_height = p_owner->target_height;
+
         static const char caps[ES_CATEGORY_COUNT][16] = {
             [VIDEO_ES] = "video decoder",
             [AUDIO_ES] = "audio decoder",
@@ -1346,7 +1356,7 @@ static picture_t *thumbnailer_buffer_new( decoder_t *p_dec )
     /* Avoid decoding more than one frame when a thumbnail was
      * already generated */
     vlc_fifo_Lock(p_owner->p_fifo);
-    if( !p_owner->b_first )
+    if( p_owner->thumbnail_sent )
     {
         vlc_fifo_Unlock(p_owner->p_fifo);
         return NULL;
@@ -1361,8 +1371,8 @@ static void ModuleThread_QueueThumbnail( decoder_t *p_dec, picture_t *p_pic )
     bool b_first;
 
     vlc_fifo_Lock(p_owner->p_fifo);
-    b_first = p_owner->b_first;
-    p_owner->b_first = false;
+    b_first = !p_owner->thumbnail_sent;
+    p_owner->thumbnail_sent = true;
     vlc_fifo_Unlock(p_owner->p_fifo);
 
     if( b_first )
@@ -1676,6 +1686,12 @@ static void DecoderThread_Flush( vlc_input_decoder_t *p_owner )
     if ( p_dec->pf_flush != NULL )
         p_dec->pf_flush( p_dec );
 
+    /* Send a new thumbnail after each seek, but only once the pictures
+     * decoded before it are flushed */
+    vlc_fifo_Lock( p_owner->p_fifo );
+    p_owner->thumbnail_sent = false;
+    vlc_fifo_Unlock( p_owner->p_fifo );
+
     /* flush CC sub decoders */
     vlc_mutex_lock(&p_owner->cc.lock);
     if( p_owner->cc.b_supported )
@@ -1873,6 +1889,8 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     p_owner->p_resource = cfg->resource;
     p_owner->cbs = cfg->cbs;
     p_owner->cbs_userdata = cfg->cbs_data;
+    p_owner->target_width = cfg->target_width;
+    p_owner->target_height = cfg->target_height;
     p_owner->p_aout = NULL;
     p_owner->p_astream = NULL;
     p_owner->p_vout = NULL;
@@ -1895,6 +1913,7 @@ CreateDecoder( vlc_object_t *p_parent, const struct vlc_input_decoder_cfg *cfg )
     p_owner->b_waiting = false;
     p_owner->b_first = true;
     p_owner->b_has_data = false;
+    p_owner->thumbnail_sent = false;
 
     p_owner->error = false;
 
@@ -60,6 +60,9 @@ struct vlc_input_decoder_cfg
     enum input_type input_type;
     const struct vlc_input_decoder_callbacks *cbs;
     void *cbs_data;
+    /* Size the pictures will be downscaled to, or 0 */
+    unsigned target_width;
+    unsigned target_height;
 };
 
 vlc_input_decoder_t *
@@ -2296,6 +2296,8 @@ static void EsOutCreateDecoder( es_out_t *out, es_out_id_t *p_es )
         .input_type = p_sys->input_type,
         .cbs = &decoder_cbs,
         .cbs_data = p_es,
+        .target_width = priv->thumbnail_width,
+        .target_height = priv->thumbnail_height,
     };
     dec = vlc_input_decoder_New( VLC_OBJECT(p_input), &cfg );
     if( dec != NULL )
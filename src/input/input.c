@@ -190,6 +190,16 @@ void input_SetPosition( input_thread_t *p_input, double f_position, bool b_fast
     input_ControlPush( p_input, INPUT_CONTROL_SET_POSITION, &param );
 }
 
+void input_SetThumbnailSize( input_thread_t *p_input, unsigned width,
+                             unsigned height )
+{
+    input_thread_private_t *priv = input_priv(p_input);
+
+    assert( !priv->is_running );
+    priv->thumbnail_width = width;
+    priv->thumbnail_height = height;
+}
+
 /**
  * Get the item from an input thread
  * FIXME it does not increase ref count of the item.
@@ -272,6 +282,7 @@ input_thread_t *input_Create( vlc_object_t *p_parent,
     TAB_INIT( priv->i_attachment, priv->attachment );
     priv->p_sout   = NULL;
     priv->b_out_pace_control = priv->type == INPUT_TYPE_THUMBNAILING;
+    priv->thumbnail_width = priv->thumbnail_height = 0;
     priv->p_renderer = p_renderer && priv->type != INPUT_TYPE_PREPARSING ?
                 vlc_renderer_item_hold( p_renderer ) : NULL;
 
@@ -627,6 +638,17 @@ static void MainLoop( input_thread_t *p_input, bool b_interactive )
     const bool b_can_demux = p_demux->pf_demux != NULL
                           || p_demux->pf_readdir != NULL;
 
+    /* The thumbnailer seeks before starting: apply it before demuxing, or
+     * the first picture of the stream could be sent instead */
+    if( input_priv(p_input)->type == INPUT_TYPE_THUMBNAILING )
+    {
+        int i_type;
+        input_control_param_t param;
+
+        while( !ControlPop( p_input, &i_type, &param, 0, false ) )
+            Control( p_input, i_type, param );
+    }
+
     while( !input_Stopped( p_input ) && input_priv(p_input)->i_state != ERROR_S )
     {
         vlc_tick_t i_wakeup = -1;
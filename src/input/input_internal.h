@@ -333,6 +333,12 @@ void input_SetTime( input_thread_t *, vlc_tick_t i_time, bool b_fast );
 
 void input_SetPosition( input_thread_t *, double f_position, bool b_fast );
 
+/**
+ * Set the size the video pictures will be downscaled to, so that decoders
+ * can output smaller pictures. It must be called before input_Start().
+ */
+void input_SetThumbnailSize( input_thread_t *, unsigned width, unsigned height );
+
 /**
  * Set the delay of an ES identifier
  */
@@ -483,6 +489,8 @@ typedef struct input_thread_private_t
     vlc_viewpoint_t viewpoint;
     bool            viewpoint_changed;
     vlc_renderer_item_t *p_renderer;
+    unsigned        thumbnail_width;    /* 0 if unknown */
+    unsigned        thumbnail_height;
 
 
     int i_title_offset;
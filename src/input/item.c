@@ -1243,6 +1243,7 @@ input_item_node_t *input_item_node_Create( input_item_t *p_input )
 
     p_node->i_children = 0;
     p_node->pp_children = NULL;
+    p_node->b_append = false;
 
     return p_node;
 }
@@ -1636,69 +1637,82 @@ static int rdh_should_match_idx(struct vlc_readdir_helper *p_rdh,
     return false;
 }
 
-static void rdh_attach_slaves(struct vlc_readdir_helper *p_rdh,
-                              input_item_node_t *p_parent_node)
+static bool rdh_may_have_slaves(input_item_t *p_item)
 {
-    if (p_rdh->i_sub_autodetect_fuzzy == 0)
-        return;
+    enum slave_type unused;
+    /* don't match 2 possible slaves between each others */
+    return input_item_IsMaster(p_item->psz_name)
+        && !input_item_slave_GetType(p_item->psz_name, &unused);
+}
 
-    /* Try to match slaves for each items of the node */
-    for (int i = 0; i < p_parent_node->i_children; i++)
+/* p_node is the node of the item, or NULL if it was already posted */
+static void rdh_attach_item_slaves(struct vlc_readdir_helper *p_rdh,
+                                   input_item_node_t *p_parent_node,
+                                   input_item_node_t *p_node,
+                                   input_item_t *p_item)
+{
+    for (size_t j = 0; j < p_rdh->i_slaves; j++)
     {
-        input_item_node_t *p_node = p_parent_node->pp_children[i];
-        input_item_t *p_item = p_node->p_item;
+        struct rdh_slave *p_rdh_slave = p_rdh->pp_slaves[j];
 
-        enum slave_type unused;
-        if (!input_item_IsMaster(p_item->psz_name)
-         || input_item_slave_GetType(p_item->psz_name, &unused))
-            continue; /* don't match 2 possible slaves between each others */
+        /* Don't try to match slaves with themselves or slaves already
+         * attached with the higher priority */
+        if ((p_node != NULL && p_rdh_slave->p_node == p_node)
+         || p_rdh_slave->p_slave->i_priority == SLAVE_PRIORITY_MATCH_ALL)
+            continue;
 
-        for (size_t j = 0; j < p_rdh->i_slaves; j++)
-        {
-            struct rdh_slave *p_rdh_slave = p_rdh->pp_slaves[j];
+        uint8_t i_priority =
+            rdh_get_slave_priority(p_item, p_rdh_slave->p_slave,
+                                     p_rdh_slave->psz_filename);
 
-            /* Don't try to match slaves with themselves or slaves already
-             * attached with the higher priority */
-            if (p_rdh_slave->p_node == p_node
-             || p_rdh_slave->p_slave->i_priority == SLAVE_PRIORITY_MATCH_ALL)
-                continue;
+        if (i_priority < p_rdh->i_sub_autodetect_fuzzy)
+            continue;
 
-            uint8_t i_priority =
-                rdh_get_slave_priority(p_item, p_rdh_slave->p_slave,
-                                         p_rdh_slave->psz_filename);
+        /* Drop the ".sub" slave if a ".idx" slave matches */
+        if (p_rdh_slave->p_slave->i_type == SLAVE_TYPE_SPU
+         && rdh_should_match_idx(p_rdh, p_rdh_slave))
+            continue;
 
-            if (i_priority < p_rdh->i_sub_autodetect_fuzzy)
-                continue;
+        input_item_slave_t *p_slave =
+            input_item_slave_New(p_rdh_slave->p_slave->psz_uri,
+                                 p_rdh_slave->p_slave->i_type,
+                                 i_priority);
+        if (p_slave == NULL)
+            break;
 
-            /* Drop the ".sub" slave if a ".idx" slave matches */
-            if (p_rdh_slave->p_slave->i_type == SLAVE_TYPE_SPU
-             && rdh_should_match_idx(p_rdh, p_rdh_slave))
-                continue;
+        if (input_item_AddSlave(p_item, p_slave) != VLC_SUCCESS)
+        {
+            input_item_slave_Delete(p_slave);
+            break;
+        }
 
-            input_item_slave_t *p_slave =
-                input_item_slave_New(p_rdh_slave->p_slave->psz_uri,
-                                     p_rdh_slave->p_slave->i_type,
-                                     i_priority);
-            if (p_slave == NULL)
-                break;
+        /* Remove the corresponding node if any: This slave won't be
+         * added in the parent node */
+        if (p_rdh_slave->p_node != NULL)
+        {
+            input_item_node_RemoveNode(p_parent_node, p_rdh_slave->p_node);
+            input_item_node_Delete(p_rdh_slave->p_node);
+            p_rdh_slave->p_node = NULL;
+        }
 
-            if (input_item_AddSlave(p_item, p_slave) != VLC_SUCCESS)
-            {
-                input_item_slave_Delete(p_slave);
-                break;
-            }
+        p_rdh_slave->p_slave->i_priority = i_priority;
+    }
+}
 
-            /* Remove the corresponding node if any: This slave won't be
-             * added in the parent node */
-            if (p_rdh_slave->p_node != NULL)
-            {
-                input_item_node_RemoveNode(p_parent_node, p_rdh_slave->p_node);
-                input_item_node_Delete(p_rdh_slave->p_node);
-                p_rdh_slave->p_node = NULL;
-            }
+static void rdh_attach_slaves(struct vlc_readdir_helper *p_rdh,
+                              input_item_node_t *p_parent_node)
+{
+    if (p_rdh->i_sub_autodetect_fuzzy == 0)
+        return;
 
-            p_rdh_slave->p_slave->i_priority = i_priority;
-        }
+    /* Try to match slaves for each items of the node */
+    for (int i = 0; i < p_parent_node->i_children; i++)
+    {
+        input_item_node_t *p_node = p_parent_node->pp_children[i];
+
+        if (rdh_may_have_slaves(p_node->p_item))
+            rdh_attach_item_slaves(p_rdh, p_parent_node, p_node,
+                                   p_node->p_item);
     }
 
     /* Attach all children */
@@ -1706,6 +1720,16 @@ static void rdh_attach_slaves(struct vlc_readdir_helper *p_rdh,
         rdh_attach_slaves(p_rdh, p_parent_node->pp_children[i]);
 }
 
+static bool rdh_is_slave_node(struct vlc_readdir_helper *p_rdh,
+                              input_item_node_t *p_node)
+{
+    enum slave_type unused;
+    /* vlc_readdir_helper_additem() registers all the possible slaves it adds,
+     * don't look for the node in the whole list for each item */
+    return p_rdh->i_sub_autodetect_fuzzy != 0
+        && input_item_slave_GetType(p_node->p_item->psz_name, &unused);
+}
+
 static int rdh_unflatten(struct vlc_readdir_helper *p_rdh,
                          input_item_node_t **pp_node, const char *psz_path,
                          int i_net)
@@ -1796,6 +1820,7 @@ void vlc_readdir_helper_init(struct vlc_readdir_helper *p_rdh,
     p_rdh->b_flatten = var_InheritBool(p_obj, "extractor-flatten");
     TAB_INIT(p_rdh->i_slaves, p_rdh->pp_slaves);
     TAB_INIT(p_rdh->i_dirs, p_rdh->pp_dirs);
+    TAB_INIT(p_rdh->i_posted, p_rdh->pp_posted);
 
     if (p_var_obj != NULL)
         vlc_object_delete(p_var_obj);
@@ -1806,10 +1831,19 @@ void vlc_readdir_helper_finish(struct vlc_readdir_helper *p_rdh, bool b_success)
     if (b_success)
     {
         rdh_sort(p_rdh->p_node);
+
+        /* The items already posted come first */
+        for (size_t i = 0; i < p_rdh->i_posted; i++)
+            rdh_attach_item_slaves(p_rdh, p_rdh->p_node, NULL,
+                                   p_rdh->pp_posted[i]);
         rdh_attach_slaves(p_rdh, p_rdh->p_node);
     }
     free(p_rdh->psz_ignored_exts);
 
+    for (size_t i = 0; i < p_rdh->i_posted; i++)
+        input_item_Release(p_rdh->pp_posted[i]);
+    TAB_CLEAN(p_rdh->i_posted, p_rdh->pp_posted);
+
     /* Remove unmatched slaves */
     for (size_t i = 0; i < p_rdh->i_slaves; i++)
     {
@@ -1828,6 +1862,89 @@ void vlc_readdir_helper_finish(struct vlc_readdir_helper *p_rdh, bool b_success)
     TAB_CLEAN(p_rdh->i_dirs, p_rdh->pp_dirs);
 }
 
+int vlc_readdir_helper_post(struct vlc_readdir_helper *p_rdh, es_out_t *out)
+{
+    input_item_node_t *p_node = p_rdh->p_node;
+
+    /* The subfolders created by rdh_unflatten() may still receive items */
+    if (out == NULL || p_rdh->i_dirs > 0)
+        return VLC_EGENERIC;
+
+    input_item_node_t *p_batch = input_item_node_Create(p_node->p_item);
+    if (unlikely(p_batch == NULL))
+        return VLC_ENOMEM;
+
+    /* Keep the possible slaves until the end, so that they are not listed if
+     * they match an item. Hold the items they may be attached to. */
+    input_item_node_t **pp_kept = NULL;
+    int i_kept = 0;
+    for (int i = 0; i < p_node->i_children; i++)
+        if (rdh_is_slave_node(p_rdh, p_node->pp_children[i]))
+            i_kept++;
+    if (i_kept > 0)
+    {
+        /* they are kept again by every batch, don't grow the array by one */
+        pp_kept = vlc_alloc(i_kept, sizeof(*pp_kept));
+        if (unlikely(pp_kept == NULL))
+        {
+            input_item_node_Delete(p_batch);
+            return VLC_ENOMEM;
+        }
+        i_kept = 0;
+    }
+
+    int i_batch = 0;
+    size_t i_posted = p_rdh->i_posted;
+    for (int i = 0; i < p_node->i_children; i++)
+    {
+        input_item_node_t *p_child = p_node->pp_children[i];
+        if (rdh_is_slave_node(p_rdh, p_child))
+        {
+            pp_kept[i_kept++] = p_child;
+            continue;
+        }
+
+        if (p_rdh->i_sub_autodetect_fuzzy != 0
+         && rdh_may_have_slaves(p_child->p_item))
+            TAB_APPEND(p_rdh->i_posted, p_rdh->pp_posted,
+                       input_item_Hold(p_child->p_item));
+        p_node->pp_children[i_batch++] = p_child;
+    }
+
+    p_batch->pp_children = p_node->pp_children;
+    p_batch->i_children = i_batch;
+    p_batch->b_append = p_node->b_append;
+    p_node->pp_children = pp_kept;
+    p_node->i_children = i_kept;
+
+    if (i_batch == 0)
+    {
+        input_item_node_Delete(p_batch);
+        return VLC_SUCCESS;
+    }
+
+    rdh_sort(p_batch);
+
+    /* The batch is released by the es_out on success */
+    if (es_out_Control(out, ES_OUT_POST_SUBNODE, p_batch))
+    {
+        /* Keep them for the next batch */
+        for (int i = 0; i < p_batch->i_children; i++)
+            input_item_node_AppendNode(p_node, p_batch->pp_children[i]);
+        p_batch->i_children = 0;
+        input_item_node_Delete(p_batch);
+
+        for (size_t i = i_posted; i < p_rdh->i_posted; i++)
+            input_item_Release(p_rdh->pp_posted[i]);
+        p_rdh->i_posted = i_posted;
+        return VLC_EGENERIC;
+    }
+
+    /* The next items follow the ones already posted */
+    p_node->b_append = true;
+    return VLC_SUCCESS;
+}
+
 int vlc_readdir_helper_additem(struct vlc_readdir_helper *p_rdh,
                                const char *psz_uri, const char *psz_flatpath,
                                const char *psz_filename, int i_type, int i_net,
@@ -26,6 +26,9 @@
 
 #include <vlc_thumbnailer.h>
 #include <vlc_executor.h>
+#include <vlc_image.h>
+#include <vlc_memstream.h>
+#include <vlc_vector.h>
 #include "input_internal.h"
 
 struct vlc_thumbnailer_t
@@ -60,6 +63,9 @@ struct vlc_thumbnailer_request_t
     struct seek_target seek_target;
     bool fast_seek;
     input_item_t *item;
+    /* Size the thumbnail will be downscaled to, 0 if unknown */
+    unsigned width;
+    unsigned height;
     /**
      * A positive value will be used as the timeout duration
      * VLC_TICK_INVALID means no timeout
@@ -68,6 +74,11 @@ struct vlc_thumbnailer_request_t
     vlc_thumbnailer_cb cb;
     void* userdata;
 
+    /* Batch requests only, with their own copy of the times and URL */
+    const struct vlc_thumbnailer_batch_cbs *batch_cbs;
+    struct vlc_thumbnailer_batch batch;
+    vlc_tick_t length; /**< length of the media, protected by lock */
+
     vlc_mutex_t lock;
     vlc_cond_t cond_ended;
     enum
@@ -86,6 +97,7 @@ static void RunnableRun(void *);
 static task_t *
 TaskNew(vlc_thumbnailer_t *thumbnailer, input_item_t *item,
         struct seek_target seek_target, bool fast_seek,
+        unsigned width, unsigned height,
         vlc_thumbnailer_cb cb, void *userdata, vlc_tick_t timeout)
 {
     task_t *task = malloc(sizeof(*task));
@@ -97,9 +109,13 @@ TaskNew(vlc_thumbnailer_t *thumbnailer, input_item_t *item,
     task->item = item;
     task->seek_target = seek_target;
     task->fast_seek = fast_seek;
+    task->width = width;
+    task->height = height;
     task->cb = cb;
     task->userdata = userdata;
     task->timeout = timeout;
+    task->batch_cbs = NULL;
+    task->length = VLC_TICK_INVALID;
 
     vlc_mutex_init(&task->lock);
     vlc_cond_init(&task->cond_ended);
@@ -120,6 +136,11 @@ TaskRelease(task_t *task)
     if (!vlc_atomic_rc_dec(&task->rc))
         return;
     input_item_Release(task->item);
+    if (task->batch_cbs != NULL)
+    {
+        free((vlc_tick_t *)task->batch.times);
+        free((char *)task->batch.sprite_url);
+    }
     free(task);
 }
 
@@ -134,13 +155,21 @@ on_thumbnailer_input_event( input_thread_t *input,
                             const struct vlc_input_event *event, void *userdata )
 {
     VLC_UNUSED(input);
+    task_t *task = userdata;
+
+    if ( event->type == INPUT_EVENT_TIMES && task->batch_cbs != NULL )
+    {
+        vlc_mutex_lock(&task->lock);
+        task->length = event->times.length;
+        vlc_mutex_unlock(&task->lock);
+        return;
+    }
+
     if ( event->type != INPUT_EVENT_THUMBNAIL_READY &&
          ( event->type != INPUT_EVENT_STATE || ( event->state.value != ERROR_S &&
                                                  event->state.value != END_S ) ) )
          return;
 
-    task_t *task = userdata;
-
     vlc_mutex_lock(&task->lock);
     if (task->status != RUNNING)
     {
@@ -151,46 +180,76 @@ on_thumbnailer_input_event( input_thread_t *input,
         return;
     }
 
-    task->status = ENDED;
-
     if (event->type == INPUT_EVENT_THUMBNAIL_READY)
+    {
+        /* Batches go on after each thumbnail, one per seek */
+        if (task->batch_cbs != NULL)
+        {
+            if (task->pic == NULL)
+                task->pic = picture_Hold(event->thumbnail);
+            vlc_cond_signal(&task->cond_ended);
+            vlc_mutex_unlock(&task->lock);
+            return;
+        }
         task->pic = picture_Hold(event->thumbnail);
+    }
+
+    task->status = ENDED;
 
     vlc_cond_signal(&task->cond_ended);
     vlc_mutex_unlock(&task->lock);
 }
 
-static void
-RunnableRun(void *userdata)
+static input_thread_t *
+TaskStartInput(task_t *task, struct seek_target seek_target, bool fast_seek)
 {
-    vlc_thread_set_name("vlc-run-thumb");
-
-    task_t *task = userdata;
-    vlc_thumbnailer_t *thumbnailer = task->thumbnailer;
-
-    vlc_tick_t now = vlc_tick_now();
-
     input_thread_t* input =
-            input_Create( thumbnailer->parent, on_thumbnailer_input_event, task,
-                          task->item, INPUT_TYPE_THUMBNAILING, NULL, NULL );
+            input_Create( task->thumbnailer->parent, on_thumbnailer_input_event,
+                          task, task->item, INPUT_TYPE_THUMBNAILING, NULL, NULL );
     if (!input)
-        goto error;
+        return NULL;
 
-    if (task->seek_target.type == VLC_THUMBNAILER_SEEK_TIME)
-        input_SetTime(input, task->seek_target.time, task->fast_seek);
+    input_SetThumbnailSize(input, task->width, task->height);
+
+    if (seek_target.type == VLC_THUMBNAILER_SEEK_TIME)
+        input_SetTime(input, seek_target.time, fast_seek);
     else
     {
-        assert(task->seek_target.type == VLC_THUMBNAILER_SEEK_POS);
-        input_SetPosition(input, task->seek_target.pos, task->fast_seek);
+        assert(seek_target.type == VLC_THUMBNAILER_SEEK_POS);
+        input_SetPosition(input, seek_target.pos, fast_seek);
     }
 
-    int ret = input_Start(input);
-    if (ret != VLC_SUCCESS)
+    if (input_Start(input) != VLC_SUCCESS)
     {
         input_Close(input);
-        goto error;
+        return NULL;
+    }
+    return input;
+}
+
+static void RunBatch(task_t *);
+
+static void
+RunnableRun(void *userdata)
+{
+    vlc_thread_set_name("vlc-run-thumb");
+
+    task_t *task = userdata;
+
+    if (task->batch_cbs != NULL)
+    {
+        RunBatch(task);
+        TaskRelease(task);
+        return;
     }
 
+    vlc_tick_t now = vlc_tick_now();
+
+    input_thread_t* input = TaskStartInput(task, task->seek_target,
+                                           task->fast_seek);
+    if (!input)
+        goto error;
+
     vlc_mutex_lock(&task->lock);
     if (task->timeout == VLC_TICK_INVALID)
     {
@@ -224,6 +283,307 @@ error:
     TaskRelease(task);
 }
 
+static bool
+BatchGetTime(task_t *task, size_t index, vlc_tick_t *time)
+{
+    const struct vlc_thumbnailer_batch *batch = &task->batch;
+
+    if (batch->count != 0 && index >= batch->count)
+        return false;
+    if (batch->times != NULL)
+    {
+        *time = batch->times[index];
+        return true;
+    }
+
+    *time = index * batch->interval;
+
+    vlc_mutex_lock(&task->lock);
+    vlc_tick_t length = task->length;
+    vlc_mutex_unlock(&task->lock);
+
+    return length == VLC_TICK_INVALID || *time < length;
+}
+
+/* Crop the format to the aspect ratio of the tiles, like picture_Export() */
+static void
+BatchCropTile(video_format_t *fmt, unsigned width, unsigned height)
+{
+    unsigned visible_width = fmt->i_visible_width;
+    unsigned visible_height = fmt->i_visible_height;
+
+    if (visible_width == 0 || visible_height == 0)
+        return;
+
+    if ((uint64_t)visible_width * height > (uint64_t)visible_height * width)
+    {
+        unsigned crop_width = (uint64_t)visible_height * width / height;
+        fmt->i_x_offset += (visible_width - crop_width) / 2;
+        fmt->i_visible_width = crop_width;
+    }
+    else
+    {
+        unsigned crop_height = (uint64_t)visible_width * height / width;
+        fmt->i_y_offset += (visible_height - crop_height) / 2;
+        fmt->i_visible_height = crop_height;
+    }
+}
+
+/* Scale a thumbnail down to its tile as soon as it is decoded, so that a
+ * batch never keeps more than one full size picture */
+static picture_t *
+BatchConvertTile(task_t *task, image_handler_t *image, picture_t *pic)
+{
+    const struct vlc_thumbnailer_batch *batch = &task->batch;
+
+    video_format_t fmt_in = pic->format;
+    BatchCropTile(&fmt_in, batch->width, batch->height);
+
+    video_format_t fmt_out;
+    video_format_Init(&fmt_out, VLC_CODEC_RGBA);
+    fmt_out.i_width = fmt_out.i_visible_width = batch->width;
+    fmt_out.i_height = fmt_out.i_visible_height = batch->height;
+    fmt_out.i_sar_num = fmt_out.i_sar_den = 1;
+
+    picture_t *tile = image_Convert(image, pic, &fmt_in, &fmt_out);
+    video_format_Clean(&fmt_out);
+    return tile;
+}
+
+/* The tiles that could not be converted are NULL, and left blank */
+static picture_t *
+BatchComposeSprite(task_t *task, picture_t *const *tiles, size_t count)
+{
+    const struct vlc_thumbnailer_batch *batch = &task->batch;
+    const unsigned tile_width = batch->width;
+    const unsigned tile_height = batch->height;
+    const unsigned columns = __MIN(batch->sprite_columns, count);
+    const unsigned rows = (count + columns - 1) / columns;
+
+    picture_t *sprite = picture_New(VLC_CODEC_RGBA, columns * tile_width,
+                                    rows * tile_height, 1, 1);
+    if (sprite == NULL)
+        return NULL;
+
+    plane_t *dst = &sprite->p[0];
+    memset(dst->p_pixels, 0, dst->i_pitch * dst->i_lines);
+
+    for (size_t i = 0; i < count; i++)
+    {
+        if (tiles[i] == NULL)
+            continue;
+
+        const plane_t *src = &tiles[i]->p[0];
+        uint8_t *p = &dst->p_pixels[(i / columns) * tile_height * dst->i_pitch
+                                    + (i % columns) * tile_width * 4];
+        unsigned lines = __MIN(tile_height, (unsigned)src->i_visible_lines);
+        size_t size = __MIN(tile_width * 4, (unsigned)src->i_visible_pitch);
+        for (unsigned y = 0; y < lines; y++)
+            memcpy(&p[y * dst->i_pitch], &src->p_pixels[y * src->i_pitch],
+                   size);
+    }
+
+    return sprite;
+}
+
+static void
+BatchPrintTime(struct vlc_memstream *ms, vlc_tick_t time)
+{
+    lldiv_t ms_d = lldiv(MS_FROM_VLC_TICK(__MAX(time, 0)), 1000);
+    lldiv_t s_d = lldiv(ms_d.quot, 60);
+    lldiv_t m_d = lldiv(s_d.quot, 60);
+
+    vlc_memstream_printf(ms, "%02lld:%02lld:%02lld.%03lld", m_d.quot, m_d.rem,
+                         s_d.rem, ms_d.rem);
+}
+
+/* WebVTT index of the sprite sheet: each cue spans from the time of its
+ * thumbnail to the time of the next one, or to the end of the media */
+static char *
+BatchSpriteIndex(task_t *task, size_t count)
+{
+    const struct vlc_thumbnailer_batch *batch = &task->batch;
+    const unsigned columns = __MIN(batch->sprite_columns, count);
+    struct vlc_memstream ms;
+
+    if (vlc_memstream_open(&ms) != 0)
+        return NULL;
+
+    vlc_mutex_lock(&task->lock);
+    vlc_tick_t length = task->length;
+    vlc_mutex_unlock(&task->lock);
+
+    vlc_memstream_puts(&ms, "WEBVTT\n");
+
+    vlc_tick_t start;
+    BatchGetTime(task, 0, &start);
+    for (size_t i = 0; i < count; i++)
+    {
+        vlc_tick_t end;
+        if (i + 1 < count)
+            BatchGetTime(task, i + 1, &end);
+        else if (length > start)
+            end = length;
+        else
+            end = start + (batch->interval > 0 ? batch->interval
+                                               : VLC_TICK_FROM_SEC(10));
+
+        vlc_memstream_putc(&ms, '\n');
+        BatchPrintTime(&ms, start);
+        vlc_memstream_puts(&ms, " --> ");
+        BatchPrintTime(&ms, end);
+        vlc_memstream_printf(&ms, "\n%s#xywh=%u,%u,%u,%u\n",
+                             batch->sprite_url ? batch->sprite_url : "",
+                             (unsigned)(i % columns) * batch->width,
+                             (unsigned)(i / columns) * batch->height,
+                             batch->width, batch->height);
+        start = end;
+    }
+
+    if (vlc_memstream_close(&ms) != 0)
+        return NULL;
+    return ms.ptr;
+}
+
+static void
+RunBatch(task_t *task)
+{
+    const struct vlc_thumbnailer_batch *batch = &task->batch;
+    struct VLC_VECTOR(picture_t *) tiles = VLC_VECTOR_INITIALIZER;
+    bool sprite = batch->sprite_columns > 0;
+    image_handler_t *image = NULL;
+    input_thread_t *input = NULL;
+    bool progress = false;
+    size_t index = 0;
+    vlc_tick_t time;
+
+    if (sprite)
+    {
+        image = image_HandlerCreate(task->thumbnailer->parent);
+        sprite = image != NULL;
+    }
+
+    while (BatchGetTime(task, index, &time))
+    {
+        if (input == NULL)
+        {
+            vlc_mutex_lock(&task->lock);
+            if (task->status == ENDED)
+                task->status = RUNNING;
+            bool interrupted = task->status == INTERRUPTED;
+            vlc_mutex_unlock(&task->lock);
+            if (interrupted)
+                break;
+
+            struct seek_target seek_target = {
+                .type = VLC_THUMBNAILER_SEEK_TIME,
+                .time = time,
+            };
+            input = TaskStartInput(task, seek_target, true);
+            if (input == NULL)
+                break;
+            progress = false;
+        }
+        else
+            /* The decoder sends a new thumbnail once flushed by the seek */
+            input_SetTime(input, time, true);
+
+        vlc_mutex_lock(&task->lock);
+        vlc_tick_t deadline = vlc_tick_now() + task->timeout;
+        int timeout = 0;
+        while (task->status == RUNNING && task->pic == NULL && timeout == 0)
+        {
+            if (task->timeout == VLC_TICK_INVALID)
+                vlc_cond_wait(&task->cond_ended, &task->lock);
+            else
+                timeout = vlc_cond_timedwait(&task->cond_ended, &task->lock,
+                                             deadline);
+        }
+
+        picture_t *pic = task->pic;
+        task->pic = NULL;
+        bool interrupted = task->status == INTERRUPTED;
+        bool ended = task->status == ENDED;
+        vlc_mutex_unlock(&task->lock);
+
+        if (interrupted)
+        {
+            if (pic != NULL)
+                picture_Release(pic);
+            break;
+        }
+
+        if (pic == NULL)
+        {
+            /* Without pace control, the input may reach the end of the
+             * stream before the next seek: start it again from there, unless
+             * it did not produce any thumbnail since the last start. */
+            if (ended && progress)
+            {
+                input_Stop(input);
+                input_Close(input);
+                input = NULL;
+                continue;
+            }
+            break; /* timeout, error or past the end */
+        }
+
+        progress = true;
+        task->batch_cbs->on_thumbnail(task->userdata, index, time, pic);
+
+        if (sprite)
+        {
+            picture_t *tile = BatchConvertTile(task, image, pic);
+            if (!vlc_vector_push(&tiles, tile))
+            {
+                if (tile != NULL)
+                    picture_Release(tile);
+                sprite = false;
+            }
+        }
+        picture_Release(pic);
+        index++;
+    }
+
+    if (input != NULL)
+    {
+        input_Stop(input);
+        input_Close(input);
+    }
+
+    vlc_mutex_lock(&task->lock);
+    bool notify = task->status != INTERRUPTED;
+    vlc_mutex_unlock(&task->lock);
+
+    if (notify)
+    {
+        picture_t *sprite_pic = NULL;
+        char *sprite_index = NULL;
+
+        if (sprite && tiles.size > 0)
+        {
+            sprite_pic = BatchComposeSprite(task, tiles.data, tiles.size);
+            if (sprite_pic != NULL)
+                sprite_index = BatchSpriteIndex(task, tiles.size);
+        }
+
+        task->batch_cbs->on_ended(task->userdata, index, sprite_pic,
+                                  sprite_index);
+
+        if (sprite_pic != NULL)
+            picture_Release(sprite_pic);
+        free(sprite_index);
+    }
+
+    picture_t *tile;
+    vlc_vector_foreach(tile, &tiles)
+        if (tile != NULL)
+            picture_Release(tile);
+    vlc_vector_destroy(&tiles);
+    if (image != NULL)
+        image_HandlerDelete(image);
+}
+
 static void
 Interrupt(task_t *task)
 {
@@ -237,11 +597,12 @@ Interrupt(task_t *task)
 static task_t *
 RequestCommon(vlc_thumbnailer_t *thumbnailer, struct seek_target seek_target,
               enum vlc_thumbnailer_seek_speed speed, input_item_t *item,
-              vlc_tick_t timeout, vlc_thumbnailer_cb cb, void *userdata)
+              unsigned width, unsigned height, vlc_tick_t timeout,
+              vlc_thumbnailer_cb cb, void *userdata)
 {
     bool fast_seek = speed == VLC_THUMBNAILER_SEEK_FAST;
-    task_t *task = TaskNew(thumbnailer, item, seek_target, fast_seek, cb,
-                           userdata, timeout);
+    task_t *task = TaskNew(thumbnailer, item, seek_target, fast_seek, width,
+                           height, cb, userdata, timeout);
     if (!task)
         return NULL;
 
@@ -256,29 +617,81 @@ task_t *
 vlc_thumbnailer_RequestByTime( vlc_thumbnailer_t *thumbnailer,
                                vlc_tick_t time,
                                enum vlc_thumbnailer_seek_speed speed,
-                               input_item_t *item, vlc_tick_t timeout,
+                               input_item_t *item, unsigned width,
+                               unsigned height, vlc_tick_t timeout,
                                vlc_thumbnailer_cb cb, void* userdata )
 {
     struct seek_target seek_target = {
         .type = VLC_THUMBNAILER_SEEK_TIME,
         .time = time,
     };
-    return RequestCommon(thumbnailer, seek_target, speed, item, timeout, cb,
-                         userdata);
+    return RequestCommon(thumbnailer, seek_target, speed, item, width, height,
+                         timeout, cb, userdata);
 }
 
 task_t *
 vlc_thumbnailer_RequestByPos( vlc_thumbnailer_t *thumbnailer,
                               double pos, enum vlc_thumbnailer_seek_speed speed,
-                              input_item_t *item, vlc_tick_t timeout,
+                              input_item_t *item, unsigned width,
+                              unsigned height, vlc_tick_t timeout,
                               vlc_thumbnailer_cb cb, void* userdata )
 {
     struct seek_target seek_target = {
         .type = VLC_THUMBNAILER_SEEK_POS,
         .pos = pos,
     };
-    return RequestCommon(thumbnailer, seek_target, speed, item, timeout, cb,
-                         userdata);
+    return RequestCommon(thumbnailer, seek_target, speed, item, width, height,
+                         timeout, cb, userdata);
+}
+
+task_t *
+vlc_thumbnailer_RequestBatch( vlc_thumbnailer_t *thumbnailer,
+                              input_item_t *item,
+                              const struct vlc_thumbnailer_batch *batch,
+                              vlc_tick_t timeout,
+                              const struct vlc_thumbnailer_batch_cbs *cbs,
+                              void *userdata )
+{
+    assert(cbs->on_thumbnail != NULL && cbs->on_ended != NULL);
+    assert(batch->times != NULL ? batch->count > 0 : batch->interval > 0);
+    assert(batch->sprite_columns == 0 || (batch->width > 0 && batch->height > 0));
+
+    struct seek_target seek_target = {
+        .type = VLC_THUMBNAILER_SEEK_TIME,
+        .time = VLC_TICK_INVALID,
+    };
+    task_t *task = TaskNew(thumbnailer, item, seek_target, true, batch->width,
+                           batch->height, NULL, userdata, timeout);
+    if (!task)
+        return NULL;
+
+    task->batch_cbs = cbs;
+    task->batch = *batch;
+    task->batch.times = NULL;
+    task->batch.sprite_url = NULL;
+
+    if (batch->times != NULL)
+    {
+        vlc_tick_t *times = vlc_alloc(batch->count, sizeof(*times));
+        if (times != NULL)
+            memcpy(times, batch->times, batch->count * sizeof(*times));
+        task->batch.times = times;
+    }
+    if (batch->sprite_url != NULL)
+        task->batch.sprite_url = strdup(batch->sprite_url);
+
+    if ((batch->times != NULL && task->batch.times == NULL)
+     || (batch->sprite_url != NULL && task->batch.sprite_url == NULL))
+    {
+        TaskRelease(task);
+        return NULL;
+    }
+
+    /* One ref for the executor */
+    vlc_atomic_rc_inc(&task->rc);
+    vlc_executor_Submit(thumbnailer->executor, &task->runnable);
+
+    return task;
 }
 
 void vlc_thumbnailer_DestroyRequest( vlc_thumbnailer_t* thumbnailer, task_t* task )
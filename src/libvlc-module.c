@@ -1183,7 +1183,17 @@ static const char *const clock_sources_text[] = {
 
 #define PREPARSE_THREADS_TEXT N_( "Preparsing threads" )
 #define PREPARSE_THREADS_LONGTEXT N_( \
-    "Maximum number of threads used to preparse items" )
+    "Maximum number of threads used to preparse local items" )
+
+#define PREPARSE_NET_THREADS_TEXT N_( "Network preparsing threads" )
+#define PREPARSE_NET_THREADS_LONGTEXT N_( \
+    "Maximum number of threads used to preparse network items, in addition " \
+    "to the local ones, so that slow servers do not delay local items." )
+
+#define PREPARSE_CACHE_TEXT N_( "Use a preparsing cache" )
+#define PREPARSE_CACHE_LONGTEXT N_( \
+    "Keep the results of preparsing local files, so that they are not " \
+    "opened again until they are modified." )
 
 #define FETCH_ART_THREADS_TEXT N_( "Fetch-art threads" )
 #define FETCH_ART_THREADS_LONGTEXT N_( \
@@ -2142,6 +2152,12 @@ vlc_module_begin ()
     add_integer( "preparse-threads", 1, PREPARSE_THREADS_TEXT,
                  PREPARSE_THREADS_LONGTEXT )
 
+    add_integer( "preparse-network-threads", 1, PREPARSE_NET_THREADS_TEXT,
+                 PREPARSE_NET_THREADS_LONGTEXT )
+
+    add_bool( "preparse-cache", true, PREPARSE_CACHE_TEXT,
+              PREPARSE_CACHE_LONGTEXT )
+
     add_integer( "fetch-art-threads", 1, FETCH_ART_THREADS_TEXT,
                  FETCH_ART_THREADS_LONGTEXT )
 
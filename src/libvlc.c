@@ -525,3 +525,20 @@ void libvlc_MetadataCancel(libvlc_int_t *libvlc, void *id)
 
     input_preparser_Cancel(priv->parser, id);
 }
+
+/**
+ * Changes the priority of the meta data extraction requests for an input item
+ * that are not started yet.
+ *
+ * The id argument is the same as the one given to libvlc_MetadataRequest().
+ */
+void libvlc_MetadataSetPriority(libvlc_int_t *libvlc, void *id,
+                                enum input_item_preparse_priority priority)
+{
+    libvlc_priv_t *priv = libvlc_priv(libvlc);
+
+    if (unlikely(priv->parser == NULL))
+        return;
+
+    input_preparser_SetPriority(priv->parser, id, priority);
+}
@@ -64,6 +64,7 @@ vlc_media_tree_New(void)
     vlc_media_tree_t *tree = &priv->public_data;
     input_item_node_t *root = &tree->root;
     root->p_item = NULL;
+    root->b_append = false;
     TAB_INIT(root->i_children, root->pp_children);
 
     return tree;
@@ -162,9 +163,22 @@ media_subtree_changed(input_item_t *media, input_item_node_t *node,
         return;
     }
 
-    vlc_media_tree_ClearChildren(subtree_root);
-    vlc_media_tree_AddSubtree(subtree_root, node);
-    vlc_media_tree_Notify(tree, on_children_reset, subtree_root);
+    if (node->b_append)
+    {
+        /* the subitems are posted in several batches */
+        int count = subtree_root->i_children;
+        vlc_media_tree_AddSubtree(subtree_root, node);
+        if (subtree_root->i_children > count)
+            vlc_media_tree_Notify(tree, on_children_added, subtree_root,
+                                  &subtree_root->pp_children[count],
+                                  subtree_root->i_children - count);
+    }
+    else
+    {
+        vlc_media_tree_ClearChildren(subtree_root);
+        vlc_media_tree_AddSubtree(subtree_root, node);
+        vlc_media_tree_Notify(tree, on_children_reset, subtree_root);
+    }
     vlc_media_tree_Unlock(tree);
 }
 
@@ -111,6 +111,8 @@ VLC_WEAK unsigned vlc_CPU_raw(void)
         i_capabilities |= VLC_CPU_SSE2;
     if (i_ecx & 0x00000001)
         i_capabilities |= VLC_CPU_SSE3;
+    if (i_ecx & 0x00000002)
+        i_capabilities |= VLC_CPU_PCLMULQDQ;
     if (i_ecx & 0x00000200)
         i_capabilities |= VLC_CPU_SSSE3;
     if (i_ecx & 0x00080000)
@@ -176,6 +178,8 @@ void vlc_CPU_dump (vlc_object_t *obj)
         vlc_memstream_puts(&stream, "AVX ");
     if (vlc_CPU_AVX2())
         vlc_memstream_puts(&stream, "AVX2 ");
+    if (vlc_CPU_PCLMULQDQ())
+        vlc_memstream_puts(&stream, "PCLMULQDQ ");
 
 #elif defined (__powerpc__) || defined (__ppc__) || defined (__ppc64__)
     if (vlc_CPU_ALTIVEC())
@@ -0,0 +1,223 @@
+/*****************************************************************************
+ * crc.c: Cyclic redundancy checks
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_cpu.h>
+#include <vlc_crc.h>
+
+#ifdef HAVE_PCLMUL_INTRINSICS
+# include <immintrin.h>
+#endif
+
+/*
+ * Every CRC is computed as a 32 bits one, with its register and polynomial
+ * shifted to the top bits: the CRC of a message M with a polynomial P of
+ * width W, M.x^W mod P, is the CRC of M with P.x^(32-W), shifted right by
+ * 32-W bits. This way, the same tables layout and code serve all widths.
+ */
+typedef struct
+{
+    /* table[k][i]: register after i followed by k zero bytes */
+    uint32_t table[8][256];
+#ifdef HAVE_PCLMUL_INTRINSICS
+    /* x^(d+64) mod P, x^d mod P: fold a 128 bits block by d bits */
+    uint64_t fold128[2];
+    uint64_t fold512[2];
+#endif
+    uint32_t poly;
+} vlc_crc_t;
+
+static vlc_crc_t crc8, crc16, crc32;
+static uint32_t (*crc_update)(const vlc_crc_t *, uint32_t,
+                              const uint8_t *, size_t);
+
+static uint32_t crc_xpow(uint32_t poly, unsigned n)
+{
+    uint32_t r = 1;
+    while (n-- > 0)
+        r = (r & 0x80000000) ? (r << 1) ^ poly : r << 1;
+    return r;
+}
+
+static void crc_Init(vlc_crc_t *crc, uint32_t poly)
+{
+    crc->poly = poly;
+
+    for (unsigned i = 0; i < 256; i++)
+    {
+        uint32_t r = (uint32_t)i << 24;
+        for (unsigned j = 0; j < 8; j++)
+            r = (r & 0x80000000) ? (r << 1) ^ poly : r << 1;
+        crc->table[0][i] = r;
+    }
+
+    for (unsigned k = 1; k < 8; k++)
+        for (unsigned i = 0; i < 256; i++)
+        {
+            uint32_t r = crc->table[k - 1][i];
+            crc->table[k][i] = (r << 8) ^ crc->table[0][r >> 24];
+        }
+
+#ifdef HAVE_PCLMUL_INTRINSICS
+    crc->fold128[0] = crc_xpow(poly, 128);
+    crc->fold128[1] = crc_xpow(poly, 128 + 64);
+    crc->fold512[0] = crc_xpow(poly, 512);
+    crc->fold512[1] = crc_xpow(poly, 512 + 64);
+#else
+    VLC_UNUSED(crc_xpow);
+#endif
+}
+
+static inline uint32_t crc_Byte(const vlc_crc_t *crc, uint32_t r, uint8_t b)
+{
+    return (r << 8) ^ crc->table[0][(r >> 24) ^ b];
+}
+
+/* Slicing-by-8: 8 table lookups per 8 bytes, without any dependency
+ * between them but the register */
+static uint32_t crc_UpdateTable(const vlc_crc_t *crc, uint32_t r,
+                                const uint8_t *p, size_t size)
+{
+    const uint32_t (*t)[256] = crc->table;
+
+    for (; size >= 8; size -= 8, p += 8)
+    {
+        uint32_t hi = r ^ GetDWBE(p);
+        uint32_t lo = GetDWBE(p + 4);
+        r = t[7][hi >> 24] ^ t[6][(hi >> 16) & 0xff]
+          ^ t[5][(hi >> 8) & 0xff] ^ t[4][hi & 0xff]
+          ^ t[3][lo >> 24] ^ t[2][(lo >> 16) & 0xff]
+          ^ t[1][(lo >> 8) & 0xff] ^ t[0][lo & 0xff];
+    }
+
+    while (size-- > 0)
+        r = crc_Byte(crc, r, *p++);
+    return r;
+}
+
+#ifdef HAVE_PCLMUL_INTRINSICS
+/* Carry-less multiplication folding, as described in Intel's "Fast CRC
+ * Computation for Generic Polynomials Using PCLMULQDQ Instruction".
+ *
+ * The data is loaded byte-swapped so that the first byte of each 16 bytes
+ * block is the most significant one. Folding a block X = H.x^64 + L by d bits
+ * is then H.(x^(d+64) mod P) + L.(x^d mod P), which is congruent to X.x^d
+ * and fits in 96 bits. The last block is reduced with the tables. */
+# define CRC_PCLMUL_MIN 64
+
+__attribute__((__target__("pclmul,ssse3")))
+static inline __m128i crc_Load(const uint8_t *p, __m128i bswap)
+{
+    return _mm_shuffle_epi8(_mm_loadu_si128((const __m128i *)p), bswap);
+}
+
+__attribute__((__target__("pclmul,ssse3")))
+static inline __m128i crc_Fold(__m128i x, __m128i k)
+{
+    return _mm_xor_si128(_mm_clmulepi64_si128(x, k, 0x11),
+                         _mm_clmulepi64_si128(x, k, 0x00));
+}
+
+__attribute__((__target__("pclmul,ssse3")))
+static uint32_t crc_UpdatePCLMUL(const vlc_crc_t *crc, uint32_t r,
+                                 const uint8_t *p, size_t size)
+{
+    if (size < CRC_PCLMUL_MIN)
+        return crc_UpdateTable(crc, r, p, size);
+
+    const __m128i bswap = _mm_set_epi8(0, 1, 2, 3, 4, 5, 6, 7,
+                                       8, 9, 10, 11, 12, 13, 14, 15);
+    const __m128i k512 = _mm_set_epi64x(crc->fold512[1], crc->fold512[0]);
+    const __m128i k128 = _mm_set_epi64x(crc->fold128[1], crc->fold128[0]);
+
+    /* The register applies to the first 32 bits of the data */
+    __m128i x0 = _mm_xor_si128(crc_Load(p, bswap),
+                               _mm_set_epi32(r, 0, 0, 0));
+    __m128i x1 = crc_Load(p + 16, bswap);
+    __m128i x2 = crc_Load(p + 32, bswap);
+    __m128i x3 = crc_Load(p + 48, bswap);
+    p += 64;
+    size -= 64;
+
+    for (; size >= 64; size -= 64, p += 64)
+    {
+        x0 = _mm_xor_si128(crc_Fold(x0, k512), crc_Load(p, bswap));
+        x1 = _mm_xor_si128(crc_Fold(x1, k512), crc_Load(p + 16, bswap));
+        x2 = _mm_xor_si128(crc_Fold(x2, k512), crc_Load(p + 32, bswap));
+        x3 = _mm_xor_si128(crc_Fold(x3, k512), crc_Load(p + 48, bswap));
+    }
+
+    x0 = _mm_xor_si128(crc_Fold(x0, k128), x1);
+    x0 = _mm_xor_si128(crc_Fold(x0, k128), x2);
+    x0 = _mm_xor_si128(crc_Fold(x0, k128), x3);
+
+    for (; size >= 16; size -= 16, p += 16)
+        x0 = _mm_xor_si128(crc_Fold(x0, k128), crc_Load(p, bswap));
+
+    uint8_t last[16];
+    _mm_storeu_si128((__m128i *)last, _mm_shuffle_epi8(x0, bswap));
+
+    r = crc_UpdateTable(crc, 0, last, sizeof (last));
+    return crc_UpdateTable(crc, r, p, size);
+}
+#endif
+
+static void crc_InitAll(void *data)
+{
+    VLC_UNUSED(data);
+
+    crc_Init(&crc8, UINT32_C(0x07) << 24);
+    crc_Init(&crc16, UINT32_C(0x8005) << 16);
+    crc_Init(&crc32, UINT32_C(0x04c11db7));
+
+    crc_update = crc_UpdateTable;
+#ifdef HAVE_PCLMUL_INTRINSICS
+    if (vlc_CPU_SSSE3() && vlc_CPU_PCLMULQDQ())
+        crc_update = crc_UpdatePCLMUL;
+#endif
+}
+
+static uint32_t crc_Update(const vlc_crc_t *crc, uint32_t r,
+                           const void *buf, size_t size)
+{
+    static vlc_once_t once = VLC_STATIC_ONCE;
+    vlc_once(&once, crc_InitAll, NULL);
+
+    return crc_update(crc, r, buf, size);
+}
+
+uint8_t vlc_crc8(uint8_t crc, const void *buf, size_t size)
+{
+    return crc_Update(&crc8, (uint32_t)crc << 24, buf, size) >> 24;
+}
+
+uint16_t vlc_crc16(uint16_t crc, const void *buf, size_t size)
+{
+    return crc_Update(&crc16, (uint32_t)crc << 16, buf, size) >> 16;
+}
+
+uint32_t vlc_crc32(uint32_t crc, const void *buf, size_t size)
+{
+    return crc_Update(&crc32, crc, buf, size);
+}
@@ -87,6 +87,9 @@ static void
 vlc_playlist_ItemsMoved(vlc_playlist_t *playlist, size_t index, size_t count,
                         size_t target)
 {
+    /* the next sort will have to sort all the items */
+    playlist->sort.sorted = false;
+
     struct vlc_playlist_state state;
     vlc_playlist_state_Save(playlist, &state);
 
@@ -37,6 +37,7 @@ vlc_playlist_item_New(input_item_t *media, uint64_t id)
     vlc_atomic_rc_init(&item->rc);
     item->id = id;
     item->media = media;
+    item->sort_keys = NULL;
     input_item_Hold(media);
     return item;
 }
@@ -53,6 +54,7 @@ vlc_playlist_item_Release(vlc_playlist_item_t *item)
     if (vlc_atomic_rc_dec(&item->rc))
     {
         input_item_Release(item->media);
+        vlc_playlist_sort_keys_Delete(item->sort_keys);
         free(item);
     }
 }
@@ -25,16 +25,23 @@
 
 typedef struct vlc_playlist_item vlc_playlist_item_t;
 typedef struct input_item_t input_item_t;
+struct vlc_playlist_sort_keys;
 
 struct vlc_playlist_item
 {
     input_item_t *media;
     uint64_t id;
     vlc_atomic_rc_t rc;
+    /* keys of the last sort, only accessed with the playlist locked */
+    struct vlc_playlist_sort_keys *sort_keys;
 };
 
 /* _New() is private, it is called when inserting new media in the playlist */
 vlc_playlist_item_t *
 vlc_playlist_item_New(input_item_t *media, uint64_t id);
 
+/* implemented in sort.c */
+void
+vlc_playlist_sort_keys_Delete(struct vlc_playlist_sort_keys *keys);
+
 #endif
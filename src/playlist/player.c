@@ -109,7 +109,8 @@ on_player_media_subitems_changed(vlc_player_t *player, input_item_t *media,
     VLC_UNUSED(player);
     VLC_UNUSED(media);
     vlc_playlist_t *playlist = userdata;
-    vlc_playlist_ExpandItemFromNode(playlist, subitems);
+    vlc_playlist_ExpandItemFromNode(playlist, subitems,
+                                    VLC_PLAYLIST_EXPANSION_PLAYER);
 }
 
 static input_item_t *
@@ -29,6 +29,7 @@
 #include "content.h"
 #include "item.h"
 #include "player.h"
+#include "preparse.h"
 
 vlc_playlist_t *
 vlc_playlist_New(vlc_object_t *parent)
@@ -53,6 +54,13 @@ vlc_playlist_New(vlc_object_t *parent)
     playlist->repeat = VLC_PLAYLIST_PLAYBACK_REPEAT_NONE;
     playlist->order = VLC_PLAYLIST_PLAYBACK_ORDER_NORMAL;
     playlist->idgen = 0;
+    for (size_t i = 0; i < VLC_PLAYLIST_EXPANSIONS; ++i)
+        playlist->expansions[i].media = NULL;
+    playlist->next_expansion = 0;
+    playlist->sort.criteria = NULL;
+    playlist->sort.count = 0;
+    playlist->sort.gen = 0;
+    playlist->sort.sorted = false;
 #ifdef TEST_PLAYLIST
     playlist->libvlc = NULL;
     playlist->auto_preparse = false;
@@ -72,7 +80,9 @@ vlc_playlist_Delete(vlc_playlist_t *playlist)
 
     vlc_playlist_PlayerDestroy(playlist);
     randomizer_Destroy(&playlist->randomizer);
+    vlc_playlist_ClearExpansions(playlist);
     vlc_playlist_ClearItems(playlist);
+    free(playlist->sort.criteria);
     free(playlist);
 }
 
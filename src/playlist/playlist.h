@@ -25,6 +25,7 @@
 #include <vlc_playlist.h>
 #include <vlc_vector.h>
 #include "../player/player.h"
+#include "preparse.h"
 #include "randomizer.h"
 
 typedef struct input_item_t input_item_t;
@@ -45,6 +46,27 @@ typedef struct input_item_t input_item_t;
 
 typedef struct VLC_VECTOR(vlc_playlist_item_t *) playlist_item_vector_t;
 
+/* number of expansions which may still receive subitems to append */
+#define VLC_PLAYLIST_EXPANSIONS 4
+
+/* item replaced by its subitems, which may be posted in several batches */
+struct vlc_playlist_expansion
+{
+    input_item_t *media; /**< expanded media (held), or NULL */
+    enum vlc_playlist_expansion_source source; /**< poster of the batches */
+    uint64_t last_id; /**< id of the last subitem inserted */
+    size_t last_index; /**< index hint for the last subitem inserted */
+};
+
+/* criteria of the last sort, whose keys are cached in the items */
+struct vlc_playlist_sort_state
+{
+    struct vlc_playlist_sort_criterion *criteria;
+    size_t count;
+    uint64_t gen; /**< incremented when the keys of the criteria change */
+    bool sorted; /**< the items not updated since the last sort are sorted */
+};
+
 struct vlc_playlist
 {
     vlc_player_t *player;
@@ -61,6 +83,9 @@ struct vlc_playlist
     enum vlc_playlist_playback_repeat repeat;
     enum vlc_playlist_playback_order order;
     uint64_t idgen;
+    struct vlc_playlist_expansion expansions[VLC_PLAYLIST_EXPANSIONS];
+    unsigned next_expansion; /**< oldest entry, replaced by the next one */
+    struct vlc_playlist_sort_state sort;
 };
 
 /* Also disable vlc_assert_locked in tests since the symbol is not exported */
@@ -62,18 +62,160 @@ vlc_playlist_ExpandItem(vlc_playlist_t *playlist, size_t index,
     return ret;
 }
 
+void
+vlc_playlist_ClearExpansions(vlc_playlist_t *playlist)
+{
+    for (size_t i = 0; i < VLC_PLAYLIST_EXPANSIONS; ++i)
+    {
+        struct vlc_playlist_expansion *expansion = &playlist->expansions[i];
+        if (expansion->media)
+        {
+            input_item_Release(expansion->media);
+            expansion->media = NULL;
+        }
+    }
+}
+
+static struct vlc_playlist_expansion *
+vlc_playlist_FindExpansion(vlc_playlist_t *playlist, const input_item_t *media,
+                           enum vlc_playlist_expansion_source source)
+{
+    for (size_t i = 0; i < VLC_PLAYLIST_EXPANSIONS; ++i)
+    {
+        struct vlc_playlist_expansion *expansion = &playlist->expansions[i];
+        if (expansion->media == media && expansion->source == source)
+            return expansion;
+    }
+    return NULL;
+}
+
+static void
+vlc_playlist_RecordExpansion(vlc_playlist_t *playlist, input_item_t *media,
+                             enum vlc_playlist_expansion_source source,
+                             size_t last_index)
+{
+    struct vlc_playlist_expansion *expansion =
+        vlc_playlist_FindExpansion(playlist, media, source);
+    if (!expansion)
+    {
+        /* replace the oldest one */
+        expansion = &playlist->expansions[playlist->next_expansion];
+        playlist->next_expansion =
+            (playlist->next_expansion + 1) % VLC_PLAYLIST_EXPANSIONS;
+
+        if (expansion->media)
+            input_item_Release(expansion->media);
+        expansion->media = input_item_Hold(media);
+        expansion->source = source;
+    }
+
+    expansion->last_index = last_index;
+    expansion->last_id = playlist->items.data[last_index]->id;
+}
+
+static void
+vlc_playlist_ForgetExpansion(vlc_playlist_t *playlist, input_item_t *media,
+                             enum vlc_playlist_expansion_source source)
+{
+    struct vlc_playlist_expansion *expansion =
+        vlc_playlist_FindExpansion(playlist, media, source);
+    if (expansion)
+    {
+        input_item_Release(expansion->media);
+        expansion->media = NULL;
+    }
+}
+
+static ssize_t
+vlc_playlist_IndexOfLastExpanded(vlc_playlist_t *playlist,
+                                 const struct vlc_playlist_expansion *expansion)
+{
+    /* the items are rarely moved between two batches */
+    size_t index = expansion->last_index;
+    if (index < playlist->items.size
+            && playlist->items.data[index]->id == expansion->last_id)
+        return index;
+    return vlc_playlist_IndexOfId(playlist, expansion->last_id);
+}
+
+static int
+vlc_playlist_AppendToExpansion(vlc_playlist_t *playlist,
+                               input_item_node_t *subitems,
+                               enum vlc_playlist_expansion_source source)
+{
+    vlc_playlist_AssertLocked(playlist);
+
+    /* only follow the batches accepted from the same source */
+    struct vlc_playlist_expansion *expansion =
+        vlc_playlist_FindExpansion(playlist, subitems->p_item, source);
+    if (!expansion)
+        return VLC_ENOENT;
+
+    ssize_t last = vlc_playlist_IndexOfLastExpanded(playlist, expansion);
+    if (last == -1)
+        return VLC_ENOENT;
+
+    media_vector_t flatten = VLC_VECTOR_INITIALIZER;
+    vlc_playlist_CollectChildren(playlist, &flatten, subitems);
+
+    int ret = VLC_SUCCESS;
+    if (flatten.size)
+    {
+        /* insert the whole batch at once, with a single notification */
+        ret = vlc_playlist_Insert(playlist, last + 1, flatten.data,
+                                  flatten.size);
+        if (ret == VLC_SUCCESS)
+        {
+            expansion->last_index = last + flatten.size;
+            expansion->last_id =
+                playlist->items.data[expansion->last_index]->id;
+        }
+    }
+    vlc_vector_destroy(&flatten);
+
+    return ret;
+}
+
 int
 vlc_playlist_ExpandItemFromNode(vlc_playlist_t *playlist,
-                                input_item_node_t *subitems)
+                                input_item_node_t *subitems,
+                                enum vlc_playlist_expansion_source source)
 {
     vlc_playlist_AssertLocked(playlist);
+
+    /* the item has already been replaced by the previous batches */
+    if (subitems->b_append)
+        return vlc_playlist_AppendToExpansion(playlist, subitems, source);
+
     input_item_t *media = subitems->p_item;
     ssize_t index = vlc_playlist_IndexOfMedia(playlist, media);
     if (index == -1)
+    {
+        /* the next batches of this source must be dropped as well (the item
+         * may have been expanded by the other source) */
+        vlc_playlist_ForgetExpansion(playlist, media, source);
         return VLC_ENOENT;
+    }
+
+    size_t count = vlc_playlist_Count(playlist);
 
     /* replace the item by its flatten subtree */
-    return vlc_playlist_ExpandItem(playlist, index, subitems);
+    int ret = vlc_playlist_ExpandItem(playlist, index, subitems);
+    if (ret != VLC_SUCCESS)
+    {
+        vlc_playlist_ForgetExpansion(playlist, media, source);
+        return ret;
+    }
+
+    /* the item is replaced by the subitems (if any) */
+    size_t inserted = vlc_playlist_Count(playlist) + 1 - count;
+    if (inserted)
+        vlc_playlist_RecordExpansion(playlist, media, source,
+                                     index + inserted - 1);
+    else
+        vlc_playlist_ForgetExpansion(playlist, media, source);
+
+    return VLC_SUCCESS;
 }
 
 static void
@@ -84,7 +226,8 @@ on_subtree_added(input_item_t *media, input_item_node_t *subtree,
     vlc_playlist_t *playlist = userdata;
 
     vlc_playlist_Lock(playlist);
-    vlc_playlist_ExpandItemFromNode(playlist, subtree);
+    vlc_playlist_ExpandItemFromNode(playlist, subtree,
+                                    VLC_PLAYLIST_EXPANSION_PREPARSER);
     vlc_playlist_Unlock(playlist);
 }
 
@@ -120,9 +263,12 @@ vlc_playlist_Preparse(vlc_playlist_t *playlist, input_item_t *input)
     VLC_UNUSED(input_preparser_callbacks);
 #else
     /* vlc_MetadataRequest is not exported */
+    /* Background request for every added item: let the user-facing ones
+     * (media library, browsing) go first */
     vlc_MetadataRequest(playlist->libvlc, input,
                         META_REQUEST_OPTION_SCOPE_LOCAL |
-                        META_REQUEST_OPTION_FETCH_LOCAL,
+                        META_REQUEST_OPTION_FETCH_LOCAL |
+                        META_REQUEST_OPTION_PRIORITY_LOW,
                         &input_preparser_callbacks, playlist, -1, NULL);
 #endif
 }
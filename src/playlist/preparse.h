@@ -33,8 +33,20 @@ int
 vlc_playlist_ExpandItem(vlc_playlist_t *playlist, size_t index,
                         input_item_node_t *node);
 
+/* The preparser and the player may both post the subitems of the same media:
+ * the batches appended by one of them must not follow the ones of the other */
+enum vlc_playlist_expansion_source
+{
+    VLC_PLAYLIST_EXPANSION_PREPARSER,
+    VLC_PLAYLIST_EXPANSION_PLAYER,
+};
+
 int
 vlc_playlist_ExpandItemFromNode(vlc_playlist_t *playlist,
-                                input_item_node_t *subitems);
+                                input_item_node_t *subitems,
+                                enum vlc_playlist_expansion_source source);
+
+void
+vlc_playlist_ClearExpansions(vlc_playlist_t *playlist);
 
 #endif
@@ -524,12 +524,104 @@ randomizer_RemoveOne(struct randomizer *r, const vlc_playlist_item_t *item)
     randomizer_RemoveAt(r, index);
 }
 
+/* Open addressing set of the items to remove, NULL for empty slots */
+struct randomizer_item_set
+{
+    const vlc_playlist_item_t **slots;
+    size_t mask;
+};
+
+static inline size_t
+randomizer_item_set_Hash(const struct randomizer_item_set *set,
+                         const vlc_playlist_item_t *item)
+{
+    uint64_t hash = (uint64_t) (uintptr_t) item * UINT64_C(0x9e3779b97f4a7c15);
+    return (size_t) (hash >> 32) & set->mask;
+}
+
+static bool
+randomizer_item_set_Init(struct randomizer_item_set *set,
+                         vlc_playlist_item_t *const items[], size_t count)
+{
+    /* keep the load factor under 1/2 */
+    size_t capacity = 1;
+    while (capacity < 2 * count)
+        capacity <<= 1;
+
+    set->slots = calloc(capacity, sizeof(*set->slots));
+    if (unlikely(!set->slots))
+        return false;
+    set->mask = capacity - 1;
+
+    for (size_t i = 0; i < count; ++i)
+    {
+        size_t h = randomizer_item_set_Hash(set, items[i]);
+        while (set->slots[h])
+            h = (h + 1) & set->mask;
+        set->slots[h] = items[i];
+    }
+    return true;
+}
+
+static inline bool
+randomizer_item_set_Contains(const struct randomizer_item_set *set,
+                             const vlc_playlist_item_t *item)
+{
+    for (size_t h = randomizer_item_set_Hash(set, item); set->slots[h];
+         h = (h + 1) & set->mask)
+        if (set->slots[h] == item)
+            return true;
+    return false;
+}
+
+/* Remove all the items in one pass, instead of searching and shifting the
+ * items once for each of them. The parts keep their relative order, so the
+ * result is equivalent to removing the items one by one. */
+static bool
+randomizer_RemoveBatch(struct randomizer *r,
+                       vlc_playlist_item_t *const items[], size_t count)
+{
+    struct randomizer_item_set set;
+    if (count > SIZE_MAX / 4 || !randomizer_item_set_Init(&set, items, count))
+        return false;
+
+    size_t head = r->head;
+    size_t history = r->history;
+    size_t next = r->next;
+    size_t size = 0;
+    for (size_t i = 0; i < r->items.size; ++i)
+    {
+        vlc_playlist_item_t *item = r->items.data[i];
+        if (randomizer_item_set_Contains(&set, item))
+        {
+            if (i < r->head)
+                head--;
+            if (i < r->history)
+                history--;
+            if (i < r->next)
+                next--;
+        }
+        else
+            r->items.data[size++] = item;
+    }
+    assert(size + count == r->items.size); /* items must exist */
+
+    r->items.size = size;
+    r->head = head;
+    r->history = history;
+    r->next = next;
+
+    free(set.slots);
+    return true;
+}
+
 void
 randomizer_Remove(struct randomizer *r, vlc_playlist_item_t *const items[],
                   size_t count)
 {
-    for (size_t i = 0; i < count; ++i)
-        randomizer_RemoveOne(r, items[i]);
+    if (count < 2 || !randomizer_RemoveBatch(r, items, count))
+        for (size_t i = 0; i < count; ++i)
+            randomizer_RemoveOne(r, items[i]);
 
     vlc_vector_autoshrink(&r->items);
 }
@@ -57,6 +57,9 @@ vlc_playlist_Shuffle(vlc_playlist_t *playlist)
         playlist->items.data[selected] = tmp;
     }
 
+    /* the next sort will have to sort all the items */
+    playlist->sort.sorted = false;
+
     struct vlc_playlist_state state;
     if (current)
     {
@@ -32,47 +32,36 @@
 #include "playlist.h"
 
 /**
- * Struct containing a copy of (parsed) media metadata, used for sorting
- * without locking all the items.
+ * Value of a sort key, read from a locked media.
  */
-struct vlc_playlist_item_meta {
-    vlc_playlist_item_t *item;
-    size_t index;
-    const char *title_or_name;
-    vlc_tick_t duration;
-    const char *artist;
-    const char *album;
-    const char *album_artist;
-    const char *genre;
-    const char *url;
-    int64_t date;
-    int64_t track_number;
-    int64_t disc_number;
-    int64_t rating;
-    bool has_date;
-    bool has_track_number;
-    bool has_disc_number;
-    bool has_rating;
-    int64_t file_size;
-    int64_t file_modified;
+struct vlc_playlist_sort_value
+{
+    const char *str; /**< owned by the media, for string keys */
+    int64_t num;
+    bool has_num;
 };
 
-static int
-vlc_playlist_item_meta_CopyString(const char **to, const char *from)
+/**
+ * Copy of a sort key value, cached in a playlist item: sorting again only
+ * compares it with the media value, and the items are compared without
+ * locking them.
+ */
+struct vlc_playlist_sort_field
 {
-    if (from)
-    {
-        *to = strdup(from);
-        if (unlikely(!*to))
-            return VLC_ENOMEM;
-    }
-    else
-        *to = NULL;
-    return VLC_SUCCESS;
-}
+    char *str;
+    int64_t num;
+    bool has_num;
+};
+
+struct vlc_playlist_sort_keys
+{
+    uint64_t gen; /**< generation of the criteria the keys were read for */
+    size_t count;
+    struct vlc_playlist_sort_field keys[]; /**< one per criterion */
+};
 
 static int
-vlc_playlist_item_meta_GetNumber(const char * str, int64_t * to)
+vlc_playlist_sort_value_GetNumber(const char * str, int64_t * to)
 {
     // NOTE: When we have an empty string we apply the default value.
     if (*str == '\0')
@@ -94,183 +83,176 @@ vlc_playlist_item_meta_GetNumber(const char * str, int64_t * to)
     return VLC_SUCCESS;
 }
 
+static void
+vlc_playlist_sort_value_SetOptional(struct vlc_playlist_sort_value *value,
+                                    const char *str)
+{
+    value->has_num = !EMPTY_STR(str);
+    if (value->has_num)
+        value->num = atoll(str);
+}
+
 static int
-vlc_playlist_item_meta_InitField(struct vlc_playlist_item_meta *meta,
-                                 enum vlc_playlist_sort_key key)
+vlc_playlist_sort_value_GetInfo(struct vlc_playlist_sort_value *value,
+                                input_item_t *media, const char *name)
 {
-    input_item_t *media = meta->item->media;
+    char *str = input_item_GetInfoLocked(media, ".stat", name);
+
+    if (str == NULL)
+        return VLC_EGENERIC;
+
+    int result = vlc_playlist_sort_value_GetNumber(str, &value->num);
+
+    free(str);
+
+    return result;
+}
+
+/* The media must be locked */
+static int
+vlc_playlist_sort_value_Read(struct vlc_playlist_sort_value *value,
+                             input_item_t *media,
+                             enum vlc_playlist_sort_key key)
+{
+    /* assume that NULL representation is all-zeros */
+    *value = (struct vlc_playlist_sort_value) { .str = NULL };
+
     switch (key)
     {
         case VLC_PLAYLIST_SORT_KEY_TITLE:
-        {
-            const char *value = input_item_GetMetaLocked(media, vlc_meta_Title);
-            if (EMPTY_STR(value))
-                value = media->psz_name;
-            return vlc_playlist_item_meta_CopyString(&meta->title_or_name,
-                                                     value);
-        }
+            value->str = input_item_GetMetaLocked(media, vlc_meta_Title);
+            if (EMPTY_STR(value->str))
+                value->str = media->psz_name;
+            return VLC_SUCCESS;
         case VLC_PLAYLIST_SORT_KEY_DURATION:
-        {
-            if (media->i_duration == INPUT_DURATION_INDEFINITE
-             || media->i_duration == INPUT_DURATION_UNSET)
-                meta->duration = 0;
-            else
-                meta->duration = media->i_duration;
+            if (media->i_duration != INPUT_DURATION_INDEFINITE
+             && media->i_duration != INPUT_DURATION_UNSET)
+                value->num = media->i_duration;
             return VLC_SUCCESS;
-        }
         case VLC_PLAYLIST_SORT_KEY_ARTIST:
-        {
-            const char *value = input_item_GetMetaLocked(media,
-                                                         vlc_meta_Artist);
-            return vlc_playlist_item_meta_CopyString(&meta->artist, value);
-        }
+            value->str = input_item_GetMetaLocked(media, vlc_meta_Artist);
+            return VLC_SUCCESS;
         case VLC_PLAYLIST_SORT_KEY_ALBUM:
-        {
-            const char *value = input_item_GetMetaLocked(media, vlc_meta_Album);
-            return vlc_playlist_item_meta_CopyString(&meta->album, value);
-        }
+            value->str = input_item_GetMetaLocked(media, vlc_meta_Album);
+            return VLC_SUCCESS;
         case VLC_PLAYLIST_SORT_KEY_ALBUM_ARTIST:
-        {
-            const char *value = input_item_GetMetaLocked(media,
-                                                         vlc_meta_AlbumArtist);
-            return vlc_playlist_item_meta_CopyString(&meta->album_artist,
-                                                     value);
-        }
+            value->str = input_item_GetMetaLocked(media, vlc_meta_AlbumArtist);
+            return VLC_SUCCESS;
         case VLC_PLAYLIST_SORT_KEY_GENRE:
-        {
-            const char *value = input_item_GetMetaLocked(media, vlc_meta_Genre);
-            return vlc_playlist_item_meta_CopyString(&meta->genre, value);
-        }
+            value->str = input_item_GetMetaLocked(media, vlc_meta_Genre);
+            return VLC_SUCCESS;
         case VLC_PLAYLIST_SORT_KEY_DATE:
-        {
-            const char *str = input_item_GetMetaLocked(media, vlc_meta_Date);
-            meta->has_date = !EMPTY_STR(str);
-            if (meta->has_date)
-                meta->date = atoll(str);
+            vlc_playlist_sort_value_SetOptional(value,
+                    input_item_GetMetaLocked(media, vlc_meta_Date));
             return VLC_SUCCESS;
-        }
         case VLC_PLAYLIST_SORT_KEY_TRACK_NUMBER:
-        {
-            const char *str = input_item_GetMetaLocked(media,
-                                                       vlc_meta_TrackNumber);
-            meta->has_track_number = !EMPTY_STR(str);
-            if (meta->has_track_number)
-                meta->track_number = atoll(str);
+            vlc_playlist_sort_value_SetOptional(value,
+                    input_item_GetMetaLocked(media, vlc_meta_TrackNumber));
             return VLC_SUCCESS;
-        }
         case VLC_PLAYLIST_SORT_KEY_DISC_NUMBER:
-        {
-            const char *str = input_item_GetMetaLocked(media,
-                                                       vlc_meta_DiscNumber);
-            meta->has_disc_number = !EMPTY_STR(str);
-            if (meta->has_disc_number)
-                meta->disc_number = atoll(str);
+            vlc_playlist_sort_value_SetOptional(value,
+                    input_item_GetMetaLocked(media, vlc_meta_DiscNumber));
             return VLC_SUCCESS;
-        }
         case VLC_PLAYLIST_SORT_KEY_URL:
-        {
-            const char *value = input_item_GetMetaLocked(media, vlc_meta_URL);
-            return vlc_playlist_item_meta_CopyString(&meta->url, value);
-        }
+            value->str = input_item_GetMetaLocked(media, vlc_meta_URL);
+            return VLC_SUCCESS;
         case VLC_PLAYLIST_SORT_KEY_RATING:
-        {
-            const char *str = input_item_GetMetaLocked(media, vlc_meta_Rating);
-            meta->has_rating = !EMPTY_STR(str);
-            if (meta->has_rating)
-                meta->rating = atoll(str);
+            vlc_playlist_sort_value_SetOptional(value,
+                    input_item_GetMetaLocked(media, vlc_meta_Rating));
             return VLC_SUCCESS;
-        }
         case VLC_PLAYLIST_SORT_KEY_FILE_SIZE:
-        {
-            char *str = input_item_GetInfoLocked(media, ".stat", "size");
-
-            if (str == NULL)
-                return VLC_EGENERIC;
-
-            int result = vlc_playlist_item_meta_GetNumber(str, &(meta->file_size));
-
-            free(str);
-
-            return result;
-        }
+            return vlc_playlist_sort_value_GetInfo(value, media, "size");
         case VLC_PLAYLIST_SORT_KEY_FILE_MODIFIED:
-        {
-            char *str = input_item_GetInfoLocked(media, ".stat", "mtime");
-
-            if (str == NULL)
-                return VLC_EGENERIC;
-
-            int result = vlc_playlist_item_meta_GetNumber(str, &(meta->file_modified));
-
-            free(str);
-
-            return result;
-        }
+            return vlc_playlist_sort_value_GetInfo(value, media, "mtime");
         default:
             assert(!"Unknown sort key");
             vlc_assert_unreachable();
     }
 }
 
-static void
-vlc_playlist_item_meta_DestroyFields(struct vlc_playlist_item_meta *meta)
-{
-    free((void *) meta->title_or_name);
-    free((void *) meta->artist);
-    free((void *) meta->album);
-    free((void *) meta->album_artist);
-    free((void *) meta->genre);
-    free((void *) meta->url);
-}
-
+/* Updates the cached value from the media one, only copying it if it has
+ * changed */
 static int
-vlc_playlist_item_meta_InitFields(struct vlc_playlist_item_meta *meta,
-        const struct vlc_playlist_sort_criterion criteria[], size_t count)
+vlc_playlist_sort_field_Update(struct vlc_playlist_sort_field *field,
+                               const struct vlc_playlist_sort_value *value,
+                               bool *changed)
 {
-    for (size_t i = 0; i < count; ++i)
+    bool same_str = field->str && value->str
+                  ? !strcmp(field->str, value->str)
+                  : field->str == value->str;
+    if (!same_str)
     {
-        const struct vlc_playlist_sort_criterion *criterion = &criteria[i];
-        int ret = vlc_playlist_item_meta_InitField(meta, criterion->key);
-        if (unlikely(ret != VLC_SUCCESS))
+        char *str = NULL;
+        if (value->str != NULL)
         {
-            vlc_playlist_item_meta_DestroyFields(meta);
-            return ret;
+            str = strdup(value->str);
+            if (unlikely(!str))
+                return VLC_ENOMEM;
         }
+        free(field->str);
+        field->str = str;
+        *changed = true;
+    }
+
+    if (field->num != value->num || field->has_num != value->has_num)
+    {
+        field->num = value->num;
+        field->has_num = value->has_num;
+        *changed = true;
     }
+
     return VLC_SUCCESS;
 }
 
-static struct vlc_playlist_item_meta *
-vlc_playlist_item_meta_New(size_t index, vlc_playlist_item_t *item,
-                           const struct vlc_playlist_sort_criterion criteria[],
-                           size_t count)
+void
+vlc_playlist_sort_keys_Delete(struct vlc_playlist_sort_keys *keys)
 {
-    /* assume that NULL representation is all-zeros */
-    struct vlc_playlist_item_meta *meta = calloc(1, sizeof(*meta));
-    if (unlikely(!meta))
-        return NULL;
-
-    meta->item = item;
-    meta->index = index;
+    if (!keys)
+        return;
+    for (size_t i = 0; i < keys->count; ++i)
+        free(keys->keys[i].str);
+    free(keys);
+}
 
-    vlc_mutex_lock(&item->media->lock);
-    int ret = vlc_playlist_item_meta_InitFields(meta, criteria, count);
-    vlc_mutex_unlock(&item->media->lock);
+/* Reads the sort keys of an item, and reports whether they changed since
+ * they were cached */
+static int
+vlc_playlist_item_UpdateSortKeys(vlc_playlist_t *playlist,
+                                 vlc_playlist_item_t *item, bool *changed)
+{
+    const struct vlc_playlist_sort_state *sort = &playlist->sort;
+    struct vlc_playlist_sort_keys *keys = item->sort_keys;
 
-    if (unlikely(ret != VLC_SUCCESS))
+    *changed = false;
+    if (!keys || keys->gen != sort->gen)
     {
-        free(meta);
-        return NULL;
+        /* not cached yet, or for other criteria */
+        vlc_playlist_sort_keys_Delete(keys);
+        /* assume that NULL representation is all-zeros */
+        keys = calloc(1, sizeof(*keys) + sort->count * sizeof(keys->keys[0]));
+        item->sort_keys = keys;
+        if (unlikely(!keys))
+            return VLC_ENOMEM;
+        keys->gen = sort->gen;
+        keys->count = sort->count;
+        *changed = true;
     }
 
-    return meta;
-}
+    int ret = VLC_SUCCESS;
+    input_item_t *media = item->media;
+    vlc_mutex_lock(&media->lock);
+    for (size_t i = 0; i < sort->count && ret == VLC_SUCCESS; ++i)
+    {
+        struct vlc_playlist_sort_value value;
+        ret = vlc_playlist_sort_value_Read(&value, media,
+                                           sort->criteria[i].key);
+        if (ret == VLC_SUCCESS)
+            ret = vlc_playlist_sort_field_Update(&keys->keys[i], &value,
+                                                 changed);
+    }
+    vlc_mutex_unlock(&media->lock);
 
-static void
-vlc_playlist_item_meta_Delete(struct vlc_playlist_item_meta *meta)
-{
-    vlc_playlist_item_meta_DestroyFields(meta);
-    free(meta);
+    return ret;
 }
 
 static inline int
@@ -326,68 +308,58 @@ CompareOptionalIntegers(bool has_a, int64_t a, bool has_b, int64_t b)
 }
 
 static inline int
-CompareMetaByKey(const struct vlc_playlist_item_meta *a,
-                 const struct vlc_playlist_item_meta *b,
-                 enum vlc_playlist_sort_key key)
+CompareKeys(const struct vlc_playlist_sort_field *a,
+            const struct vlc_playlist_sort_field *b,
+            enum vlc_playlist_sort_key key)
 {
     switch (key)
     {
         case VLC_PLAYLIST_SORT_KEY_TITLE:
-            return CompareFilenameStrings(a->title_or_name, b->title_or_name);
-        case VLC_PLAYLIST_SORT_KEY_DURATION:
-            return CompareIntegers(a->duration, b->duration);
-        case VLC_PLAYLIST_SORT_KEY_ARTIST:
-            return CompareStrings(a->artist, b->artist);
         case VLC_PLAYLIST_SORT_KEY_ALBUM:
-            return CompareFilenameStrings(a->album, b->album);
+            return CompareFilenameStrings(a->str, b->str);
+        case VLC_PLAYLIST_SORT_KEY_ARTIST:
         case VLC_PLAYLIST_SORT_KEY_ALBUM_ARTIST:
-            return CompareStrings(a->album_artist, b->album_artist);
         case VLC_PLAYLIST_SORT_KEY_GENRE:
-            return CompareStrings(a->genre, b->genre);
+            return CompareStrings(a->str, b->str);
+        case VLC_PLAYLIST_SORT_KEY_URL:
+            return CompareVersionStrings(a->str, b->str);
+        case VLC_PLAYLIST_SORT_KEY_DURATION:
+        case VLC_PLAYLIST_SORT_KEY_FILE_SIZE:
+        case VLC_PLAYLIST_SORT_KEY_FILE_MODIFIED:
+            return CompareIntegers(a->num, b->num);
         case VLC_PLAYLIST_SORT_KEY_DATE:
-            return CompareOptionalIntegers(a->has_date, a->date,
-                                           b->has_date, b->date);
         case VLC_PLAYLIST_SORT_KEY_TRACK_NUMBER:
-            return CompareOptionalIntegers(a->has_track_number, a->track_number,
-                                           b->has_track_number, b->track_number);
         case VLC_PLAYLIST_SORT_KEY_DISC_NUMBER:
-            return CompareOptionalIntegers(a->has_disc_number, a->disc_number,
-                                           b->has_disc_number, b->disc_number);
-        case VLC_PLAYLIST_SORT_KEY_URL:
-            return CompareVersionStrings(a->url, b->url);
         case VLC_PLAYLIST_SORT_KEY_RATING:
-            return CompareOptionalIntegers(a->has_rating, a->rating,
-                                           b->has_rating, b->rating);
-        case VLC_PLAYLIST_SORT_KEY_FILE_SIZE:
-            return CompareIntegers(a->file_size, b->file_size);
-        case VLC_PLAYLIST_SORT_KEY_FILE_MODIFIED:
-            return CompareIntegers(a->file_modified, b->file_modified);
+            return CompareOptionalIntegers(a->has_num, a->num,
+                                           b->has_num, b->num);
         default:
             assert(!"Unknown sort key");
             vlc_assert_unreachable();
      }
 }
 
-/* context for qsort_r() */
-struct sort_request
+/* item to sort, along with its position before sorting */
+struct vlc_playlist_sort_entry
 {
-    const struct vlc_playlist_sort_criterion *criteria;
-    size_t count;
+    vlc_playlist_item_t *item;
+    const struct vlc_playlist_sort_keys *keys; /**< item->sort_keys */
+    size_t index;
 };
 
 static int
-compare_meta(const void *lhs, const void *rhs, void *userdata)
+compare_entries(const void *lhs, const void *rhs, void *userdata)
 {
-    struct sort_request *req = userdata;
-    const struct vlc_playlist_item_meta *a =
-            *(const struct vlc_playlist_item_meta **) lhs;
-    const struct vlc_playlist_item_meta *b =
-            *(const struct vlc_playlist_item_meta **) rhs;
+    const struct vlc_playlist_sort_state *sort = userdata;
+    const struct vlc_playlist_sort_entry *a = lhs;
+    const struct vlc_playlist_sort_entry *b = rhs;
 
-    for (size_t i = 0; i < req->count; ++i)
+    for (size_t i = 0; i < sort->count; ++i)
     {
-        const struct vlc_playlist_sort_criterion *criterion = &req->criteria[i];
-        int ret = CompareMetaByKey(a, b, criterion->key);
+        const struct vlc_playlist_sort_criterion *criterion =
+            &sort->criteria[i];
+        int ret = CompareKeys(&a->keys->keys[i], &b->keys->keys[i],
+                              criterion->key);
         if (ret)
         {
             if (criterion->order == VLC_PLAYLIST_SORT_ORDER_DESCENDING)
@@ -403,42 +375,87 @@ compare_meta(const void *lhs, const void *rhs, void *userdata)
     return a->index < b->index ? -1 : 1;
 }
 
-static void
-vlc_playlist_DeleteMetaArray(struct vlc_playlist_item_meta *array[],
-                             size_t count)
+/* Stores the criteria, and returns whether the items not updated since the
+ * last sort are still sorted for them */
+static int
+vlc_playlist_SetSortCriteria(vlc_playlist_t *playlist,
+                             const struct vlc_playlist_sort_criterion criteria[],
+                             size_t count, bool *sorted)
 {
-    for (size_t i = 0; i < count; ++i)
-        vlc_playlist_item_meta_Delete(array[i]);
-    free(array);
-}
+    struct vlc_playlist_sort_state *sort = &playlist->sort;
 
-static struct vlc_playlist_item_meta **
-vlc_playlist_NewMetaArray(vlc_playlist_t *playlist,
-        const struct vlc_playlist_sort_criterion criteria[], size_t count)
-{
-    struct vlc_playlist_item_meta **array =
-            vlc_alloc(playlist->items.size, sizeof(*array));
+    bool same_keys = sort->count == count;
+    bool same_orders = same_keys;
+    for (size_t i = 0; i < count && same_keys; ++i)
+    {
+        same_keys = sort->criteria[i].key == criteria[i].key;
+        same_orders = same_orders
+                   && sort->criteria[i].order == criteria[i].order;
+    }
+
+    *sorted = same_keys && same_orders && sort->sorted;
+    if (*sorted)
+        return VLC_SUCCESS;
 
-    if (unlikely(!array))
-        return NULL;
+    /* until the items are sorted for the new criteria */
+    sort->sorted = false;
 
-    size_t i;
-    for (i = 0; i < playlist->items.size; ++i)
+    if (!same_keys)
     {
-        array[i] = vlc_playlist_item_meta_New(i, playlist->items.data[i],
-                                              criteria, count);
-        if (unlikely(!array[i]))
-            break;
+        struct vlc_playlist_sort_criterion *copy =
+            vlc_alloc(count, sizeof(*copy));
+        if (unlikely(!copy))
+            return VLC_ENOMEM;
+        free(sort->criteria);
+        sort->criteria = copy;
+        sort->count = count;
+        /* the keys cached in the items are now obsolete */
+        sort->gen++;
     }
+    memcpy(sort->criteria, criteria, count * sizeof(*criteria));
+    return VLC_SUCCESS;
+}
 
-    if (i < playlist->items.size)
+/* Returns the number of entries of the sorted run a lower than the entry */
+static size_t
+vlc_playlist_LowerBound(vlc_playlist_t *playlist,
+                        const struct vlc_playlist_sort_entry *a, size_t na,
+                        const struct vlc_playlist_sort_entry *entry)
+{
+    size_t low = 0;
+    size_t high = na;
+    while (low < high)
     {
-        /* allocation failure */
-        vlc_playlist_DeleteMetaArray(array, i);
-        return NULL;
+        size_t mid = low + (high - low) / 2;
+        if (compare_entries(&a[mid], entry, &playlist->sort) < 0)
+            low = mid + 1;
+        else
+            high = mid;
     }
+    return low;
+}
+
+/* Merges a large sorted run of entries with a small one into the playlist
+ * items: each entry of the small run is located by a binary search, so that
+ * the entries of the large run are not compared one by one */
+static void
+vlc_playlist_MergeEntries(vlc_playlist_t *playlist,
+                          const struct vlc_playlist_sort_entry *a, size_t na,
+                          const struct vlc_playlist_sort_entry *b, size_t nb)
+{
+    vlc_playlist_item_t **out = playlist->items.data;
 
-    return array;
+    for (size_t j = 0; j < nb; ++j)
+    {
+        size_t count = vlc_playlist_LowerBound(playlist, a, na, &b[j]);
+        for (size_t i = 0; i < count; ++i)
+            *out++ = a[i].item;
+        a += count;
+        na -= count;
+        *out++ = b[j].item;
+    }
+    for (size_t i = 0; i < na; ++i)
+        *out++ = a[i].item;
 }
 
 int
@@ -453,20 +470,56 @@ vlc_playlist_Sort(vlc_playlist_t *playlist,
                                  ? playlist->items.data[playlist->current]
                                  : NULL;
 
-    struct vlc_playlist_item_meta **array =
-        vlc_playlist_NewMetaArray(playlist, criteria, count);
-    if (unlikely(!array))
+    bool sorted;
+    int ret = vlc_playlist_SetSortCriteria(playlist, criteria, count, &sorted);
+    if (unlikely(ret != VLC_SUCCESS))
+        return ret;
+
+    size_t size = playlist->items.size;
+    struct vlc_playlist_sort_entry *entries = vlc_alloc(size, sizeof(*entries));
+    if (unlikely(!entries && size))
         return VLC_ENOMEM;
 
-    struct sort_request req = { criteria, count };
+    /*
+     * If the playlist was sorted with the same criteria and not reordered
+     * since, the items whose keys did not change are still in order: only
+     * sort the other ones (inserted or updated), and merge them. Otherwise,
+     * sort all of them.
+     *
+     * The unchanged items are stored first, in order, the other ones from the
+     * end.
+     */
+    size_t unchanged = 0;
+    size_t changed = 0;
+    for (size_t i = 0; i < size; ++i)
+    {
+        vlc_playlist_item_t *item = playlist->items.data[i];
+        bool item_changed;
+        ret = vlc_playlist_item_UpdateSortKeys(playlist, item, &item_changed);
+        if (unlikely(ret != VLC_SUCCESS))
+        {
+            /* some keys may have been updated without moving their item */
+            playlist->sort.sorted = false;
+            free(entries);
+            return ret;
+        }
+
+        struct vlc_playlist_sort_entry entry = { item, item->sort_keys, i };
+        if (sorted && !item_changed)
+            entries[unchanged++] = entry;
+        else
+            entries[size - ++changed] = entry;
+    }
 
-    vlc_qsort(array, playlist->items.size, sizeof(*array), compare_meta, &req);
+    vlc_qsort(&entries[unchanged], changed, sizeof(*entries), compare_entries,
+              &playlist->sort);
 
     /* apply the sorting result to the playlist */
-    for (size_t i = 0; i < playlist->items.size; ++i)
-        playlist->items.data[i] = array[i]->item;
+    vlc_playlist_MergeEntries(playlist, entries, unchanged,
+                              &entries[unchanged], changed);
+    playlist->sort.sorted = true;
 
-    vlc_playlist_DeleteMetaArray(array, playlist->items.size);
+    free(entries);
 
     struct vlc_playlist_state state;
     if (current)
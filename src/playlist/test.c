@@ -315,6 +315,188 @@ test_expand_item(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_expand_item_batches(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[16];
+    CreateDummyMediaArray(media, 16);
+
+    /* initial playlist with 5 items */
+    int ret = vlc_playlist_Append(playlist, media, 5);
+    assert(ret == VLC_SUCCESS);
+
+    /* item 2 is expanded by 3 batches, the second one being empty */
+    input_item_t *item_to_expand = playlist->items.data[2]->media;
+    input_item_node_t *batches[3];
+    for (int i = 0; i < 3; ++i)
+    {
+        batches[i] = input_item_node_Create(item_to_expand);
+        assert(batches[i]);
+        batches[i]->b_append = i > 0;
+    }
+
+    for (int i = 0; i < 4; ++i)
+    {
+        input_item_node_t *node = input_item_node_AppendItem(batches[0],
+                                                             media[i + 5]);
+        assert(node);
+    }
+    for (int i = 0; i < 3; ++i)
+    {
+        input_item_node_t *node = input_item_node_AppendItem(batches[2],
+                                                             media[i + 9]);
+        assert(node);
+    }
+
+    ret = vlc_playlist_ExpandItemFromNode(playlist, batches[0],
+                                          VLC_PLAYLIST_EXPANSION_PREPARSER);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_Count(playlist) == 8);
+
+    ret = vlc_playlist_ExpandItemFromNode(playlist, batches[1],
+                                          VLC_PLAYLIST_EXPANSION_PREPARSER);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_Count(playlist) == 8);
+
+    /* move the last expanded item, the next batch must still follow it */
+    vlc_playlist_Move(playlist, 5, 1, 0);
+    EXPECT_AT(0, 8);
+
+    ret = vlc_playlist_ExpandItemFromNode(playlist, batches[2],
+                                          VLC_PLAYLIST_EXPANSION_PREPARSER);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_Count(playlist) == 11);
+
+    EXPECT_AT(0, 8);
+    EXPECT_AT(1, 9);
+    EXPECT_AT(2, 10);
+    EXPECT_AT(3, 11);
+    EXPECT_AT(4, 0);
+    EXPECT_AT(5, 1);
+    EXPECT_AT(6, 5);
+    EXPECT_AT(7, 6);
+    EXPECT_AT(8, 7);
+    EXPECT_AT(9, 3);
+    EXPECT_AT(10, 4);
+
+    /* a batch for an item which has not been expanded is ignored */
+    input_item_node_t *orphan = input_item_node_Create(media[13]);
+    assert(orphan);
+    orphan->b_append = true;
+    input_item_node_t *node = input_item_node_AppendItem(orphan, media[14]);
+    assert(node);
+
+    ret = vlc_playlist_ExpandItemFromNode(playlist, orphan,
+                                          VLC_PLAYLIST_EXPANSION_PREPARSER);
+    assert(ret == VLC_ENOENT);
+    assert(vlc_playlist_Count(playlist) == 11);
+
+    input_item_node_Delete(orphan);
+    for (int i = 0; i < 3; ++i)
+        input_item_node_Delete(batches[i]);
+    DestroyMediaArray(media, 16);
+    vlc_playlist_Delete(playlist);
+}
+
+static input_item_node_t *
+CreateBatch(input_item_t *media, bool append, input_item_t *const *children,
+            size_t count)
+{
+    input_item_node_t *batch = input_item_node_Create(media);
+    assert(batch);
+    batch->b_append = append;
+    for (size_t i = 0; i < count; ++i)
+    {
+        input_item_node_t *node = input_item_node_AppendItem(batch,
+                                                             children[i]);
+        assert(node);
+    }
+    return batch;
+}
+
+static void
+test_expand_item_batches_sources(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[20];
+    CreateDummyMediaArray(media, 20);
+
+    /* initial playlist with 3 items */
+    int ret = vlc_playlist_Append(playlist, media, 3);
+    assert(ret == VLC_SUCCESS);
+
+    /* the preparser and the player both post the subitems of item 1, in
+     * interleaved batches */
+    input_item_t *item_to_expand = media[1];
+    input_item_node_t *batches[6];
+    batches[0] = CreateBatch(item_to_expand, false, &media[3], 2);
+    batches[1] = CreateBatch(item_to_expand, false, &media[5], 2);
+    batches[2] = CreateBatch(item_to_expand, true, &media[7], 2);
+    batches[3] = CreateBatch(item_to_expand, true, &media[9], 2);
+    batches[4] = CreateBatch(item_to_expand, true, &media[11], 2);
+    batches[5] = CreateBatch(item_to_expand, true, &media[13], 2);
+
+    ret = vlc_playlist_ExpandItemFromNode(playlist, batches[0],
+                                          VLC_PLAYLIST_EXPANSION_PREPARSER);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_Count(playlist) == 4);
+
+    /* the item has already been replaced */
+    ret = vlc_playlist_ExpandItemFromNode(playlist, batches[1],
+                                          VLC_PLAYLIST_EXPANSION_PLAYER);
+    assert(ret == VLC_ENOENT);
+    assert(vlc_playlist_Count(playlist) == 4);
+
+    ret = vlc_playlist_ExpandItemFromNode(playlist, batches[2],
+                                          VLC_PLAYLIST_EXPANSION_PREPARSER);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_Count(playlist) == 6);
+
+    /* the first batch of the player was rejected, so are the next ones */
+    ret = vlc_playlist_ExpandItemFromNode(playlist, batches[3],
+                                          VLC_PLAYLIST_EXPANSION_PLAYER);
+    assert(ret == VLC_ENOENT);
+    assert(vlc_playlist_Count(playlist) == 6);
+
+    ret = vlc_playlist_ExpandItemFromNode(playlist, batches[4],
+                                          VLC_PLAYLIST_EXPANSION_PREPARSER);
+    assert(ret == VLC_SUCCESS);
+    assert(vlc_playlist_Count(playlist) == 8);
+
+    EXPECT_AT(0, 0);
+    EXPECT_AT(1, 3);
+    EXPECT_AT(2, 4);
+    EXPECT_AT(3, 7);
+    EXPECT_AT(4, 8);
+    EXPECT_AT(5, 11);
+    EXPECT_AT(6, 12);
+    EXPECT_AT(7, 2);
+
+    /* a new parse from the preparser is rejected, the batches following it
+     * must not be appended to the previous expansion */
+    input_item_node_t *reparse = CreateBatch(item_to_expand, false,
+                                             &media[15], 2);
+    ret = vlc_playlist_ExpandItemFromNode(playlist, reparse,
+                                          VLC_PLAYLIST_EXPANSION_PREPARSER);
+    assert(ret == VLC_ENOENT);
+
+    ret = vlc_playlist_ExpandItemFromNode(playlist, batches[5],
+                                          VLC_PLAYLIST_EXPANSION_PREPARSER);
+    assert(ret == VLC_ENOENT);
+    assert(vlc_playlist_Count(playlist) == 8);
+
+    input_item_node_Delete(reparse);
+    for (int i = 0; i < 6; ++i)
+        input_item_node_Delete(batches[i]);
+    DestroyMediaArray(media, 20);
+    vlc_playlist_Delete(playlist);
+}
+
 struct playlist_state
 {
     size_t playlist_size;
@@ -2423,6 +2605,107 @@ test_stable_sort(void)
     vlc_playlist_Delete(playlist);
 }
 
+static void
+test_sort_again(void)
+{
+    vlc_playlist_t *playlist = vlc_playlist_New(NULL);
+    assert(playlist);
+
+    input_item_t *media[8];
+    CreateDummyMediaArray(media, 8);
+    media[0]->i_duration = 50;
+    media[1]->i_duration = 10;
+    media[2]->i_duration = 40;
+    media[3]->i_duration = 20;
+    media[4]->i_duration = 30;
+    media[5]->i_duration = 10;
+    media[6]->i_duration = 10;
+    media[7]->i_duration = 35;
+
+    /* initial playlist with 6 items */
+    int ret = vlc_playlist_Append(playlist, media, 6);
+    assert(ret == VLC_SUCCESS);
+
+    struct vlc_playlist_callbacks cbs = {
+        .on_items_reset = callback_on_items_reset,
+    };
+
+    struct callback_ctx ctx = CALLBACK_CTX_INITIALIZER;
+    vlc_playlist_listener_id *listener =
+            vlc_playlist_AddListener(playlist, &cbs, &ctx, false);
+    assert(listener);
+
+    struct vlc_playlist_sort_criterion criteria[] = {
+        { VLC_PLAYLIST_SORT_KEY_DURATION, VLC_PLAYLIST_SORT_ORDER_ASCENDING },
+    };
+
+    ret = vlc_playlist_Sort(playlist, criteria, 1);
+    assert(ret == VLC_SUCCESS);
+
+    EXPECT_AT(0, 1);
+    EXPECT_AT(1, 5);
+    EXPECT_AT(2, 3);
+    EXPECT_AT(3, 4);
+    EXPECT_AT(4, 2);
+    EXPECT_AT(5, 0);
+
+    /* insert new items and update an existing one */
+    ret = vlc_playlist_Insert(playlist, 0, &media[6], 2);
+    assert(ret == VLC_SUCCESS);
+    media[3]->i_duration = 60;
+
+    callback_ctx_reset(&ctx);
+
+    /* the result must be the same as sorting all the items */
+    ret = vlc_playlist_Sort(playlist, criteria, 1);
+    assert(ret == VLC_SUCCESS);
+
+    EXPECT_AT(0, 6);
+    EXPECT_AT(1, 1);
+    EXPECT_AT(2, 5);
+    EXPECT_AT(3, 4);
+    EXPECT_AT(4, 7);
+    EXPECT_AT(5, 2);
+    EXPECT_AT(6, 0);
+    EXPECT_AT(7, 3);
+
+    assert(ctx.vec_items_reset.size == 1);
+    assert(ctx.vec_items_reset.data[0].count == 8);
+
+    /* a moved item is not in order anymore */
+    vlc_playlist_Move(playlist, 0, 1, 7);
+    ret = vlc_playlist_Sort(playlist, criteria, 1);
+    assert(ret == VLC_SUCCESS);
+
+    EXPECT_AT(0, 1);
+    EXPECT_AT(1, 5);
+    EXPECT_AT(2, 6);
+    EXPECT_AT(3, 4);
+    EXPECT_AT(4, 7);
+    EXPECT_AT(5, 2);
+    EXPECT_AT(6, 0);
+    EXPECT_AT(7, 3);
+
+    /* same keys, other order */
+    criteria[0].order = VLC_PLAYLIST_SORT_ORDER_DESCENDING;
+    ret = vlc_playlist_Sort(playlist, criteria, 1);
+    assert(ret == VLC_SUCCESS);
+
+    EXPECT_AT(0, 3);
+    EXPECT_AT(1, 0);
+    EXPECT_AT(2, 2);
+    EXPECT_AT(3, 7);
+    EXPECT_AT(4, 4);
+    EXPECT_AT(5, 1);
+    EXPECT_AT(6, 5);
+    EXPECT_AT(7, 6);
+
+    callback_ctx_destroy(&ctx);
+    vlc_playlist_RemoveListener(playlist, listener);
+    DestroyMediaArray(media, 8);
+    vlc_playlist_Delete(playlist);
+}
+
 #undef EXPECT_AT
 
 int main(void)
@@ -2433,6 +2716,8 @@ int main(void)
     test_remove();
     test_clear();
     test_expand_item();
+    test_expand_item_batches();
+    test_expand_item_batches_sources();
     test_items_added_callbacks();
     test_items_moved_callbacks();
     test_items_removed_callbacks();
@@ -2459,6 +2744,7 @@ int main(void)
     test_shuffle();
     test_sort();
     test_stable_sort();
+    test_sort_again();
     return 0;
 }
 
@@ -0,0 +1,877 @@
+/*****************************************************************************
+ * cache.c: preparse results cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <sys/stat.h>
+#include <assert.h>
+#include <stdio.h>
+#include <string.h>
+#include <time.h>
+#include <unistd.h>
+
+#include <vlc_common.h>
+#include <vlc_arrays.h>
+#include <vlc_block.h>
+#include <vlc_crc.h>
+#include <vlc_es.h>
+#include <vlc_fs.h>
+#include <vlc_input_item.h>
+#include <vlc_memstream.h>
+#include <vlc_meta.h>
+#include <vlc_url.h>
+
+#include "input/info.h"
+#include "input/item.h"
+#include "cache.h"
+
+/* Cache filename */
+#define CACHE_NAME "preparse.dat"
+/* Magic for the cache filename: the cache is dropped on upgrade, as the
+ * demuxers might then find different results */
+#define CACHE_STRING "preparse "PACKAGE_NAME" "PACKAGE_VERSION
+/* Sub-version number, to change when the entry format changes */
+#define CACHE_SUBVERSION_NUM 1
+
+/* Entries unused for that many days are not saved anymore */
+#define CACHE_MAX_AGE_DAYS 60
+
+/*
+ * The cache file contains CACHE_STRING, the sub-version number byte, the
+ * entries and the CRC-32 of all of the above (big endian).
+ *
+ * Each entry is made of the URI, size, modification time, day of the last use
+ * and length of the serialized preparse results, followed by them. The
+ * results are kept serialized in memory as well: they are only decoded on
+ * hit.
+ *
+ * Integers are stored as LEB128 variable length numbers (zigzag encoded if
+ * signed) and strings as their length plus one (0 for NULL) followed by their
+ * bytes.
+ */
+
+struct cache_entry
+{
+    uint64_t size;
+    int64_t mtime;
+    uint32_t day; /**< day of the last use, since the Epoch */
+    size_t length;
+    uint8_t data[];
+};
+
+struct input_preparser_cache_t
+{
+    char *dir;
+
+    vlc_mutex_t lock;
+    vlc_dictionary_t entries; /**< struct cache_entry by URI */
+    bool modified;
+    unsigned hits;
+    unsigned misses;
+};
+
+static uint32_t CacheToday(void)
+{
+    return time(NULL) / 86400;
+}
+
+static void EntryFree(void *entry, void *data)
+{
+    VLC_UNUSED(data);
+    free(entry);
+}
+
+/*****************************************************************************
+ * Serialization
+ *****************************************************************************/
+
+static void WriteUInt(struct vlc_memstream *ms, uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        vlc_memstream_putc(ms, 0x80 | (value & 0x7f));
+        value >>= 7;
+    }
+    vlc_memstream_putc(ms, value);
+}
+
+static void WriteInt(struct vlc_memstream *ms, int64_t value)
+{
+    WriteUInt(ms, value < 0 ? ~((uint64_t)value << 1)
+                            : (uint64_t)value << 1);
+}
+
+static void WriteFloat(struct vlc_memstream *ms, float value)
+{
+    uint32_t bits;
+
+    static_assert(sizeof(bits) == sizeof(value), "unexpected float size");
+    memcpy(&bits, &value, sizeof(bits));
+    WriteUInt(ms, bits);
+}
+
+static void WriteString(struct vlc_memstream *ms, const char *str)
+{
+    if (str == NULL)
+    {
+        WriteUInt(ms, 0);
+        return;
+    }
+
+    size_t len = strlen(str);
+    WriteUInt(ms, len + 1);
+    vlc_memstream_write(ms, str, len);
+}
+
+struct cache_reader
+{
+    const uint8_t *p;
+    size_t left;
+    bool error;
+};
+
+static uint64_t ReadUInt(struct cache_reader *r)
+{
+    uint64_t value = 0;
+
+    for (unsigned shift = 0; shift < 64 && r->left > 0; shift += 7)
+    {
+        uint8_t byte = *(r->p++);
+        r->left--;
+        value |= (uint64_t)(byte & 0x7f) << shift;
+        if (!(byte & 0x80))
+            return value;
+    }
+    r->error = true;
+    return 0;
+}
+
+static int64_t ReadInt(struct cache_reader *r)
+{
+    uint64_t value = ReadUInt(r);
+    return (value & 1) ? (int64_t)~(value >> 1) : (int64_t)(value >> 1);
+}
+
+static float ReadFloat(struct cache_reader *r)
+{
+    uint32_t bits = ReadUInt(r);
+    float value;
+
+    memcpy(&value, &bits, sizeof(value));
+    return value;
+}
+
+/* Reads a count of items, each at least one byte long */
+static size_t ReadCount(struct cache_reader *r)
+{
+    uint64_t count = ReadUInt(r);
+    if (count > r->left)
+    {
+        r->error = true;
+        return 0;
+    }
+    return count;
+}
+
+static char *ReadString(struct cache_reader *r)
+{
+    uint64_t size = ReadUInt(r);
+    if (size == 0)
+        return NULL;
+
+    size--;
+    if (size > r->left)
+    {
+        r->error = true;
+        return NULL;
+    }
+
+    char *str = strndup((const char *)r->p, size);
+    if (unlikely(str == NULL))
+        r->error = true;
+    r->p += size;
+    r->left -= size;
+    return str;
+}
+
+static void WriteEs(struct vlc_memstream *ms, const es_format_t *fmt)
+{
+    WriteUInt(ms, fmt->i_cat);
+    WriteUInt(ms, fmt->i_codec);
+    WriteUInt(ms, fmt->i_original_fourcc);
+    WriteInt(ms, fmt->i_id);
+    WriteInt(ms, fmt->i_group);
+    WriteInt(ms, fmt->i_priority);
+    WriteString(ms, fmt->psz_language);
+    WriteString(ms, fmt->psz_description);
+    WriteUInt(ms, fmt->i_bitrate);
+    WriteInt(ms, fmt->i_profile);
+    WriteInt(ms, fmt->i_level);
+
+    switch (fmt->i_cat)
+    {
+        case AUDIO_ES:
+            WriteUInt(ms, fmt->audio.i_rate);
+            WriteUInt(ms, fmt->audio.i_physical_channels);
+            WriteUInt(ms, fmt->audio.i_chan_mode);
+            WriteUInt(ms, fmt->audio.i_channels);
+            WriteUInt(ms, fmt->audio.i_bitspersample);
+            WriteUInt(ms, fmt->audio.i_blockalign);
+            break;
+        case VIDEO_ES:
+            WriteUInt(ms, fmt->video.i_chroma);
+            WriteUInt(ms, fmt->video.i_width);
+            WriteUInt(ms, fmt->video.i_height);
+            WriteUInt(ms, fmt->video.i_x_offset);
+            WriteUInt(ms, fmt->video.i_y_offset);
+            WriteUInt(ms, fmt->video.i_visible_width);
+            WriteUInt(ms, fmt->video.i_visible_height);
+            WriteUInt(ms, fmt->video.i_sar_num);
+            WriteUInt(ms, fmt->video.i_sar_den);
+            WriteUInt(ms, fmt->video.i_frame_rate);
+            WriteUInt(ms, fmt->video.i_frame_rate_base);
+            WriteUInt(ms, fmt->video.orientation);
+            WriteUInt(ms, fmt->video.projection_mode);
+            WriteUInt(ms, fmt->video.multiview_mode);
+            WriteFloat(ms, fmt->video.pose.yaw);
+            WriteFloat(ms, fmt->video.pose.pitch);
+            WriteFloat(ms, fmt->video.pose.roll);
+            WriteFloat(ms, fmt->video.pose.fov);
+            break;
+        case SPU_ES:
+            WriteString(ms, fmt->subs.psz_encoding);
+            break;
+        default:
+            break;
+    }
+}
+
+static void ReadEs(struct cache_reader *r, es_format_t *fmt)
+{
+    enum es_format_category_e cat = ReadUInt(r);
+    vlc_fourcc_t codec = ReadUInt(r);
+
+    es_format_Init(fmt, cat, codec);
+    fmt->i_original_fourcc = ReadUInt(r);
+    fmt->i_id = ReadInt(r);
+    fmt->i_group = ReadInt(r);
+    fmt->i_priority = ReadInt(r);
+    fmt->psz_language = ReadString(r);
+    fmt->psz_description = ReadString(r);
+    fmt->i_bitrate = ReadUInt(r);
+    fmt->i_profile = ReadInt(r);
+    fmt->i_level = ReadInt(r);
+
+    switch (cat)
+    {
+        case AUDIO_ES:
+            fmt->audio.i_rate = ReadUInt(r);
+            fmt->audio.i_physical_channels = ReadUInt(r);
+            fmt->audio.i_chan_mode = ReadUInt(r);
+            fmt->audio.i_channels = ReadUInt(r);
+            fmt->audio.i_bitspersample = ReadUInt(r);
+            fmt->audio.i_blockalign = ReadUInt(r);
+            break;
+        case VIDEO_ES:
+            fmt->video.i_chroma = ReadUInt(r);
+            fmt->video.i_width = ReadUInt(r);
+            fmt->video.i_height = ReadUInt(r);
+            fmt->video.i_x_offset = ReadUInt(r);
+            fmt->video.i_y_offset = ReadUInt(r);
+            fmt->video.i_visible_width = ReadUInt(r);
+            fmt->video.i_visible_height = ReadUInt(r);
+            fmt->video.i_sar_num = ReadUInt(r);
+            fmt->video.i_sar_den = ReadUInt(r);
+            fmt->video.i_frame_rate = ReadUInt(r);
+            fmt->video.i_frame_rate_base = ReadUInt(r);
+            fmt->video.orientation = ReadUInt(r);
+            fmt->video.projection_mode = ReadUInt(r);
+            fmt->video.multiview_mode = ReadUInt(r);
+            fmt->video.pose.yaw = ReadFloat(r);
+            fmt->video.pose.pitch = ReadFloat(r);
+            fmt->video.pose.roll = ReadFloat(r);
+            fmt->video.pose.fov = ReadFloat(r);
+            break;
+        case SPU_ES:
+            fmt->subs.psz_encoding = ReadString(r);
+            break;
+        default:
+            break;
+    }
+}
+
+static bool MetaIsCacheable(vlc_meta_type_t type, const char *value)
+{
+    /* attachments can only be read from an opened input */
+    return type != vlc_meta_ArtworkURL
+        || strncmp(value, "attachment://", 13);
+}
+
+/* The item must be locked */
+static void WriteItem(struct vlc_memstream *ms, input_item_t *item)
+{
+    WriteInt(ms, item->i_duration);
+
+    const vlc_meta_t *meta = item->p_meta;
+    unsigned count = 0;
+    for (int i = 0; i < VLC_META_TYPE_COUNT; i++)
+    {
+        const char *value = meta ? vlc_meta_Get(meta, i) : NULL;
+        if (value != NULL && MetaIsCacheable(i, value))
+            count++;
+    }
+    WriteUInt(ms, count);
+    for (int i = 0; i < VLC_META_TYPE_COUNT && count > 0; i++)
+    {
+        const char *value = meta ? vlc_meta_Get(meta, i) : NULL;
+        if (value != NULL && MetaIsCacheable(i, value))
+        {
+            WriteUInt(ms, i);
+            WriteString(ms, value);
+        }
+    }
+
+    char **names = meta ? vlc_meta_CopyExtraNames(meta) : NULL;
+    count = 0;
+    for (size_t i = 0; names && names[i]; i++)
+        count++;
+    WriteUInt(ms, count);
+    for (size_t i = 0; names && names[i]; i++)
+    {
+        WriteString(ms, names[i]);
+        WriteString(ms, vlc_meta_GetExtra(meta, names[i]));
+        free(names[i]);
+    }
+    free(names);
+
+    WriteUInt(ms, item->i_es);
+    for (int i = 0; i < item->i_es; i++)
+        WriteEs(ms, item->es[i]);
+
+    const info_category_t *cat;
+    count = 0;
+    vlc_list_foreach(cat, &item->categories, node)
+        count++;
+    WriteUInt(ms, count);
+    vlc_list_foreach(cat, &item->categories, node)
+    {
+        const info_t *info;
+
+        WriteString(ms, cat->psz_name);
+        count = 0;
+        info_foreach(info, &cat->infos)
+            count++;
+        WriteUInt(ms, count);
+        info_foreach(info, &cat->infos)
+        {
+            WriteString(ms, info->psz_name);
+            WriteString(ms, info->psz_value);
+        }
+    }
+}
+
+/* Preparse results, decoded before being applied to the item at once */
+struct cache_item
+{
+    vlc_tick_t duration;
+    vlc_meta_t *meta;
+    es_format_t *es;
+    size_t es_count;
+    struct vlc_list categories;
+};
+
+static void CacheItemClean(struct cache_item *ci)
+{
+    if (ci->meta != NULL)
+        vlc_meta_Delete(ci->meta);
+    for (size_t i = 0; i < ci->es_count; i++)
+        es_format_Clean(&ci->es[i]);
+    free(ci->es);
+
+    info_category_t *cat;
+    vlc_list_foreach(cat, &ci->categories, node)
+    {
+        vlc_list_remove(&cat->node);
+        info_category_Delete(cat);
+    }
+}
+
+static int ReadItem(struct cache_reader *r, struct cache_item *ci)
+{
+    ci->es = NULL;
+    ci->es_count = 0;
+    vlc_list_init(&ci->categories);
+
+    ci->meta = vlc_meta_New();
+    if (unlikely(ci->meta == NULL))
+        return VLC_ENOMEM;
+
+    ci->duration = ReadInt(r);
+
+    for (size_t count = ReadCount(r); count > 0 && !r->error; count--)
+    {
+        uint64_t type = ReadUInt(r);
+        char *value = ReadString(r);
+        if (type >= VLC_META_TYPE_COUNT || value == NULL)
+            r->error = true;
+        else
+            vlc_meta_Set(ci->meta, type, value);
+        free(value);
+    }
+
+    for (size_t count = ReadCount(r); count > 0 && !r->error; count--)
+    {
+        char *name = ReadString(r);
+        char *value = ReadString(r);
+        if (name == NULL || value == NULL)
+            r->error = true;
+        else
+            vlc_meta_AddExtra(ci->meta, name, value);
+        free(name);
+        free(value);
+    }
+
+    size_t count = ReadCount(r);
+    if (count > 0 && !r->error)
+    {
+        ci->es = vlc_alloc(count, sizeof(*ci->es));
+        if (unlikely(ci->es == NULL))
+            return VLC_ENOMEM;
+        for (; ci->es_count < count && !r->error; ci->es_count++)
+            ReadEs(r, &ci->es[ci->es_count]);
+    }
+
+    for (count = ReadCount(r); count > 0 && !r->error; count--)
+    {
+        char *name = ReadString(r);
+        info_category_t *cat = name ? info_category_New(name) : NULL;
+        free(name);
+        if (cat == NULL)
+        {
+            r->error = true;
+            break;
+        }
+        vlc_list_append(&cat->node, &ci->categories);
+
+        for (size_t infos = ReadCount(r); infos > 0 && !r->error; infos--)
+        {
+            name = ReadString(r);
+            char *value = ReadString(r);
+            if (name == NULL
+             || info_category_AddInfo(cat, name, "%s", value ? value : "")
+                == NULL)
+                r->error = true;
+            free(name);
+            free(value);
+        }
+    }
+
+    return r->error || r->left > 0 ? VLC_EGENERIC : VLC_SUCCESS;
+}
+
+static void ApplyItem(input_item_t *item, struct cache_item *ci)
+{
+    input_item_SetDuration(item, ci->duration);
+
+    for (int i = 0; i < VLC_META_TYPE_COUNT; i++)
+    {
+        const char *value = vlc_meta_Get(ci->meta, i);
+        if (value != NULL)
+            input_item_SetMeta(item, i, value);
+    }
+
+    char **names = vlc_meta_CopyExtraNames(ci->meta);
+    if (names != NULL)
+    {
+        vlc_mutex_lock(&item->lock);
+        for (size_t i = 0; names[i]; i++)
+        {
+            if (item->p_meta != NULL)
+                vlc_meta_AddExtra(item->p_meta, names[i],
+                                  vlc_meta_GetExtra(ci->meta, names[i]));
+            free(names[i]);
+        }
+        vlc_mutex_unlock(&item->lock);
+        free(names);
+    }
+
+    /* As the preparser names the item after its title */
+    const char *title = vlc_meta_Get(ci->meta, vlc_meta_Title);
+    if (title != NULL)
+        input_item_SetName(item, title);
+
+    for (size_t i = 0; i < ci->es_count; i++)
+        input_item_UpdateTracksInfo(item, &ci->es[i]);
+
+    info_category_t *cat;
+    vlc_list_foreach(cat, &ci->categories, node)
+    {
+        vlc_list_remove(&cat->node);
+        input_item_MergeInfos(item, cat);
+    }
+}
+
+/*****************************************************************************
+ * Cache file
+ *****************************************************************************/
+
+static void CacheLoad(input_preparser_cache_t *cache, const char *path)
+{
+    block_t *file = block_FilePath(path, false);
+    if (file == NULL)
+        return;
+
+    const size_t header = sizeof (CACHE_STRING) - 1 + 1;
+    if (file->i_buffer < header + 4
+     || memcmp(file->p_buffer, CACHE_STRING, sizeof (CACHE_STRING) - 1)
+     || file->p_buffer[header - 1] != CACHE_SUBVERSION_NUM)
+        goto out;
+
+    size_t size = file->i_buffer - 4;
+    if (vlc_crc32(0xffffffff, file->p_buffer, size)
+        != GetDWBE(&file->p_buffer[size]))
+        goto out;
+
+    struct cache_reader r = {
+        .p = &file->p_buffer[header], .left = size - header, .error = false,
+    };
+
+    while (r.left > 0 && !r.error)
+    {
+        char *uri = ReadString(&r);
+        uint64_t file_size = ReadUInt(&r);
+        int64_t mtime = ReadInt(&r);
+        uint32_t day = ReadUInt(&r);
+        uint64_t length = ReadUInt(&r);
+
+        if (uri == NULL || length > r.left || r.error)
+        {
+            free(uri);
+            break;
+        }
+
+        struct cache_entry *entry = malloc(sizeof(*entry) + length);
+        if (likely(entry != NULL))
+        {
+            entry->size = file_size;
+            entry->mtime = mtime;
+            entry->day = day;
+            entry->length = length;
+            memcpy(entry->data, r.p, length);
+            vlc_dictionary_insert(&cache->entries, uri, entry);
+        }
+        free(uri);
+        r.p += length;
+        r.left -= length;
+    }
+
+out:
+    block_Release(file);
+}
+
+static int CacheWrite(input_preparser_cache_t *cache, FILE *file)
+{
+    struct vlc_memstream ms;
+    uint32_t today = CacheToday();
+
+    if (vlc_memstream_open(&ms))
+        return VLC_ENOMEM;
+
+    vlc_memstream_puts(&ms, CACHE_STRING);
+    vlc_memstream_putc(&ms, CACHE_SUBVERSION_NUM);
+
+    for (int i = 0; i < cache->entries.i_size; i++)
+        for (const vlc_dictionary_entry_t *de = cache->entries.p_entries[i];
+             de != NULL; de = de->p_next)
+        {
+            const struct cache_entry *entry = de->p_value;
+
+            if (entry->day + CACHE_MAX_AGE_DAYS < today)
+                continue;
+
+            WriteString(&ms, de->psz_key);
+            WriteUInt(&ms, entry->size);
+            WriteInt(&ms, entry->mtime);
+            WriteUInt(&ms, entry->day);
+            WriteUInt(&ms, entry->length);
+            vlc_memstream_write(&ms, entry->data, entry->length);
+        }
+
+    if (vlc_memstream_close(&ms))
+        return VLC_ENOMEM;
+
+    uint8_t crc[4];
+    SetDWBE(crc, vlc_crc32(0xffffffff, ms.ptr, ms.length));
+
+    int ret = VLC_SUCCESS;
+    if (fwrite(ms.ptr, 1, ms.length, file) != ms.length
+     || fwrite(crc, 1, sizeof(crc), file) != sizeof(crc)
+     || fflush(file))
+        ret = VLC_EGENERIC;
+    free(ms.ptr);
+    return ret;
+}
+
+static int CacheSave(input_preparser_cache_t *cache)
+{
+    char *filename, *tmpname;
+
+    vlc_mkdir(cache->dir, 0700);
+
+    if (asprintf(&filename, "%s"DIR_SEP CACHE_NAME, cache->dir) == -1)
+        return VLC_ENOMEM;
+
+    if (asprintf(&tmpname, "%s.%"PRIu32, filename, (uint32_t)getpid()) == -1)
+    {
+        free(filename);
+        return VLC_ENOMEM;
+    }
+
+    int ret = VLC_EGENERIC;
+    FILE *file = vlc_fopen(tmpname, "wb");
+    if (file == NULL)
+        goto out;
+
+    ret = CacheWrite(cache, file);
+    if (ret != VLC_SUCCESS)
+    {
+        fclose(file);
+        vlc_unlink(tmpname);
+        goto out;
+    }
+
+#if !defined( _WIN32 ) && !defined( __OS2__ )
+    vlc_rename(tmpname, filename); /* atomically replace old cache */
+    fclose(file);
+#else
+    vlc_unlink(filename);
+    fclose(file);
+    vlc_rename(tmpname, filename);
+#endif
+out:
+    free(filename);
+    free(tmpname);
+    return ret;
+}
+
+/*****************************************************************************
+ * API
+ *****************************************************************************/
+
+input_preparser_cache_t *input_preparser_cache_New(const char *dir)
+{
+    input_preparser_cache_t *cache = malloc(sizeof(*cache));
+    if (unlikely(cache == NULL))
+        return NULL;
+
+    cache->dir = strdup(dir);
+    if (unlikely(cache->dir == NULL))
+    {
+        free(cache);
+        return NULL;
+    }
+
+    vlc_mutex_init(&cache->lock);
+    vlc_dictionary_init(&cache->entries, 0);
+    cache->modified = false;
+    cache->hits = cache->misses = 0;
+
+    char *path;
+    if (asprintf(&path, "%s"DIR_SEP CACHE_NAME, dir) != -1)
+    {
+        CacheLoad(cache, path);
+        free(path);
+    }
+
+    return cache;
+}
+
+int input_preparser_cache_Delete(input_preparser_cache_t *cache)
+{
+    int ret = cache->modified ? CacheSave(cache) : VLC_SUCCESS;
+
+    vlc_dictionary_clear(&cache->entries, EntryFree, NULL);
+    free(cache->dir);
+    free(cache);
+    return ret;
+}
+
+int input_preparser_cache_key_Init(struct input_preparser_cache_key *key,
+                                   input_item_t *item)
+{
+    vlc_mutex_lock(&item->lock);
+    bool cacheable = item->i_type == ITEM_TYPE_FILE && !item->b_net
+                  && item->i_options == 0
+                  && !strncmp(item->psz_uri, "file://", 7);
+    char *path = cacheable ? vlc_uri2path(item->psz_uri) : NULL;
+    key->uri = path ? strdup(item->psz_uri) : NULL;
+    vlc_mutex_unlock(&item->lock);
+
+    if (path == NULL)
+        return VLC_EGENERIC;
+
+    struct stat st;
+    int ret = vlc_stat(path, &st);
+    free(path);
+
+    if (ret || !S_ISREG(st.st_mode) || key->uri == NULL)
+    {
+        free(key->uri);
+        return VLC_EGENERIC;
+    }
+
+    key->size = st.st_size;
+    key->mtime = st.st_mtime;
+    return VLC_SUCCESS;
+}
+
+void input_preparser_cache_key_Clean(struct input_preparser_cache_key *key)
+{
+    free(key->uri);
+}
+
+bool input_preparser_cache_Lookup(input_preparser_cache_t *cache,
+                                  const struct input_preparser_cache_key *key,
+                                  input_item_t *item)
+{
+    uint8_t *data = NULL;
+    size_t length = 0;
+
+    vlc_mutex_lock(&cache->lock);
+    struct cache_entry *entry =
+        vlc_dictionary_value_for_key(&cache->entries, key->uri);
+    if (entry != NULL)
+    {
+        if (entry->size == key->size && entry->mtime == key->mtime)
+        {
+            /* decode out of the lock, as the entry can be replaced */
+            data = vlc_alloc(entry->length, 1);
+            length = entry->length;
+            if (likely(data != NULL))
+                memcpy(data, entry->data, length);
+
+            uint32_t today = CacheToday();
+            if (entry->day != today)
+            {
+                entry->day = today;
+                cache->modified = true;
+            }
+        }
+        else
+        {
+            vlc_dictionary_remove_value_for_key(&cache->entries, key->uri,
+                                                EntryFree, NULL);
+            cache->modified = true;
+        }
+    }
+    vlc_mutex_unlock(&cache->lock);
+
+    struct cache_reader r = { .p = data, .left = length, .error = false };
+    struct cache_item ci;
+    bool hit = data != NULL && ReadItem(&r, &ci) == VLC_SUCCESS;
+    if (hit)
+        ApplyItem(item, &ci);
+    if (data != NULL)
+        CacheItemClean(&ci);
+    free(data);
+
+    vlc_mutex_lock(&cache->lock);
+    if (hit)
+        cache->hits++;
+    else
+        cache->misses++;
+    vlc_mutex_unlock(&cache->lock);
+    return hit;
+}
+
+void input_preparser_cache_Insert(input_preparser_cache_t *cache,
+                                  const struct input_preparser_cache_key *key,
+                                  input_item_t *item)
+{
+    struct vlc_memstream ms;
+
+    if (vlc_memstream_open(&ms))
+        return;
+
+    vlc_mutex_lock(&item->lock);
+    WriteItem(&ms, item);
+    vlc_mutex_unlock(&item->lock);
+
+    if (vlc_memstream_close(&ms))
+        return;
+
+    struct cache_entry *entry = malloc(sizeof(*entry) + ms.length);
+    if (unlikely(entry == NULL))
+    {
+        free(ms.ptr);
+        return;
+    }
+
+    entry->size = key->size;
+    entry->mtime = key->mtime;
+    entry->day = CacheToday();
+    entry->length = ms.length;
+    memcpy(entry->data, ms.ptr, ms.length);
+    free(ms.ptr);
+
+    vlc_mutex_lock(&cache->lock);
+    vlc_dictionary_remove_value_for_key(&cache->entries, key->uri,
+                                        EntryFree, NULL);
+    vlc_dictionary_insert(&cache->entries, key->uri, entry);
+    cache->modified = true;
+    vlc_mutex_unlock(&cache->lock);
+}
+
+int input_preparser_cache_CopyResults(input_item_t *dst, input_item_t *src)
+{
+    struct vlc_memstream ms;
+
+    if (vlc_memstream_open(&ms))
+        return VLC_ENOMEM;
+
+    vlc_mutex_lock(&src->lock);
+    WriteItem(&ms, src);
+    vlc_mutex_unlock(&src->lock);
+
+    if (vlc_memstream_close(&ms))
+        return VLC_ENOMEM;
+
+    struct cache_reader r = {
+        .p = (const uint8_t *)ms.ptr, .left = ms.length, .error = false
+    };
+    struct cache_item ci;
+    int ret = ReadItem(&r, &ci);
+    if (ret == VLC_SUCCESS)
+        ApplyItem(dst, &ci);
+    CacheItemClean(&ci);
+    free(ms.ptr);
+    return ret;
+}
+
+void input_preparser_cache_GetStats(input_preparser_cache_t *cache,
+                                    unsigned *hits, unsigned *misses)
+{
+    vlc_mutex_lock(&cache->lock);
+    *hits = cache->hits;
+    *misses = cache->misses;
+    vlc_mutex_unlock(&cache->lock);
+}
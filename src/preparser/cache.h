@@ -0,0 +1,112 @@
+/*****************************************************************************
+ * cache.h: preparse results cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifndef _INPUT_PREPARSER_CACHE_H
+#define _INPUT_PREPARSER_CACHE_H 1
+
+#include <vlc_input_item.h>
+
+/**
+ * Preparse cache opaque structure.
+ *
+ * The cache stores the duration, meta data, tracks and infos of preparsed
+ * local files, keyed by their URI, size and modification time, so that
+ * browsing the same files again does not open them. It is loaded from and
+ * saved to a single file of the given directory.
+ */
+typedef struct input_preparser_cache_t input_preparser_cache_t;
+
+/**
+ * Identifies the content of a file, to be looked up in the cache.
+ */
+struct input_preparser_cache_key
+{
+    char *uri;
+    uint64_t size;
+    int64_t mtime;
+};
+
+/**
+ * This function creates the cache and loads it from the given directory.
+ *
+ * A missing, outdated or corrupted cache file is not an error: the cache is
+ * then created empty.
+ */
+input_preparser_cache_t *input_preparser_cache_New( const char *dir );
+
+/**
+ * This function saves the cache if it was modified and destroys it.
+ *
+ * @returns VLC_SUCCESS if the cache did not need saving or was saved, an error
+ * code otherwise
+ */
+int input_preparser_cache_Delete( input_preparser_cache_t * );
+
+/**
+ * This function gets the key of an input item.
+ *
+ * Only the regular local files without input options can be cached: their
+ * size and modification time are then checked, without opening them.
+ *
+ * @returns VLC_SUCCESS if the item can be cached, an error code otherwise
+ */
+int input_preparser_cache_key_Init( struct input_preparser_cache_key *,
+                                    input_item_t * );
+
+void input_preparser_cache_key_Clean( struct input_preparser_cache_key * );
+
+/**
+ * This function fills the input item with the cached preparse results.
+ *
+ * An entry of a file whose size or modification time changed since it was
+ * inserted is removed.
+ *
+ * @returns true on hit, false on miss
+ */
+bool input_preparser_cache_Lookup( input_preparser_cache_t *,
+                                   const struct input_preparser_cache_key *,
+                                   input_item_t * );
+
+/**
+ * This function inserts the preparse results of an input item.
+ *
+ * @param key the key of the item, as read before preparsing it
+ */
+void input_preparser_cache_Insert( input_preparser_cache_t *,
+                                   const struct input_preparser_cache_key *,
+                                   input_item_t * );
+
+/**
+ * This function copies the preparse results of an input item to another one,
+ * as if they were inserted in and looked up from the cache.
+ *
+ * It does not need a cache object: the preparser uses it to share the results
+ * of one request with the identical requests merged into it.
+ */
+int input_preparser_cache_CopyResults( input_item_t *dst, input_item_t *src );
+
+/**
+ * This function gets the number of hits and misses since the creation of the
+ * cache.
+ */
+void input_preparser_cache_GetStats( input_preparser_cache_t *,
+                                     unsigned *hits, unsigned *misses );
+
+#endif
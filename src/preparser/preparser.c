@@ -23,24 +23,55 @@
 #endif
 
 #include <vlc_common.h>
+#include <vlc_arrays.h>
 #include <vlc_atomic.h>
+#include <vlc_configuration.h>
 #include <vlc_executor.h>
 
 #include "input/input_interface.h"
 #include "input/input_internal.h"
 #include "preparser.h"
 #include "fetcher.h"
+#include "cache.h"
+
+enum preparser_class
+{
+    PREPARSER_CLASS_LOCAL,
+    PREPARSER_CLASS_NETWORK,
+    PREPARSER_CLASS_COUNT,
+};
+
+#define PREPARSER_PRIORITY_COUNT (ITEM_PREPARSE_PRIORITY_HIGH + 1)
 
 struct input_preparser_t
 {
     vlc_object_t* owner;
     input_fetcher_t* fetcher;
+    input_preparser_cache_t *cache;
     vlc_executor_t *executor;
     vlc_tick_t default_timeout;
     atomic_bool deactivated;
 
     vlc_mutex_t lock;
     struct vlc_list submitted_tasks; /**< list of struct task */
+
+    /* The tasks are queued here, and only submitted to the executor when
+     * their class has a free slot, so that the executor queue never holds
+     * more than the running tasks */
+    struct vlc_list pending[PREPARSER_CLASS_COUNT][PREPARSER_PRIORITY_COUNT];
+    unsigned running[PREPARSER_CLASS_COUNT];
+    unsigned max_running[PREPARSER_CLASS_COUNT];
+
+    /* struct task leading the requests for a given URI, see TaskCanFollow() */
+    vlc_dictionary_t leaders;
+
+    /* time spent in the queue, by priority */
+    struct
+    {
+        unsigned count;
+        vlc_tick_t total;
+        vlc_tick_t max;
+    } wait[PREPARSER_PRIORITY_COUNT];
 };
 
 struct task
@@ -53,12 +84,31 @@ struct task
     void *id;
     vlc_tick_t timeout;
 
+    char *uri;
+    bool has_options;
+    enum preparser_class class;
+    enum input_item_preparse_priority priority; /**< requested priority */
+    vlc_tick_t queued; /**< date of the request */
+
+    /* Protected by input_preparser_t.lock */
+    enum
+    {
+        TASK_PENDING, /**< queued in input_preparser_t.pending */
+        TASK_RUNNING, /**< submitted to the executor */
+        TASK_FOLLOWER, /**< merged into the request of another task */
+    } state;
+    enum input_item_preparse_priority queue_priority; /**< of its queue */
+    struct task *leader; /**< if state == TASK_FOLLOWER */
+    struct vlc_list followers; /**< list of struct task merged into this one */
+    struct vlc_list queue_node; /**< node of a pending queue or followers */
+
     input_item_parser_id_t *parser;
 
     vlc_sem_t preparse_ended;
     vlc_sem_t fetch_ended;
     atomic_int preparse_status;
     atomic_bool interrupted;
+    bool subtree_added;
 
     struct vlc_runnable runnable; /**< to be passed to the executor */
 
@@ -79,6 +129,30 @@ TaskNew(input_preparser_t *preparser, input_item_t *item,
     if (!task)
         return NULL;
 
+    vlc_mutex_lock(&item->lock);
+    /* items without URI are only merged with themselves, as nodes */
+    task->uri = strdup(item->psz_uri ? item->psz_uri : INPUT_ITEM_URI_NOP);
+    task->has_options = item->i_options > 0;
+    task->class = item->b_net ? PREPARSER_CLASS_NETWORK
+                              : PREPARSER_CLASS_LOCAL;
+    vlc_mutex_unlock(&item->lock);
+
+    if (task->uri == NULL)
+    {
+        free(task);
+        return NULL;
+    }
+
+    if (options & META_REQUEST_OPTION_PRIORITY_HIGH)
+        task->priority = ITEM_PREPARSE_PRIORITY_HIGH;
+    else if (options & META_REQUEST_OPTION_PRIORITY_LOW)
+        task->priority = ITEM_PREPARSE_PRIORITY_LOW;
+    else
+        task->priority = ITEM_PREPARSE_PRIORITY_NORMAL;
+    task->queued = vlc_tick_now();
+    task->leader = NULL;
+    vlc_list_init(&task->followers);
+
     task->preparser = preparser;
     task->item = item;
     task->options = options;
@@ -94,6 +168,7 @@ TaskNew(input_preparser_t *preparser, input_item_t *item,
     vlc_sem_init(&task->fetch_ended, 0);
     atomic_init(&task->preparse_status, ITEM_PREPARSE_SKIPPED);
     atomic_init(&task->interrupted, false);
+    task->subtree_added = false;
 
     task->runnable.run = RunnableRun;
     task->runnable.userdata = task;
@@ -105,23 +180,163 @@ static void
 TaskDelete(struct task *task)
 {
     input_item_Release(task->item);
+    free(task->uri);
     free(task);
 }
 
+/* The priority of a task is raised by the requests merged into it */
+static enum input_item_preparse_priority
+TaskGetPriority(const struct task *task)
+{
+    enum input_item_preparse_priority priority = task->priority;
+
+    const struct task *follower;
+    vlc_list_foreach(follower, &task->followers, queue_node)
+        if (follower->priority > priority)
+            priority = follower->priority;
+    return priority;
+}
+
+/*
+ * A request can be merged into the pending or running request of another
+ * task for the same URI, if that one does at least as much (scope and
+ * fetching). The results are then copied if the items differ, which is only
+ * correct if they have no input options, as these can change the demuxer or
+ * the parsed content.
+ */
+static bool
+TaskCanFollow(const struct task *leader, const struct task *task)
+{
+    const input_item_meta_request_option_t mask =
+        META_REQUEST_OPTION_SCOPE_ANY | META_REQUEST_OPTION_FETCH_ANY;
+
+    if (task->options & ~leader->options & mask)
+        return false;
+    if (leader->item == task->item)
+        return true;
+    return !leader->has_options && !task->has_options
+        && strcmp(task->uri, INPUT_ITEM_URI_NOP);
+}
+
+/* All the PreparserXxx() functions must be called with the lock held */
+
 static void
-PreparserAddTask(input_preparser_t *preparser, struct task *task)
+PreparserEnqueue(input_preparser_t *preparser, struct task *task)
 {
-    vlc_mutex_lock(&preparser->lock);
-    vlc_list_append(&task->node, &preparser->submitted_tasks);
-    vlc_mutex_unlock(&preparser->lock);
+    task->state = TASK_PENDING;
+    task->queue_priority = TaskGetPriority(task);
+    vlc_list_append(&task->queue_node,
+                    &preparser->pending[task->class][task->queue_priority]);
 }
 
 static void
-PreparserRemoveTask(input_preparser_t *preparser, struct task *task)
+PreparserRequeue(input_preparser_t *preparser, struct task *task)
 {
-    vlc_mutex_lock(&preparser->lock);
-    vlc_list_remove(&task->node);
-    vlc_mutex_unlock(&preparser->lock);
+    assert(task->state == TASK_PENDING);
+
+    if (TaskGetPriority(task) != task->queue_priority)
+    {
+        vlc_list_remove(&task->queue_node);
+        PreparserEnqueue(preparser, task);
+    }
+}
+
+static void
+PreparserQueue(input_preparser_t *preparser, struct task *task)
+{
+    struct task *leader =
+        vlc_dictionary_value_for_key(&preparser->leaders, task->uri);
+
+    if (leader != NULL && TaskCanFollow(leader, task))
+    {
+        task->state = TASK_FOLLOWER;
+        task->leader = leader;
+        vlc_list_append(&task->queue_node, &leader->followers);
+        if (leader->state == TASK_PENDING)
+            PreparserRequeue(preparser, leader);
+        return;
+    }
+
+    if (leader == NULL)
+        vlc_dictionary_insert(&preparser->leaders, task->uri, task);
+    PreparserEnqueue(preparser, task);
+}
+
+static void
+PreparserRemoveLeader(input_preparser_t *preparser, struct task *task)
+{
+    if (vlc_dictionary_value_for_key(&preparser->leaders, task->uri) == task)
+        vlc_dictionary_remove_value_for_key(&preparser->leaders, task->uri,
+                                            NULL, NULL);
+}
+
+/* Requeues the followers of a task that will not provide any results
+ * (cancelled, interrupted, or with subitems, which are not copied) */
+static void
+PreparserPromoteFollower(input_preparser_t *preparser, struct task *task)
+{
+    PreparserRemoveLeader(preparser, task);
+
+    struct task *next =
+        vlc_list_first_entry_or_null(&task->followers, struct task,
+                                     queue_node);
+    if (next == NULL)
+        return;
+
+    vlc_list_remove(&next->queue_node);
+    next->leader = NULL;
+
+    struct task *follower;
+    vlc_list_foreach(follower, &task->followers, queue_node)
+    {
+        vlc_list_remove(&follower->queue_node);
+        if (TaskCanFollow(next, follower))
+        {
+            follower->leader = next;
+            vlc_list_append(&follower->queue_node, &next->followers);
+        }
+        else
+        {
+            follower->leader = NULL;
+            PreparserEnqueue(preparser, follower);
+        }
+    }
+
+    if (!vlc_dictionary_has_key(&preparser->leaders, next->uri))
+        vlc_dictionary_insert(&preparser->leaders, next->uri, next);
+    PreparserEnqueue(preparser, next);
+}
+
+/* Submits the pending tasks of highest priority while there are free slots */
+static void
+PreparserSchedule(input_preparser_t *preparser)
+{
+    for (int class = 0; class < PREPARSER_CLASS_COUNT; class++)
+    {
+        while (preparser->running[class] < preparser->max_running[class])
+        {
+            struct task *task = NULL;
+            for (int prio = PREPARSER_PRIORITY_COUNT - 1;
+                 prio >= 0 && task == NULL; prio--)
+                task = vlc_list_first_entry_or_null(
+                        &preparser->pending[class][prio], struct task,
+                        queue_node);
+            if (task == NULL)
+                break;
+
+            vlc_list_remove(&task->queue_node);
+            task->state = TASK_RUNNING;
+            preparser->running[class]++;
+
+            vlc_tick_t wait = vlc_tick_now() - task->queued;
+            preparser->wait[task->queue_priority].count++;
+            preparser->wait[task->queue_priority].total += wait;
+            if (wait > preparser->wait[task->queue_priority].max)
+                preparser->wait[task->queue_priority].max = wait;
+
+            vlc_executor_Submit(preparser->executor, &task->runnable);
+        }
+    }
 }
 
 static void
@@ -161,6 +376,7 @@ OnParserSubtreeAdded(input_item_t *item, input_item_node_t *subtree,
     VLC_UNUSED(item);
     struct task *task = task_;
 
+    task->subtree_added = true;
     if (task->cbs && task->cbs->on_subtree_added)
         task->cbs->on_subtree_added(task->item, subtree, task->userdata);
 }
@@ -181,7 +397,7 @@ static const input_fetcher_callbacks_t input_fetcher_callbacks = {
 };
 
 static void
-Parse(struct task *task, vlc_tick_t deadline)
+ParseInput(struct task *task, vlc_tick_t deadline)
 {
     static const input_item_parser_cbs_t cbs = {
         .on_ended = OnParserEnded,
@@ -212,6 +428,36 @@ Parse(struct task *task, vlc_tick_t deadline)
     input_item_parser_id_Release(task->parser);
 }
 
+static void
+Parse(struct task *task, vlc_tick_t deadline)
+{
+    input_preparser_cache_t *cache = task->preparser->cache;
+    struct input_preparser_cache_key key;
+
+    if (cache == NULL
+     || input_preparser_cache_key_Init(&key, task->item) != VLC_SUCCESS)
+    {
+        ParseInput(task, deadline);
+        return;
+    }
+
+    if (input_preparser_cache_Lookup(cache, &key, task->item))
+        atomic_store_explicit(&task->preparse_status, ITEM_PREPARSE_DONE,
+                              memory_order_relaxed);
+    else
+    {
+        ParseInput(task, deadline);
+
+        /* Playlist files are not cached, as their subitems are not */
+        if (!atomic_load(&task->interrupted) && !task->subtree_added
+         && atomic_load_explicit(&task->preparse_status,
+                                 memory_order_relaxed) == ITEM_PREPARSE_DONE)
+            input_preparser_cache_Insert(cache, &key, task->item);
+    }
+
+    input_preparser_cache_key_Clean(&key);
+}
+
 static void
 Fetch(struct task *task)
 {
@@ -230,6 +476,56 @@ Fetch(struct task *task)
     vlc_sem_wait(&task->fetch_ended);
 }
 
+static void
+EndTask(struct task *task)
+{
+    input_preparser_t *preparser = task->preparser;
+    struct vlc_list followers;
+
+    vlc_list_init(&followers);
+
+    vlc_mutex_lock(&preparser->lock);
+    preparser->running[task->class]--;
+    if (atomic_load(&task->interrupted) || task->subtree_added)
+        PreparserPromoteFollower(preparser, task);
+    else
+    {
+        PreparserRemoveLeader(preparser, task);
+
+        struct task *follower;
+        vlc_list_foreach(follower, &task->followers, queue_node)
+        {
+            vlc_list_remove(&follower->queue_node);
+            vlc_list_remove(&follower->node);
+            vlc_list_append(&follower->queue_node, &followers);
+        }
+    }
+    vlc_list_remove(&task->node);
+    PreparserSchedule(preparser);
+    vlc_mutex_unlock(&preparser->lock);
+
+    struct task *follower;
+    vlc_list_foreach(follower, &followers, queue_node)
+    {
+        int status = atomic_load_explicit(&task->preparse_status,
+                                          memory_order_relaxed);
+        if (status == ITEM_PREPARSE_DONE)
+        {
+            if (follower->item != task->item
+             && input_preparser_cache_CopyResults(follower->item, task->item))
+                status = ITEM_PREPARSE_FAILED;
+            else
+                input_item_SetPreparsed(follower->item, true);
+        }
+        atomic_store_explicit(&follower->preparse_status, status,
+                              memory_order_relaxed);
+        NotifyPreparseEnded(follower);
+        TaskDelete(follower);
+    }
+
+    TaskDelete(task);
+}
+
 static void
 RunnableRun(void *userdata)
 {
@@ -257,9 +553,7 @@ RunnableRun(void *userdata)
 
 end:
     NotifyPreparseEnded(task);
-    input_preparser_t *preparser = task->preparser;
-    PreparserRemoveTask(preparser, task);
-    TaskDelete(task);
+    EndTask(task);
 }
 
 static void
@@ -282,8 +576,15 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     int max_threads = var_InheritInteger(parent, "preparse-threads");
     if (max_threads < 1)
         max_threads = 1;
+    int max_net_threads =
+        var_InheritInteger(parent, "preparse-network-threads");
+    if (max_net_threads < 1)
+        max_net_threads = 1;
+
+    preparser->max_running[PREPARSER_CLASS_LOCAL] = max_threads;
+    preparser->max_running[PREPARSER_CLASS_NETWORK] = max_net_threads;
 
-    preparser->executor = vlc_executor_New(max_threads);
+    preparser->executor = vlc_executor_New(max_threads + max_net_threads);
     if (!preparser->executor)
     {
         free(preparser);
@@ -295,12 +596,31 @@ input_preparser_t* input_preparser_New( vlc_object_t *parent )
     if (preparser->default_timeout < 0)
         preparser->default_timeout = 0;
 
+    preparser->cache = NULL;
+    if (var_InheritBool(parent, "preparse-cache"))
+    {
+        char *dir = config_GetUserDir(VLC_CACHE_DIR);
+        if (dir != NULL)
+        {
+            preparser->cache = input_preparser_cache_New(dir);
+            free(dir);
+        }
+    }
+
     preparser->owner = parent;
     preparser->fetcher = input_fetcher_New( parent );
     atomic_init( &preparser->deactivated, false );
 
     vlc_mutex_init(&preparser->lock);
     vlc_list_init(&preparser->submitted_tasks);
+    for (int class = 0; class < PREPARSER_CLASS_COUNT; class++)
+    {
+        for (int prio = 0; prio < PREPARSER_PRIORITY_COUNT; prio++)
+            vlc_list_init(&preparser->pending[class][prio]);
+        preparser->running[class] = 0;
+    }
+    vlc_dictionary_init(&preparser->leaders, 0);
+    memset(preparser->wait, 0, sizeof(preparser->wait));
 
     if( unlikely( !preparser->fetcher ) )
         msg_Warn( parent, "unable to create art fetcher" );
@@ -348,9 +668,11 @@ int input_preparser_Push( input_preparser_t *preparser,
     if( !task )
         return VLC_ENOMEM;
 
-    PreparserAddTask(preparser, task);
-
-    vlc_executor_Submit(preparser->executor, &task->runnable);
+    vlc_mutex_lock(&preparser->lock);
+    vlc_list_append(&task->node, &preparser->submitted_tasks);
+    PreparserQueue(preparser, task);
+    PreparserSchedule(preparser);
+    vlc_mutex_unlock(&preparser->lock);
     return VLC_SUCCESS;
 }
 
@@ -370,20 +692,57 @@ void input_preparser_Cancel( input_preparser_t *preparser, void *id )
     struct task *task;
     vlc_list_foreach(task, &preparser->submitted_tasks, node)
     {
-        if (!id || task->id == id)
+        if (id && task->id != id)
+            continue;
+
+        switch (task->state)
         {
-            bool canceled =
-                vlc_executor_Cancel(preparser->executor, &task->runnable);
-            if (canceled)
-            {
-                NotifyPreparseEnded(task);
-                vlc_list_remove(&task->node);
-                TaskDelete(task);
-            }
-            else
-                /* The task will be finished and destroyed after run() */
-                Interrupt(task);
+            case TASK_FOLLOWER:
+                vlc_list_remove(&task->queue_node);
+                break;
+            case TASK_PENDING:
+                vlc_list_remove(&task->queue_node);
+                PreparserPromoteFollower(preparser, task);
+                break;
+            case TASK_RUNNING:
+                if (!vlc_executor_Cancel(preparser->executor,
+                                         &task->runnable))
+                {
+                    /* The task will be finished and destroyed after run() */
+                    Interrupt(task);
+                    continue;
+                }
+                preparser->running[task->class]--;
+                PreparserPromoteFollower(preparser, task);
+                break;
         }
+
+        NotifyPreparseEnded(task);
+        vlc_list_remove(&task->node);
+        TaskDelete(task);
+    }
+
+    PreparserSchedule(preparser);
+    vlc_mutex_unlock(&preparser->lock);
+}
+
+void input_preparser_SetPriority( input_preparser_t *preparser, void *id,
+                                  enum input_item_preparse_priority priority )
+{
+    vlc_mutex_lock(&preparser->lock);
+
+    struct task *task;
+    vlc_list_foreach(task, &preparser->submitted_tasks, node)
+    {
+        if (id && task->id != id)
+            continue;
+
+        task->priority = priority;
+
+        struct task *leader = task->state == TASK_FOLLOWER ? task->leader
+                                                           : task;
+        if (leader->state == TASK_PENDING)
+            PreparserRequeue(preparser, leader);
     }
 
     vlc_mutex_unlock(&preparser->lock);
@@ -402,8 +761,35 @@ void input_preparser_Delete( input_preparser_t *preparser )
 
     vlc_executor_Delete(preparser->executor);
 
+    static const char *const priorities[] = { "low", "normal", "high" };
+    static_assert(ARRAY_SIZE(priorities) == PREPARSER_PRIORITY_COUNT,
+                  "unexpected priority count");
+    for (int prio = 0; prio < PREPARSER_PRIORITY_COUNT; prio++)
+        if (preparser->wait[prio].count > 0)
+            msg_Dbg( preparser->owner, "preparse queue, %s priority: "
+                     "%u requests, %"PRId64" ms average wait, "
+                     "%"PRId64" ms max wait", priorities[prio],
+                     preparser->wait[prio].count,
+                     MS_FROM_VLC_TICK(preparser->wait[prio].total
+                                      / preparser->wait[prio].count),
+                     MS_FROM_VLC_TICK(preparser->wait[prio].max) );
+
+    assert(vlc_dictionary_is_empty(&preparser->leaders));
+    vlc_dictionary_clear(&preparser->leaders, NULL, NULL);
+
     if( preparser->fetcher )
         input_fetcher_Delete( preparser->fetcher );
 
+    if( preparser->cache )
+    {
+        unsigned hits, misses;
+
+        input_preparser_cache_GetStats( preparser->cache, &hits, &misses );
+        msg_Dbg( preparser->owner, "preparse cache: %u hits, %u misses",
+                 hits, misses );
+        if( input_preparser_cache_Delete( preparser->cache ) )
+            msg_Warn( preparser->owner, "cannot save the preparse cache" );
+    }
+
     free( preparser );
 }
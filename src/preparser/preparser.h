@@ -49,10 +49,18 @@ input_preparser_t *input_preparser_New( vlc_object_t * );
  * "preparse-timeout" option will be used as a timeout. If 0, it will wait
  * indefinitely. If > 0, the timeout will be used (in milliseconds).
  * @param id unique id provided by the caller. This is can be used to cancel
- * the request with input_preparser_Cancel()
+ * the request with input_preparser_Cancel(), or to change its priority with
+ * input_preparser_SetPriority()
  * @returns VLC_SUCCESS if the item was scheduled for preparsing, an error code
  * otherwise
  * If this returns an error, the on_preparse_ended will *not* be invoked
+ *
+ * The requests are started by priority, set by the
+ * META_REQUEST_OPTION_PRIORITY_LOW/HIGH options (normal by default), then in
+ * order, with separate limits of running local and network items
+ * ("preparse-threads" and "preparse-network-threads" options). A request for
+ * the URI of a request not ended yet is merged into it, and then gets a copy
+ * of its results, unless the items have input options.
  */
 int input_preparser_Push( input_preparser_t *, input_item_t *,
                            input_item_meta_request_option_t,
@@ -72,6 +80,16 @@ void input_preparser_fetcher_Push( input_preparser_t *, input_item_t *,
  */
 void input_preparser_Cancel( input_preparser_t *, void *id );
 
+/**
+ * This function changes the priority of all preparsing requests for a given id
+ *
+ * The requests that are already running are not affected.
+ *
+ * @param id unique id given to input_preparser_Push()
+ */
+void input_preparser_SetPriority( input_preparser_t *, void *id,
+                                  enum input_item_preparse_priority );
+
 /**
  * This function destroys the preparser object and thread.
  *
@@ -41,6 +41,7 @@
 #include <stdio.h>
 #include <stdlib.h>
 #include <stdbool.h>
+#include <string.h>
 #include <unistd.h>
 #include <signal.h>
 
@@ -89,9 +90,10 @@ static inline void test_init (void)
     }
     if (alarm_timeout != 0)
     {
-        struct sigaction sig = {
-            .sa_handler = on_timeout,
-        };
+        /* not a designated initializer, for the C++ tests */
+        struct sigaction sig;
+        memset(&sig, 0, sizeof (sig));
+        sig.sa_handler = on_timeout;
         sigaction(SIGALRM, &sig, NULL);
         alarm (alarm_timeout);
     }
@@ -0,0 +1,186 @@
+/*****************************************************************************
+ * directory_bench.c: directory listing benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_modules_access_directory_bench [directory]
+ *
+ * Browses a directory with one stat thread, then with the default number of
+ * threads, and measures the time until the first items are added and until
+ * the whole directory is listed. Without directory, 50000 empty files are
+ * generated in a temporary one. The listing is much faster with several
+ * threads on network file systems (NFS, SMB mounts). Set
+ * VLC_TEST_TIMEOUT=-1 for large directories. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define GEN_FILES 50000
+
+struct bench_ctx
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    vlc_tick_t first_item;
+    bool parsed;
+};
+
+static void media_subitem_added(const libvlc_event_t *event, void *user_data)
+{
+    (void)event;
+    struct bench_ctx *ctx = user_data;
+
+    vlc_mutex_lock(&ctx->lock);
+    if (ctx->first_item == VLC_TICK_INVALID)
+        ctx->first_item = vlc_tick_now();
+    vlc_mutex_unlock(&ctx->lock);
+}
+
+static void media_parse_ended(const libvlc_event_t *event, void *user_data)
+{
+    (void)event;
+    struct bench_ctx *ctx = user_data;
+
+    vlc_mutex_lock(&ctx->lock);
+    ctx->parsed = true;
+    vlc_cond_signal(&ctx->cond);
+    vlc_mutex_unlock(&ctx->lock);
+}
+
+static void bench_browse(const char *name, const char *dir,
+                         const char *threads)
+{
+    const char *args[] = {
+        "--ignore-config",
+        "--no-preparse-cache",
+        threads,
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args) - !threads, args);
+    if (vlc == NULL)
+        return;
+
+    struct bench_ctx ctx = { .first_item = VLC_TICK_INVALID };
+    vlc_mutex_init(&ctx.lock);
+    vlc_cond_init(&ctx.cond);
+
+    libvlc_media_t *root = libvlc_media_new_path(dir);
+    if (root == NULL)
+    {
+        libvlc_release(vlc);
+        return;
+    }
+    libvlc_event_manager_t *em = libvlc_media_event_manager(root);
+    libvlc_event_attach(em, libvlc_MediaSubItemAdded, media_subitem_added,
+                        &ctx);
+    libvlc_event_attach(em, libvlc_MediaParsedChanged, media_parse_ended,
+                        &ctx);
+
+    vlc_tick_t start = vlc_tick_now();
+    if (libvlc_media_parse_request(vlc, root, libvlc_media_parse_local, -1))
+    {
+        fprintf(stderr, "can't browse %s\n", dir);
+        libvlc_media_release(root);
+        libvlc_release(vlc);
+        return;
+    }
+
+    vlc_mutex_lock(&ctx.lock);
+    while (!ctx.parsed)
+        vlc_cond_wait(&ctx.cond, &ctx.lock);
+    vlc_mutex_unlock(&ctx.lock);
+    vlc_tick_t end = vlc_tick_now();
+
+    libvlc_media_list_t *list = libvlc_media_subitems(root);
+    int count = 0;
+    if (list != NULL)
+    {
+        libvlc_media_list_lock(list);
+        count = libvlc_media_list_count(list);
+        libvlc_media_list_unlock(list);
+        libvlc_media_list_release(list);
+    }
+
+    printf("%-12s first items %8.3f s  all %8.3f s  %d items\n", name,
+           ctx.first_item != VLC_TICK_INVALID
+               ? secf_from_vlc_tick(ctx.first_item - start) : 0.,
+           secf_from_vlc_tick(end - start), count);
+
+    libvlc_media_release(root);
+    libvlc_release(vlc);
+}
+
+static int generate_files(const char *dir)
+{
+    for (unsigned i = 0; i < GEN_FILES; i++)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%05u.mp3", dir, i);
+        FILE *file = fopen(path, "wb");
+        if (file == NULL)
+            return -1;
+        fclose(file);
+    }
+    return 0;
+}
+
+static void remove_files(const char *dir)
+{
+    for (unsigned i = 0; i < GEN_FILES; i++)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%05u.mp3", dir, i);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+int main(int argc, char *argv[])
+{
+    test_init();
+
+    char gendir[] = "/tmp/vlc-directory-bench-XXXXXX";
+    const char *dir = argc > 1 ? argv[1] : NULL;
+    if (dir == NULL)
+    {
+        if (mkdtemp(gendir) == NULL || generate_files(gendir))
+        {
+            fprintf(stderr, "can't generate the files\n");
+            return 1;
+        }
+        dir = gendir;
+    }
+
+    bench_browse("1 thread", dir, "--directory-stat-threads=1");
+    bench_browse("default", dir, NULL);
+
+    if (dir == gendir)
+        remove_files(gendir);
+    return 0;
+}
@@ -0,0 +1,331 @@
+/*****************************************************************************
+ * adaptive_bench.cpp: adaptive live manifest refresh benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_modules_demux_adaptive_bench [window size...]
+ *
+ * Measures the CPU time of the live manifest refreshes of the adaptive
+ * demuxer, for a DASH SegmentTimeline and a HLS media playlist of the given
+ * number of segments (60, 600, 3600 and 21600 by default, that is 2 minutes
+ * to 12 hours of 2 seconds segments). Every refresh slides the window by one
+ * segment, as a live stream refreshed once per segment does.
+ *
+ * DASH refreshes are split into the XML DOM build and release, the MPD build
+ * knowing the current playlist, and its merge into the current playlist.
+ * The initial load of the same manifests is reported for comparison. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+extern "C" const char vlc_module_name[] = "adaptive_bench";
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+#include <vlc_tick.h>
+
+#include "../../../modules/demux/adaptive/xml/DOMParser.h"
+#include "../../../modules/demux/adaptive/playlist/BasePeriod.h"
+#include "../../../modules/demux/adaptive/playlist/BaseAdaptationSet.h"
+#include "../../../modules/demux/adaptive/playlist/SegmentList.h"
+#include "../../../modules/demux/adaptive/playlist/SegmentTemplate.h"
+#include "../../../modules/demux/adaptive/playlist/SegmentTimeline.h"
+#include "../../../modules/demux/dash/mpd/IsoffMainParser.h"
+#include "../../../modules/demux/dash/mpd/MPD.h"
+#include "../../../modules/demux/hls/playlist/Parser.hpp"
+#include "../../../modules/demux/hls/playlist/M3U8.hpp"
+#include "../../../modules/demux/hls/playlist/HLSRepresentation.hpp"
+
+#include <string>
+#include <vector>
+
+using namespace adaptive::playlist;
+using namespace adaptive::xml;
+using namespace dash::mpd;
+using namespace hls::playlist;
+
+#define BENCH_MIN_DURATION VLC_TICK_FROM_MS(500)
+#define BENCH_MIN_REFRESHES 5
+#define BENCH_LOADS         3
+
+#define MANIFEST_URL "http://example.com/live/manifest"
+
+/* Segments of about 2 seconds at 90 kHz, alternately rounded up and down as
+ * from a 29.97 fps encoder, so that no <S> can be repeated */
+static stime_t segment_duration(uint64_t n)
+{
+    return (n % 2) ? 179820 : 180180;
+}
+
+static stime_t segment_time(uint64_t n)
+{
+    return n * 180000 + ((n % 2) ? 180 : 0);
+}
+
+static std::string dash_manifest(uint64_t first, size_t count)
+{
+    std::string mpd =
+        "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+        "<MPD xmlns=\"urn:mpeg:dash:schema:mpd:2011\" type=\"dynamic\""
+        " profiles=\"urn:mpeg:dash:profile:isoff-live:2011\""
+        " availabilityStartTime=\"1970-01-01T00:00:00Z\""
+        " minimumUpdatePeriod=\"PT2S\" timeShiftBufferDepth=\"PT12H\""
+        " minBufferTime=\"PT4S\">\n"
+        " <Period id=\"p0\" start=\"PT0S\">\n"
+        "  <AdaptationSet id=\"1\" mimeType=\"video/mp4\" segmentAlignment=\"true\">\n"
+        "   <SegmentTemplate timescale=\"90000\""
+        " initialization=\"$RepresentationID$/init.mp4\""
+        " media=\"$RepresentationID$/$Time$.m4s\">\n"
+        "    <SegmentTimeline>\n";
+    for(uint64_t n = first; n < first + count; n++)
+    {
+        mpd += "     <S ";
+        if(n == first)
+            mpd += "t=\"" + std::to_string(segment_time(n)) + "\" ";
+        mpd += "d=\"" + std::to_string(segment_duration(n)) + "\"/>\n";
+    }
+    mpd +=
+        "    </SegmentTimeline>\n"
+        "   </SegmentTemplate>\n"
+        "   <Representation id=\"v1\" bandwidth=\"1000000\" codecs=\"avc1.64001f\""
+        " width=\"960\" height=\"540\"/>\n"
+        "   <Representation id=\"v2\" bandwidth=\"3000000\" codecs=\"avc1.640028\""
+        " width=\"1920\" height=\"1080\"/>\n"
+        "  </AdaptationSet>\n"
+        " </Period>\n"
+        "</MPD>\n";
+    return mpd;
+}
+
+static std::string hls_playlist(uint64_t first, size_t count)
+{
+    std::string m3u =
+        "#EXTM3U\n"
+        "#EXT-X-VERSION:3\n"
+        "#EXT-X-TARGETDURATION:2\n"
+        "#EXT-X-MEDIA-SEQUENCE:" + std::to_string(first) + "\n";
+    for(uint64_t n = first; n < first + count; n++)
+    {
+        m3u += (n % 2) ? "#EXTINF:1.998,\n" : "#EXTINF:2.002,\n";
+        m3u += "segment-" + std::to_string(n) + ".ts\n";
+    }
+    return m3u;
+}
+
+static stream_t *manifest_stream(vlc_object_t *obj, std::string &manifest)
+{
+    return vlc_stream_MemoryNew(obj, reinterpret_cast<uint8_t *>(&manifest[0]),
+                                manifest.size(), true);
+}
+
+struct dash_times
+{
+    vlc_tick_t xml, mpd, merge;
+};
+
+static MPD *dash_parse(vlc_object_t *obj, std::string &manifest,
+                       MPD *known, dash_times *times)
+{
+    stream_t *s = manifest_stream(obj, manifest);
+    if(!s)
+        return nullptr;
+
+    MPD *mpd = nullptr;
+    vlc_tick_t start = vlc_tick_now(), parsed, built, merged;
+    {
+        DOMParser parser(s);
+        bool b_parsed = parser.parse(true);
+        parsed = vlc_tick_now();
+        if(b_parsed)
+        {
+            IsoffMainParser mpdparser(parser.getRootNode(), obj, s,
+                                      MANIFEST_URL);
+            mpdparser.setKnownPlaylist(known);
+            mpd = mpdparser.parse();
+        }
+        built = vlc_tick_now();
+
+        if(mpd && known)
+        {
+            known->updateWith(mpd);
+            delete mpd;
+            mpd = known;
+        }
+        merged = vlc_tick_now();
+    }
+    /* the DOM is released with the parser */
+    times->xml += parsed - start + vlc_tick_now() - merged;
+    times->mpd += built - parsed;
+    times->merge += merged - built;
+    vlc_stream_Delete(s);
+    return mpd;
+}
+
+static size_t dash_window(MPD *mpd)
+{
+    const SegmentTemplate *templ = mpd->getFirstPeriod()
+            ->getAdaptationSets().front()->inheritSegmentTemplate();
+    const SegmentTimeline *timeline = templ ? templ->inheritSegmentTimeline()
+                                            : nullptr;
+    if(!timeline)
+        return 0;
+    return timeline->maxElementNumber() - timeline->minElementNumber() + 1;
+}
+
+static int bench_dash(vlc_object_t *obj, size_t count)
+{
+    MPD *mpd = nullptr;
+    dash_times load = {}, refresh = {};
+
+    for(int i = 0; i < BENCH_LOADS; i++)
+    {
+        std::string manifest = dash_manifest(0, count);
+        delete mpd;
+        mpd = dash_parse(obj, manifest, nullptr, &load);
+        if(!mpd)
+            return VLC_EGENERIC;
+    }
+
+    unsigned refreshes = 0;
+    do
+    {
+        std::string manifest = dash_manifest(++refreshes, count);
+        if(!dash_parse(obj, manifest, mpd, &refresh))
+            break;
+    } while(refreshes < BENCH_MIN_REFRESHES ||
+            refresh.xml + refresh.mpd + refresh.merge < BENCH_MIN_DURATION);
+
+    int ret = dash_window(mpd) == count ? VLC_SUCCESS : VLC_EGENERIC;
+    delete mpd;
+
+    printf("dash %6zu segments: load %8.3f ms, refresh %8.3f ms"
+           " (xml %8.3f, mpd %8.3f, merge %8.3f)%s\n", count,
+           secf_from_vlc_tick(load.xml + load.mpd + load.merge)
+                * 1000 / BENCH_LOADS,
+           secf_from_vlc_tick(refresh.xml + refresh.mpd + refresh.merge)
+                * 1000 / refreshes,
+           secf_from_vlc_tick(refresh.xml) * 1000 / refreshes,
+           secf_from_vlc_tick(refresh.mpd) * 1000 / refreshes,
+           secf_from_vlc_tick(refresh.merge) * 1000 / refreshes,
+           ret ? "  (bad window)" : "");
+    return ret;
+}
+
+static HLSRepresentation *hls_representation(M3U8 *m3u)
+{
+    BasePeriod *period = m3u->getFirstPeriod();
+    if(!period || period->getAdaptationSets().empty())
+        return nullptr;
+    BaseAdaptationSet *set = period->getAdaptationSets().front();
+    if(set->getRepresentations().empty())
+        return nullptr;
+    return dynamic_cast<HLSRepresentation *>(set->getRepresentations().front());
+}
+
+static int bench_hls(vlc_object_t *obj, size_t count)
+{
+    M3U8Parser parser(nullptr);
+    M3U8 *m3u = nullptr;
+    vlc_tick_t load = 0, refresh = 0;
+
+    for(int i = 0; i < BENCH_LOADS; i++)
+    {
+        std::string playlist = hls_playlist(0, count);
+        stream_t *s = manifest_stream(obj, playlist);
+        if(!s)
+            break;
+        delete m3u;
+        vlc_tick_t start = vlc_tick_now();
+        m3u = parser.parse(obj, s, MANIFEST_URL);
+        load += vlc_tick_now() - start;
+        vlc_stream_Delete(s);
+    }
+
+    HLSRepresentation *rep = m3u ? hls_representation(m3u) : nullptr;
+    if(!rep)
+    {
+        delete m3u;
+        return VLC_EGENERIC;
+    }
+
+    unsigned refreshes = 0;
+    do
+    {
+        std::string playlist = hls_playlist(++refreshes, count);
+        stream_t *s = manifest_stream(obj, playlist);
+        if(!s)
+            break;
+        vlc_tick_t start = vlc_tick_now();
+        parser.appendSegmentsFromStream(obj, s, rep);
+        refresh += vlc_tick_now() - start;
+        vlc_stream_Delete(s);
+    } while(refreshes < BENCH_MIN_REFRESHES || refresh < BENCH_MIN_DURATION);
+
+    const SegmentList *list = rep->inheritSegmentList();
+    int ret = list && list->getSegments().size() == count
+            ? VLC_SUCCESS : VLC_EGENERIC;
+    delete m3u;
+
+    printf("hls  %6zu segments: load %8.3f ms, refresh %8.3f ms%s\n", count,
+           secf_from_vlc_tick(load) * 1000 / BENCH_LOADS,
+           secf_from_vlc_tick(refresh) * 1000 / refreshes,
+           ret ? "  (bad window)" : "");
+    return ret;
+}
+
+int main(int argc, char *argv[])
+{
+    std::vector<size_t> counts;
+
+    test_init();
+
+    for(int i = 1; i < argc; i++)
+    {
+        unsigned long count = strtoul(argv[i], NULL, 10);
+        if(count == 0)
+        {
+            fprintf(stderr, "invalid window size: %s\n", argv[i]);
+            return 1;
+        }
+        counts.push_back(count);
+    }
+    if(counts.empty())
+        counts = { 60, 600, 3600, 21600 };
+
+    libvlc_instance_t *vlc = libvlc_new(test_defaults_nargs,
+                                        test_defaults_args);
+    if(!vlc)
+        return 1;
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    int ret = 0;
+    for(size_t count : counts)
+        if(bench_dash(obj, count) != VLC_SUCCESS)
+            ret = 1;
+    for(size_t count : counts)
+        if(bench_hls(obj, count) != VLC_SUCCESS)
+            ret = 1;
+
+    libvlc_release(vlc);
+    return ret;
+}
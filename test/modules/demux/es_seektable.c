@@ -0,0 +1,330 @@
+/*****************************************************************************
+ * es_seektable.c: audio elementary stream seek table tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+const char vlc_module_name[] = "es_seektable";
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+#include <vlc_codec.h>
+#include <vlc_rand.h>
+
+#include "../../../modules/packetizer/a52.h"
+#include "../../../modules/packetizer/mpegaudio.h"
+#include "../../../modules/demux/mpeg/es_seektable.h"
+
+#define BAILOUT(run) { fprintf(stderr, "failed %s line %d\n", run, __LINE__); \
+                        goto end; }
+#define EXPECT(foo) if(!(foo)) BAILOUT(run)
+
+/* 5 minutes of audio */
+#define STREAM_DURATION VLC_TICK_FROM_SEC(300)
+
+typedef struct
+{
+    uint8_t    *p_data;
+    size_t      i_data;
+    size_t      i_max;
+    /* every frame start, as reference */
+    seektable_point_t *p_frames;
+    size_t      i_frames;
+    vlc_tick_t  i_length;
+} es_sample_t;
+
+static uint8_t *SampleAppend( es_sample_t *p_sample, size_t i_size )
+{
+    if( p_sample->i_data + i_size > p_sample->i_max )
+    {
+        p_sample->i_max = (p_sample->i_data + i_size) * 2;
+        p_sample->p_data = realloc( p_sample->p_data, p_sample->i_max );
+        assert( p_sample->p_data );
+    }
+    uint8_t *p = &p_sample->p_data[p_sample->i_data];
+    /* payload that won't emulate any of the sync words */
+    for( size_t i = 0; i < i_size; i++ )
+        p[i] = 0x10 + (vlc_lrand48() & 0x3F);
+    p_sample->i_data += i_size;
+    return p;
+}
+
+static void SampleAddFrame( es_sample_t *p_sample, size_t i_pos,
+                            unsigned i_samples, unsigned i_rate,
+                            uint64_t *pi_total )
+{
+    if( (p_sample->i_frames & 1023) == 0 )
+    {
+        p_sample->p_frames = realloc( p_sample->p_frames,
+                        (p_sample->i_frames + 1024) * sizeof(seektable_point_t) );
+        assert( p_sample->p_frames );
+    }
+    seektable_point_t *p = &p_sample->p_frames[p_sample->i_frames++];
+    p->i_pos = i_pos;
+    p->i_time = vlc_tick_from_samples( *pi_total, i_rate );
+    *pi_total += i_samples;
+    p_sample->i_length = vlc_tick_from_samples( *pi_total, i_rate );
+}
+
+static void GenerateMpga( es_sample_t *p_sample )
+{
+    uint64_t i_total = 0;
+    while( p_sample->i_length < STREAM_DURATION )
+    {
+        /* MPEG-1 layer III, 44.1kHz, random bitrate */
+        uint32_t h = 0xFFFB0000 | ((1 + vlc_lrand48() % 14) << 12) |
+                     ((vlc_lrand48() & 1) << 9);
+        struct mpga_frameheader_s mpgah;
+        assert( !mpga_decode_frameheader( h, &mpgah ) );
+
+        size_t i_pos = p_sample->i_data;
+        uint8_t *p = SampleAppend( p_sample, mpgah.i_frame_size );
+        SetDWBE( p, h );
+        SampleAddFrame( p_sample, i_pos, mpgah.i_samples_per_frame,
+                        mpgah.i_sample_rate, &i_total );
+    }
+}
+
+static void GenerateAdts( es_sample_t *p_sample )
+{
+    uint64_t i_total = 0;
+    while( p_sample->i_length < STREAM_DURATION )
+    {
+        /* 48kHz, no CRC, one raw block */
+        size_t i_size = 7 + vlc_lrand48() % 1500;
+        size_t i_pos = p_sample->i_data;
+        uint8_t *p = SampleAppend( p_sample, i_size );
+        p[0] = 0xFF;
+        p[1] = 0xF1;
+        p[2] = 0x40 | (3 << 2);
+        p[3] = 0x80 | (i_size >> 11);
+        p[4] = i_size >> 3;
+        p[5] = ((i_size & 0x07) << 5) | 0x1F;
+        p[6] = 0xFC;
+        SampleAddFrame( p_sample, i_pos, 1024, 48000, &i_total );
+    }
+}
+
+static void GenerateA52( es_sample_t *p_sample, bool b_big_endian )
+{
+    uint64_t i_total = 0;
+    while( p_sample->i_length < STREAM_DURATION )
+    {
+        /* 48kHz stereo, random bitrate */
+        const uint8_t header[VLC_A52_MIN_HEADER_SIZE] = {
+            0x0B, 0x77, 0x00, 0x00, vlc_lrand48() % 38, 0x08 << 3, 0x40, 0x00
+        };
+        vlc_a52_header_t a52;
+        assert( !vlc_a52_header_Parse( &a52, header, sizeof(header) ) );
+
+        size_t i_pos = p_sample->i_data;
+        uint8_t *p = SampleAppend( p_sample, a52.i_size );
+        if( b_big_endian )
+            memcpy( p, header, sizeof(header) );
+        else
+            swab( header, p, sizeof(header) );
+        SampleAddFrame( p_sample, i_pos, a52.i_samples, a52.i_rate, &i_total );
+    }
+}
+
+typedef struct
+{
+    seektable_t  *p_table;
+    stream_t     *s;
+    vlc_fourcc_t  i_codec;
+    bool          b_big_endian;
+    int           i_ret;
+} scan_ctx_t;
+
+static void *ScanThread( void *data )
+{
+    scan_ctx_t *ctx = data;
+    ctx->i_ret = es_seektable_Scan( ctx->p_table, ctx->s, ctx->i_codec,
+                                    ctx->b_big_endian );
+    return NULL;
+}
+
+/* the seekpoint must be a frame start, at or before the target, and no
+ * more than ES_SEEKTABLE_INTERVAL frames away from it */
+static bool CheckByTime( const es_sample_t *p_sample, vlc_tick_t i_target,
+                         const seektable_point_t *p_point )
+{
+    size_t i_low = 0, i_high = p_sample->i_frames;
+    while( i_high - i_low > 1 )
+    {
+        size_t i_mid = (i_low + i_high) / 2;
+        if( p_sample->p_frames[i_mid].i_time <= i_target )
+            i_low = i_mid;
+        else
+            i_high = i_mid;
+    }
+    for( size_t i = 0; i < ES_SEEKTABLE_INTERVAL && i <= i_low; i++ )
+    {
+        const seektable_point_t *p = &p_sample->p_frames[i_low - i];
+        if( p->i_time == p_point->i_time && p->i_pos == p_point->i_pos )
+            return true;
+    }
+    return false;
+}
+
+static bool CheckByPos( const es_sample_t *p_sample, uint64_t i_target,
+                        const seektable_point_t *p_point )
+{
+    size_t i_low = 0, i_high = p_sample->i_frames;
+    while( i_high - i_low > 1 )
+    {
+        size_t i_mid = (i_low + i_high) / 2;
+        if( p_sample->p_frames[i_mid].i_pos <= i_target )
+            i_low = i_mid;
+        else
+            i_high = i_mid;
+    }
+    for( size_t i = 0; i < ES_SEEKTABLE_INTERVAL && i <= i_low; i++ )
+    {
+        const seektable_point_t *p = &p_sample->p_frames[i_low - i];
+        if( p->i_time == p_point->i_time && p->i_pos == p_point->i_pos )
+            return true;
+    }
+    return false;
+}
+
+static int runtest( const char *run, libvlc_instance_t *vlc,
+                    vlc_fourcc_t i_codec, bool b_big_endian,
+                    es_sample_t *p_sample )
+{
+    int ret = 1;
+    stream_t *s = NULL;
+    seektable_t table;
+    seektable_point_t point;
+    vlc_tick_t i_length;
+
+    /* trailing ID3v1 tag */
+    memcpy( SampleAppend( p_sample, 128 ), "TAG", 3 );
+
+    seektable_Init( &table );
+
+    s = vlc_stream_MemoryNew( vlc->p_libvlc_int, p_sample->p_data,
+                                        p_sample->i_data, true );
+    EXPECT( s );
+
+    /* nothing scanned yet */
+    EXPECT( seektable_SeekByTime( &table, 0, &point ) != VLC_SUCCESS );
+    EXPECT( seektable_GetEndTime( &table, &i_length ) != VLC_SUCCESS );
+
+    /* seek while the table is being built */
+    scan_ctx_t ctx = { .p_table = &table, .s = s, .i_codec = i_codec,
+                       .b_big_endian = b_big_endian, .i_ret = VLC_EGENERIC };
+    vlc_thread_t thread;
+    vlc_tick_t i_start = vlc_tick_now();
+    EXPECT( !vlc_clone( &thread, ScanThread, &ctx ) );
+
+    vlc_tick_t i_first_seek = VLC_TICK_INVALID;
+    unsigned i_partial = 0;
+    bool b_ok = true;
+    for( unsigned i = 0; i < 100000 && b_ok; i++ )
+    {
+        vlc_tick_t i_target = vlc_lrand48() % STREAM_DURATION;
+        if( seektable_SeekByTime( &table, i_target, &point ) == VLC_SUCCESS )
+        {
+            if( i_first_seek == VLC_TICK_INVALID )
+                i_first_seek = vlc_tick_now() - i_start;
+            b_ok = CheckByTime( p_sample, i_target, &point );
+            i_partial++;
+        }
+    }
+    vlc_join( thread, NULL );
+    vlc_tick_t i_scan = vlc_tick_now() - i_start;
+    EXPECT( b_ok );
+    EXPECT( ctx.i_ret == VLC_SUCCESS );
+
+    /* whole stream is known */
+    EXPECT( seektable_GetEndTime( &table, &i_length ) == VLC_SUCCESS );
+    EXPECT( i_length == p_sample->i_length );
+    EXPECT( table.i_points == (p_sample->i_frames + ES_SEEKTABLE_INTERVAL - 1)
+                              / ES_SEEKTABLE_INTERVAL );
+
+    /* accuracy */
+    i_start = vlc_tick_now();
+    for( unsigned i = 0; i < 100000; i++ )
+    {
+        vlc_tick_t i_target = vlc_lrand48() % (p_sample->i_length + 1);
+        EXPECT( seektable_SeekByTime( &table, i_target, &point ) == VLC_SUCCESS );
+        EXPECT( CheckByTime( p_sample, i_target, &point ) );
+
+        uint64_t i_target_pos = vlc_lrand48() % p_sample->i_data;
+        EXPECT( seektable_SeekByPos( &table, i_target_pos, &point ) == VLC_SUCCESS );
+        EXPECT( CheckByPos( p_sample, i_target_pos, &point ) );
+    }
+    vlc_tick_t i_lookups = vlc_tick_now() - i_start;
+
+    EXPECT( seektable_SeekByTime( &table, 0, &point ) == VLC_SUCCESS );
+    EXPECT( point.i_time == 0 && point.i_pos == 0 );
+
+    fprintf( stderr, "%s: %zu frames, %zu bytes, scanned in %"PRId64" ms, "
+             "first seek after %"PRId64" ms (%u during scan), "
+             "200000 lookups in %"PRId64" ms\n", run,
+             p_sample->i_frames, p_sample->i_data, MS_FROM_VLC_TICK( i_scan ),
+             i_first_seek != VLC_TICK_INVALID ? MS_FROM_VLC_TICK( i_first_seek ) : -1,
+             i_partial, MS_FROM_VLC_TICK( i_lookups ) );
+    ret = 0;
+
+end:
+    if( s )
+        vlc_stream_Delete( s );
+    seektable_Clean( &table );
+    free( p_sample->p_data );
+    free( p_sample->p_frames );
+    return ret;
+}
+
+int main( void )
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new( 0, NULL );
+    if( !vlc )
+        return 1;
+
+    int ret = 0;
+    es_sample_t sample;
+
+    memset( &sample, 0, sizeof(sample) );
+    GenerateMpga( &sample );
+    ret |= runtest( "mpga", vlc, VLC_CODEC_MPGA, false, &sample );
+
+    memset( &sample, 0, sizeof(sample) );
+    GenerateAdts( &sample );
+    ret |= runtest( "adts", vlc, VLC_CODEC_MP4A, false, &sample );
+
+    memset( &sample, 0, sizeof(sample) );
+    GenerateA52( &sample, true );
+    ret |= runtest( "a52", vlc, VLC_CODEC_A52, true, &sample );
+
+    memset( &sample, 0, sizeof(sample) );
+    GenerateA52( &sample, false );
+    ret |= runtest( "a52 swapped", vlc, VLC_CODEC_A52, false, &sample );
+
+    libvlc_release( vlc );
+    return ret;
+}
@@ -0,0 +1,419 @@
+/*****************************************************************************
+ * mkv_bench.c: Matroska demuxer first seek benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_modules_demux_mkv_bench [minutes]
+ *
+ * Writes a Matroska file without Cues of 60 minutes by default, as a live
+ * recording would, with a 25 fps video track and an audio track in 2 s
+ * clusters, and measures the first seek to the middle of the file:
+ *  - without the background cluster indexer,
+ *  - right after opening, while the indexer runs,
+ *  - once the indexer is done.
+ * The file is written to /tmp, and is read from the page cache. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_fs.h>
+#include <vlc_stream.h>
+#include <vlc_tick.h>
+#include <vlc_url.h>
+#include <vlc_variables.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define GEN_FPS            25
+#define GEN_VIDEO_SIZE     4000
+#define GEN_AUDIO_SIZE     400
+#define GEN_AUDIO_FRAME_MS 24 /* MPEG audio layer II at 48 kHz */
+#define GEN_CLUSTER_MS     2000
+
+struct ebml_writer
+{
+    uint8_t *p_data;
+    size_t   i_data;
+    size_t   i_alloc;
+};
+
+static uint8_t *ebml_Reserve(struct ebml_writer *w, size_t i_size)
+{
+    if (w->i_data + i_size > w->i_alloc)
+    {
+        size_t i_alloc = __MAX(w->i_alloc * 2, w->i_data + i_size);
+        uint8_t *p_realloc = realloc(w->p_data, i_alloc);
+        if (!p_realloc)
+            abort();
+        w->p_data = p_realloc;
+        w->i_alloc = i_alloc;
+    }
+    uint8_t *p = &w->p_data[w->i_data];
+    w->i_data += i_size;
+    return p;
+}
+
+static void ebml_PutId(struct ebml_writer *w, uint32_t i_id)
+{
+    unsigned i_len = i_id > 0xffffff ? 4 : i_id > 0xffff ? 3 : i_id > 0xff ? 2 : 1;
+    uint8_t *p = ebml_Reserve(w, i_len);
+    for (unsigned i = 0; i < i_len; i++)
+        p[i] = i_id >> (8 * (i_len - 1 - i));
+}
+
+/* Every element size is coded on 8 bytes, so that it can be written once
+ * the element is complete */
+static void ebml_SetSize(uint8_t *p, uint64_t i_size)
+{
+    SetQWBE(p, i_size);
+    p[0] = 0x01;
+}
+
+/* Returns the offset of the element size, for ebml_End() */
+static size_t ebml_Start(struct ebml_writer *w, uint32_t i_id)
+{
+    ebml_PutId(w, i_id);
+    size_t i_offset = w->i_data;
+    ebml_Reserve(w, 8);
+    return i_offset;
+}
+
+static void ebml_End(struct ebml_writer *w, size_t i_offset)
+{
+    ebml_SetSize(&w->p_data[i_offset], w->i_data - i_offset - 8);
+}
+
+static void ebml_PutUint(struct ebml_writer *w, uint32_t i_id, uint64_t i_value)
+{
+    size_t el = ebml_Start(w, i_id);
+    SetQWBE(ebml_Reserve(w, 8), i_value);
+    ebml_End(w, el);
+}
+
+static void ebml_PutFloat(struct ebml_writer *w, uint32_t i_id, float f_value)
+{
+    uint32_t i_value;
+    memcpy(&i_value, &f_value, sizeof(i_value));
+    size_t el = ebml_Start(w, i_id);
+    SetDWBE(ebml_Reserve(w, 4), i_value);
+    ebml_End(w, el);
+}
+
+static void ebml_PutString(struct ebml_writer *w, uint32_t i_id, const char *psz)
+{
+    size_t el = ebml_Start(w, i_id);
+    memcpy(ebml_Reserve(w, strlen(psz)), psz, strlen(psz));
+    ebml_End(w, el);
+}
+
+static void mkv_PutTrack(struct ebml_writer *w, unsigned i_track, bool b_audio)
+{
+    size_t entry = ebml_Start(w, 0xAE);
+    ebml_PutUint(w, 0xD7, i_track);
+    ebml_PutUint(w, 0x73C5, i_track);
+    ebml_PutUint(w, 0x83, b_audio ? 2 : 1);
+    ebml_PutString(w, 0x86, b_audio ? "A_MPEG/L2" : "V_MPEG2");
+    if (b_audio)
+    {
+        size_t audio = ebml_Start(w, 0xE1);
+        ebml_PutFloat(w, 0xB5, 48000.f);
+        ebml_PutUint(w, 0x9F, 2);
+        ebml_End(w, audio);
+    }
+    else
+    {
+        size_t video = ebml_Start(w, 0xE0);
+        ebml_PutUint(w, 0xB0, 320);
+        ebml_PutUint(w, 0xBA, 240);
+        ebml_End(w, video);
+    }
+    ebml_End(w, entry);
+}
+
+static void mkv_PutSimpleBlock(struct ebml_writer *w, unsigned i_track,
+                               int16_t i_timecode, bool b_key, size_t i_size)
+{
+    size_t block = ebml_Start(w, 0xA3);
+    uint8_t *p = ebml_Reserve(w, 4 + i_size);
+    p[0] = 0x80 | i_track;
+    SetWBE(&p[1], i_timecode);
+    p[3] = b_key ? 0x80 : 0;
+    memset(&p[4], 0, i_size);
+    ebml_End(w, block);
+}
+
+static bool mkv_Flush(struct ebml_writer *w, FILE *f)
+{
+    bool b_ok = fwrite(w->p_data, 1, w->i_data, f) == w->i_data;
+    w->i_data = 0;
+    return b_ok;
+}
+
+static int generate_mkv(FILE *f, unsigned i_minutes, uint64_t *pi_size)
+{
+    struct ebml_writer w = { 0 };
+    const uint64_t i_duration_ms = (uint64_t) i_minutes * 60 * 1000;
+
+    size_t header = ebml_Start(&w, 0x1A45DFA3);
+    ebml_PutUint(&w, 0x4286, 1);
+    ebml_PutUint(&w, 0x42F7, 1);
+    ebml_PutUint(&w, 0x42F2, 4);
+    ebml_PutUint(&w, 0x42F3, 8);
+    ebml_PutString(&w, 0x4282, "matroska");
+    ebml_PutUint(&w, 0x4287, 4);
+    ebml_PutUint(&w, 0x4285, 2);
+    ebml_End(&w, header);
+
+    /* the segment size is written at the end */
+    size_t segment = ebml_Start(&w, 0x18538067);
+    const long i_segment_size_pos = segment;
+    const long i_segment_data = w.i_data;
+
+    size_t info = ebml_Start(&w, 0x1549A966);
+    ebml_PutUint(&w, 0x2AD7B1, 1000000);
+    ebml_PutFloat(&w, 0x4489, i_duration_ms);
+    ebml_PutString(&w, 0x4D80, "mkv_bench");
+    ebml_PutString(&w, 0x5741, "mkv_bench");
+    ebml_End(&w, info);
+
+    size_t tracks = ebml_Start(&w, 0x1654AE6B);
+    mkv_PutTrack(&w, 1, false);
+    mkv_PutTrack(&w, 2, true);
+    ebml_End(&w, tracks);
+
+    int i_ret = !mkv_Flush(&w, f);
+    uint64_t i_video = 0, i_audio = 0;
+    for (uint64_t i_time = 0; i_time < i_duration_ms && !i_ret;
+         i_time += GEN_CLUSTER_MS)
+    {
+        const uint64_t i_end = i_time + GEN_CLUSTER_MS;
+        size_t cluster = ebml_Start(&w, 0x1F43B675);
+        ebml_PutUint(&w, 0xE7, i_time);
+        for (;;)
+        {
+            uint64_t i_vtime = i_video * 1000 / GEN_FPS;
+            uint64_t i_atime = i_audio * GEN_AUDIO_FRAME_MS;
+            if (i_vtime >= i_end && i_atime >= i_end)
+                break;
+            if (i_vtime < i_end && (i_vtime <= i_atime || i_atime >= i_end))
+            {
+                /* one keyframe per cluster */
+                mkv_PutSimpleBlock(&w, 1, i_vtime - i_time,
+                                   i_vtime == i_time, GEN_VIDEO_SIZE);
+                i_video++;
+            }
+            else
+            {
+                mkv_PutSimpleBlock(&w, 2, i_atime - i_time, true,
+                                   GEN_AUDIO_SIZE);
+                i_audio++;
+            }
+        }
+        ebml_End(&w, cluster);
+        if (!mkv_Flush(&w, f))
+            i_ret = 1;
+    }
+
+    long i_size = ftell(f);
+    if (!i_ret && i_size >= i_segment_data)
+    {
+        uint8_t size[8];
+        ebml_SetSize(size, i_size - i_segment_data);
+        if (fseek(f, i_segment_size_pos, SEEK_SET) ||
+            fwrite(size, 1, sizeof(size), f) != sizeof(size) || fflush(f))
+            i_ret = 1;
+        *pi_size = i_size;
+    }
+    else
+        i_ret = 1;
+
+    free(w.p_data);
+    return i_ret;
+}
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    VLC_UNUSED(in); VLC_UNUSED(fmt);
+    return (es_out_id_t *) out;
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in); VLC_UNUSED(query); VLC_UNUSED(args);
+    return VLC_EGENERIC;
+}
+
+static void EsOutDestroy(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+/* Posted by the log callback when the indexer thread is done */
+static vlc_sem_t indexed;
+
+static void log_cb(void *data, int level, const libvlc_log_t *ctx,
+                   const char *fmt, va_list args)
+{
+    VLC_UNUSED(data); VLC_UNUSED(level); VLC_UNUSED(ctx); VLC_UNUSED(args);
+    if (!strncmp(fmt, "indexed ", 8))
+        vlc_sem_post(&indexed);
+}
+
+enum bench_case
+{
+    BENCH_NO_INDEX,
+    BENCH_INDEXING,
+    BENCH_INDEXED,
+};
+
+static int bench_seek(libvlc_instance_t *vlc, const char *psz_url,
+                      unsigned i_minutes, enum bench_case i_case)
+{
+    static const char *const names[] = {
+        [BENCH_NO_INDEX] = "no index",
+        [BENCH_INDEXING] = "seek while indexing",
+        [BENCH_INDEXED]  = "seek once indexed",
+    };
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    var_SetBool(obj, "mkv-index-clusters", i_case != BENCH_NO_INDEX);
+    vlc_sem_init(&indexed, 0);
+
+    stream_t *s = vlc_stream_NewURL(obj, psz_url);
+    if (!s)
+        return 1;
+
+    es_out_t out = { .cbs = &es_out_cbs };
+    vlc_tick_t i_start = vlc_tick_now();
+    demux_t *demux = demux_New(obj, "mkv", psz_url, s, &out);
+    if (!demux)
+    {
+        vlc_stream_Delete(s);
+        return 1;
+    }
+    vlc_tick_t i_open = vlc_tick_now() - i_start;
+
+    vlc_tick_t i_index = 0;
+    if (i_case == BENCH_INDEXED)
+    {
+        if (vlc_sem_timedwait(&indexed, i_start + VLC_TICK_FROM_SEC(60)))
+            fprintf(stderr, "the indexer didn't finish\n");
+        i_index = vlc_tick_now() - i_start;
+    }
+
+    i_start = vlc_tick_now();
+    int i_ret = demux_Control(demux, DEMUX_SET_TIME,
+                              VLC_TICK_FROM_SEC(i_minutes * 60 / 2), true);
+    vlc_tick_t i_seek = vlc_tick_now() - i_start;
+    if (i_ret == VLC_SUCCESS)
+        i_ret = demux_Demux(demux) == VLC_DEMUXER_SUCCESS ? VLC_SUCCESS
+                                                          : VLC_EGENERIC;
+
+    printf("%-20s open %7.3f s  seek %7.3f s", names[i_case],
+           secf_from_vlc_tick(i_open), secf_from_vlc_tick(i_seek));
+    if (i_case == BENCH_INDEXED)
+        printf("  (indexed in %.3f s)", secf_from_vlc_tick(i_index));
+    printf("\n");
+
+    demux_Delete(demux);
+    return i_ret != VLC_SUCCESS;
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned i_minutes = argc > 1 ? strtoul(argv[1], NULL, 0) : 60;
+
+    test_init();
+
+    char psz_path[] = "/tmp/vlc-mkv-bench-XXXXXX";
+    int fd = vlc_mkstemp(psz_path);
+    if (fd == -1)
+        return 1;
+    FILE *f = fdopen(fd, "wb");
+    uint64_t i_size = 0;
+    if (!f || generate_mkv(f, i_minutes, &i_size))
+    {
+        fprintf(stderr, "can't write the generated file\n");
+        if (f)
+            fclose(f);
+        else
+            close(fd);
+        unlink(psz_path);
+        return 1;
+    }
+    fclose(f);
+
+    char *psz_url = vlc_path2uri(psz_path, NULL);
+    libvlc_instance_t *vlc = psz_url ? libvlc_new(0, NULL) : NULL;
+    if (!vlc)
+    {
+        free(psz_url);
+        unlink(psz_path);
+        return 1;
+    }
+    libvlc_log_set(vlc, log_cb, NULL);
+    var_Create(vlc->p_libvlc_int, "mkv-index-clusters", VLC_VAR_BOOL);
+
+    printf("%u min, %.1f MiB, no Cues\n", i_minutes,
+           (double) i_size / (1 << 20));
+
+    int i_ret = bench_seek(vlc, psz_url, i_minutes, BENCH_NO_INDEX)
+             || bench_seek(vlc, psz_url, i_minutes, BENCH_INDEXING)
+             || bench_seek(vlc, psz_url, i_minutes, BENCH_INDEXED);
+    if (i_ret)
+        fprintf(stderr, "can't open or seek the generated file\n");
+
+    libvlc_release(vlc);
+    free(psz_url);
+    unlink(psz_path);
+    return i_ret;
+}
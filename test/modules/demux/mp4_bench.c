@@ -0,0 +1,854 @@
+/*****************************************************************************
+ * mp4_bench.c: MP4 demuxer benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_modules_demux_mp4_bench [tables|fragments] [hours]
+ *
+ * tables: generates a 25 fps video track of 24 hours by default, with a
+ * composition offset per sample, as 1 sample per chunk and as 25 samples per
+ * chunk, and measures the time to open the MP4 demuxer on it and the resident
+ * memory it keeps once opened. Only the sample tables are meaningful: the
+ * samples are all 1 or 2 bytes long.
+ *
+ * fragments: generates a fragmented file of 1 hour by default, with a video
+ * and an audio track and no index, or a sidx every 30 fragments, and measures
+ * the first seek to the middle of the file. The file is served by a slow
+ * seeking stream, which only stores the boxes headers and reads the media
+ * data as zeros. The reported latency adds 50 ms per range request to the
+ * time spent in the demuxer.
+ *
+ * Both run when no mode is given. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_stream.h>
+#include <vlc_tick.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define GEN_FPS 25
+
+struct mp4_writer
+{
+    uint8_t *p_data;
+    size_t   i_data;
+    size_t   i_alloc;
+};
+
+static uint8_t *mp4_Reserve(struct mp4_writer *w, size_t i_size)
+{
+    if (w->i_data + i_size > w->i_alloc)
+    {
+        size_t i_alloc = __MAX(w->i_alloc * 2, w->i_data + i_size);
+        uint8_t *p_realloc = realloc(w->p_data, i_alloc);
+        if (!p_realloc)
+            abort();
+        w->p_data = p_realloc;
+        w->i_alloc = i_alloc;
+    }
+    uint8_t *p = &w->p_data[w->i_data];
+    w->i_data += i_size;
+    return p;
+}
+
+static void mp4_Put8(struct mp4_writer *w, uint8_t i)
+{
+    *mp4_Reserve(w, 1) = i;
+}
+
+static void mp4_Put16(struct mp4_writer *w, uint16_t i)
+{
+    SetWBE(mp4_Reserve(w, 2), i);
+}
+
+static void mp4_Put32(struct mp4_writer *w, uint32_t i)
+{
+    SetDWBE(mp4_Reserve(w, 4), i);
+}
+
+static void mp4_PutFourcc(struct mp4_writer *w, const char *psz)
+{
+    memcpy(mp4_Reserve(w, 4), psz, 4);
+}
+
+static void mp4_PutZeros(struct mp4_writer *w, size_t i_size)
+{
+    memset(mp4_Reserve(w, i_size), 0, i_size);
+}
+
+static void mp4_PutMatrix(struct mp4_writer *w)
+{
+    static const uint32_t matrix[9] = {
+        0x00010000, 0, 0, 0, 0x00010000, 0, 0, 0, 0x40000000,
+    };
+    for (size_t i = 0; i < ARRAY_SIZE(matrix); i++)
+        mp4_Put32(w, matrix[i]);
+}
+
+/* Returns the offset of the box, for mp4_BoxEnd() to write its size */
+static size_t mp4_BoxStart(struct mp4_writer *w, const char *psz_type)
+{
+    size_t i_offset = w->i_data;
+    mp4_Put32(w, 0);
+    mp4_PutFourcc(w, psz_type);
+    return i_offset;
+}
+
+static size_t mp4_FullBoxStart(struct mp4_writer *w, const char *psz_type,
+                               uint8_t i_version, uint32_t i_flags)
+{
+    size_t i_offset = mp4_BoxStart(w, psz_type);
+    mp4_Put32(w, ((uint32_t)i_version << 24) | i_flags);
+    return i_offset;
+}
+
+static void mp4_BoxEnd(struct mp4_writer *w, size_t i_offset)
+{
+    SetDWBE(&w->p_data[i_offset], w->i_data - i_offset);
+}
+
+static unsigned sample_size(uint32_t i)
+{
+    return 1 + (i & 1);
+}
+
+struct mp4_track
+{
+    uint32_t    i_id;
+    const char *psz_handler; /* "vide" or "soun" */
+    uint32_t    i_timescale;
+    uint32_t    i_duration; /* in track timescale */
+};
+
+static void mp4_PutSampleEntry(struct mp4_writer *w,
+                               const struct mp4_track *track)
+{
+    size_t stsd = mp4_FullBoxStart(w, "stsd", 0, 0);
+    mp4_Put32(w, 1);
+    if (!strcmp(track->psz_handler, "soun"))
+    {
+        size_t entry = mp4_BoxStart(w, "mp4a");
+        mp4_PutZeros(w, 6);
+        mp4_Put16(w, 1); /* data reference index */
+        mp4_PutZeros(w, 8);
+        mp4_Put16(w, 2); /* channels */
+        mp4_Put16(w, 16);
+        mp4_PutZeros(w, 4);
+        mp4_Put32(w, track->i_timescale << 16);
+        mp4_BoxEnd(w, entry);
+    }
+    else
+    {
+        size_t entry = mp4_BoxStart(w, "mp4v");
+        mp4_PutZeros(w, 6);
+        mp4_Put16(w, 1); /* data reference index */
+        mp4_PutZeros(w, 16);
+        mp4_Put16(w, 320);
+        mp4_Put16(w, 240);
+        mp4_Put32(w, 0x00480000);
+        mp4_Put32(w, 0x00480000);
+        mp4_Put32(w, 0);
+        mp4_Put16(w, 1); /* frame count */
+        mp4_PutZeros(w, 32);
+        mp4_Put16(w, 0x18);
+        mp4_Put16(w, 0xffff);
+        mp4_BoxEnd(w, entry);
+    }
+    mp4_BoxEnd(w, stsd);
+}
+
+static void mp4_PutSampleTables(struct mp4_writer *w,
+                                const struct mp4_track *track,
+                                uint32_t i_samples, uint32_t i_per_chunk,
+                                size_t *pi_stco)
+{
+    mp4_PutSampleEntry(w, track);
+
+    size_t stts = mp4_FullBoxStart(w, "stts", 0, 0);
+    mp4_Put32(w, i_samples ? 1 : 0);
+    if (i_samples)
+    {
+        mp4_Put32(w, i_samples);
+        mp4_Put32(w, 1);
+    }
+    mp4_BoxEnd(w, stts);
+
+    /* B frames like offsets, changing on every sample */
+    if (i_samples)
+    {
+        size_t ctts = mp4_FullBoxStart(w, "ctts", 0, 0);
+        mp4_Put32(w, i_samples);
+        for (uint32_t i = 0; i < i_samples; i++)
+        {
+            mp4_Put32(w, 1);
+            mp4_Put32(w, 1 + i % 3);
+        }
+        mp4_BoxEnd(w, ctts);
+    }
+
+    size_t stsc = mp4_FullBoxStart(w, "stsc", 0, 0);
+    mp4_Put32(w, i_samples ? 1 : 0);
+    if (i_samples)
+    {
+        mp4_Put32(w, 1);
+        mp4_Put32(w, i_per_chunk);
+        mp4_Put32(w, 1);
+    }
+    mp4_BoxEnd(w, stsc);
+
+    size_t stsz = mp4_FullBoxStart(w, "stsz", 0, 0);
+    mp4_Put32(w, 0);
+    mp4_Put32(w, i_samples);
+    for (uint32_t i = 0; i < i_samples; i++)
+        mp4_Put32(w, sample_size(i));
+    mp4_BoxEnd(w, stsz);
+
+    /* offsets are written once the mdat position is known */
+    uint32_t i_chunks = i_samples ? (i_samples + i_per_chunk - 1) / i_per_chunk
+                                  : 0;
+    size_t stco = mp4_FullBoxStart(w, "stco", 0, 0);
+    mp4_Put32(w, i_chunks);
+    *pi_stco = w->i_data;
+    mp4_PutZeros(w, 4 * i_chunks);
+    mp4_BoxEnd(w, stco);
+}
+
+static void mp4_PutFtyp(struct mp4_writer *w)
+{
+    size_t ftyp = mp4_BoxStart(w, "ftyp");
+    mp4_PutFourcc(w, "isom");
+    mp4_Put32(w, 0x200);
+    mp4_PutFourcc(w, "isom");
+    mp4_PutFourcc(w, "mp41");
+    mp4_BoxEnd(w, ftyp);
+}
+
+static void mp4_PutMvhd(struct mp4_writer *w, uint32_t i_duration_ms,
+                        uint32_t i_next_track_id)
+{
+    size_t mvhd = mp4_FullBoxStart(w, "mvhd", 0, 0);
+    mp4_PutZeros(w, 8);
+    mp4_Put32(w, 1000);
+    mp4_Put32(w, i_duration_ms);
+    mp4_Put32(w, 0x00010000);
+    mp4_Put16(w, 0x0100);
+    mp4_PutZeros(w, 10);
+    mp4_PutMatrix(w);
+    mp4_PutZeros(w, 24);
+    mp4_Put32(w, i_next_track_id);
+    mp4_BoxEnd(w, mvhd);
+}
+
+static void mp4_PutTrak(struct mp4_writer *w, const struct mp4_track *track,
+                        uint32_t i_duration_ms, uint32_t i_samples,
+                        uint32_t i_per_chunk, size_t *pi_stco)
+{
+    const bool b_audio = !strcmp(track->psz_handler, "soun");
+    size_t trak = mp4_BoxStart(w, "trak");
+
+    size_t tkhd = mp4_FullBoxStart(w, "tkhd", 0, 7);
+    mp4_PutZeros(w, 8);
+    mp4_Put32(w, track->i_id);
+    mp4_Put32(w, 0);
+    mp4_Put32(w, i_duration_ms);
+    mp4_PutZeros(w, 8);
+    mp4_Put16(w, 0);
+    mp4_Put16(w, 0);
+    mp4_Put16(w, b_audio ? 0x0100 : 0); /* volume */
+    mp4_Put16(w, 0);
+    mp4_PutMatrix(w);
+    mp4_Put32(w, b_audio ? 0 : 320 << 16);
+    mp4_Put32(w, b_audio ? 0 : 240 << 16);
+    mp4_BoxEnd(w, tkhd);
+
+    size_t mdia = mp4_BoxStart(w, "mdia");
+    size_t mdhd = mp4_FullBoxStart(w, "mdhd", 0, 0);
+    mp4_PutZeros(w, 8);
+    mp4_Put32(w, track->i_timescale);
+    mp4_Put32(w, track->i_duration);
+    mp4_Put16(w, 0x55c4); /* und */
+    mp4_Put16(w, 0);
+    mp4_BoxEnd(w, mdhd);
+
+    size_t hdlr = mp4_FullBoxStart(w, "hdlr", 0, 0);
+    mp4_Put32(w, 0);
+    mp4_PutFourcc(w, track->psz_handler);
+    mp4_PutZeros(w, 12);
+    mp4_Put8(w, 0);
+    mp4_BoxEnd(w, hdlr);
+
+    size_t minf = mp4_BoxStart(w, "minf");
+    if (b_audio)
+    {
+        size_t smhd = mp4_FullBoxStart(w, "smhd", 0, 0);
+        mp4_PutZeros(w, 4);
+        mp4_BoxEnd(w, smhd);
+    }
+    else
+    {
+        size_t vmhd = mp4_FullBoxStart(w, "vmhd", 0, 1);
+        mp4_PutZeros(w, 8);
+        mp4_BoxEnd(w, vmhd);
+    }
+
+    size_t dinf = mp4_BoxStart(w, "dinf");
+    size_t dref = mp4_FullBoxStart(w, "dref", 0, 0);
+    mp4_Put32(w, 1);
+    mp4_BoxEnd(w, mp4_FullBoxStart(w, "url ", 0, 1));
+    mp4_BoxEnd(w, dref);
+    mp4_BoxEnd(w, dinf);
+
+    size_t stbl = mp4_BoxStart(w, "stbl");
+    mp4_PutSampleTables(w, track, i_samples, i_per_chunk, pi_stco);
+    mp4_BoxEnd(w, stbl);
+
+    mp4_BoxEnd(w, minf);
+    mp4_BoxEnd(w, mdia);
+    mp4_BoxEnd(w, trak);
+}
+
+static uint8_t *generate_mp4(unsigned i_hours, uint32_t i_per_chunk,
+                             size_t *pi_data)
+{
+    struct mp4_writer w = { 0 };
+    const uint32_t i_samples = i_hours * 3600 * GEN_FPS;
+    const uint32_t i_duration_ms = i_hours * 3600 * 1000;
+    const struct mp4_track video = { 1, "vide", GEN_FPS, i_samples };
+
+    mp4_PutFtyp(&w);
+
+    size_t moov = mp4_BoxStart(&w, "moov");
+    mp4_PutMvhd(&w, i_duration_ms, 2);
+    size_t i_stco;
+    mp4_PutTrak(&w, &video, i_duration_ms, i_samples, i_per_chunk, &i_stco);
+    mp4_BoxEnd(&w, moov);
+
+    size_t mdat = mp4_BoxStart(&w, "mdat");
+    size_t i_offset = w.i_data;
+    for (uint32_t i = 0; i < i_samples; i++)
+    {
+        if (i % i_per_chunk == 0)
+            SetDWBE(&w.p_data[i_stco + 4 * (i / i_per_chunk)], i_offset);
+        i_offset += sample_size(i);
+    }
+    mp4_PutZeros(&w, i_offset - w.i_data);
+    mp4_BoxEnd(&w, mdat);
+
+    *pi_data = w.i_data;
+    return w.p_data;
+}
+
+static size_t get_rss(void)
+{
+    FILE *f = fopen("/proc/self/statm", "r");
+    if (!f)
+        return 0;
+    unsigned long i_size, i_resident = 0;
+    if (fscanf(f, "%lu %lu", &i_size, &i_resident) != 2)
+        i_resident = 0;
+    fclose(f);
+    return i_resident * sysconf(_SC_PAGESIZE);
+}
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    VLC_UNUSED(in); VLC_UNUSED(fmt);
+    return (es_out_id_t *) out;
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in); VLC_UNUSED(query); VLC_UNUSED(args);
+    return VLC_EGENERIC;
+}
+
+static void EsOutDestroy(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+static int bench_open(libvlc_instance_t *vlc, unsigned i_hours,
+                      uint32_t i_per_chunk)
+{
+    size_t i_data;
+    uint8_t *p_data = generate_mp4(i_hours, i_per_chunk, &i_data);
+
+    es_out_t out = { .cbs = &es_out_cbs };
+    stream_t *s = vlc_stream_MemoryNew(vlc->p_libvlc_int, p_data, i_data,
+                                       false);
+    if (!s)
+    {
+        free(p_data);
+        return 1;
+    }
+
+    size_t i_rss = get_rss();
+    vlc_tick_t i_start = vlc_tick_now();
+    demux_t *demux = demux_New(VLC_OBJECT(vlc->p_libvlc_int), "mp4",
+                               INPUT_ITEM_URI_NOP, s, &out);
+    vlc_tick_t i_elapsed = vlc_tick_now() - i_start;
+    if (!demux)
+    {
+        vlc_stream_Delete(s);
+        return 1;
+    }
+
+    printf("%2u sample(s)/chunk  %zu bytes  open %7.3f s  rss +%6.1f MiB\n",
+           i_per_chunk, i_data, secf_from_vlc_tick(i_elapsed),
+           (double) (get_rss() - i_rss) / (1 << 20));
+
+    demux_Delete(demux);
+    return 0;
+}
+
+/* A fragmented file, where only the boxes headers are stored: the media
+ * data in between is read as zeros */
+struct frag_file
+{
+    struct mp4_writer w;
+    struct frag_extent
+    {
+        uint64_t i_pos;
+        size_t   i_offset; /* in w */
+        size_t   i_size;
+    } *p_extents;
+    size_t   i_extents;
+    size_t   i_alloc;
+    size_t   i_flushed; /* bytes of w already placed in the file */
+    uint64_t i_size;
+};
+
+/* Places the headers written since the last call at the end of the file */
+static void frag_Flush(struct frag_file *f)
+{
+    if (f->i_extents == f->i_alloc)
+    {
+        size_t i_alloc = __MAX(f->i_alloc * 2, 64);
+        void *p_realloc = realloc(f->p_extents,
+                                  i_alloc * sizeof(*f->p_extents));
+        if (!p_realloc)
+            abort();
+        f->p_extents = p_realloc;
+        f->i_alloc = i_alloc;
+    }
+    struct frag_extent *e = &f->p_extents[f->i_extents++];
+    e->i_pos = f->i_size;
+    e->i_offset = f->i_flushed;
+    e->i_size = f->w.i_data - f->i_flushed;
+    f->i_size += e->i_size;
+    f->i_flushed = f->w.i_data;
+}
+
+static void frag_Hole(struct frag_file *f, uint64_t i_size)
+{
+    f->i_size += i_size;
+}
+
+struct frag_params
+{
+    const char *psz_name;
+    unsigned    i_fragment_ms;
+    uint32_t    i_fragment_bytes;
+    unsigned    i_sidx_every; /* fragments per sidx, 0 for none */
+};
+
+#define FRAG_AUDIO_RATE  48000
+#define FRAG_AUDIO_FRAME 1024
+
+static void frag_PutTraf(struct mp4_writer *w, uint32_t i_track_id,
+                         uint64_t i_decode_time, uint32_t i_samples,
+                         uint32_t i_duration, uint32_t i_bytes,
+                         size_t *pi_data_offset)
+{
+    size_t traf = mp4_BoxStart(w, "traf");
+
+    size_t tfhd = mp4_FullBoxStart(w, "tfhd", 0, 0x020000);
+    mp4_Put32(w, i_track_id);
+    mp4_BoxEnd(w, tfhd);
+
+    size_t tfdt = mp4_FullBoxStart(w, "tfdt", 1, 0);
+    mp4_Put32(w, i_decode_time >> 32);
+    mp4_Put32(w, i_decode_time);
+    mp4_BoxEnd(w, tfdt);
+
+    /* data offset, sample duration and size */
+    size_t trun = mp4_FullBoxStart(w, "trun", 0, 0x301);
+    mp4_Put32(w, i_samples);
+    *pi_data_offset = w->i_data;
+    mp4_Put32(w, 0);
+    for (uint32_t i = 0; i < i_samples; i++)
+    {
+        mp4_Put32(w, i_duration);
+        mp4_Put32(w, i_bytes / i_samples + (i < i_bytes % i_samples));
+    }
+    mp4_BoxEnd(w, trun);
+
+    mp4_BoxEnd(w, traf);
+}
+
+static void generate_fragments(struct frag_file *f, unsigned i_hours,
+                               const struct frag_params *params)
+{
+    struct mp4_writer *w = &f->w;
+    const uint32_t i_duration_ms = i_hours * 3600 * 1000;
+    const uint32_t i_fragments = i_duration_ms / params->i_fragment_ms;
+    const struct mp4_track video = { 1, "vide", GEN_FPS, 0 };
+    const struct mp4_track audio = { 2, "soun", FRAG_AUDIO_RATE, 0 };
+
+    mp4_PutFtyp(w);
+
+    size_t moov = mp4_BoxStart(w, "moov");
+    mp4_PutMvhd(w, 0, 3);
+    size_t i_stco;
+    mp4_PutTrak(w, &video, 0, 0, 1, &i_stco);
+    mp4_PutTrak(w, &audio, 0, 0, 1, &i_stco);
+
+    size_t mvex = mp4_BoxStart(w, "mvex");
+    size_t mehd = mp4_FullBoxStart(w, "mehd", 0, 0);
+    mp4_Put32(w, i_duration_ms);
+    mp4_BoxEnd(w, mehd);
+    for (uint32_t i_id = 1; i_id <= 2; i_id++)
+    {
+        size_t trex = mp4_FullBoxStart(w, "trex", 0, 0);
+        mp4_Put32(w, i_id);
+        mp4_Put32(w, 1);
+        mp4_PutZeros(w, 12);
+        mp4_BoxEnd(w, trex);
+    }
+    mp4_BoxEnd(w, mvex);
+    mp4_BoxEnd(w, moov);
+
+    uint64_t i_audio_time = 0;
+    size_t i_sidx_ref = 0;
+    for (uint32_t i = 0; i < i_fragments; i++)
+    {
+        if (params->i_sidx_every && i % params->i_sidx_every == 0)
+        {
+            /* the referenced sizes are written along the fragments */
+            uint32_t i_count = __MIN(params->i_sidx_every, i_fragments - i);
+            size_t sidx = mp4_FullBoxStart(w, "sidx", 0, 0);
+            mp4_Put32(w, 1);
+            mp4_Put32(w, 1000);
+            mp4_Put32(w, i * params->i_fragment_ms);
+            mp4_Put32(w, 0);
+            mp4_Put16(w, 0);
+            mp4_Put16(w, i_count);
+            i_sidx_ref = w->i_data;
+            for (uint32_t j = 0; j < i_count; j++)
+            {
+                mp4_Put32(w, 0);
+                mp4_Put32(w, params->i_fragment_ms);
+                mp4_Put32(w, 0x90000000); /* starts with SAP type 1 */
+            }
+            mp4_BoxEnd(w, sidx);
+        }
+
+        const uint64_t i_end_ms = (uint64_t) (i + 1) * params->i_fragment_ms;
+        const uint32_t i_video_samples = params->i_fragment_ms * GEN_FPS / 1000;
+        const uint64_t i_audio_end = i_end_ms * FRAG_AUDIO_RATE / 1000;
+        const uint32_t i_audio_samples =
+            (i_audio_end - i_audio_time + FRAG_AUDIO_FRAME - 1) / FRAG_AUDIO_FRAME;
+        const uint32_t i_audio_bytes = params->i_fragment_bytes / 16;
+        const uint32_t i_video_bytes = params->i_fragment_bytes - i_audio_bytes;
+
+        size_t i_moof_pos = w->i_data;
+        size_t moof = mp4_BoxStart(w, "moof");
+        size_t mfhd = mp4_FullBoxStart(w, "mfhd", 0, 0);
+        mp4_Put32(w, i + 1);
+        mp4_BoxEnd(w, mfhd);
+        size_t i_video_offset, i_audio_offset;
+        frag_PutTraf(w, 1, (uint64_t) i * i_video_samples, i_video_samples,
+                     1, i_video_bytes, &i_video_offset);
+        frag_PutTraf(w, 2, i_audio_time, i_audio_samples,
+                     FRAG_AUDIO_FRAME, i_audio_bytes, &i_audio_offset);
+        mp4_BoxEnd(w, moof);
+        i_audio_time += (uint64_t) i_audio_samples * FRAG_AUDIO_FRAME;
+
+        const uint32_t i_moof_size = w->i_data - i_moof_pos;
+        SetDWBE(&w->p_data[i_video_offset], i_moof_size + 8);
+        SetDWBE(&w->p_data[i_audio_offset], i_moof_size + 8 + i_video_bytes);
+
+        mp4_Put32(w, 8 + params->i_fragment_bytes);
+        mp4_PutFourcc(w, "mdat");
+        frag_Flush(f);
+        frag_Hole(f, params->i_fragment_bytes);
+
+        if (params->i_sidx_every)
+        {
+            SetDWBE(&w->p_data[i_sidx_ref],
+                    i_moof_size + 8 + params->i_fragment_bytes);
+            i_sidx_ref += 12;
+        }
+    }
+}
+
+struct frag_stream
+{
+    const struct frag_file *f;
+    uint64_t i_pos;
+    size_t   i_extent; /* first extent that may contain i_pos */
+    unsigned i_requests;
+    uint64_t i_read;
+};
+
+static ssize_t FragStreamRead(stream_t *s, void *buf, size_t i_len)
+{
+    struct frag_stream *sys = s->p_sys;
+    const struct frag_file *f = sys->f;
+
+    if (sys->i_pos >= f->i_size)
+        return 0;
+    i_len = __MIN(i_len, f->i_size - sys->i_pos);
+
+    while (sys->i_extent < f->i_extents &&
+           f->p_extents[sys->i_extent].i_pos +
+           f->p_extents[sys->i_extent].i_size <= sys->i_pos)
+        sys->i_extent++;
+
+    const struct frag_extent *e = sys->i_extent < f->i_extents
+                                ? &f->p_extents[sys->i_extent] : NULL;
+    if (e && e->i_pos <= sys->i_pos)
+    {
+        size_t i_skip = sys->i_pos - e->i_pos;
+        i_len = __MIN(i_len, e->i_size - i_skip);
+        memcpy(buf, &f->w.p_data[e->i_offset + i_skip], i_len);
+    }
+    else
+    {
+        if (e)
+            i_len = __MIN(i_len, e->i_pos - sys->i_pos);
+        memset(buf, 0, i_len);
+    }
+
+    sys->i_pos += i_len;
+    sys->i_read += i_len;
+    return i_len;
+}
+
+static int FragStreamSeek(stream_t *s, uint64_t i_pos)
+{
+    struct frag_stream *sys = s->p_sys;
+    if (i_pos == sys->i_pos)
+        return VLC_SUCCESS;
+
+    /* any other position needs a new range request */
+    sys->i_requests++;
+    if (i_pos < sys->i_pos)
+        sys->i_extent = 0;
+    sys->i_pos = i_pos;
+    return VLC_SUCCESS;
+}
+
+static int FragStreamControl(stream_t *s, int i_query, va_list args)
+{
+    struct frag_stream *sys = s->p_sys;
+    switch (i_query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case STREAM_CAN_FASTSEEK:
+            *va_arg(args, bool *) = false;
+            return VLC_SUCCESS;
+        case STREAM_GET_SIZE:
+            *va_arg(args, uint64_t *) = sys->f->i_size;
+            return VLC_SUCCESS;
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) = DEFAULT_PTS_DELAY;
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static void FragStreamDestroy(stream_t *s)
+{
+    VLC_UNUSED(s);
+}
+
+/* Resets the peak resident size, and returns the current one in kB */
+static unsigned long reset_peak_rss(void)
+{
+    FILE *f = fopen("/proc/self/clear_refs", "w");
+    if (f)
+    {
+        fputs("5", f);
+        fclose(f);
+    }
+    return get_rss() / 1024;
+}
+
+static unsigned long get_peak_rss(void)
+{
+    FILE *f = fopen("/proc/self/status", "r");
+    if (!f)
+        return 0;
+    char line[128];
+    unsigned long i_hwm = 0;
+    while (fgets(line, sizeof(line), f))
+        if (sscanf(line, "VmHWM: %lu kB", &i_hwm) == 1)
+            break;
+    fclose(f);
+    return i_hwm;
+}
+
+#define FRAG_REQUEST_LATENCY VLC_TICK_FROM_MS(50)
+
+static void frag_report(const char *psz_step, const struct frag_stream *sys,
+                        unsigned i_requests, uint64_t i_read,
+                        vlc_tick_t i_elapsed)
+{
+    i_requests = sys->i_requests - i_requests;
+    i_read = sys->i_read - i_read;
+    printf("  %-5s %5u request(s) %9.1f MiB read %8.3f s  latency %8.3f s\n",
+           psz_step, i_requests, (double) i_read / (1 << 20),
+           secf_from_vlc_tick(i_elapsed),
+           secf_from_vlc_tick(i_elapsed + i_requests * FRAG_REQUEST_LATENCY));
+}
+
+static int bench_seek(libvlc_instance_t *vlc, unsigned i_hours,
+                      const struct frag_params *params)
+{
+    struct frag_file f = { 0 };
+    generate_fragments(&f, i_hours, params);
+
+    struct frag_stream sys = { .f = &f };
+    stream_t *s = vlc_stream_CommonNew(VLC_OBJECT(vlc->p_libvlc_int),
+                                       FragStreamDestroy);
+    if (!s)
+        goto error;
+    s->p_sys = &sys;
+    s->pf_read = FragStreamRead;
+    s->pf_seek = FragStreamSeek;
+    s->pf_control = FragStreamControl;
+
+    printf("%s: %u fragments, %.1f MiB, %zu bytes of headers\n",
+           params->psz_name, i_hours * 3600 * 1000 / params->i_fragment_ms,
+           (double) f.i_size / (1 << 20), f.w.i_data);
+
+    es_out_t out = { .cbs = &es_out_cbs };
+    vlc_tick_t i_start = vlc_tick_now();
+    demux_t *demux = demux_New(VLC_OBJECT(vlc->p_libvlc_int), "mp4",
+                               INPUT_ITEM_URI_NOP, s, &out);
+    if (!demux)
+    {
+        vlc_stream_Delete(s);
+        goto error;
+    }
+    frag_report("open", &sys, 0, 0, vlc_tick_now() - i_start);
+
+    unsigned i_requests = sys.i_requests;
+    uint64_t i_read = sys.i_read;
+    unsigned long i_rss = reset_peak_rss();
+    i_start = vlc_tick_now();
+    int i_ret = demux_Control(demux, DEMUX_SET_TIME,
+                              VLC_TICK_FROM_SEC(i_hours * 3600 / 2), false);
+    vlc_tick_t i_elapsed = vlc_tick_now() - i_start;
+    unsigned long i_peak = get_peak_rss();
+    if (i_ret == VLC_SUCCESS)
+        i_ret = demux_Demux(demux) == VLC_DEMUXER_SUCCESS ? VLC_SUCCESS
+                                                          : VLC_EGENERIC;
+    frag_report("seek", &sys, i_requests, i_read, i_elapsed);
+    printf("  peak memory +%.1f MiB\n",
+           (double) (i_peak > i_rss ? i_peak - i_rss : 0) / 1024);
+
+    demux_Delete(demux);
+    free(f.w.p_data);
+    free(f.p_extents);
+    return i_ret != VLC_SUCCESS;
+
+error:
+    free(f.w.p_data);
+    free(f.p_extents);
+    return 1;
+}
+
+static const struct frag_params frag_cases[] =
+{
+    { "2s fragments, no index",     2000, 1 << 20, 0 },
+    { "2s fragments, sidx/30",      2000, 1 << 20, 30 },
+    { "200ms fragments, no index",   200, 40 << 10, 0 },
+};
+
+int main(int argc, char *argv[])
+{
+    const char *psz_mode = argc > 1 ? argv[1] : NULL;
+    unsigned i_hours = argc > 2 ? strtoul(argv[2], NULL, 0) : 0;
+    bool b_tables = !psz_mode || !strcmp(psz_mode, "tables");
+    bool b_fragments = !psz_mode || !strcmp(psz_mode, "fragments");
+    if (!b_tables && !b_fragments)
+    {
+        fprintf(stderr, "usage: %s [tables|fragments] [hours]\n", argv[0]);
+        return 1;
+    }
+
+    test_init();
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (!vlc)
+        return 1;
+
+    int i_ret = 0;
+    if (b_tables)
+        i_ret = bench_open(vlc, i_hours ? i_hours : 24, 1)
+             || bench_open(vlc, i_hours ? i_hours : 24, 25);
+    for (size_t i = 0; b_fragments && !i_ret && i < ARRAY_SIZE(frag_cases); i++)
+        i_ret = bench_seek(vlc, i_hours ? i_hours : 1, &frag_cases[i]);
+    if (i_ret)
+        fprintf(stderr, "can't open or seek the generated file\n");
+
+    libvlc_release(vlc);
+    return i_ret;
+}
@@ -0,0 +1,415 @@
+/*****************************************************************************
+ * ogg_bench.c: Ogg demuxer seek benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_modules_demux_ogg_bench [minutes...]
+ *
+ * Generates VBR Opus files of 5, 40 and 320 minutes by default, and measures
+ * the cost of random seeks against the file length, by bisection and through
+ * the background seek index. Reads, seeks and bytes are counted on the
+ * demuxer stream, which is served from memory; the seek index thread reads
+ * the same file written to /tmp. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_fs.h>
+#include <vlc_stream.h>
+#include <vlc_tick.h>
+#include <vlc_url.h>
+#include <vlc_variables.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define GEN_RATE             48000
+#define GEN_PACKET_SAMPLES   960 /* 20 ms */
+#define GEN_PACKETS_PER_PAGE 25
+#define GEN_SERIAL           0x1234
+
+#define BENCH_SEEKS 200
+
+struct ogg_writer
+{
+    uint8_t *p_data;
+    size_t   i_data;
+    size_t   i_alloc;
+    uint32_t i_sequence;
+};
+
+static uint32_t crc_table[256];
+
+static void ogg_InitCrc(void)
+{
+    for (uint32_t i = 0; i < 256; i++)
+    {
+        uint32_t r = i << 24;
+        for (int j = 0; j < 8; j++)
+            r = (r & 0x80000000) ? (r << 1) ^ 0x04c11db7 : r << 1;
+        crc_table[i] = r;
+    }
+}
+
+static uint8_t *ogg_Reserve(struct ogg_writer *w, size_t i_size)
+{
+    if (w->i_data + i_size > w->i_alloc)
+    {
+        size_t i_alloc = __MAX(w->i_alloc * 2, w->i_data + i_size);
+        uint8_t *p_realloc = realloc(w->p_data, i_alloc);
+        if (!p_realloc)
+            abort();
+        w->p_data = p_realloc;
+        w->i_alloc = i_alloc;
+    }
+    uint8_t *p = &w->p_data[w->i_data];
+    w->i_data += i_size;
+    return p;
+}
+
+/* Writes a page holding whole packets */
+static void ogg_PutPage(struct ogg_writer *w, uint8_t i_flags, int64_t i_granule,
+                        const uint8_t *const *pp_packets, const size_t *pi_sizes,
+                        unsigned i_packets)
+{
+    unsigned i_segments = 0;
+    size_t i_body = 0;
+    for (unsigned i = 0; i < i_packets; i++)
+    {
+        i_segments += pi_sizes[i] / 255 + 1;
+        i_body += pi_sizes[i];
+    }
+
+    size_t i_page = w->i_data;
+    uint8_t *p = ogg_Reserve(w, 27 + i_segments + i_body);
+    memcpy(p, "OggS", 4);
+    p[4] = 0;
+    p[5] = i_flags;
+    SetQWLE(&p[6], i_granule);
+    SetDWLE(&p[14], GEN_SERIAL);
+    SetDWLE(&p[18], w->i_sequence++);
+    SetDWLE(&p[22], 0);
+    p[26] = i_segments;
+
+    uint8_t *p_lacing = &p[27];
+    uint8_t *p_body = &p[27 + i_segments];
+    for (unsigned i = 0; i < i_packets; i++)
+    {
+        for (size_t i_left = pi_sizes[i]; ; i_left -= 255)
+        {
+            *p_lacing++ = __MIN(i_left, 255);
+            if (i_left < 255)
+                break;
+        }
+        memcpy(p_body, pp_packets[i], pi_sizes[i]);
+        p_body += pi_sizes[i];
+    }
+
+    uint32_t i_crc = 0;
+    for (size_t i = i_page; i < w->i_data; i++)
+        i_crc = (i_crc << 8) ^ crc_table[(i_crc >> 24) ^ w->p_data[i]];
+    SetDWLE(&w->p_data[i_page + 22], i_crc);
+}
+
+static uint8_t *generate_ogg(unsigned i_minutes, size_t *pi_data)
+{
+    struct ogg_writer w = { 0 };
+
+    uint8_t head[19] = "OpusHead";
+    head[8] = 1; /* version */
+    head[9] = 2; /* channels */
+    SetWLE(&head[10], 0); /* pre-skip */
+    SetDWLE(&head[12], GEN_RATE);
+    SetWLE(&head[16], 0); /* gain */
+    head[18] = 0; /* mapping family */
+    const uint8_t *p_head = head;
+    size_t i_head = sizeof(head);
+    ogg_PutPage(&w, 0x02, 0, &p_head, &i_head, 1);
+
+    static const uint8_t tags[] = "OpusTags\x09\0\0\0ogg_bench\0\0\0\0";
+    const uint8_t *p_tags = tags;
+    size_t i_tags = sizeof(tags) - 1;
+    ogg_PutPage(&w, 0, 0, &p_tags, &i_tags, 1);
+
+    /* 20 ms SILK packets of varying sizes */
+    uint8_t packet[254] = { 0x08 };
+    const uint8_t *pp_packets[GEN_PACKETS_PER_PAGE];
+    size_t pi_sizes[GEN_PACKETS_PER_PAGE];
+    for (unsigned i = 0; i < GEN_PACKETS_PER_PAGE; i++)
+        pp_packets[i] = packet;
+
+    const int64_t i_total = (int64_t) i_minutes * 60 * GEN_RATE;
+    uint32_t i_seed = 1;
+    for (int64_t i_granule = 0; i_granule < i_total; )
+    {
+        unsigned i_packets = 0;
+        while (i_packets < GEN_PACKETS_PER_PAGE && i_granule < i_total)
+        {
+            i_seed = i_seed * 1103515245 + 12345;
+            pi_sizes[i_packets++] = 40 + (i_seed >> 16) % 200;
+            i_granule += GEN_PACKET_SAMPLES;
+        }
+        ogg_PutPage(&w, i_granule >= i_total ? 0x04 : 0, i_granule,
+                    pp_packets, pi_sizes, i_packets);
+    }
+
+    *pi_data = w.i_data;
+    return w.p_data;
+}
+
+struct bench_stream
+{
+    const uint8_t *p_data;
+    size_t         i_data;
+    uint64_t       i_pos;
+    unsigned       i_reads;
+    unsigned       i_seeks;
+    uint64_t       i_bytes;
+};
+
+static ssize_t BenchStreamRead(stream_t *s, void *buf, size_t i_len)
+{
+    struct bench_stream *sys = s->p_sys;
+    if (sys->i_pos >= sys->i_data)
+        return 0;
+    i_len = __MIN(i_len, sys->i_data - sys->i_pos);
+    memcpy(buf, &sys->p_data[sys->i_pos], i_len);
+    sys->i_pos += i_len;
+    sys->i_reads++;
+    sys->i_bytes += i_len;
+    return i_len;
+}
+
+static int BenchStreamSeek(stream_t *s, uint64_t i_pos)
+{
+    struct bench_stream *sys = s->p_sys;
+    if (i_pos != sys->i_pos)
+        sys->i_seeks++;
+    sys->i_pos = i_pos;
+    return VLC_SUCCESS;
+}
+
+static int BenchStreamControl(stream_t *s, int i_query, va_list args)
+{
+    struct bench_stream *sys = s->p_sys;
+    switch (i_query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case STREAM_GET_SIZE:
+            *va_arg(args, uint64_t *) = sys->i_data;
+            return VLC_SUCCESS;
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) = DEFAULT_PTS_DELAY;
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static void BenchStreamDestroy(stream_t *s)
+{
+    VLC_UNUSED(s);
+}
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    VLC_UNUSED(in); VLC_UNUSED(fmt);
+    return (es_out_id_t *) out;
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in); VLC_UNUSED(query); VLC_UNUSED(args);
+    return VLC_EGENERIC;
+}
+
+static void EsOutDestroy(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+/* Posted by the log callback when the seek index thread is done */
+static vlc_sem_t indexed;
+
+static void log_cb(void *data, int level, const libvlc_log_t *ctx,
+                   const char *fmt, va_list args)
+{
+    VLC_UNUSED(data); VLC_UNUSED(level); VLC_UNUSED(ctx); VLC_UNUSED(args);
+    if (!strncmp(fmt, "seek index: ", 12))
+        vlc_sem_post(&indexed);
+}
+
+static int bench_seek(libvlc_instance_t *vlc, const char *psz_url,
+                      const uint8_t *p_data, size_t i_data,
+                      unsigned i_minutes, bool b_index)
+{
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    var_SetBool(obj, "ogg-seek-index", b_index);
+    vlc_sem_init(&indexed, 0);
+
+    struct bench_stream sys = { .p_data = p_data, .i_data = i_data };
+    stream_t *s = vlc_stream_CommonNew(obj, BenchStreamDestroy);
+    if (!s)
+        return 1;
+    s->p_sys = &sys;
+    s->pf_read = BenchStreamRead;
+    s->pf_seek = BenchStreamSeek;
+    s->pf_control = BenchStreamControl;
+
+    es_out_t out = { .cbs = &es_out_cbs };
+    vlc_tick_t i_start = vlc_tick_now();
+    demux_t *demux = demux_New(obj, "ogg", psz_url, s, &out);
+    if (!demux)
+    {
+        vlc_stream_Delete(s);
+        return 1;
+    }
+
+    vlc_tick_t i_index = 0;
+    if (b_index)
+    {
+        if (vlc_sem_timedwait(&indexed, i_start + VLC_TICK_FROM_SEC(60)))
+            fprintf(stderr, "the seek index thread didn't finish\n");
+        i_index = vlc_tick_now() - i_start;
+    }
+
+    sys.i_reads = sys.i_seeks = 0;
+    sys.i_bytes = 0;
+    uint32_t i_seed = 7;
+    int i_ret = VLC_SUCCESS;
+    i_start = vlc_tick_now();
+    for (unsigned i = 0; i < BENCH_SEEKS && i_ret == VLC_SUCCESS; i++)
+    {
+        i_seed = i_seed * 1103515245 + 12345;
+        vlc_tick_t i_time = VLC_TICK_FROM_MS((i_seed >> 8) % (i_minutes * 60000));
+        i_ret = demux_Control(demux, DEMUX_SET_TIME, i_time, true);
+    }
+    vlc_tick_t i_elapsed = vlc_tick_now() - i_start;
+
+    printf("%4u min  %-6s  %6.1f reads  %6.1f seeks  %7.1f KiB  %7.1f us",
+           i_minutes, b_index ? "index" : "bisect",
+           (double) sys.i_reads / BENCH_SEEKS, (double) sys.i_seeks / BENCH_SEEKS,
+           (double) sys.i_bytes / 1024 / BENCH_SEEKS,
+           (double) US_FROM_VLC_TICK(i_elapsed) / BENCH_SEEKS);
+    if (b_index)
+        printf("  (indexed in %.3f s)", secf_from_vlc_tick(i_index));
+    printf("\n");
+
+    demux_Delete(demux);
+    return i_ret != VLC_SUCCESS;
+}
+
+static int bench_length(libvlc_instance_t *vlc, unsigned i_minutes)
+{
+    size_t i_data;
+    uint8_t *p_data = generate_ogg(i_minutes, &i_data);
+
+    char psz_path[] = "/tmp/vlc-ogg-bench-XXXXXX";
+    int fd = vlc_mkstemp(psz_path);
+    if (fd == -1)
+    {
+        free(p_data);
+        return 1;
+    }
+    bool b_written = write(fd, p_data, i_data) == (ssize_t) i_data;
+    close(fd);
+
+    char *psz_url = vlc_path2uri(psz_path, NULL);
+    int i_ret = 1;
+    if (b_written && psz_url)
+        i_ret = bench_seek(vlc, psz_url, p_data, i_data, i_minutes, false)
+             || bench_seek(vlc, psz_url, p_data, i_data, i_minutes, true);
+
+    free(psz_url);
+    unlink(psz_path);
+    free(p_data);
+    return i_ret;
+}
+
+int main(int argc, char *argv[])
+{
+    static const unsigned default_lengths[] = { 5, 40, 320 };
+
+    test_init();
+    ogg_InitCrc();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (!vlc)
+        return 1;
+    libvlc_log_set(vlc, log_cb, NULL);
+    var_Create(vlc->p_libvlc_int, "ogg-seek-index", VLC_VAR_BOOL);
+
+    printf("%u random seeks per file, I/O counted on the demuxer stream\n",
+           BENCH_SEEKS);
+
+    int i_ret = 0;
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc && !i_ret; i++)
+            i_ret = bench_length(vlc, strtoul(argv[i], NULL, 0));
+    }
+    else
+    {
+        for (size_t i = 0; i < ARRAY_SIZE(default_lengths) && !i_ret; i++)
+            i_ret = bench_length(vlc, default_lengths[i]);
+    }
+    if (i_ret)
+        fprintf(stderr, "can't open or seek the generated file\n");
+
+    libvlc_release(vlc);
+    return i_ret;
+}
@@ -0,0 +1,494 @@
+/*****************************************************************************
+ * ps_bench.c: MPEG program stream seek accuracy benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_modules_demux_ps_bench [minutes...]
+ *
+ * Generates VBR MPEG video program streams of 10, 60 and 180 minutes by
+ * default: 25fps, 12 frames GOPs, and 10s scenes whose complexity varies
+ * from 0.25x to 4x. Random time seeks are done with the mux rate estimate,
+ * then through the background seek index, and the first I picture demuxed
+ * after each seek is compared to the target. Bytes are counted on the
+ * demuxer stream, which is served from memory; the seek index thread reads
+ * the same file written to /tmp. Set VLC_TEST_TIMEOUT=-1 for the longest
+ * files. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_fs.h>
+#include <vlc_stream.h>
+#include <vlc_tick.h>
+#include <vlc_url.h>
+#include <vlc_variables.h>
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <unistd.h>
+
+#define GEN_FRAME_DURATION 3600 /* 90kHz, 25fps */
+#define GEN_GOP_SIZE       12
+#define GEN_SCENE_FRAMES   250  /* 10s */
+#define GEN_I_SIZE         2000 /* bytes at 1x complexity */
+#define GEN_P_SIZE         250
+#define GEN_PES_PAYLOAD    2016
+#define GEN_MUX_RATE       2500 /* 50 bytes/s units: 1Mbit/s */
+
+#define BENCH_SEEKS 200
+
+struct ps_writer
+{
+    uint8_t *p_data;
+    size_t   i_data;
+    size_t   i_alloc;
+    int64_t  i_scr; /* 90kHz */
+};
+
+static uint8_t *ps_Reserve(struct ps_writer *w, size_t i_size)
+{
+    if (w->i_data + i_size > w->i_alloc)
+    {
+        size_t i_alloc = __MAX(w->i_alloc * 2, w->i_data + i_size);
+        uint8_t *p_realloc = realloc(w->p_data, i_alloc);
+        if (!p_realloc)
+            abort();
+        w->p_data = p_realloc;
+        w->i_alloc = i_alloc;
+    }
+    uint8_t *p = &w->p_data[w->i_data];
+    /* payload that won't emulate any start code */
+    memset(p, 0x55, i_size);
+    w->i_data += i_size;
+    return p;
+}
+
+static void ps_PutPack(struct ps_writer *w)
+{
+    const int64_t i_scr = w->i_scr;
+    uint8_t *p = ps_Reserve(w, 14);
+
+    SetDWBE(p, 0x000001BA);
+    p[4] = 0x44 | ((i_scr >> 27) & 0x38) | ((i_scr >> 28) & 0x03);
+    p[5] = i_scr >> 20;
+    p[6] = ((i_scr >> 12) & 0xF8) | 0x04 | ((i_scr >> 13) & 0x03);
+    p[7] = i_scr >> 5;
+    p[8] = ((i_scr << 3) & 0xF8) | 0x04;
+    p[9] = 0x01;
+    p[10] = GEN_MUX_RATE >> 14;
+    p[11] = (GEN_MUX_RATE >> 6) & 0xFF;
+    p[12] = ((GEN_MUX_RATE << 2) & 0xFC) | 0x03;
+    p[13] = 0xF8;
+}
+
+static uint8_t *ps_PutPES(struct ps_writer *w, uint8_t i_id, int64_t i_pts,
+                          size_t i_payload)
+{
+    const size_t i_header = i_pts >= 0 ? 5 : 0;
+    uint8_t *p = ps_Reserve(w, 9 + i_header + i_payload);
+
+    SetDWBE(p, 0x00000100 | i_id);
+    SetWBE(&p[4], 3 + i_header + i_payload);
+    p[6] = 0x80;
+    p[7] = i_pts >= 0 ? 0x80 : 0x00;
+    p[8] = i_header;
+    if (i_pts >= 0)
+    {
+        p[9] = 0x21 | ((i_pts >> 29) & 0x0E);
+        p[10] = i_pts >> 22;
+        p[11] = ((i_pts >> 14) & 0xFE) | 0x01;
+        p[12] = i_pts >> 7;
+        p[13] = ((i_pts << 1) & 0xFE) | 0x01;
+    }
+    return &p[9 + i_header];
+}
+
+/* Sequence header and I picture at each GOP start, P pictures otherwise */
+static void ps_PutFrame(struct ps_writer *w, unsigned i_frame, size_t i_size)
+{
+    const unsigned i_tref = i_frame % GEN_GOP_SIZE;
+    const int64_t i_pts = 0x1FFFF + 18000 + (int64_t) i_frame * GEN_FRAME_DURATION;
+
+    for (size_t i_done = 0; i_done < i_size; )
+    {
+        const size_t i_payload = __MIN(i_size - i_done, GEN_PES_PAYLOAD);
+        ps_PutPack(w);
+        uint8_t *p = ps_PutPES(w, 0xE0, i_done ? -1 : i_pts, i_payload);
+        if (i_done == 0)
+        {
+            if (i_tref == 0)
+            {
+                SetDWBE(p, 0x000001B3);
+                p += 12;
+            }
+            SetDWBE(p, 0x00000100);
+            p[4] = i_tref >> 2;
+            p[5] = ((i_tref & 0x03) << 6) | ((i_tref == 0 ? 1 : 2) << 3);
+        }
+        i_done += i_payload;
+        /* as sent at the mux rate */
+        w->i_scr += (int64_t) (14 + 14 + i_payload) * 90000 / (GEN_MUX_RATE * 50);
+    }
+
+    /* one audio frame per video frame */
+    ps_PutPack(w);
+    ps_PutPES(w, 0xC0, i_pts, 96);
+}
+
+static uint8_t *generate_ps(unsigned i_minutes, size_t *pi_data)
+{
+    struct ps_writer w = { .i_scr = 0x1FFFF };
+    const unsigned i_frames = i_minutes * 60 * 25;
+    uint32_t i_seed = 1;
+    double f_complexity = 1.;
+
+    for (unsigned i = 0; i < i_frames; i++)
+    {
+        if (i % GEN_SCENE_FRAMES == 0)
+        {
+            /* log uniform between 0.25x and 4x */
+            i_seed = i_seed * 1103515245 + 12345;
+            f_complexity = exp2(-2. + 4. * ((i_seed >> 8) & 0xFFFF) / 65535.);
+        }
+        i_seed = i_seed * 1103515245 + 12345;
+        size_t i_size = (i % GEN_GOP_SIZE == 0 ? GEN_I_SIZE : GEN_P_SIZE)
+                      * f_complexity * (0.75 + ((i_seed >> 8) & 0xFF) / 512.);
+
+        /* the SCR never goes past the decoding time */
+        int64_t i_dts = 0x1FFFF + (int64_t) i * GEN_FRAME_DURATION;
+        if (w.i_scr < i_dts)
+            w.i_scr = i_dts;
+        ps_PutFrame(&w, i, i_size);
+    }
+    SetDWBE(ps_Reserve(&w, 4), 0x000001B9);
+
+    *pi_data = w.i_data;
+    return w.p_data;
+}
+
+struct bench_stream
+{
+    const uint8_t *p_data;
+    size_t         i_data;
+    uint64_t       i_pos;
+    uint64_t       i_bytes;
+};
+
+static ssize_t BenchStreamRead(stream_t *s, void *buf, size_t i_len)
+{
+    struct bench_stream *sys = s->p_sys;
+    if (sys->i_pos >= sys->i_data)
+        return 0;
+    i_len = __MIN(i_len, sys->i_data - sys->i_pos);
+    memcpy(buf, &sys->p_data[sys->i_pos], i_len);
+    sys->i_pos += i_len;
+    sys->i_bytes += i_len;
+    return i_len;
+}
+
+static int BenchStreamSeek(stream_t *s, uint64_t i_pos)
+{
+    struct bench_stream *sys = s->p_sys;
+    sys->i_pos = i_pos;
+    return VLC_SUCCESS;
+}
+
+static int BenchStreamControl(stream_t *s, int i_query, va_list args)
+{
+    struct bench_stream *sys = s->p_sys;
+    switch (i_query)
+    {
+        case STREAM_CAN_SEEK:
+        case STREAM_CAN_FASTSEEK:
+        case STREAM_CAN_PAUSE:
+        case STREAM_CAN_CONTROL_PACE:
+            *va_arg(args, bool *) = true;
+            return VLC_SUCCESS;
+        case STREAM_GET_SIZE:
+            *va_arg(args, uint64_t *) = sys->i_data;
+            return VLC_SUCCESS;
+        case STREAM_GET_PTS_DELAY:
+            *va_arg(args, vlc_tick_t *) = DEFAULT_PTS_DELAY;
+            return VLC_SUCCESS;
+        default:
+            return VLC_EGENERIC;
+    }
+}
+
+static void BenchStreamDestroy(stream_t *s)
+{
+    VLC_UNUSED(s);
+}
+
+/* Keeps the timestamp of the first I picture demuxed after a seek */
+struct bench_out
+{
+    es_out_t    out;
+    es_out_id_t *p_video;
+    vlc_tick_t  i_landing;
+};
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    struct bench_out *sys = container_of(out, struct bench_out, out);
+    VLC_UNUSED(in);
+    /* any non NULL id */
+    es_out_id_t *id = (es_out_id_t *) ((uintptr_t) fmt->i_cat);
+    if (fmt->i_cat == VIDEO_ES)
+        sys->p_video = id;
+    return id;
+}
+
+static bool IsIntraPicture(const block_t *block)
+{
+    for (size_t i = 0; i + 6 <= block->i_buffer; i++)
+    {
+        const uint8_t *p = &block->p_buffer[i];
+        if (p[0] == 0 && p[1] == 0 && p[2] == 1 && p[3] == 0)
+            return ((p[5] >> 3) & 0x07) == 1;
+    }
+    return false;
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    struct bench_out *sys = container_of(out, struct bench_out, out);
+    if (id == sys->p_video && sys->i_landing == VLC_TICK_INVALID &&
+        block->i_pts != VLC_TICK_INVALID && IsIntraPicture(block))
+        sys->i_landing = block->i_pts;
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in); VLC_UNUSED(query); VLC_UNUSED(args);
+    return VLC_EGENERIC;
+}
+
+static void EsOutDestroy(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+/* Posted by the log callback when the seek index thread is done */
+static vlc_sem_t indexed;
+
+static void log_cb(void *data, int level, const libvlc_log_t *ctx,
+                   const char *fmt, va_list args)
+{
+    VLC_UNUSED(data); VLC_UNUSED(level); VLC_UNUSED(ctx); VLC_UNUSED(args);
+    if (!strncmp(fmt, "seek index: ", 12))
+        vlc_sem_post(&indexed);
+}
+
+/* Demuxes until the first I picture, or a few seconds of stream */
+static int demux_ToIntra(demux_t *demux, struct bench_out *out)
+{
+    out->i_landing = VLC_TICK_INVALID;
+    for (unsigned i = 0; i < 100000; i++)
+    {
+        if (demux_Demux(demux) != VLC_DEMUXER_SUCCESS)
+            return VLC_EGENERIC;
+        if (out->i_landing != VLC_TICK_INVALID)
+            return VLC_SUCCESS;
+    }
+    return VLC_EGENERIC;
+}
+
+static int cmp_tick(const void *a, const void *b)
+{
+    vlc_tick_t x = *(const vlc_tick_t *) a, y = *(const vlc_tick_t *) b;
+    return (x > y) - (x < y);
+}
+
+static int bench_seek(libvlc_instance_t *vlc, const char *psz_url,
+                      const uint8_t *p_data, size_t i_data,
+                      unsigned i_minutes, bool b_index)
+{
+    vlc_object_t *obj = VLC_OBJECT(vlc->p_libvlc_int);
+
+    var_SetBool(obj, "ps-seek-index", b_index);
+    vlc_sem_init(&indexed, 0);
+
+    struct bench_stream sys = { .p_data = p_data, .i_data = i_data };
+    stream_t *s = vlc_stream_CommonNew(obj, BenchStreamDestroy);
+    if (!s)
+        return 1;
+    s->p_sys = &sys;
+    s->pf_read = BenchStreamRead;
+    s->pf_seek = BenchStreamSeek;
+    s->pf_control = BenchStreamControl;
+
+    struct bench_out out = { .out = { .cbs = &es_out_cbs } };
+    vlc_tick_t i_start = vlc_tick_now();
+    demux_t *demux = demux_New(obj, "ps", psz_url, s, &out.out);
+    if (!demux)
+    {
+        vlc_stream_Delete(s);
+        return 1;
+    }
+
+    vlc_tick_t i_index = 0;
+    if (b_index)
+    {
+        if (vlc_sem_timedwait(&indexed, i_start + VLC_TICK_FROM_SEC(120)))
+            fprintf(stderr, "the seek index thread didn't finish\n");
+        i_index = vlc_tick_now() - i_start;
+    }
+
+    /* the times are relative to the first picture */
+    int i_ret = demux_ToIntra(demux, &out);
+    const vlc_tick_t i_origin = out.i_landing;
+
+    vlc_tick_t errors[BENCH_SEEKS];
+    unsigned i_before = 0;
+    uint64_t i_bytes = 0;
+    uint32_t i_seed = 7;
+    i_start = vlc_tick_now();
+    for (unsigned i = 0; i < BENCH_SEEKS && i_ret == VLC_SUCCESS; i++)
+    {
+        i_seed = i_seed * 1103515245 + 12345;
+        /* not in the last minute, so that there is an I picture after */
+        vlc_tick_t i_time = VLC_TICK_FROM_MS((i_seed >> 8) % ((i_minutes - 1) * 60000));
+
+        i_ret = demux_Control(demux, DEMUX_SET_TIME, i_time, false);
+        sys.i_bytes = 0;
+        if (i_ret == VLC_SUCCESS)
+            i_ret = demux_ToIntra(demux, &out);
+        i_bytes += sys.i_bytes;
+
+        errors[i] = out.i_landing - i_origin - i_time;
+        if (errors[i] <= 0)
+            i_before++;
+        if (errors[i] < 0)
+            errors[i] = -errors[i];
+    }
+    vlc_tick_t i_elapsed = vlc_tick_now() - i_start;
+
+    if (i_ret == VLC_SUCCESS)
+    {
+        qsort(errors, BENCH_SEEKS, sizeof(*errors), cmp_tick);
+        printf("%4u min  %-8s  error median %7.2f s  p95 %7.2f s  "
+               "%3u%% before  %6.1f KiB to the I picture  %7.1f us",
+               i_minutes, b_index ? "index" : "estimate",
+               secf_from_vlc_tick(errors[BENCH_SEEKS / 2]),
+               secf_from_vlc_tick(errors[BENCH_SEEKS * 95 / 100]),
+               i_before * 100 / BENCH_SEEKS,
+               (double) i_bytes / 1024 / BENCH_SEEKS,
+               (double) US_FROM_VLC_TICK(i_elapsed) / BENCH_SEEKS);
+        if (b_index)
+            printf("  (%.1f MiB indexed in %.3f s)",
+                   (double) i_data / 1024 / 1024, secf_from_vlc_tick(i_index));
+        printf("\n");
+    }
+    else
+        fprintf(stderr, "%u min %s: seek failed\n", i_minutes,
+                b_index ? "index" : "estimate");
+
+    demux_Delete(demux);
+    return i_ret != VLC_SUCCESS;
+}
+
+static int bench_length(libvlc_instance_t *vlc, unsigned i_minutes)
+{
+    size_t i_data;
+    uint8_t *p_data = generate_ps(i_minutes, &i_data);
+
+    char psz_path[] = "/tmp/vlc-ps-bench-XXXXXX";
+    int fd = vlc_mkstemp(psz_path);
+    if (fd == -1)
+    {
+        free(p_data);
+        return 1;
+    }
+    bool b_written = write(fd, p_data, i_data) == (ssize_t) i_data;
+    close(fd);
+
+    char *psz_url = vlc_path2uri(psz_path, NULL);
+    int i_ret = 1;
+    if (b_written && psz_url)
+        i_ret = bench_seek(vlc, psz_url, p_data, i_data, i_minutes, false)
+             || bench_seek(vlc, psz_url, p_data, i_data, i_minutes, true);
+
+    free(psz_url);
+    unlink(psz_path);
+    free(p_data);
+    return i_ret;
+}
+
+int main(int argc, char *argv[])
+{
+    static const unsigned default_lengths[] = { 10, 60, 180 };
+
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (!vlc)
+        return 1;
+    libvlc_log_set(vlc, log_cb, NULL);
+    var_Create(vlc->p_libvlc_int, "ps-seek-index", VLC_VAR_BOOL);
+
+    printf("%u random time seeks per file, landing on the first I picture "
+           "demuxed after the seek\n", BENCH_SEEKS);
+
+    int i_ret = 0;
+    if (argc > 1)
+    {
+        for (int i = 1; i < argc && !i_ret; i++)
+        {
+            unsigned i_minutes = strtoul(argv[i], NULL, 10);
+            if (i_minutes > 1)
+                i_ret = bench_length(vlc, i_minutes);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < ARRAY_SIZE(default_lengths) && !i_ret; i++)
+            i_ret = bench_length(vlc, default_lengths[i]);
+    }
+
+    libvlc_release(vlc);
+    return i_ret;
+}
@@ -0,0 +1,352 @@
+/*****************************************************************************
+ * ps_seektable.c: MPEG program stream seek table tests
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+const char vlc_module_name[] = "ps_seektable";
+
+#include <vlc_common.h>
+#include <vlc_stream.h>
+#include <vlc_rand.h>
+
+#include "../../../modules/demux/mpeg/timestamps.h"
+#include "../../../modules/demux/mpeg/ps_seektable.h"
+
+#define BAILOUT(run) { fprintf(stderr, "failed %s line %d\n", run, __LINE__); \
+                        goto end; }
+#define EXPECT(foo) if(!(foo)) BAILOUT(run)
+
+/* 3 minutes of 25fps video, 12 frames GOP */
+#define STREAM_FRAMES   (25 * 180)
+#define GOP_SIZE        12
+#define FRAME_DURATION  3600 /* 90kHz */
+#define PES_PAYLOAD     2016
+/* 3 minutes of 1152 samples 48kHz audio frames */
+#define AUDIO_FRAMES    7500
+#define AUDIO_DURATION  2160 /* 90kHz */
+
+typedef struct
+{
+    uint8_t    *p_data;
+    size_t      i_data;
+    size_t      i_max;
+    /* every seekpoint the scan must find, as reference */
+    seektable_point_t *p_keys;
+    size_t      i_keys;
+    /* muxer state */
+    int64_t     i_scr;     /* 90kHz */
+    int64_t     i_last_scr;
+    vlc_tick_t  i_offset;
+} ps_sample_t;
+
+static uint8_t *SampleAppend( ps_sample_t *p_sample, size_t i_size )
+{
+    if( p_sample->i_data + i_size > p_sample->i_max )
+    {
+        p_sample->i_max = (p_sample->i_data + i_size) * 2;
+        p_sample->p_data = realloc( p_sample->p_data, p_sample->i_max );
+        assert( p_sample->p_data );
+    }
+    uint8_t *p = &p_sample->p_data[p_sample->i_data];
+    /* payload that won't emulate any start code */
+    for( size_t i = 0; i < i_size; i++ )
+        p[i] = 0x10 + (vlc_lrand48() & 0x3F);
+    p_sample->i_data += i_size;
+    return p;
+}
+
+static void SampleAddKey( ps_sample_t *p_sample, int64_t i_pts, uint64_t i_pos )
+{
+    p_sample->p_keys = realloc( p_sample->p_keys,
+                (p_sample->i_keys + 1) * sizeof(seektable_point_t) );
+    assert( p_sample->p_keys );
+    seektable_point_t *p_key = &p_sample->p_keys[p_sample->i_keys++];
+    p_key->i_time = FROM_SCALE( i_pts ) + p_sample->i_offset;
+    p_key->i_offset = p_sample->i_offset;
+    p_key->i_pos = i_pos;
+}
+
+static void SetTimestamp( uint8_t *p, uint8_t i_flags, int64_t i_ts )
+{
+    p[0] = (i_flags << 4) | ((i_ts >> 29) & 0x0E) | 0x01;
+    p[1] = i_ts >> 22;
+    p[2] = ((i_ts >> 14) & 0xFE) | 0x01;
+    p[3] = i_ts >> 7;
+    p[4] = ((i_ts << 1) & 0xFE) | 0x01;
+}
+
+static uint64_t WritePack( ps_sample_t *p_sample )
+{
+    const int64_t i_scr = p_sample->i_scr;
+    const uint32_t i_mux_rate = 25200; /* 10Mbit/s */
+    uint64_t i_pos = p_sample->i_data;
+    uint8_t *p = SampleAppend( p_sample, 14 );
+
+    SetDWBE( p, 0x000001BA );
+    p[4] = 0x44 | ((i_scr >> 27) & 0x38) | ((i_scr >> 28) & 0x03);
+    p[5] = i_scr >> 20;
+    p[6] = ((i_scr >> 12) & 0xF8) | 0x04 | ((i_scr >> 13) & 0x03);
+    p[7] = i_scr >> 5;
+    p[8] = ((i_scr << 3) & 0xF8) | 0x04;
+    p[9] = 0x01;
+    p[10] = i_mux_rate >> 14;
+    p[11] = (i_mux_rate >> 6) & 0xFF;
+    p[12] = ((i_mux_rate << 2) & 0xFC) | 0x03;
+    p[13] = 0xF8;
+
+    /* the scanner keeps the timeline continuous over SCR jumps */
+    if( p_sample->i_last_scr >= 0 &&
+        ( i_scr < p_sample->i_last_scr ||
+          FROM_SCALE_NZ( i_scr - p_sample->i_last_scr ) > VLC_TICK_FROM_SEC(1) ) )
+        p_sample->i_offset += FROM_SCALE( p_sample->i_last_scr ) - FROM_SCALE( i_scr );
+    p_sample->i_last_scr = i_scr;
+
+    return i_pos;
+}
+
+static uint8_t *WritePES( ps_sample_t *p_sample, uint8_t i_id,
+                          int64_t i_pts, size_t i_payload )
+{
+    const size_t i_header = i_pts >= 0 ? 5 : 0;
+    uint8_t *p = SampleAppend( p_sample, 9 + i_header + i_payload );
+
+    SetDWBE( p, 0x00000100 | i_id );
+    SetWBE( &p[4], 3 + i_header + i_payload );
+    p[6] = 0x80;
+    p[7] = i_pts >= 0 ? 0x80 : 0x00;
+    p[8] = i_header;
+    if( i_pts >= 0 )
+        SetTimestamp( &p[9], 0x02, i_pts );
+    return &p[9 + i_header];
+}
+
+static uint8_t *WriteStartCode( uint8_t *p, uint8_t i_code, size_t i_size )
+{
+    SetDWBE( p, 0x00000100 | i_code );
+    return &p[4 + i_size];
+}
+
+/* Every other GOP starts with a sequence header, the others with only an
+ * I picture. Other pictures are P pictures. */
+static void WriteMpgvPicture( uint8_t *p, unsigned i_frame )
+{
+    const unsigned i_tref = i_frame % GOP_SIZE;
+    const bool b_key = i_tref == 0;
+
+    if( b_key && (i_frame / GOP_SIZE) % 2 == 0 )
+        p = WriteStartCode( p, 0xB3, 8 );
+    WriteStartCode( p, 0x00, 0 );
+    p[4] = i_tref >> 2;
+    p[5] = ((i_tref & 0x03) << 6) | ((b_key ? 1 : 2) << 3);
+}
+
+/* Every other GOP starts with SPS and PPS before the IDR slice, the others
+ * with only the IDR slice. Other pictures are non IDR slices, after an SEI
+ * the scanner must step over. */
+static void WriteH264Picture( uint8_t *p, unsigned i_frame )
+{
+    const bool b_key = (i_frame % GOP_SIZE) == 0;
+
+    p = WriteStartCode( p, 0x09, 1 ); /* access unit delimiter */
+    if( b_key )
+    {
+        if( (i_frame / GOP_SIZE) % 2 == 0 )
+        {
+            p = WriteStartCode( p, 0x67, 8 );
+            p = WriteStartCode( p, 0x68, 4 );
+        }
+        WriteStartCode( p, 0x65, 0 );
+    }
+    else
+    {
+        p = WriteStartCode( p, 0x06, 4 );
+        WriteStartCode( p, 0x41, 0 );
+    }
+}
+
+static void WriteFrame( ps_sample_t *p_sample, bool b_h264,
+                        unsigned i_frame, int64_t i_pts )
+{
+    const bool b_key = (i_frame % GOP_SIZE) == 0;
+    size_t i_size = b_key ? 8000 + vlc_lrand48() % 8000
+                          : 1000 + vlc_lrand48() % 3000;
+
+    for( size_t i_done = 0; i_done < i_size; )
+    {
+        const size_t i_payload = __MIN( i_size - i_done, PES_PAYLOAD );
+        const uint64_t i_pack_pos = WritePack( p_sample );
+        uint8_t *p = WritePES( p_sample, 0xE0, i_done ? -1 : i_pts, i_payload );
+
+        if( i_done == 0 )
+        {
+            if( b_h264 )
+                WriteH264Picture( p, i_frame );
+            else
+                WriteMpgvPicture( p, i_frame );
+            if( b_key )
+                SampleAddKey( p_sample, i_pts, i_pack_pos );
+        }
+
+        i_done += i_payload;
+        p_sample->i_scr += 40;
+    }
+
+    /* one audio frame per video frame, not a seekpoint with video */
+    WritePack( p_sample );
+    WritePES( p_sample, 0xC0, i_pts, 384 );
+}
+
+static void SampleInit( ps_sample_t *p_sample )
+{
+    memset( p_sample, 0, sizeof(*p_sample) );
+    p_sample->i_scr = 0x1FFFF;
+    p_sample->i_last_scr = -1;
+}
+
+static void Generate( ps_sample_t *p_sample, bool b_h264, bool b_discontinuity )
+{
+    SampleInit( p_sample );
+
+    int64_t i_base = p_sample->i_scr;
+    for( unsigned i = 0; i < STREAM_FRAMES; i++ )
+    {
+        /* the clock is reset in the middle of a GOP, like at a cut */
+        if( b_discontinuity && i == STREAM_FRAMES / 2 + 5 )
+        {
+            p_sample->i_scr = 0x1000;
+            i_base = p_sample->i_scr - i * FRAME_DURATION;
+        }
+        if( p_sample->i_scr < i_base + i * FRAME_DURATION )
+            p_sample->i_scr = i_base + i * FRAME_DURATION;
+        WriteFrame( p_sample, b_h264, i, i_base + i * FRAME_DURATION + 18000 );
+    }
+
+    /* MPEG program end code */
+    SetDWBE( SampleAppend( p_sample, 4 ), 0x000001B9 );
+}
+
+/* Without video, the audio packets are seekpoints every 500ms */
+static void GenerateAudio( ps_sample_t *p_sample )
+{
+    SampleInit( p_sample );
+
+    const int64_t i_base = p_sample->i_scr;
+    vlc_tick_t i_last = VLC_TICK_INVALID;
+    for( unsigned i = 0; i < AUDIO_FRAMES; i++ )
+    {
+        const int64_t i_pts = i_base + i * AUDIO_DURATION + 18000;
+        p_sample->i_scr = i_base + i * AUDIO_DURATION;
+
+        uint64_t i_pack_pos = WritePack( p_sample );
+        WritePES( p_sample, 0xC0, i_pts, 384 );
+
+        if( i_last == VLC_TICK_INVALID ||
+            FROM_SCALE( i_pts ) - i_last >= VLC_TICK_FROM_MS(500) )
+        {
+            SampleAddKey( p_sample, i_pts, i_pack_pos );
+            i_last = FROM_SCALE( i_pts );
+        }
+    }
+
+    SetDWBE( SampleAppend( p_sample, 4 ), 0x000001B9 );
+}
+
+static int runtest( const char *run, libvlc_instance_t *vlc,
+                    bool b_h264, ps_sample_t *p_sample )
+{
+    int ret = 1;
+    stream_t *s = NULL;
+    seektable_t table;
+    vlc_tick_t i_end;
+
+    seektable_Init( &table );
+
+    s = vlc_stream_MemoryNew( vlc->p_libvlc_int, p_sample->p_data,
+                                        p_sample->i_data, true );
+    EXPECT( s );
+
+    vlc_tick_t i_start = vlc_tick_now();
+    EXPECT( ps_seektable_Scan( &table, s, b_h264 ) == VLC_SUCCESS );
+    vlc_tick_t i_scan = vlc_tick_now() - i_start;
+
+    /* every keyframe, and only them */
+    EXPECT( table.b_done );
+    EXPECT( table.i_indexed_end == p_sample->i_data );
+    EXPECT( table.i_points == p_sample->i_keys );
+    for( size_t i = 0; i < p_sample->i_keys; i++ )
+    {
+        const seektable_point_t *p_point = &table.p_points[i];
+        const seektable_point_t *p_key = &p_sample->p_keys[i];
+        EXPECT( p_point->i_time == p_key->i_time );
+        EXPECT( p_point->i_offset == p_key->i_offset );
+        EXPECT( p_point->i_pos == p_key->i_pos );
+    }
+
+    /* the end time comes from the last pack */
+    EXPECT( seektable_GetEndTime( &table, &i_end ) == VLC_SUCCESS );
+    EXPECT( i_end == FROM_SCALE( p_sample->i_last_scr ) + p_sample->i_offset );
+
+    fprintf( stderr, "%s: %zu seekpoints, %zu bytes, scanned in %"PRId64" ms\n",
+             run, p_sample->i_keys, p_sample->i_data, MS_FROM_VLC_TICK( i_scan ) );
+    ret = 0;
+
+end:
+    if( s )
+        vlc_stream_Delete( s );
+    seektable_Clean( &table );
+    free( p_sample->p_data );
+    free( p_sample->p_keys );
+    return ret;
+}
+
+int main( void )
+{
+    test_init();
+
+    libvlc_instance_t *vlc = libvlc_new( 0, NULL );
+    if( !vlc )
+        return 1;
+
+    int ret = 0;
+    ps_sample_t sample;
+
+    Generate( &sample, false, false );
+    ret |= runtest( "mpgv", vlc, false, &sample );
+
+    Generate( &sample, false, true );
+    ret |= runtest( "mpgv discontinuity", vlc, false, &sample );
+
+    Generate( &sample, true, false );
+    ret |= runtest( "h264", vlc, true, &sample );
+
+    Generate( &sample, true, true );
+    ret |= runtest( "h264 discontinuity", vlc, true, &sample );
+
+    GenerateAudio( &sample );
+    ret |= runtest( "audio only", vlc, false, &sample );
+
+    libvlc_release( vlc );
+    return ret;
+}
@@ -0,0 +1,356 @@
+/*****************************************************************************
+ * medialibrary_bench.c: media library folder watching benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_modules_misc_medialibrary_bench [dirs] [files]
+ *
+ * Generates 50 folders of 20 short WAV files by default, and indexes them
+ * with and without watching the folders. For each mode, measures the I/O
+ * (from /proc/self/io) and CPU time of the process while idle for 10 s, the
+ * time until a single added file is indexed (by reloading all the folders
+ * when they are not watched), and the reload at startup, with the listings
+ * kept from the previous run. Set VLC_TEST_TIMEOUT=-1 for large counts. */
+
+#ifdef HAVE_CONFIG_H
+# include <config.h>
+#endif
+
+/* Define a builtin module for the benchmark interface */
+#define MODULE_NAME test_misc_medialibrary_bench
+#undef VLC_DYNAMIC_PLUGIN
+
+#include "../../libvlc/test.h"
+
+#include <vlc/vlc.h>
+
+#include <vlc_common.h>
+#include <vlc_plugin.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+#include <vlc_url.h>
+#include <vlc_media_library.h>
+
+#include <ftw.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <sys/resource.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+const char vlc_module_name[] = MODULE_STRING;
+
+#define IDLE_WINDOW VLC_TICK_FROM_SEC(10)
+#define INDEX_TIMEOUT VLC_TICK_FROM_SEC(60)
+
+static int exitcode = 0;
+static char *folder_mrl;
+static const char *media_dir;
+static unsigned dirs = 50, files = 20;
+static bool restart, watching;
+
+struct io_usage
+{
+    vlc_tick_t date;
+    vlc_tick_t cpu;
+    unsigned long long rchar;
+    unsigned long long syscr;
+    unsigned long long read_bytes;
+};
+
+static void get_io_usage(struct io_usage *usage)
+{
+    memset(usage, 0, sizeof(*usage));
+    usage->date = vlc_tick_now();
+
+    struct rusage ru;
+    if (getrusage(RUSAGE_SELF, &ru) == 0)
+        usage->cpu = vlc_tick_from_timeval(&ru.ru_utime)
+                   + vlc_tick_from_timeval(&ru.ru_stime);
+
+    FILE *file = fopen("/proc/self/io", "r");
+    if (file == NULL)
+        return;
+
+    char name[32];
+    unsigned long long value;
+    while (fscanf(file, "%31[^:]: %llu\n", name, &value) == 2)
+    {
+        if (!strcmp(name, "rchar"))
+            usage->rchar = value;
+        else if (!strcmp(name, "syscr"))
+            usage->syscr = value;
+        else if (!strcmp(name, "read_bytes"))
+            usage->read_bytes = value;
+    }
+    fclose(file);
+}
+
+static void print_phase(const char *name, const struct io_usage *start,
+                        bool done)
+{
+    struct io_usage end;
+    get_io_usage(&end);
+
+    printf("  %-18s %8.3f s  cpu %7.3f s  read %9llu B (%llu B from disk)"
+           "  %6llu calls%s\n", name,
+           secf_from_vlc_tick(end.date - start->date),
+           secf_from_vlc_tick(end.cpu - start->cpu),
+           end.rchar - start->rchar, end.read_bytes - start->read_bytes,
+           end.syscr - start->syscr, done ? "" : "  (timed out)");
+}
+
+struct bench_ctx
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    unsigned media_added;
+    unsigned discoveries;
+};
+
+static void on_event(void *data, const vlc_ml_event_t *event)
+{
+    struct bench_ctx *ctx = data;
+
+    vlc_mutex_lock(&ctx->lock);
+    if (event->i_type == VLC_ML_EVENT_MEDIA_ADDED)
+        ctx->media_added++;
+    else if (event->i_type == VLC_ML_EVENT_DISCOVERY_COMPLETED)
+        ctx->discoveries++;
+    vlc_cond_signal(&ctx->cond);
+    vlc_mutex_unlock(&ctx->lock);
+}
+
+static bool wait_counter(struct bench_ctx *ctx, const unsigned *counter,
+                         unsigned value)
+{
+    vlc_tick_t deadline = vlc_tick_now() + INDEX_TIMEOUT;
+    bool done = true;
+
+    vlc_mutex_lock(&ctx->lock);
+    while (*counter < value && done)
+        done = vlc_cond_timedwait(&ctx->cond, &ctx->lock, deadline) == 0
+            || *counter >= value;
+    vlc_mutex_unlock(&ctx->lock);
+    return done;
+}
+
+static int write_wav(const char *path)
+{
+    /* 0.1 s of 8 kHz mono 16-bit silence */
+    static const uint8_t header[44] = {
+        'R', 'I', 'F', 'F', 0x64, 0x06, 0, 0, 'W', 'A', 'V', 'E',
+        'f', 'm', 't', ' ', 16, 0, 0, 0, 1, 0, 1, 0,
+        0x40, 0x1f, 0, 0, 0x80, 0x3e, 0, 0, 2, 0, 16, 0,
+        'd', 'a', 't', 'a', 0x40, 0x06, 0, 0,
+    };
+    static const uint8_t samples[1600];
+
+    FILE *file = fopen(path, "wb");
+    if (file == NULL)
+        return -1;
+    bool ok = fwrite(header, sizeof(header), 1, file) == 1
+           && fwrite(samples, sizeof(samples), 1, file) == 1;
+    return (fclose(file) == 0 && ok) ? 0 : -1;
+}
+
+static int generate_files(const char *dir)
+{
+    for (unsigned i = 0; i < dirs; i++)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%04u", dir, i);
+        if (mkdir(path, 0700))
+            return -1;
+        for (unsigned j = 0; j < files; j++)
+        {
+            snprintf(path, sizeof(path), "%s/%04u/%04u.wav", dir, i, j);
+            if (write_wav(path))
+                return -1;
+        }
+    }
+    return 0;
+}
+
+static void bench_index(vlc_medialibrary_t *ml, struct bench_ctx *ctx)
+{
+    struct io_usage start;
+
+    get_io_usage(&start);
+    vlc_ml_add_folder(ml, folder_mrl);
+    bool done = wait_counter(ctx, &ctx->media_added, dirs * files);
+    print_phase("initial indexing", &start, done);
+    if (!done)
+        return;
+
+    /* let the background tasks settle */
+    vlc_tick_sleep(VLC_TICK_FROM_SEC(2));
+
+    get_io_usage(&start);
+    vlc_tick_sleep(IDLE_WINDOW);
+    print_phase("idle", &start, true);
+
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%04u/added.wav", media_dir, dirs / 2);
+    vlc_mutex_lock(&ctx->lock);
+    unsigned added = ctx->media_added + 1;
+    vlc_mutex_unlock(&ctx->lock);
+
+    get_io_usage(&start);
+    if (write_wav(path))
+        return;
+    if (!watching)
+        vlc_ml_reload_folder(ml, NULL);
+    done = wait_counter(ctx, &ctx->media_added, added);
+    print_phase("single file added", &start, done);
+}
+
+static void bench_restart(vlc_medialibrary_t *ml, struct bench_ctx *ctx)
+{
+    struct io_usage start;
+
+    get_io_usage(&start);
+    vlc_ml_reload_folder(ml, NULL);
+    bool done = wait_counter(ctx, &ctx->discoveries, 1);
+    print_phase("restart reload", &start, done);
+}
+
+static int OpenIntf(vlc_object_t *root)
+{
+    vlc_medialibrary_t *ml = vlc_ml_instance_get(root);
+    if (ml == NULL)
+    {
+        exitcode = 77;
+        return VLC_SUCCESS;
+    }
+
+    struct bench_ctx ctx = { 0 };
+    vlc_mutex_init(&ctx.lock);
+    vlc_cond_init(&ctx.cond);
+
+    vlc_ml_event_callback_t *listener =
+        vlc_ml_event_register_callback(ml, on_event, &ctx);
+    if (listener == NULL)
+    {
+        exitcode = 1;
+        return VLC_SUCCESS;
+    }
+
+    if (restart)
+        bench_restart(ml, &ctx);
+    else
+        bench_index(ml, &ctx);
+
+    vlc_ml_event_unregister_callback(ml, listener);
+    return VLC_SUCCESS;
+}
+
+/** Inject the benchmark interface as a static plugin: **/
+vlc_module_begin()
+    set_callback(OpenIntf)
+    set_capability("interface", 0)
+vlc_module_end()
+
+VLC_EXPORT const vlc_plugin_cb vlc_static_modules[] = {
+    VLC_SYMBOL(vlc_entry),
+    NULL
+};
+
+static int cleanup_tmpdir(const char *dirpath, const struct stat *sb,
+                          int typeflag, struct FTW *ftwbuf)
+{
+    (void)sb; (void)typeflag; (void)ftwbuf;
+    return remove(dirpath);
+}
+
+static void run(void)
+{
+    const char * const args[] = {
+        "--ignore-config", "--vout=dummy", "--aout=dummy",
+        "--no-auto-preparse", "--media-library",
+        watching ? "--ml-watch" : "--no-ml-watch",
+    };
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    if (vlc == NULL)
+    {
+        exitcode = 1;
+        return;
+    }
+    libvlc_add_intf(vlc, MODULE_STRING);
+    libvlc_release(vlc);
+}
+
+static void bench(const char *name, bool watch)
+{
+    /* the added file is indexed again by each run */
+    char path[256];
+    snprintf(path, sizeof(path), "%s/%04u/added.wav", media_dir, dirs / 2);
+    unlink(path);
+
+    char template[] = "/tmp/vlc-medialibrary-bench-data-XXXXXX";
+    const char *datadir = mkdtemp(template);
+    if (datadir == NULL)
+    {
+        exitcode = 1;
+        return;
+    }
+    setenv("XDG_DATA_HOME", datadir, 1);
+
+    printf("%s:\n", name);
+    watching = watch;
+    restart = false;
+    run();
+    if (exitcode == 0)
+    {
+        restart = true;
+        run();
+    }
+
+    nftw(datadir, cleanup_tmpdir, FOPEN_MAX, FTW_DEPTH | FTW_MOUNT | FTW_PHYS);
+}
+
+int main(int argc, char *argv[])
+{
+    if (argc > 1)
+        dirs = strtoul(argv[1], NULL, 0);
+    if (argc > 2)
+        files = strtoul(argv[2], NULL, 0);
+
+    test_init();
+
+    char template[] = "/tmp/vlc-medialibrary-bench-XXXXXX";
+    media_dir = mkdtemp(template);
+    if (media_dir == NULL || generate_files(media_dir))
+    {
+        fprintf(stderr, "can't generate the files\n");
+        return 1;
+    }
+    folder_mrl = vlc_path2uri(media_dir, NULL);
+    if (folder_mrl == NULL)
+        return 1;
+
+    bench("watched", true);
+    if (exitcode == 0)
+        bench("not watched", false);
+
+    free(folder_mrl);
+    nftw(media_dir, cleanup_tmpdir, FOPEN_MAX, FTW_DEPTH | FTW_MOUNT | FTW_PHYS);
+    return exitcode;
+}
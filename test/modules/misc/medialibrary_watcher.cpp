@@ -0,0 +1,401 @@
+/*****************************************************************************
+ * medialibrary_watcher.cpp: test for the medialibrary file system watcher
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published
+ * by the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+extern "C" const char vlc_module_name[] = "medialibrary_watcher";
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_url.h>
+
+#include "../../../modules/misc/medialibrary/fs/watcher.h"
+
+#include <algorithm>
+#include <functional>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <ftw.h>
+#include <unistd.h>
+
+using namespace vlc::medialibrary;
+
+#define BAILOUT(run) { fprintf(stderr, "failed %s line %d\n", run, __LINE__); \
+                        goto end; }
+#define EXPECT(foo) if(!(foo)) BAILOUT(run)
+
+/* the events are reported by the watcher thread right away, but the settled
+ * changes only after a second without events */
+#define EVENT_TIMEOUT  VLC_TICK_FROM_SEC(2)
+#define SETTLE_TIMEOUT VLC_TICK_FROM_SEC(4)
+
+class WatcherCb : public IWatcherCb
+{
+public:
+    void onDirectoryChanged( const std::string& mrl ) override
+    {
+        vlc::threads::mutex_locker lock( m_mutex );
+        m_changed.push_back( mrl );
+        m_cond.broadcast();
+        /* lets the test fill the event queue */
+        while ( m_blocked )
+            m_cond.wait( m_mutex );
+    }
+
+    void onChangesSettled( const std::vector<std::string>& mrls ) override
+    {
+        vlc::threads::mutex_locker lock( m_mutex );
+        m_settled.insert( m_settled.end(), mrls.begin(), mrls.end() );
+        m_cond.broadcast();
+    }
+
+    void onOverflow() override
+    {
+        vlc::threads::mutex_locker lock( m_mutex );
+        m_overflows++;
+        m_cond.broadcast();
+    }
+
+    void reset()
+    {
+        vlc::threads::mutex_locker lock( m_mutex );
+        m_changed.clear();
+        m_settled.clear();
+        m_overflows = 0;
+    }
+
+    void setBlocked( bool blocked )
+    {
+        vlc::threads::mutex_locker lock( m_mutex );
+        m_blocked = blocked;
+        m_cond.broadcast();
+    }
+
+    /* Waits for a condition, checked with the lock held. The watches are
+     * added asynchronously, without any callback: poll them too. */
+    bool waitFor( const std::function<bool()>& cond, vlc_tick_t timeout )
+    {
+        vlc_tick_t deadline = vlc_tick_now() + timeout;
+        vlc::threads::mutex_locker lock( m_mutex );
+        while ( !cond() )
+        {
+            vlc_tick_t now = vlc_tick_now();
+            if ( now >= deadline )
+                return false;
+            m_cond.timedwait( m_mutex, std::min( deadline,
+                                         now + VLC_TICK_FROM_MS(20) ) );
+        }
+        return true;
+    }
+
+    bool hasChanged( const std::string& mrl ) const
+    {
+        return std::find( m_changed.begin(), m_changed.end(), mrl )
+               != m_changed.end();
+    }
+
+    bool hasSettled( const std::string& mrl ) const
+    {
+        return std::find( m_settled.begin(), m_settled.end(), mrl )
+               != m_settled.end();
+    }
+
+    std::vector<std::string> m_changed;
+    std::vector<std::string> m_settled;
+    unsigned m_overflows = 0;
+
+private:
+    vlc::threads::mutex m_mutex;
+    vlc::threads::condition_variable m_cond;
+    bool m_blocked = false;
+};
+
+static std::string s_root;
+static std::string s_rootMrl;
+
+static std::string Path( const std::string& name )
+{
+    return s_root + '/' + name;
+}
+
+static std::string Mrl( const std::string& name )
+{
+    return s_rootMrl + name + '/';
+}
+
+static bool Touch( const std::string& name )
+{
+    int fd = vlc_open( Path( name ).c_str(), O_WRONLY | O_CREAT, 0644 );
+    if ( fd == -1 )
+        return false;
+    vlc_close( fd );
+    return true;
+}
+
+static bool Rename( const std::string& from, const std::string& to )
+{
+    return vlc_rename( Path( from ).c_str(), Path( to ).c_str() ) == 0;
+}
+
+static int RemoveEntry( const char* path, const struct stat*, int,
+                        struct FTW* )
+{
+    return remove( path );
+}
+
+static bool WaitWatched( WatcherCb& cb, SDWatcher& watcher,
+                         const std::string& mrl, bool watched )
+{
+    return cb.waitFor( [&] { return watcher.isWatched( mrl ) == watched; },
+                       EVENT_TIMEOUT );
+}
+
+static bool WaitChanged( WatcherCb& cb, const std::string& mrl )
+{
+    return cb.waitFor( [&] { return cb.hasChanged( mrl ); }, EVENT_TIMEOUT );
+}
+
+static int TestTree( vlc_object_t* obj )
+{
+    const char* run = "tree";
+    WatcherCb cb;
+    SDWatcher watcher( obj, cb );
+    int ret = 1;
+
+    if ( !watcher.start() )
+        return 77;
+
+    /* tree/sub/nested, a link to tree (loop), a link to sub (already watched
+     * through its path) and a link out of the tree (watched) */
+    EXPECT( vlc_mkdir( Path( "out" ).c_str(), 0755 ) == 0 );
+    EXPECT( vlc_mkdir( Path( "tree" ).c_str(), 0755 ) == 0 );
+    EXPECT( vlc_mkdir( Path( "tree/sub" ).c_str(), 0755 ) == 0 );
+    EXPECT( vlc_mkdir( Path( "tree/sub/nested" ).c_str(), 0755 ) == 0 );
+    EXPECT( symlink( ".", Path( "tree/loop" ).c_str() ) == 0 );
+    EXPECT( symlink( "sub", Path( "tree/alias" ).c_str() ) == 0 );
+    EXPECT( symlink( "../out", Path( "tree/outlink" ).c_str() ) == 0 );
+
+    /* the watch request has no trailing '/' */
+    watcher.watch( s_rootMrl + "tree" );
+    EXPECT( WaitWatched( cb, watcher, Mrl( "tree" ), true ) );
+    EXPECT( WaitWatched( cb, watcher, Mrl( "tree/sub/nested" ), true ) );
+    EXPECT( WaitWatched( cb, watcher, Mrl( "tree/outlink" ), true ) );
+    EXPECT( !watcher.isWatched( Mrl( "tree/loop" ) ) );
+    EXPECT( !watcher.isWatched( Mrl( "tree/loop/sub" ) ) );
+    EXPECT( !watcher.isWatched( Mrl( "tree/alias" ) ) );
+    EXPECT( !watcher.isWatched( Mrl( "out" ) ) );
+    /* only the local directories are watched */
+    watcher.watch( "http://example.com/" );
+    EXPECT( !watcher.isWatched( "http://example.com/" ) );
+
+    run = "files";
+    EXPECT( Touch( "tree/a" ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree" ) ) );
+    cb.reset();
+    EXPECT( Rename( "tree/a", "tree/b" ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree" ) ) );
+    cb.reset();
+    EXPECT( unlink( Path( "tree/b" ).c_str() ) == 0 );
+    EXPECT( WaitChanged( cb, Mrl( "tree" ) ) );
+    cb.reset();
+    EXPECT( Touch( "tree/sub/nested/c" ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree/sub/nested" ) ) );
+    /* through the link out of the tree */
+    EXPECT( Touch( "tree/outlink/d" ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree/outlink" ) ) );
+
+    run = "settle";
+    /* only the topmost changed directories are reported */
+    EXPECT( Touch( "tree/sub/e" ) );
+    EXPECT( Touch( "tree/f" ) );
+    EXPECT( cb.waitFor( [&] { return !cb.m_settled.empty(); },
+                        SETTLE_TIMEOUT ) );
+    EXPECT( cb.hasSettled( Mrl( "tree" ) ) );
+    EXPECT( !cb.hasSettled( Mrl( "tree/sub" ) ) );
+    EXPECT( !cb.hasSettled( Mrl( "tree/sub/nested" ) ) );
+
+    run = "new directory";
+    cb.reset();
+    EXPECT( vlc_mkdir( Path( "tree/new" ).c_str(), 0755 ) == 0 );
+    /* the new directory is watched before its parent is reported */
+    EXPECT( WaitChanged( cb, Mrl( "tree" ) ) );
+    EXPECT( watcher.isWatched( Mrl( "tree/new" ) ) );
+    EXPECT( Touch( "tree/new/g" ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree/new" ) ) );
+    /* a link to a parent created later is not followed either */
+    EXPECT( symlink( "..", Path( "tree/new/up" ).c_str() ) == 0 );
+    EXPECT( vlc_mkdir( Path( "tree/new/dir" ).c_str(), 0755 ) == 0 );
+    EXPECT( WaitWatched( cb, watcher, Mrl( "tree/new/dir" ), true ) );
+    EXPECT( !watcher.isWatched( Mrl( "tree/new/up" ) ) );
+
+    run = "moved directory";
+    cb.reset();
+    EXPECT( Rename( "tree/sub", "tree/moved" ) );
+    EXPECT( WaitWatched( cb, watcher, Mrl( "tree/moved/nested" ), true ) );
+    EXPECT( !watcher.isWatched( Mrl( "tree/sub" ) ) );
+    EXPECT( !watcher.isWatched( Mrl( "tree/sub/nested" ) ) );
+    /* the previous listings must be dropped */
+    EXPECT( WaitChanged( cb, Mrl( "tree/sub" ) ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree/sub/nested" ) ) );
+    cb.reset();
+    EXPECT( Touch( "tree/moved/nested/h" ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree/moved/nested" ) ) );
+    /* out of the tree */
+    cb.reset();
+    EXPECT( Rename( "tree/moved", "moved" ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree/moved/nested" ) ) );
+    EXPECT( !watcher.isWatched( Mrl( "tree/moved" ) ) );
+
+    run = "removed directory";
+    cb.reset();
+    EXPECT( unlink( Path( "tree/new/g" ).c_str() ) == 0 );
+    EXPECT( rmdir( Path( "tree/new/dir" ).c_str() ) == 0 );
+    EXPECT( WaitChanged( cb, Mrl( "tree/new/dir" ) ) );
+    EXPECT( WaitWatched( cb, watcher, Mrl( "tree/new/dir" ), false ) );
+    EXPECT( watcher.isWatched( Mrl( "tree/new" ) ) );
+
+    run = "unwatch";
+    cb.reset();
+    watcher.unwatch( Mrl( "tree" ) );
+    EXPECT( WaitWatched( cb, watcher, Mrl( "tree" ), false ) );
+    EXPECT( !watcher.isWatched( Mrl( "tree/new" ) ) );
+    EXPECT( !watcher.isWatched( Mrl( "tree/outlink" ) ) );
+    /* the changes made while unwatched won't be reported: the listings
+     * must be dropped */
+    EXPECT( WaitChanged( cb, Mrl( "tree" ) ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree/new" ) ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree/outlink" ) ) );
+    /* the events are in order: nothing comes from the root once another
+     * watched directory is reported */
+    watcher.watch( s_rootMrl + "out" );
+    EXPECT( WaitWatched( cb, watcher, Mrl( "out" ), true ) );
+    cb.reset();
+    EXPECT( Touch( "tree/i" ) );
+    EXPECT( Touch( "out/j" ) );
+    EXPECT( WaitChanged( cb, Mrl( "out" ) ) );
+    EXPECT( !cb.hasChanged( Mrl( "tree" ) ) );
+
+    run = "watch again";
+    EXPECT( vlc_mkdir( Path( "tree/new/later" ).c_str(), 0755 ) == 0 );
+    watcher.watch( Mrl( "tree" ) );
+    EXPECT( WaitWatched( cb, watcher, Mrl( "tree/new/later" ), true ) );
+    EXPECT( watcher.isWatched( Mrl( "tree" ) ) );
+    cb.reset();
+    EXPECT( Touch( "tree/new/k" ) );
+    EXPECT( WaitChanged( cb, Mrl( "tree/new" ) ) );
+
+    ret = 0;
+end:
+    return ret;
+}
+
+static unsigned MaxQueuedEvents()
+{
+    unsigned max = 16384;
+    FILE* file = vlc_fopen( "/proc/sys/fs/inotify/max_queued_events", "r" );
+    if ( file != nullptr )
+    {
+        if ( fscanf( file, "%u", &max ) != 1 )
+            max = 16384;
+        fclose( file );
+    }
+    return max;
+}
+
+static int TestOverflow( vlc_object_t* obj )
+{
+    const char* run = "overflow";
+    WatcherCb cb;
+    SDWatcher watcher( obj, cb );
+    int ret = 1;
+
+    if ( !watcher.start() )
+        return 77;
+
+    EXPECT( vlc_mkdir( Path( "overflow" ).c_str(), 0755 ) == 0 );
+    watcher.watch( Mrl( "overflow" ) );
+    EXPECT( WaitWatched( cb, watcher, Mrl( "overflow" ), true ) );
+
+    {
+        /* hold the watcher thread in the first callback while the queue
+         * fills up: each file adds a create, a close and a delete event */
+        cb.setBlocked( true );
+        EXPECT( Touch( "overflow/first" ) );
+        EXPECT( WaitChanged( cb, Mrl( "overflow" ) ) );
+
+        unsigned count = MaxQueuedEvents() / 3 + 1;
+        for ( unsigned i = 0; i < count; i++ )
+        {
+            std::string name = "overflow/" + std::to_string( i );
+            if ( !Touch( name ) || unlink( Path( name ).c_str() ) )
+            {
+                cb.setBlocked( false );
+                BAILOUT( run );
+            }
+        }
+        cb.setBlocked( false );
+    }
+    EXPECT( cb.waitFor( [&] { return cb.m_overflows > 0; }, EVENT_TIMEOUT ) );
+
+    /* the events are still reported afterwards */
+    cb.reset();
+    EXPECT( Touch( "overflow/last" ) );
+    EXPECT( WaitChanged( cb, Mrl( "overflow" ) ) );
+
+    ret = 0;
+end:
+    return ret;
+}
+
+int main( void )
+{
+    test_init();
+
+    char dir[] = "/tmp/vlc-ml-watcher-XXXXXX";
+    if ( mkdtemp( dir ) == nullptr )
+        return 77;
+    s_root = dir;
+    char* mrl = vlc_path2uri( dir, "file" );
+    assert( mrl != nullptr );
+    s_rootMrl = std::string( mrl ) + '/';
+    free( mrl );
+
+    libvlc_instance_t* vlc = libvlc_new( test_defaults_nargs,
+                                         test_defaults_args );
+    assert( vlc != nullptr );
+    vlc_object_t* obj = VLC_OBJECT( vlc->p_libvlc_int );
+
+    int ret = TestOverflow( obj );
+    if ( ret == 0 )
+        ret = TestTree( obj );
+
+    libvlc_release( vlc );
+    nftw( dir, RemoveEntry, 16, FTW_DEPTH | FTW_PHYS );
+
+    return ret;
+}
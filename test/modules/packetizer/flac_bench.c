@@ -0,0 +1,287 @@
+/*****************************************************************************
+ * flac_bench.c: FLAC demux and packetizer throughput benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_modules_packetizer_flac_bench [file]
+ *
+ * Measures the CRC-16 throughput, then runs the FLAC demuxer, and thus the
+ * FLAC packetizer, over a FLAC file. Without file, the stream is generated:
+ * 16 bits stereo frames of 4096 verbatim samples of noise, which also makes
+ * the packetizer check a false sync code every other frame or so. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_crc.h>
+#include <vlc_demux.h>
+#include <vlc_es_out.h>
+#include <vlc_stream.h>
+#include <vlc_tick.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BENCH_MIN_DURATION VLC_TICK_FROM_MS(500)
+
+#define GEN_FRAMES     2000
+#define GEN_BLOCKSIZE  4096
+#define GEN_CHANNELS   2
+
+static void bench_crc(const uint8_t *p_data, size_t i_data)
+{
+    static const size_t sizes[] = { 16, 256, 16384 };
+
+    for (size_t i = 0; i < ARRAY_SIZE(sizes); i++)
+    {
+        size_t i_size = __MIN(sizes[i], i_data);
+        size_t i_bytes = 0;
+        uint16_t crc = 0;
+        vlc_tick_t i_start = vlc_tick_now(), i_elapsed;
+        do
+        {
+            for (size_t i_pos = 0; i_pos + i_size <= i_data; i_pos += i_size)
+                crc ^= vlc_crc16(0, &p_data[i_pos], i_size);
+            i_bytes += i_data / i_size * i_size;
+            i_elapsed = vlc_tick_now() - i_start;
+        } while (i_elapsed < BENCH_MIN_DURATION);
+
+        printf("crc16 %6zu bytes %8.2f GB/s  (%04x)\n", i_size,
+               (double) i_bytes / secf_from_vlc_tick(i_elapsed) / 1e9, crc);
+    }
+}
+
+struct bench_es_out
+{
+    es_out_t es_out;
+    unsigned i_frames;
+    size_t   i_bytes;
+};
+
+static es_out_id_t *EsOutAdd(es_out_t *out, input_source_t *in,
+                             const es_format_t *fmt)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in); VLC_UNUSED(fmt);
+    return (es_out_id_t *) out;
+}
+
+static int EsOutSend(es_out_t *out, es_out_id_t *id, block_t *block)
+{
+    struct bench_es_out *ctx = container_of(out, struct bench_es_out, es_out);
+    VLC_UNUSED(id);
+
+    ctx->i_frames++;
+    ctx->i_bytes += block->i_buffer;
+    block_Release(block);
+    return VLC_SUCCESS;
+}
+
+static void EsOutDel(es_out_t *out, es_out_id_t *id)
+{
+    VLC_UNUSED(out); VLC_UNUSED(id);
+}
+
+static int EsOutControl(es_out_t *out, input_source_t *in, int query,
+                        va_list args)
+{
+    VLC_UNUSED(out); VLC_UNUSED(in); VLC_UNUSED(query); VLC_UNUSED(args);
+    return VLC_EGENERIC;
+}
+
+static void EsOutDestroy(es_out_t *out)
+{
+    VLC_UNUSED(out);
+}
+
+static const struct es_out_callbacks es_out_cbs =
+{
+    .add = EsOutAdd,
+    .send = EsOutSend,
+    .del = EsOutDel,
+    .control = EsOutControl,
+    .destroy = EsOutDestroy,
+};
+
+static int bench_demux(libvlc_instance_t *vlc, uint8_t *p_data, size_t i_data)
+{
+    struct bench_es_out out = { .es_out = { .cbs = &es_out_cbs } };
+    unsigned i_passes = 0;
+    vlc_tick_t i_start = vlc_tick_now(), i_elapsed;
+    do
+    {
+        stream_t *s = vlc_stream_MemoryNew(vlc->p_libvlc_int, p_data, i_data,
+                                           true);
+        if (!s)
+            return 1;
+
+        demux_t *demux = demux_New(VLC_OBJECT(vlc->p_libvlc_int), "flac",
+                                   INPUT_ITEM_URI_NOP, s, &out.es_out);
+        if (!demux)
+        {
+            vlc_stream_Delete(s);
+            return 1;
+        }
+
+        while (demux_Demux(demux) == VLC_DEMUXER_SUCCESS);
+        demux_Delete(demux);
+
+        i_passes++;
+        i_elapsed = vlc_tick_now() - i_start;
+    } while (i_elapsed < BENCH_MIN_DURATION);
+
+    double f_secs = secf_from_vlc_tick(i_elapsed);
+    printf("demux %8.1f MB/s  %8.0f frames/s  %u frames  %zu bytes\n",
+           (double) i_data * i_passes / f_secs / 1e6,
+           out.i_frames / f_secs, out.i_frames / i_passes,
+           out.i_bytes / i_passes);
+    return 0;
+}
+
+static uint8_t *load_file(const char *psz_path, size_t *pi_data)
+{
+    FILE *f = fopen(psz_path, "rb");
+    if (!f)
+        return NULL;
+
+    uint8_t *p_data = NULL;
+    size_t i_data = 0, i_alloc = 0;
+    for (;;)
+    {
+        if (i_data == i_alloc)
+        {
+            i_alloc = i_alloc ? i_alloc * 2 : 1 << 20;
+            uint8_t *p_realloc = realloc(p_data, i_alloc);
+            if (!p_realloc)
+                break;
+            p_data = p_realloc;
+        }
+        size_t i_read = fread(&p_data[i_data], 1, i_alloc - i_data, f);
+        if (i_read == 0)
+            break;
+        i_data += i_read;
+    }
+    fclose(f);
+
+    *pi_data = i_data;
+    return p_data;
+}
+
+static uint8_t *generate_data(size_t *pi_data)
+{
+    const size_t i_frame = 7 + GEN_CHANNELS * (1 + GEN_BLOCKSIZE * 2) + 2;
+    const size_t i_alloc = 4 + 4 + 34 + GEN_FRAMES * (i_frame + 4);
+    uint8_t *p_data = malloc(i_alloc);
+    if (!p_data)
+        return NULL;
+
+    /* STREAMINFO, as the last metadata block */
+    uint8_t *p = p_data;
+    memcpy(p, "fLaC\x80\x00\x00\x22", 8);
+    p += 8;
+    SetWBE(&p[0], GEN_BLOCKSIZE);
+    SetWBE(&p[2], GEN_BLOCKSIZE);
+    memset(&p[4], 0, 6); /* unknown frame sizes */
+    /* 44100 Hz (20), channels - 1 (3), bits per sample - 1 (5),
+     * samples (36) */
+    uint64_t i_info = ((uint64_t)44100 << 44)
+                    | ((uint64_t)(GEN_CHANNELS - 1) << 41)
+                    | ((uint64_t)15 << 36)
+                    | (uint64_t)GEN_FRAMES * GEN_BLOCKSIZE;
+    SetQWBE(&p[10], i_info);
+    memset(&p[18], 0, 16); /* no MD5 */
+    p += 34;
+
+    srand(42);
+    for (unsigned i = 0; i < GEN_FRAMES; i++)
+    {
+        uint8_t *p_frame = p;
+
+        /* fixed blocksize, 4096 samples, 44.1 kHz, independent channels,
+         * 16 bits */
+        *p++ = 0xff;
+        *p++ = 0xf8;
+        *p++ = 0xc9;
+        *p++ = ((GEN_CHANNELS - 1) << 4) | 0x08;
+        /* UTF-8 coded frame number */
+        if (i < 0x80)
+            *p++ = i;
+        else if (i < 0x800)
+        {
+            *p++ = 0xc0 | (i >> 6);
+            *p++ = 0x80 | (i & 0x3f);
+        }
+        else
+        {
+            *p++ = 0xe0 | (i >> 12);
+            *p++ = 0x80 | ((i >> 6) & 0x3f);
+            *p++ = 0x80 | (i & 0x3f);
+        }
+        *p = vlc_crc8(0, p_frame, p - p_frame);
+        p++;
+
+        for (unsigned c = 0; c < GEN_CHANNELS; c++)
+        {
+            *p++ = 0x02; /* verbatim */
+            for (unsigned j = 0; j < GEN_BLOCKSIZE * 2; j++)
+                *p++ = rand();
+        }
+
+        SetWBE(p, vlc_crc16(0, p_frame, p - p_frame));
+        p += 2;
+    }
+
+    *pi_data = p - p_data;
+    return p_data;
+}
+
+int main(int argc, char *argv[])
+{
+    size_t i_data;
+    uint8_t *p_data = argc > 1 ? load_file(argv[1], &i_data)
+                               : generate_data(&i_data);
+    if (!p_data)
+    {
+        fprintf(stderr, "can't load the data\n");
+        return 1;
+    }
+
+    printf("%zu bytes\n", i_data);
+    bench_crc(p_data, i_data);
+
+    test_init();
+    libvlc_instance_t *vlc = libvlc_new(0, NULL);
+    if (!vlc)
+    {
+        free(p_data);
+        return 1;
+    }
+
+    int i_ret = bench_demux(vlc, p_data, i_data);
+    if (i_ret)
+        fprintf(stderr, "can't demux the data\n");
+
+    libvlc_release(vlc);
+    free(p_data);
+    return i_ret;
+}
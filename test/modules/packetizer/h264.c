@@ -96,6 +96,14 @@ const uint8_t test_samples_raw_h264[] = {
 };
 const size_t test_samples_raw_h264_len = 761;
 
+static bool mark_h264_slice(uint8_t *p_nal, size_t i_nal, unsigned i_slice)
+{
+    VLC_UNUSED(i_slice);
+    /* identical slice headers belong to the same picture */
+    const uint8_t i_type = p_nal[0] & 0x1f;
+    return i_nal > 1 && (i_type == 1 || i_type == 5);
+}
+
 int main(void)
 {
     test_init();
@@ -113,6 +121,9 @@ int main(void)
     params.i_frame_count = 2*25;
     params.b_extra = true;
 
+    /* output of the packetizer before the slices were gathered in place,
+     * which must stay the same byte for byte */
+    params.i_hash = UINT64_C(0x7f0decaf024a2694);
     params.i_read_size = 500;
     RUN("block 500", test_packetize,
         test_samples_raw_h264, test_samples_raw_h264_len, 0);
@@ -120,14 +131,29 @@ int main(void)
     params.i_rate_num = 60000;
     params.i_rate_den = 1001;
     params.i_read_size = 8;
+    params.i_hash = UINT64_C(0xd8f87175ce5ddad0);
     RUN("block 8", test_packetize,
         test_samples_raw_h264, test_samples_raw_h264_len, 0);
 
     params.i_frame_count = 1*25;
     params.i_read_size = 500;
+    params.i_hash = UINT64_C(0xd99ca2139a592278);
     RUN("skip 1st Iframe", test_packetize,
         test_samples_raw_h264 + 10, test_samples_raw_h264_len - 10, 0);
 
+    /* 4K like, 68 slices per picture */
+    size_t i_sliced;
+    uint8_t *p_sliced = build_multislice(test_samples_raw_h264,
+                                         test_samples_raw_h264_len,
+                                         68, 2000, mark_h264_slice, &i_sliced);
+    if(!p_sliced)
+        BAILOUT("multislice");
+    params.i_frame_count = 2*25;
+    params.i_read_size = 65536;
+    params.i_hash = UINT64_C(0x0a6e70d993e98b21);
+    RUN("68 slices", test_packetize, p_sliced, i_sliced, 0);
+    free(p_sliced);
+
     libvlc_release(vlc);
     return 0;
 }
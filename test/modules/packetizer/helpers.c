@@ -77,19 +77,121 @@ static int run_annexb_sets( const uint8_t *p_set, const uint8_t *p_end,
         return i_ret;
 
     /* Perform same tests on simd optimized code */
-    if( startcode_FindAnnexB_Bits != startcode_FindAnnexB )
+#ifdef CAN_COMPILE_SSE2
+    if( vlc_CPU_SSE2() )
     {
-        printf("checking asm:\n");
+        printf("checking sse2:\n");
         i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
-                           startcode_FindAnnexB );
+                           startcode_FindAnnexB_SSE2 );
         if( i_ret != 0 )
             return i_ret;
     }
-    else printf("asm not built in, skipping test:\n");
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if( vlc_CPU_AVX2() )
+    {
+        printf("checking avx2:\n");
+        i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                           startcode_FindAnnexB_AVX2 );
+        if( i_ret != 0 )
+            return i_ret;
+    }
+#endif
+#ifdef HAVE_STARTCODE_NEON
+    printf("checking neon:\n");
+    i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                       startcode_FindAnnexB_NEON );
+    if( i_ret != 0 )
+        return i_ret;
+#endif
 
+    printf("checking default:\n");
+    i_ret = check_set( p_set, p_end, p_results, i_results, i_results_offset,
+                       startcode_FindAnnexB );
+    if( i_ret != 0 )
+        return i_ret;
+
+    return 0;
+}
+
+/* Compare a lookup against the byte by byte one on zero rich data, for all
+ * the buffer alignments and sizes around the vector widths */
+static int check_random_set( const uint8_t *p_data,
+                             const uint8_t *(*pf_find)(const uint8_t *, const uint8_t *) )
+{
+    for( size_t i_offset = 0; i_offset < 64; i_offset++ )
+    {
+        for( size_t i_size = 0; i_size < 200; i_size++ )
+        {
+            const uint8_t *p_set = &p_data[i_offset];
+            const uint8_t *p_end = p_set + i_size;
+            const uint8_t *p = p_set, *p_ref;
+            do
+            {
+                p_ref = NULL;
+                for( const uint8_t *q = p; q + 3 <= p_end; q++ )
+                {
+                    if( q[0] == 0 && q[1] == 0 && q[2] == 1 )
+                    {
+                        p_ref = q;
+                        break;
+                    }
+                }
+                if( pf_find( p, p_end ) != p_ref )
+                {
+                    printf("mismatch offset %zu size %zu\n", i_offset, i_size);
+                    return 1;
+                }
+                if( p_ref )
+                    p = p_ref + 1;
+            } while( p_ref );
+        }
+    }
     return 0;
 }
 
+static int run_random_sets( void )
+{
+    uint8_t *p_data = malloc( 64 + 200 );
+    if( !p_data )
+        return 0;
+
+    srand( 42 );
+    for( size_t i = 0; i < 64 + 200; i++ )
+    {
+        int r = rand() % 8;
+        p_data[i] = r < 5 ? 0 : r == 5 ? 1 : rand();
+    }
+
+    int i_ret;
+    printf("checking bits code:\n");
+    i_ret = check_random_set( p_data, startcode_FindAnnexB_Bits );
+#ifdef CAN_COMPILE_SSE2
+    if( i_ret == 0 && vlc_CPU_SSE2() )
+    {
+        printf("checking sse2:\n");
+        i_ret = check_random_set( p_data, startcode_FindAnnexB_SSE2 );
+    }
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if( i_ret == 0 && vlc_CPU_AVX2() )
+    {
+        printf("checking avx2:\n");
+        i_ret = check_random_set( p_data, startcode_FindAnnexB_AVX2 );
+    }
+#endif
+#ifdef HAVE_STARTCODE_NEON
+    if( i_ret == 0 )
+    {
+        printf("checking neon:\n");
+        i_ret = check_random_set( p_data, startcode_FindAnnexB_NEON );
+    }
+#endif
+
+    free( p_data );
+    return i_ret;
+}
+
 int main( void )
 {
     const uint8_t test1_annexbdata[] = { 0, 0, 0, 1, 0x55, 0x55, 0x55, 0x55, 0x55, // 9
@@ -134,5 +236,6 @@ int main( void )
             return i_ret;
     }
 
-    return 0;
+    printf("* Running tests on random sets:\n");
+    return run_random_sets();
 }
@@ -114,6 +114,16 @@ const uint8_t test_samples_raw_h265[] = {
 };
 const size_t test_samples_raw_h265_len = 979;
 
+static bool mark_hevc_slice(uint8_t *p_nal, size_t i_nal, unsigned i_slice)
+{
+    if(i_nal < 3 || ((p_nal[0] >> 1) & 0x3f) >= 32)
+        return false;
+    /* not the first_slice_segment_in_pic_flag */
+    if(i_slice > 0)
+        p_nal[2] &= 0x7f;
+    return true;
+}
+
 int main(void)
 {
     test_init();
@@ -131,6 +141,9 @@ int main(void)
     params.i_frame_count = 2*25;
     params.b_extra = true;
 
+    /* output of the packetizer before the slices were gathered in place,
+     * which must stay the same byte for byte */
+    params.i_hash = UINT64_C(0x59a7f2159029d0c6);
     params.i_read_size = 500;
     RUN("block 500", test_packetize,
         test_samples_raw_h265, test_samples_raw_h265_len, 0);
@@ -138,14 +151,29 @@ int main(void)
     params.i_rate_num = 60000;
     params.i_rate_den = 1001;
     params.i_read_size = 8;
+    params.i_hash = UINT64_C(0xa66c64cf92d20da8);
     RUN("block 8", test_packetize,
         test_samples_raw_h265, test_samples_raw_h265_len, 0);
 
     params.i_frame_count = 1*25 + 4 /* RASL from previous GOP */;
     params.i_read_size = 500;
+    params.i_hash = UINT64_C(0xb6652947347be917);
     RUN("skip 1st Iframe", test_packetize,
         test_samples_raw_h265 + 10, test_samples_raw_h265_len - 10, 0);
 
+    /* 4K like, 68 slices per picture */
+    size_t i_sliced;
+    uint8_t *p_sliced = build_multislice(test_samples_raw_h265,
+                                         test_samples_raw_h265_len,
+                                         68, 2000, mark_hevc_slice, &i_sliced);
+    if(!p_sliced)
+        BAILOUT("multislice");
+    params.i_frame_count = 2*25;
+    params.i_read_size = 65536;
+    params.i_hash = UINT64_C(0x5672ec107e0e1de4);
+    RUN("68 slices", test_packetize, p_sliced, i_sliced, 0);
+    free(p_sliced);
+
     libvlc_release(vlc);
     return 0;
 }
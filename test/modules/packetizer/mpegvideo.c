@@ -159,6 +159,7 @@ int main(void)
     params.i_rate_den = 0;
     params.i_frame_count = 2*25;
     params.b_extra = false;
+    params.i_hash = 0;
 
     params.i_read_size = 500;
     RUN("block 500", test_packetize,
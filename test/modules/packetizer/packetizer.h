@@ -40,6 +40,7 @@ struct params_s
     unsigned i_read_size;
     unsigned i_frame_count;
     bool b_extra;
+    uint64_t i_hash; /* of the output access units, 0 to skip the check */
 };
 
 #define BAILOUT(run) { fprintf(stderr, "failed %s line %d\n", run, __LINE__); \
@@ -92,6 +93,20 @@ static decoder_t *create_packetizer(libvlc_instance_t *vlc,
     return p_pack;
 }
 
+/* FNV-1a, over the properties then the data of each access unit */
+static uint64_t hash_block(uint64_t i_hash, const block_t *p_block)
+{
+    const uint64_t props[] = {
+        p_block->i_buffer, p_block->i_flags, p_block->i_length,
+    };
+    for(size_t i = 0; i < sizeof(props) * 8; i += 8)
+        i_hash = (i_hash ^ ((props[i / 64] >> (i % 64)) & 0xff))
+               * 0x100000001b3;
+    for(size_t i = 0; i < p_block->i_buffer; i++)
+        i_hash = (i_hash ^ p_block->p_buffer[i]) * 0x100000001b3;
+    return i_hash;
+}
+
 static int test_packetize(const char *run,
                           const uint8_t *p_data, size_t i_data,
                           const struct params_s *params)
@@ -145,6 +160,15 @@ static int test_packetize(const char *run,
     {
         EXPECT(outchain != NULL);
     }
+    uint64_t i_hash = 0xcbf29ce484222325;
+    for(const block_t *b = outchain; b; b = b->p_next)
+        i_hash = hash_block(i_hash, b);
+    if(params->i_hash && i_hash != params->i_hash)
+    {
+        fprintf(stderr, "%s: output hash %016"PRIx64
+                ", expected %016"PRIx64"\n", run, i_hash, params->i_hash);
+        BAILOUT(run);
+    }
     block_ChainRelease(outchain);
 
     EXPECT(!!params->b_extra == !!p->fmt_out.i_extra);
@@ -155,3 +179,63 @@ static int test_packetize(const char *run,
 
     return OK;
 }
+
+/* Repeats every VCL NAL of an Annex B sample as i_slices slices of the same
+ * picture, each padded to i_slice_size bytes, as with high resolution
+ * multi sliced streams. pf_slice() returns whether the NAL is a VCL one and
+ * marks the copies as following slices. */
+typedef bool (*slice_cb)(uint8_t *p_nal, size_t i_nal, unsigned i_slice);
+
+static inline uint8_t * build_multislice(const uint8_t *p_data, size_t i_data,
+                                         unsigned i_slices, size_t i_slice_size,
+                                         slice_cb pf_slice, size_t *pi_out)
+{
+    size_t i_max = i_data * i_slices + i_data / 4 * i_slices * i_slice_size;
+    uint8_t *p_out = malloc(i_max);
+    if(!p_out)
+        return NULL;
+    size_t i_out = 0;
+
+    const uint8_t *p_end = &p_data[i_data];
+    const uint8_t *p = p_data;
+    while(p + 3 <= p_end)
+    {
+        if(p[0] != 0 || p[1] != 0 || p[2] != 1)
+        {
+            p++;
+            continue;
+        }
+        const uint8_t *p_nal = p + 3;
+        const uint8_t *p_next = p_nal;
+        while(p_next + 3 <= p_end &&
+              (p_next[0] != 0 || p_next[1] != 0 || p_next[2] != 1))
+            p_next++;
+        if(p_next + 3 > p_end)
+            p_next = p_end;
+        size_t i_nal = p_next - p_nal;
+        while(i_nal > 1 && p_nal[i_nal - 1] == 0)
+            i_nal--;
+
+        for(unsigned i = 0; i < i_slices; i++)
+        {
+            uint8_t *p_dst = &p_out[i_out];
+            if(i_out + 4 + i_nal + i_slice_size > i_max)
+                break;
+            memcpy(p_dst, "\x00\x00\x00\x01", 4);
+            memcpy(&p_dst[4], p_nal, i_nal);
+            if(!pf_slice(&p_dst[4], i_nal, i))
+            {
+                i_out += 4 + i_nal;
+                break;
+            }
+            /* random payload, without any startcode */
+            for(size_t j = 0; j < i_slice_size; j++)
+                p_dst[4 + i_nal + j] = 1 + (j * 7 + i) % 255;
+            i_out += 4 + i_nal + i_slice_size;
+        }
+        p = p_next;
+    }
+
+    *pi_out = i_out;
+    return p_out;
+}
@@ -0,0 +1,293 @@
+/*****************************************************************************
+ * slice_bench.c: H.264/HEVC slice header parsing benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_modules_packetizer_slice_bench [slice size in KiB...]
+ *
+ * Runs the H.264 and HEVC slice header parsers of the packetizers over intra
+ * slices of the given sizes (2, 32 and 256 KiB by default), as found in high
+ * bitrate intra only streams. Every slice starts with the IDR (H.264) or CRA
+ * (HEVC) slice header of the packetizer test samples, followed by escaped
+ * random data standing for the entropy coded payload. The slices are spread
+ * over 64 MiB so that each header is read from a cold cache, as it would be
+ * from a freshly demuxed block.
+ *
+ * Reports the time spent per slice header and the matching bitrate above
+ * which the header parsing alone would use a whole core. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_tick.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "../modules/packetizer/h264_nal.h"
+#include "../modules/packetizer/h264_slice.h"
+#include "../modules/packetizer/hevc_nal.h"
+
+#define BENCH_MIN_DURATION VLC_TICK_FROM_MS(500)
+#define BENCH_DATA_SIZE    (64 << 20)
+
+/* Parameter sets and intra slice headers of h264.c and hevc.c samples,
+ * without startcodes */
+static const uint8_t h264_sps[] = {
+    0x67, 0xf4, 0x00, 0x0a, 0x91, 0x9b, 0x2b, 0xd0, 0x80, 0x00, 0x00, 0x03,
+    0x00, 0x80, 0x00, 0x00, 0x19, 0x07, 0x89, 0x12, 0xcb,
+};
+static const uint8_t h264_pps[] = {
+    0x68, 0xeb, 0xec, 0x44, 0x84, 0x40,
+};
+static const uint8_t h264_idr[] = {
+    0x65, 0x88, 0x84, 0x00, 0x37, 0xff, 0xfe, 0xf5, 0xdb, 0xf3, 0x2c, 0xac,
+    0x66, 0x67, 0xff,
+};
+
+static const uint8_t hevc_vps[] = {
+    0x40, 0x01, 0x0c, 0x01, 0xff, 0xff, 0x04, 0x08, 0x00, 0x00, 0x03, 0x00,
+    0x9e, 0x08, 0x00, 0x00, 0x03, 0x00, 0x00, 0x1e, 0x95, 0x98, 0x09,
+};
+static const uint8_t hevc_sps[] = {
+    0x42, 0x01, 0x01, 0x04, 0x08, 0x00, 0x00, 0x03, 0x00, 0x9e, 0x08, 0x00,
+    0x00, 0x03, 0x00, 0x00, 0x1e, 0x90, 0x11, 0x08, 0xb2, 0xca, 0xcd, 0x57,
+    0x95, 0xcd, 0x40, 0x80, 0x80, 0x01, 0x00, 0x00, 0x03, 0x00, 0x01, 0x00,
+    0x00, 0x03, 0x00, 0x19, 0x08,
+};
+static const uint8_t hevc_pps[] = {
+    0x44, 0x01, 0xc1, 0x73, 0x18, 0x31, 0x08, 0x90,
+};
+static const uint8_t hevc_cra[] = {
+    0x28, 0x01, 0xaf, 0x19, 0x80, 0xef, 0xef, 0xcb, 0x5f, 0xfe, 0x52, 0x0b,
+    0xfe, 0xbb, 0x6d, 0xfd, 0x0f, 0xf8,
+};
+
+struct bench_slices
+{
+    uint8_t *p_data;
+    size_t   i_slice; /* stride between slices */
+    size_t   i_count;
+};
+
+/* Fills every slice with the header, then with random data escaped as an
+ * encoder would (xorshift, as rand() would take most of the test timeout) */
+static int generate_slices(struct bench_slices *s, size_t i_slice,
+                           const uint8_t *p_header, size_t i_header)
+{
+    s->i_slice = i_slice;
+    s->i_count = BENCH_DATA_SIZE / i_slice;
+    s->p_data = malloc(s->i_slice * s->i_count);
+    if (!s->p_data)
+        return VLC_ENOMEM;
+
+    uint64_t i_seed = 42;
+    for (size_t i = 0; i < s->i_count; i++)
+    {
+        uint8_t *p = &s->p_data[i * i_slice];
+        memcpy(p, p_header, i_header);
+        unsigned i_zeros = 0;
+        for (size_t j = i_header; j < i_slice; j++)
+        {
+            i_seed ^= i_seed << 13;
+            i_seed ^= i_seed >> 7;
+            i_seed ^= i_seed << 17;
+            uint8_t i_byte = i_seed >> 56;
+            if (i_zeros >= 2 && i_byte <= 3)
+            {
+                p[j++] = 0x03;
+                i_zeros = 0;
+                if (j == i_slice)
+                    break;
+            }
+            p[j] = i_byte;
+            i_zeros = i_byte ? 0 : i_zeros + 1;
+        }
+    }
+    return VLC_SUCCESS;
+}
+
+static void report(const char *psz_name, const struct bench_slices *s,
+                   unsigned i_passes, vlc_tick_t i_elapsed, size_t i_failed)
+{
+    double f_seconds = secf_from_vlc_tick(i_elapsed);
+    double f_headers = (double) s->i_count * i_passes;
+    printf("%-5s %6zu KiB slices: %7.1f ns/header  %9.1f Gb/s%s\n", psz_name,
+           s->i_slice / 1024, f_seconds * 1e9 / f_headers,
+           f_headers * s->i_slice * 8 / f_seconds / 1e9,
+           i_failed ? "  (parsing failed)" : "");
+}
+
+struct h264_sets
+{
+    h264_sequence_parameter_set_t *p_sps;
+    h264_picture_parameter_set_t *p_pps;
+};
+
+static void h264_get_sets(uint8_t i_pps_id, void *priv,
+                          const h264_sequence_parameter_set_t **pp_sps,
+                          const h264_picture_parameter_set_t **pp_pps)
+{
+    VLC_UNUSED(i_pps_id);
+    const struct h264_sets *sets = priv;
+    *pp_sps = sets->p_sps;
+    *pp_pps = sets->p_pps;
+}
+
+static int bench_h264(size_t i_slice)
+{
+    struct h264_sets sets = {
+        .p_sps = h264_decode_sps(h264_sps, sizeof(h264_sps), true),
+        .p_pps = h264_decode_pps(h264_pps, sizeof(h264_pps), true),
+    };
+    struct bench_slices s = { .p_data = NULL };
+    int i_ret = VLC_EGENERIC;
+    if (!sets.p_sps || !sets.p_pps ||
+        generate_slices(&s, i_slice, h264_idr, sizeof(h264_idr)))
+        goto end;
+
+    size_t i_failed = 0;
+    unsigned i_passes = 0;
+    vlc_tick_t i_start = vlc_tick_now(), i_elapsed;
+    do
+    {
+        for (size_t i = 0; i < s.i_count; i++)
+        {
+            h264_slice_t slice;
+            h264_slice_init(&slice);
+            if (!h264_decode_slice(&s.p_data[i * s.i_slice], s.i_slice,
+                                   h264_get_sets, &sets, &slice))
+                i_failed++;
+        }
+        i_passes++;
+        i_elapsed = vlc_tick_now() - i_start;
+    } while (i_elapsed < BENCH_MIN_DURATION);
+
+    report("h264", &s, i_passes, i_elapsed, i_failed);
+    i_ret = i_failed ? VLC_EGENERIC : VLC_SUCCESS;
+end:
+    free(s.p_data);
+    if (sets.p_sps)
+        h264_release_sps(sets.p_sps);
+    if (sets.p_pps)
+        h264_release_pps(sets.p_pps);
+    return i_ret;
+}
+
+struct hevc_sets
+{
+    hevc_video_parameter_set_t *p_vps;
+    hevc_sequence_parameter_set_t *p_sps;
+    hevc_picture_parameter_set_t *p_pps;
+};
+
+static void hevc_get_sets(uint8_t i_pps_id, void *priv,
+                          hevc_picture_parameter_set_t **pp_pps,
+                          hevc_sequence_parameter_set_t **pp_sps,
+                          hevc_video_parameter_set_t **pp_vps)
+{
+    VLC_UNUSED(i_pps_id);
+    const struct hevc_sets *sets = priv;
+    *pp_pps = sets->p_pps;
+    *pp_sps = sets->p_sps;
+    *pp_vps = sets->p_vps;
+}
+
+static int bench_hevc(size_t i_slice)
+{
+    struct hevc_sets sets = {
+        .p_vps = hevc_decode_vps(hevc_vps, sizeof(hevc_vps), true),
+        .p_sps = hevc_decode_sps(hevc_sps, sizeof(hevc_sps), true),
+        .p_pps = hevc_decode_pps(hevc_pps, sizeof(hevc_pps), true),
+    };
+    struct bench_slices s = { .p_data = NULL };
+    int i_ret = VLC_EGENERIC;
+    if (!sets.p_vps || !sets.p_sps || !sets.p_pps ||
+        generate_slices(&s, i_slice, hevc_cra, sizeof(hevc_cra)))
+        goto end;
+
+    size_t i_failed = 0;
+    unsigned i_passes = 0;
+    vlc_tick_t i_start = vlc_tick_now(), i_elapsed;
+    do
+    {
+        for (size_t i = 0; i < s.i_count; i++)
+        {
+            hevc_slice_segment_header_t *p_sh =
+                hevc_decode_slice_header(&s.p_data[i * s.i_slice], s.i_slice,
+                                         true, hevc_get_sets, &sets);
+            if (p_sh)
+                hevc_rbsp_release_slice_header(p_sh);
+            else
+                i_failed++;
+        }
+        i_passes++;
+        i_elapsed = vlc_tick_now() - i_start;
+    } while (i_elapsed < BENCH_MIN_DURATION);
+
+    report("hevc", &s, i_passes, i_elapsed, i_failed);
+    i_ret = i_failed ? VLC_EGENERIC : VLC_SUCCESS;
+end:
+    free(s.p_data);
+    if (sets.p_vps)
+        hevc_rbsp_release_vps(sets.p_vps);
+    if (sets.p_sps)
+        hevc_rbsp_release_sps(sets.p_sps);
+    if (sets.p_pps)
+        hevc_rbsp_release_pps(sets.p_pps);
+    return i_ret;
+}
+
+int main(int argc, char *argv[])
+{
+    static const size_t default_sizes[] = { 2, 32, 256 };
+    size_t sizes[16];
+    size_t i_sizes = 0;
+
+    test_init();
+
+    for (int i = 1; i < argc && i_sizes < ARRAY_SIZE(sizes); i++)
+    {
+        unsigned long i_kib = strtoul(argv[i], NULL, 10);
+        if (i_kib == 0 || i_kib > BENCH_DATA_SIZE / 1024)
+        {
+            fprintf(stderr, "invalid slice size: %s\n", argv[i]);
+            return 1;
+        }
+        sizes[i_sizes++] = i_kib;
+    }
+    if (i_sizes == 0)
+    {
+        memcpy(sizes, default_sizes, sizeof(default_sizes));
+        i_sizes = ARRAY_SIZE(default_sizes);
+    }
+
+    int i_ret = 0;
+    for (size_t i = 0; i < i_sizes; i++)
+        if (bench_h264(sizes[i] * 1024) != VLC_SUCCESS)
+            i_ret = 1;
+    for (size_t i = 0; i < i_sizes; i++)
+        if (bench_hevc(sizes[i] * 1024) != VLC_SUCCESS)
+            i_ret = 1;
+    return i_ret;
+}
@@ -0,0 +1,384 @@
+/*****************************************************************************
+ * startcode_bench.c: Annex B startcode lookup benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_modules_packetizer_startcode_bench [file [fourcc [slices]]]
+ *
+ * Measures the throughput of every startcode lookup usable on this CPU over
+ * an Annex B elementary stream (H.264 by default, or hevc, mpgv, WVC1...),
+ * then runs the packetizer over the same data to estimate the share of its
+ * time spent looking up startcodes, with the byte by byte lookup and with
+ * the default one, and reports the packetizer throughput. Without file, only
+ * the lookups are measured over generated data.
+ *
+ * With a number of slices, every picture of an H.264 or HEVC file is first
+ * repeated as that many slices of 2000 bytes, as in high resolution multi
+ * sliced streams (68 for 4K like pictures). */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_codec.h>
+#include <vlc_modules.h>
+#include <vlc_meta.h>
+#include <vlc_tick.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#include "../modules/packetizer/startcode_helper.h"
+
+#define BENCH_MIN_DURATION VLC_TICK_FROM_MS(500)
+#define BENCH_BLOCK_SIZE   65536
+
+typedef const uint8_t *(*startcode_lookup)(const uint8_t *, const uint8_t *);
+
+static size_t count_startcodes(const uint8_t *p, const uint8_t *end,
+                               startcode_lookup pf_find)
+{
+    size_t i_count = 0;
+    while ((p = pf_find(p, end)) != NULL)
+    {
+        i_count++;
+        p += 3;
+    }
+    return i_count;
+}
+
+/* Returns the duration of a single pass over the data */
+static vlc_tick_t bench_lookup(const char *psz_name, startcode_lookup pf_find,
+                               const uint8_t *p_data, size_t i_data)
+{
+    size_t i_count = 0;
+    unsigned i_passes = 0;
+    vlc_tick_t i_start = vlc_tick_now(), i_elapsed;
+    do
+    {
+        i_count = count_startcodes(p_data, p_data + i_data, pf_find);
+        i_passes++;
+        i_elapsed = vlc_tick_now() - i_start;
+    } while (i_elapsed < BENCH_MIN_DURATION);
+
+    double f_gbps = (double) i_data * i_passes
+                  / secf_from_vlc_tick(i_elapsed) / 1e9;
+    printf("%-8s %8.2f GB/s  %zu startcodes\n", psz_name, f_gbps, i_count);
+    return i_elapsed / i_passes;
+}
+
+struct packetizer_owner
+{
+    decoder_t   packetizer;
+    es_format_t fmt_in;
+};
+
+static void delete_packetizer(decoder_t *p_pack)
+{
+    struct packetizer_owner *owner =
+        container_of(p_pack, struct packetizer_owner, packetizer);
+    if (p_pack->p_module)
+        module_unneed(p_pack, p_pack->p_module);
+    es_format_Clean(&owner->fmt_in);
+    es_format_Clean(&p_pack->fmt_out);
+    if (p_pack->p_description)
+        vlc_meta_Delete(p_pack->p_description);
+    vlc_object_delete(p_pack);
+}
+
+static decoder_t *create_packetizer(libvlc_instance_t *vlc, vlc_fourcc_t codec)
+{
+    struct packetizer_owner *owner;
+    owner = vlc_object_create(vlc->p_libvlc_int, sizeof(*owner));
+    if (!owner)
+        return NULL;
+    decoder_t *p_pack = &owner->packetizer;
+    p_pack->pf_decode = NULL;
+    p_pack->pf_packetize = NULL;
+
+    es_format_Init(&owner->fmt_in, VIDEO_ES, codec);
+    es_format_Init(&p_pack->fmt_out, VIDEO_ES, 0);
+    owner->fmt_in.b_packetized = false;
+    p_pack->fmt_in = &owner->fmt_in;
+
+    p_pack->p_module = module_need(p_pack, "packetizer", NULL, false);
+    if (!p_pack->p_module)
+    {
+        delete_packetizer(p_pack);
+        return NULL;
+    }
+    return p_pack;
+}
+
+static vlc_tick_t packetize(libvlc_instance_t *vlc, vlc_fourcc_t codec,
+                            const uint8_t *p_data, size_t i_data,
+                            unsigned *pi_frames)
+{
+    decoder_t *p = create_packetizer(vlc, codec);
+    if (!p)
+        return VLC_TICK_INVALID;
+
+    unsigned i_frames = 0;
+    vlc_tick_t i_start = vlc_tick_now();
+    for (size_t i_pos = 0; ; i_pos += BENCH_BLOCK_SIZE)
+    {
+        block_t *in = NULL; /* drains once all the data is sent */
+        if (i_pos < i_data)
+        {
+            size_t i_size = __MIN(BENCH_BLOCK_SIZE, i_data - i_pos);
+            in = block_Alloc(i_size);
+            if (!in)
+                break;
+            memcpy(in->p_buffer, &p_data[i_pos], i_size);
+            if (i_pos == 0)
+                in->i_dts = VLC_TICK_0;
+        }
+
+        block_t *out;
+        while ((out = p->pf_packetize(p, in ? &in : NULL)) != NULL)
+        {
+            for (block_t *b = out; b; b = b->p_next)
+                i_frames++;
+            block_ChainRelease(out);
+        }
+        if (i_pos >= i_data)
+            break;
+    }
+    vlc_tick_t i_elapsed = vlc_tick_now() - i_start;
+
+    delete_packetizer(p);
+
+    *pi_frames = i_frames;
+    return i_elapsed;
+}
+
+/* Returns the duration of a single pass over the data */
+static vlc_tick_t bench_packetizer(libvlc_instance_t *vlc, vlc_fourcc_t codec,
+                                   const uint8_t *p_data, size_t i_data)
+{
+    unsigned i_frames = 0, i_passes = 0;
+    vlc_tick_t i_elapsed = 0;
+    do
+    {
+        vlc_tick_t i_pass = packetize(vlc, codec, p_data, i_data, &i_frames);
+        if (i_pass == VLC_TICK_INVALID)
+            return VLC_TICK_INVALID;
+        i_elapsed += i_pass;
+        i_passes++;
+    } while (i_elapsed < BENCH_MIN_DURATION);
+
+    double f_secs = secf_from_vlc_tick(i_elapsed);
+    printf("packetizer %8.2f MB/s  %.0f AU/s  %u frames\n",
+           (double) i_data * i_passes / f_secs / 1e6,
+           (double) i_frames * i_passes / f_secs, i_frames);
+    return i_elapsed / i_passes;
+}
+
+/* Returns whether the NAL is a VCL one, and marks it as a following slice of
+ * the picture if i_slice is not 0 */
+static bool mark_slice(vlc_fourcc_t codec, uint8_t *p_nal, size_t i_nal,
+                       unsigned i_slice)
+{
+    if (codec == VLC_CODEC_H264)
+    {
+        /* identical slice headers belong to the same picture */
+        const uint8_t i_type = p_nal[0] & 0x1f;
+        return i_nal > 1 && (i_type == 1 || i_type == 5);
+    }
+
+    if (i_nal < 3 || ((p_nal[0] >> 1) & 0x3f) >= 32)
+        return false;
+    /* not the first_slice_segment_in_pic_flag */
+    if (i_slice > 0)
+        p_nal[2] &= 0x7f;
+    return true;
+}
+
+/* Repeats every VCL NAL as i_slices slices of the same picture, each padded
+ * to 2000 bytes of payload without startcode */
+static uint8_t *slice_data(vlc_fourcc_t codec, const uint8_t *p_data,
+                           size_t i_data, unsigned i_slices, size_t *pi_out)
+{
+    const size_t i_slice_size = 2000;
+    size_t i_max = i_data * i_slices + i_data / 4 * i_slices * i_slice_size;
+    uint8_t *p_out = malloc(i_max);
+    if (!p_out)
+        return NULL;
+    size_t i_out = 0;
+
+    const uint8_t *p_end = &p_data[i_data];
+    const uint8_t *p = startcode_FindAnnexB(p_data, p_end);
+    while (p != NULL)
+    {
+        const uint8_t *p_nal = p + 3;
+        const uint8_t *p_next = startcode_FindAnnexB(p_nal, p_end);
+        size_t i_nal = (p_next ? p_next : p_end) - p_nal;
+        while (i_nal > 1 && p_nal[i_nal - 1] == 0)
+            i_nal--;
+
+        for (unsigned i = 0; i < i_slices; i++)
+        {
+            uint8_t *p_dst = &p_out[i_out];
+            if (i_out + 4 + i_nal + i_slice_size > i_max)
+                break;
+            memcpy(p_dst, "\x00\x00\x00\x01", 4);
+            memcpy(&p_dst[4], p_nal, i_nal);
+            if (!mark_slice(codec, &p_dst[4], i_nal, i))
+            {
+                i_out += 4 + i_nal;
+                break;
+            }
+            for (size_t j = 0; j < i_slice_size; j++)
+                p_dst[4 + i_nal + j] = 1 + (j * 7 + i) % 255;
+            i_out += 4 + i_nal + i_slice_size;
+        }
+        p = p_next;
+    }
+
+    *pi_out = i_out;
+    return p_out;
+}
+
+static uint8_t *load_file(const char *psz_path, size_t *pi_data)
+{
+    FILE *f = fopen(psz_path, "rb");
+    if (!f)
+        return NULL;
+
+    uint8_t *p_data = NULL;
+    size_t i_data = 0, i_alloc = 0;
+    for (;;)
+    {
+        if (i_data == i_alloc)
+        {
+            i_alloc = i_alloc ? i_alloc * 2 : 1 << 20;
+            uint8_t *p_realloc = realloc(p_data, i_alloc);
+            if (!p_realloc)
+                break;
+            p_data = p_realloc;
+        }
+        size_t i_read = fread(&p_data[i_data], 1, i_alloc - i_data, f);
+        if (i_read == 0)
+            break;
+        i_data += i_read;
+    }
+    fclose(f);
+
+    *pi_data = i_data;
+    return p_data;
+}
+
+static uint8_t *generate_data(size_t *pi_data)
+{
+    /* entropy coded payload, with a NAL every 1500 bytes */
+    const size_t i_data = 64 << 20;
+    uint8_t *p_data = malloc(i_data);
+    if (!p_data)
+        return NULL;
+
+    srand(42);
+    for (size_t i = 0; i < i_data; i++)
+        p_data[i] = rand();
+    for (size_t i = 0; i + 4 < i_data; i += 1500)
+        memcpy(&p_data[i], "\x00\x00\x01\x41", 4);
+
+    *pi_data = i_data;
+    return p_data;
+}
+
+int main(int argc, char *argv[])
+{
+    vlc_fourcc_t codec = VLC_CODEC_H264;
+    if (argc > 2)
+        codec = vlc_fourcc_GetCodecFromString(VIDEO_ES, argv[2]);
+
+    size_t i_data;
+    uint8_t *p_data = argc > 1 ? load_file(argv[1], &i_data)
+                               : generate_data(&i_data);
+    if (p_data && argc > 3)
+    {
+        if (codec != VLC_CODEC_H264 && codec != VLC_CODEC_HEVC)
+        {
+            fprintf(stderr, "can only slice H.264 or HEVC\n");
+            free(p_data);
+            return 1;
+        }
+        uint8_t *p_sliced = slice_data(codec, p_data, i_data,
+                                       strtoul(argv[3], NULL, 0), &i_data);
+        free(p_data);
+        p_data = p_sliced;
+    }
+    if (!p_data)
+    {
+        fprintf(stderr, "can't load the data\n");
+        return 1;
+    }
+
+    printf("%zu bytes\n", i_data);
+    vlc_tick_t i_bits = bench_lookup("bits", startcode_FindAnnexB_Bits,
+                                     p_data, i_data);
+#ifdef CAN_COMPILE_SSE2
+    if (vlc_CPU_SSE2())
+        bench_lookup("sse2", startcode_FindAnnexB_SSE2, p_data, i_data);
+#endif
+#ifdef HAVE_AVX2_INTRINSICS
+    if (vlc_CPU_AVX2())
+        bench_lookup("avx2", startcode_FindAnnexB_AVX2, p_data, i_data);
+#endif
+#ifdef HAVE_STARTCODE_NEON
+    bench_lookup("neon", startcode_FindAnnexB_NEON, p_data, i_data);
+#endif
+    vlc_tick_t i_default = bench_lookup("default", startcode_FindAnnexB,
+                                        p_data, i_data);
+
+    int i_ret = 0;
+    if (argc > 1)
+    {
+        test_init();
+        libvlc_instance_t *vlc = libvlc_new(0, NULL);
+        if (!vlc)
+        {
+            free(p_data);
+            return 1;
+        }
+
+        vlc_tick_t i_packetizer = bench_packetizer(vlc, codec, p_data, i_data);
+        if (i_packetizer > 0)
+        {
+            /* the packetizer uses the default lookup, estimate what it took
+             * with the byte by byte one */
+            vlc_tick_t i_before = i_packetizer - i_default + i_bits;
+            printf("lookup share: %.1f%% with bits, %.1f%% with default\n",
+                   100. * i_bits / i_before, 100. * i_default / i_packetizer);
+        }
+        else
+        {
+            fprintf(stderr, "no packetizer for this codec\n");
+            i_ret = 1;
+        }
+        libvlc_release(vlc);
+    }
+
+    free(p_data);
+    return i_ret;
+}
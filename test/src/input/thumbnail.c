@@ -141,14 +141,16 @@ static void test_thumbnails( libvlc_instance_t* p_vlc )
             p_req = vlc_thumbnailer_RequestByPos( p_thumbnailer, test_params[i].f_pos,
                 test_params[i].b_fast_seek ?
                     VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
-                p_item, test_params[i].i_timeout, thumbnailer_callback, &ctx );
+                p_item, 320, 240, test_params[i].i_timeout,
+                thumbnailer_callback, &ctx );
         }
         else
         {
             p_req = vlc_thumbnailer_RequestByTime( p_thumbnailer, test_params[i].i_time,
                 test_params[i].b_fast_seek ?
                     VLC_THUMBNAILER_SEEK_FAST : VLC_THUMBNAILER_SEEK_PRECISE,
-                p_item, test_params[i].i_timeout, thumbnailer_callback, &ctx );
+                p_item, 0, 0, test_params[i].i_timeout, thumbnailer_callback,
+                &ctx );
         }
         assert( p_req != NULL );
 
@@ -185,7 +187,7 @@ static void test_cancel_thumbnail( libvlc_instance_t* p_vlc )
     assert( p_item != NULL );
 
     vlc_thumbnailer_request_t* p_req = vlc_thumbnailer_RequestByTime( p_thumbnailer,
-        VLC_TICK_INVALID, VLC_THUMBNAILER_SEEK_PRECISE, p_item,
+        VLC_TICK_INVALID, VLC_THUMBNAILER_SEEK_PRECISE, p_item, 0, 0,
         VLC_TICK_INVALID, thumbnailer_callback_cancel, NULL );
 
     vlc_thumbnailer_DestroyRequest( p_thumbnailer, p_req );
@@ -199,6 +201,185 @@ static void test_cancel_thumbnail( libvlc_instance_t* p_vlc )
     vlc_thumbnailer_Release( p_thumbnailer );
 }
 
+#define BATCH_COUNT 10
+#define BATCH_INTERVAL (MOCK_DURATION / BATCH_COUNT)
+
+struct batch_ctx
+{
+    vlc_cond_t cond;
+    vlc_mutex_t lock;
+    size_t i_thumbnails;
+    size_t i_count;
+    char *psz_index;
+    unsigned i_sprite_width;
+    unsigned i_sprite_height;
+    uint8_t i_tile_pixels[4]; /* first byte of each tile of a 2x2 sprite */
+    bool b_done;
+};
+
+static void batch_on_thumbnail( void* data, size_t i_index, vlc_tick_t i_time,
+                                picture_t* thumbnail )
+{
+    struct batch_ctx* p_ctx = data;
+    (void) i_time;
+
+    vlc_mutex_lock( &p_ctx->lock );
+    assert( i_index == p_ctx->i_thumbnails && "Unexpected thumbnail order" );
+    assert( thumbnail != NULL );
+    p_ctx->i_thumbnails++;
+    vlc_mutex_unlock( &p_ctx->lock );
+}
+
+static void batch_on_ended( void* data, size_t i_count, picture_t* sprite,
+                            const char* psz_index )
+{
+    struct batch_ctx* p_ctx = data;
+
+    vlc_mutex_lock( &p_ctx->lock );
+    p_ctx->i_count = i_count;
+    if ( sprite != NULL )
+    {
+        p_ctx->i_sprite_width = sprite->format.i_visible_width;
+        p_ctx->i_sprite_height = sprite->format.i_visible_height;
+        if ( p_ctx->i_sprite_width == 64 && p_ctx->i_sprite_height == 36 )
+        {
+            const plane_t* p = &sprite->p[0];
+            for ( size_t i = 0; i < 4; ++i )
+                p_ctx->i_tile_pixels[i] =
+                    p->p_pixels[(i / 2) * 18 * p->i_pitch + (i % 2) * 32 * 4];
+        }
+        assert( psz_index != NULL );
+        p_ctx->psz_index = strdup( psz_index );
+    }
+    p_ctx->b_done = true;
+    vlc_cond_signal( &p_ctx->cond );
+    vlc_mutex_unlock( &p_ctx->lock );
+}
+
+static const struct vlc_thumbnailer_batch_cbs batch_cbs = {
+    .on_thumbnail = batch_on_thumbnail,
+    .on_ended = batch_on_ended,
+};
+
+static size_t run_batch( vlc_thumbnailer_t* p_thumbnailer, input_item_t* p_item,
+                         const struct vlc_thumbnailer_batch* batch,
+                         struct batch_ctx* p_ctx )
+{
+    p_ctx->i_thumbnails = p_ctx->i_count = 0;
+    p_ctx->psz_index = NULL;
+    p_ctx->i_sprite_width = p_ctx->i_sprite_height = 0;
+    memset( p_ctx->i_tile_pixels, 0, sizeof( p_ctx->i_tile_pixels ) );
+    p_ctx->b_done = false;
+
+    vlc_mutex_lock( &p_ctx->lock );
+    vlc_thumbnailer_request_t* p_req = vlc_thumbnailer_RequestBatch(
+        p_thumbnailer, p_item, batch, VLC_TICK_FROM_SEC( 1 ), &batch_cbs, p_ctx );
+    assert( p_req != NULL );
+
+    while ( p_ctx->b_done == false )
+        vlc_cond_wait( &p_ctx->cond, &p_ctx->lock );
+    assert( p_ctx->i_count == p_ctx->i_thumbnails );
+    vlc_mutex_unlock( &p_ctx->lock );
+
+    vlc_thumbnailer_DestroyRequest( p_thumbnailer, p_req );
+    return p_ctx->i_count;
+}
+
+static void test_batch( libvlc_instance_t* p_vlc )
+{
+    vlc_thumbnailer_t* p_thumbnailer = vlc_thumbnailer_Create(
+                VLC_OBJECT( p_vlc->p_libvlc_int ) );
+    assert( p_thumbnailer != NULL );
+
+    char* psz_mrl;
+    if ( asprintf( &psz_mrl, "mock://video_track_count=1;length=%" PRId64
+                   ";video_chroma=ARGB", MOCK_DURATION ) < 0 )
+        assert( !"Failed to allocate mock mrl" );
+    input_item_t* p_item = input_item_New( psz_mrl, "mock item" );
+    assert( p_item != NULL );
+
+    struct batch_ctx ctx;
+    vlc_cond_init( &ctx.cond );
+    vlc_mutex_init( &ctx.lock );
+
+    /* One request per thumbnail, as done before batches */
+    struct test_ctx single_ctx;
+    vlc_cond_init( &single_ctx.cond );
+    vlc_mutex_init( &single_ctx.lock );
+    single_ctx.test_idx = 0; /* a successful video test */
+
+    vlc_tick_t i_start = vlc_tick_now();
+    for ( size_t i = 0; i < BATCH_COUNT; ++i )
+    {
+        vlc_mutex_lock( &single_ctx.lock );
+        single_ctx.b_done = false;
+        vlc_thumbnailer_request_t* p_req = vlc_thumbnailer_RequestByTime(
+            p_thumbnailer, i * BATCH_INTERVAL, VLC_THUMBNAILER_SEEK_FAST,
+            p_item, 0, 0, VLC_TICK_FROM_SEC( 1 ), thumbnailer_callback,
+            &single_ctx );
+        assert( p_req != NULL );
+        while ( single_ctx.b_done == false )
+            vlc_cond_wait( &single_ctx.cond, &single_ctx.lock );
+        vlc_mutex_unlock( &single_ctx.lock );
+        vlc_thumbnailer_DestroyRequest( p_thumbnailer, p_req );
+    }
+    vlc_tick_t i_single = vlc_tick_now() - i_start;
+
+    /* Every interval up to the end */
+    const struct vlc_thumbnailer_batch interval_batch = {
+        .interval = BATCH_INTERVAL,
+    };
+    i_start = vlc_tick_now();
+    size_t i_count = run_batch( p_thumbnailer, p_item, &interval_batch, &ctx );
+    vlc_tick_t i_batch = vlc_tick_now() - i_start;
+    assert( i_count == BATCH_COUNT );
+
+    printf( "%d thumbnails: %" PRId64 " ms with single requests, %" PRId64
+            " ms with a batch\n", BATCH_COUNT, MS_FROM_VLC_TICK( i_single ),
+            MS_FROM_VLC_TICK( i_batch ) );
+
+    /* Given times, with a sprite sheet of 2 columns */
+    const vlc_tick_t times[] = {
+        VLC_TICK_FROM_SEC( 10 ), VLC_TICK_FROM_SEC( 20 ),
+        MOCK_DURATION - VLC_TICK_FROM_SEC( 10 ),
+    };
+    const struct vlc_thumbnailer_batch sprite_batch = {
+        .times = times,
+        .count = ARRAY_SIZE( times ),
+        .width = 32,
+        .height = 18,
+        .sprite_columns = 2,
+        .sprite_url = "sprite.png",
+    };
+    /* RGBA pictures can be scaled to the tiles by the "scale" converter */
+    free( psz_mrl );
+    if ( asprintf( &psz_mrl, "mock://video_track_count=1;length=%" PRId64
+                   ";video_chroma=RGBA", MOCK_DURATION ) < 0 )
+        assert( !"Failed to allocate mock mrl" );
+    input_item_Release( p_item );
+    p_item = input_item_New( psz_mrl, "mock item" );
+    assert( p_item != NULL );
+
+    i_count = run_batch( p_thumbnailer, p_item, &sprite_batch, &ctx );
+    assert( i_count == ARRAY_SIZE( times ) );
+    assert( ctx.psz_index != NULL );
+    assert( ctx.i_sprite_width == 64 && ctx.i_sprite_height == 36 );
+    assert( !strncmp( ctx.psz_index, "WEBVTT\n", 7 ) );
+    assert( strstr( ctx.psz_index, "\n00:00:10.000 --> 00:00:20.000\n"
+                                   "sprite.png#xywh=0,0,32,18\n" ) );
+    assert( strstr( ctx.psz_index, "sprite.png#xywh=0,18,32,18\n" ) );
+    free( ctx.psz_index );
+    /* The mock frames are filled with a non-zero value at these times, and
+     * were scaled into their tiles, the last tile is left blank */
+    assert( ctx.i_tile_pixels[0] != 0 && ctx.i_tile_pixels[1] != 0
+         && ctx.i_tile_pixels[2] != 0 );
+    assert( ctx.i_tile_pixels[3] == 0 );
+
+    input_item_Release( p_item );
+    free( psz_mrl );
+    vlc_thumbnailer_Release( p_thumbnailer );
+}
+
 int main()
 {
     test_init();
@@ -212,6 +393,7 @@ int main()
 
     test_thumbnails( vlc );
     test_cancel_thumbnail( vlc );
+    test_batch( vlc );
 
     libvlc_release( vlc );
 }
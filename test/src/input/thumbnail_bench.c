@@ -0,0 +1,177 @@
+/*****************************************************************************
+ * thumbnail_bench.c: thumbnailer throughput benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_src_input_thumbnail_bench [-s WIDTHxHEIGHT] file...
+ *
+ * Creates a thumbnail of every file (cover art, pictures, videos...), first
+ * at full size, then passing the thumbnail size (320x240 by default) to the
+ * decoders, and reports the thumbnails per second in both cases, as well as
+ * the size of the pictures output by the thumbnailer.
+ * Set VLC_TEST_TIMEOUT=-1 for large corpora. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../lib/libvlc_internal.h"
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_thumbnailer.h>
+#include <vlc_input_item.h>
+#include <vlc_picture.h>
+#include <vlc_tick.h>
+#include <vlc_url.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+struct bench_ctx
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    bool b_done;
+    unsigned i_width;
+    unsigned i_height;
+};
+
+static void thumbnailer_callback(void *data, picture_t *thumbnail)
+{
+    struct bench_ctx *ctx = data;
+
+    vlc_mutex_lock(&ctx->lock);
+    ctx->i_width = thumbnail ? thumbnail->format.i_visible_width : 0;
+    ctx->i_height = thumbnail ? thumbnail->format.i_visible_height : 0;
+    ctx->b_done = true;
+    vlc_cond_signal(&ctx->cond);
+    vlc_mutex_unlock(&ctx->lock);
+}
+
+static void bench_thumbnails(vlc_thumbnailer_t *thumbnailer,
+                             input_item_t **items, size_t i_items,
+                             unsigned i_width, unsigned i_height)
+{
+    struct bench_ctx ctx;
+    vlc_mutex_init(&ctx.lock);
+    vlc_cond_init(&ctx.cond);
+
+    unsigned i_thumbnails = 0;
+    uint64_t i_pixels = 0;
+    vlc_tick_t i_start = vlc_tick_now();
+
+    for (size_t i = 0; i < i_items; i++)
+    {
+        vlc_mutex_lock(&ctx.lock);
+        ctx.b_done = false;
+
+        vlc_thumbnailer_request_t *req =
+            vlc_thumbnailer_RequestByPos(thumbnailer, .3,
+                                         VLC_THUMBNAILER_SEEK_FAST, items[i],
+                                         i_width, i_height,
+                                         VLC_TICK_FROM_SEC(10),
+                                         thumbnailer_callback, &ctx);
+        if (req == NULL)
+        {
+            vlc_mutex_unlock(&ctx.lock);
+            continue;
+        }
+
+        while (!ctx.b_done)
+            vlc_cond_wait(&ctx.cond, &ctx.lock);
+        vlc_mutex_unlock(&ctx.lock);
+        vlc_thumbnailer_DestroyRequest(thumbnailer, req);
+
+        if (ctx.i_width == 0)
+        {
+            fprintf(stderr, "no thumbnail for %s\n", items[i]->psz_uri);
+            continue;
+        }
+        i_thumbnails++;
+        i_pixels += ctx.i_width * ctx.i_height;
+    }
+
+    double f_secs = secf_from_vlc_tick(vlc_tick_now() - i_start);
+    printf("%4ux%-4u %8.2f thumbnails/s  %u thumbnails  %.2f Mpixels/thumbnail\n",
+           i_width, i_height, i_thumbnails / f_secs, i_thumbnails,
+           i_thumbnails ? i_pixels / 1e6 / i_thumbnails : 0.);
+}
+
+int main(int argc, char *argv[])
+{
+    unsigned i_width = 320, i_height = 240;
+    int i_arg = 1;
+
+    if (argc > 2 && !strcmp(argv[1], "-s"))
+    {
+        if (sscanf(argv[2], "%ux%u", &i_width, &i_height) != 2)
+        {
+            fprintf(stderr, "invalid size %s\n", argv[2]);
+            return 1;
+        }
+        i_arg = 3;
+    }
+    if (i_arg >= argc)
+    {
+        fprintf(stderr, "usage: %s [-s WIDTHxHEIGHT] file...\n", argv[0]);
+        return 1;
+    }
+
+    test_init();
+
+    static const char *args[] = {
+        "--ignore-config",
+        "--no-hw-dec",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    if (!vlc)
+        return 1;
+
+    vlc_thumbnailer_t *thumbnailer =
+        vlc_thumbnailer_Create(VLC_OBJECT(vlc->p_libvlc_int));
+    if (!thumbnailer)
+    {
+        libvlc_release(vlc);
+        return 1;
+    }
+
+    size_t i_items = 0;
+    input_item_t **items = vlc_alloc(argc - i_arg, sizeof(*items));
+    for (int i = i_arg; items && i < argc; i++)
+    {
+        char *psz_uri = vlc_path2uri(argv[i], NULL);
+        if (!psz_uri)
+            continue;
+        input_item_t *item = input_item_New(psz_uri, argv[i]);
+        free(psz_uri);
+        if (item)
+            items[i_items++] = item;
+    }
+
+    bench_thumbnails(thumbnailer, items, i_items, 0, 0);
+    bench_thumbnails(thumbnailer, items, i_items, i_width, i_height);
+
+    for (size_t i = 0; i < i_items; i++)
+        input_item_Release(items[i]);
+    free(items);
+    vlc_thumbnailer_Release(thumbnailer);
+    libvlc_release(vlc);
+    return 0;
+}
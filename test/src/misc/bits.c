@@ -338,6 +338,69 @@ static int test_annexb( const char *psz_tag )
     return 0;
 }
 
+/* Reads the same random fields from an escaped random stream and from its
+ * unescaped copy */
+static int test_annexb_random( const char *psz_tag )
+{
+    uint8_t annexb[1024], unesc[1024];
+    size_t i_unesc = 0;
+    unsigned i_zeros = 0;
+
+    srand( 42 );
+    /* the first byte never starts an escape sequence */
+    annexb[0] = 0x00;
+    unesc[i_unesc++] = annexb[0];
+    for( size_t i = 1; i < ARRAY_SIZE(annexb); i++ )
+    {
+        int r = rand() % 8;
+        annexb[i] = r < 4 ? 0x00 : r < 6 ? 0x03 : rand();
+        if( i_zeros >= 2 && annexb[i] == 0x03 && i + 1 < ARRAY_SIZE(annexb) )
+        {
+            i_zeros = 0; /* escape, dropped */
+            continue;
+        }
+        i_zeros = annexb[i] == 0x00 ? i_zeros + 1 : 0;
+        unesc[i_unesc++] = annexb[i];
+    }
+
+    for( int i_run = 0; i_run < 100; i_run++ )
+    {
+        bs_t bs, bsr;
+        struct hxxx_bsfw_ep3b_ctx_s bsctx;
+        hxxx_bsfw_ep3b_ctx_init( &bsctx );
+        bs_init_custom( &bs, annexb, ARRAY_SIZE(annexb),
+                        &hxxx_bsfw_ep3b_callbacks, &bsctx );
+        bs_init( &bsr, unesc, i_unesc );
+
+        while( !bs_eof( &bsr ) )
+        {
+            int r = rand() % 4;
+            if( r == 0 )
+            {
+                uint_fast32_t v = bs_read_ue( &bsr );
+                test_assert( bs_read_ue( &bs ), v );
+            }
+            else if( r == 1 )
+            {
+                bs_skip( &bsr, i_run );
+                bs_skip( &bs, i_run );
+            }
+            else
+            {
+                uint8_t i_count = rand() % 33;
+                uint32_t v = bs_read( &bsr, i_count );
+                test_assert( bs_read( &bs, i_count ), v );
+            }
+            /* overflows are not accounted the same */
+            if( !bs_eof( &bsr ) )
+                test_assert( bs_pos( &bs ), bs_pos( &bsr ) );
+        }
+        test_assert( bs_eof( &bs ), true );
+    }
+
+    return 0;
+}
+
 
 int main( void )
 {
@@ -376,5 +439,8 @@ int main( void )
     if( test_annexb( "annexb ") )
         return 1;
 
+    if( test_annexb_random( "annexb random" ) )
+        return 1;
+
     return 0;
 }
@@ -0,0 +1,131 @@
+/*****************************************************************************
+ * crc.c: test cyclic redundancy checks
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc_common.h>
+#include <vlc_crc.h>
+
+#include <assert.h>
+#include <stdlib.h>
+
+/* Bit by bit reference */
+static uint32_t crc_bitwise(uint32_t crc, unsigned width, uint32_t poly,
+                            const uint8_t *p, size_t size)
+{
+    const uint32_t top = UINT32_C(1) << (width - 1);
+    const uint32_t mask = top | (top - 1);
+
+    for (size_t i = 0; i < size; i++)
+        for (int j = 7; j >= 0; j--)
+        {
+            bool bit = ((crc & top) != 0) ^ ((p[i] >> j) & 1);
+            crc = ((crc << 1) ^ (bit ? poly : 0)) & mask;
+        }
+    return crc;
+}
+
+static void test_check_values(void)
+{
+    /* CRC catalogue check values */
+    static const char check[] = "123456789";
+
+    assert(vlc_crc8(0, check, 9) == 0xf4);
+    assert(vlc_crc16(0, check, 9) == 0xfee8);
+    assert(vlc_crc32(0xffffffff, check, 9) == 0x0376e6e7);
+
+    /* nothing to add */
+    assert(vlc_crc8(0x5a, check, 0) == 0x5a);
+    assert(vlc_crc16(0x1234, NULL, 0) == 0x1234);
+    assert(vlc_crc32(0xdeadbeef, NULL, 0) == 0xdeadbeef);
+
+    /* a message followed by its CRC checks to 0 */
+    uint8_t frame[11];
+    memcpy(frame, check, 9);
+    SetWBE(&frame[9], vlc_crc16(0, check, 9));
+    assert(vlc_crc16(0, frame, 11) == 0);
+}
+
+static void test_random(const uint8_t *p_data, size_t i_data)
+{
+    /* every alignment and size up to 300 bytes, over the table, the folding
+     * and the tail code paths */
+    for (size_t offset = 0; offset < 16; offset++)
+        for (size_t size = 0; size <= 300 && offset + size <= i_data; size++)
+        {
+            const uint8_t *p = &p_data[offset];
+            uint32_t init = p_data[size] * 0x01010101U;
+
+            assert(vlc_crc8(init, p, size)
+                   == crc_bitwise(init & 0xff, 8, 0x07, p, size));
+            assert(vlc_crc16(init, p, size)
+                   == crc_bitwise(init & 0xffff, 16, 0x8005, p, size));
+            assert(vlc_crc32(init, p, size)
+                   == crc_bitwise(init, 32, 0x04c11db7, p, size));
+        }
+
+    /* whole buffer at once, and incrementally in random sized chunks */
+    uint8_t crc8 = crc_bitwise(0, 8, 0x07, p_data, i_data);
+    uint16_t crc16 = crc_bitwise(0, 16, 0x8005, p_data, i_data);
+    uint32_t crc32 = crc_bitwise(0xffffffff, 32, 0x04c11db7, p_data, i_data);
+
+    assert(vlc_crc8(0, p_data, i_data) == crc8);
+    assert(vlc_crc16(0, p_data, i_data) == crc16);
+    assert(vlc_crc32(0xffffffff, p_data, i_data) == crc32);
+
+    uint8_t inc8 = 0;
+    uint16_t inc16 = 0;
+    uint32_t inc32 = 0xffffffff;
+    for (size_t i = 0; i < i_data; )
+    {
+        size_t size = __MIN((size_t)(rand() % 1000), i_data - i);
+        inc8 = vlc_crc8(inc8, &p_data[i], size);
+        inc16 = vlc_crc16(inc16, &p_data[i], size);
+        inc32 = vlc_crc32(inc32, &p_data[i], size);
+        i += size;
+    }
+    assert(inc8 == crc8);
+    assert(inc16 == crc16);
+    assert(inc32 == crc32);
+}
+
+int main(void)
+{
+    test_check_values();
+
+    const size_t i_data = 1 << 18;
+    uint8_t *p_data = malloc(i_data);
+    assert(p_data);
+
+    srand(0);
+    for (size_t i = 0; i < i_data; i++)
+        p_data[i] = rand();
+    test_random(p_data, i_data);
+
+    /* zero rich data */
+    for (size_t i = 0; i < i_data; i++)
+        p_data[i] = (rand() % 8) ? 0x00 : 0xff;
+    test_random(p_data, i_data);
+
+    free(p_data);
+    return 0;
+}
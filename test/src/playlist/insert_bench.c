@@ -0,0 +1,248 @@
+/*****************************************************************************
+ * insert_bench.c: playlist insertion and expansion benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_src_playlist_insert_bench [items]
+ *
+ * Inserts 1000000 items by default into an empty playlist, one by one, by
+ * batches of 1000 and all at once, and counts the notifications received by
+ * a listener. Then an M3U file with as many entries is generated and
+ * expanded by the preparser: the time until the first entries are added to
+ * the playlist and until all of them are is measured. Set
+ * VLC_TEST_TIMEOUT=-1 for large counts. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_input_item.h>
+#include <vlc_playlist.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+#include <vlc_url.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+struct bench_ctx
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    size_t expected;
+    size_t notifications;
+    vlc_tick_t first_items;
+    vlc_tick_t all_items;
+};
+
+static void
+on_items_added(vlc_playlist_t *playlist, size_t index,
+               vlc_playlist_item_t *const items[], size_t count,
+               void *userdata)
+{
+    (void)index; (void)items; (void)count;
+    struct bench_ctx *ctx = userdata;
+
+    /* called with the playlist locked, like the listeners of the UIs */
+    ctx->notifications++;
+    size_t size = vlc_playlist_Count(playlist);
+    if (ctx->first_items == VLC_TICK_INVALID && size > 1)
+        ctx->first_items = vlc_tick_now();
+    if (size >= ctx->expected)
+    {
+        vlc_mutex_lock(&ctx->lock);
+        if (ctx->all_items == VLC_TICK_INVALID)
+            ctx->all_items = vlc_tick_now();
+        vlc_cond_signal(&ctx->cond);
+        vlc_mutex_unlock(&ctx->lock);
+    }
+}
+
+static const struct vlc_playlist_callbacks cbs = {
+    .on_items_added = on_items_added,
+};
+
+static input_item_t **new_media(size_t count)
+{
+    input_item_t **media = vlc_alloc(count, sizeof(*media));
+    if (media == NULL)
+        abort();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        media[i] = input_item_New("vlc://nop", "track");
+        if (media[i] == NULL)
+            abort();
+    }
+    return media;
+}
+
+static void release_media(input_item_t **media, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        input_item_Release(media[i]);
+    free(media);
+}
+
+static void bench_insert(libvlc_instance_t *vlc, const char *name,
+                         input_item_t **media, size_t count, size_t batch)
+{
+    vlc_playlist_t *playlist =
+        vlc_playlist_New(VLC_OBJECT(vlc->p_libvlc_int));
+    if (playlist == NULL)
+        abort();
+
+    struct bench_ctx ctx = {
+        .expected = count,
+        .first_items = VLC_TICK_INVALID,
+        .all_items = VLC_TICK_INVALID,
+    };
+    vlc_mutex_init(&ctx.lock);
+    vlc_cond_init(&ctx.cond);
+
+    vlc_playlist_Lock(playlist);
+    vlc_playlist_listener_id *listener =
+        vlc_playlist_AddListener(playlist, &cbs, &ctx, false);
+    if (listener == NULL)
+        abort();
+
+    vlc_tick_t start = vlc_tick_now();
+    for (size_t i = 0; i < count; i += batch)
+        if (vlc_playlist_Append(playlist, &media[i],
+                                count - i < batch ? count - i : batch))
+            abort();
+    vlc_tick_t end = vlc_tick_now();
+
+    printf("%-20s %8.3f s  %zu notifications\n", name,
+           secf_from_vlc_tick(end - start), ctx.notifications);
+
+    vlc_playlist_RemoveListener(playlist, listener);
+    vlc_playlist_Unlock(playlist);
+    vlc_playlist_Delete(playlist);
+}
+
+static int generate_m3u(const char *path, size_t count)
+{
+    FILE *file = fopen(path, "w");
+    if (file == NULL)
+        return -1;
+
+    fputs("#EXTM3U\n", file);
+    for (size_t i = 0; i < count; i++)
+        fprintf(file, "#EXTINF:180,Artist - Track %zu\nvlc://nop\n", i);
+    return fclose(file);
+}
+
+static void bench_expand(libvlc_instance_t *vlc, const char *path,
+                         size_t count)
+{
+    char *mrl = vlc_path2uri(path, NULL);
+    if (mrl == NULL)
+        abort();
+    input_item_t *media = input_item_New(mrl, NULL);
+    free(mrl);
+    if (media == NULL)
+        abort();
+    /* expand the playlist file, as if opened from the media browser */
+    media->i_preparse_depth = 1;
+
+    vlc_playlist_t *playlist =
+        vlc_playlist_New(VLC_OBJECT(vlc->p_libvlc_int));
+    if (playlist == NULL)
+        abort();
+
+    struct bench_ctx ctx = {
+        .expected = count,
+        .first_items = VLC_TICK_INVALID,
+        .all_items = VLC_TICK_INVALID,
+    };
+    vlc_mutex_init(&ctx.lock);
+    vlc_cond_init(&ctx.cond);
+
+    vlc_playlist_Lock(playlist);
+    if (vlc_playlist_AppendOne(playlist, media))
+        abort();
+    vlc_playlist_listener_id *listener =
+        vlc_playlist_AddListener(playlist, &cbs, &ctx, false);
+    if (listener == NULL)
+        abort();
+    vlc_playlist_Unlock(playlist);
+
+    vlc_tick_t start = vlc_tick_now();
+    vlc_playlist_Preparse(playlist, media);
+
+    vlc_mutex_lock(&ctx.lock);
+    while (ctx.all_items == VLC_TICK_INVALID)
+        vlc_cond_wait(&ctx.cond, &ctx.lock);
+    vlc_mutex_unlock(&ctx.lock);
+
+    vlc_playlist_Lock(playlist);
+
+    printf("%-20s first items %8.3f s  all %8.3f s  %zu notifications\n",
+           "m3u expansion", secf_from_vlc_tick(ctx.first_items - start),
+           secf_from_vlc_tick(ctx.all_items - start), ctx.notifications);
+
+    vlc_playlist_RemoveListener(playlist, listener);
+    vlc_playlist_Unlock(playlist);
+    vlc_playlist_Delete(playlist);
+    input_item_Release(media);
+}
+
+int main(int argc, char *argv[])
+{
+    test_init();
+
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+
+    const char *args[] = {
+        "--ignore-config",
+        "--no-auto-preparse",
+        "--preparse-timeout=0",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    if (vlc == NULL)
+        return 1;
+
+    input_item_t **media = new_media(count);
+    bench_insert(vlc, "one by one", media, count, 1);
+    bench_insert(vlc, "batches of 1000", media, count, 1000);
+    bench_insert(vlc, "all at once", media, count, count);
+    release_media(media, count);
+
+    char path[] = "/tmp/vlc-insert-bench-XXXXXX.m3u";
+    int fd = mkstemps(path, 4);
+    if (fd == -1)
+        abort();
+    close(fd);
+    if (generate_m3u(path, count))
+    {
+        fprintf(stderr, "can't generate the playlist\n");
+        unlink(path);
+        return 1;
+    }
+    bench_expand(vlc, path, count);
+    unlink(path);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,164 @@
+/*****************************************************************************
+ * sort_bench.c: playlist sort and shuffle benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_src_playlist_sort_bench [items] [batches]
+ *
+ * Fills a playlist with 1000000 items by default, then measures sorting it by
+ * title and duration (first, then again without changes), inserting batches
+ * of 100 items (100 batches by default) and sorting again after each of them,
+ * shuffling it, sorting it after the shuffle, and removing batches of items
+ * in random playback order. Set VLC_TEST_TIMEOUT=-1 for large counts. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_input_item.h>
+#include <vlc_playlist.h>
+#include <vlc_tick.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+#define BATCH_SIZE 100
+
+static const struct vlc_playlist_sort_criterion criteria[] = {
+    { VLC_PLAYLIST_SORT_KEY_TITLE, VLC_PLAYLIST_SORT_ORDER_ASCENDING },
+    { VLC_PLAYLIST_SORT_KEY_DURATION, VLC_PLAYLIST_SORT_ORDER_ASCENDING },
+};
+
+static input_item_t **new_media(size_t count, unsigned short xsubi[3])
+{
+    input_item_t **media = vlc_alloc(count, sizeof(*media));
+    if (media == NULL)
+        abort();
+
+    for (size_t i = 0; i < count; i++)
+    {
+        /* a lot of equal titles, to compare the durations too */
+        char name[32];
+        snprintf(name, sizeof(name), "track %ld", nrand48(xsubi) % 100000);
+        media[i] = input_item_New("vlc://nop", name);
+        if (media[i] == NULL)
+            abort();
+        media[i]->i_duration = VLC_TICK_FROM_SEC(nrand48(xsubi) % 3600);
+    }
+    return media;
+}
+
+static void release_media(input_item_t **media, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+        input_item_Release(media[i]);
+    free(media);
+}
+
+static void print_phase(const char *name, vlc_tick_t start, size_t count)
+{
+    printf("%-20s %8.3f s  %zu items\n", name,
+           secf_from_vlc_tick(vlc_tick_now() - start), count);
+}
+
+static void sort(vlc_playlist_t *playlist)
+{
+    if (vlc_playlist_Sort(playlist, criteria, ARRAY_SIZE(criteria)))
+        abort();
+}
+
+int main(int argc, char *argv[])
+{
+    test_init();
+
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 0) : 1000000;
+    size_t batches = argc > 2 ? strtoul(argv[2], NULL, 0) : 100;
+
+    const char *args[] = {
+        "--ignore-config",
+        "--no-auto-preparse",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    if (vlc == NULL)
+        return 1;
+
+    vlc_playlist_t *playlist =
+        vlc_playlist_New(VLC_OBJECT(vlc->p_libvlc_int));
+    if (playlist == NULL)
+        abort();
+
+    unsigned short xsubi[3] = { 0x1234, 0x5678, 0x9abc };
+    input_item_t **media = new_media(count, xsubi);
+    input_item_t **inserted = new_media(batches * BATCH_SIZE, xsubi);
+
+    vlc_playlist_Lock(playlist);
+
+    vlc_tick_t start = vlc_tick_now();
+    if (vlc_playlist_Append(playlist, media, count))
+        abort();
+    print_phase("append", start, vlc_playlist_Count(playlist));
+
+    start = vlc_tick_now();
+    sort(playlist);
+    print_phase("sort", start, vlc_playlist_Count(playlist));
+
+    start = vlc_tick_now();
+    sort(playlist);
+    print_phase("sort again", start, vlc_playlist_Count(playlist));
+
+    start = vlc_tick_now();
+    for (size_t i = 0; i < batches; i++)
+    {
+        if (vlc_playlist_Append(playlist, &inserted[i * BATCH_SIZE],
+                                BATCH_SIZE))
+            abort();
+        sort(playlist);
+    }
+    print_phase("insert and sort", start, vlc_playlist_Count(playlist));
+
+    start = vlc_tick_now();
+    vlc_playlist_Shuffle(playlist);
+    print_phase("shuffle", start, vlc_playlist_Count(playlist));
+
+    start = vlc_tick_now();
+    sort(playlist);
+    print_phase("sort after shuffle", start, vlc_playlist_Count(playlist));
+
+    vlc_playlist_SetPlaybackOrder(playlist, VLC_PLAYLIST_PLAYBACK_ORDER_RANDOM);
+    start = vlc_tick_now();
+    for (size_t i = 0; i < batches
+                       && vlc_playlist_Count(playlist) >= BATCH_SIZE; i++)
+    {
+        size_t index = nrand48(xsubi)
+                     % (vlc_playlist_Count(playlist) - BATCH_SIZE + 1);
+        vlc_playlist_Remove(playlist, index, BATCH_SIZE);
+    }
+    print_phase("random order remove", start, vlc_playlist_Count(playlist));
+
+    vlc_playlist_Unlock(playlist);
+
+    vlc_playlist_Delete(playlist);
+    release_media(inserted, batches * BATCH_SIZE);
+    release_media(media, count);
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,185 @@
+/*****************************************************************************
+ * cache.c: test the preparse cache
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+
+#include <assert.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <utime.h>
+
+#define WAV_SAMPLES 8000
+
+/* Writes an 8 bits mono PCM WAV file of WAV_SAMPLES samples, so that its size
+ * does not depend on its rate */
+static void write_wav(const char *path, unsigned rate)
+{
+    uint8_t header[44];
+
+    memcpy(&header[0], "RIFF", 4);
+    SetDWLE(&header[4], 36 + WAV_SAMPLES);
+    memcpy(&header[8], "WAVEfmt ", 8);
+    SetDWLE(&header[16], 16);
+    SetWLE(&header[20], 1); /* PCM */
+    SetWLE(&header[22], 1); /* mono */
+    SetDWLE(&header[24], rate);
+    SetDWLE(&header[28], rate); /* bytes per second */
+    SetWLE(&header[32], 1); /* block align */
+    SetWLE(&header[34], 8); /* bits per sample */
+    memcpy(&header[36], "data", 4);
+    SetDWLE(&header[40], WAV_SAMPLES);
+
+    FILE *file = fopen(path, "wb");
+    assert(file != NULL);
+    fwrite(header, 1, sizeof(header), file);
+    for (unsigned i = 0; i < WAV_SAMPLES; i++)
+        fputc(0x80, file);
+    fclose(file);
+}
+
+static void set_mtime(const char *path, time_t mtime)
+{
+    struct utimbuf times = { .actime = mtime, .modtime = mtime };
+    int ret = utime(path, &times);
+    assert(ret == 0);
+}
+
+static void media_parse_ended(const libvlc_event_t *event, void *user_data)
+{
+    (void)event;
+    vlc_sem_t *sem = user_data;
+    vlc_sem_post(sem);
+}
+
+/* Preparses the file with a new instance, which loads the cache when created
+ * and saves it when released, and returns the rate of its audio track */
+static unsigned parse_rate(const char *path, bool cache)
+{
+    const char *args[] = {
+        "--ignore-config",
+        cache ? "--preparse-cache" : "--no-preparse-cache",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    libvlc_media_t *media = libvlc_media_new_path(path);
+    assert(media != NULL);
+
+    vlc_sem_t sem;
+    vlc_sem_init(&sem, 0);
+
+    libvlc_event_manager_t *em = libvlc_media_event_manager(media);
+    libvlc_event_attach(em, libvlc_MediaParsedChanged, media_parse_ended, &sem);
+
+    int ret = libvlc_media_parse_request(vlc, media, libvlc_media_parse_local,
+                                         -1);
+    assert(ret == 0);
+    vlc_sem_wait(&sem);
+    assert(libvlc_media_get_parsed_status(media)
+           == libvlc_media_parsed_status_done);
+
+    libvlc_media_tracklist_t *tracklist =
+        libvlc_media_get_tracklist(media, libvlc_track_audio);
+    assert(tracklist != NULL);
+    assert(libvlc_media_tracklist_count(tracklist) == 1);
+    unsigned rate = libvlc_media_tracklist_at(tracklist, 0)->audio->i_rate;
+    libvlc_media_tracklist_delete(tracklist);
+
+    /* the duration is cached along with the tracks */
+    assert(llabs(libvlc_media_get_duration(media)
+                 - WAV_SAMPLES * INT64_C(1000) / rate) <= 1);
+
+    libvlc_media_release(media);
+    libvlc_release(vlc);
+    return rate;
+}
+
+int main(void)
+{
+#if defined(_WIN32) || defined(__APPLE__) || defined(__OS2__) || \
+    defined(__ANDROID__)
+    /* the cache directory can't be moved to a temporary one */
+    return 77;
+#else
+    test_init();
+
+    char dir[] = "/tmp/vlc-preparse-cache-XXXXXX";
+    if (mkdtemp(dir) == NULL)
+        return 77;
+
+    char *cachedir, *cachefile, *path;
+    if (asprintf(&cachedir, "%s/vlc", dir) == -1
+     || asprintf(&cachefile, "%s/preparse.dat", cachedir) == -1
+     || asprintf(&path, "%s/test.wav", dir) == -1)
+        return 1;
+    /* the cache is then saved in dir/vlc */
+    setenv("XDG_CACHE_HOME", dir, 1);
+
+    /* miss, then saved */
+    write_wav(path, 8000);
+    set_mtime(path, 1000000000);
+    assert(parse_rate(path, true) == 8000);
+
+    struct stat st;
+    assert(stat(cachefile, &st) == 0);
+
+    /* same size and modification time: hit, the file is not opened */
+    write_wav(path, 16000);
+    set_mtime(path, 1000000000);
+    assert(parse_rate(path, true) == 8000);
+    assert(parse_rate(path, false) == 16000);
+
+    /* modified: miss */
+    set_mtime(path, 1000000001);
+    assert(parse_rate(path, true) == 16000);
+    assert(parse_rate(path, true) == 16000);
+
+    /* corrupted cache: ignored */
+    FILE *file = fopen(cachefile, "r+b");
+    assert(file != NULL);
+    fseek(file, -1, SEEK_END);
+    int crc = fgetc(file);
+    fseek(file, -1, SEEK_END);
+    fputc(~crc, file);
+    fclose(file);
+    write_wav(path, 11025);
+    set_mtime(path, 1000000001);
+    assert(parse_rate(path, true) == 11025);
+
+    unlink(cachefile);
+    unlink(path);
+    rmdir(cachedir);
+    rmdir(dir);
+    free(path);
+    free(cachefile);
+    free(cachedir);
+    return 0;
+#endif
+}
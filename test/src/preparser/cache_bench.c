@@ -0,0 +1,250 @@
+/*****************************************************************************
+ * cache_bench.c: preparse cache benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_src_preparser_cache_bench [directory]
+ *
+ * Browses a directory and preparses all its files, without the preparse
+ * cache, then twice with an empty cache, each time with a new instance, so
+ * that the second pass reads the cache saved by the first one. Without
+ * directory, 10000 small WAV files are generated in a temporary one.
+ * Set VLC_TEST_TIMEOUT=-1 for large directories. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include <vlc/vlc.h>
+#include "../../libvlc/test.h"
+
+#include <vlc_common.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <unistd.h>
+
+#define GEN_FILES   10000
+#define GEN_SAMPLES 4000
+
+struct bench_ctx
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    size_t pending;
+};
+
+static void media_parse_ended(const libvlc_event_t *event, void *user_data)
+{
+    (void)event;
+    struct bench_ctx *ctx = user_data;
+
+    vlc_mutex_lock(&ctx->lock);
+    ctx->pending--;
+    vlc_cond_signal(&ctx->cond);
+    vlc_mutex_unlock(&ctx->lock);
+}
+
+static int parse(libvlc_instance_t *vlc, struct bench_ctx *ctx,
+                 libvlc_media_t *media)
+{
+    libvlc_event_manager_t *em = libvlc_media_event_manager(media);
+    libvlc_event_attach(em, libvlc_MediaParsedChanged, media_parse_ended, ctx);
+
+    vlc_mutex_lock(&ctx->lock);
+    ctx->pending++;
+    vlc_mutex_unlock(&ctx->lock);
+
+    if (libvlc_media_parse_request(vlc, media, libvlc_media_parse_local, -1))
+    {
+        libvlc_event_detach(em, libvlc_MediaParsedChanged, media_parse_ended,
+                            ctx);
+        vlc_mutex_lock(&ctx->lock);
+        ctx->pending--;
+        vlc_mutex_unlock(&ctx->lock);
+        return -1;
+    }
+    return 0;
+}
+
+static void wait_parsed(struct bench_ctx *ctx)
+{
+    vlc_mutex_lock(&ctx->lock);
+    while (ctx->pending > 0)
+        vlc_cond_wait(&ctx->cond, &ctx->lock);
+    vlc_mutex_unlock(&ctx->lock);
+}
+
+static void bench_browse(const char *name, const char *dir, bool cache)
+{
+    const char *args[] = {
+        "--ignore-config",
+        cache ? "--preparse-cache" : "--no-preparse-cache",
+    };
+    struct bench_ctx ctx = { .pending = 0 };
+    vlc_mutex_init(&ctx.lock);
+    vlc_cond_init(&ctx.cond);
+
+    vlc_tick_t start = vlc_tick_now();
+
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    if (vlc == NULL)
+        return;
+
+    libvlc_media_t *root = libvlc_media_new_path(dir);
+    if (root == NULL || parse(vlc, &ctx, root))
+    {
+        fprintf(stderr, "can't browse %s\n", dir);
+        if (root != NULL)
+            libvlc_media_release(root);
+        libvlc_release(vlc);
+        return;
+    }
+    wait_parsed(&ctx);
+
+    libvlc_media_list_t *list = libvlc_media_subitems(root);
+    size_t count = 0, parsed = 0;
+    if (list != NULL)
+    {
+        libvlc_media_list_lock(list);
+        count = libvlc_media_list_count(list);
+        libvlc_media_list_unlock(list);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            libvlc_media_list_lock(list);
+            libvlc_media_t *media = libvlc_media_list_item_at_index(list, i);
+            libvlc_media_list_unlock(list);
+            if (media == NULL)
+                continue;
+            parse(vlc, &ctx, media);
+            libvlc_media_release(media);
+        }
+        wait_parsed(&ctx);
+
+        for (size_t i = 0; i < count; i++)
+        {
+            libvlc_media_list_lock(list);
+            libvlc_media_t *media = libvlc_media_list_item_at_index(list, i);
+            libvlc_media_list_unlock(list);
+            if (media == NULL)
+                continue;
+            if (libvlc_media_get_parsed_status(media)
+                == libvlc_media_parsed_status_done)
+                parsed++;
+            libvlc_media_release(media);
+        }
+        libvlc_media_list_release(list);
+    }
+    libvlc_media_release(root);
+
+    vlc_tick_t browsed = vlc_tick_now();
+    /* the cache is saved when the instance is released */
+    libvlc_release(vlc);
+    vlc_tick_t released = vlc_tick_now();
+
+    double secs = secf_from_vlc_tick(browsed - start);
+    printf("%-12s %8.3f s  %9.1f files/s  %zu files  %zu parsed  "
+           "(release %.3f s)\n", name, secs, count / secs, count, parsed,
+           secf_from_vlc_tick(released - browsed));
+}
+
+static int generate_files(const char *dir)
+{
+    uint8_t header[44];
+
+    memcpy(&header[0], "RIFF", 4);
+    SetDWLE(&header[4], 36 + GEN_SAMPLES);
+    memcpy(&header[8], "WAVEfmt ", 8);
+    SetDWLE(&header[16], 16);
+    SetWLE(&header[20], 1); /* PCM */
+    SetWLE(&header[22], 1); /* mono */
+    SetDWLE(&header[24], 8000);
+    SetDWLE(&header[28], 8000);
+    SetWLE(&header[32], 1);
+    SetWLE(&header[34], 8);
+    memcpy(&header[36], "data", 4);
+    SetDWLE(&header[40], GEN_SAMPLES);
+
+    uint8_t samples[GEN_SAMPLES];
+    memset(samples, 0x80, sizeof(samples));
+
+    for (unsigned i = 0; i < GEN_FILES; i++)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%05u.wav", dir, i);
+        FILE *file = fopen(path, "wb");
+        if (file == NULL)
+            return -1;
+        fwrite(header, 1, sizeof(header), file);
+        fwrite(samples, 1, sizeof(samples), file);
+        fclose(file);
+    }
+    return 0;
+}
+
+static void remove_files(const char *dir)
+{
+    for (unsigned i = 0; i < GEN_FILES; i++)
+    {
+        char path[256];
+        snprintf(path, sizeof(path), "%s/%05u.wav", dir, i);
+        unlink(path);
+    }
+    rmdir(dir);
+}
+
+int main(int argc, char *argv[])
+{
+    test_init();
+
+    /* use an empty cache, in a temporary directory */
+    char cachehome[] = "/tmp/vlc-preparse-bench-XXXXXX";
+    if (mkdtemp(cachehome) == NULL)
+        return 1;
+    setenv("XDG_CACHE_HOME", cachehome, 1);
+
+    char gendir[] = "/tmp/vlc-preparse-files-XXXXXX";
+    const char *dir = argc > 1 ? argv[1] : NULL;
+    if (dir == NULL)
+    {
+        if (mkdtemp(gendir) == NULL || generate_files(gendir))
+        {
+            fprintf(stderr, "can't generate the files\n");
+            return 1;
+        }
+        dir = gendir;
+    }
+
+    bench_browse("no cache", dir, false);
+    bench_browse("cold cache", dir, true);
+    bench_browse("warm cache", dir, true);
+
+    if (dir == gendir)
+        remove_files(gendir);
+
+    char cachefile[sizeof(cachehome) + sizeof("/vlc/preparse.dat")];
+    snprintf(cachefile, sizeof(cachefile), "%s/vlc/preparse.dat", cachehome);
+    unlink(cachefile);
+    snprintf(cachefile, sizeof(cachefile), "%s/vlc", cachehome);
+    rmdir(cachefile);
+    rmdir(cachehome);
+    return 0;
+}
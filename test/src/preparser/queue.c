@@ -0,0 +1,231 @@
+/*****************************************************************************
+ * queue.c: test the preparser queue
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_fs.h>
+#include <vlc_input_item.h>
+#include <vlc_threads.h>
+
+#define ITEM_COUNT 8
+
+struct test_ctx
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    input_item_t *ended[ITEM_COUNT + 2];
+    size_t ended_count;
+    int status;
+};
+
+static void on_preparse_ended(input_item_t *item,
+                              enum input_item_preparse_status status,
+                              void *userdata)
+{
+    struct test_ctx *ctx = userdata;
+
+    vlc_mutex_lock(&ctx->lock);
+    assert(ctx->ended_count < ARRAY_SIZE(ctx->ended));
+    ctx->ended[ctx->ended_count++] = item;
+    ctx->status = status;
+    vlc_cond_signal(&ctx->cond);
+    vlc_mutex_unlock(&ctx->lock);
+}
+
+static const input_preparser_callbacks_t cbs = {
+    .on_preparse_ended = on_preparse_ended,
+};
+
+static void wait_ended(struct test_ctx *ctx, size_t count)
+{
+    vlc_mutex_lock(&ctx->lock);
+    while (ctx->ended_count < count)
+        vlc_cond_wait(&ctx->cond, &ctx->lock);
+    vlc_mutex_unlock(&ctx->lock);
+}
+
+/* Blocks the only local preparser thread, so that the next requests are
+ * queued, until it is cancelled with its id */
+static input_item_t *push_blocker(libvlc_instance_t *vlc, int fds[2],
+                                  void *id)
+{
+    int ret = vlc_pipe(fds);
+    assert(ret == 0);
+
+    char uri[sizeof("fd://") + 11];
+    sprintf(uri, "fd://%u", (unsigned) fds[1]);
+    input_item_t *item = input_item_NewFile(uri, "blocker", 0, ITEM_LOCAL);
+    assert(item != NULL);
+
+    ret = libvlc_MetadataRequest(vlc->p_libvlc_int, item,
+                                 META_REQUEST_OPTION_SCOPE_LOCAL,
+                                 NULL, NULL, 0, id);
+    assert(ret == 0);
+    return item;
+}
+
+static void cancel_blocker(libvlc_instance_t *vlc, input_item_t *item,
+                           int fds[2], void *id)
+{
+    libvlc_MetadataCancel(vlc->p_libvlc_int, id);
+    input_item_Release(item);
+    vlc_close(fds[0]);
+    vlc_close(fds[1]);
+}
+
+static input_item_t *new_mock(unsigned audio_tracks, bool net)
+{
+    char *uri;
+    if (asprintf(&uri, "mock://video_track_count=0;audio_track_count=%u;"
+                 "length=100000", audio_tracks) == -1)
+        abort();
+    input_item_t *item = input_item_NewFile(uri, "mock", 0,
+                                            net ? ITEM_NET : ITEM_LOCAL);
+    assert(item != NULL);
+    free(uri);
+    return item;
+}
+
+static void test_priorities(libvlc_instance_t *vlc)
+{
+    test_log("test_priorities\n");
+
+    struct test_ctx ctx = { .ended_count = 0 };
+    vlc_mutex_init(&ctx.lock);
+    vlc_cond_init(&ctx.cond);
+
+    int fds[2], blocker_id;
+    input_item_t *blocker = push_blocker(vlc, fds, &blocker_id);
+
+    input_item_t *items[ITEM_COUNT + 1];
+    for (size_t i = 0; i < ARRAY_SIZE(items); i++)
+    {
+        /* different URIs, so that the requests are not merged */
+        items[i] = new_mock(i + 1, false);
+        input_item_meta_request_option_t options =
+            META_REQUEST_OPTION_SCOPE_LOCAL
+            | (i < ITEM_COUNT ? META_REQUEST_OPTION_PRIORITY_LOW
+                              : META_REQUEST_OPTION_PRIORITY_HIGH);
+        int ret = libvlc_MetadataRequest(vlc->p_libvlc_int, items[i],
+                                         options, &cbs, &ctx, -1, &items[i]);
+        assert(ret == 0);
+    }
+
+    /* raise a low priority request, still pending */
+    libvlc_MetadataSetPriority(vlc->p_libvlc_int, &items[3],
+                               ITEM_PREPARSE_PRIORITY_HIGH);
+
+    cancel_blocker(vlc, blocker, fds, &blocker_id);
+    wait_ended(&ctx, ARRAY_SIZE(items));
+
+    /* high priority first, in order, then the low ones, in order */
+    assert(ctx.ended[0] == items[3]);
+    assert(ctx.ended[1] == items[ITEM_COUNT]);
+    for (size_t i = 0, j = 2; i < ITEM_COUNT; i++)
+        if (i != 3)
+            assert(ctx.ended[j++] == items[i]);
+
+    for (size_t i = 0; i < ARRAY_SIZE(items); i++)
+        input_item_Release(items[i]);
+}
+
+static void test_merge(libvlc_instance_t *vlc)
+{
+    test_log("test_merge\n");
+
+    struct test_ctx ctx = { .ended_count = 0 };
+    vlc_mutex_init(&ctx.lock);
+    vlc_cond_init(&ctx.cond);
+
+    int fds[2], blocker_id;
+    input_item_t *blocker = push_blocker(vlc, fds, &blocker_id);
+
+    /* same URI, different items: the second one gets a copy of the results
+     * of the first one */
+    input_item_t *items[2];
+    for (size_t i = 0; i < ARRAY_SIZE(items); i++)
+    {
+        items[i] = new_mock(2, false);
+        int ret = libvlc_MetadataRequest(vlc->p_libvlc_int, items[i],
+                                         META_REQUEST_OPTION_SCOPE_LOCAL,
+                                         &cbs, &ctx, -1, &items[i]);
+        assert(ret == 0);
+    }
+
+    cancel_blocker(vlc, blocker, fds, &blocker_id);
+    wait_ended(&ctx, ARRAY_SIZE(items));
+    assert(ctx.status == ITEM_PREPARSE_DONE);
+
+    for (size_t i = 0; i < ARRAY_SIZE(items); i++)
+    {
+        assert(input_item_IsPreparsed(items[i]));
+        vlc_mutex_lock(&items[i]->lock);
+        assert(items[i]->i_es == 2);
+        vlc_mutex_unlock(&items[i]->lock);
+        input_item_Release(items[i]);
+    }
+}
+
+static void test_network(libvlc_instance_t *vlc)
+{
+    test_log("test_network\n");
+
+    struct test_ctx ctx = { .ended_count = 0 };
+    vlc_mutex_init(&ctx.lock);
+    vlc_cond_init(&ctx.cond);
+
+    int fds[2], blocker_id;
+    input_item_t *blocker = push_blocker(vlc, fds, &blocker_id);
+
+    /* network items do not wait for the local ones */
+    input_item_t *item = new_mock(1, true);
+    int ret = libvlc_MetadataRequest(vlc->p_libvlc_int, item,
+                                     META_REQUEST_OPTION_SCOPE_ANY,
+                                     &cbs, &ctx, -1, item);
+    assert(ret == 0);
+    wait_ended(&ctx, 1);
+    assert(ctx.status == ITEM_PREPARSE_DONE);
+
+    cancel_blocker(vlc, blocker, fds, &blocker_id);
+    input_item_Release(item);
+}
+
+int main(void)
+{
+    test_init();
+
+    const char *args[] = {
+        "--ignore-config",
+        "--no-preparse-cache",
+        "--preparse-threads=1",
+        "--preparse-network-threads=1",
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    assert(vlc != NULL);
+
+    test_priorities(vlc);
+    test_merge(vlc);
+    test_network(vlc);
+
+    libvlc_release(vlc);
+    return 0;
+}
@@ -0,0 +1,197 @@
+/*****************************************************************************
+ * queue_bench.c: preparser queue latency benchmark
+ *****************************************************************************
+ * Copyright (C) 2026 VLC authors and VideoLAN
+ *
+ * This program is free software; you can redistribute it and/or modify it
+ * under the terms of the GNU Lesser General Public License as published by
+ * the Free Software Foundation; either version 2.1 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE. See the
+ * GNU Lesser General Public License for more details.
+ *
+ * You should have received a copy of the GNU Lesser General Public License
+ * along with this program; if not, write to the Free Software Foundation,
+ * Inc., 51 Franklin Street, Fifth Floor, Boston MA 02110-1301, USA.
+ *****************************************************************************/
+
+/* Usage: test_src_preparser_queue_bench [background requests] [threads]
+ *
+ * Saturates the preparser with background requests (10000 by default), and
+ * pushes a foreground request every 1% of them, like a user scrolling a list
+ * while a large folder is being preparsed. The latency of the foreground
+ * requests is measured first without priorities (FIFO), then with the
+ * background requests pushed as low priority and the foreground ones as high
+ * priority. Set VLC_TEST_TIMEOUT=-1 for large counts. */
+
+#ifdef HAVE_CONFIG_H
+# include "config.h"
+#endif
+
+#include "../../libvlc/test.h"
+#include "../lib/libvlc_internal.h"
+
+#include <vlc_common.h>
+#include <vlc_input_item.h>
+#include <vlc_threads.h>
+#include <vlc_tick.h>
+
+#include <stdio.h>
+#include <stdlib.h>
+
+struct request
+{
+    struct bench_ctx *ctx;
+    input_item_t *item;
+    vlc_tick_t pushed;
+    vlc_tick_t latency;
+    bool foreground;
+};
+
+struct bench_ctx
+{
+    vlc_mutex_t lock;
+    vlc_cond_t cond;
+    size_t pending;
+};
+
+static void on_preparse_ended(input_item_t *item,
+                              enum input_item_preparse_status status,
+                              void *userdata)
+{
+    (void)item; (void)status;
+    struct request *req = userdata;
+    struct bench_ctx *ctx = req->ctx;
+
+    req->latency = vlc_tick_now() - req->pushed;
+
+    vlc_mutex_lock(&ctx->lock);
+    ctx->pending--;
+    vlc_cond_signal(&ctx->cond);
+    vlc_mutex_unlock(&ctx->lock);
+}
+
+static const input_preparser_callbacks_t cbs = {
+    .on_preparse_ended = on_preparse_ended,
+};
+
+static int cmp_tick(const void *a, const void *b)
+{
+    vlc_tick_t ta = *(const vlc_tick_t *)a, tb = *(const vlc_tick_t *)b;
+    return ta < tb ? -1 : ta > tb;
+}
+
+static void bench(const char *name, size_t count, const char *threads,
+                  bool priorities)
+{
+    const char *args[] = {
+        "--ignore-config",
+        "--no-preparse-cache",
+        threads,
+    };
+    libvlc_instance_t *vlc = libvlc_new(ARRAY_SIZE(args), args);
+    if (vlc == NULL)
+        return;
+
+    struct bench_ctx ctx = { .pending = 0 };
+    vlc_mutex_init(&ctx.lock);
+    vlc_cond_init(&ctx.cond);
+
+    size_t step = count / 100 ? count / 100 : 1;
+    size_t total = count + count / step;
+    struct request *reqs = calloc(total, sizeof(*reqs));
+    if (reqs == NULL)
+        abort();
+
+    vlc_tick_t start = vlc_tick_now();
+    for (size_t i = 0, bg = 0; i < total; i++)
+    {
+        struct request *req = &reqs[i];
+        req->ctx = &ctx;
+        req->foreground = bg > 0 && bg % step == 0
+                       && (i == 0 || !reqs[i - 1].foreground);
+        if (!req->foreground)
+            bg++;
+
+        /* different lengths, so that the requests are not merged */
+        char *uri;
+        if (asprintf(&uri, "mock://video_track_count=0;audio_track_count=1;"
+                     "length=%zu", 100000 + i) == -1)
+            abort();
+        req->item = input_item_NewFile(uri, "bench", 0, ITEM_LOCAL);
+        free(uri);
+        if (req->item == NULL)
+            abort();
+
+        input_item_meta_request_option_t options =
+            META_REQUEST_OPTION_SCOPE_LOCAL;
+        if (priorities)
+            options |= req->foreground ? META_REQUEST_OPTION_PRIORITY_HIGH
+                                       : META_REQUEST_OPTION_PRIORITY_LOW;
+
+        vlc_mutex_lock(&ctx.lock);
+        ctx.pending++;
+        vlc_mutex_unlock(&ctx.lock);
+
+        req->pushed = vlc_tick_now();
+        if (libvlc_MetadataRequest(vlc->p_libvlc_int, req->item, options,
+                                   &cbs, req, -1, req) != VLC_SUCCESS)
+        {
+            vlc_mutex_lock(&ctx.lock);
+            ctx.pending--;
+            vlc_mutex_unlock(&ctx.lock);
+        }
+    }
+
+    vlc_mutex_lock(&ctx.lock);
+    while (ctx.pending > 0)
+        vlc_cond_wait(&ctx.cond, &ctx.lock);
+    vlc_mutex_unlock(&ctx.lock);
+    vlc_tick_t end = vlc_tick_now();
+
+    vlc_tick_t *latencies = vlc_alloc(total, sizeof(*latencies));
+    if (latencies == NULL)
+        abort();
+    size_t fg = 0;
+    vlc_tick_t sum = 0;
+    for (size_t i = 0; i < total; i++)
+    {
+        if (reqs[i].foreground)
+        {
+            latencies[fg++] = reqs[i].latency;
+            sum += reqs[i].latency;
+        }
+        input_item_Release(reqs[i].item);
+    }
+    qsort(latencies, fg, sizeof(*latencies), cmp_tick);
+
+    if (fg > 0)
+        printf("%-10s %8.3f s total, %zu foreground requests: "
+               "avg %8.1f ms, p50 %8.1f ms, p95 %8.1f ms, max %8.1f ms\n",
+               name, secf_from_vlc_tick(end - start), fg,
+               secf_from_vlc_tick(sum / (vlc_tick_t)fg) * 1000,
+               secf_from_vlc_tick(latencies[fg / 2]) * 1000,
+               secf_from_vlc_tick(latencies[fg * 95 / 100]) * 1000,
+               secf_from_vlc_tick(latencies[fg - 1]) * 1000);
+
+    free(latencies);
+    free(reqs);
+    libvlc_release(vlc);
+}
+
+int main(int argc, char *argv[])
+{
+    test_init();
+
+    size_t count = argc > 1 ? strtoul(argv[1], NULL, 0) : 10000;
+    char threads[32];
+    snprintf(threads, sizeof(threads), "--preparse-threads=%s",
+             argc > 2 ? argv[2] : "1");
+
+    bench("fifo", count, threads, false);
+    bench("priority", count, threads, true);
+    return 0;
+}